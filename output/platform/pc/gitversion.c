@@ -0,0 +1 @@
+const char * const gitversion = "52ec59c40b6e78231832e329890e90d2a5f1c43f";
@@ -0,0 +1,1030 @@
+/* This file is automatically generated by vdsogen
+ * - DO NOT MODIFY -
+ */
+const unsigned char vdso_raw[] __attribute__((aligned (4096))) = {
+    0x7F, 0x45, 0x4C, 0x46, 0x02, 0x01, 0x01, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x3E, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xB0, 0x19, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x38, 0x00,
+    0x03, 0x00, 0x40, 0x00, 0x0F, 0x00, 0x0E, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x6B, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x6B, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0xC0, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xC0, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xC0, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x50, 0xE5, 0x74, 0x64, 0x04, 0x00, 0x00, 0x00,
+    0x10, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x10, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x10, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x2C, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x2C, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x0A, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+    0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00,
+    0x81, 0x34, 0x30, 0x01, 0x46, 0x65, 0x00, 0x81,
+    0x01, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00,
+    0x07, 0x00, 0x00, 0x00, 0x7E, 0x55, 0xDD, 0x71,
+    0x00, 0xCA, 0x1B, 0xB0, 0x86, 0x4B, 0x85, 0xE6,
+    0x0D, 0x8E, 0x1E, 0x82, 0x94, 0x78, 0x9E, 0x7C,
+    0x19, 0xA3, 0x43, 0x6E, 0x8A, 0x2A, 0xC6, 0x26,
+    0x26, 0xB0, 0x62, 0x65, 0x6D, 0x58, 0x87, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0x1D, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x16, 0x00, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0x3F, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x25, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1D, 0x00, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0x64, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x25, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x38, 0x00, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0xE3, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x3F, 0x00, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0xFD, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0xFB, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x4C, 0x00, 0x00, 0x00, 0x11, 0x00, 0xF1, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x2A, 0x00, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0x89, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x2D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x31, 0x00, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0xB6, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x2D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x5F, 0x5F, 0x76, 0x64, 0x73, 0x6F, 0x5F,
+    0x63, 0x6C, 0x6F, 0x63, 0x6B, 0x5F, 0x67, 0x65,
+    0x74, 0x74, 0x69, 0x6D, 0x65, 0x00, 0x5F, 0x5F,
+    0x76, 0x64, 0x73, 0x6F, 0x5F, 0x67, 0x65, 0x74,
+    0x74, 0x69, 0x6D, 0x65, 0x6F, 0x66, 0x64, 0x61,
+    0x79, 0x00, 0x5F, 0x5F, 0x76, 0x64, 0x73, 0x6F,
+    0x5F, 0x67, 0x65, 0x74, 0x63, 0x70, 0x75, 0x00,
+    0x5F, 0x5F, 0x76, 0x64, 0x73, 0x6F, 0x5F, 0x74,
+    0x69, 0x6D, 0x65, 0x00, 0x76, 0x64, 0x73, 0x6F,
+    0x2E, 0x73, 0x6F, 0x00, 0x4C, 0x49, 0x4E, 0x55,
+    0x58, 0x5F, 0x32, 0x2E, 0x36, 0x00, 0x50, 0x49,
+    0x43, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xFD, 0xFF, 0xFF, 0x7F, 0x00, 0x00, 0x00, 0x00,
+    0x56, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xE8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xF5, 0xFE, 0xFF, 0x6F, 0x00, 0x00, 0x00, 0x00,
+    0x28, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x60, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x70, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x5A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x0B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xFC, 0xFF, 0xFF, 0x6F, 0x00, 0x00, 0x00, 0x00,
+    0xD8, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xFD, 0xFF, 0xFF, 0x6F, 0x00, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xF0, 0xFF, 0xFF, 0x6F, 0x00, 0x00, 0x00, 0x00,
+    0xC0, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00,
+    0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00,
+    0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00,
+    0xEF, 0x25, 0xBA, 0x0C, 0x14, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x44, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x01, 0x00, 0xF6, 0x75, 0xAE, 0x03,
+    0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x4C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x1B, 0x03, 0x3B, 0x2C, 0x01, 0x00, 0x00,
+    0x24, 0x00, 0x00, 0x00, 0xD4, 0x05, 0x00, 0x00,
+    0x48, 0x01, 0x00, 0x00, 0xE4, 0x05, 0x00, 0x00,
+    0x68, 0x01, 0x00, 0x00, 0xF6, 0x05, 0x00, 0x00,
+    0x88, 0x01, 0x00, 0x00, 0x3E, 0x06, 0x00, 0x00,
+    0xA8, 0x01, 0x00, 0x00, 0x86, 0x06, 0x00, 0x00,
+    0xC8, 0x01, 0x00, 0x00, 0xC7, 0x06, 0x00, 0x00,
+    0xE8, 0x01, 0x00, 0x00, 0x09, 0x07, 0x00, 0x00,
+    0x08, 0x02, 0x00, 0x00, 0x1B, 0x07, 0x00, 0x00,
+    0x28, 0x02, 0x00, 0x00, 0x43, 0x07, 0x00, 0x00,
+    0x48, 0x02, 0x00, 0x00, 0x6E, 0x07, 0x00, 0x00,
+    0x68, 0x02, 0x00, 0x00, 0x95, 0x07, 0x00, 0x00,
+    0x88, 0x02, 0x00, 0x00, 0xE6, 0x07, 0x00, 0x00,
+    0xA8, 0x02, 0x00, 0x00, 0x3A, 0x08, 0x00, 0x00,
+    0xC8, 0x02, 0x00, 0x00, 0x94, 0x08, 0x00, 0x00,
+    0xE8, 0x02, 0x00, 0x00, 0xEB, 0x08, 0x00, 0x00,
+    0x08, 0x03, 0x00, 0x00, 0x0D, 0x09, 0x00, 0x00,
+    0x28, 0x03, 0x00, 0x00, 0x2F, 0x09, 0x00, 0x00,
+    0x48, 0x03, 0x00, 0x00, 0x54, 0x09, 0x00, 0x00,
+    0x68, 0x03, 0x00, 0x00, 0x79, 0x09, 0x00, 0x00,
+    0x88, 0x03, 0x00, 0x00, 0xA6, 0x09, 0x00, 0x00,
+    0xA8, 0x03, 0x00, 0x00, 0xD3, 0x09, 0x00, 0x00,
+    0xC8, 0x03, 0x00, 0x00, 0xED, 0x09, 0x00, 0x00,
+    0xE8, 0x03, 0x00, 0x00, 0x07, 0x0A, 0x00, 0x00,
+    0x08, 0x04, 0x00, 0x00, 0x21, 0x0A, 0x00, 0x00,
+    0x28, 0x04, 0x00, 0x00, 0xA3, 0x0A, 0x00, 0x00,
+    0x48, 0x04, 0x00, 0x00, 0xB5, 0x0A, 0x00, 0x00,
+    0x68, 0x04, 0x00, 0x00, 0x3F, 0x0B, 0x00, 0x00,
+    0x8C, 0x04, 0x00, 0x00, 0x4C, 0x0B, 0x00, 0x00,
+    0xAC, 0x04, 0x00, 0x00, 0x68, 0x0B, 0x00, 0x00,
+    0xCC, 0x04, 0x00, 0x00, 0x83, 0x0B, 0x00, 0x00,
+    0xEC, 0x04, 0x00, 0x00, 0x9E, 0x0B, 0x00, 0x00,
+    0x0C, 0x05, 0x00, 0x00, 0x85, 0x0C, 0x00, 0x00,
+    0x34, 0x05, 0x00, 0x00, 0xAC, 0x0C, 0x00, 0x00,
+    0x54, 0x05, 0x00, 0x00, 0xB9, 0x0C, 0x00, 0x00,
+    0x74, 0x05, 0x00, 0x00, 0xD8, 0x0C, 0x00, 0x00,
+    0x94, 0x05, 0x00, 0x00, 0x15, 0x0E, 0x00, 0x00,
+    0xB4, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x7A, 0x52, 0x00, 0x01, 0x78, 0x10, 0x01,
+    0x1B, 0x0C, 0x07, 0x08, 0x90, 0x01, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00,
+    0x84, 0x04, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x4B, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x3C, 0x00, 0x00, 0x00,
+    0x74, 0x04, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x4D, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x5C, 0x00, 0x00, 0x00,
+    0x66, 0x04, 0x00, 0x00, 0x48, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x45, 0x83, 0x03, 0x7E, 0x0C, 0x07, 0x08,
+    0x1C, 0x00, 0x00, 0x00, 0x7C, 0x00, 0x00, 0x00,
+    0x8E, 0x04, 0x00, 0x00, 0x48, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x45, 0x83, 0x03, 0x7E, 0x0C, 0x07, 0x08,
+    0x1C, 0x00, 0x00, 0x00, 0x9C, 0x00, 0x00, 0x00,
+    0xB6, 0x04, 0x00, 0x00, 0x41, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x7C, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0xBC, 0x00, 0x00, 0x00,
+    0xD7, 0x04, 0x00, 0x00, 0x42, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x7D, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0xDC, 0x00, 0x00, 0x00,
+    0xF9, 0x04, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x4D, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0xFC, 0x00, 0x00, 0x00,
+    0xEB, 0x04, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x63, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x1C, 0x01, 0x00, 0x00,
+    0xF3, 0x04, 0x00, 0x00, 0x2B, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x66, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x3C, 0x01, 0x00, 0x00,
+    0xFE, 0x04, 0x00, 0x00, 0x27, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x62, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x5C, 0x01, 0x00, 0x00,
+    0x05, 0x05, 0x00, 0x00, 0x51, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x02, 0x4C, 0x0C, 0x07, 0x08, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x7C, 0x01, 0x00, 0x00,
+    0x36, 0x05, 0x00, 0x00, 0x54, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x02, 0x4F, 0x0C, 0x07, 0x08, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x9C, 0x01, 0x00, 0x00,
+    0x6A, 0x05, 0x00, 0x00, 0x5A, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x02, 0x55, 0x0C, 0x07, 0x08, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0xBC, 0x01, 0x00, 0x00,
+    0xA4, 0x05, 0x00, 0x00, 0x57, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x02, 0x52, 0x0C, 0x07, 0x08, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0xDC, 0x01, 0x00, 0x00,
+    0xDB, 0x05, 0x00, 0x00, 0x22, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x5D, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0xFC, 0x01, 0x00, 0x00,
+    0xDD, 0x05, 0x00, 0x00, 0x22, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x5D, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x1C, 0x02, 0x00, 0x00,
+    0xDF, 0x05, 0x00, 0x00, 0x25, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x60, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x3C, 0x02, 0x00, 0x00,
+    0xE4, 0x05, 0x00, 0x00, 0x25, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x60, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x5C, 0x02, 0x00, 0x00,
+    0xE9, 0x05, 0x00, 0x00, 0x2D, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x68, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x7C, 0x02, 0x00, 0x00,
+    0xF6, 0x05, 0x00, 0x00, 0x2D, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x68, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x9C, 0x02, 0x00, 0x00,
+    0x03, 0x06, 0x00, 0x00, 0x1A, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x55, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0xBC, 0x02, 0x00, 0x00,
+    0xFD, 0x05, 0x00, 0x00, 0x1A, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x55, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0xDC, 0x02, 0x00, 0x00,
+    0xF7, 0x05, 0x00, 0x00, 0x1A, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x55, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0xFC, 0x02, 0x00, 0x00,
+    0xF1, 0x05, 0x00, 0x00, 0x82, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x02, 0x7D, 0x0C, 0x07, 0x08, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x1C, 0x03, 0x00, 0x00,
+    0x53, 0x06, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x4D, 0x0C, 0x07, 0x08, 0x00, 0x00, 0x00,
+    0x20, 0x00, 0x00, 0x00, 0x3C, 0x03, 0x00, 0x00,
+    0x45, 0x06, 0x00, 0x00, 0x8A, 0x00, 0x00, 0x00,
+    0x00, 0x41, 0x0E, 0x10, 0x86, 0x02, 0x43, 0x0D,
+    0x06, 0x45, 0x83, 0x03, 0x02, 0x80, 0x0C, 0x07,
+    0x08, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00,
+    0x60, 0x03, 0x00, 0x00, 0xAB, 0x06, 0x00, 0x00,
+    0x0D, 0x00, 0x00, 0x00, 0x00, 0x41, 0x0E, 0x10,
+    0x86, 0x02, 0x43, 0x0D, 0x06, 0x48, 0x0C, 0x07,
+    0x08, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00,
+    0x80, 0x03, 0x00, 0x00, 0x98, 0x06, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x00, 0x41, 0x0E, 0x10,
+    0x86, 0x02, 0x43, 0x0D, 0x06, 0x57, 0x0C, 0x07,
+    0x08, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00,
+    0xA0, 0x03, 0x00, 0x00, 0x94, 0x06, 0x00, 0x00,
+    0x1B, 0x00, 0x00, 0x00, 0x00, 0x41, 0x0E, 0x10,
+    0x86, 0x02, 0x43, 0x0D, 0x06, 0x56, 0x0C, 0x07,
+    0x08, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00,
+    0xC0, 0x03, 0x00, 0x00, 0x8F, 0x06, 0x00, 0x00,
+    0x1B, 0x00, 0x00, 0x00, 0x00, 0x41, 0x0E, 0x10,
+    0x86, 0x02, 0x43, 0x0D, 0x06, 0x56, 0x0C, 0x07,
+    0x08, 0x00, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00,
+    0xE0, 0x03, 0x00, 0x00, 0x8A, 0x06, 0x00, 0x00,
+    0xE7, 0x00, 0x00, 0x00, 0x00, 0x41, 0x0E, 0x10,
+    0x86, 0x02, 0x43, 0x0D, 0x06, 0x4C, 0x8F, 0x03,
+    0x8E, 0x04, 0x8D, 0x05, 0x8C, 0x06, 0x02, 0xD6,
+    0x0C, 0x07, 0x08, 0x00, 0x1C, 0x00, 0x00, 0x00,
+    0x08, 0x04, 0x00, 0x00, 0x49, 0x07, 0x00, 0x00,
+    0x27, 0x00, 0x00, 0x00, 0x00, 0x41, 0x0E, 0x10,
+    0x86, 0x02, 0x43, 0x0D, 0x06, 0x62, 0x0C, 0x07,
+    0x08, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00,
+    0x28, 0x04, 0x00, 0x00, 0x50, 0x07, 0x00, 0x00,
+    0x0D, 0x00, 0x00, 0x00, 0x00, 0x41, 0x0E, 0x10,
+    0x86, 0x02, 0x43, 0x0D, 0x06, 0x48, 0x0C, 0x07,
+    0x08, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00,
+    0x48, 0x04, 0x00, 0x00, 0x3D, 0x07, 0x00, 0x00,
+    0x1F, 0x00, 0x00, 0x00, 0x00, 0x41, 0x0E, 0x10,
+    0x86, 0x02, 0x43, 0x0D, 0x06, 0x5A, 0x0C, 0x07,
+    0x08, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00,
+    0x68, 0x04, 0x00, 0x00, 0x3C, 0x07, 0x00, 0x00,
+    0x3D, 0x01, 0x00, 0x00, 0x00, 0x41, 0x0E, 0x10,
+    0x86, 0x02, 0x43, 0x0D, 0x06, 0x03, 0x38, 0x01,
+    0x0C, 0x07, 0x08, 0x00, 0x1C, 0x00, 0x00, 0x00,
+    0x88, 0x04, 0x00, 0x00, 0x59, 0x08, 0x00, 0x00,
+    0x46, 0x00, 0x00, 0x00, 0x00, 0x41, 0x0E, 0x10,
+    0x86, 0x02, 0x43, 0x0D, 0x06, 0x02, 0x41, 0x0C,
+    0x07, 0x08, 0x00, 0x00, 0x55, 0x48, 0x89, 0xE5,
+    0x48, 0x89, 0x7D, 0xF8, 0x48, 0x8B, 0x45, 0xF8,
+    0x89, 0xC0, 0x5D, 0xC3, 0x55, 0x48, 0x89, 0xE5,
+    0x48, 0x89, 0x7D, 0xF8, 0x48, 0x8B, 0x45, 0xF8,
+    0x48, 0xC1, 0xE8, 0x20, 0x5D, 0xC3, 0x55, 0x48,
+    0x89, 0xE5, 0x53, 0x48, 0x83, 0xEC, 0x18, 0x48,
+    0x89, 0x7D, 0xE0, 0x48, 0x8B, 0x45, 0xE0, 0x48,
+    0x89, 0xC7, 0xE8, 0xD5, 0xFF, 0xFF, 0xFF, 0x48,
+    0x89, 0x45, 0xF0, 0x48, 0x8B, 0x45, 0xF0, 0x48,
+    0x69, 0xD8, 0x00, 0xCA, 0x9A, 0x3B, 0x48, 0x8B,
+    0x45, 0xE0, 0x48, 0x89, 0xC7, 0xE8, 0xAA, 0xFF,
+    0xFF, 0xFF, 0x48, 0x69, 0xC0, 0x00, 0xCA, 0x9A,
+    0x3B, 0x48, 0xC1, 0xE8, 0x20, 0x48, 0x01, 0xD8,
+    0x48, 0x8B, 0x5D, 0xF8, 0xC9, 0xC3, 0x55, 0x48,
+    0x89, 0xE5, 0x53, 0x48, 0x83, 0xEC, 0x18, 0x48,
+    0x89, 0x7D, 0xE0, 0x48, 0x8B, 0x45, 0xE0, 0x48,
+    0x89, 0xC7, 0xE8, 0x8D, 0xFF, 0xFF, 0xFF, 0x48,
+    0x89, 0x45, 0xF0, 0x48, 0x8B, 0x45, 0xF0, 0x48,
+    0x69, 0xD8, 0x40, 0x42, 0x0F, 0x00, 0x48, 0x8B,
+    0x45, 0xE0, 0x48, 0x89, 0xC7, 0xE8, 0x62, 0xFF,
+    0xFF, 0xFF, 0x48, 0x69, 0xC0, 0x40, 0x42, 0x0F,
+    0x00, 0x48, 0xC1, 0xE8, 0x20, 0x48, 0x01, 0xD8,
+    0x48, 0x8B, 0x5D, 0xF8, 0xC9, 0xC3, 0x55, 0x48,
+    0x89, 0xE5, 0x48, 0x83, 0xEC, 0x10, 0x48, 0x89,
+    0x7D, 0xF8, 0x48, 0x89, 0x75, 0xF0, 0x48, 0x8B,
+    0x45, 0xF0, 0x48, 0xC1, 0xE8, 0x20, 0x48, 0x89,
+    0xC2, 0x48, 0x8B, 0x45, 0xF8, 0x48, 0x89, 0x10,
+    0x48, 0x8B, 0x45, 0xF0, 0x48, 0x89, 0xC7, 0xE8,
+    0x20, 0xFF, 0xFF, 0xFF, 0x48, 0x89, 0xC7, 0xE8,
+    0x82, 0xFF, 0xFF, 0xFF, 0x48, 0x8B, 0x55, 0xF8,
+    0x48, 0x89, 0x42, 0x08, 0x90, 0xC9, 0xC3, 0x55,
+    0x48, 0x89, 0xE5, 0x48, 0x83, 0xEC, 0x10, 0x48,
+    0x89, 0x7D, 0xF8, 0x48, 0x89, 0x75, 0xF0, 0x48,
+    0x8B, 0x45, 0xF0, 0x48, 0x89, 0xC7, 0xE8, 0x01,
+    0xFF, 0xFF, 0xFF, 0x48, 0x8B, 0x55, 0xF8, 0x48,
+    0x89, 0x02, 0x48, 0x8B, 0x45, 0xF0, 0x48, 0x89,
+    0xC7, 0xE8, 0xDE, 0xFE, 0xFF, 0xFF, 0x48, 0x89,
+    0xC7, 0xE8, 0xF8, 0xFE, 0xFF, 0xFF, 0x48, 0x8B,
+    0x55, 0xF8, 0x48, 0x89, 0x42, 0x08, 0x90, 0xC9,
+    0xC3, 0x55, 0x48, 0x89, 0xE5, 0x48, 0x89, 0x7D,
+    0xF8, 0x48, 0x8B, 0x45, 0xF8, 0x48, 0xC1, 0xE8,
+    0x20, 0x5D, 0xC3, 0x55, 0x48, 0x89, 0xE5, 0x89,
+    0x7D, 0xEC, 0x48, 0x89, 0x75, 0xE0, 0xB8, 0xE4,
+    0x00, 0x00, 0x00, 0x8B, 0x55, 0xEC, 0x48, 0x8B,
+    0x4D, 0xE0, 0x89, 0xD7, 0x48, 0x89, 0xCE, 0x0F,
+    0x05, 0x48, 0x89, 0x45, 0xF8, 0x48, 0x8B, 0x45,
+    0xF8, 0x5D, 0xC3, 0x55, 0x48, 0x89, 0xE5, 0x48,
+    0x89, 0x7D, 0xE8, 0x48, 0x89, 0x75, 0xE0, 0xB8,
+    0x60, 0x00, 0x00, 0x00, 0x48, 0x8B, 0x55, 0xE8,
+    0x48, 0x8B, 0x4D, 0xE0, 0x48, 0x89, 0xD7, 0x48,
+    0x89, 0xCE, 0x0F, 0x05, 0x48, 0x89, 0x45, 0xF8,
+    0x48, 0x8B, 0x45, 0xF8, 0x5D, 0xC3, 0x55, 0x48,
+    0x89, 0xE5, 0x48, 0x89, 0x7D, 0xE8, 0xB8, 0xC9,
+    0x00, 0x00, 0x00, 0x48, 0x8B, 0x55, 0xE8, 0xB9,
+    0x00, 0x00, 0x00, 0x00, 0x48, 0x89, 0xD7, 0x89,
+    0xCE, 0x0F, 0x05, 0x48, 0x89, 0x45, 0xF8, 0x48,
+    0x8B, 0x45, 0xF8, 0x5D, 0xC3, 0x55, 0x48, 0x89,
+    0xE5, 0x48, 0x83, 0xEC, 0x20, 0x89, 0x7D, 0xEC,
+    0x48, 0x89, 0x75, 0xE0, 0x8B, 0x45, 0xEC, 0x89,
+    0xC7, 0xE8, 0x2A, 0x05, 0x00, 0x00, 0x48, 0x89,
+    0x45, 0xF8, 0x48, 0x83, 0x7D, 0xF8, 0xFF, 0x75,
+    0x13, 0x48, 0x8B, 0x55, 0xE0, 0x8B, 0x45, 0xEC,
+    0x48, 0x89, 0xD6, 0x89, 0xC7, 0xE8, 0x51, 0xFF,
+    0xFF, 0xFF, 0xEB, 0x18, 0x48, 0x8B, 0x55, 0xF8,
+    0x48, 0x8B, 0x45, 0xE0, 0x48, 0x89, 0xD6, 0x48,
+    0x89, 0xC7, 0xE8, 0xE8, 0xFE, 0xFF, 0xFF, 0xB8,
+    0x00, 0x00, 0x00, 0x00, 0xC9, 0xC3, 0x55, 0x48,
+    0x89, 0xE5, 0x48, 0x83, 0xEC, 0x20, 0x48, 0x89,
+    0x7D, 0xE8, 0x48, 0x89, 0x75, 0xE0, 0xBF, 0x00,
+    0x00, 0x00, 0x00, 0xE8, 0xD8, 0x04, 0x00, 0x00,
+    0x48, 0x89, 0x45, 0xF8, 0x48, 0x83, 0x7D, 0xF8,
+    0xFF, 0x75, 0x15, 0x48, 0x8B, 0x55, 0xE0, 0x48,
+    0x8B, 0x45, 0xE8, 0x48, 0x89, 0xD6, 0x48, 0x89,
+    0xC7, 0xE8, 0x25, 0xFF, 0xFF, 0xFF, 0xEB, 0x18,
+    0x48, 0x8B, 0x55, 0xF8, 0x48, 0x8B, 0x45, 0xE8,
+    0x48, 0x89, 0xD6, 0x48, 0x89, 0xC7, 0xE8, 0x53,
+    0xFE, 0xFF, 0xFF, 0xB8, 0x00, 0x00, 0x00, 0x00,
+    0xC9, 0xC3, 0x55, 0x48, 0x89, 0xE5, 0x48, 0x83,
+    0xEC, 0x30, 0x48, 0x89, 0x7D, 0xE8, 0x48, 0x89,
+    0x75, 0xE0, 0x48, 0x89, 0x55, 0xD8, 0x48, 0x8B,
+    0x55, 0xE0, 0x48, 0x8B, 0x45, 0xE8, 0x48, 0x89,
+    0xD6, 0x48, 0x89, 0xC7, 0xE8, 0xB4, 0x05, 0x00,
+    0x00, 0x48, 0x98, 0x48, 0x89, 0x45, 0xF8, 0x48,
+    0x83, 0x7D, 0xF8, 0x00, 0x78, 0x06, 0x48, 0x8B,
+    0x45, 0xF8, 0xEB, 0x1E, 0xB8, 0x35, 0x01, 0x00,
+    0x00, 0x48, 0x8B, 0x55, 0xE8, 0x48, 0x8B, 0x4D,
+    0xE0, 0x48, 0x89, 0xD7, 0x48, 0x89, 0xCE, 0x0F,
+    0x05, 0x48, 0x89, 0x45, 0xF0, 0x48, 0x8B, 0x45,
+    0xF0, 0x90, 0xC9, 0xC3, 0x55, 0x48, 0x89, 0xE5,
+    0x48, 0x83, 0xEC, 0x20, 0x48, 0x89, 0x7D, 0xE8,
+    0xBF, 0x00, 0x00, 0x00, 0x00, 0xE8, 0x2E, 0x04,
+    0x00, 0x00, 0x48, 0x89, 0x45, 0xF8, 0x48, 0x83,
+    0x7D, 0xF8, 0xFF, 0x75, 0x0E, 0x48, 0x8B, 0x45,
+    0xE8, 0x48, 0x89, 0xC7, 0xE8, 0xAD, 0xFE, 0xFF,
+    0xFF, 0xEB, 0x26, 0x48, 0x8B, 0x45, 0xF8, 0x48,
+    0x89, 0xC7, 0xE8, 0x3A, 0xFE, 0xFF, 0xFF, 0x48,
+    0x89, 0x45, 0xF0, 0x48, 0x83, 0x7D, 0xE8, 0x00,
+    0x74, 0x0B, 0x48, 0x8B, 0x45, 0xE8, 0x48, 0x8B,
+    0x55, 0xF0, 0x48, 0x89, 0x10, 0x48, 0x8B, 0x45,
+    0xF0, 0xC9, 0xC3, 0x55, 0x48, 0x89, 0xE5, 0x48,
+    0x83, 0xEC, 0x10, 0x89, 0x7D, 0xFC, 0x48, 0x89,
+    0x75, 0xF0, 0x48, 0x8B, 0x55, 0xF0, 0x8B, 0x45,
+    0xFC, 0x48, 0x89, 0xD6, 0x89, 0xC7, 0xE8, 0x8A,
+    0xFE, 0xFF, 0xFF, 0xC9, 0xC3, 0x55, 0x48, 0x89,
+    0xE5, 0x48, 0x83, 0xEC, 0x10, 0x89, 0x7D, 0xFC,
+    0x48, 0x89, 0x75, 0xF0, 0x48, 0x8B, 0x55, 0xF0,
+    0x8B, 0x45, 0xFC, 0x48, 0x89, 0xD6, 0x89, 0xC7,
+    0xE8, 0x68, 0xFE, 0xFF, 0xFF, 0xC9, 0xC3, 0x55,
+    0x48, 0x89, 0xE5, 0x48, 0x83, 0xEC, 0x10, 0x48,
+    0x89, 0x7D, 0xF8, 0x48, 0x89, 0x75, 0xF0, 0x48,
+    0x8B, 0x55, 0xF0, 0x48, 0x8B, 0x45, 0xF8, 0x48,
+    0x89, 0xD6, 0x48, 0x89, 0xC7, 0xE8, 0x94, 0xFE,
+    0xFF, 0xFF, 0xC9, 0xC3, 0x55, 0x48, 0x89, 0xE5,
+    0x48, 0x83, 0xEC, 0x10, 0x48, 0x89, 0x7D, 0xF8,
+    0x48, 0x89, 0x75, 0xF0, 0x48, 0x8B, 0x55, 0xF0,
+    0x48, 0x8B, 0x45, 0xF8, 0x48, 0x89, 0xD6, 0x48,
+    0x89, 0xC7, 0xE8, 0x6F, 0xFE, 0xFF, 0xFF, 0xC9,
+    0xC3, 0x55, 0x48, 0x89, 0xE5, 0x48, 0x83, 0xEC,
+    0x20, 0x48, 0x89, 0x7D, 0xF8, 0x48, 0x89, 0x75,
+    0xF0, 0x48, 0x89, 0x55, 0xE8, 0x48, 0x8B, 0x55,
+    0xE8, 0x48, 0x8B, 0x4D, 0xF0, 0x48, 0x8B, 0x45,
+    0xF8, 0x48, 0x89, 0xCE, 0x48, 0x89, 0xC7, 0xE8,
+    0x96, 0xFE, 0xFF, 0xFF, 0xC9, 0xC3, 0x55, 0x48,
+    0x89, 0xE5, 0x48, 0x83, 0xEC, 0x20, 0x48, 0x89,
+    0x7D, 0xF8, 0x48, 0x89, 0x75, 0xF0, 0x48, 0x89,
+    0x55, 0xE8, 0x48, 0x8B, 0x55, 0xE8, 0x48, 0x8B,
+    0x4D, 0xF0, 0x48, 0x8B, 0x45, 0xF8, 0x48, 0x89,
+    0xCE, 0x48, 0x89, 0xC7, 0xE8, 0x69, 0xFE, 0xFF,
+    0xFF, 0xC9, 0xC3, 0x55, 0x48, 0x89, 0xE5, 0x48,
+    0x83, 0xEC, 0x10, 0x48, 0x89, 0x7D, 0xF8, 0x48,
+    0x8B, 0x45, 0xF8, 0x48, 0x89, 0xC7, 0xE8, 0xA9,
+    0xFE, 0xFF, 0xFF, 0xC9, 0xC3, 0x55, 0x48, 0x89,
+    0xE5, 0x48, 0x83, 0xEC, 0x10, 0x48, 0x89, 0x7D,
+    0xF8, 0x48, 0x8B, 0x45, 0xF8, 0x48, 0x89, 0xC7,
+    0xE8, 0x8F, 0xFE, 0xFF, 0xFF, 0xC9, 0xC3, 0x55,
+    0x48, 0x89, 0xE5, 0x48, 0x89, 0x7D, 0xF8, 0x48,
+    0x8B, 0x05, 0x82, 0x12, 0x00, 0x00, 0x48, 0x0F,
+    0xAF, 0x45, 0xF8, 0x48, 0xC1, 0xF8, 0x20, 0x5D,
+    0xC3, 0x55, 0x48, 0x89, 0xE5, 0x48, 0x89, 0x7D,
+    0xE8, 0x48, 0x89, 0x75, 0xE0, 0x48, 0x8B, 0x45,
+    0xE0, 0x48, 0x8B, 0x55, 0xE8, 0x48, 0x29, 0xC2,
+    0x48, 0x89, 0x55, 0xF8, 0x48, 0x8B, 0x45, 0xE8,
+    0x48, 0x89, 0x45, 0xF0, 0x48, 0x8B, 0x05, 0x5D,
+    0x12, 0x00, 0x00, 0x48, 0x39, 0x45, 0xF8, 0x73,
+    0x0B, 0x48, 0x8B, 0x05, 0x50, 0x12, 0x00, 0x00,
+    0x48, 0x89, 0x45, 0xF8, 0x48, 0x8B, 0x05, 0x4D,
+    0x12, 0x00, 0x00, 0x48, 0x3B, 0x45, 0xE8, 0x73,
+    0x0B, 0x48, 0x8B, 0x05, 0x40, 0x12, 0x00, 0x00,
+    0x48, 0x89, 0x45, 0xF0, 0x48, 0x8B, 0x45, 0xE8,
+    0x48, 0x3B, 0x45, 0xF8, 0x73, 0x07, 0xB8, 0x00,
+    0x00, 0x00, 0x00, 0xEB, 0x1C, 0x48, 0x8B, 0x45,
+    0xF0, 0x48, 0x2B, 0x45, 0xF8, 0x48, 0x89, 0x45,
+    0xE0, 0x48, 0x8B, 0x05, 0x08, 0x12, 0x00, 0x00,
+    0x48, 0x0F, 0xAF, 0x45, 0xE0, 0x48, 0xC1, 0xF8,
+    0x20, 0x5D, 0xC3, 0x55, 0x48, 0x89, 0xE5, 0x48,
+    0x89, 0x7D, 0xF8, 0x48, 0x8B, 0x45, 0xF8, 0x48,
+    0xC1, 0xE0, 0x20, 0x5D, 0xC3, 0x55, 0x48, 0x89,
+    0xE5, 0x53, 0x48, 0x83, 0xEC, 0x18, 0x48, 0x89,
+    0x7D, 0xE0, 0x48, 0x83, 0x7D, 0xE0, 0x00, 0x75,
+    0x07, 0xB8, 0x00, 0x00, 0x00, 0x00, 0xEB, 0x69,
+    0x48, 0x8B, 0x45, 0xE0, 0x48, 0xC1, 0xE8, 0x09,
+    0x48, 0xBA, 0x53, 0x5A, 0x9B, 0xA0, 0x2F, 0xB8,
+    0x44, 0x00, 0x48, 0xF7, 0xE2, 0x48, 0x89, 0xD0,
+    0x48, 0xC1, 0xE8, 0x0B, 0x48, 0x89, 0x45, 0xF0,
+    0x48, 0x8B, 0x45, 0xF0, 0x48, 0x69, 0xC0, 0x00,
+    0xCA, 0x9A, 0x3B, 0x48, 0x29, 0x45, 0xE0, 0x48,
+    0x8B, 0x45, 0xF0, 0x48, 0x89, 0xC7, 0xE8, 0x98,
+    0xFF, 0xFF, 0xFF, 0x48, 0x89, 0xC3, 0x48, 0x8B,
+    0x45, 0xE0, 0x48, 0x89, 0xC7, 0xE8, 0x89, 0xFF,
+    0xFF, 0xFF, 0x48, 0xC1, 0xE8, 0x09, 0x48, 0xBA,
+    0x53, 0x5A, 0x9B, 0xA0, 0x2F, 0xB8, 0x44, 0x00,
+    0x48, 0xF7, 0xE2, 0x48, 0x89, 0xD0, 0x48, 0xC1,
+    0xE8, 0x0B, 0x48, 0x01, 0xD8, 0x48, 0x83, 0xC0,
+    0x01, 0x48, 0x8B, 0x5D, 0xF8, 0xC9, 0xC3, 0x55,
+    0x48, 0x89, 0xE5, 0x0F, 0xB6, 0x05, 0x6E, 0x11,
+    0x00, 0x00, 0x5D, 0xC3, 0x55, 0x48, 0x89, 0xE5,
+    0x0F, 0x01, 0xF9, 0x89, 0x45, 0xFC, 0x89, 0x55,
+    0xF8, 0x8B, 0x45, 0xFC, 0x8B, 0x55, 0xF8, 0x48,
+    0xC1, 0xE2, 0x20, 0x48, 0x09, 0xD0, 0x5D, 0xC3,
+    0x55, 0x48, 0x89, 0xE5, 0x0F, 0x31, 0x89, 0x45,
+    0xFC, 0x89, 0x55, 0xF8, 0x8B, 0x45, 0xFC, 0x8B,
+    0x55, 0xF8, 0x48, 0xC1, 0xE2, 0x20, 0x48, 0x09,
+    0xD0, 0x5D, 0xC3, 0x55, 0x48, 0x89, 0xE5, 0xE8,
+    0xB3, 0xFF, 0xFF, 0xFF, 0x84, 0xC0, 0x74, 0x07,
+    0xE8, 0xB7, 0xFF, 0xFF, 0xFF, 0xEB, 0x05, 0xE8,
+    0xCC, 0xFF, 0xFF, 0xFF, 0x5D, 0xC3, 0x55, 0x48,
+    0x89, 0xE5, 0x41, 0x57, 0x41, 0x56, 0x41, 0x55,
+    0x41, 0x54, 0x48, 0x83, 0xEC, 0x30, 0x48, 0x89,
+    0x7D, 0xB8, 0x48, 0x8B, 0x45, 0xB8, 0x8B, 0x00,
+    0x83, 0xE0, 0xFE, 0x89, 0x45, 0xD4, 0x0F, 0xAE,
+    0xE8, 0x90, 0xE8, 0xBC, 0xFF, 0xFF, 0xFF, 0x48,
+    0x89, 0xC2, 0x48, 0x8B, 0x45, 0xB8, 0x48, 0x8B,
+    0x40, 0x08, 0x48, 0x29, 0xC2, 0x48, 0x89, 0x55,
+    0xD8, 0x48, 0x8B, 0x45, 0xB8, 0x0F, 0xB6, 0x40,
+    0x1C, 0x84, 0xC0, 0x79, 0x15, 0x48, 0x8B, 0x45,
+    0xB8, 0x0F, 0xB6, 0x40, 0x1C, 0x0F, 0xBE, 0xC0,
+    0xF7, 0xD8, 0x89, 0xC1, 0x48, 0xD3, 0x6D, 0xD8,
+    0xEB, 0x11, 0x48, 0x8B, 0x45, 0xB8, 0x0F, 0xB6,
+    0x40, 0x1C, 0x0F, 0xBE, 0xC0, 0x89, 0xC1, 0x48,
+    0xD3, 0x65, 0xD8, 0x48, 0x8B, 0x45, 0xB8, 0x48,
+    0x8B, 0x48, 0x10, 0x48, 0x8B, 0x45, 0xD8, 0x49,
+    0x89, 0xC4, 0x41, 0xBD, 0x00, 0x00, 0x00, 0x00,
+    0x48, 0x8B, 0x45, 0xB8, 0x8B, 0x40, 0x18, 0x89,
+    0xC0, 0x49, 0x89, 0xC6, 0x41, 0xBF, 0x00, 0x00,
+    0x00, 0x00, 0x4C, 0x89, 0xEA, 0x49, 0x0F, 0xAF,
+    0xD6, 0x4C, 0x89, 0xF8, 0x49, 0x0F, 0xAF, 0xC4,
+    0x48, 0x8D, 0x34, 0x02, 0x4C, 0x89, 0xE0, 0x49,
+    0xF7, 0xE6, 0x48, 0x01, 0xD6, 0x48, 0x89, 0xF2,
+    0x48, 0x0F, 0xAC, 0xD0, 0x20, 0x48, 0xC1, 0xEA,
+    0x20, 0x48, 0x01, 0xC8, 0x48, 0x89, 0x45, 0xC8,
+    0x0F, 0xAE, 0xE8, 0x90, 0x48, 0x8B, 0x45, 0xB8,
+    0x8B, 0x00, 0x39, 0x45, 0xD4, 0x0F, 0x85, 0x3F,
+    0xFF, 0xFF, 0xFF, 0x48, 0x8B, 0x45, 0xC8, 0x48,
+    0x83, 0xC4, 0x30, 0x41, 0x5C, 0x41, 0x5D, 0x41,
+    0x5E, 0x41, 0x5F, 0x5D, 0xC3, 0x55, 0x48, 0x89,
+    0xE5, 0x48, 0x8B, 0x05, 0xF0, 0x0F, 0x00, 0x00,
+    0x48, 0x8D, 0x15, 0x59, 0x1F, 0x00, 0x00, 0x48,
+    0x01, 0xD0, 0x48, 0x89, 0xC7, 0xE8, 0xFC, 0xFE,
+    0xFF, 0xFF, 0x48, 0x89, 0xC7, 0xE8, 0x0B, 0xFE,
+    0xFF, 0xFF, 0x5D, 0xC3, 0x55, 0x48, 0x89, 0xE5,
+    0x48, 0xC7, 0xC0, 0xFF, 0xFF, 0xFF, 0xFF, 0x5D,
+    0xC3, 0x55, 0x48, 0x89, 0xE5, 0x89, 0x7D, 0xFC,
+    0x83, 0x7D, 0xFC, 0x03, 0x75, 0x09, 0x48, 0x8D,
+    0x05, 0xB8, 0xFF, 0xFF, 0xFF, 0xEB, 0x07, 0x48,
+    0x8D, 0x05, 0xD6, 0xFF, 0xFF, 0xFF, 0x5D, 0xC3,
+    0x55, 0x48, 0x89, 0xE5, 0x48, 0x83, 0xEC, 0x30,
+    0x89, 0x7D, 0xDC, 0x48, 0xC7, 0x45, 0xF8, 0xFF,
+    0xFF, 0xFF, 0xFF, 0x48, 0xC7, 0x45, 0xF0, 0x00,
+    0x00, 0x00, 0x00, 0x48, 0xC7, 0x45, 0xE8, 0x00,
+    0x00, 0x00, 0x00, 0x48, 0x8B, 0x05, 0x86, 0x0F,
+    0x00, 0x00, 0x48, 0x83, 0xE0, 0xFE, 0x48, 0x89,
+    0x45, 0xE0, 0x83, 0x7D, 0xDC, 0x07, 0x0F, 0x97,
+    0xC0, 0x84, 0xC0, 0x0F, 0x85, 0xC6, 0x00, 0x00,
+    0x00, 0x8B, 0x45, 0xDC, 0xBA, 0x01, 0x00, 0x00,
+    0x00, 0x89, 0xC1, 0x48, 0xD3, 0xE2, 0x48, 0x89,
+    0xD0, 0x48, 0x89, 0xC2, 0x81, 0xE2, 0xD2, 0x00,
+    0x00, 0x00, 0x48, 0x85, 0xD2, 0x0F, 0x95, 0xC2,
+    0x84, 0xD2, 0x75, 0x12, 0x83, 0xE0, 0x21, 0x48,
+    0x85, 0xC0, 0x0F, 0x95, 0xC0, 0x84, 0xC0, 0x75,
+    0x3D, 0xE9, 0x91, 0x00, 0x00, 0x00, 0x8B, 0x05,
+    0x1C, 0x0F, 0x00, 0x00, 0x89, 0xC7, 0xE8, 0x5E,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xD0, 0x48, 0x89, 0x45,
+    0xF8, 0x83, 0x7D, 0xDC, 0x04, 0x74, 0x7B, 0x48,
+    0x8B, 0x05, 0x22, 0x0F, 0x00, 0x00, 0x48, 0x8B,
+    0x55, 0xF8, 0x48, 0x29, 0xC2, 0x48, 0x89, 0xD0,
+    0x48, 0x89, 0xC7, 0xE8, 0x87, 0xFC, 0xFF, 0xFF,
+    0x48, 0x89, 0x45, 0xF0, 0xEB, 0x5D, 0x8B, 0x05,
+    0xE4, 0x0E, 0x00, 0x00, 0x89, 0xC7, 0xE8, 0x26,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xD0, 0x48, 0x89, 0x45,
+    0xF8, 0x48, 0x8B, 0x05, 0xD8, 0x0E, 0x00, 0x00,
+    0x48, 0x89, 0x45, 0xF0, 0x48, 0x8B, 0x05, 0xE5,
+    0x0E, 0x00, 0x00, 0x48, 0x8B, 0x55, 0xF8, 0x48,
+    0x29, 0xC2, 0x48, 0x89, 0x55, 0xE8, 0x48, 0x8B,
+    0x45, 0xE8, 0x48, 0x89, 0xC7, 0xE8, 0x45, 0xFC,
+    0xFF, 0xFF, 0x48, 0x01, 0x45, 0xF0, 0x48, 0x8B,
+    0x55, 0xE8, 0x48, 0x8B, 0x45, 0xF8, 0x48, 0x89,
+    0xD6, 0x48, 0x89, 0xC7, 0xE8, 0x48, 0xFC, 0xFF,
+    0xFF, 0x48, 0x01, 0x45, 0xF0, 0xEB, 0x04, 0x90,
+    0xEB, 0x01, 0x90, 0x0F, 0xAE, 0xE8, 0x90, 0x48,
+    0x8B, 0x05, 0x9A, 0x0E, 0x00, 0x00, 0x48, 0x39,
+    0x45, 0xE0, 0x0F, 0x85, 0x03, 0xFF, 0xFF, 0xFF,
+    0x48, 0x83, 0x7D, 0xF8, 0xFF, 0x75, 0x09, 0x48,
+    0xC7, 0xC0, 0xFF, 0xFF, 0xFF, 0xFF, 0xEB, 0x0B,
+    0x48, 0x8B, 0x55, 0xF8, 0x48, 0x8B, 0x45, 0xF0,
+    0x48, 0x01, 0xD0, 0xC9, 0xC3, 0x55, 0x48, 0x89,
+    0xE5, 0x48, 0x89, 0x7D, 0xF8, 0x48, 0x89, 0x75,
+    0xF0, 0x0F, 0xB6, 0x05, 0x90, 0x0E, 0x00, 0x00,
+    0x84, 0xC0, 0x74, 0x28, 0x48, 0x83, 0x7D, 0xF8,
+    0x00, 0x74, 0x09, 0x0F, 0x01, 0xF9, 0x48, 0x8B,
+    0x45, 0xF8, 0x89, 0x08, 0x48, 0x83, 0x7D, 0xF0,
+    0x00, 0x74, 0x0A, 0x48, 0x8B, 0x45, 0xF0, 0xC7,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0xB8, 0x00, 0x00,
+    0x00, 0x00, 0xEB, 0x05, 0xB8, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x5D, 0xC3, 0x47, 0x43, 0x43, 0x3A, 0x20,
+    0x28, 0x44, 0x65, 0x62, 0x69, 0x61, 0x6E, 0x20,
+    0x31, 0x32, 0x2E, 0x32, 0x2E, 0x30, 0x2D, 0x31,
+    0x34, 0x2B, 0x64, 0x65, 0x62, 0x31, 0x32, 0x75,
+    0x31, 0x29, 0x20, 0x31, 0x32, 0x2E, 0x32, 0x2E,
+    0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x04, 0x00, 0xF1, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0xE4, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1A, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0xF4, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x19, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x06, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x2D, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x4E, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x41, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x96, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x41, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x53, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0xD7, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x42, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x66, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x19, 0x0B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x77, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x2B, 0x0B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x28, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x8E, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x53, 0x0B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x2B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xA4, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x7E, 0x0B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x27, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xB2, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0xA5, 0x0B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x51, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xC8, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0xF6, 0x0B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xDD, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x4A, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x5A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xEC, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0xA4, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x57, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xF9, 0x00, 0x00, 0x00, 0x04, 0x00, 0xF1, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x04, 0x01, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x17, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x16, 0x01, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x31, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x82, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x11, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0xB3, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x29, 0x01, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0xC5, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x8A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x35, 0x01, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x4F, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x56, 0x01, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x5C, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x5E, 0x01, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x78, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x5F, 0x01, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x93, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x65, 0x01, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x95, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x27, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x76, 0x01, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0xBC, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x84, 0x01, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0xC9, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0xF1, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x94, 0x01, 0x00, 0x00, 0x00, 0x00, 0x0A, 0x00,
+    0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x9E, 0x01, 0x00, 0x00, 0x01, 0x00, 0x05, 0x00,
+    0xC0, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xA7, 0x01, 0x00, 0x00, 0x00, 0x00, 0xF1, 0xFF,
+    0x00, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xB4, 0x01, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0xE8, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x3D, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x14, 0x02, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0x25, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x46, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xBD, 0x01, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00,
+    0x10, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xD0, 0x01, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00,
+    0xAE, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xE7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xE4, 0x01, 0x00, 0x00, 0x00, 0x00, 0xF1, 0xFF,
+    0x80, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x80, 0x00, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0x1D, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xF4, 0x01, 0x00, 0x00, 0x11, 0x00, 0xF1, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xFE, 0x01, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0x3F, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x25, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x12, 0x02, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0x89, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x2D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x97, 0x00, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0x64, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x25, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xAD, 0x00, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0xFD, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x19, 0x02, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0xB6, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x2D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x20, 0x02, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0xFB, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x35, 0x02, 0x00, 0x00, 0x12, 0x00, 0x0A, 0x00,
+    0xE3, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x76, 0x64, 0x73, 0x6F, 0x2E, 0x63, 0x00,
+    0x74, 0x72, 0x75, 0x6E, 0x63, 0x61, 0x74, 0x65,
+    0x5F, 0x73, 0x65, 0x63, 0x6F, 0x6E, 0x64, 0x73,
+    0x00, 0x6E, 0x73, 0x65, 0x63, 0x5F, 0x66, 0x72,
+    0x6F, 0x6D, 0x5F, 0x74, 0x69, 0x6D, 0x65, 0x73,
+    0x74, 0x61, 0x6D, 0x70, 0x00, 0x75, 0x73, 0x65,
+    0x63, 0x5F, 0x66, 0x72, 0x6F, 0x6D, 0x5F, 0x74,
+    0x69, 0x6D, 0x65, 0x73, 0x74, 0x61, 0x6D, 0x70,
+    0x00, 0x74, 0x69, 0x6D, 0x65, 0x76, 0x61, 0x6C,
+    0x5F, 0x66, 0x72, 0x6F, 0x6D, 0x5F, 0x74, 0x69,
+    0x6D, 0x65, 0x00, 0x74, 0x69, 0x6D, 0x65, 0x73,
+    0x70, 0x65, 0x63, 0x5F, 0x66, 0x72, 0x6F, 0x6D,
+    0x5F, 0x74, 0x69, 0x6D, 0x65, 0x00, 0x74, 0x69,
+    0x6D, 0x65, 0x5F, 0x74, 0x5F, 0x66, 0x72, 0x6F,
+    0x6D, 0x5F, 0x74, 0x69, 0x6D, 0x65, 0x00, 0x66,
+    0x61, 0x6C, 0x6C, 0x62, 0x61, 0x63, 0x6B, 0x5F,
+    0x63, 0x6C, 0x6F, 0x63, 0x6B, 0x5F, 0x67, 0x65,
+    0x74, 0x74, 0x69, 0x6D, 0x65, 0x00, 0x66, 0x61,
+    0x6C, 0x6C, 0x62, 0x61, 0x63, 0x6B, 0x5F, 0x67,
+    0x65, 0x74, 0x74, 0x69, 0x6D, 0x65, 0x6F, 0x66,
+    0x64, 0x61, 0x79, 0x00, 0x66, 0x61, 0x6C, 0x6C,
+    0x62, 0x61, 0x63, 0x6B, 0x5F, 0x74, 0x69, 0x6D,
+    0x65, 0x00, 0x64, 0x6F, 0x5F, 0x76, 0x64, 0x73,
+    0x6F, 0x5F, 0x63, 0x6C, 0x6F, 0x63, 0x6B, 0x5F,
+    0x67, 0x65, 0x74, 0x74, 0x69, 0x6D, 0x65, 0x00,
+    0x64, 0x6F, 0x5F, 0x76, 0x64, 0x73, 0x6F, 0x5F,
+    0x67, 0x65, 0x74, 0x74, 0x69, 0x6D, 0x65, 0x6F,
+    0x66, 0x64, 0x61, 0x79, 0x00, 0x64, 0x6F, 0x5F,
+    0x76, 0x64, 0x73, 0x6F, 0x5F, 0x67, 0x65, 0x74,
+    0x63, 0x70, 0x75, 0x00, 0x64, 0x6F, 0x5F, 0x76,
+    0x64, 0x73, 0x6F, 0x5F, 0x74, 0x69, 0x6D, 0x65,
+    0x00, 0x76, 0x64, 0x73, 0x6F, 0x2D, 0x6E, 0x6F,
+    0x77, 0x2E, 0x63, 0x00, 0x63, 0x6C, 0x6F, 0x63,
+    0x6B, 0x5F, 0x66, 0x72, 0x65, 0x71, 0x5F, 0x61,
+    0x64, 0x6A, 0x75, 0x73, 0x74, 0x00, 0x63, 0x6C,
+    0x6F, 0x63, 0x6B, 0x5F, 0x70, 0x68, 0x61, 0x73,
+    0x65, 0x5F, 0x61, 0x64, 0x6A, 0x75, 0x73, 0x74,
+    0x00, 0x6E, 0x61, 0x6E, 0x6F, 0x73, 0x65, 0x63,
+    0x6F, 0x6E, 0x64, 0x73, 0x00, 0x70, 0x6C, 0x61,
+    0x74, 0x66, 0x6F, 0x72, 0x6D, 0x5F, 0x68, 0x61,
+    0x73, 0x5F, 0x70, 0x72, 0x65, 0x63, 0x69, 0x73,
+    0x65, 0x5F, 0x63, 0x6C, 0x6F, 0x63, 0x6B, 0x73,
+    0x6F, 0x75, 0x72, 0x63, 0x65, 0x00, 0x5F, 0x72,
+    0x64, 0x74, 0x73, 0x63, 0x70, 0x00, 0x5F, 0x72,
+    0x64, 0x74, 0x73, 0x63, 0x00, 0x76, 0x64, 0x73,
+    0x6F, 0x5F, 0x6E, 0x6F, 0x77, 0x5F, 0x70, 0x76,
+    0x63, 0x6C, 0x6F, 0x63, 0x6B, 0x00, 0x76, 0x64,
+    0x73, 0x6F, 0x5F, 0x6E, 0x6F, 0x77, 0x5F, 0x6E,
+    0x6F, 0x6E, 0x65, 0x00, 0x76, 0x64, 0x73, 0x6F,
+    0x5F, 0x67, 0x65, 0x74, 0x5F, 0x6E, 0x6F, 0x77,
+    0x5F, 0x66, 0x6E, 0x00, 0x76, 0x76, 0x61, 0x72,
+    0x5F, 0x70, 0x61, 0x67, 0x65, 0x00, 0x5F, 0x44,
+    0x59, 0x4E, 0x41, 0x4D, 0x49, 0x43, 0x00, 0x70,
+    0x76, 0x63, 0x6C, 0x6F, 0x63, 0x6B, 0x5F, 0x70,
+    0x61, 0x67, 0x65, 0x00, 0x76, 0x64, 0x73, 0x6F,
+    0x5F, 0x6E, 0x6F, 0x77, 0x00, 0x5F, 0x5F, 0x47,
+    0x4E, 0x55, 0x5F, 0x45, 0x48, 0x5F, 0x46, 0x52,
+    0x41, 0x4D, 0x45, 0x5F, 0x48, 0x44, 0x52, 0x00,
+    0x76, 0x64, 0x73, 0x6F, 0x5F, 0x70, 0x76, 0x63,
+    0x6C, 0x6F, 0x63, 0x6B, 0x5F, 0x6E, 0x6F, 0x77,
+    0x5F, 0x6E, 0x73, 0x00, 0x5F, 0x5F, 0x76, 0x64,
+    0x73, 0x6F, 0x5F, 0x76, 0x64, 0x73, 0x6F, 0x5F,
+    0x64, 0x61, 0x74, 0x00, 0x4C, 0x49, 0x4E, 0x55,
+    0x58, 0x5F, 0x32, 0x2E, 0x36, 0x00, 0x5F, 0x5F,
+    0x76, 0x64, 0x73, 0x6F, 0x5F, 0x67, 0x65, 0x74,
+    0x74, 0x69, 0x6D, 0x65, 0x6F, 0x66, 0x64, 0x61,
+    0x79, 0x00, 0x5F, 0x5F, 0x76, 0x64, 0x73, 0x6F,
+    0x5F, 0x67, 0x65, 0x74, 0x63, 0x70, 0x75, 0x00,
+    0x5F, 0x5F, 0x76, 0x64, 0x73, 0x6F, 0x5F, 0x63,
+    0x6C, 0x6F, 0x63, 0x6B, 0x5F, 0x67, 0x65, 0x74,
+    0x74, 0x69, 0x6D, 0x65, 0x00, 0x5F, 0x5F, 0x76,
+    0x64, 0x73, 0x6F, 0x5F, 0x74, 0x69, 0x6D, 0x65,
+    0x00, 0x00, 0x2E, 0x73, 0x79, 0x6D, 0x74, 0x61,
+    0x62, 0x00, 0x2E, 0x73, 0x74, 0x72, 0x74, 0x61,
+    0x62, 0x00, 0x2E, 0x73, 0x68, 0x73, 0x74, 0x72,
+    0x74, 0x61, 0x62, 0x00, 0x2E, 0x67, 0x6E, 0x75,
+    0x2E, 0x68, 0x61, 0x73, 0x68, 0x00, 0x2E, 0x64,
+    0x79, 0x6E, 0x73, 0x79, 0x6D, 0x00, 0x2E, 0x64,
+    0x79, 0x6E, 0x73, 0x74, 0x72, 0x00, 0x2E, 0x64,
+    0x79, 0x6E, 0x61, 0x6D, 0x69, 0x63, 0x00, 0x2E,
+    0x67, 0x6E, 0x75, 0x2E, 0x76, 0x65, 0x72, 0x73,
+    0x69, 0x6F, 0x6E, 0x00, 0x2E, 0x67, 0x6E, 0x75,
+    0x2E, 0x76, 0x65, 0x72, 0x73, 0x69, 0x6F, 0x6E,
+    0x5F, 0x64, 0x00, 0x2E, 0x65, 0x68, 0x5F, 0x66,
+    0x72, 0x61, 0x6D, 0x65, 0x5F, 0x68, 0x64, 0x72,
+    0x00, 0x2E, 0x65, 0x68, 0x5F, 0x66, 0x72, 0x61,
+    0x6D, 0x65, 0x00, 0x2E, 0x74, 0x65, 0x78, 0x74,
+    0x00, 0x2E, 0x63, 0x6F, 0x6D, 0x6D, 0x65, 0x6E,
+    0x74, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1F, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xE8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xE8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1B, 0x00, 0x00, 0x00, 0xF6, 0xFF, 0xFF, 0x6F,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x28, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x28, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x25, 0x00, 0x00, 0x00, 0x0B, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x70, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x70, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x2D, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x60, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x60, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x5A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x35, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xC0, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xC0, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x3E, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x6F,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xC0, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xC0, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x4B, 0x00, 0x00, 0x00, 0xFD, 0xFF, 0xFF, 0x6F,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xD8, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xD8, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x5A, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x10, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x10, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x2C, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x68, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x40, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x40, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xA4, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x72, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xE4, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xE4, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x87, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x78, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x6B, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x27, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x98, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x50, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x0D, 0x00, 0x00, 0x00, 0x25, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x09, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xE8, 0x16, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x41, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x11, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x29, 0x19, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x81, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+const unsigned long vdso_raw_length = 8192;
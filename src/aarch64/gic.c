@@ -322,7 +322,9 @@ void dev_irq_disable(u32 dev_id, int vector)
     }
 }
 
-void msi_format(u32 *address, u32 *data, int vector)
+/* MSIs are routed to cpu 0 regardless of target_cpu: steering them would
+   require remapping the ITS collection or the SPI target of each vector. */
+void msi_format(u32 *address, u32 *data, int vector, u32 target_cpu)
 {
     if (gic.its_base) {
         *address = gic.its_base + GITS_TRANSLATER - DEVICE_BASE;
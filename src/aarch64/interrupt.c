@@ -201,7 +201,7 @@ NOTRACE
 void synchronous_handler(void)
 {
     cpuinfo ci = current_cpu();
-    bitmap_set_atomic(idle_cpu_mask, ci->id, 0);
+    cpu_clear_idle(ci);
     context ctx = get_current_context(ci);
     context_frame f = ctx->frame;
     u32 esr = esr_from_frame(f);
@@ -253,7 +253,7 @@ NOTRACE
 void irq_handler(void)
 {
     cpuinfo ci = current_cpu();
-    bitmap_set_atomic(idle_cpu_mask, ci->id, 0);
+    cpu_clear_idle(ci);
     context ctx = get_current_context(ci);
     context_frame f = ctx->frame;
     u64 i;
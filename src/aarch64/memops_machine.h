@@ -0,0 +1,37 @@
+/* Zeroing with dc zva for runtime memops, selected once by init_memops().
+   The kernel is built without FP/SIMD, so copies stay with the generic word
+   loops (which the compiler turns into ldp/stp); zero fills of whole,
+   aligned zva blocks, such as page clearing, are done a block at a time. */
+#ifndef BOOT
+#define ARCH_MEMOPS
+
+#define ARCH_MEMOPS_ZVA_MIN 256
+
+#define DCZID_EL0_DZP       (1 << 4)
+#define DCZID_EL0_BS_MASK   0xf
+
+/* Returns the dc zva block size, or 0 if dc zva is prohibited. */
+static inline u32 arch_memops_features(void)
+{
+    u64 dczid;
+    asm volatile("mrs %0, dczid_el0" : "=r" (dczid));
+    if (dczid & DCZID_EL0_DZP)
+        return 0;
+    return 4 << (dczid & DCZID_EL0_BS_MASK);
+}
+
+static inline boolean arch_memcpy(void *dst, const void *src, bytes len, u32 zva_size)
+{
+    return false;
+}
+
+static inline boolean arch_memset(void *dst, u8 c, bytes len, u32 zva_size)
+{
+    if (c || !zva_size || (len < ARCH_MEMOPS_ZVA_MIN) ||
+        ((u64_from_pointer(dst) | len) & (zva_size - 1)))
+        return false;
+    for (void *end = dst + len; dst < end; dst += zva_size)
+        asm volatile("dc zva, %0" : : "r" (dst) : "memory");
+    return true;
+}
+#endif
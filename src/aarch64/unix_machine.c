@@ -289,7 +289,6 @@ void register_other_syscalls(struct syscall *map)
     register_syscall(map, sched_setattr, 0, 0);
     register_syscall(map, sched_getattr, 0, 0);
     register_syscall(map, seccomp, 0, 0);
-    register_syscall(map, memfd_create, 0, 0);
     register_syscall(map, kexec_file_load, 0, 0);
     register_syscall(map, bpf, 0, 0);
     register_syscall(map, execveat, 0, 0);
@@ -33,7 +33,12 @@
 /* per-cpu queue */
 #define CPU_QUEUE_SIZE 512
 
-/* general scheduling queues */
+/* per-cpu deferred work queues */
+#define CPU_BHQUEUE_SIZE       2048
+#define CPU_RUNQUEUE_SIZE      2048
+#define CPU_ASYNC_QUEUE_1_SIZE 16384
+
+/* general scheduling queues, also taking overflow from the per-cpu queues */
 #define BHQUEUE_SIZE       8192
 #define RUNQUEUE_SIZE      8192
 #define ASYNC_QUEUE_1_SIZE 65536
@@ -48,6 +53,9 @@
 #define TFS_LOG_INITIAL_SIZE           SECTOR_SIZE
 #define TFS_LOG_DEFAULT_EXTENSION_SIZE (512*KB)
 #define TFS_LOG_FLUSH_DELAY_SECONDS 1
+/* Size of log reads at mount; extensions that follow the one being read are
+ * picked up by the same request. */
+#define TFS_LOG_READ_AHEAD_SIZE (4*MB)
 /* Minimum number of obsolete log entries needed to trigger a log compaction. */
 #define TFS_LOG_COMPACT_OBSOLETE   8192
 /* Log compaction is not triggered if the ratio between total entries and
@@ -67,6 +75,10 @@
 #define LOW_MEMORY_THRESHOLD   (64 * MB)
 #define SG_FRAG_BYTE_THRESHOLD (128*KB)
 
+/* upper bounds for requests merged by the storage queues; drivers may lower them */
+#define STORAGE_MERGE_MAX_BYTES (512 * KB)
+#define STORAGE_MERGE_MAX_SEGS  128
+
 /* don't go below this minimum amount of physical memory when inflating balloon */
 #define BALLOON_MEMORY_MINIMUM (16 * MB)
 
@@ -69,9 +69,16 @@ typedef struct hyperv_platform_info {
 
     vmbus_dev vmbus;
 
+    boolean tlb_flush;          /* remote TLB flush hypercall in use */
     boolean initialized;
 } *hyperv_platform_info;
 
+typedef struct hyperv_percpu {
+    u32 vp_index;
+    struct hypercall_flush_va_space_in *flush_in;
+    u64 flush_in_paddr;
+} *hyperv_percpu;
+
 BSS_RO_AFTER_INIT struct hyperv_platform_info hyperv_info;
 
 u64
@@ -210,6 +217,64 @@ closure_function(0, 0, timestamp, hyperv_clock_now)
     return nanoseconds(hyperv_info.hyperv_tc64() * HYPERV_TIMER_NS_FACTOR);
 }
 
+closure_function(0, 0, void, hyperv_percpu_init)
+{
+    cpuinfo ci = current_cpu();
+    hyperv_percpu hp = allocate(heap_locked(get_kernel_heaps()), sizeof(*hp));
+    assert(hp != INVALID_ADDRESS);
+    hp->vp_index = read_msr(MSR_HV_VP_INDEX);
+    hp->flush_in = allocate(hyperv_info.contiguous, PAGESIZE);
+    assert(hp->flush_in != INVALID_ADDRESS);
+    hp->flush_in_paddr = physical_from_virtual(hp->flush_in);
+    ci->m.hypervisor_data = hp;
+}
+
+/* Flush the TLBs of all target cpus with a single hypercall instead of
+   sending IPIs. Only VP indices below 64 fit in the basic (non-sparse) processor mask. */
+closure_function(0, 2, void, hyperv_remote_tlb_flush,
+                 u64 *, cpus, u64, ncpus)
+{
+    hyperv_percpu hp = current_cpu()->m.hypervisor_data;
+    if (!hp)
+        return;
+    struct hypercall_flush_va_space_in *in = hp->flush_in;
+    in->fva_address_space = 0;
+    in->fva_flags = HV_FLUSH_ALL_VA_SPACES;
+    in->fva_processor_mask = 0;
+    for (u64 cpu = 0; cpu < ncpus; cpu++) {
+        if (!(cpus[cpu >> 6] & U64_FROM_BIT(cpu & 63)))
+            continue;
+        hyperv_percpu target = cpuinfo_from_id(cpu)->m.hypervisor_data;
+        if (!target || target->vp_index >= 64)
+            return;
+        in->fva_processor_mask |= U64_FROM_BIT(target->vp_index);
+    }
+    u64 status = hypercall_md(hyperv_info.hypercall_context.hc_addr,
+                              HYPERCALL_FLUSH_VA_SPACE, hp->flush_in_paddr, 0);
+    if ((status & 0xffff) != HYPERCALL_STATUS_SUCCESS) {
+        hyperv_debug("flush hypercall failed, status 0x%lx", status);
+        return;
+    }
+    zero(cpus, pad(ncpus, 64) >> 3);
+}
+
+static void
+hyperv_init_tlb_flush(void)
+{
+    u32 v[4];
+    if (!(hyperv_info.features & CPUID_HV_MSR_VP_INDEX))
+        return;
+    cpuid(CPUID_LEAF_HV_RECOMMENDS, 0, v);
+    if (!(v[0] & CPUID_HV_REMOTE_TLB_FLUSH))
+        return;
+    hyperv_debug("remote TLB flush hypercall recommended");
+    thunk percpu_init = closure(hyperv_info.general, hyperv_percpu_init);
+    assert(percpu_init != INVALID_ADDRESS);
+    apply(percpu_init);
+    register_percpu_init(percpu_init);
+    hyperv_info.tlb_flush = true;
+}
+
 boolean
 hyperv_detect(kernel_heaps kh) {
     u32 v[4];
@@ -266,6 +331,7 @@ hyperv_detect(kernel_heaps kh) {
     }
 
     register_platform_clock_timer(ct, per_cpu_init);
+    hyperv_init_tlb_flush();
     list_init(&hyperv_info.vmbus_list);
     list_init(&hyperv_info.driver_list);
     hyperv_info.initialized = true;
@@ -292,6 +358,8 @@ void
 init_vmbus(kernel_heaps kh)
 {
     hypercall_create();
+    if (hyperv_info.tlb_flush)
+        register_remote_tlb_flush(closure(hyperv_info.general, hyperv_remote_tlb_flush));
 
     status s = vmbus_attach(kh, &hyperv_info.vmbus);
     if (!is_ok(s)) {
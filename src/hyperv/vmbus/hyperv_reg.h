@@ -122,6 +122,8 @@
 #define CPUID3_HV_MSR_CRASH		0x0400	/* MSRs for guest crash */
 
 #define CPUID_LEAF_HV_RECOMMENDS	0x40000004
+/* EAX: recommendations */
+#define CPUID_HV_REMOTE_TLB_FLUSH	0x0004	/* remote TLB flush hypercalls */
 #define CPUID_LEAF_HV_LIMITS		0x40000005
 #define CPUID_LEAF_HV_HWFEATURES	0x40000006
 
@@ -149,6 +151,7 @@ struct hyperv_mon_param {
 /*
  * Hypercall input values
  */
+#define HYPERCALL_FLUSH_VA_SPACE	0x0002
 #define HYPERCALL_POST_MESSAGE		0x005c
 #define HYPERCALL_SIGNAL_EVENT		0x005d
 
@@ -166,6 +169,18 @@ struct hyperv_mon_param {
 #define HYPERCALL_PARAM_SIZE_ALIGN	8
 #endif
 
+/*
+ * HYPERCALL_FLUSH_VA_SPACE
+ */
+#define HV_FLUSH_ALL_PROCESSORS		0x0001
+#define HV_FLUSH_ALL_VA_SPACES		0x0002
+
+struct hypercall_flush_va_space_in {
+	uint64_t	fva_address_space;
+	uint64_t	fva_flags;
+	uint64_t	fva_processor_mask;
+} __packed;
+
 /*
  * HYPERCALL_POST_MESSAGE
  */
@@ -15,6 +15,9 @@ static volatile boolean service_scheduled;
 BSS_RO_AFTER_INIT static thunk flush_service;
 BSS_RO_AFTER_INIT static queue flush_completion_queue;
 static struct rw_spinlock flush_lock;
+BSS_RO_AFTER_INIT static u64 cpu_mask_words;
+static remote_tlb_flush remote_flush;
+static struct flush_stats stats;
 
 static void queue_flush_service(void);
 
@@ -28,6 +31,8 @@ struct flush_entry {
     boolean flush;
     u64 pages[FLUSH_THRESHOLD];
     int npages;
+    u64 *targets;       /* cpus that still hold a reference */
+    u64 *ipis;          /* scratch mask for page_invalidate_sync() */
     status_handler completion;
     closure_struct(flush_complete, finish);
 };
@@ -48,6 +53,7 @@ static void _flush_handler(void)
     spin_rlock(&flush_lock);
     while (ci->inval_gen != inval_gen) {
         word oldgen = ci->inval_gen;
+        word found = 0;
         ci->inval_gen = inval_gen;
         list_foreach(&entries, l) {
             flush_entry f = struct_from_list(l, flush_entry, l);
@@ -55,6 +61,7 @@ static void _flush_handler(void)
                 continue;
             if (f->gen > ci->inval_gen)
                 break;
+            found++;
             if (!full_flush) {
                 if (f->flush)
                     full_flush = true;
@@ -63,8 +70,15 @@ static void _flush_handler(void)
                         invalidate(f->pages[i]);
                 }
             }
-            refcount_release(&f->ref);
+            /* The issuing cpu may have released the reference on our behalf. */
+            if (atomic_test_and_clear_bit(&f->targets[ci->id >> 6], ci->id & 63))
+                refcount_release(&f->ref);
         }
+
+        /* Entries may have been retired while this cpu was idle or being
+           flushed by the hypervisor, in which case their pages are unknown. */
+        if (found != ci->inval_gen - oldgen)
+            full_flush = true;
     }
     spin_runlock(&flush_lock);
 
@@ -137,6 +151,69 @@ static void queue_flush_service(void)
     }
 }
 
+static inline void cpu_mask_set(u64 *mask, u64 cpu)
+{
+    mask[cpu >> 6] |= U64_FROM_BIT(cpu & 63);
+}
+
+static inline boolean cpu_mask_get(u64 *mask, u64 cpu)
+{
+    return (mask[cpu >> 6] & U64_FROM_BIT(cpu & 63)) != 0;
+}
+
+/* Interrupt only the cpus that may be using stale TLB entries. An idle cpu
+   catches up with pending invalidations when it wakes up (see
+   cpu_clear_idle()), and a cpu may have been flushed by the hypervisor; the
+   references of these cpus are released here. Called with interrupts
+   disabled, after the entry has been published. */
+static void flush_remote_cpus(flush_entry f, u64 ncpus)
+{
+    if (ncpus == 1)
+        return;
+    u64 self = current_cpu()->id;
+    u64 *ipis = f->ipis;
+    u64 nipis = 0;
+    zero(ipis, cpu_mask_words * sizeof(u64));
+    for (u64 cpu = 0; cpu < ncpus; cpu++) {
+        if (cpu == self)
+            continue;
+        if (bitmap_get(idle_cpu_mask, cpu)) {
+            fetch_and_add(&stats.idle_skipped, 1);
+            continue;
+        }
+        cpu_mask_set(ipis, cpu);
+        nipis++;
+    }
+    fetch_and_add(&stats.shootdowns, 1);
+    if (nipis > 0 && remote_flush) {
+        apply(remote_flush, ipis, ncpus);
+        u64 n = 0;
+        for (u64 cpu = 0; cpu < ncpus; cpu++) {
+            if (cpu_mask_get(ipis, cpu))
+                n++;
+        }
+        fetch_and_add(&stats.pv_flushed, nipis - n);
+        nipis = n;
+    }
+    for (u64 cpu = 0; cpu < ncpus; cpu++) {
+        if (cpu == self || cpu_mask_get(ipis, cpu))
+            continue;
+        if (atomic_test_and_clear_bit(&f->targets[cpu >> 6], cpu & 63))
+            refcount_release(&f->ref);
+    }
+    if (nipis == 0)
+        return;
+    fetch_and_add(&stats.ipis, nipis);
+    if (nipis == ncpus - 1) {
+        send_ipi(TARGET_EXCLUSIVE_BROADCAST, flush_ipi);
+    } else {
+        for (u64 cpu = 0; cpu < ncpus; cpu++) {
+            if (cpu_mask_get(ipis, cpu))
+                send_ipi(cpu, flush_ipi);
+        }
+    }
+}
+
 /* N.B. It is possible for the completion to be run with flush_lock held in
  * low flush resource situations, so it must not invoke operations that
  * could call page_invalidate_sync again or else face deadlock.
@@ -152,7 +229,10 @@ void page_invalidate_sync(flush_entry f, status_handler completion)
             }
             return;
         }
-        init_refcount(&f->ref, total_processors, init_closure(&f->finish, flush_complete, f));
+        u64 ncpus = total_processors;
+        init_refcount(&f->ref, ncpus, init_closure(&f->finish, flush_complete, f));
+        for (u64 cpu = 0; cpu < ncpus; cpu++)
+            cpu_mask_set(f->targets, cpu);
         f->completion = completion;
 
         u64 flags = irq_disable_save();
@@ -177,7 +257,7 @@ void page_invalidate_sync(flush_entry f, status_handler completion)
         f->gen = fetch_and_add((word *)&inval_gen, 1) + 1;
         spin_wunlock(&flush_lock);
 
-        send_ipi(TARGET_EXCLUSIVE_BROADCAST, flush_ipi);
+        flush_remote_cpus(f, ncpus);
         _flush_handler();
         irq_restore(flags);
     } else {
@@ -206,10 +286,25 @@ flush_entry get_page_flush_entry(void)
         kern_pause();
 
     assert(fe != INVALID_ADDRESS);
+    u64 *targets = fe->targets;
+    u64 *ipis = fe->ipis;
     runtime_memset((void *)fe, 0, sizeof(*fe));
+    fe->targets = targets;
+    fe->ipis = ipis;
+    zero(targets, cpu_mask_words * sizeof(u64));
     return fe;
 }
 
+void register_remote_tlb_flush(remote_tlb_flush rf)
+{
+    remote_flush = rf;
+}
+
+void page_invalidate_get_stats(flush_stats s)
+{
+    runtime_memcpy(s, &stats, sizeof(*s));
+}
+
 void init_flush(heap h)
 {
     flush_ipi = allocate_ipi_interrupt();
@@ -219,8 +314,15 @@ void init_flush(heap h)
     free_flush_entries = allocate_queue(h, MAX_FLUSH_ENTRIES + 1);
     flush_completion_queue = allocate_queue(h, COMP_QUEUE_SIZE);
     flush_entry fa = allocate(h, sizeof(struct flush_entry) * MAX_FLUSH_ENTRIES);
-    assert(fa);
-    for (flush_entry f = fa; f < fa + MAX_FLUSH_ENTRIES; f++)
+    assert(fa != INVALID_ADDRESS);
+    cpu_mask_words = pad(MAX(present_processors, total_processors), 64) >> 6;
+    u64 *masks = allocate(h, MAX_FLUSH_ENTRIES * 2 * cpu_mask_words * sizeof(u64));
+    assert(masks != INVALID_ADDRESS);
+    for (flush_entry f = fa; f < fa + MAX_FLUSH_ENTRIES; f++) {
+        f->targets = masks;
+        f->ipis = masks + cpu_mask_words;
+        masks += 2 * cpu_mask_words;
         assert(enqueue(free_flush_entries, f));
+    }
     initialized = true;
 }
@@ -0,0 +1,639 @@
+/* Sampling heap profiler
+
+   The general kernel heap (and therefore the locked heap, which wraps it)
+   and the lwIP heap are created with a thin wrapper that forwards to the
+   underlying heap. Once the profiler is enabled, each cpu counts down a
+   randomized budget of allocated bytes, averaging <interval>; the
+   allocation that exhausts the budget records its call stack. A sample
+   stands for max(size, interval) bytes, so per-site totals estimate the
+   real number of bytes allocated and still live.
+
+   Sampled addresses are tracked until freed. The free path consults a
+   table of counters indexed by address hash and only takes the profiler
+   lock if the counter is nonzero, so frees of unsampled objects cost one
+   load. No memory is allocated while sampling; all tables are sized at
+   boot.
+
+   Reports are served over HTTP:
+     /heapprof          call sites sorted by estimated live bytes,
+                        with allocation rates since the last reset
+     /heapprof/folded   live bytes per stack in folded stack format
+     /heapprof/stats, /heapprof/enable, /heapprof/disable, /heapprof/reset
+
+   Manifest configuration:
+     heapprof:(interval:<bytes> sites:<call sites> samples:<tracked samples> disable:t)
+*/
+
+#include <kernel.h>
+#include <net.h>
+#include <http.h>
+#include <symtab.h>
+
+//#define HEAPPROF_DEBUG
+#ifdef HEAPPROF_DEBUG
+#define heapprof_debug(x, ...) do {rprintf("HPROF: " x, ##__VA_ARGS__);} while(0)
+#else
+#define heapprof_debug(x, ...)
+#endif
+
+#define HEAPPROF_HTTP_PORT          9092
+#define HEAPPROF_URI                "heapprof"
+#define HEAPPROF_DEFAULT_INTERVAL   (512 * KB)
+#define HEAPPROF_DEFAULT_SITES      4096
+#define HEAPPROF_DEFAULT_SAMPLES    16384
+#define HEAPPROF_MAX_DEPTH          16
+#define HEAPPROF_MAX_HEAPS          4
+#define HEAPPROF_PROBE_LIMIT        16
+#define HEAPPROF_REPORT_SITES       64
+#define HEAPPROF_REPORT_CALLERS     3
+
+typedef struct heapprof_heap {
+    struct heap h;
+    heap parent;
+    u32 id;
+} *heapprof_heap;
+
+typedef struct heapprof_site {
+    u64 hash;                   /* 0 if unused */
+    u64 alloc_count;            /* estimated, since reset */
+    u64 alloc_bytes;
+    u64 live_count;             /* estimated */
+    u64 live_bytes;
+    u32 heap_id;
+    u32 depth;
+    u64 pcs[HEAPPROF_MAX_DEPTH]; /* leaf first */
+} *heapprof_site;
+
+typedef struct heapprof_sample {
+    u64 addr;                   /* 0 if unused */
+    u64 size;
+    u64 site;
+} *heapprof_sample;
+
+typedef struct heapprof_cpu {
+    s64 budget;
+    u64 rand;
+} *heapprof_cpu;
+
+static struct {
+    heap h;
+    struct spinlock lock;
+    heapprof_cpu cpus;
+    u64 ncpus;
+    u64 interval;
+    heapprof_site sites;
+    u64 nsites;                 /* power of 2 */
+    u64 sites_used;
+    heapprof_sample samples;
+    u64 nsamples;               /* power of 2 */
+    u64 samples_live;
+    u16 *filter;                /* live samples per address hash bucket */
+    u64 filter_mask;
+    u64 sample_count;
+    u64 dropped;
+    timestamp start;
+    const char *heap_names[HEAPPROF_MAX_HEAPS];
+    u32 nheaps;
+    boolean tracking;           /* frees are checked against sampled addresses */
+    boolean sampling;           /* allocations are sampled */
+} heapprof;
+
+/* Allocator entry points that are not interesting as call sites; the
+   reported site is the first frame outside of these. */
+static const char *heapprof_alloc_funcs[] = {
+    "heaplock_alloc",
+    "lwip_allocate",
+    "mem_malloc",
+    "mem_calloc",
+    "memp_malloc",
+    "do_memp_malloc_pool",
+};
+
+static inline u64 heapprof_addr_hash(u64 a)
+{
+    u64 h = a * 0x9e3779b97f4a7c15ull;
+    return h ^ (h >> 32);
+}
+
+static u64 heapprof_stack_hash(u32 heap_id, u64 *pcs, u32 depth)
+{
+    u64 hash = 0xcbf29ce484222325;
+    u64 fnv_prime = 1099511628211;
+    hash ^= heap_id;
+    hash *= fnv_prime;
+    for (int i = 0; i < depth; i++) {
+        hash ^= pcs[i];
+        hash *= fnv_prime;
+    }
+    return hash ? hash : 1;
+}
+
+static inline u64 heapprof_weight(u64 size)
+{
+    return MAX(size, heapprof.interval);
+}
+
+static inline u64 heapprof_weight_count(u64 size)
+{
+    return heapprof_weight(size) / size;
+}
+
+/* xorshift; uniform in [1, 2 * interval] for an average of interval */
+static s64 heapprof_next_budget(heapprof_cpu hc)
+{
+    u64 x = hc->rand;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    hc->rand = x;
+    return 1 + x % (2 * heapprof.interval);
+}
+
+/* all of the following with heapprof.lock held */
+
+static heapprof_site heapprof_site_get(u32 heap_id, u64 *pcs, u32 depth)
+{
+    u64 hash = heapprof_stack_hash(heap_id, pcs, depth);
+    u64 mask = heapprof.nsites - 1;
+    for (int i = 0; i < HEAPPROF_PROBE_LIMIT; i++) {
+        heapprof_site s = &heapprof.sites[(hash + i) & mask];
+        if (s->hash == hash && s->heap_id == heap_id && s->depth == depth &&
+            runtime_memcmp(s->pcs, pcs, depth * sizeof(u64)) == 0)
+            return s;
+        if (s->hash == 0) {
+            s->heap_id = heap_id;
+            s->depth = depth;
+            runtime_memcpy(s->pcs, pcs, depth * sizeof(u64));
+            s->hash = hash;
+            heapprof.sites_used++;
+            return s;
+        }
+    }
+    return 0;
+}
+
+static heapprof_sample heapprof_sample_find(u64 a)
+{
+    u64 mask = heapprof.nsamples - 1;
+    for (u64 i = heapprof_addr_hash(a) & mask; heapprof.samples[i].addr; i = (i + 1) & mask) {
+        if (heapprof.samples[i].addr == a)
+            return &heapprof.samples[i];
+    }
+    return 0;
+}
+
+/* linear probing with backward shift deletion, so lookups need no tombstones */
+static void heapprof_sample_remove(heapprof_sample hs)
+{
+    u64 mask = heapprof.nsamples - 1;
+    heapprof_site s = &heapprof.sites[hs->site];
+    s->live_count -= heapprof_weight_count(hs->size);
+    s->live_bytes -= heapprof_weight(hs->size);
+    heapprof.filter[heapprof_addr_hash(hs->addr) & heapprof.filter_mask]--;
+    heapprof.samples_live--;
+    u64 i = hs - heapprof.samples;
+    u64 j = i;
+    while (true) {
+        heapprof.samples[i].addr = 0;
+        u64 home;
+        do {
+            j = (j + 1) & mask;
+            if (!heapprof.samples[j].addr)
+                return;
+            home = heapprof_addr_hash(heapprof.samples[j].addr) & mask;
+        } while (i <= j ? (i < home && home <= j) : (i < home || home <= j));
+        heapprof.samples[i] = heapprof.samples[j];
+        i = j;
+    }
+}
+
+static boolean heapprof_sample_insert(u64 a, u64 size, heapprof_site s)
+{
+    /* the address was freed behind the profiler's back; forget it */
+    heapprof_sample hs = heapprof_sample_find(a);
+    if (hs)
+        heapprof_sample_remove(hs);
+    if (heapprof.samples_live >= heapprof.nsamples - heapprof.nsamples / 4)
+        return false;
+    u64 mask = heapprof.nsamples - 1;
+    u64 i = heapprof_addr_hash(a) & mask;
+    while (heapprof.samples[i].addr)
+        i = (i + 1) & mask;
+    hs = &heapprof.samples[i];
+    hs->size = size;
+    hs->site = s - heapprof.sites;
+    hs->addr = a;
+    heapprof.samples_live++;
+    heapprof.filter[heapprof_addr_hash(a) & heapprof.filter_mask]++;
+    s->live_count += heapprof_weight_count(size);
+    s->live_bytes += heapprof_weight(size);
+    return true;
+}
+
+static void __attribute__((noinline)) heapprof_record(heapprof_heap hh, heapprof_cpu hc,
+                                                      u64 a, bytes size)
+{
+    hc->budget = heapprof_next_budget(hc);
+    if (size == 0)
+        size = 1;
+
+    /* the first frame is the wrapper's own alloc */
+    u64 pcs[HEAPPROF_MAX_DEPTH + 1];
+    int depth = profile_walk_frames(__builtin_frame_address(0), pcs, HEAPPROF_MAX_DEPTH + 1, false);
+    depth = MAX(depth - 1, 0);
+
+    u64 flags = spin_lock_irq(&heapprof.lock);
+    heapprof_site s = heapprof_site_get(hh->id, pcs + 1, depth);
+    if (s && heapprof_sample_insert(a, size, s)) {
+        s->alloc_count += heapprof_weight_count(size);
+        s->alloc_bytes += heapprof_weight(size);
+        heapprof.sample_count++;
+    } else {
+        heapprof.dropped++;
+    }
+    spin_unlock_irq(&heapprof.lock, flags);
+}
+
+static void __attribute__((noinline)) heapprof_free(u64 a)
+{
+    u64 flags = spin_lock_irq(&heapprof.lock);
+    heapprof_sample hs = heapprof_sample_find(a);
+    if (hs)
+        heapprof_sample_remove(hs);
+    spin_unlock_irq(&heapprof.lock, flags);
+}
+
+static u64 heapprof_alloc(heap h, bytes b)
+{
+    heapprof_heap hh = (heapprof_heap)h;
+    u64 a = allocate_u64(hh->parent, b);
+    if (heapprof.sampling && a != INVALID_PHYSICAL) {
+        u64 cpu = current_cpu()->id;
+        if (cpu < heapprof.ncpus) {
+            heapprof_cpu hc = &heapprof.cpus[cpu];
+            hc->budget -= b;
+            if (hc->budget <= 0)
+                heapprof_record(hh, hc, a, b);
+        }
+    }
+    return a;
+}
+
+static void heapprof_dealloc(heap h, u64 a, bytes b)
+{
+    heapprof_heap hh = (heapprof_heap)h;
+    if (heapprof.tracking && heapprof.filter[heapprof_addr_hash(a) & heapprof.filter_mask])
+        heapprof_free(a);
+    deallocate_u64(hh->parent, a, b);
+}
+
+static void heapprof_destroy(heap h)
+{
+    destroy_heap(((heapprof_heap)h)->parent);
+}
+
+static bytes heapprof_allocated(heap h)
+{
+    return heap_allocated(((heapprof_heap)h)->parent);
+}
+
+static bytes heapprof_total(heap h)
+{
+    return heap_total(((heapprof_heap)h)->parent);
+}
+
+static value heapprof_management(heap h)
+{
+    return heap_management(((heapprof_heap)h)->parent);
+}
+
+/* Wrappers are created with the heaps they profile, long before the
+   manifest is read; until the profiler is enabled they just forward. */
+heap heapprof_wrapper(heap meta, heap parent, const char *name)
+{
+    if (heapprof.nheaps >= HEAPPROF_MAX_HEAPS)
+        return parent;
+    heapprof_heap hh = allocate(meta, sizeof(*hh));
+    if (hh == INVALID_ADDRESS)
+        return INVALID_ADDRESS;
+    hh->h.alloc = heapprof_alloc;
+    hh->h.dealloc = heapprof_dealloc;
+    hh->h.destroy = heapprof_destroy;
+    hh->h.allocated = heapprof_allocated;
+    hh->h.total = heapprof_total;
+    hh->h.management = heapprof_management;
+    hh->h.pagesize = parent->pagesize;
+    hh->parent = parent;
+    hh->id = heapprof.nheaps;
+    heapprof.heap_names[heapprof.nheaps++] = name;
+    return &hh->h;
+}
+
+static void heapprof_start(void)
+{
+    if (heapprof.sampling)
+        return;
+    for (u64 cpu = 0; cpu < heapprof.ncpus; cpu++)
+        heapprof.cpus[cpu].budget = heapprof_next_budget(&heapprof.cpus[cpu]);
+    memory_barrier();
+    heapprof.sampling = true;
+    heapprof_debug("started, interval %ld\n", heapprof.interval);
+}
+
+static void heapprof_stop(void)
+{
+    heapprof.sampling = false;
+    heapprof_debug("stopped\n");
+}
+
+/* Live figures are kept, since the objects they describe still exist. */
+static void heapprof_reset(void)
+{
+    u64 flags = spin_lock_irq(&heapprof.lock);
+    for (u64 i = 0; i < heapprof.nsites; i++) {
+        heapprof_site s = &heapprof.sites[i];
+        s->alloc_count = s->alloc_bytes = 0;
+    }
+    heapprof.sample_count = heapprof.dropped = 0;
+    heapprof.start = now(CLOCK_ID_MONOTONIC);
+    spin_unlock_irq(&heapprof.lock, flags);
+}
+
+/* Copy the used sites out of the table, so that reports are formatted
+   without holding the profiler lock (formatting allocates from profiled
+   heaps). The snapshot comes from the backed heap, which isn't profiled. */
+static heapprof_site heapprof_snapshot(u64 *count, bytes *size)
+{
+    heap backed = (heap)heap_linear_backed(get_kernel_heaps());
+    u64 n = heapprof.sites_used;
+    *size = MAX(n, 1) * sizeof(struct heapprof_site);
+    heapprof_site snap = allocate(backed, *size);
+    if (snap == INVALID_ADDRESS)
+        return snap;
+    u64 c = 0;
+    u64 flags = spin_lock_irq(&heapprof.lock);
+    for (u64 i = 0; i < heapprof.nsites && c < n; i++) {
+        if (heapprof.sites[i].hash)
+            runtime_memcpy(&snap[c++], &heapprof.sites[i], sizeof(*snap));
+    }
+    spin_unlock_irq(&heapprof.lock, flags);
+    *count = c;
+    return snap;
+}
+
+static void heapprof_snapshot_free(heapprof_site snap, bytes size)
+{
+    deallocate((heap)heap_linear_backed(get_kernel_heaps()), snap, size);
+}
+
+static boolean heapprof_is_alloc_func(const char *name)
+{
+    for (int i = 0; i < _countof(heapprof_alloc_funcs); i++)
+        if (!runtime_strcmp(name, heapprof_alloc_funcs[i]))
+            return true;
+    return false;
+}
+
+/* return addresses point past the call */
+static void heapprof_print_frame(buffer b, u64 pc)
+{
+    char *name = find_elf_sym(pc - 1, 0, 0);
+    if (name)
+        buffer_write_cstring(b, name);
+    else
+        bprintf(b, "0x%lx", pc);
+}
+
+static void heapprof_print_site(buffer b, heapprof_site s)
+{
+    if (s->depth == 0) {
+        buffer_write_cstring(b, "?");
+        return;
+    }
+    int i = 0;
+    while (i < s->depth - 1) {
+        char *name = find_elf_sym(s->pcs[i] - 1, 0, 0);
+        if (!name || !heapprof_is_alloc_func(name))
+            break;
+        i++;
+    }
+    heapprof_print_frame(b, s->pcs[i]);
+    for (int n = 0; n < HEAPPROF_REPORT_CALLERS && ++i < s->depth; n++) {
+        buffer_write_cstring(b, " < ");
+        heapprof_print_frame(b, s->pcs[i]);
+    }
+}
+
+static buffer heapprof_report(void)
+{
+    bytes snap_size;
+    u64 count;
+    heapprof_site snap = heapprof_snapshot(&count, &snap_size);
+    if (snap == INVALID_ADDRESS)
+        return INVALID_ADDRESS;
+    buffer b = allocate_buffer(heapprof.h, PAGESIZE);
+    if (b == INVALID_ADDRESS)
+        goto out;
+
+    /* top sites by live bytes */
+    heapprof_site top[HEAPPROF_REPORT_SITES];
+    int ntop = 0;
+    u64 live_total = 0;
+    for (u64 i = 0; i < count; i++) {
+        heapprof_site s = &snap[i];
+        live_total += s->live_bytes;
+        int j = ntop;
+        if (ntop < HEAPPROF_REPORT_SITES)
+            ntop++;
+        else if (top[ntop - 1]->live_bytes >= s->live_bytes)
+            continue;
+        else
+            j = ntop - 1;
+        for (; j > 0 && top[j - 1]->live_bytes < s->live_bytes; j--)
+            top[j] = top[j - 1];
+        top[j] = s;
+    }
+
+    u64 ms = msec_from_timestamp(now(CLOCK_ID_MONOTONIC) - heapprof.start);
+    bprintf(b, "heap profiler %s, interval %ld bytes, %ld samples (%ld dropped) in %ld ms, "
+            "%ld sites, estimated live %ld bytes\n",
+            heapprof.sampling ? "running" : "stopped", heapprof.interval,
+            heapprof.sample_count, heapprof.dropped, ms, count, live_total);
+    bprintf(b, "%14s %10s %14s %12s %-8s %s\n", "live bytes", "live objs", "alloc bytes",
+            "alloc B/s", "heap", "call site");
+    for (int i = 0; i < ntop; i++) {
+        heapprof_site s = top[i];
+        bprintf(b, "%14ld %10ld %14ld %12ld %-8s ", s->live_bytes, s->live_count,
+                s->alloc_bytes, ms ? s->alloc_bytes * 1000 / ms : 0,
+                heapprof.heap_names[s->heap_id]);
+        heapprof_print_site(b, s);
+        push_u8(b, '\n');
+    }
+  out:
+    heapprof_snapshot_free(snap, snap_size);
+    return b;
+}
+
+static buffer heapprof_folded(void)
+{
+    bytes snap_size;
+    u64 count;
+    heapprof_site snap = heapprof_snapshot(&count, &snap_size);
+    if (snap == INVALID_ADDRESS)
+        return INVALID_ADDRESS;
+    buffer b = allocate_buffer(heapprof.h, PAGESIZE);
+    if (b == INVALID_ADDRESS)
+        goto out;
+    for (u64 i = 0; i < count; i++) {
+        heapprof_site s = &snap[i];
+        if (!s->live_bytes)
+            continue;
+        bprintf(b, "[%s]", heapprof.heap_names[s->heap_id]);
+        for (int j = s->depth - 1; j >= 0; j--) {
+            push_u8(b, ';');
+            heapprof_print_frame(b, s->pcs[j]);
+        }
+        bprintf(b, " %ld\n", s->live_bytes);
+    }
+  out:
+    heapprof_snapshot_free(snap, snap_size);
+    return b;
+}
+
+static buffer heapprof_stats(void)
+{
+    buffer b = allocate_buffer(heapprof.h, 256);
+    if (b == INVALID_ADDRESS)
+        return b;
+    u64 flags = spin_lock_irq(&heapprof.lock);
+    u64 samples = heapprof.sample_count, dropped = heapprof.dropped;
+    u64 live = heapprof.samples_live, sites = heapprof.sites_used;
+    spin_unlock_irq(&heapprof.lock, flags);
+    bprintf(b, "heap profiler %s, interval %ld bytes\n",
+            heapprof.sampling ? "running" : "stopped", heapprof.interval);
+    bprintf(b, "%ld samples, %ld dropped, %ld/%ld live samples tracked, %ld/%ld sites\n",
+            samples, dropped, live, heapprof.nsamples, sites, heapprof.nsites);
+    for (u32 i = 0; i < heapprof.nheaps; i++)
+        bprintf(b, "heap %s\n", heapprof.heap_names[i]);
+    return b;
+}
+
+static void heapprof_send_http_error(http_responder handler, const char *status, const char *msg)
+{
+    buffer b = aprintf(heapprof.h, "<html><head><title>%s %s</title></head>"
+                       "<body><h1>%s</h1></body></html>\r\n", status, msg, msg);
+    send_http_response(handler, timm("status", "%s %s", status, msg), b);
+}
+
+closure_function(0, 3, void, heapprof_http_request,
+                 http_method, method, http_responder, handler, value, val)
+{
+    string relative_uri = get_string(val, sym(relative_uri));
+    if (method != HTTP_REQUEST_METHOD_GET) {
+        heapprof_send_http_error(handler, "501", "Not Implemented");
+        return;
+    }
+    buffer b;
+    if (!relative_uri) {
+        b = heapprof_report();
+    } else if (buffer_compare_with_cstring(relative_uri, "folded")) {
+        b = heapprof_folded();
+    } else if (buffer_compare_with_cstring(relative_uri, "stats")) {
+        b = heapprof_stats();
+    } else if (buffer_compare_with_cstring(relative_uri, "enable")) {
+        heapprof_start();
+        b = aprintf(heapprof.h, "heap profiler enabled\n");
+    } else if (buffer_compare_with_cstring(relative_uri, "disable")) {
+        heapprof_stop();
+        b = aprintf(heapprof.h, "heap profiler disabled\n");
+    } else if (buffer_compare_with_cstring(relative_uri, "reset")) {
+        heapprof_reset();
+        b = aprintf(heapprof.h, "heap profile reset\n");
+    } else {
+        heapprof_send_http_error(handler, "404", "Not Found");
+        return;
+    }
+    if (b == INVALID_ADDRESS) {
+        heapprof_send_http_error(handler, "500", "Internal Server Error");
+        return;
+    }
+    status s = send_http_response(handler, timm("ContentType", "text/plain"), b);
+    if (!is_ok(s)) {
+        msg_err("failed to send heap profile: %v\n", s);
+        timm_dealloc(s);
+    }
+}
+
+static boolean init_heapprof_http_listener(void)
+{
+    http_listener hl = allocate_http_listener(heapprof.h, HEAPPROF_HTTP_PORT);
+    if (hl == INVALID_ADDRESS) {
+        msg_err("could not allocate heap profile HTTP listener\n");
+        return false;
+    }
+    http_register_uri_handler(hl, HEAPPROF_URI, closure(heapprof.h, heapprof_http_request));
+    status s = listen_port(heapprof.h, HEAPPROF_HTTP_PORT, connection_handler_from_http_listener(hl));
+    if (!is_ok(s)) {
+        msg_err("listen_port(port=%d) failed for heap profile HTTP listener\n", HEAPPROF_HTTP_PORT);
+        timm_dealloc(s);
+        deallocate_http_listener(heapprof.h, hl);
+        return false;
+    }
+    rprintf("started heap profile http listener on port %d\n", HEAPPROF_HTTP_PORT);
+    return true;
+}
+
+void init_heap_profiler(kernel_heaps kh, tuple root)
+{
+    tuple config = get_tuple(root, sym(heapprof));
+    if (!config)
+        return;
+    heapprof.h = heap_locked(kh);
+    heap backed = (heap)heap_linear_backed(kh);
+
+    u64 interval = HEAPPROF_DEFAULT_INTERVAL;
+    if (get_u64(config, sym(interval), &interval) && interval == 0) {
+        msg_err("invalid heap profile interval\n");
+        return;
+    }
+    heapprof.interval = interval;
+    u64 sites = HEAPPROF_DEFAULT_SITES;
+    if (get_u64(config, sym(sites), &sites) && sites < HEAPPROF_PROBE_LIMIT) {
+        msg_err("invalid number of heap profile sites %ld\n", sites);
+        return;
+    }
+    heapprof.nsites = U64_FROM_BIT(find_order(sites));
+    u64 samples = HEAPPROF_DEFAULT_SAMPLES;
+    if (get_u64(config, sym(samples), &samples) && samples < HEAPPROF_PROBE_LIMIT) {
+        msg_err("invalid number of heap profile samples %ld\n", samples);
+        return;
+    }
+    heapprof.nsamples = U64_FROM_BIT(find_order(samples));
+
+    /* a filter 4 times the sample table keeps collisions with live samples rare */
+    u64 nfilter = heapprof.nsamples * 4;
+    heapprof.filter_mask = nfilter - 1;
+    heapprof.ncpus = MAX(present_processors, total_processors);
+    heapprof.cpus = allocate_zero(backed, heapprof.ncpus * sizeof(struct heapprof_cpu));
+    heapprof.sites = allocate_zero(backed, heapprof.nsites * sizeof(struct heapprof_site));
+    heapprof.samples = allocate_zero(backed, heapprof.nsamples * sizeof(struct heapprof_sample));
+    heapprof.filter = allocate_zero(backed, nfilter * sizeof(u16));
+    if (heapprof.cpus == INVALID_ADDRESS || heapprof.sites == INVALID_ADDRESS ||
+        heapprof.samples == INVALID_ADDRESS || heapprof.filter == INVALID_ADDRESS) {
+        msg_err("failed to allocate heap profile tables\n");
+        return;
+    }
+    for (u64 cpu = 0; cpu < heapprof.ncpus; cpu++)
+        heapprof.cpus[cpu].rand = random_u64() | 1;
+    spin_lock_init_class(&heapprof.lock, "heapprof");
+    heapprof.start = now(CLOCK_ID_MONOTONIC);
+
+    if (!init_heapprof_http_listener())
+        return;
+    memory_barrier();
+    heapprof.tracking = true;
+    if (!get(config, sym(disable)))
+        heapprof_start();
+    rprintf("heap profiler initialized, interval %ld bytes, %ld sites, %ld samples\n",
+            heapprof.interval, heapprof.nsites, heapprof.nsamples);
+}
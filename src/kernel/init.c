@@ -80,6 +80,8 @@ void init_kernel_heaps(void)
     heaps.general = allocate_mcache(&bootstrap, (heap)heaps.linear_backed, 5, MAX_MCACHE_ORDER,
                                     pagesize);
     assert(heaps.general != INVALID_ADDRESS);
+    heaps.general = heapprof_wrapper(&bootstrap, heaps.general, "general");
+    assert(heaps.general != INVALID_ADDRESS);
 
     heaps.locked = locking_heap_wrapper(heaps.general, heaps.general);
     assert(heaps.locked != INVALID_ADDRESS);
@@ -141,6 +143,11 @@ closure_function(2, 2, void, fsstarted,
     assert(wrapped_root != INVALID_ADDRESS);
     // XXX use wrapped_root after root fs is separate
     tuple root = filesystem_getroot(root_fs);
+    if (get(root, sym(mount_stats))) {
+        buffer b = little_stack_buffer(512);
+        filesystem_print_mount_stats(fs, b);
+        buffer_print(b);
+    }
     tuple mounts = get_tuple(root, sym(mounts));
     if (mounts)
         storage_set_mountpoints(mounts);
@@ -291,8 +298,9 @@ static void rootfs_init(u8 *mbr, u64 offset, storage_req_handler req_handler, u6
                       closure(h, fsstarted, mbr, req_handler));
 }
 
-closure_function(4, 1, void, mbr_read,
-                 u8 *, mbr, storage_req_handler, req_handler, u64, length, int, attach_id,
+closure_function(5, 1, void, mbr_read,
+                 u8 *, mbr, storage_req_handler, driver, storage_req_handler, req_handler, u64, length,
+                 int, attach_id,
                  status, s)
 {
     init_debug("%s", __func__);
@@ -313,7 +321,7 @@ closure_function(4, 1, void, mbr_read,
     } else {
         /* The on-disk kernel log dump section is immediately before the first partition. */
         struct partition_entry *first_part = partition_at(mbr, 0);
-        klog_disk_setup(first_part->lba_start * SECTOR_SIZE - KLOG_DUMP_SIZE, bound(req_handler));
+        klog_disk_setup(first_part->lba_start * SECTOR_SIZE - KLOG_DUMP_SIZE, bound(driver));
 
         rootfs_init(mbr, rootfs_part->lba_start * SECTOR_SIZE, bound(req_handler), bound(length));
     }
@@ -332,7 +340,13 @@ closure_function(0, 3, void, attach_storage,
         msg_err("cannot allocate memory for MBR sector\n");
         return;
     }
-    status_handler sh = closure(h, mbr_read, mbr, req_handler, length, attach_id);
+    /* Filesystems access the device through its request queue; the kernel log dump doesn't. */
+    storage_req_handler queue_handler = storage_queue_attach(req_handler, attach_id);
+    if (queue_handler == INVALID_ADDRESS) {
+        msg_err("cannot allocate storage queue\n");
+        queue_handler = req_handler;
+    }
+    status_handler sh = closure(h, mbr_read, mbr, req_handler, queue_handler, length, attach_id);
     if (sh == INVALID_ADDRESS) {
         msg_err("cannot allocate MBR read closure\n");
         deallocate(bh, mbr, PAGESIZE);
@@ -366,7 +380,7 @@ void kernel_runtime_init(kernel_heaps kh)
     init_runtime(misc, locked);
     init_sg(locked);
     list_init(&mm_cleaners);
-    spin_lock_init(&mm_lock);
+    spin_lock_init_class(&mm_lock, "mm");
     init_pagecache(locked, reserve_heap_wrapper(misc, (heap)heap_linear_backed(kh), PAGECACHE_MEMORY_RESERVE),
                reserve_heap_wrapper(misc, (heap)heap_physical(kh), PAGECACHE_MEMORY_RESERVE), PAGESIZE);
     mem_cleaner pc_cleaner = closure(misc, mm_pagecache_cleaner);
@@ -175,6 +175,9 @@ cpuinfo init_cpuinfo(heap backed, int cpu)
     assert(ci->free_syscall_contexts != INVALID_ADDRESS);
     ci->cpu_queue = allocate_queue(backed, CPU_QUEUE_SIZE);
     assert(ci->cpu_queue != INVALID_ADDRESS);
+    assert(init_deferred_queue(&ci->bh_queue, backed, CPU_BHQUEUE_SIZE));
+    assert(init_deferred_queue(&ci->run_queue, backed, CPU_RUNQUEUE_SIZE));
+    assert(init_deferred_queue(&ci->async_1_queue, backed, CPU_ASYNC_QUEUE_1_SIZE));
     ci->last_timer_update = 0;
     ci->frcount = 0;
     ci->mcs_prev = 0;
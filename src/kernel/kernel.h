@@ -16,10 +16,16 @@ void runloop_target(void) __attribute__((noreturn));
 #include <tracelog.h>
 #else
 void tprintf(symbol tag, tuple attrs, const char *format, ...);
+#define tracepoint_enabled(id)      false
+#define tracepoint_instant(id, ...) do {} while (0)
+#define tracepoint_begin(id, ...)   do {} while (0)
+#define tracepoint_end(id, ...)     do {} while (0)
 #endif
 
-#ifdef LOCK_STATS
 #include <lockstats.h>
+
+#ifdef KERNEL
+#include <profile.h>
 #endif
 
 //#define CONTEXT_DEBUG
@@ -65,6 +71,21 @@ typedef struct sched_queue {
     struct spinlock lock;
 } *sched_queue;
 
+/* Per-cpu queue of deferred work. Items are normally serviced by the owning
+   cpu; other cpus only take items when they would otherwise go idle. The
+   counters are updated without locking and are approximate. */
+typedef struct deferred_queue {
+    queue q;
+    timestamp pending_since;    /* when the queue last became non-empty */
+    u64 enqueued;
+    u64 serviced;               /* items run by the owning cpu */
+    u64 stolen;                 /* items run by other cpus */
+    u64 max_depth;
+    u64 drains;
+    timestamp latency_total;    /* summed over drains, from pending_since */
+    timestamp latency_max;
+} *deferred_queue;
+
 /* per-cpu, architecture-independent invariants */
 typedef struct cpuinfo *cpuinfo;
 
@@ -73,10 +94,14 @@ struct cpuinfo {
     u32 id;
     int state;
     queue cpu_queue;
+    struct deferred_queue bh_queue;     /* kernel from interrupt */
+    struct deferred_queue run_queue;
+    struct deferred_queue async_1_queue;
     struct sched_queue thread_queue;
     timestamp last_timer_update;
     u64 frcount;
     u64 inval_gen; /* Generation number for invalidates */
+    u32 storage_plug;   /* storage_plug() nesting depth */
 
     cpuinfo mcs_prev;
     cpuinfo mcs_next;
@@ -90,13 +115,10 @@ struct cpuinfo {
     struct ftrace_graph_entry * graph_stack;
 #endif
 #ifdef CONFIG_TRACELOG
-    void *tracelog_buffer;
+    void *tracelog_ring;
 #endif
-#ifdef LOCK_STATS
     boolean lock_stats_disable;
-    table lock_stats_table;
-    heap lock_stats_heap;
-#endif
+    lockstats_cpu lock_stats;
 };
 
 extern vector cpuinfos;
@@ -104,47 +126,40 @@ extern vector cpuinfos;
 #if defined(KERNEL) && defined(SMP_ENABLE)
 static inline boolean spin_try(spinlock l)
 {
-    boolean success = compare_and_swap_64(&l->w, 0, 1);
-#ifdef LOCK_STATS
-    LOCKSTATS_RECORD_LOCK(l->s, success, 0, 0);
-#endif
+    boolean success = compare_and_swap_32(&l->locked, 0, 1);
+    if (record_lock_stats)
+        lockstats_spin_try(l, success);
     return success;
 }
 
 static inline void spin_lock(spinlock l)
 {
-    volatile u64 *p = (volatile u64 *)&l->w;
-#ifdef LOCK_STATS
-    u64 spins = 0;
-    while (*p || !compare_and_swap_64(&l->w, 0, 1)) {
-        spins++;
-        kern_pause();
+    if (record_lock_stats) {
+        lockstats_spin_lock(l);
+        return;
     }
-    LOCKSTATS_RECORD_LOCK(l->s, true, spins, 0);
-#else
-    while (*p || !compare_and_swap_64(&l->w, 0, 1))
+    volatile u32 *p = (volatile u32 *)&l->locked;
+    while (*p || !compare_and_swap_32(&l->locked, 0, 1))
         kern_pause();
-#endif
 }
 
 static inline void spin_unlock(spinlock l)
 {
-#ifdef LOCK_STATS
-    LOCKSTATS_RECORD_UNLOCK(l->s);
-#endif
+    if (record_lock_stats)
+        lockstats_spin_unlock(l);
     compiler_barrier();
-    *(volatile u64 *)&l->w = 0;
+    *(volatile u32 *)&l->locked = 0;
 }
 
 static inline void spin_rlock(rw_spinlock l)
 {
     while (1) {
-        if (*(volatile word *)&l->l.w) {
+        if (*(volatile u32 *)&l->l.locked) {
             kern_pause();
             continue;
         }
         fetch_and_add(&l->readers, 1);
-        if (!*(volatile word *)&l->l.w)
+        if (!*(volatile u32 *)&l->l.locked)
             return;
         fetch_and_add(&l->readers, -1);
     }
@@ -395,15 +410,34 @@ static inline void set_platform_timer(timestamp duration)
     apply(platform_timer, duration);
 }
 
+timestamp kern_now(clock_id id);    /* klibs must use this instead of now() */
+
+static inline void deferred_queue_account(deferred_queue dq)
+{
+    fetch_and_add(&dq->enqueued, 1);
+    if (!dq->pending_since)
+        dq->pending_since = kern_now(CLOCK_ID_MONOTONIC_RAW);
+}
+
+/* Deferred work goes to the queue of the current cpu; the global queues are
+   only used when the per-cpu queue is full. */
 static inline void async_apply(thunk t)
 {
     assert(!in_interrupt());
-    assert(enqueue(runqueue, t));
+    deferred_queue dq = &current_cpu()->run_queue;
+    if (enqueue(dq->q, t))
+        deferred_queue_account(dq);
+    else
+        assert(enqueue(runqueue, t));
 }
 
 static inline void async_apply_bh(thunk t)
 {
-    assert(enqueue_irqsafe(bhqueue, t));
+    deferred_queue dq = &current_cpu()->bh_queue;
+    if (enqueue_irqsafe(dq->q, t))
+        deferred_queue_account(dq);
+    else
+        assert(enqueue_irqsafe(bhqueue, t));
 }
 
 typedef closure_type(async_1, void, u64);
@@ -418,7 +452,11 @@ static inline void async_apply_1(void *a, void *arg0)
     struct applied_async_1 aa;
     aa.a = a;
     aa.arg0 = u64_from_pointer(arg0);
-    assert(enqueue_n_irqsafe(async_queue_1, &aa, sizeof(aa) / sizeof(u64)));
+    deferred_queue dq = &current_cpu()->async_1_queue;
+    if (enqueue_n_irqsafe(dq->q, &aa, sizeof(aa) / sizeof(u64)))
+        deferred_queue_account(dq);
+    else
+        assert(enqueue_n_irqsafe(async_queue_1, &aa, sizeof(aa) / sizeof(u64)));
 }
 #define async_apply_status_handler async_apply_1
 
@@ -654,6 +692,8 @@ static inline __attribute__((always_inline))  __attribute__((noreturn)) void ker
 
 static inline void schedule_timer_service(void)
 {
+    /* all platform timer interrupts funnel through here */
+    profile_timer_interrupt();
     if (compare_and_swap_32(&kernel_timers->service_scheduled, false, true))
         async_apply_bh(kernel_timers->service);
 }
@@ -731,6 +771,11 @@ void unmap_and_free_phys(u64 virtual, u64 length);
 
 heap allocate_tagged_region(kernel_heaps kh, u64 tag, bytes pagesize);
 heap locking_heap_wrapper(heap meta, heap parent);
+heap heapprof_wrapper(heap meta, heap parent, const char *name);
+caching_heap percpu_cache_wrapper(heap meta, heap parent, bytes parent_pagesize,
+                                  int min_order, int max_order);
+boolean percpu_cache_enable(caching_heap ch, u32 magazine_size);
+void init_heap_profiler(kernel_heaps kh, tuple root);
 
 #endif
 
@@ -740,13 +785,12 @@ void configure_timer(timestamp rate, thunk t);
 
 void kernel_sleep();
 void kernel_delay(timestamp delta);
-timestamp kern_now(clock_id id);    /* klibs must use this instead of now() */
 
 void init_clock(void);
 
 void process_bhqueue();
 
-void msi_format(u32 *address, u32 *data, int vector);
+void msi_format(u32 *address, u32 *data, int vector, u32 target_cpu);
 int msi_get_vector(u32 data);
 
 u64 allocate_ipi_interrupt(void);
@@ -766,8 +810,11 @@ void send_ipi(u64 cpu, u8 vector);
 
 void init_scheduler(heap);
 void init_scheduler_cpus(heap h);
+void init_scheduler_management(tuple root);
 void mm_service(void);
 
+boolean init_deferred_queue(deferred_queue dq, heap h, u64 size);
+
 boolean sched_queue_init(sched_queue sq, heap h);
 void sched_enqueue(sched_queue sq, sched_task task);
 sched_task sched_dequeue(sched_queue sq);
@@ -804,6 +851,15 @@ extern bitmap idle_cpu_mask;
 extern u64 total_processors;
 extern u64 present_processors;
 
+/* Called on exception and interrupt entry. TLB shootdowns skip idle cpus, so
+   a cpu leaving idle must catch up before doing anything else. */
+static inline void cpu_clear_idle(cpuinfo ci)
+{
+    bitmap_set_atomic(idle_cpu_mask, ci->id, 0);
+    if (ci->state == cpu_idle)
+        page_invalidate_flush();
+}
+
 void cpu_init(int cpu);
 void start_secondary_cores(kernel_heaps kh);
 void count_cpus_present(void);
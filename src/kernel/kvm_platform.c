@@ -20,6 +20,23 @@
 #define KVM_CPUID_FEATURES  1
 #define KVM_MSR_SYSTEM_TIME 0x4b564d01
 #define KVM_MSR_WALL_CLOCK  0x4b564d00
+#define KVM_MSR_STEAL_TIME  0x4b564d03
+
+#define KVM_FEATURE_STEAL_TIME      5
+#define KVM_FEATURE_PV_TLB_FLUSH    9
+
+#define KVM_VCPU_PREEMPTED  (1 << 0)
+#define KVM_VCPU_FLUSH_TLB  (1 << 1)
+
+struct kvm_steal_time {
+    u64 steal;
+    u32 version;
+    u32 flags;
+    u8 preempted;
+    u8 u8_pad[3];
+    u32 pad[11];
+};
+
 
 static boolean probe_kvm_pvclock(kernel_heaps kh, u32 cpuid_fn)
 {
@@ -48,6 +65,56 @@ static boolean probe_kvm_pvclock(kernel_heaps kh, u32 cpuid_fn)
     return true;
 }
 
+closure_function(1, 0, void, kvm_steal_time_percpu_init,
+                 heap, backed)
+{
+    cpuinfo ci = current_cpu();
+    struct kvm_steal_time *st = allocate_zero(bound(backed), bound(backed)->pagesize);
+    if (st == INVALID_ADDRESS) {
+        msg_err("failed to allocate steal time area for cpu %d\n", ci->id);
+        return;
+    }
+    write_msr(KVM_MSR_STEAL_TIME, physical_from_virtual(st) | /* enable */ 1);
+    ci->m.hypervisor_data = st;
+}
+
+/* A preempted vcpu gets its TLB flushed by the host before it runs again, so
+   there is no need to interrupt it. */
+closure_function(0, 2, void, kvm_remote_tlb_flush,
+                 u64 *, cpus, u64, ncpus)
+{
+    for (u64 cpu = 0; cpu < ncpus; cpu++) {
+        u64 *w = &cpus[cpu >> 6];
+        if (!(*w & U64_FROM_BIT(cpu & 63)))
+            continue;
+        struct kvm_steal_time *st = cpuinfo_from_id(cpu)->m.hypervisor_data;
+        if (!st)
+            continue;
+        u8 state = st->preempted;
+        if ((state & KVM_VCPU_PREEMPTED) &&
+            compare_and_swap_8(&st->preempted, state, state | KVM_VCPU_FLUSH_TLB))
+            *w &= ~U64_FROM_BIT(cpu & 63);
+    }
+}
+
+static void probe_kvm_pv_tlb_flush(kernel_heaps kh, u32 cpuid_fn)
+{
+    u32 v[4];
+    cpuid(cpuid_fn + KVM_CPUID_FEATURES, 0, v);
+    if (!(v[0] & U64_FROM_BIT(KVM_FEATURE_STEAL_TIME)) ||
+        !(v[0] & U64_FROM_BIT(KVM_FEATURE_PV_TLB_FLUSH))) {
+        kvm_debug("no PV TLB flush");
+        return;
+    }
+    heap h = heap_general(kh);
+    thunk percpu_init = closure(h, kvm_steal_time_percpu_init, (heap)heap_linear_backed(kh));
+    assert(percpu_init != INVALID_ADDRESS);
+    apply(percpu_init);
+    register_percpu_init(percpu_init);
+    register_remote_tlb_flush(closure(h, kvm_remote_tlb_flush));
+    kvm_debug("PV TLB flush enabled");
+}
+
 boolean kvm_detect(kernel_heaps kh)
 {
     kvm_debug("probing for KVM...");
@@ -78,5 +145,6 @@ boolean kvm_detect(kernel_heaps kh)
     }
 
     register_platform_clock_timer(ct, per_cpu_init);
+    probe_kvm_pv_tlb_flush(kh, fn);
     return true;
 }
@@ -1,12 +1,13 @@
-#ifdef LOCK_STATS
 #include <lockstats_struct.h>
-#endif
 
 typedef struct spinlock {
-    word w;
-#ifdef LOCK_STATS
-    struct lockstats_lock s;
-#endif
+    union {
+        word w;
+        struct {
+            u32 locked;
+            u32 class;          /* lock profiling class id, see lockstats_class_id() */
+        };
+    };
 } *spinlock;
 
 typedef struct rw_spinlock {
@@ -17,10 +18,16 @@ typedef struct rw_spinlock {
 static inline void spin_lock_init(spinlock l)
 {
     l->w = 0;
-#ifdef LOCK_STATS
-    l->s.type = LOCK_TYPE_SPIN;
-    l->s.acq_time = 0;
-    l->s.trace_hash = 0;
+}
+
+/* The class name groups locks of the same kind in the lock profiler
+   output; it must point to static storage. Only a small id is kept in the
+   lock word, so naming a lock does not make it any larger. */
+static inline void spin_lock_init_class(spinlock l, const char *class)
+{
+    spin_lock_init(l);
+#if defined(KERNEL) && defined(SMP_ENABLE)
+    l->class = lockstats_class_id(class);
 #endif
 }
 
@@ -29,3 +36,9 @@ static inline void spin_rw_lock_init(rw_spinlock l)
     spin_lock_init(&l->l);
     l->readers = 0;
 }
+
+static inline void spin_rw_lock_init_class(rw_spinlock l, const char *class)
+{
+    spin_lock_init_class(&l->l, class);
+    l->readers = 0;
+}
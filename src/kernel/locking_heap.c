@@ -124,6 +124,6 @@ heap locking_heap_wrapper(heap meta, heap parent)
     hl->meta = meta;
     hl->mgmt = 0;
     hl->parent_mgmt = 0;
-    spin_lock_init(&hl->lock);
+    spin_lock_init_class(&hl->lock, "heaplock");
     return (heap)hl;
 }
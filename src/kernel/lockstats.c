@@ -7,12 +7,65 @@
 #define LOCKSTATS_URI                "lockstat"
 #define LOCKSTATS_HTTP_CHUNK_MAXSIZE (64*KB)
 #define LOCKSTATS_PREALLOC           2048
+#define LOCKSTATS_CLASSES            256
 
 static heap lockstats_heap;
+static heap lockstats_backed;
 static http_listener lockstats_hl;
+static boolean lockstats_allocated;
 
 boolean record_lock_stats = false;
 
+/* Class names are interned by address in a fixed table, so that a lock
+   refers to its class by a small id; this needs no allocations and works at
+   any point of boot. Id 0 stands for no class. */
+static const char *lockstats_classes[LOCKSTATS_CLASSES];
+
+u32 lockstats_class_id(const char *class)
+{
+    if (!class)
+        return 0;
+    u64 h = (u64_from_pointer(class) * 0x9e3779b97f4a7c15ull) >> 56;
+    for (int i = 0; i < LOCKSTATS_CLASSES; i++) {
+        int n = (h + i) & (LOCKSTATS_CLASSES - 1);
+        const char *c = *(const char * volatile *)&lockstats_classes[n];
+        if (!c) {
+            if (compare_and_swap_64((u64 *)&lockstats_classes[n], 0, u64_from_pointer(class)))
+                return n + 1;
+            c = *(const char * volatile *)&lockstats_classes[n];
+        }
+        if (c == class)
+            return n + 1;
+    }
+    return 0;
+}
+
+static inline const char *lockstats_class_name(u32 id)
+{
+    return id ? lockstats_classes[id - 1] : 0;
+}
+
+#ifdef __x86_64__
+static inline u64 lockstats_rdtscp(void)
+{
+    u32 a, d;
+    if (platform_has_precise_clocksource())
+        asm volatile("rdtscp" : "=a" (a), "=d" (d) :: "%rcx");
+    else
+        asm volatile("rdtsc" : "=a" (a), "=d" (d) :: "%rcx");
+    return (((u64)a) | (((u64)d) << 32));
+}
+
+#define lockstats_timestamp() lockstats_rdtscp()
+#else
+#define lockstats_timestamp() (nsec_from_timestamp(now(CLOCK_ID_MONOTONIC)))
+#endif
+
+static inline int lockstats_bucket(u64 t)
+{
+    return t == 0 ? 0 : MIN(msb(t) + 1, LOCKSTATS_BUCKETS - 1);
+}
+
 static u64 hash_lock_block(lock_block b)
 {
     u64 hash = 0xcbf29ce484222325;
@@ -26,10 +79,11 @@ static u64 hash_lock_block(lock_block b)
     return hash;
 }
 
-static inline void save_frame_trace(u64 *trace)
+/* fp is the frame of the lockstats entry point, so that the trace starts at
+   the function which took the lock */
+static inline void save_frame_trace(u64 *trace, u64 *fp)
 {
     int i;
-    u64 *fp = get_current_fp();
 
     for (i = 0; i < MAX_TRACE_DEPTH; i++) {
         /* simple bounds check for performance and to avoid recursive pt locking */
@@ -46,41 +100,259 @@ static inline void save_frame_trace(u64 *trace)
         trace[i] = 0;
 }
 
-lock_stats get_lockstats_block(lockstats_lock l, boolean islocking)
+/* Returns the per-cpu state with recording held off on this cpu, or 0 if
+   nothing is to be recorded; release with lockstats_put(). */
+static inline lockstats_cpu lockstats_get(cpuinfo ci)
 {
-    struct lock_block lookup;
-    cpuinfo ci = current_cpu();
-
-    if (ci->lock_stats_disable)
+    lockstats_cpu ls = ci->lock_stats;
+    if (!ls || ci->lock_stats_disable)
         return 0;
     ci->lock_stats_disable = true;
+    return ls;
+}
 
-    u64 trace_hash = 0;
-    lock_stats stats = 0;
-    table t = ci->lock_stats_table;
-    if (islocking) {
-        lookup.lock_address = u64_from_pointer(l);
-        save_frame_trace(lookup.lock_trace);
-        trace_hash = hash_lock_block(&lookup);
-        stats = table_find(t, (void *)trace_hash);
-        if (stats)
-            goto out;
-        stats = allocate_zero(ci->lock_stats_heap, sizeof(struct lock_stats));
-        assert(stats != INVALID_ADDRESS);
-        runtime_memcpy(&stats->lock, &lookup, sizeof(struct lock_block));
-        stats->lock.type = l->type;
-        stats->lock.hash = trace_hash;
-        stats->spins_min = -1u;
-        stats->hold_time_min = -1u;
-        table_set(t, (void *)trace_hash, stats);
-    } else if (l->trace_hash) {
-        stats = table_find(t, (void *)l->trace_hash);
-    }
-out:
+static inline void lockstats_put(cpuinfo ci)
+{
     ci->lock_stats_disable = false;
+}
+
+static lock_stats lockstats_site(lockstats_cpu ls, u64 *fp, void *lock, int type, u32 class)
+{
+    struct lock_block lookup;
+    lookup.lock_address = u64_from_pointer(lock);
+    save_frame_trace(lookup.lock_trace, fp);
+    u64 trace_hash = hash_lock_block(&lookup);
+    lock_stats stats = table_find(ls->stats_table, (void *)trace_hash);
+    if (stats)
+        return stats;
+    stats = allocate_zero(ls->stats_heap, sizeof(struct lock_stats));
+    if (stats == INVALID_ADDRESS)
+        return 0;
+    runtime_memcpy(&stats->lock, &lookup, sizeof(struct lock_block));
+    stats->lock.type = type;
+    stats->lock.hash = trace_hash;
+    stats->lock.class = lockstats_class_name(class);
+    stats->spins_min = -1u;
+    stats->hold_time_min = -1u;
+    table_set(ls->stats_table, (void *)trace_hash, stats);
     return stats;
 }
 
+static inline u64 lock_pair_key(u64 waiter_hash, u64 holder_hash)
+{
+    return (waiter_hash * 1099511628211ull) ^ holder_hash;
+}
+
+static void lockstats_record_wait(cpuinfo ci, lockstats_cpu ls, lock_stats stats,
+                                  lockstats_wait w, u64 wait)
+{
+    stats->wait_time_total += wait;
+    if (wait > stats->wait_time_max)
+        stats->wait_time_max = wait;
+    stats->wait_hist[lockstats_bucket(wait)]++;
+    stats->wait_cpus |= U64_FROM_BIT(ci->id & 63);
+    if (!w->holder_hash)
+        return;
+    u64 key = lock_pair_key(stats->lock.hash, w->holder_hash);
+    lock_pair lp = table_find(ls->pairs_table, (void *)key);
+    if (!lp) {
+        lp = allocate_zero(ls->pairs_heap, sizeof(struct lock_pair));
+        if (lp == INVALID_ADDRESS)
+            return;
+        lp->waiter_hash = stats->lock.hash;
+        lp->holder_hash = w->holder_hash;
+        table_set(ls->pairs_table, (void *)key, lp);
+    }
+    lp->count++;
+    lp->wait_time_total += wait;
+    if (w->holder_cpu)
+        lp->holder_cpus |= U64_FROM_BIT(((cpuinfo)w->holder_cpu)->id & 63);
+}
+
+/* Account an acquisition attempt and, if the lock was taken, fill in the
+   state of the held lock. */
+static void lockstats_record(cpuinfo ci, lockstats_cpu ls, u64 *fp, void *lock, int type,
+                             u32 class, boolean acq, u64 spins, u64 sleeps,
+                             lockstats_wait w, lockstats_lock ll)
+{
+    u64 ts = lockstats_timestamp();
+    lock_stats stats = lockstats_site(ls, fp, lock, type, class);
+    if (!stats)
+        return;
+    if (!acq) {
+        stats->tries++;
+        return;
+    }
+    stats->acq++;
+    if (spins > 0 || sleeps > 0) {
+        stats->spins_total += spins;
+        if (spins > stats->spins_max)
+            stats->spins_max = spins;
+        if (spins < stats->spins_min)
+            stats->spins_min = spins;
+        stats->sleep_time_total += sleeps;
+        stats->cont++;
+        if (w && w->start && ts > w->start)
+            lockstats_record_wait(ci, ls, stats, w, ts - w->start);
+    }
+    ll->lock = lock;
+    ll->cpu = ci;
+    ll->acq_time = ts;
+    ll->trace_hash = stats->lock.hash;
+}
+
+static void lockstats_record_unlock(lockstats_cpu ls, lockstats_lock ll)
+{
+    lock_stats stats = table_find(ls->stats_table, (void *)ll->trace_hash);
+    /* XXX unlocks on a cpu that has never first locked this hash will be dropped */
+    if (!stats)
+        return;
+    u64 holdtm = lockstats_timestamp() - ll->acq_time;
+    /* discard giant hold times resulting from enabling profiling while lock was being held */
+    if (holdtm > 10*BILLION)
+        return;
+    stats->hold_time_total += holdtm;
+    if (holdtm > stats->hold_time_max)
+        stats->hold_time_max = holdtm;
+    if (holdtm < stats->hold_time_min)
+        stats->hold_time_min = holdtm;
+    stats->hold_hist[lockstats_bucket(holdtm)]++;
+}
+
+/* Spinlocks are released on the cpu that took them, so their held state
+   lives on a per-cpu stack. Entries of locks taken before recording was
+   stopped are never popped; once the stack is full, the oldest entry is
+   dropped to make room. */
+static lockstats_lock lockstats_held_push(lockstats_cpu ls)
+{
+    if (ls->nheld == LOCKSTATS_HELD_MAX) {
+        runtime_memcpy(&ls->held[0], &ls->held[1],
+                       (LOCKSTATS_HELD_MAX - 1) * sizeof(struct lockstats_lock));
+        ls->nheld--;
+    }
+    return &ls->held[ls->nheld++];
+}
+
+static boolean lockstats_held_pop(lockstats_cpu ls, void *lock, lockstats_lock ll)
+{
+    for (int i = ls->nheld - 1; i >= 0; i--) {
+        if (ls->held[i].lock != lock)
+            continue;
+        runtime_memcpy(ll, &ls->held[i], sizeof(struct lockstats_lock));
+        ls->nheld--;
+        if (i < ls->nheld)
+            runtime_memcpy(&ls->held[i], &ls->held[i + 1],
+                           (ls->nheld - i) * sizeof(struct lockstats_lock));
+        return true;
+    }
+    return false;
+}
+
+/* The holder is looked up on the held stacks of all cpus; these are read
+   without synchronization, which at worst misattributes a pair. */
+static void lockstats_spin_wait_begin(lockstats_wait w, spinlock l)
+{
+    cpuinfo ci;
+    w->start = lockstats_timestamp();
+    vector_foreach(cpuinfos, ci) {
+        lockstats_cpu ls = ci->lock_stats;
+        if (!ls)
+            continue;
+        for (int i = 0; i < ls->nheld && i < LOCKSTATS_HELD_MAX; i++) {
+            lockstats_lock ll = &ls->held[i];
+            if (ll->lock == l) {
+                w->holder_hash = ll->trace_hash;
+                w->holder_cpu = ci;
+                return;
+            }
+        }
+    }
+}
+
+static void lockstats_spin_acquired(spinlock l, u64 *fp, boolean acq, u64 spins,
+                                    lockstats_wait w)
+{
+    cpuinfo ci = current_cpu();
+    lockstats_cpu ls = lockstats_get(ci);
+    if (!ls)
+        return;
+    if (acq) {
+        lockstats_lock ll = lockstats_held_push(ls);
+        ll->lock = 0;
+        lockstats_record(ci, ls, fp, l, LOCK_TYPE_SPIN, l->class, true, spins, 0, w, ll);
+        if (!ll->lock)
+            ls->nheld--;
+    } else {
+        lockstats_record(ci, ls, fp, l, LOCK_TYPE_SPIN, l->class, false, 0, 0, 0, 0);
+    }
+    lockstats_put(ci);
+}
+
+void lockstats_spin_lock(spinlock l)
+{
+    volatile u32 *p = (volatile u32 *)&l->locked;
+    u64 spins = 0;
+    struct lockstats_wait w = { 0 };
+    while (*p || !compare_and_swap_32(&l->locked, 0, 1)) {
+        if (spins++ == 0)
+            lockstats_spin_wait_begin(&w, l);
+        kern_pause();
+    }
+    lockstats_spin_acquired(l, get_current_fp(), true, spins, &w);
+}
+
+void lockstats_spin_try(spinlock l, boolean acquired)
+{
+    lockstats_spin_acquired(l, get_current_fp(), acquired, 0, 0);
+}
+
+void lockstats_spin_unlock(spinlock l)
+{
+    cpuinfo ci = current_cpu();
+    lockstats_cpu ls = lockstats_get(ci);
+    if (!ls)
+        return;
+    struct lockstats_lock ll;
+    if (lockstats_held_pop(ls, l, &ll))
+        lockstats_record_unlock(ls, &ll);
+    lockstats_put(ci);
+}
+
+void lockstats_mutex_wait_begin(mutex m, lockstats_wait w)
+{
+    w->start = lockstats_timestamp();
+    w->holder_hash = m->s.trace_hash;
+    w->holder_cpu = m->s.cpu;
+}
+
+void lockstats_mutex_lock(mutex m, boolean acquired, u64 spins, u64 sleeps, lockstats_wait w)
+{
+    cpuinfo ci = current_cpu();
+    lockstats_cpu ls = lockstats_get(ci);
+    if (!ls)
+        return;
+    if (acquired)
+        m->s.trace_hash = 0;
+    lockstats_record(ci, ls, get_current_fp(), m, LOCK_TYPE_MUTEX, m->class, acquired,
+                     spins, sleeps, w, &m->s);
+    lockstats_put(ci);
+}
+
+/* The unlock is only accounted if the mutex is released on a cpu where its
+   acquisition site has been seen. */
+void lockstats_mutex_unlock(mutex m)
+{
+    cpuinfo ci = current_cpu();
+    lockstats_cpu ls = lockstats_get(ci);
+    if (!ls)
+        return;
+    if (m->s.trace_hash) {
+        lockstats_record_unlock(ls, &m->s);
+        m->s.trace_hash = 0;
+    }
+    lockstats_put(ci);
+}
+
 boolean lockstats_print_u64_with_sym(buffer b, u64 n)
 {
     char * name;
@@ -91,16 +363,96 @@ boolean lockstats_print_u64_with_sym(buffer b, u64 n)
     return name != 0;
 }
 
+enum lockstats_sort {
+    LOCKSTATS_SORT_ACQ,
+    LOCKSTATS_SORT_CONT,
+    LOCKSTATS_SORT_SPINS,
+    LOCKSTATS_SORT_WAIT,
+    LOCKSTATS_SORT_HOLD,
+    LOCKSTATS_SORT_SLEEPS,
+    LOCKSTATS_SORT_MAX
+};
+
+static const char * const lockstats_sort_names[LOCKSTATS_SORT_MAX] = {
+    [LOCKSTATS_SORT_ACQ] = "acq",
+    [LOCKSTATS_SORT_CONT] = "cont",
+    [LOCKSTATS_SORT_SPINS] = "spins",
+    [LOCKSTATS_SORT_WAIT] = "wait",
+    [LOCKSTATS_SORT_HOLD] = "hold",
+    [LOCKSTATS_SORT_SLEEPS] = "sleeps",
+};
+
+/* A collated record: either a single acquisition site or, in the class
+   view, the sum of all sites of one lock class. */
+typedef struct lockstats_row {
+    struct lock_stats s;
+    u64 sort_value;
+} *lockstats_row;
+
 static boolean stat_sort_reverse(void *a, void *b)
 {
-    lock_stats sa = a;
-    lock_stats sb = b;
-    if (sa->cont > sb->cont)
-        return false;
-    return true;
+    return ((lockstats_row)a)->sort_value < ((lockstats_row)b)->sort_value;
 }
 
-static pqueue log_collate_and_sort(void)
+static u64 lockstats_sort_value(lock_stats s, int sort)
+{
+    switch (sort) {
+    case LOCKSTATS_SORT_ACQ:
+        return s->acq;
+    case LOCKSTATS_SORT_SPINS:
+        return s->spins_total;
+    case LOCKSTATS_SORT_WAIT:
+        return s->wait_time_total;
+    case LOCKSTATS_SORT_HOLD:
+        return s->hold_time_total;
+    case LOCKSTATS_SORT_SLEEPS:
+        return s->sleep_time_total;
+    default:
+        return s->cont;
+    }
+}
+
+static u64 hash_class_name(const char *class)
+{
+    u64 hash = 0xcbf29ce484222325;
+    while (*class) {
+        hash ^= *class++;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static void lockstats_merge(lock_stats dest, lock_stats s)
+{
+    dest->acq += s->acq;
+    dest->cont += s->cont;
+    dest->tries += s->tries;
+    dest->spins_total += s->spins_total;
+    if (s->cont) {
+        if (s->spins_max > dest->spins_max)
+            dest->spins_max = s->spins_max;
+        if (s->spins_min < dest->spins_min)
+            dest->spins_min = s->spins_min;
+    }
+    dest->hold_time_total += s->hold_time_total;
+    if (s->hold_time_max > dest->hold_time_max)
+        dest->hold_time_max = s->hold_time_max;
+    if (s->hold_time_min < dest->hold_time_min)
+        dest->hold_time_min = s->hold_time_min;
+    dest->sleep_time_total += s->sleep_time_total;
+    dest->wait_time_total += s->wait_time_total;
+    if (s->wait_time_max > dest->wait_time_max)
+        dest->wait_time_max = s->wait_time_max;
+    dest->wait_cpus |= s->wait_cpus;
+    for (int i = 0; i < LOCKSTATS_BUCKETS; i++) {
+        dest->wait_hist[i] += s->wait_hist[i];
+        dest->hold_hist[i] += s->hold_hist[i];
+    }
+}
+
+/* Rows are keyed by acquisition site, or by lock class if by_class is set;
+   locks without a class are then grouped by the first lock address seen. */
+static pqueue log_collate_and_sort(boolean by_class, int sort)
 {
     cpuinfo ci;
     pqueue pq = INVALID_ADDRESS;
@@ -110,26 +462,19 @@ static pqueue log_collate_and_sort(void)
     if (collated == INVALID_ADDRESS)
         goto out;
     vector_foreach(cpuinfos, ci) {
-        table_foreach(ci->lock_stats_table, k, v) {
-            lock_stats stats = table_find(collated, k);
-            if (!stats) {
-                stats = allocate_zero(lockstats_heap, sizeof(struct lock_stats));
-                assert(stats != INVALID_ADDRESS);
-                runtime_memcpy(stats, v, sizeof(struct lock_stats));
-                table_set(collated, k, stats);
-                continue;
-            }
+        table_foreach(ci->lock_stats->stats_table, k, v) {
             lock_stats s = v;
-            stats->acq += s->acq;
-            stats->cont += s->cont;
-            stats->tries += s->tries;
-            stats->spins_total += s->spins_total;
-            if (s->cont) {
-                if (s->spins_max > stats->spins_max)
-                    stats->spins_max = s->spins_max;
-                if (s->spins_min < stats->spins_min)
-                    stats->spins_min = s->spins_min;
+            if (by_class)
+                k = (void *)(s->lock.class ? hash_class_name(s->lock.class) : s->lock.lock_address);
+            lockstats_row row = table_find(collated, k);
+            if (!row) {
+                row = allocate_zero(lockstats_heap, sizeof(struct lockstats_row));
+                assert(row != INVALID_ADDRESS);
+                runtime_memcpy(&row->s, s, sizeof(struct lock_stats));
+                table_set(collated, k, row);
+                continue;
             }
+            lockstats_merge(&row->s, s);
         }
     }
     pq = allocate_pqueue(lockstats_heap, stat_sort_reverse);
@@ -137,49 +482,171 @@ static pqueue log_collate_and_sort(void)
         goto out;
     table_foreach(collated, k, v) {
         (void)k;
-        /* Only print locks with contended acquisitions */
-        if (((lock_stats)v)->cont == 0)
+        lockstats_row row = v;
+        /* Only print locks with contended acquisitions, unless sorting by
+           acquisitions or hold time which are of interest regardless */
+        if (row->s.cont == 0 && sort != LOCKSTATS_SORT_ACQ && sort != LOCKSTATS_SORT_HOLD) {
+            deallocate(lockstats_heap, row, sizeof(struct lockstats_row));
             continue;
-        pqueue_insert(pq, v);
+        }
+        row->sort_value = lockstats_sort_value(&row->s, sort);
+        pqueue_insert(pq, row);
     }
-    deallocate_table(collated);
-out:
+  out:
+    if (collated != INVALID_ADDRESS)
+        deallocate_table(collated);
     record_lock_stats = record_state;
     return pq;
 }
 
-static boolean log_output(pqueue pq, buffer b)
+static void log_output_hist(buffer b, u32 *hist)
+{
+    boolean empty = true;
+    for (int i = 0; i < LOCKSTATS_BUCKETS; i++) {
+        if (!hist[i])
+            continue;
+        bprintf(b, "%s%d:%d", empty ? "" : ",", i, hist[i]);
+        empty = false;
+    }
+    if (empty)
+        bprintf(b, "-");
+}
+
+static void log_output_row(buffer tb, lock_stats s, boolean by_class)
 {
-    lock_stats s;
+    if (by_class) {
+        if (s->lock.class)
+            bprintf(tb, "%s ", s->lock.class);
+        else
+            bprintf(tb, "%p ", s->lock.lock_address);
+        bprintf(tb, "%s %ld %ld %ld %ld %ld %ld %ld %ld %ld 0x%lx ",
+                s->lock.type == 0 ? "spin" : "mutex", s->acq, s->cont, s->tries,
+                s->spins_total, s->hold_time_total, s->hold_time_max, s->sleep_time_total,
+                s->wait_time_total, s->wait_time_max, s->wait_cpus);
+        log_output_hist(tb, s->wait_hist);
+        bprintf(tb, " ");
+        log_output_hist(tb, s->hold_hist);
+        bprintf(tb, "\n");
+        return;
+    }
+    bprintf(tb, "%p %s %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld 0x%lx %s ",
+            s->lock.lock_address,
+            s->lock.type == 0 ? "spin" : "mutex", s->acq,
+            s->cont, s->tries, s->spins_total,
+            s->spins_min, s->spins_max, s->hold_time_total,
+            s->hold_time_min, s->hold_time_max, s->sleep_time_total,
+            s->wait_time_total, s->wait_time_max, s->wait_cpus,
+            s->lock.class ? s->lock.class : "-");
+    for (int i = 0; i < MAX_TRACE_DEPTH; i++) {
+        if (s->lock.lock_trace[i] == 0)
+            break;
+        if (!lockstats_print_u64_with_sym(tb, s->lock.lock_trace[i]))
+            break;
+        bprintf(tb, " ");
+    }
+    bprintf(tb, "\n");
+}
+
+static boolean log_output(pqueue pq, buffer b, boolean by_class)
+{
+    lockstats_row row;
     buffer tb = little_stack_buffer(4*KB);
 
     if (pqueue_peek(pq) == INVALID_ADDRESS)
         return false;
 
-    while ((s = pqueue_peek(pq)) != INVALID_ADDRESS) {
+    while ((row = pqueue_peek(pq)) != INVALID_ADDRESS) {
         buffer_clear(tb);
-        bprintf(tb, "%p %s %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld ", s->lock.lock_address,
-            s->lock.type == 0 ? "spin" : "mutex", s->acq,
-            s->cont, s->tries, s->spins_total,
-            s->spins_min, s->spins_max, s->hold_time_total,
-            s->hold_time_min, s->hold_time_max, s->sleep_time_total);
-        for (int i = 0; i < MAX_TRACE_DEPTH; i++) {
-            if (s->lock.lock_trace[i] == 0)
-                break;
-            if (!lockstats_print_u64_with_sym(tb, s->lock.lock_trace[i]))
-                break;
-            bprintf(tb, " ");
-        }
-        bprintf(tb, "\n");
+        log_output_row(tb, &row->s, by_class);
         if (buffer_length(tb) > buffer_space(b))
             break;
         push_buffer(b, tb);
-        s = pqueue_pop(pq);
-        deallocate(lockstats_heap, s, sizeof(struct lock_stats));
+        row = pqueue_pop(pq);
+        deallocate(lockstats_heap, row, sizeof(struct lockstats_row));
     }
     return true;
 }
 
+static const char lockstats_log_header[] =
+    "# address type acq cont tries spins_total spins_min spins_max hold_total hold_min "
+    "hold_max sleeps wait_total wait_max wait_cpus class backtrace\n";
+static const char lockstats_classes_header[] =
+    "# class type acq cont tries spins_total hold_total hold_max sleeps wait_total "
+    "wait_max wait_cpus wait_hist hold_hist\n";
+static const char lockstats_pairs_header[] =
+    "# count wait_total holder_cpus waiter_class waiter_site holder_class holder_site cpu\n";
+
+/* Describe an acquisition site by its class and the innermost frame of its
+   backtrace. */
+static void lockstats_print_site(buffer b, u64 hash)
+{
+    cpuinfo ci;
+    lock_stats s = 0;
+    vector_foreach(cpuinfos, ci) {
+        s = table_find(ci->lock_stats->stats_table, (void *)hash);
+        if (s)
+            break;
+    }
+    if (!s) {
+        bprintf(b, "- 0x%lx", hash);
+        return;
+    }
+    bprintf(b, "%s ", s->lock.class ? s->lock.class : "-");
+    if (s->lock.lock_trace[0])
+        lockstats_print_u64_with_sym(b, s->lock.lock_trace[0]);
+    else
+        bprintf(b, "0x%lx", hash);
+}
+
+static buffer lockstats_pairs_output(void)
+{
+    cpuinfo ci;
+    boolean record_state = record_lock_stats;
+    record_lock_stats = 0;
+    buffer b = allocate_buffer(lockstats_heap, PAGESIZE);
+    assert(b != INVALID_ADDRESS);
+    buffer_write_cstring(b, lockstats_pairs_header);
+    vector_foreach(cpuinfos, ci) {
+        table_foreach(ci->lock_stats->pairs_table, k, v) {
+            (void)k;
+            lock_pair lp = v;
+            if (!lp->count)
+                continue;
+            bprintf(b, "%ld %ld 0x%lx ", lp->count, lp->wait_time_total, lp->holder_cpus);
+            lockstats_print_site(b, lp->waiter_hash);
+            bprintf(b, " ");
+            lockstats_print_site(b, lp->holder_hash);
+            bprintf(b, " cpu%d\n", ci->id);
+        }
+    }
+    record_lock_stats = record_state;
+    return b;
+}
+
+/* Counters are zeroed in place so that no allocations are needed; samples
+   recorded concurrently on other cpus may be partially cleared. */
+static void lockstats_clear(void)
+{
+    cpuinfo ci;
+    boolean record_state = record_lock_stats;
+    record_lock_stats = 0;
+    vector_foreach(cpuinfos, ci) {
+        table_foreach(ci->lock_stats->stats_table, k, v) {
+            (void)k;
+            lock_stats s = v;
+            runtime_memset((void *)&s->acq, 0, sizeof(*s) - offsetof(lock_stats, acq));
+            s->spins_min = -1u;
+            s->hold_time_min = -1u;
+        }
+        table_foreach(ci->lock_stats->pairs_table, k, v) {
+            (void)k;
+            lock_pair lp = v;
+            lp->count = lp->wait_time_total = lp->holder_cpus = 0;
+        }
+    }
+    record_lock_stats = record_state;
+}
+
 #define catch_err(s) do {if (!is_ok(s)) msg_err("lockstat: failed to send HTTP response: %v\n", (s));} while(0)
 
 static void
@@ -219,17 +686,19 @@ lockstats_send_http_internal_error(http_responder handler, http_method method)
 }
 
 static void
-lockstats_do_http_get_log_chunked(http_responder out)
+lockstats_do_http_get_log_chunked(http_responder out, boolean by_class, int sort)
 {
-    pqueue pq = log_collate_and_sort();
+    pqueue pq = log_collate_and_sort(by_class, sort);
     if (pq == INVALID_ADDRESS) {
         lockstats_send_http_internal_error(out, 0);
         return;
     }
+    send_http_chunk(out, aprintf(lockstats_heap, "%s",
+                                 by_class ? lockstats_classes_header : lockstats_log_header));
     while (true) {
         buffer b = allocate_buffer(lockstats_heap, LOCKSTATS_HTTP_CHUNK_MAXSIZE);
         assert(b != INVALID_ADDRESS);
-        if (!log_output(pq, b)) {
+        if (!log_output(pq, b, by_class)) {
             deallocate_buffer(b);
             break;
         }
@@ -239,6 +708,30 @@ lockstats_do_http_get_log_chunked(http_responder out)
     send_http_chunk(out, 0);
 }
 
+/* match "<view>" or "<view>/<sort field>" */
+static boolean lockstats_parse_view(string uri, const char *view, int *sort)
+{
+    int len = runtime_strlen(view);
+    if (buffer_length(uri) < len || runtime_memcmp(buffer_ref(uri, 0), view, len))
+        return false;
+    if (buffer_length(uri) == len) {
+        *sort = LOCKSTATS_SORT_CONT;
+        return true;
+    }
+    if (*(char *)buffer_ref(uri, len) != '/')
+        return false;
+    buffer field = alloca_wrap_buffer(buffer_ref(uri, len + 1), buffer_length(uri) - len - 1);
+    for (int i = 0; i < LOCKSTATS_SORT_MAX; i++) {
+        if (buffer_compare_with_cstring(field, lockstats_sort_names[i])) {
+            *sort = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static boolean lockstats_enable(boolean enable);
+
 closure_function(0, 3, void, lockstats_http_request,
                  http_method, method, http_responder, handler, value, val)
 {
@@ -253,15 +746,25 @@ closure_function(0, 3, void, lockstats_http_request,
         lockstats_send_http_no_method(handler, method);
         return;
     }
-    if (buffer_compare_with_cstring(relative_uri, "log")) {
+    int sort;
+    if (lockstats_parse_view(relative_uri, "log", &sort)) {
+        lockstats_send_http_chunked_response(handler);
+        lockstats_do_http_get_log_chunked(handler, false, sort);
+    } else if (lockstats_parse_view(relative_uri, "classes", &sort)) {
         lockstats_send_http_chunked_response(handler);
-        lockstats_do_http_get_log_chunked(handler);
+        lockstats_do_http_get_log_chunked(handler, true, sort);
+    } else if (buffer_compare_with_cstring(relative_uri, "pairs")) {
+        lockstats_send_http_response(handler, lockstats_pairs_output());
+    } else if (buffer_compare_with_cstring(relative_uri, "clear")) {
+        lockstats_clear();
+        lockstats_send_http_response(handler,
+               aprintf(lockstats_heap, "lock profile cleared\n"));
     } else if (buffer_compare_with_cstring(relative_uri, "enable")) {
         lockstats_send_http_response(handler,
                aprintf(lockstats_heap, "lock profiling enabled\n"));
-        record_lock_stats = true;
+        lockstats_enable(true);
     } else if (buffer_compare_with_cstring(relative_uri, "disable")) {
-        record_lock_stats = false;
+        lockstats_enable(false);
         lockstats_send_http_response(handler,
                aprintf(lockstats_heap, "lock profiling disabled\n"));
     } else {
@@ -302,18 +805,86 @@ init_http_listener(void)
     return 0;
 }
 
-void lockstats_init(kernel_heaps kh)
+static void lockstats_cpu_free(lockstats_cpu ls)
+{
+    if (ls->stats_table && ls->stats_table != INVALID_ADDRESS)
+        deallocate_table(ls->stats_table);
+    if (ls->stats_heap && ls->stats_heap != INVALID_ADDRESS)
+        destroy_heap(ls->stats_heap);
+    if (ls->pairs_table && ls->pairs_table != INVALID_ADDRESS)
+        deallocate_table(ls->pairs_table);
+    if (ls->pairs_heap && ls->pairs_heap != INVALID_ADDRESS)
+        destroy_heap(ls->pairs_heap);
+    deallocate(lockstats_heap, ls, sizeof(struct lockstats_cpu));
+}
+
+static lockstats_cpu lockstats_cpu_alloc(void)
+{
+    heap h = lockstats_heap;
+    heap backed = lockstats_backed;
+    lockstats_cpu ls = allocate_zero(h, sizeof(struct lockstats_cpu));
+    if (ls == INVALID_ADDRESS)
+        return ls;
+    ls->stats_table = allocate_table_preallocated(h, backed, identity_key, pointer_equal,
+                                                  LOCKSTATS_PREALLOC);
+    ls->stats_heap = (heap)allocate_objcache_preallocated(h, backed,
+        sizeof(struct lock_stats), PAGESIZE, LOCKSTATS_PREALLOC, true);
+    ls->pairs_table = allocate_table_preallocated(h, backed, identity_key, pointer_equal,
+                                                  LOCKSTATS_PREALLOC);
+    ls->pairs_heap = (heap)allocate_objcache_preallocated(h, backed,
+        sizeof(struct lock_pair), PAGESIZE, LOCKSTATS_PREALLOC, true);
+    if (ls->stats_table == INVALID_ADDRESS || ls->stats_heap == INVALID_ADDRESS ||
+        ls->pairs_table == INVALID_ADDRESS || ls->pairs_heap == INVALID_ADDRESS) {
+        lockstats_cpu_free(ls);
+        return INVALID_ADDRESS;
+    }
+    return ls;
+}
+
+/* The per-cpu tables and the http listener are only set up when recording
+   is first enabled, so that a kernel which never profiles locks pays for
+   neither. This runs from the root tuple notify, which enables recording
+   before http can. */
+static boolean lockstats_setup(void)
 {
-    heap h = heap_general(kh);
-    heap backed = (heap)heap_linear_backed(kh);
-    lockstats_heap = h;
     cpuinfo ci;
+    if (lockstats_allocated)
+        return true;
     vector_foreach(cpuinfos, ci) {
-        ci->lock_stats_table = allocate_table_preallocated(h, backed, identity_key, pointer_equal, LOCKSTATS_PREALLOC);
-        ci->lock_stats_heap = (heap)allocate_objcache_preallocated(h, backed,
-            sizeof(struct lock_stats), PAGESIZE, LOCKSTATS_PREALLOC, true);
+        if (ci->lock_stats)
+            continue;
+        lockstats_cpu ls = lockstats_cpu_alloc();
+        if (ls == INVALID_ADDRESS) {
+            msg_err("lockstat: failed to allocate profiling state for cpu %d\n", ci->id);
+            return false;
+        }
+        ci->lock_stats = ls;
     }
-    int ret = init_http_listener();
-    if (ret != 0)
+    lockstats_allocated = true;
+    if (init_http_listener() != 0)
         rprintf("%s: failed to start http listener\n", __func__);
+    return true;
+}
+
+static boolean lockstats_enable(boolean enable)
+{
+    if (enable && !lockstats_setup())
+        return false;
+    write_barrier();
+    record_lock_stats = enable;
+    return true;
+}
+
+closure_function(0, 1, boolean, lockstats_notify,
+                 value, v)
+{
+    return lockstats_enable(!!v);
+}
+
+void lockstats_init(kernel_heaps kh)
+{
+    lockstats_heap = heap_general(kh);
+    lockstats_backed = (heap)heap_linear_backed(kh);
+    /* applied at once if the option is set in the manifest */
+    register_root_notify(sym(lockstats), closure(lockstats_heap, lockstats_notify));
 }
@@ -1,10 +1,15 @@
 #define MAX_TRACE_DEPTH 8
 
+/* Log2 histogram buckets of wait and hold times, in lockstats_timestamp()
+   units: bucket n counts times in [2^(n-1), 2^n). */
+#define LOCKSTATS_BUCKETS 32
+
 typedef struct lock_block {
     u64 lock_trace[MAX_TRACE_DEPTH];
     u64 lock_address;
     int type;               /* lock type */
     u64 hash;
+    const char *class;      /* class name of the first lock seen, if any */
 } *lock_block;
 
 typedef struct lock_stats {
@@ -19,78 +24,47 @@ typedef struct lock_stats {
     u64 hold_time_max;      /* max time holding lock */
     u64 hold_time_min;      /* min time holding lock */
     u64 sleep_time_total;   /* time spent sleeping for lock */
-
+    u64 wait_time_total;    /* time from first failed attempt to acquisition */
+    u64 wait_time_max;
+    u64 wait_cpus;          /* mask of cpus (modulo 64) that waited */
+    u32 wait_hist[LOCKSTATS_BUCKETS];
+    u32 hold_hist[LOCKSTATS_BUCKETS];
 } *lock_stats;
 
-void lockstats_init(kernel_heaps kh);
-
-#ifdef __x86_64__
-static inline u64 lockstats_rdtscp(void)
-{
-    u32 a, d;
-    if (platform_has_precise_clocksource())
-        asm volatile("rdtscp" : "=a" (a), "=d" (d) :: "%rcx");
-    else
-        asm volatile("rdtsc" : "=a" (a), "=d" (d) :: "%rcx");
-    return (((u64)a) | (((u64)d) << 32));
-}
+/* contention between the acquisition site of a waiter and that of the holder */
+typedef struct lock_pair {
+    u64 waiter_hash;
+    u64 holder_hash;
+    u64 count;
+    u64 wait_time_total;
+    u64 holder_cpus;        /* mask of holder cpus (modulo 64) */
+} *lock_pair;
 
-#define lockstats_timestamp() lockstats_rdtscp()
-#else
-#define lockstats_timestamp() (nsec_from_timestamp(now(CLOCK_ID_MONOTONIC)))
-#endif
+/* Per-cpu profiling state, allocated when recording is first enabled */
+#define LOCKSTATS_HELD_MAX 16
 
-#define LOCKSTATS_RECORD_LOCK(L, A, N, S)                       \
-            if (record_lock_stats) {                               \
-                if (A) L.acq_time = lockstats_timestamp();         \
-                lockstats_record(&L, A, N, S);     \
-            }
-
-#define LOCKSTATS_RECORD_UNLOCK(L) \
-    if (record_lock_stats) { lockstats_record_unlock(&L, lockstats_timestamp() - L.acq_time); }
+typedef struct lockstats_cpu {
+    table stats_table;
+    heap stats_heap;
+    table pairs_table;
+    heap pairs_heap;
+    int nheld;
+    struct lockstats_lock held[LOCKSTATS_HELD_MAX]; /* held spinlocks, innermost last */
+} *lockstats_cpu;
 
+/* Lock profiling is built into every kernel but is off until enabled with
+   the "lockstats" root option, at boot or at runtime, or over http. The
+   lock primitives test this flag and call out of line when it is set. */
 extern boolean record_lock_stats;
 
-lock_stats get_lockstats_block(lockstats_lock ll, boolean islocking);
-
-static inline void lockstats_record(lockstats_lock ll, boolean acq, u64 spins, u64 sleeps)
-{
-    if (!record_lock_stats)
-        return;
-    lock_stats stats = get_lockstats_block(ll, true);
-    if (!stats)
-        return;
-    if (!acq) {
-        stats->tries++;
-        return;
-    }
-    stats->acq++;
-    if (spins > 0) {
-        stats->spins_total += spins;
-        if (spins > stats->spins_max)
-            stats->spins_max = spins;
-        if (spins < stats->spins_min)
-            stats->spins_min = spins;
-        stats->sleep_time_total += sleeps;
-        stats->cont++;
-    }
-    ll->trace_hash = stats->lock.hash;
-}
+void lockstats_init(kernel_heaps kh);
 
-static inline void lockstats_record_unlock(lockstats_lock ll, u64 holdtm)
-{
-    lock_stats stats = get_lockstats_block(ll, false);
-    /* XXX unlocks on a cpu that has never first locked this hash will be dropped */
-    if (!stats)
-        return;
+void lockstats_spin_lock(spinlock l);
+void lockstats_spin_try(spinlock l, boolean acquired);
+void lockstats_spin_unlock(spinlock l);
 
-    ll->trace_hash = 0;
-    /* discard giant hold times resulting from enabling profiling while lock was being held */
-    if (holdtm > 10*BILLION)
-        return;
-    stats->hold_time_total += holdtm;
-    if (holdtm > stats->hold_time_max)
-        stats->hold_time_max = holdtm;
-    if (holdtm < stats->hold_time_min)
-        stats->hold_time_min = holdtm;
-}
+struct mutex;
+void lockstats_mutex_wait_begin(struct mutex *m, lockstats_wait w);
+void lockstats_mutex_lock(struct mutex *m, boolean acquired, u64 spins, u64 sleeps,
+                          lockstats_wait w);
+void lockstats_mutex_unlock(struct mutex *m);
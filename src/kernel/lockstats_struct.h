@@ -1,8 +1,21 @@
 #define LOCK_TYPE_SPIN 0
 #define LOCK_TYPE_MUTEX 1
 
+/* State of a held lock for hold time and contention pair accounting. For
+   spinlocks, this is kept out of line on a per-cpu stack of held locks; a
+   mutex, which may be released on another cpu, embeds it. */
 typedef struct lockstats_lock {
-    int type;
+    void *lock;
+    void *cpu;                  /* cpuinfo of the acquirer */
     u64 acq_time;
     u64 trace_hash;
 } *lockstats_lock;
+
+/* snapshot taken by a waiter at its first failed acquisition attempt */
+typedef struct lockstats_wait {
+    u64 start;
+    u64 holder_hash;            /* trace hash of the holder's acquisition */
+    void *holder_cpu;           /* cpuinfo */
+} *lockstats_wait;
+
+u32 lockstats_class_id(const char *class);
@@ -6,9 +6,8 @@ typedef struct mutex {
     struct list waiters;
     u64 mcs_spinouts;           /* stats */
     u64 acquire_spinouts;
-#ifdef LOCK_STATS
+    u32 class;                  /* lock profiling class id */
     struct lockstats_lock s;
-#endif
 } *mutex;
 
 boolean mutex_try_lock(mutex ql);
@@ -20,4 +19,7 @@ void mutex_unlock(mutex ql);
 #define mutex_is_locked(m)      ((m)->turn != 0)
 #define mutex_is_acquired(m)    ((m)->turn == get_current_context(current_cpu()))
 
-mutex allocate_mutex(heap h, u64 spin_iterations);
+/* class is an optional name for lock profiling; it must point to static storage */
+mutex allocate_mutex_class(heap h, u64 spin_iterations, const char *class);
+
+#define allocate_mutex(h, spin_iterations) allocate_mutex_class(h, spin_iterations, 0)
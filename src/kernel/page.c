@@ -565,7 +565,7 @@ void init_page_initial_map(void *initial_map, range phys)
     page_init_debug(", length ");
     page_init_debug_u64(range_span(phys));
     page_init_debug("\n");
-    spin_lock_init(&pt_lock);
+    spin_lock_init_class(&pt_lock, "pagetable");
     pagemem.current_phys = phys;
     pagemem.pageheap = 0;
     pagemem.initial_map = initial_map;
@@ -27,6 +27,20 @@ void page_invalidate(flush_entry f, u64 address);
 void page_invalidate_sync(flush_entry f, status_handler completion);
 void page_invalidate_flush();
 
+/* Paravirtual remote TLB flush: cpus in the mask whose TLBs have been (or are
+   guaranteed to be, before they next run) fully flushed are cleared from it;
+   the remaining cpus are sent a flush IPI. */
+typedef closure_type(remote_tlb_flush, void, u64 * /* cpu mask */, u64 /* ncpus */);
+void register_remote_tlb_flush(remote_tlb_flush rf);
+
+typedef struct flush_stats {
+    u64 shootdowns;     /* page_invalidate_sync() calls that needed remote flushes */
+    u64 ipis;           /* flush IPIs sent (a broadcast counts once per target) */
+    u64 idle_skipped;   /* idle cpus left to catch up on wakeup */
+    u64 pv_flushed;     /* cpus flushed by the hypervisor */
+} *flush_stats;
+void page_invalidate_get_stats(flush_stats s);
+
 void invalidate(u64 page);
 void flush_tlb(boolean full_flush);
 
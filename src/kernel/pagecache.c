@@ -10,6 +10,7 @@
 /* don't care for this ... but we're used in both kernel and other contexts ... maybe split up */
 #ifdef KERNEL
 #include <kernel.h>
+#include <storage.h>
 #else
 #include <runtime.h>
 typedef void *nanos_thread;
@@ -179,6 +180,10 @@ static inline void change_page_state_locked(pagecache pc, pagecache_page pp, int
         } else if (old_state == PAGECACHE_PAGESTATE_WRITING) {
             pagelist_move(&pc->new, &pc->writing, pp);
             refcount_release(&pp->node->refcount);
+        } else if (old_state == PAGECACHE_PAGESTATE_DIRTY) {
+            /* only for discarding pages of nodes without backing storage */
+            pagelist_enqueue(&pc->new, pp);
+            refcount_release(&pp->node->refcount);
         } else {
             assert(old_state == PAGECACHE_PAGESTATE_READING);
             pagelist_enqueue(&pc->new, pp);
@@ -514,6 +519,10 @@ static pagecache_page touch_or_fill_page_by_num_nodelocked(pagecache_node pn, u6
 /* called with node locked */
 static boolean pagecache_set_dirty(pagecache_node pn, range r)
 {
+    /* Without backing storage there is nothing to write back; dirty pages stay resident (and
+       unreclaimable) until discarded. */
+    if (!pn->fs_write)
+        return true;
     if (!rangemap_insert_range(&pn->dirty, r))
         return false;
     pagecache_debug("node %p, added dirty range %R\n", pn, r);
@@ -863,6 +872,9 @@ closure_function(3, 1, void, pagecache_commit_dirty_ranges,
     merge m = allocate_merge(pc->h, (status_handler)closure_self());
     status_handler sh = apply_merge(m);
     u64 committing = 0;
+#ifdef KERNEL
+    storage_plug();
+#endif
     pagecache_lock_node(pn);
     u64 limit = pn->length;
     while (buffer_length(dirty) > 0 && committing < COMMIT_LIMIT) {
@@ -934,6 +946,9 @@ closure_function(3, 1, void, pagecache_commit_dirty_ranges,
               closure(pc->h, pagecache_commit_complete, pc, first_page, page_count, sg, apply_merge(m)));
     }
     pagecache_unlock_node(pn);
+#ifdef KERNEL
+    storage_unplug();
+#endif
     apply(sh, s);
 }
 
@@ -983,6 +998,10 @@ static void pagecache_commit_dirty_pages(pagecache pc)
 {
     pagecache_debug("%s\n", __func__);
 
+    /* let the storage queues merge writes across nodes */
+#ifdef KERNEL
+    storage_plug();
+#endif
     pagecache_lock(pc);
     list_foreach(&pc->volumes, l) {
         pagecache_volume pv = struct_from_list(l, pagecache_volume, l);
@@ -1000,6 +1019,9 @@ static void pagecache_commit_dirty_pages(pagecache pc)
         } while (pn);
     }
     pagecache_unlock(pc);
+#ifdef KERNEL
+    storage_unplug();
+#endif
 }
 
 static void pagecache_scan(pagecache pc)
@@ -1028,6 +1050,50 @@ void pagecache_sync_node(pagecache_node pn, status_handler complete)
     pagecache_scan_node(pn);
     pagecache_commit_dirty_node(pn, complete);
 }
+
+/* Drop cached data at and beyond offset, zeroing the remainder of a partial page at the
+   boundary. This is meant for nodes without backing storage, whose dirty pages are otherwise
+   retained for the lifetime of the node; the caller must first unmap the affected range. */
+void pagecache_node_discard_pages(pagecache_node pn, u64 offset)
+{
+    pagecache pc = pn->pv->pc;
+    u64 pi = offset >> pc->page_order;
+    u64 page_start = offset & MASK(pc->page_order);
+    struct pagecache_page k;
+    k.state_offset = pi;
+    pagecache_debug("%s: pn %p, offset 0x%lx\n", __func__, pn, offset);
+    pagecache_lock_node(pn);
+    pagecache_page pp = (pagecache_page)rbtree_lookup_max_lte(&pn->pages, &k.rbnode);
+    if (pp == INVALID_ADDRESS)
+        pp = (pagecache_page)rbtree_find_first(&pn->pages);
+    else if (page_offset(pp) < pi)
+        pp = (pagecache_page)rbnode_get_next((rbnode)pp);
+    pagecache_lock_state(pc);
+    for (; pp != INVALID_ADDRESS; pp = (pagecache_page)rbnode_get_next((rbnode)pp)) {
+        int state = page_state(pp);
+        if (state == PAGECACHE_PAGESTATE_FREE || state == PAGECACHE_PAGESTATE_EVICTED)
+            continue;
+        if (page_offset(pp) == pi && page_start) {
+            zero(pp->kvirt + page_start, cache_pagesize(pc) - page_start);
+            continue;
+        }
+
+        /* A page may outlive the discard if still referenced, so clear stale contents. */
+        zero(pp->kvirt, cache_pagesize(pc));
+        if (state == PAGECACHE_PAGESTATE_READING || state == PAGECACHE_PAGESTATE_WRITING)
+            continue;
+        if (state == PAGECACHE_PAGESTATE_DIRTY) {
+            change_page_state_locked(pc, pp, PAGECACHE_PAGESTATE_NEW);
+            pagecache_page_release_locked(pc, pp);
+        }
+        if (!pp->evicted) {
+            pagecache_page_release_locked(pc, pp);
+            pp->evicted = true;
+        }
+    }
+    pagecache_unlock_state(pc);
+    pagecache_unlock_node(pn);
+}
 #endif /* !PAGECACHE_READ_ONLY */
 
 typedef closure_type(pp_handler, void, pagecache_page);
@@ -1587,7 +1653,7 @@ pagecache_node pagecache_allocate_node(pagecache_volume pv, sg_io fs_read, sg_io
         return INVALID_ADDRESS;
     }
 #ifdef KERNEL
-    spin_lock_init(&pn->pages_lock);
+    spin_lock_init_class(&pn->pages_lock, "pagecache_node");
 #endif
     list_init_member(&pn->l);
     init_rangemap(&pn->dirty, h);
@@ -1637,7 +1703,7 @@ pagecache_volume pagecache_allocate_volume(u64 length, int block_order)
     pagecache_unlock(pc);
     list_init(&pv->dirty_nodes);
 #ifdef KERNEL
-    spin_lock_init(&pv->lock);
+    spin_lock_init_class(&pv->lock, "pagecache_volume");
     if (!timer_is_active(&pc->scan_timer)) {
         timestamp t = seconds(PAGECACHE_SCAN_PERIOD_SECONDS);
         register_timer(kernel_timers, &pc->scan_timer, CLOCK_ID_MONOTONIC, t, false, t,
@@ -1686,8 +1752,8 @@ void init_pagecache(heap general, heap contiguous, heap physical, u64 pagesize)
     pc->completions = (heap)allocate_objcache(general, contiguous, sizeof(struct page_completion),
                                               PAGESIZE, true);
     assert(pc->completions != INVALID_ADDRESS);
-    spin_lock_init(&pc->state_lock);
-    spin_lock_init(&pc->global_lock);
+    spin_lock_init_class(&pc->state_lock, "pagecache_state");
+    spin_lock_init_class(&pc->global_lock, "pagecache_global");
 #else
     pc->completions = general;
 #endif
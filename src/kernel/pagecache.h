@@ -12,6 +12,8 @@ void pagecache_node_finish_pending_writes(pagecache_node pn, status_handler comp
 
 void pagecache_sync_node(pagecache_node pn, status_handler complete);
 
+void pagecache_node_discard_pages(pagecache_node pn, u64 offset);
+
 void pagecache_sync_volume(pagecache_volume pv, status_handler complete);
 
 void *pagecache_get_zero_page(void);
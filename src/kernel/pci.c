@@ -162,12 +162,13 @@ u64 pci_msix_table_slot_addr(pci_dev dev, int msi_slot)
     return pci_msix_table_addr(dev) + (msi_slot * sizeof(u32) * 4);
 }
 
-u64 pci_setup_msix(pci_dev dev, int msi_slot, thunk h, const char *name)
+/* Where the platform supports it, the interrupt is delivered to target_cpu. */
+u64 pci_setup_msix_target(pci_dev dev, int msi_slot, thunk h, const char *name, u32 target_cpu)
 {
-    pci_debug("%s: msi %d: %s\n", __func__, msi_slot, name);
+    pci_debug("%s: msi %d: %s, cpu %d\n", __func__, msi_slot, name, target_cpu);
 
     u32 address, data;
-    u64 vector = pci_platform_allocate_msi(dev, h, name, &address, &data);
+    u64 vector = pci_platform_allocate_msi(dev, h, name, target_cpu, &address, &data);
     if (vector == INVALID_PHYSICAL)
         return vector;
 
@@ -181,6 +182,11 @@ u64 pci_setup_msix(pci_dev dev, int msi_slot, thunk h, const char *name)
     return vector;
 }
 
+u64 pci_setup_msix(pci_dev dev, int msi_slot, thunk h, const char *name)
+{
+    return pci_setup_msix_target(dev, msi_slot, h, name, 0);
+}
+
 void pci_teardown_msix(pci_dev dev, int msi_slot)
 {
     u64 slot_addr = pci_msix_table_slot_addr(dev, msi_slot);
@@ -0,0 +1,391 @@
+/* per-cpu object cache
+
+   This heap wraps an (unlocked) mcache and keeps, on each cpu, a
+   magazine of free objects for each of the smaller size classes, so
+   that most allocations and deallocations of small objects are served
+   without touching the shared mcache (the "depot") or its lock. An empty
+   magazine is refilled, and a full one is flushed, by moving half a
+   magazine of objects under a single acquisition of the depot lock. An
+   object freed on a cpu other than the one it was allocated on simply
+   lands in the magazine of the freeing cpu; cross-cpu frees are thus
+   returned to the depot in batches like any other.
+
+   Requests for larger sizes go straight to the depot under its lock, as
+   do all requests until percpu_cache_enable() is called, which must
+   happen after the number of cpus is known.
+
+   As with mcache, deallocations may be made with a size of -1ull; the
+   size class is then found from the objcache page footer.
+
+   Draining the heap (e.g. from a memory cleaner) flushes the magazines
+   of all cpus and releases free depot pages to the parent heap.
+*/
+
+#include <kernel.h>
+#include <management.h>
+
+//#define PCACHE_DEBUG
+#ifdef PCACHE_DEBUG
+#define pcache_debug(x, ...) do {rprintf("PCACHE: " x, ##__VA_ARGS__);} while(0)
+#else
+#define pcache_debug(x, ...)
+#endif
+
+#define PCACHE_MAX_CLASSES  8
+
+typedef struct pcache_cpu {
+    struct spinlock lock;
+    u64 allocs;                 /* served from magazine */
+    u64 frees;                  /* absorbed by magazine */
+    u64 refills;
+    u64 flushes;
+    u32 count[PCACHE_MAX_CLASSES];
+    u64 objs[];                 /* magazine_size entries per class */
+} *pcache_cpu;
+
+typedef struct pcache {
+    struct caching_heap ch;
+    heap parent;
+    heap meta;
+    struct spinlock lock;       /* protects parent */
+    bytes parent_pagesize;
+    int min_order;
+    int nclasses;
+    u32 magazine_size;
+    u32 ncpus;
+    pcache_cpu *cpus;
+    tuple mgmt;
+} *pcache;
+
+#define lock_depot(pc) u64 _flags = spin_lock_irq(&(pc)->lock)
+#define unlock_depot(pc) spin_unlock_irq(&(pc)->lock, _flags)
+
+static inline int pcache_class(pcache pc, bytes size)
+{
+    int class = MAX(find_order(size), pc->min_order) - pc->min_order;
+    return class < pc->nclasses ? class : -1;
+}
+
+static inline bytes pcache_class_size(pcache pc, int class)
+{
+    return U64_FROM_BIT(pc->min_order + class);
+}
+
+static inline u64 *pcache_magazine(pcache pc, pcache_cpu c, int class)
+{
+    return c->objs + class * pc->magazine_size;
+}
+
+static inline pcache_cpu pcache_get_cpu(pcache pc)
+{
+    pcache_cpu *cpus = pc->cpus;
+    if (!cpus)
+        return 0;
+    u32 id = current_cpu()->id;
+    return id < pc->ncpus ? cpus[id] : 0;
+}
+
+/* called with cpu lock held */
+static void pcache_refill(pcache pc, pcache_cpu c, int class)
+{
+    u64 *mag = pcache_magazine(pc, c, class);
+    bytes size = pcache_class_size(pc, class);
+    u32 n = c->count[class];
+    u32 target = pc->magazine_size / 2;
+    lock_depot(pc);
+    while (n < target) {
+        u64 a = allocate_u64(pc->parent, size);
+        if (a == INVALID_PHYSICAL)
+            break;
+        mag[n++] = a;
+    }
+    unlock_depot(pc);
+    c->count[class] = n;
+    c->refills++;
+}
+
+/* Return the n least recently freed objects of a class to the depot;
+   called with cpu lock held. */
+static void pcache_flush(pcache pc, pcache_cpu c, int class, u32 n)
+{
+    u64 *mag = pcache_magazine(pc, c, class);
+    bytes size = pcache_class_size(pc, class);
+    lock_depot(pc);
+    for (u32 i = 0; i < n; i++)
+        deallocate_u64(pc->parent, mag[i], size);
+    unlock_depot(pc);
+    u32 remain = c->count[class] - n;
+    if (remain)
+        runtime_memcpy(mag, mag + n, remain * sizeof(u64));
+    c->count[class] = remain;
+    c->flushes++;
+}
+
+static u64 pcache_depot_alloc(pcache pc, bytes size)
+{
+    lock_depot(pc);
+    u64 a = allocate_u64(pc->parent, size);
+    unlock_depot(pc);
+    return a;
+}
+
+static void pcache_depot_dealloc(pcache pc, u64 a, bytes size)
+{
+    lock_depot(pc);
+    deallocate_u64(pc->parent, a, size);
+    unlock_depot(pc);
+}
+
+static u64 pcache_alloc(heap h, bytes size)
+{
+    pcache pc = (pcache)h;
+    int class = pcache_class(pc, size);
+    pcache_cpu c;
+    if (class < 0 || !(c = pcache_get_cpu(pc)))
+        return pcache_depot_alloc(pc, size);
+    u64 a;
+    u64 flags = spin_lock_irq(&c->lock);
+    if (c->count[class] == 0)
+        pcache_refill(pc, c, class);
+    if (c->count[class] > 0) {
+        a = pcache_magazine(pc, c, class)[--c->count[class]];
+        c->allocs++;
+    } else {
+        a = INVALID_PHYSICAL;
+    }
+    spin_unlock_irq(&c->lock, flags);
+    return a;
+}
+
+static void pcache_dealloc(heap h, u64 a, bytes size)
+{
+    pcache pc = (pcache)h;
+    pcache_cpu c = pcache_get_cpu(pc);
+    if (!c) {
+        pcache_depot_dealloc(pc, a, size);
+        return;
+    }
+    int class;
+    if (size == -1ull) {
+        heap o = objcache_from_object(a, pc->parent_pagesize);
+        class = (o != INVALID_ADDRESS) ? pcache_class(pc, o->pagesize) : -1;
+    } else {
+        class = pcache_class(pc, size);
+    }
+    if (class < 0) {
+        pcache_depot_dealloc(pc, a, size);
+        return;
+    }
+    u64 flags = spin_lock_irq(&c->lock);
+    if (c->count[class] == pc->magazine_size)
+        pcache_flush(pc, c, class, pc->magazine_size / 2);
+    pcache_magazine(pc, c, class)[c->count[class]++] = a;
+    c->frees++;
+    spin_unlock_irq(&c->lock, flags);
+}
+
+static bytes pcache_drain(caching_heap ch, bytes len, bytes retain)
+{
+    pcache pc = (pcache)ch;
+    pcache_cpu *cpus = pc->cpus;
+    if (cpus) {
+        for (u32 i = 0; i < pc->ncpus; i++) {
+            pcache_cpu c = cpus[i];
+            u64 flags = spin_lock_irq(&c->lock);
+            for (int class = 0; class < pc->nclasses; class++) {
+                if (c->count[class])
+                    pcache_flush(pc, c, class, c->count[class]);
+            }
+            spin_unlock_irq(&c->lock, flags);
+        }
+    }
+    lock_depot(pc);
+    bytes drained = mcache_drain(pc->parent, len, retain);
+    unlock_depot(pc);
+    pcache_debug("%s: drained %ld / %ld bytes\n", __func__, drained, len);
+    return drained;
+}
+
+static bytes pcache_cached(pcache pc)
+{
+    pcache_cpu *cpus = pc->cpus;
+    bytes cached = 0;
+    if (cpus) {
+        for (u32 i = 0; i < pc->ncpus; i++) {
+            for (int class = 0; class < pc->nclasses; class++)
+                cached += cpus[i]->count[class] * pcache_class_size(pc, class);
+        }
+    }
+    return cached;
+}
+
+/* Objects held in magazines are allocated from the point of view of the
+   depot but not of the users of this heap. */
+static bytes pcache_allocated(heap h)
+{
+    pcache pc = (pcache)h;
+    lock_depot(pc);
+    bytes allocated = heap_allocated(pc->parent);
+    unlock_depot(pc);
+    bytes cached = pcache_cached(pc);
+    return allocated > cached ? allocated - cached : 0;
+}
+
+static bytes pcache_total(heap h)
+{
+    pcache pc = (pcache)h;
+    lock_depot(pc);
+    bytes total = heap_total(pc->parent);
+    unlock_depot(pc);
+    return total;
+}
+
+static void pcache_destroy(heap h)
+{
+    pcache pc = (pcache)h;
+    pcache_cpu *cpus = pc->cpus;
+    if (cpus) {
+        bytes cpu_size = sizeof(struct pcache_cpu) +
+            pc->nclasses * pc->magazine_size * sizeof(u64);
+        pcache_drain(&pc->ch, 0, 0);
+        for (u32 i = 0; i < pc->ncpus; i++)
+            deallocate(pc->meta, cpus[i], cpu_size);
+        deallocate(pc->meta, cpus, pc->ncpus * sizeof(pcache_cpu));
+    }
+    destroy_heap(pc->parent);
+    deallocate(pc->meta, pc, sizeof(*pc));
+}
+
+enum {
+    PCACHE_STAT_ALLOCS,
+    PCACHE_STAT_FREES,
+    PCACHE_STAT_REFILLS,
+    PCACHE_STAT_FLUSHES,
+    PCACHE_STAT_CACHED,
+};
+
+closure_function(3, 0, value, pcache_get_stat,
+                 pcache, pc, int, stat, value, v)
+{
+    pcache pc = bound(pc);
+    pcache_cpu *cpus = pc->cpus;
+    u64 result = 0;
+    if (bound(stat) == PCACHE_STAT_CACHED) {
+        result = pcache_cached(pc);
+    } else if (cpus) {
+        for (u32 i = 0; i < pc->ncpus; i++) {
+            pcache_cpu c = cpus[i];
+            switch (bound(stat)) {
+            case PCACHE_STAT_ALLOCS:
+                result += c->allocs;
+                break;
+            case PCACHE_STAT_FREES:
+                result += c->frees;
+                break;
+            case PCACHE_STAT_REFILLS:
+                result += c->refills;
+                break;
+            case PCACHE_STAT_FLUSHES:
+                result += c->flushes;
+                break;
+            }
+        }
+    }
+    return value_rewrite_u64(bound(v), result);
+}
+
+static value pcache_management(heap h)
+{
+    static const char * const stat_names[] = {
+        [PCACHE_STAT_ALLOCS] = "allocs",
+        [PCACHE_STAT_FREES] = "frees",
+        [PCACHE_STAT_REFILLS] = "refills",
+        [PCACHE_STAT_FLUSHES] = "flushes",
+        [PCACHE_STAT_CACHED] = "cached",
+    };
+    pcache pc = (pcache)h;
+    if (pc->mgmt)
+        return pc->mgmt;
+    tuple t = timm("type", "percpu_cache", "min_size", "%ld", pcache_class_size(pc, 0),
+                   "max_size", "%ld", pcache_class_size(pc, pc->nclasses - 1),
+                   "magazine_size", "%d", pc->magazine_size);
+    assert(t != INVALID_ADDRESS);
+    tuple_notifier n = tuple_notifier_wrap(t);
+    assert(n != INVALID_ADDRESS);
+    for (int stat = 0; stat < sizeof(stat_names) / sizeof(stat_names[0]); stat++) {
+        value v = value_from_u64(pc->meta, 0);
+        symbol s = sym_this((char *)stat_names[stat]);
+        set(t, s, v);
+        tuple_notifier_register_get_notify(n, s, closure(pc->meta, pcache_get_stat, pc, stat, v));
+    }
+    pc->mgmt = (tuple)n;
+    return n;
+}
+
+/* Allocate magazines of magazine_size objects for each size class on
+   each cpu; must be called once all cpus have been counted. */
+boolean percpu_cache_enable(caching_heap ch, u32 magazine_size)
+{
+    pcache pc = (pcache)ch;
+    assert(!pc->cpus);
+    if (magazine_size < 2)
+        return false;
+    u32 ncpus = MAX(present_processors, total_processors);
+    bytes cpu_size = sizeof(struct pcache_cpu) +
+        pc->nclasses * magazine_size * sizeof(u64);
+    pcache_cpu *cpus = allocate(pc->meta, ncpus * sizeof(pcache_cpu));
+    if (cpus == INVALID_ADDRESS)
+        return false;
+    for (u32 i = 0; i < ncpus; i++) {
+        pcache_cpu c = allocate_zero(pc->meta, cpu_size);
+        if (c == INVALID_ADDRESS) {
+            while (i-- > 0)
+                deallocate(pc->meta, cpus[i], cpu_size);
+            deallocate(pc->meta, cpus, ncpus * sizeof(pcache_cpu));
+            return false;
+        }
+        spin_lock_init_class(&c->lock, "pcache_cpu");
+        cpus[i] = c;
+    }
+    pc->magazine_size = magazine_size & ~1;
+    pc->ncpus = ncpus;
+    write_barrier();
+    pc->cpus = cpus;
+    pcache_debug("%s: %d cpus, %d classes, magazine size %d\n", __func__,
+                 ncpus, pc->nclasses, pc->magazine_size);
+    return true;
+}
+
+/* parent must be an mcache created with parent_pagesize and a
+   min_order no greater than the one given here; objects of sizes up
+   to 2^max_order are cached per cpu. */
+caching_heap percpu_cache_wrapper(heap meta, heap parent, bytes parent_pagesize,
+                                  int min_order, int max_order)
+{
+    if (max_order < min_order || max_order - min_order >= PCACHE_MAX_CLASSES) {
+        msg_err("invalid order range [%d, %d]\n", min_order, max_order);
+        return INVALID_ADDRESS;
+    }
+    pcache pc = allocate(meta, sizeof(*pc));
+    if (pc == INVALID_ADDRESS)
+        return INVALID_ADDRESS;
+    pc->ch.h.alloc = pcache_alloc;
+    pc->ch.h.dealloc = pcache_dealloc;
+    pc->ch.h.destroy = pcache_destroy;
+    pc->ch.h.allocated = pcache_allocated;
+    pc->ch.h.total = pcache_total;
+    pc->ch.h.pagesize = parent->pagesize;
+    pc->ch.h.management = pcache_management;
+    pc->ch.drain = pcache_drain;
+    pc->parent = parent;
+    pc->meta = meta;
+    spin_lock_init_class(&pc->lock, "pcache");
+    pc->parent_pagesize = parent_pagesize;
+    pc->min_order = min_order;
+    pc->nclasses = max_order - min_order + 1;
+    pc->magazine_size = 0;
+    pc->ncpus = 0;
+    pc->cpus = 0;
+    pc->mgmt = 0;
+    return &pc->ch;
+}
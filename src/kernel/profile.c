@@ -0,0 +1,718 @@
+/* Timer-driven sampling profiler
+
+   There is no periodic scheduler tick in the kernel, so a periodic kernel
+   timer at the sampling rate is armed while profiling is running. Every
+   timer interrupt calls into profile_tick(); the first cpu to see a sample
+   period elapse samples the context it interrupted and sends an IPI to all
+   non-idle cpus, which do the same. A sample is the interrupted pc plus a
+   frame pointer walk of the kernel or user stack. Samples are aggregated in
+   preallocated per-cpu hash tables, so that the sampling path neither
+   allocates nor takes locks.
+
+   Profiles are exported in folded stack format (one "frame;frame;... count"
+   line per unique stack, as consumed by flamegraph.pl and speedscope) or as
+   an uncompressed pprof protobuf, either over HTTP or to a file written at
+   shutdown. User program symbols are resolved only if the program symbols
+   have been ingested (see the "ingest_program_symbols" manifest option).
+
+   Manifest configuration:
+     profile:(rate:<Hz> entries:<per-cpu stack slots> file:<path>
+              format:<folded|pprof> disable:t)
+*/
+
+#include <kernel.h>
+#include <pagecache.h>
+#include <tfs.h>
+#include <net.h>
+#include <http.h>
+#include <symtab.h>
+
+//#define PROFILE_DEBUG
+#ifdef PROFILE_DEBUG
+#define profile_debug(x, ...) do {rprintf("PROF: " x, ##__VA_ARGS__);} while(0)
+#else
+#define profile_debug(x, ...)
+#endif
+
+#define PROFILE_HTTP_PORT       9091
+#define PROFILE_URI             "profile"
+#define PROFILE_DEFAULT_RATE    99      /* Hz; off-beat with periodic activity */
+#define PROFILE_MAX_RATE        10000
+#define PROFILE_DEFAULT_ENTRIES 1024
+#define PROFILE_PROBE_LIMIT     16
+
+enum {
+    PROFILE_CTX_KERNEL,
+    PROFILE_CTX_SYSCALL,
+    PROFILE_CTX_USER,
+    PROFILE_CTX_MAX
+};
+
+static const char *profile_ctx_names[PROFILE_CTX_MAX] = {
+    "[kernel]",
+    "[syscall]",
+    "[user]",
+};
+
+typedef struct profile_entry {
+    u64 hash;                   /* 0 if unused */
+    u64 count;
+    u32 depth;
+    u32 ctx;
+    u64 pcs[PROFILE_MAX_DEPTH]; /* leaf first */
+} *profile_entry;
+
+typedef struct profile_cpu {
+    profile_entry entries;
+    u64 samples;
+    u64 dropped;
+    boolean busy;
+} *profile_cpu;
+
+static struct {
+    heap h;
+    profile_cpu cpus;
+    u64 ncpus;
+    u64 nentries;               /* per cpu, power of 2 */
+    timestamp period;
+    timestamp next_sample;
+    timestamp start;
+    timestamp duration;         /* accumulated while stopped */
+    struct timer timer;
+    timer_handler timer_func;
+    u64 ipi_vector;
+    boolean pprof;              /* default file format */
+    fsfile file;
+    sg_io fs_write;
+} profile;
+
+boolean profile_running;
+
+static u64 profile_hash(u32 ctx, u64 *pcs, u32 depth)
+{
+    u64 hash = 0xcbf29ce484222325;
+    u64 fnv_prime = 1099511628211;
+    hash ^= ctx;
+    hash *= fnv_prime;
+    for (int i = 0; i < depth; i++) {
+        hash ^= pcs[i];
+        hash *= fnv_prime;
+    }
+    return hash ? hash : 1;
+}
+
+static boolean profile_entry_match(profile_entry e, u32 ctx, u64 *pcs, u32 depth)
+{
+    if (e->ctx != ctx || e->depth != depth)
+        return false;
+    return runtime_memcmp(e->pcs, pcs, depth * sizeof(u64)) == 0;
+}
+
+/* Only the owning cpu inserts into its table, with interrupts disabled, so
+   a slot is claimed without atomics; the hash is published last so that
+   collation on another cpu never sees a partially written stack. */
+static void profile_record(profile_cpu pc, u32 ctx, u64 *pcs, u32 depth)
+{
+    u64 hash = profile_hash(ctx, pcs, depth);
+    u64 mask = profile.nentries - 1;
+    for (int i = 0; i < PROFILE_PROBE_LIMIT; i++) {
+        profile_entry e = &pc->entries[(hash + i) & mask];
+        if (e->hash == hash && profile_entry_match(e, ctx, pcs, depth)) {
+            e->count++;
+            return;
+        }
+        if (e->hash == 0) {
+            e->count = 1;
+            e->depth = depth;
+            e->ctx = ctx;
+            runtime_memcpy(e->pcs, pcs, depth * sizeof(u64));
+            write_barrier();
+            e->hash = hash;
+            return;
+        }
+    }
+    pc->dropped++;
+}
+
+int profile_walk_frames(u64 *fp, u64 *pcs, int max, boolean user)
+{
+    int n = 0;
+    while (n < max && fp) {
+        if (user ? is_kernel_memory(fp) : !is_kernel_memory(fp))
+            break;
+        if (!validate_frame_ptr(fp))
+            break;
+        u64 *nfp;
+        u64 *rap = get_frame_ra_ptr(fp, &nfp);
+        if (*rap == 0)
+            break;
+        pcs[n++] = *rap;
+        /* stacks grow down; anything else is a corrupt or foreign chain */
+        if (nfp <= fp)
+            break;
+        fp = nfp;
+    }
+    return n;
+}
+
+/* interrupt context */
+static void profile_sample(cpuinfo ci)
+{
+    if (ci->id >= profile.ncpus)
+        return;
+    profile_cpu pc = &profile.cpus[ci->id];
+    pc->busy = true;
+    memory_barrier();
+    if (profile_running) {
+        context ctx = get_current_context(ci);
+        context_frame f = ctx->frame;
+        u32 type = is_thread_context(ctx) ? PROFILE_CTX_USER :
+            (is_syscall_context(ctx) ? PROFILE_CTX_SYSCALL : PROFILE_CTX_KERNEL);
+        u64 pcs[PROFILE_MAX_DEPTH];
+        pcs[0] = frame_fault_pc(f);
+        u32 depth = 1 + profile_walk_frames(frame_get_fp(f), pcs + 1, PROFILE_MAX_DEPTH - 1,
+                                            type == PROFILE_CTX_USER);
+        profile_record(pc, type, pcs, depth);
+        pc->samples++;
+    }
+    memory_barrier();
+    pc->busy = false;
+}
+
+void profile_tick(void)
+{
+    timestamp here = now(CLOCK_ID_MONOTONIC_RAW);
+    timestamp next = profile.next_sample;
+    if (here < next)
+        return;
+    /* allow for the platform timer firing slightly early */
+    if (!compare_and_swap_64(&profile.next_sample, next, here + profile.period - profile.period / 4))
+        return;
+    cpuinfo ci = current_cpu();
+    for (u64 cpu = 0; cpu < total_processors; cpu++) {
+        if (cpu != ci->id && !bitmap_get(idle_cpu_mask, cpu))
+            send_ipi(cpu, profile.ipi_vector);
+    }
+    profile_sample(ci);
+}
+
+closure_function(0, 0, void, profile_ipi)
+{
+    if (profile_running)
+        profile_sample(current_cpu());
+}
+
+/* only here to keep timer interrupts coming at the sampling rate */
+closure_function(0, 2, void, profile_timer_func,
+                 u64, expiry, u64, overruns)
+{
+}
+
+static void profile_start(void)
+{
+    if (profile_running)
+        return;
+    profile.start = now(CLOCK_ID_MONOTONIC);
+    profile.next_sample = 0;
+    memory_barrier();
+    profile_running = true;
+    register_timer(kernel_timers, &profile.timer, CLOCK_ID_MONOTONIC, profile.period, false,
+                   profile.period, profile.timer_func);
+    profile_debug("started, period %T\n", profile.period);
+}
+
+static void profile_stop(void)
+{
+    if (!profile_running)
+        return;
+    profile_running = false;
+    remove_timer(kernel_timers, &profile.timer, 0);
+    profile.duration += now(CLOCK_ID_MONOTONIC) - profile.start;
+    profile_debug("stopped\n");
+}
+
+static void profile_clear(void)
+{
+    boolean running = profile_running;
+    profile_running = false;
+    memory_barrier();
+    for (u64 cpu = 0; cpu < profile.ncpus; cpu++) {
+        profile_cpu pc = &profile.cpus[cpu];
+        while (pc->busy)
+            kern_pause();
+        zero(pc->entries, profile.nentries * sizeof(struct profile_entry));
+        pc->samples = pc->dropped = 0;
+    }
+    profile.duration = 0;
+    profile.start = now(CLOCK_ID_MONOTONIC);
+    memory_barrier();
+    profile_running = running;
+}
+
+static timestamp profile_duration(void)
+{
+    return profile.duration + (profile_running ? now(CLOCK_ID_MONOTONIC) - profile.start : 0);
+}
+
+/* Merge the per-cpu tables into a vector of entry copies. Counts of stacks
+   being sampled concurrently may be slightly stale, which is harmless. */
+static vector profile_collate(void)
+{
+    heap h = profile.h;
+    vector v = allocate_vector(h, profile.nentries);
+    if (v == INVALID_ADDRESS)
+        return v;
+    table t = allocate_table(h, identity_key, pointer_equal);
+    if (t == INVALID_ADDRESS) {
+        deallocate_vector(v);
+        return INVALID_ADDRESS;
+    }
+    for (u64 cpu = 0; cpu < profile.ncpus; cpu++) {
+        profile_entry entries = profile.cpus[cpu].entries;
+        for (u64 i = 0; i < profile.nentries; i++) {
+            profile_entry e = &entries[i];
+            u64 hash = e->hash;
+            if (!hash)
+                continue;
+            read_barrier();
+            profile_entry c = table_find(t, pointer_from_u64(hash));
+            if (c && profile_entry_match(c, e->ctx, e->pcs, e->depth)) {
+                c->count += e->count;
+                continue;
+            }
+            c = allocate(h, sizeof(*c));
+            if (c == INVALID_ADDRESS)
+                break;
+            runtime_memcpy(c, e, sizeof(*c));
+            if (!table_find(t, pointer_from_u64(hash)))
+                table_set(t, pointer_from_u64(hash), c);
+            vector_push(v, c);
+        }
+    }
+    deallocate_table(t);
+    return v;
+}
+
+static void profile_collation_free(vector v)
+{
+    profile_entry e;
+    vector_foreach(v, e)
+        deallocate(profile.h, e, sizeof(*e));
+    deallocate_vector(v);
+}
+
+/* Return addresses point past the call; look up the call instruction
+   itself so that calls at the end of a function resolve correctly. */
+static inline u64 profile_frame_addr(profile_entry e, int i)
+{
+    return i == 0 ? e->pcs[0] : e->pcs[i] - 1;
+}
+
+static buffer profile_folded(vector v)
+{
+    buffer b = allocate_buffer(profile.h, PAGESIZE);
+    if (b == INVALID_ADDRESS)
+        return b;
+    profile_entry e;
+    vector_foreach(v, e) {
+        buffer_write_cstring(b, profile_ctx_names[e->ctx]);
+        for (int i = e->depth - 1; i >= 0; i--) {
+            u64 addr = profile_frame_addr(e, i);
+            char *name = find_elf_sym(addr, 0, 0);
+            if (name)
+                bprintf(b, ";%s", name);
+            else
+                bprintf(b, ";0x%lx", e->pcs[i]);
+        }
+        bprintf(b, " %ld\n", e->count);
+    }
+    return b;
+}
+
+/* Minimal protobuf encoding of the pprof profile.proto message */
+
+#define PB_WIRE_VARINT  0
+#define PB_WIRE_LEN     2
+
+static void pb_varint(buffer b, u64 v)
+{
+    while (v >= 0x80) {
+        push_u8(b, (v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    push_u8(b, v);
+}
+
+static void pb_uint(buffer b, int field, u64 v)
+{
+    pb_varint(b, (field << 3) | PB_WIRE_VARINT);
+    pb_varint(b, v);
+}
+
+static void pb_bytes(buffer b, int field, const void *p, bytes len)
+{
+    pb_varint(b, (field << 3) | PB_WIRE_LEN);
+    pb_varint(b, len);
+    buffer_write(b, p, len);
+}
+
+/* append m as a length-delimited field and reset it for reuse */
+static void pb_message(buffer b, int field, buffer m)
+{
+    pb_bytes(b, field, buffer_ref(m, 0), buffer_length(m));
+    buffer_clear(m);
+}
+
+/* profile.proto field numbers */
+#define PPROF_SAMPLE_TYPE       1
+#define PPROF_SAMPLE            2
+#define PPROF_LOCATION          4
+#define PPROF_FUNCTION          5
+#define PPROF_STRING_TABLE      6
+#define PPROF_DURATION_NANOS    10
+#define PPROF_PERIOD_TYPE       11
+#define PPROF_PERIOD            12
+
+#define PPROF_VALUETYPE_TYPE    1
+#define PPROF_VALUETYPE_UNIT    2
+#define PPROF_SAMPLE_LOCATION   1
+#define PPROF_SAMPLE_VALUE      2
+#define PPROF_SAMPLE_LABEL      3
+#define PPROF_LABEL_KEY         1
+#define PPROF_LABEL_STR         2
+#define PPROF_LOCATION_ID       1
+#define PPROF_LOCATION_ADDRESS  3
+#define PPROF_LOCATION_LINE     4
+#define PPROF_LINE_FUNCTION     1
+#define PPROF_FUNCTION_ID       1
+#define PPROF_FUNCTION_NAME     2
+#define PPROF_FUNCTION_SYSNAME  3
+
+/* fixed string table indices */
+enum {
+    PPROF_STR_EMPTY,
+    PPROF_STR_SAMPLES,
+    PPROF_STR_COUNT,
+    PPROF_STR_CPU,
+    PPROF_STR_NANOSECONDS,
+    PPROF_STR_CONTEXT,
+    PPROF_STR_CTX_BASE,
+    PPROF_STR_FIXED = PPROF_STR_CTX_BASE + PROFILE_CTX_MAX,
+};
+
+static const char *pprof_fixed_strings[PPROF_STR_FIXED] = {
+    "", "samples", "count", "cpu", "nanoseconds", "context",
+    "kernel", "syscall", "user",
+};
+
+static void pprof_value_type(buffer b, int field, buffer m, u64 type, u64 unit)
+{
+    pb_uint(m, PPROF_VALUETYPE_TYPE, type);
+    pb_uint(m, PPROF_VALUETYPE_UNIT, unit);
+    pb_message(b, field, m);
+}
+
+static buffer profile_pprof(vector v)
+{
+    heap h = profile.h;
+    buffer b = allocate_buffer(h, PAGESIZE);
+    buffer m = allocate_buffer(h, 256);
+    buffer n = allocate_buffer(h, 256);
+    table locs = allocate_table(h, identity_key, pointer_equal);    /* address -> location id */
+    table funcs = allocate_table(h, identity_key, pointer_equal);   /* symbol name -> function id */
+    vector strings = allocate_vector(h, PPROF_STR_FIXED);
+    if (b == INVALID_ADDRESS || m == INVALID_ADDRESS || n == INVALID_ADDRESS ||
+        locs == INVALID_ADDRESS || funcs == INVALID_ADDRESS || strings == INVALID_ADDRESS) {
+        if (b != INVALID_ADDRESS)
+            deallocate_buffer(b);
+        b = INVALID_ADDRESS;
+        goto out;
+    }
+    for (int i = 0; i < PPROF_STR_FIXED; i++)
+        vector_push(strings, (void *)pprof_fixed_strings[i]);
+
+    pprof_value_type(b, PPROF_SAMPLE_TYPE, m, PPROF_STR_SAMPLES, PPROF_STR_COUNT);
+    pprof_value_type(b, PPROF_SAMPLE_TYPE, m, PPROF_STR_CPU, PPROF_STR_NANOSECONDS);
+    pprof_value_type(b, PPROF_PERIOD_TYPE, m, PPROF_STR_CPU, PPROF_STR_NANOSECONDS);
+    u64 period_ns = nsec_from_timestamp(profile.period);
+    pb_uint(b, PPROF_PERIOD, period_ns);
+    pb_uint(b, PPROF_DURATION_NANOS, nsec_from_timestamp(profile_duration()));
+
+    u64 nlocs = 0;
+    profile_entry e;
+    vector_foreach(v, e) {
+        for (int i = 0; i < e->depth; i++) {
+            void *addr = pointer_from_u64(profile_frame_addr(e, i));
+            u64 id = u64_from_pointer(table_find(locs, addr));
+            if (!id) {
+                id = ++nlocs;
+                table_set(locs, addr, pointer_from_u64(id));
+            }
+            pb_varint(n, id);
+        }
+        pb_message(m, PPROF_SAMPLE_LOCATION, n);
+        pb_varint(n, e->count);
+        pb_varint(n, e->count * period_ns);
+        pb_message(m, PPROF_SAMPLE_VALUE, n);
+        pb_uint(n, PPROF_LABEL_KEY, PPROF_STR_CONTEXT);
+        pb_uint(n, PPROF_LABEL_STR, PPROF_STR_CTX_BASE + e->ctx);
+        pb_message(m, PPROF_SAMPLE_LABEL, n);
+        pb_message(b, PPROF_SAMPLE, m);
+    }
+
+    table_foreach(locs, addr, id) {
+        pb_uint(m, PPROF_LOCATION_ID, u64_from_pointer(id));
+        pb_uint(m, PPROF_LOCATION_ADDRESS, u64_from_pointer(addr));
+        char *name = find_elf_sym(u64_from_pointer(addr), 0, 0);
+        if (name) {
+            u64 fid = u64_from_pointer(table_find(funcs, name));
+            if (!fid) {
+                fid = vector_length(strings);   /* also the name's string index */
+                vector_push(strings, name);
+                table_set(funcs, name, pointer_from_u64(fid));
+                pb_uint(n, PPROF_FUNCTION_ID, fid);
+                pb_uint(n, PPROF_FUNCTION_NAME, fid);
+                pb_uint(n, PPROF_FUNCTION_SYSNAME, fid);
+                pb_message(b, PPROF_FUNCTION, n);
+            }
+            pb_uint(n, PPROF_LINE_FUNCTION, fid);
+            pb_message(m, PPROF_LOCATION_LINE, n);
+        }
+        pb_message(b, PPROF_LOCATION, m);
+    }
+
+    const char *s;
+    vector_foreach(strings, s)
+        pb_bytes(b, PPROF_STRING_TABLE, s, runtime_strlen(s));
+  out:
+    if (m != INVALID_ADDRESS)
+        deallocate_buffer(m);
+    if (n != INVALID_ADDRESS)
+        deallocate_buffer(n);
+    if (locs != INVALID_ADDRESS)
+        deallocate_table(locs);
+    if (funcs != INVALID_ADDRESS)
+        deallocate_table(funcs);
+    if (strings != INVALID_ADDRESS)
+        deallocate_vector(strings);
+    return b;
+}
+
+static buffer profile_output(boolean pprof)
+{
+    vector v = profile_collate();
+    if (v == INVALID_ADDRESS)
+        return INVALID_ADDRESS;
+    buffer b = pprof ? profile_pprof(v) : profile_folded(v);
+    profile_collation_free(v);
+    return b;
+}
+
+static buffer profile_stats(void)
+{
+    buffer b = allocate_buffer(profile.h, 256);
+    if (b == INVALID_ADDRESS)
+        return b;
+    bprintf(b, "profiler %s, rate %ld Hz, duration %T\n",
+            profile_running ? "running" : "stopped",
+            seconds(1) / profile.period, profile_duration());
+    for (u64 cpu = 0; cpu < profile.ncpus; cpu++) {
+        profile_cpu pc = &profile.cpus[cpu];
+        bprintf(b, "cpu %ld: %ld samples, %ld dropped\n", cpu, pc->samples, pc->dropped);
+    }
+    return b;
+}
+
+static void profile_send_http_error(http_responder handler, const char *status, const char *msg)
+{
+    buffer b = aprintf(profile.h, "<html><head><title>%s %s</title></head>"
+                       "<body><h1>%s</h1></body></html>\r\n", status, msg, msg);
+    send_http_response(handler, timm("status", "%s %s", status, msg), b);
+}
+
+closure_function(0, 3, void, profile_http_request,
+                 http_method, method, http_responder, handler, value, val)
+{
+    string relative_uri = get_string(val, sym(relative_uri));
+    if (method != HTTP_REQUEST_METHOD_GET) {
+        profile_send_http_error(handler, "501", "Not Implemented");
+        return;
+    }
+    buffer b;
+    const char *content_type = "text/plain";
+    if (!relative_uri || buffer_compare_with_cstring(relative_uri, "folded")) {
+        b = profile_output(false);
+    } else if (buffer_compare_with_cstring(relative_uri, "pprof")) {
+        b = profile_output(true);
+        content_type = "application/octet-stream";
+    } else if (buffer_compare_with_cstring(relative_uri, "enable")) {
+        profile_start();
+        b = aprintf(profile.h, "profiler enabled\n");
+    } else if (buffer_compare_with_cstring(relative_uri, "disable")) {
+        profile_stop();
+        b = aprintf(profile.h, "profiler disabled\n");
+    } else if (buffer_compare_with_cstring(relative_uri, "clear")) {
+        profile_clear();
+        b = aprintf(profile.h, "profile cleared\n");
+    } else if (buffer_compare_with_cstring(relative_uri, "stats")) {
+        b = profile_stats();
+    } else {
+        profile_send_http_error(handler, "404", "Not Found");
+        return;
+    }
+    if (b == INVALID_ADDRESS) {
+        profile_send_http_error(handler, "500", "Internal Server Error");
+        return;
+    }
+    status s = send_http_response(handler, timm("ContentType", "%s", content_type), b);
+    if (!is_ok(s)) {
+        msg_err("failed to send profile: %v\n", s);
+        timm_dealloc(s);
+    }
+}
+
+static boolean init_profile_http_listener(void)
+{
+    http_listener hl = allocate_http_listener(profile.h, PROFILE_HTTP_PORT);
+    if (hl == INVALID_ADDRESS) {
+        msg_err("could not allocate profile HTTP listener\n");
+        return false;
+    }
+    http_register_uri_handler(hl, PROFILE_URI, closure(profile.h, profile_http_request));
+    status s = listen_port(profile.h, PROFILE_HTTP_PORT, connection_handler_from_http_listener(hl));
+    if (!is_ok(s)) {
+        msg_err("listen_port(port=%d) failed for profile HTTP listener\n", PROFILE_HTTP_PORT);
+        timm_dealloc(s);
+        deallocate_http_listener(profile.h, hl);
+        return false;
+    }
+    rprintf("started profile http listener on port %d\n", PROFILE_HTTP_PORT);
+    return true;
+}
+
+closure_function(3, 1, void, profile_file_write_complete,
+                 sg_list, sg, buffer, b, status_handler, complete,
+                 status, s)
+{
+    deallocate_sg_list(bound(sg));
+    deallocate_buffer(bound(b));
+    if (is_ok(s)) {
+        fsfile_flush(profile.file, false, bound(complete));
+    } else {
+        msg_err("failed to write profile: %v\n", s);
+        apply(bound(complete), s);
+    }
+    closure_finish();
+}
+
+closure_function(0, 2, void, profile_shutdown_handler,
+                 int, status, merge, m)
+{
+    status_handler complete = apply_merge(m);
+    profile_stop();
+    buffer b = profile_output(profile.pprof);
+    if (b == INVALID_ADDRESS)
+        goto fail;
+    sg_list sg = allocate_sg_list();
+    if (sg == INVALID_ADDRESS)
+        goto fail_dealloc_buf;
+    bytes size = buffer_length(b);
+    sg_buf sgb = sg_list_tail_add(sg, size);
+    if (sgb == INVALID_ADDRESS)
+        goto fail_dealloc_sg;
+    sgb->buf = buffer_ref(b, 0);
+    sgb->size = size;
+    sgb->offset = 0;
+    sgb->refcount = 0;
+    status_handler sh = closure(profile.h, profile_file_write_complete, sg, b, complete);
+    if (sh == INVALID_ADDRESS)
+        goto fail_dealloc_sg;
+    apply(profile.fs_write, sg, irangel(0, size), sh);
+    closure_finish();
+    return;
+  fail_dealloc_sg:
+    deallocate_sg_list(sg);
+  fail_dealloc_buf:
+    deallocate_buffer(b);
+  fail:
+    msg_err("%s: out of memory\n", __func__);
+    apply(complete, STATUS_OK);
+    closure_finish();
+}
+
+static boolean init_profile_file(value v)
+{
+    tuple file;
+    fsfile fsf;
+
+    if (!is_string(v)) {
+        msg_err("invalid profile filename: %v\n", v);
+        return false;
+    }
+    filesystem fs = get_root_fs();
+    tuple root = filesystem_getroot(fs);
+    fs_status s = filesystem_get_node(&fs, inode_from_tuple(root), buffer_to_cstring((buffer)v),
+                                      true, true, false, true, &file, &fsf);
+    if (s != FS_STATUS_OK) {
+        msg_err("failed to open profile file: %s\n", string_from_fs_status(s));
+        return false;
+    }
+    filesystem_put_node(fs, file);
+    profile.file = fsf;
+    profile.fs_write = fsfile_get_writer(fsf);
+    add_shutdown_completion(closure(profile.h, profile_shutdown_handler));
+    return true;
+}
+
+void init_profiler(kernel_heaps kh, tuple root)
+{
+    tuple config = get_tuple(root, sym(profile));
+    if (!config)
+        return;
+    profile.h = heap_locked(kh);
+    heap backed = (heap)heap_linear_backed(kh);
+
+    u64 rate = PROFILE_DEFAULT_RATE;
+    if (get_u64(config, sym(rate), &rate) && (rate == 0 || rate > PROFILE_MAX_RATE)) {
+        msg_err("invalid profile rate %ld\n", rate);
+        return;
+    }
+    profile.period = seconds(1) / rate;
+    u64 entries = PROFILE_DEFAULT_ENTRIES;
+    if (get_u64(config, sym(entries), &entries) && entries < PROFILE_PROBE_LIMIT) {
+        msg_err("invalid number of profile entries %ld\n", entries);
+        return;
+    }
+    profile.nentries = U64_FROM_BIT(find_order(entries));
+    string format = get_string(config, sym(format));
+    profile.pprof = format && buffer_compare_with_cstring(format, "pprof");
+
+    profile.ncpus = MAX(present_processors, total_processors);
+    profile.cpus = allocate_zero(backed, profile.ncpus * sizeof(struct profile_cpu));
+    if (profile.cpus == INVALID_ADDRESS)
+        goto alloc_fail;
+    for (u64 cpu = 0; cpu < profile.ncpus; cpu++) {
+        profile_entry e = allocate_zero(backed, profile.nentries * sizeof(*e));
+        if (e == INVALID_ADDRESS)
+            goto alloc_fail;
+        profile.cpus[cpu].entries = e;
+    }
+    init_timer(&profile.timer);
+    profile.timer_func = closure(profile.h, profile_timer_func);
+    profile.ipi_vector = allocate_ipi_interrupt();
+    if (profile.ipi_vector == INVALID_PHYSICAL) {
+        msg_err("failed to allocate profile IPI\n");
+        return;
+    }
+    register_interrupt(profile.ipi_vector, closure(profile.h, profile_ipi), "profile ipi");
+
+    value file = get(config, sym(file));
+    if (file ? !init_profile_file(file) : !init_profile_http_listener())
+        return;
+    if (!get(config, sym(disable)))
+        profile_start();
+    rprintf("profiler initialized, %ld Hz, %ld entries per cpu\n", rate, profile.nentries);
+    return;
+  alloc_fail:
+    msg_err("failed to allocate profile tables\n");
+}
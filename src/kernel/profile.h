@@ -0,0 +1,16 @@
+/* timer-driven sampling profiler */
+
+#define PROFILE_MAX_DEPTH   30
+
+extern boolean profile_running;
+
+void profile_tick(void);
+int profile_walk_frames(u64 *fp, u64 *pcs, int max, boolean user);
+void init_profiler(kernel_heaps kh, tuple root);
+
+/* called from every timer interrupt, on any cpu */
+static inline void profile_timer_interrupt(void)
+{
+    if (profile_running)
+        profile_tick();
+}
@@ -124,10 +124,11 @@ closure_function(0, 0, void, timer_interrupt_handler_fn)
     schedule_timer_service();
 }
 
-static inline void service_thunk_queue(queue q)
+static inline u64 service_thunk_queue(queue q)
 {
     thunk t;
     context c;
+    u64 count = 0;
     while ((t = dequeue(q)) != INVALID_ADDRESS) {
         c = context_from_closure(t);
         sched_debug(" run: %F state: %s context: %p\n", t, state_strings[current_cpu()->state], c);
@@ -135,12 +136,15 @@ static inline void service_thunk_queue(queue q)
             context_apply(c, t);
         else
             apply(t);
+        count++;
     }
+    return count;
 }
 
-static inline void service_async_1(queue q)
+static inline u64 service_async_1(queue q)
 {
     struct applied_async_1 aa;
+    u64 count = 0;
     while (dequeue_n_irqsafe(q, (void **)&aa, sizeof(aa) / sizeof(u64))) {
         sched_debug(" run: %F arg0: 0x%lx\n", aa.a, aa.arg0);
         context c = context_from_closure(aa.a);
@@ -148,7 +152,74 @@ static inline void service_async_1(queue q)
             context_apply_1(c, aa.a, aa.arg0);
         else
             apply(aa.a, aa.arg0);
+        count++;
     }
+    return count;
+}
+
+#define ASYNC_1_WORDS   (sizeof(struct applied_async_1) / sizeof(u64))
+
+static inline u64 deferred_queue_depth(deferred_queue dq, boolean async_1)
+{
+    u64 len = queue_length(dq->q);
+    return async_1 ? len / ASYNC_1_WORDS : len;
+}
+
+/* Returns true if any work was found in the queue. The owner of the queue
+   drains it on every runloop pass; other cpus only steal when idle. */
+static boolean service_deferred_queue(deferred_queue dq, boolean async_1, boolean stealing)
+{
+    u64 depth = deferred_queue_depth(dq, async_1);
+    if (depth == 0)
+        return false;
+    if (depth > dq->max_depth)
+        dq->max_depth = depth;
+    timestamp since = dq->pending_since;
+    if (since) {
+        timestamp latency = now(CLOCK_ID_MONOTONIC_RAW) - since;
+        if ((s64)latency > 0) {
+            fetch_and_add(&dq->latency_total, latency);
+            if (latency > dq->latency_max)
+                dq->latency_max = latency;
+        }
+        fetch_and_add(&dq->drains, 1);
+    }
+    u64 count = async_1 ? service_async_1(dq->q) : service_thunk_queue(dq->q);
+    if (queue_empty(dq->q))
+        dq->pending_since = 0;
+    fetch_and_add(stealing ? &dq->stolen : &dq->serviced, count);
+    return true;
+}
+
+/* Run deferred work queued on other cpus; only called when this cpu has
+   nothing else to do. */
+static boolean steal_deferred_work(cpuinfo ci)
+{
+    boolean found = false;
+    for (u64 cpu = ci->id + 1; ; cpu++) {
+        if (cpu == total_processors)
+            cpu = 0;
+        if (cpu == ci->id)
+            break;
+        cpuinfo cpui = cpuinfo_from_id(cpu);
+        if (service_deferred_queue(&cpui->bh_queue, false, true))
+            found = true;
+        if (service_deferred_queue(&cpui->async_1_queue, true, true))
+            found = true;
+        if (service_deferred_queue(&cpui->run_queue, false, true))
+            found = true;
+        if (found) {
+            sched_debug("stole deferred work from CPU %d\n", cpu);
+            break;
+        }
+    }
+    return found;
+}
+
+static inline boolean deferred_work_pending(cpuinfo ci)
+{
+    return !queue_empty(ci->bh_queue.q) || !queue_empty(ci->async_1_queue.q) ||
+        !queue_empty(ci->run_queue.q);
 }
 
 NOTRACE void __attribute__((noreturn)) runloop_internal(void)
@@ -156,10 +227,12 @@ NOTRACE void __attribute__((noreturn)) runloop_internal(void)
     cpuinfo ci = current_cpu();
 
     disable_interrupts();
-    sched_debug("runloop from %s c: %d  a1: %d b:%d  r:%d  t:%d\n",
+    sched_debug("runloop from %s c: %d  a1: %d/%d b:%d/%d  r:%d/%d  t:%d\n",
                 state_strings[ci->state], queue_length(ci->cpu_queue),
-                queue_length(async_queue_1), queue_length(bhqueue),
-                queue_length(runqueue), sched_queue_length(&ci->thread_queue));
+                queue_length(ci->async_1_queue.q), queue_length(async_queue_1),
+                queue_length(ci->bh_queue.q), queue_length(bhqueue),
+                queue_length(ci->run_queue.q), queue_length(runqueue),
+                sched_queue_length(&ci->thread_queue));
     ci->state = cpu_kernel;
     /* Make sure TLB entries are appropriately flushed before doing any work */
     page_invalidate_flush();
@@ -169,11 +242,14 @@ NOTRACE void __attribute__((noreturn)) runloop_internal(void)
     service_thunk_queue(ci->cpu_queue);
 
     /* bhqueue is for deferred operations, enqueued by interrupt handlers */
+    service_deferred_queue(&ci->bh_queue, false, false);
     service_thunk_queue(bhqueue);
 
     /* serve deferred status_handlers, some of which may not return */
+    service_deferred_queue(&ci->async_1_queue, true, false);
     service_async_1(async_queue_1);
 
+    service_deferred_queue(&ci->run_queue, false, false);
     service_thunk_queue(runqueue);
 
     /* should be a list of per-runloop checks - also low-pri background */
@@ -240,11 +316,15 @@ NOTRACE void __attribute__((noreturn)) runloop_internal(void)
        runnable items may get stuck waiting for the next interrupt.
 
        Find cost of sleep / wakeup and consider spinning this check for that interval. */
-    if (queue_length(ci->cpu_queue) || queue_length(async_queue_1) ||
-        queue_length(bhqueue) || queue_length(runqueue) ||
+    if (queue_length(ci->cpu_queue) || deferred_work_pending(ci) ||
+        queue_length(async_queue_1) || queue_length(bhqueue) || queue_length(runqueue) ||
         (!shutting_down && !sched_queue_empty(&ci->thread_queue)))
         goto retry;
 
+    /* Nothing left to do here: help out with work deferred on other cpus. */
+    if (steal_deferred_work(ci))
+        goto retry;
+
     kernel_sleep();
 }    
 
@@ -283,6 +363,101 @@ void init_scheduler(heap h)
     shutting_down = false;
 }
 
+boolean init_deferred_queue(deferred_queue dq, heap h, u64 size)
+{
+    zero(dq, sizeof(*dq));
+    dq->q = allocate_queue(h, size);
+    return (dq->q != INVALID_ADDRESS);
+}
+
+enum {
+    DQ_STAT_DEPTH,
+    DQ_STAT_MAX_DEPTH,
+    DQ_STAT_ENQUEUED,
+    DQ_STAT_SERVICED,
+    DQ_STAT_STOLEN,
+    DQ_STAT_LATENCY_AVG_US,
+    DQ_STAT_LATENCY_MAX_US,
+};
+
+/* Statistics are summed (or maximized) over all cpus at the time of the get. */
+closure_function(4, 0, value, deferred_queue_get_stat,
+                 u64, offset, boolean, async_1, int, stat, value, v)
+{
+    u64 result = 0;
+    u64 drains = 0;
+    for (int i = 0; i < total_processors; i++) {
+        deferred_queue dq = pointer_from_u64(u64_from_pointer(cpuinfo_from_id(i)) + bound(offset));
+        switch (bound(stat)) {
+        case DQ_STAT_DEPTH:
+            result += deferred_queue_depth(dq, bound(async_1));
+            break;
+        case DQ_STAT_MAX_DEPTH:
+            result = MAX(result, dq->max_depth);
+            break;
+        case DQ_STAT_ENQUEUED:
+            result += dq->enqueued;
+            break;
+        case DQ_STAT_SERVICED:
+            result += dq->serviced;
+            break;
+        case DQ_STAT_STOLEN:
+            result += dq->stolen;
+            break;
+        case DQ_STAT_LATENCY_AVG_US:
+            result += dq->latency_total;
+            drains += dq->drains;
+            break;
+        case DQ_STAT_LATENCY_MAX_US:
+            result = MAX(result, dq->latency_max);
+            break;
+        }
+    }
+    if (bound(stat) == DQ_STAT_LATENCY_AVG_US)
+        result = drains ? usec_from_timestamp(result / drains) : 0;
+    else if (bound(stat) == DQ_STAT_LATENCY_MAX_US)
+        result = usec_from_timestamp(result);
+    return value_rewrite_u64(bound(v), result);
+}
+
+static tuple deferred_queue_management(heap h, u64 offset, boolean async_1)
+{
+    static const char * const stat_names[] = {
+        [DQ_STAT_DEPTH] = "depth",
+        [DQ_STAT_MAX_DEPTH] = "max_depth",
+        [DQ_STAT_ENQUEUED] = "enqueued",
+        [DQ_STAT_SERVICED] = "serviced",
+        [DQ_STAT_STOLEN] = "stolen",
+        [DQ_STAT_LATENCY_AVG_US] = "latency_avg_us",
+        [DQ_STAT_LATENCY_MAX_US] = "latency_max_us",
+    };
+    tuple t = allocate_tuple();
+    assert(t != INVALID_ADDRESS);
+    tuple_notifier n = tuple_notifier_wrap(t);
+    assert(n != INVALID_ADDRESS);
+    for (int stat = 0; stat < sizeof(stat_names) / sizeof(stat_names[0]); stat++) {
+        value v = value_from_u64(h, 0);
+        symbol s = sym_this((char *)stat_names[stat]);
+        set(t, s, v);
+        tuple_notifier_register_get_notify(n, s, closure(h, deferred_queue_get_stat,
+                                                         offset, async_1, stat, v));
+    }
+    return (tuple)n;
+}
+
+void init_scheduler_management(tuple root)
+{
+    heap h = heap_locked(get_kernel_heaps());
+    tuple sched = allocate_tuple();
+    assert(sched != INVALID_ADDRESS);
+    set(sched, sym(bhqueue), deferred_queue_management(h, offsetof(cpuinfo, bh_queue), false));
+    set(sched, sym(runqueue), deferred_queue_management(h, offsetof(cpuinfo, run_queue), false));
+    set(sched, sym(async_queue_1), deferred_queue_management(h, offsetof(cpuinfo, async_1_queue),
+                                                             true));
+    set(sched, sym(no_encode), null_value);
+    set(root, sym(sched), sched);
+}
+
 void init_scheduler_cpus(heap h)
 {
     idle_cpu_mask = allocate_bitmap(h, h, present_processors);
@@ -302,7 +477,7 @@ boolean sched_queue_init(sched_queue sq, heap h)
     if (sq->q == INVALID_ADDRESS)
         return false;
     sq->min_runtime = 0;
-    spin_lock_init(&sq->lock);
+    spin_lock_init_class(&sq->lock, "sched_queue");
     return true;
 }
 
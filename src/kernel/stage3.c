@@ -157,6 +157,10 @@ closure_function(6, 0, void, startup,
     /* register root tuple with management and kick off interfaces, if any */
     init_management_root(root);
     init_kernel_heaps_management(root);
+    init_scheduler_management(root);
+    init_storage_management(root);
+    init_profiler(kh, root);
+    init_heap_profiler(kh, root);
 #if 0
     http_listener hl = allocate_http_listener(general, 9090);
     assert(hl != INVALID_ADDRESS);
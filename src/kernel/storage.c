@@ -1,6 +1,7 @@
 #include <kernel.h>
 #include <pagecache.h>
 #include <storage.h>
+#include <storage_queue.h>
 #include <tfs.h>
 
 //#define STORAGE_DEBUG
@@ -32,6 +33,9 @@ static struct {
     struct spinlock lock;
     u64 mount_generation;
     vector mounts_watchers;
+    struct list queues;
+    int next_queue_id;
+    tuple mgmt;
 } storage;
 
 #define storage_lock()      u64 _irqflags = spin_lock_irq(&storage.lock)
@@ -116,6 +120,11 @@ closure_function(2, 2, void, volume_link,
             v->fs = fs;
             v->mount_dir = mount_dir;
             storage_debug("volume mounted, mount directory %p, filesystem %p", mount_dir, fs);
+            if (get(get_root_tuple(), sym(mount_stats))) {
+                buffer b = little_stack_buffer(512);
+                filesystem_print_mount_stats(fs, b);
+                buffer_print(b);
+            }
             notify_mount_change_locked();
         }
     } else {
@@ -211,6 +220,175 @@ storage_req_handler storage_init_req_handler(closure_ref(storage_simple_req_hand
     return init_closure(handler, storage_simple_req_handler, read, write);
 }
 
+/* Request queues of attached devices; see storage_queue.c */
+
+closure_function(3, 0, value, storage_queue_get_stat,
+                 storage_queue, q, int, stat, value, v)
+{
+    storage_queue q = bound(q);
+    u64 result = 0;
+    switch (bound(stat)) {
+    case STORAGE_STAT_INFLIGHT:
+        result = q->inflight;
+        break;
+    case STORAGE_STAT_MAX_INFLIGHT:
+        result = q->max_inflight;
+        break;
+    case STORAGE_STAT_REQUESTS:
+        result = q->requests;
+        break;
+    case STORAGE_STAT_MERGED:
+        result = q->merged;
+        break;
+    case STORAGE_STAT_DISPATCHED:
+        result = q->dispatched;
+        break;
+    case STORAGE_STAT_LATENCY_AVG_US:
+        result = q->completed ? usec_from_timestamp(q->latency_total / q->completed) : 0;
+        break;
+    case STORAGE_STAT_LATENCY_MAX_US:
+        result = usec_from_timestamp(q->latency_max);
+        break;
+    case STORAGE_STAT_MAX_SEGS:
+        result = q->max_segs;
+        break;
+    case STORAGE_STAT_MAX_KB:
+        result = (q->max_blocks << SECTOR_OFFSET) / KB;
+        break;
+    }
+    return value_rewrite_u64(bound(v), result);
+}
+
+/* Called with storage lock held. */
+static void storage_queue_management(storage_queue q)
+{
+    static const char * const stat_names[] = {
+        [STORAGE_STAT_INFLIGHT] = "inflight",
+        [STORAGE_STAT_MAX_INFLIGHT] = "max_inflight",
+        [STORAGE_STAT_REQUESTS] = "requests",
+        [STORAGE_STAT_MERGED] = "merged",
+        [STORAGE_STAT_DISPATCHED] = "dispatched",
+        [STORAGE_STAT_LATENCY_AVG_US] = "latency_avg_us",
+        [STORAGE_STAT_LATENCY_MAX_US] = "latency_max_us",
+        [STORAGE_STAT_MAX_SEGS] = "max_segs",
+        [STORAGE_STAT_MAX_KB] = "max_kb",
+    };
+    tuple t = timm("type", "storage_queue", "attach_id", "%d", q->attach_id);
+    if (t == INVALID_ADDRESS)
+        return;
+    tuple_notifier n = tuple_notifier_wrap(t);
+    if (n == INVALID_ADDRESS) {
+        destruct_tuple(t, true);
+        return;
+    }
+    for (int stat = 0; stat < STORAGE_STAT_COUNT; stat++) {
+        value v = value_from_u64(storage.h, 0);
+        symbol s = sym_this((char *)stat_names[stat]);
+        set(t, s, v);
+        q->stat_notify[stat] = closure(storage.h, storage_queue_get_stat, q, stat, v);
+        assert(q->stat_notify[stat] != INVALID_ADDRESS);
+        tuple_notifier_register_get_notify(n, s, q->stat_notify[stat]);
+    }
+    q->stats = t;
+    q->mgmt = (tuple)n;
+    set(storage.mgmt, intern_u64(q->id), q->mgmt);
+}
+
+/* Called with storage lock held. */
+static void storage_queue_management_release(storage_queue q)
+{
+    if (!q->mgmt)
+        return;
+    set(storage.mgmt, intern_u64(q->id), 0);
+    tuple_notifier_unwrap((tuple_notifier)q->mgmt);
+    destruct_tuple(q->stats, true);
+    for (int stat = 0; stat < STORAGE_STAT_COUNT; stat++)
+        deallocate_closure(q->stat_notify[stat]);
+    q->mgmt = 0;
+}
+
+/* Wraps the request handler of a newly attached device with a request queue;
+   the returned handler is the one to be used by filesystems. */
+storage_req_handler storage_queue_attach(storage_req_handler driver, int attach_id)
+{
+    storage_queue q = allocate_storage_queue(storage.h, driver);
+    if (q == INVALID_ADDRESS)
+        return INVALID_ADDRESS;
+    q->attach_id = attach_id;
+    storage_lock();
+    q->id = storage.next_queue_id++;
+    list_push_back(&storage.queues, &q->l);
+    if (storage.mgmt)
+        storage_queue_management(q);
+    storage_unlock();
+    storage_debug("queue %d for driver %p, attach id %d", q->id, driver, attach_id);
+    return storage_queue_handler(q);
+}
+
+/* Called with storage lock held. */
+static storage_queue storage_queue_from_driver(storage_req_handler driver)
+{
+    list_foreach(&storage.queues, e) {
+        storage_queue q = struct_from_list(e, storage_queue, l);
+        if (q->driver == driver)
+            return q;
+    }
+    return 0;
+}
+
+/* Lowers the limits of the queue in front of the driver; see
+   storage_queue_set_limits(). */
+void storage_set_limits(storage_req_handler driver, u64 max_bytes, u32 max_segs)
+{
+    storage_lock();
+    storage_queue q = storage_queue_from_driver(driver);
+    if (q)
+        storage_queue_set_limits(q, max_bytes, max_segs);
+    storage_unlock();
+}
+
+define_closure_function(1, 0, void, storage_queue_detached,
+                        thunk, complete)
+{
+    thunk complete = bound(complete);
+    storage_queue_release(struct_from_field(closure_self(), storage_queue, detach_complete));
+    apply(complete);
+}
+
+#ifdef CONFIG_TRACELOG
+static const char *storage_op_names[] = {
+    [STORAGE_OP_READ] = "read",
+    [STORAGE_OP_WRITE] = "write",
+    [STORAGE_OP_READSG] = "readsg",
+    [STORAGE_OP_WRITESG] = "writesg",
+    [STORAGE_OP_FLUSH] = "flush",
+};
+
+closure_function(1, 1, void, storage_req_traced,
+                 status_handler, completion,
+                 status, s)
+{
+    tracepoint_end(TRACEPOINT_STORAGE_REQ, u64_from_pointer(closure_self()),
+                   u64_from_pointer(is_ok(s) ? "ok" : "error"));
+    apply(bound(completion), s);
+    closure_finish();
+}
+
+/* Wrap the request completion to record an asynchronous span for the request. */
+void storage_trace_req(storage_req req)
+{
+    if (!tracepoint_enabled(TRACEPOINT_STORAGE_REQ))
+        return;
+    status_handler sh = closure(storage.h, storage_req_traced, req->completion);
+    if (sh == INVALID_ADDRESS)
+        return;
+    tracepoint_begin(TRACEPOINT_STORAGE_REQ, u64_from_pointer(sh),
+                     u64_from_pointer(storage_op_names[req->op]), req->blocks.start,
+                     req->blocks.end);
+    req->completion = sh;
+}
+#endif
+
 void init_volumes(heap h)
 {
     storage.h = h;
@@ -218,10 +396,27 @@ void init_volumes(heap h)
     storage.root_fs = 0;
     storage.mounts = 0;
     storage.mount_complete = 0;
-    spin_lock_init(&storage.lock);
+    spin_lock_init_class(&storage.lock, "storage");
     storage.mount_generation = 0;
     storage.mounts_watchers = allocate_vector(h, 1);
     assert(storage.mounts_watchers != INVALID_ADDRESS);
+    list_init(&storage.queues);
+    init_storage_queues();
+    storage.next_queue_id = 0;
+    storage.mgmt = 0;
+}
+
+void init_storage_management(tuple root)
+{
+    tuple t = allocate_tuple();
+    assert(t != INVALID_ADDRESS);
+    set(t, sym(no_encode), null_value);
+    storage_lock();
+    storage.mgmt = t;
+    list_foreach(&storage.queues, e)
+        storage_queue_management(struct_from_list(e, storage_queue, l));
+    storage_unlock();
+    set(root, sym(storage), t);
 }
 
 void storage_set_root_fs(filesystem root_fs)
@@ -365,6 +560,9 @@ void storage_detach(storage_req_handler req_handler, thunk complete)
     storage_debug("%s", __func__);
     volume vol = 0;
     storage_lock();
+    storage_queue q = storage_queue_from_driver(req_handler);
+    if (q)
+        req_handler = storage_queue_handler(q);
     list_foreach(&storage.volumes, e) {
         volume v = struct_from_list(e, volume, l);
         if (v->req_handler == req_handler) {
@@ -374,6 +572,12 @@ void storage_detach(storage_req_handler req_handler, thunk complete)
             break;
         }
     }
+    if (vol && q) {
+        /* the queue is released once the filesystem is unmounted */
+        list_delete(&q->l);
+        storage_queue_management_release(q);
+        complete = init_closure(&q->detach_complete, storage_queue_detached, complete);
+    }
     storage_unlock();
     if (vol) {
         storage_debug("  detaching volume %p, filesystem %p", vol, vol->fs);
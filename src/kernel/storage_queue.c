@@ -0,0 +1,324 @@
+/* Storage request queues
+
+   Each attached storage device gets a request queue between the filesystems
+   and the driver. Write requests issued while the submitting cpu is plugged
+   are held in the queue; a request that is contiguous with the last held one
+   is merged into it, within the driver limits. Held requests are dispatched
+   when the cpu unplugs, or ahead of any request that cannot be held.
+
+   Only writes are merged: the data of a merged request is moved to the sg
+   list of the request it is merged into, and the caller of a read would
+   find its own sg list empty on completion.
+
+   Requests that are not held go straight to the driver, with a context
+   taken from a set preallocated in the queue; the queue lock and the heap
+   are only used for held requests, or once all contexts are busy. */
+
+#ifdef KERNEL
+#include <kernel.h>
+#include <storage.h>
+#define storage_plug_depth  (current_cpu()->storage_plug)
+#else
+#include <runtime.h>
+#include <storage.h>
+#define spin_lock(l)                (void)(l)
+#define spin_unlock(l)              (void)(l)
+#define spin_lock_irq(l)            ({(void)(l); 0;})
+#define spin_unlock_irq(l, flags)   do {(void)(l); (void)(flags);} while (0)
+#define kern_now(id)                now(id)
+static u32 storage_plug_depth;
+#endif
+#include <management.h>
+#include <storage_queue.h>
+
+static struct {
+    struct list plugged;        /* queues with requests held */
+    struct spinlock lock;
+} storage_queues;
+
+static void storage_stat_max(u64 *stat, u64 v)
+{
+    u64 m;
+    while (v > (m = *(volatile u64 *)stat) && !compare_and_swap_64(stat, m, v));
+}
+
+static void storage_queue_start(storage_queue q)
+{
+    refcount_reserve(&q->refcount);
+    fetch_and_add(&q->dispatched, 1);
+    storage_stat_max(&q->max_inflight, fetch_and_add(&q->inflight, 1) + 1);
+}
+
+/* The queue may be freed on return. */
+static void storage_queue_complete(storage_queue q, timestamp start)
+{
+    timestamp latency = kern_now(CLOCK_ID_MONOTONIC_RAW) - start;
+    fetch_and_add(&q->inflight, (word)-1);
+    fetch_and_add(&q->completed, 1);
+    fetch_and_add(&q->latency_total, latency);
+    storage_stat_max(&q->latency_max, latency);
+    refcount_release(&q->refcount);
+}
+
+define_closure_function(0, 1, void, storage_qctx_complete,
+                        status, s)
+{
+    storage_qctx c = struct_from_field(closure_self(), storage_qctx, complete);
+    storage_queue q = c->q;
+    status_handler completion = c->completion;
+    timestamp start = c->start;
+    atomic_clear_bit(&q->ctx_busy, c - q->ctx);
+    storage_queue_complete(q, start);
+    apply(completion, s);
+}
+
+static storage_qctx storage_qctx_get(storage_queue q)
+{
+    u64 busy;
+    while ((busy = *(volatile u64 *)&q->ctx_busy) != -1ull) {
+        u64 i = lsb(~busy);
+        if (!atomic_test_and_set_bit(&q->ctx_busy, i))
+            return &q->ctx[i];
+    }
+    return 0;
+}
+
+define_closure_function(1, 1, void, storage_qreq_complete,
+                        storage_qreq, r,
+                        status, s)
+{
+    storage_qreq r = bound(r);
+    storage_queue q = r->q;
+    heap h = q->h;
+    list l;
+    while ((l = list_get_next(&r->merged))) {
+        list_delete(l);
+        storage_qreq m = struct_from_list(l, storage_qreq, l);
+        apply(m->completion, is_ok(s) ? STATUS_OK : timm("result", "merged storage request failed"));
+        deallocate(h, m, sizeof(*m));
+    }
+    status_handler completion = r->completion;
+    timestamp start = r->start;
+    deallocate(h, r, sizeof(*r));
+    storage_queue_complete(q, start);
+    apply(completion, s);
+}
+
+static void storage_qreq_dispatch(storage_qreq r)
+{
+    storage_queue q = r->q;
+    storage_queue_start(q);
+    struct storage_req req = {
+        .op = r->op,
+        .blocks = r->blocks,
+        .data = r->data,
+        .completion = init_closure(&r->complete, storage_qreq_complete, r),
+    };
+    r->start = kern_now(CLOCK_ID_MONOTONIC_RAW);
+    apply(q->driver, &req);
+}
+
+/* Dispatches, in submission order, the requests taken from a pending list. */
+static void storage_qreq_dispatch_list(struct list *head)
+{
+    list l;
+    while ((l = list_get_next(head))) {
+        list_delete(l);
+        storage_qreq_dispatch(struct_from_list(l, storage_qreq, l));
+    }
+}
+
+static void storage_queue_dispatch_pending(storage_queue q)
+{
+    struct list pending;
+    u64 irqflags = spin_lock_irq(&q->lock);
+    list_move(&pending, &q->pending);
+    spin_unlock_irq(&q->lock, irqflags);
+    storage_qreq_dispatch_list(&pending);
+}
+
+static storage_qreq storage_qreq_alloc(storage_queue q, storage_req req)
+{
+    storage_qreq r = allocate(q->h, sizeof(*r));
+    if (r == INVALID_ADDRESS)
+        return r;
+    r->q = q;
+    r->op = req->op;
+    r->blocks = req->blocks;
+    r->data = req->data;
+    r->completion = req->completion;
+    r->segs = 0;
+    list_init(&r->merged);
+    return r;
+}
+
+/* Passes a request on to the driver right away. */
+static void storage_queue_dispatch(storage_queue q, storage_req req)
+{
+    storage_qctx c = storage_qctx_get(q);
+    if (c) {
+        storage_queue_start(q);
+        struct storage_req dreq = *req;
+        c->completion = req->completion;
+        c->start = kern_now(CLOCK_ID_MONOTONIC_RAW);
+        dreq.completion = init_closure(&c->complete, storage_qctx_complete);
+        apply(q->driver, &dreq);
+        return;
+    }
+    storage_qreq r = storage_qreq_alloc(q, req);
+    if (r != INVALID_ADDRESS) {
+        storage_qreq_dispatch(r);
+        return;
+    }
+    fetch_and_add(&q->dispatched, 1);
+    apply(q->driver, req);
+}
+
+/* Returns the number of sg buffers holding the request data, or 0 if the sg
+   list holds more or less data than the request (e.g. it is shared with
+   subsequent requests), in which case the request is not held in the queue. */
+static u32 storage_qreq_segs(storage_qreq r)
+{
+    u64 length = range_span(r->blocks) << SECTOR_OFFSET;
+    u32 segs = 0;
+    sg_list_foreach((sg_list)r->data, sgb) {
+        u64 len = sg_buf_len(sgb);
+        if (len > length)
+            return 0;
+        length -= len;
+        segs++;
+    }
+    return length ? 0 : segs;
+}
+
+/* Called with queue lock held. */
+static boolean storage_qreq_merge(storage_queue q, storage_qreq tail, storage_qreq r)
+{
+    if ((tail->blocks.end != r->blocks.start) ||
+        (range_span(tail->blocks) + range_span(r->blocks) > q->max_blocks) ||
+        (tail->segs + r->segs > q->max_segs))
+        return false;
+    u64 length = range_span(r->blocks) << SECTOR_OFFSET;
+    assert(sg_move(tail->data, r->data, length) == length);
+    tail->blocks.end = r->blocks.end;
+    tail->segs += r->segs;
+    list_push_back(&tail->merged, &r->l);
+    return true;
+}
+
+define_closure_function(0, 1, void, storage_queue_req_handler,
+                        storage_req, req)
+{
+    storage_queue q = struct_from_field(closure_self(), storage_queue, req_handler);
+    fetch_and_add(&q->requests, 1);
+    storage_qreq r = 0;
+    if (storage_plug_depth && (req->op == STORAGE_OP_WRITESG)) {
+        r = storage_qreq_alloc(q, req);
+        if (r != INVALID_ADDRESS)
+            r->segs = storage_qreq_segs(r);
+    }
+    if (!r || (r == INVALID_ADDRESS) || !r->segs) {
+        /* Requests held by this cpu go first. The unlocked check may miss
+           requests being held on other cpus, which are not ordered with
+           this one anyway. */
+        if (!list_empty(&q->pending))
+            storage_queue_dispatch_pending(q);
+        if (r && (r != INVALID_ADDRESS))
+            storage_qreq_dispatch(r);
+        else
+            storage_queue_dispatch(q, req);
+        return;
+    }
+    u64 irqflags = spin_lock_irq(&q->lock);
+    if (list_empty(&q->pending)) {
+        spin_lock(&storage_queues.lock);
+        if (!list_inserted(&q->plug_l))
+            list_push_back(&storage_queues.plugged, &q->plug_l);
+        spin_unlock(&storage_queues.lock);
+    } else if (storage_qreq_merge(q, struct_from_list(q->pending.prev, storage_qreq, l), r)) {
+        fetch_and_add(&q->merged, 1);
+        spin_unlock_irq(&q->lock, irqflags);
+        return;
+    }
+    list_push_back(&q->pending, &r->l);
+    spin_unlock_irq(&q->lock, irqflags);
+}
+
+/* Requests issued by this cpu until the matching storage_unplug() may be
+   held for merging; plugged sections can be nested, and must not block. */
+void storage_plug(void)
+{
+    storage_plug_depth++;
+}
+
+void storage_unplug(void)
+{
+    assert(storage_plug_depth > 0);
+    if (--storage_plug_depth > 0)
+        return;
+    while (true) {
+        u64 irqflags = spin_lock_irq(&storage_queues.lock);
+        list l = list_get_next(&storage_queues.plugged);
+        if (l)
+            list_delete(l);
+        spin_unlock_irq(&storage_queues.lock, irqflags);
+        if (!l)
+            break;
+        storage_queue_dispatch_pending(struct_from_list(l, storage_queue, plug_l));
+    }
+}
+
+define_closure_function(0, 0, void, storage_queue_free)
+{
+    storage_queue q = struct_from_field(closure_self(), storage_queue, free);
+    deallocate(q->h, q, sizeof(*q));
+}
+
+storage_queue allocate_storage_queue(heap h, storage_req_handler driver)
+{
+    storage_queue q = allocate_zero(h, sizeof(*q));
+    if (q == INVALID_ADDRESS)
+        return q;
+    q->h = h;
+    q->driver = driver;
+    init_closure(&q->req_handler, storage_queue_req_handler);
+    q->max_blocks = STORAGE_MERGE_MAX_BYTES >> SECTOR_OFFSET;
+    q->max_segs = STORAGE_MERGE_MAX_SEGS;
+    spin_lock_init_class(&q->lock, "storage_queue");
+    list_init(&q->pending);
+    list_init_member(&q->plug_l);
+    for (int i = 0; i < STORAGE_QUEUE_CONTEXTS; i++)
+        q->ctx[i].q = q;
+    init_refcount(&q->refcount, 1, init_closure(&q->free, storage_queue_free));
+    return q;
+}
+
+/* Lowers the size of merged requests to what the driver can handle as a
+   single device command; zero values leave the corresponding limit as is. */
+void storage_queue_set_limits(storage_queue q, u64 max_bytes, u32 max_segs)
+{
+    u64 irqflags = spin_lock_irq(&q->lock);
+    if (max_bytes)
+        q->max_blocks = MAX(MIN(q->max_blocks, max_bytes >> SECTOR_OFFSET), 1);
+    if (max_segs)
+        q->max_segs = MIN(q->max_segs, max_segs);
+    spin_unlock_irq(&q->lock, irqflags);
+}
+
+/* Dispatches any held requests and frees the queue once the last request
+   completes. No further requests may be issued. */
+void storage_queue_release(storage_queue q)
+{
+    u64 irqflags = spin_lock_irq(&storage_queues.lock);
+    if (list_inserted(&q->plug_l))
+        list_delete(&q->plug_l);
+    spin_unlock_irq(&storage_queues.lock, irqflags);
+    storage_queue_dispatch_pending(q);
+    refcount_release(&q->refcount);
+}
+
+void init_storage_queues(void)
+{
+    list_init(&storage_queues.plugged);
+    spin_lock_init_class(&storage_queues.lock, "storage_plug");
+}
@@ -0,0 +1,98 @@
+/* Request queue between the filesystems and a storage driver. The queue
+   itself is in storage_queue.c, which also builds outside of the kernel;
+   storage.c attaches one to each storage device and exposes its stats. */
+
+enum storage_stat {
+    STORAGE_STAT_INFLIGHT,
+    STORAGE_STAT_MAX_INFLIGHT,
+    STORAGE_STAT_REQUESTS,
+    STORAGE_STAT_MERGED,
+    STORAGE_STAT_DISPATCHED,
+    STORAGE_STAT_LATENCY_AVG_US,
+    STORAGE_STAT_LATENCY_MAX_US,
+    STORAGE_STAT_MAX_SEGS,
+    STORAGE_STAT_MAX_KB,
+    STORAGE_STAT_COUNT
+};
+
+typedef struct storage_queue *storage_queue;
+typedef struct storage_qreq *storage_qreq;
+
+declare_closure_struct(0, 1, void, storage_queue_req_handler,
+                       storage_req, req);
+declare_closure_struct(1, 1, void, storage_qreq_complete,
+                       storage_qreq, r,
+                       status, s);
+declare_closure_struct(0, 1, void, storage_qctx_complete,
+                       status, s);
+declare_closure_struct(0, 0, void, storage_queue_free);
+declare_closure_struct(1, 0, void, storage_queue_detached,
+                       thunk, complete);
+
+/* A request held for merging, or passed on once no context was free */
+struct storage_qreq {
+    struct list l;              /* pending list, or merged list of the head request */
+    storage_queue q;
+    u8 op;
+    range blocks;
+    void *data;
+    status_handler completion;
+    u32 segs;                   /* sg buffers */
+    struct list merged;
+    timestamp start;
+    closure_struct(storage_qreq_complete, complete);
+};
+
+/* Preallocated context of a request passed straight on to the driver */
+typedef struct storage_qctx {
+    storage_queue q;
+    status_handler completion;
+    timestamp start;
+    closure_struct(storage_qctx_complete, complete);
+} *storage_qctx;
+
+#define STORAGE_QUEUE_CONTEXTS  64  /* one bit each in ctx_busy */
+
+struct storage_queue {
+    heap h;
+    storage_req_handler driver;
+    closure_struct(storage_queue_req_handler, req_handler);
+    u64 max_blocks;
+    u32 max_segs;
+    struct spinlock lock;       /* pending */
+    struct list pending;
+    struct list plug_l;         /* on the plugged list while requests are held */
+    u64 ctx_busy;
+    struct storage_qctx ctx[STORAGE_QUEUE_CONTEXTS];
+    struct refcount refcount;   /* held by the owner and by each request in the driver */
+    closure_struct(storage_queue_free, free);
+
+    /* statistics, updated atomically */
+    u64 inflight;
+    u64 max_inflight;
+    u64 requests;
+    u64 merged;
+    u64 dispatched;
+    u64 completed;
+    timestamp latency_total;
+    timestamp latency_max;
+
+    /* managed by storage.c */
+    struct list l;
+    int id;
+    int attach_id;
+    tuple stats;
+    tuple mgmt;
+    get_value_notify stat_notify[STORAGE_STAT_COUNT];
+    closure_struct(storage_queue_detached, detach_complete);
+};
+
+void init_storage_queues(void);
+storage_queue allocate_storage_queue(heap h, storage_req_handler driver);
+void storage_queue_set_limits(storage_queue q, u64 max_bytes, u32 max_segs);
+void storage_queue_release(storage_queue q);
+
+static inline storage_req_handler storage_queue_handler(storage_queue q)
+{
+    return (storage_req_handler)&q->req_handler;
+}
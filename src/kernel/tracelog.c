@@ -13,18 +13,21 @@
 
 #define TRACELOG_HTTP_PORT                 9090
 #define TRACELOG_TRACE_URI                 "tracelog"
-#define TRACELOG_DEFAULT_BUFFER_SIZE       (1 << 19)
-#define TRACELOG_SPACE_COLLATE_THRESHOLD   ((TRACELOG_ENTRY_SIZE) * 8)
+#define TRACELOG_DEFAULT_RING_SIZE         (1 << 19)
+#define TRACELOG_TEXT_MAX                  512
 #define TRACELOG_HTTP_CHUNK_MAXSIZE        (64 << 10)
+/* leave room for a maximum-size text entry escaped for JSON */
 #define TRACELOG_HTTP_CHUNK_THRESHOLD      (TRACELOG_HTTP_CHUNK_MAXSIZE - \
-                                            TRACELOG_ENTRY_SIZE)
-#define TRACELOG_COLLATE_SPIN_TIMEOUT      (1ull << 27)
-#define TRACELOG_MAX_FREE_BYTES            (TRACELOG_DEFAULT_BUFFER_SIZE * 16)
+                                            TRACELOG_TEXT_MAX * 8)
 #define TRACELOG_COLLATE_TIMER_PERIOD_SEC  1
 #define TRACELOG_FILE_WRITE_THRESHOLD      PAGESIZE
 
+/* Chrome trace event "processes" */
+#define TRACELOG_JSON_PID_CPUS             0
+#define TRACELOG_JSON_PID_THREADS          1
+
 declare_closure_struct(2, 0, void, tracelog_send_http_chunk,
-                       buffer_handler, out, buffer, relative_uri);
+                       http_responder, out, boolean, json);
 
 declare_closure_struct(0, 0, void, tracelog_collator);
 
@@ -34,55 +37,88 @@ declare_closure_struct(0, 2, void, tracelog_collate_timer_func,
 struct tracelog {
     heap h;
     mutex m;
-    struct list collated_entries;
-    struct list free_tracelog_buffers;
-    bytes n_free;
-    bytes alloc_size;
+    buffer collated;            /* time-ordered entries, not yet formatted */
+    struct tracelog_cursor *cursors;
+    bytes ring_size;
     tuple trace_tags;
+    u64 tracepoint_mask;        /* enabled typed tracepoints */
     closure_struct(tracelog_collator, collator);
     closure_struct(tracelog_send_http_chunk, send_http_chunk);
+    boolean http_json_first;
     http_listener http_listener;
     fsfile logfile;
     sg_io fs_write;
     bytes file_offset;
+    boolean file_json;
+    boolean file_json_first;
     struct timer collate_timer;
     closure_struct(tracelog_collate_timer_func, collate_timer_func);
     boolean collator_scheduled;
     boolean disabled;
 } tracelog;
 
-declare_closure_struct(1, 0, void, tracelog_buffer_free_locked,
-                       struct tracelog_buffer *, tb);
-
-typedef struct tracelog_buffer {
-    struct buffer b;
-    struct list l;
-    struct refcount refcount;
-    value lasttag;
-    closure_struct(tracelog_buffer_free_locked, free);
-} *tracelog_buffer;
-
-#define TRACELOG_ENTRY_SIZE  256
-#define TRACELOG_ENTRY_STRING_SIZE (TRACELOG_ENTRY_SIZE - 56)
-#define TRACELOG_BUFFER_BUSY 1
+u64 tracepoint_mask;
 
+/* Entries are stored as a sequence of u64 words: this header, the raw
+   arguments and, for text entries, the formatted string. The layout is the
+   same in the per-cpu rings and in the collated buffer. */
 typedef struct tracelog_entry {
-    timestamp t;                /* 0 */
-    symbol tag;                 /* 8 */
-    value attrs;                /* 16 */
-    u32 cpu;                    /* 24 */
-    u32 str_len;
-    struct list l;              /* 32 */
-    tracelog_buffer tb;         /* 48 */
-    char str[TRACELOG_ENTRY_STRING_SIZE]; /* 56 */
+    timestamp t;
+    u16 nwords;                 /* including header */
+    u16 id;
+    u16 cpu;
+    u8 ph;
+    u8 nargs;
+    u64 args[0];
 } *tracelog_entry;
 
-build_assert(sizeof(struct tracelog_entry) == TRACELOG_ENTRY_SIZE);
-build_assert((TRACELOG_ENTRY_SIZE & (TRACELOG_ENTRY_SIZE - 1)) == 0);
-
-#define TRACELOG_HEADER_SIZE (TRACELOG_ENTRY_SIZE - TRACELOG_ENTRY_STRING_SIZE)
-#define TRACELOG_OFFSET_MASK (TRACELOG_ENTRY_SIZE - 1)
-#define TRACELOG_CAS_BUSY_SPIN_LIMIT 4
+#define TRACELOG_ENTRY_HEADER_WORDS 2
+build_assert(sizeof(struct tracelog_entry) == TRACELOG_ENTRY_HEADER_WORDS * sizeof(u64));
+
+/* text entry arguments */
+#define TRACELOG_TEXT_TAG   0
+#define TRACELOG_TEXT_ATTRS 1
+#define TRACELOG_TEXT_LEN   2
+#define TRACELOG_TEXT_NARGS 3
+
+/* Per-cpu single-producer, single-consumer ring. Only the owning cpu, with
+   interrupts disabled, advances head; only the collator, with the tracelog
+   mutex held, advances tail. Entries that don't fit are dropped. */
+typedef struct tracelog_ring {
+    u64 *words;
+    u64 mask;
+    u64 head;
+    u64 tail;
+    u64 dropped;
+    u64 dropped_reported;
+} *tracelog_ring;
+
+struct tracelog_cursor {
+    u64 pos;
+    u64 end;
+};
+
+/* Span-type tracepoints may end on another cpu or thread, so they carry an
+   identifier in their first argument: a thread id for synchronous spans,
+   which nest per thread, or a unique id for asynchronous spans, which may
+   overlap. */
+#define TRACEPOINT_F_ASYNC  1   /* arg 0 is an async span id rather than a tid */
+#define TRACEPOINT_F_NAMED  2   /* arg 1 of a begin entry is a (const char *) span name */
+
+static const struct tracepoint_desc {
+    const char *name;
+    const char *begin_format;   /* applied to the arguments after the id and name */
+    const char *end_format;
+    u8 flags;
+} tracepoints[TRACEPOINT_MAX] = {
+    [TRACEPOINT_TEXT] = {"text", 0, 0, 0},
+    [TRACEPOINT_SYSCALL] = {"syscall", "nr %ld, args 0x%lx 0x%lx 0x%lx", "rv %ld",
+                            TRACEPOINT_F_NAMED},
+    [TRACEPOINT_PAGE_FAULT] = {"page_fault", "tid %ld, addr 0x%lx", "%s",
+                               TRACEPOINT_F_ASYNC},
+    [TRACEPOINT_STORAGE_REQ] = {"storage_req", "%s, blocks 0x%lx-0x%lx", "%s",
+                                TRACEPOINT_F_ASYNC},
+};
 
 static inline void schedule_collator(void)
 {
@@ -107,31 +143,10 @@ define_closure_function(0, 2, void, tracelog_collate_timer_func,
     }
 }
 
-static inline tracelog_buffer get_tracelog_buffer(cpuinfo ci)
-{
-    int n = TRACELOG_CAS_BUSY_SPIN_LIMIT;
-    u64 w = u64_from_pointer(ci->tracelog_buffer);
-    if (!w)
-        return 0;
-    if (w & TRACELOG_BUFFER_BUSY)
-        return pointer_from_u64(w ^ TRACELOG_BUFFER_BUSY);
-    while (!compare_and_swap_64((u64*)&ci->tracelog_buffer, w,
-                                w | TRACELOG_BUFFER_BUSY)) {
-        assert(n-- > 0);
-        kern_pause();
-        w = u64_from_pointer(ci->tracelog_buffer);
-    }
-    if (!w)
-        ci->tracelog_buffer = 0;
-    return pointer_from_u64(w);
-}
-
-static inline void put_tracelog_buffer(cpuinfo ci)
+static void tracelog_set_enabled(boolean enabled)
 {
-    u64 v = u64_from_pointer(ci->tracelog_buffer);
-    assert(v & TRACELOG_BUFFER_BUSY);
-    write_barrier();
-    ci->tracelog_buffer = pointer_from_u64(v ^ TRACELOG_BUFFER_BUSY);
+    tracelog.disabled = !enabled;
+    tracepoint_mask = enabled ? tracelog.tracepoint_mask : 0;
 }
 
 closure_function(2, 2, boolean, match_vec_attrs,
@@ -183,90 +198,78 @@ static boolean match_tag_and_attrs(symbol tag, tuple attrs)
    return true;
 }
 
-static void close_trace_entry(cpuinfo ci, tracelog_buffer tb)
-{
-    buffer b = &tb->b;
-    push_u8(b, '\0');
-    tracelog_entry te = buffer_ref(b, buffer_length(b) & ~TRACELOG_OFFSET_MASK);
-    u64 entry_len = buffer_length(b) & TRACELOG_OFFSET_MASK;
-    te->str_len = entry_len - TRACELOG_HEADER_SIZE - 1;
-    tracelog_debug("   finish: str_len %d entry_len %ld, produce %ld, string:\n%s\n",
-                   te->str_len, entry_len, TRACELOG_ENTRY_SIZE - entry_len, te->str);
-    buffer_produce(b, TRACELOG_ENTRY_SIZE - entry_len);
-    if (!buffer_extend(b, TRACELOG_ENTRY_SIZE)) { /* for next */
-        msg_err("failed to extend tracelog buffer; reduce collate threshold, reduce "
-                "volume of traces or increase memory; disabling tracing\n");
-        /* TODO consider eating up oldest entries to keep system alive through shutdown */
-        tracelog.disabled = true;
+/* interrupts disabled */
+static void tracelog_put(cpuinfo ci, int id, int ph, u64 *args, int nargs,
+                         const char *text, bytes text_len)
+{
+    tracelog_ring r = ci->tracelog_ring;
+    if (!r)
+        return;
+    u64 nwords = TRACELOG_ENTRY_HEADER_WORDS + nargs + pad(text_len, sizeof(u64)) / sizeof(u64);
+    u64 head = r->head;
+    u64 size = r->mask + 1;
+    u64 used = head - *(volatile u64 *)&r->tail;
+    if (used + nwords > size) {
+        r->dropped++;
+        return;
     }
+    struct tracelog_entry te = {
+        .t = now(CLOCK_ID_MONOTONIC),
+        .nwords = nwords,
+        .id = id,
+        .cpu = ci->id,
+        .ph = ph,
+        .nargs = nargs,
+    };
+    u64 *w = (u64 *)&te;
+    u64 pos = head;
+    for (int i = 0; i < TRACELOG_ENTRY_HEADER_WORDS; i++)
+        r->words[pos++ & r->mask] = w[i];
+    for (int i = 0; i < nargs; i++)
+        r->words[pos++ & r->mask] = args[i];
+    for (bytes off = 0; off < text_len; off += sizeof(u64)) {
+        u64 word = 0;
+        runtime_memcpy(&word, text + off, MIN(sizeof(u64), text_len - off));
+        r->words[pos++ & r->mask] = word;
+    }
+    write_barrier();
+    r->head = pos;
+    if (used + nwords > size / 2)
+        schedule_collator();
 }
 
+void tracepoint_record(int id, int ph, u64 *args, int nargs)
+{
+    u64 saved_flags = irq_disable_save();
+    tracelog_put(current_cpu(), id, ph, args, nargs, 0, 0);
+    irq_restore(saved_flags);
+}
+
+/* Arbitrary format arguments may not outlive the call, so text entries are
+   still formatted here; only the header formatting is deferred. */
 void vtprintf(symbol tag, tuple attrs, const char *format, vlist *ap)
 {
     cpuinfo ci = current_cpu();
     if (tracelog.disabled || !match_tag_and_attrs(tag, attrs))
         return;
+    buffer b = little_stack_buffer(TRACELOG_TEXT_MAX);
+    buffer f = alloca_wrap_buffer(format, runtime_strlen(format));
     if (!tracelog.m) {
-        buffer b = little_stack_buffer(TRACELOG_ENTRY_STRING_SIZE);
-        buffer f = alloca_wrap_buffer(format, runtime_strlen(format));
         bprintf(b, "[%T, %d, %v] ", now(CLOCK_ID_MONOTONIC), ci->id, tag);
         vbprintf(b, f, ap);
         buffer_print(b);
         return;
     }
+    vbprintf(b, f, ap);
+    if (buffer_length(b) == 0)
+        return;
+    u64 args[TRACELOG_TEXT_NARGS];
+    args[TRACELOG_TEXT_TAG] = u64_from_pointer(tag);
+    args[TRACELOG_TEXT_ATTRS] = u64_from_pointer(attrs);
+    args[TRACELOG_TEXT_LEN] = buffer_length(b);
     u64 saved_flags = irq_disable_save();
-    tracelog_buffer tb = get_tracelog_buffer(ci);
-    if (!tb)
-        goto out_irq_restore;
-
-    /* A trace print could occur for one tag while a line print for another is
-       in progress. For now, just close out the interrupted line with a newline. */
-    if (tb->lasttag && tb->lasttag != tag)
-        close_trace_entry(ci, tb);
-    tb->lasttag = tag;
-    buffer b = &tb->b;
-    u64 entry_start = buffer_length(b) & ~TRACELOG_OFFSET_MASK;
-    u64 entry_offset = buffer_length(b) & TRACELOG_OFFSET_MASK;
-    tracelog_debug("%s: buffer %p, tag %v, format \"%s\", buffer_length %ld,\n"
-                   "entry start %ld\n", __func__, b, tag, format, buffer_length(b),
-                   entry_start);
-    tracelog_entry te = buffer_ref(b, entry_start);
-
-    if (entry_offset == 0) {
-        tracelog_debug("   new entry at start %ld\n", buffer_length(b));
-        assert(buffer_space(b) >= sizeof(struct tracelog_entry));
-        te->t = now(CLOCK_ID_MONOTONIC);
-        te->tag = tag;
-        te->attrs = attrs;
-        te->cpu = ci->id;
-        /* could avoid storing tb if we used fixed-sized, aligned buffers with headers */
-        te->tb = tb;
-        entry_offset = TRACELOG_HEADER_SIZE;
-        buffer_produce(b, TRACELOG_HEADER_SIZE);
-    }
-
-    int remain = TRACELOG_ENTRY_SIZE - entry_offset - 1 /* terminator */;
-    assert(remain > 0);
-
-    /* writing to a wrapped buffer takes care of boundaries */
-    void *p = buffer_ref(b, entry_start + entry_offset);
-    tracelog_debug("   write at %p, remain %ld\n", p, remain);
-    buffer teb = alloca_wrap_buffer(p, remain);
-    buffer_clear(teb);
-    vbprintf(teb, alloca_wrap_buffer(format, runtime_strlen(format)), ap);
-    int written = buffer_length(teb);
-    if (written == 0)
-        goto out_irq_restore;
-    buffer_produce(b, written);
-    assert((buffer_length(b) & TRACELOG_OFFSET_MASK) != 0);
-    if (*(u8*)(buffer_end(b) - 1) == '\n') {
-        close_trace_entry(ci, tb);
-        if (buffer_space(b) <= TRACELOG_SPACE_COLLATE_THRESHOLD)
-            schedule_collator();
-        put_tracelog_buffer(ci);
-        tb->lasttag = 0;
-    }
-  out_irq_restore:
+    tracelog_put(ci, TRACEPOINT_TEXT, TRACEPOINT_INSTANT, args, TRACELOG_TEXT_NARGS,
+                 buffer_ref(b, 0), buffer_length(b));
     irq_restore(saved_flags);
 }
 
@@ -278,98 +281,219 @@ void tprintf(symbol tag, tuple attrs, const char *format, ...)
     vend(ap);
 }
 
-/* mutex held */
-define_closure_function(1, 0, void, tracelog_buffer_free_locked,
-                        tracelog_buffer, tb)
-{
-    tracelog_debug("%s: tb %p\n", __func__, bound(tb));
-    tracelog_buffer tb = bound(tb);
-    buffer_clear(&tb->b);
-    if (tracelog.n_free < TRACELOG_MAX_FREE_BYTES) {
-        list_insert_after(&tracelog.free_tracelog_buffers, &tb->l);
-        tracelog.n_free += tb->b.length;
-    } else {
-        deallocate(tracelog.h, tb->b.contents, tb->b.length);
-        deallocate(tracelog.h, tb, sizeof(*tb));
-    }
+static inline void tracelog_ring_entry_header(tracelog_ring r, u64 pos, tracelog_entry te)
+{
+    u64 *w = (u64 *)te;
+    for (int i = 0; i < TRACELOG_ENTRY_HEADER_WORDS; i++)
+        w[i] = r->words[(pos + i) & r->mask];
 }
 
-/* mutex held */
-static tracelog_buffer allocate_tracelog_buffer_locked(void)
+/* mutex held; merge the per-cpu rings into the collated buffer in time order */
+static void tracelog_collate_rings_locked(void)
 {
-    tracelog_debug("%s\n", __func__);
-    tracelog_buffer tb;
-    list l = list_get_next(&tracelog.free_tracelog_buffers);
-    if (l) {
-        tb = struct_from_list(l, tracelog_buffer, l);
-        list_delete(l);
-        assert(tracelog.n_free > 0);
-        tracelog.n_free -= tb->b.length;
-        refcount_set_count(&tb->refcount, 1);
-    } else {
-        tb = allocate(tracelog.h, sizeof(*tb));
-        if (tb == INVALID_ADDRESS)
-            return tb;
-        void *contents = allocate(tracelog.h, tracelog.alloc_size);
-        if (contents == INVALID_ADDRESS) {
-            deallocate(tracelog.h, tb, sizeof(*tb));
-            return INVALID_ADDRESS;
+    u64 ncpus = total_processors;
+    struct tracelog_cursor *cur = tracelog.cursors;
+    for (int i = 0; i < ncpus; i++) {
+        tracelog_ring r = cpuinfo_from_id(i)->tracelog_ring;
+        cur[i].pos = cur[i].end = 0;
+        if (!r)
+            continue;
+        cur[i].pos = r->tail;
+        cur[i].end = *(volatile u64 *)&r->head;
+    }
+    read_barrier();
+    buffer c = tracelog.collated;
+    while (1) {
+        int next = -1;
+        timestamp tnext = 0;
+        for (int i = 0; i < ncpus; i++) {
+            if (cur[i].pos == cur[i].end)
+                continue;
+            tracelog_ring r = cpuinfo_from_id(i)->tracelog_ring;
+            timestamp t = r->words[cur[i].pos & r->mask];
+            if (next < 0 || t < tnext) {
+                next = i;
+                tnext = t;
+            }
+        }
+        if (next < 0)
+            break;
+        tracelog_ring r = cpuinfo_from_id(next)->tracelog_ring;
+        struct tracelog_entry te;
+        tracelog_ring_entry_header(r, cur[next].pos, &te);
+        u64 nwords = te.nwords;
+        if (!buffer_extend(c, nwords * sizeof(u64))) {
+            msg_err("failed to extend tracelog buffer; reduce volume of traces "
+                    "or increase memory; disabling tracing\n");
+            tracelog_set_enabled(false);
+            break;
+        }
+        u64 *w = buffer_end(c);
+        for (int i = 0; i < nwords; i++)
+            w[i] = r->words[(cur[next].pos + i) & r->mask];
+        buffer_produce(c, nwords * sizeof(u64));
+        cur[next].pos += nwords;
+    }
+
+    /* entries are copied out before the space is handed back */
+    memory_barrier();
+    for (int i = 0; i < ncpus; i++) {
+        tracelog_ring r = cpuinfo_from_id(i)->tracelog_ring;
+        if (!r)
+            continue;
+        r->tail = cur[i].end;
+        u64 dropped = r->dropped;
+        if (dropped != r->dropped_reported) {
+            msg_err("tracelog: cpu %d ring full, dropped %ld entries\n",
+                    i, dropped - r->dropped_reported);
+            r->dropped_reported = dropped;
         }
-        assert(contents != INVALID_ADDRESS);
-        init_buffer(&tb->b, tracelog.alloc_size, false, tracelog.h, contents);
-        list_init_member(&tb->l);
-        init_refcount(&tb->refcount, 1,
-                      init_closure(&tb->free, tracelog_buffer_free_locked, tb));
-        tb->lasttag = 0;
     }
-    return tb;
 }
 
-static void reserve_tracelog_buffer(tracelog_buffer tb)
+static const char *tracelog_entry_name(tracelog_entry te)
 {
-    refcount_reserve(&tb->refcount);
+    const struct tracepoint_desc *d = &tracepoints[te->id];
+    if ((d->flags & TRACEPOINT_F_NAMED) && te->ph == TRACEPOINT_BEGIN && te->nargs > 1 &&
+        te->args[1])
+        return pointer_from_u64(te->args[1]);
+    return d->name;
 }
 
-/* must have mutex */
-static void release_tracelog_buffer_locked(tracelog_buffer tb)
+static void tracelog_format_detail(buffer b, tracelog_entry te)
 {
-    refcount_release(&tb->refcount);
+    const struct tracepoint_desc *d = &tracepoints[te->id];
+    const char *format = te->ph == TRACEPOINT_END ? d->end_format : d->begin_format;
+    if (!format)
+        return;
+    int first = 1;  /* skip the span id */
+    if ((d->flags & TRACEPOINT_F_NAMED) && te->ph == TRACEPOINT_BEGIN)
+        first++;
+    u64 a[TRACEPOINT_MAX_ARGS];
+    zero(a, sizeof(a));
+    for (int i = first; i < te->nargs; i++)
+        a[i - first] = te->args[i];
+    bprintf(b, format, a[0], a[1], a[2], a[3], a[4], a[5]);
+}
+
+static inline void tracelog_entry_text(tracelog_entry te, char **text, bytes *len)
+{
+    *text = (char *)&te->args[te->nargs];
+    *len = te->args[TRACELOG_TEXT_LEN];
+}
+
+static void tracelog_format_text(buffer b, tracelog_entry te)
+{
+    bprintf(b, "[%T, %d, ", te->t, te->cpu);
+    if (te->id == TRACEPOINT_TEXT) {
+        char *text;
+        bytes len;
+        tracelog_entry_text(te, &text, &len);
+        bprintf(b, "%v", pointer_from_u64(te->args[TRACELOG_TEXT_TAG]));
+        value attrs = pointer_from_u64(te->args[TRACELOG_TEXT_ATTRS]);
+        if (attrs)
+            bprintf(b, " %v", attrs);
+        bprintf(b, "] ");
+        buffer_write(b, text, len);
+        if (len == 0 || text[len - 1] != '\n')
+            push_u8(b, '\n');
+        return;
+    }
+    static const char *ph_strings[] = {"", "begin ", "end "};
+    bprintf(b, "%s] %s%s %ld: ", tracepoints[te->id].name, ph_strings[te->ph],
+            tracelog_entry_name(te), te->args[0]);
+    tracelog_format_detail(b, te);
+    push_u8(b, '\n');
+}
+
+static void json_escape(buffer b, const char *s, bytes len)
+{
+    for (bytes i = 0; i < len; i++) {
+        char c = s[i];
+        if (c == '"' || c == '\\') {
+            push_u8(b, '\\');
+            push_u8(b, c);
+        } else if (c == '\n') {
+            buffer_write_cstring(b, "\\n");
+        } else if ((u8)c < 0x20) {
+            bprintf(b, "\\u%04x", (u8)c);
+        } else {
+            push_u8(b, c);
+        }
+    }
 }
 
-closure_function(4, 1, void, tracelog_file_write_complete,
-                 sg_list, sg, buffer, b, status_handler, complete, boolean, flushing,
-                 status, s)
+static void tracelog_format_json_header(buffer b)
 {
-    if (!is_ok(s))
-        msg_err("failed to %s tracelog: %v\n", bound(flushing) ? "flush" : "write to", s);
-    if (bound(flushing)) {
-        async_apply_status_handler(bound(complete), s);
-        closure_finish();
+    bprintf(b, "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"cpus\"}},\n"
+            "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"threads\"}}",
+            TRACELOG_JSON_PID_CPUS, TRACELOG_JSON_PID_THREADS);
+}
+
+/* Chrome trace event format, as loaded by Perfetto and chrome://tracing */
+static void tracelog_format_json(buffer b, tracelog_entry te)
+{
+    u64 ns = nsec_from_timestamp(te->t);
+    if (te->id == TRACEPOINT_TEXT) {
+        char *text;
+        bytes len;
+        tracelog_entry_text(te, &text, &len);
+        if (len > 0 && text[len - 1] == '\n')
+            len--;
+        bprintf(b, ",\n{\"name\":\"%v\",\"cat\":\"text\",\"ph\":\"i\",\"s\":\"t\","
+                "\"ts\":%ld.%03ld,\"pid\":%d,\"tid\":%d,\"args\":{\"msg\":\"",
+                pointer_from_u64(te->args[TRACELOG_TEXT_TAG]), ns / THOUSAND, ns % THOUSAND,
+                TRACELOG_JSON_PID_CPUS, te->cpu);
+        json_escape(b, text, len);
+        buffer_write_cstring(b, "\"}}");
         return;
     }
-    deallocate_buffer(bound(b));
-    deallocate_sg_list(bound(sg));
-    if (bound(complete)) {
-        bound(flushing) = true;
-        fsfile_flush(tracelog.logfile, false, (status_handler)closure_self());
-    } else {
-        closure_finish();
+    const struct tracepoint_desc *d = &tracepoints[te->id];
+    boolean async = (d->flags & TRACEPOINT_F_ASYNC) != 0;
+    static const char sync_ph[] = {'i', 'B', 'E'};
+    static const char async_ph[] = {'n', 'b', 'e'};
+    bprintf(b, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%ld.%03ld,",
+            tracelog_entry_name(te), d->name, async ? async_ph[te->ph] : sync_ph[te->ph],
+            ns / THOUSAND, ns % THOUSAND);
+    if (async)
+        bprintf(b, "\"id\":\"0x%lx\",\"pid\":%d,\"tid\":%d,", te->args[0],
+                TRACELOG_JSON_PID_CPUS, te->cpu);
+    else
+        bprintf(b, "\"pid\":%d,\"tid\":%ld,", TRACELOG_JSON_PID_THREADS, te->args[0]);
+    if (te->ph == TRACEPOINT_INSTANT)
+        buffer_write_cstring(b, "\"s\":\"t\",");
+    buffer_write_cstring(b, "\"args\":{\"detail\":\"");
+    buffer d_buf = little_stack_buffer(256);
+    tracelog_format_detail(d_buf, te);
+    json_escape(b, buffer_ref(d_buf, 0), buffer_length(d_buf));
+    buffer_write_cstring(b, "\"}}");
+}
+
+/* mutex held; consume collated entries, formatting them into b */
+static void tracelog_buffer_fill_locked(buffer b, bytes threshold, boolean json)
+{
+    buffer c = tracelog.collated;
+    while (buffer_length(c) > 0 && buffer_length(b) <= threshold) {
+        tracelog_entry te = buffer_ref(c, 0);
+        if (json)
+            tracelog_format_json(b, te);
+        else
+            tracelog_format_text(b, te);
+        buffer_consume(c, te->nwords * sizeof(u64));
     }
 }
 
-static void tracelog_buffer_fill_locked(buffer b, bytes threshold)
+closure_function(3, 1, void, tracelog_file_write_complete,
+                 sg_list, sg, buffer, b, status_handler, complete,
+                 status, s)
 {
-    list_foreach(&tracelog.collated_entries, l) {
-        tracelog_entry te = struct_from_list(l, tracelog_entry, l);
-        bprintf(b, "[%T, %d, %v", te->t, te->cpu, te->tag);
-        if (te->attrs)
-            bprintf(b, " %v", te->attrs);
-        bprintf(b, "] %s", te->str);
-        list_delete(l);
-        release_tracelog_buffer_locked(te->tb);
-        if (buffer_length(b) > threshold)
-            break;
-    }
+    if (!is_ok(s))
+        msg_err("failed to write to tracelog: %v\n", s);
+    deallocate_buffer(bound(b));
+    deallocate_sg_list(bound(sg));
+    if (bound(complete))
+        fsfile_flush(tracelog.logfile, false, bound(complete));
+    closure_finish();
 }
 
 /* mutex held */
@@ -382,8 +506,19 @@ static void tracelog_file_write(status_handler complete)
     buffer b = allocate_buffer(tracelog.h, TRACELOG_FILE_WRITE_THRESHOLD);
     if (b == INVALID_ADDRESS)
         goto fail_dealloc_sg;
-    tracelog_buffer_fill_locked(b, TRACELOG_FILE_WRITE_THRESHOLD);
+    if (tracelog.file_json && tracelog.file_json_first) {
+        tracelog_format_json_header(b);
+        tracelog.file_json_first = false;
+    }
+    tracelog_buffer_fill_locked(b, -1ull, tracelog.file_json);
     bytes size = buffer_length(b);
+    if (size == 0) {
+        deallocate_buffer(b);
+        deallocate_sg_list(sg);
+        if (complete)
+            async_apply_status_handler(complete, STATUS_OK);
+        return;
+    }
     sg_buf sgb = sg_list_tail_add(sg, size);
     if (sgb == INVALID_ADDRESS)
         goto fail_dealloc_buf;
@@ -391,7 +526,7 @@ static void tracelog_file_write(status_handler complete)
     sgb->size = size;
     sgb->offset = 0;
     sgb->refcount = 0;
-    status_handler sh = closure(tracelog.h, tracelog_file_write_complete, sg, b, complete, false);
+    status_handler sh = closure(tracelog.h, tracelog_file_write_complete, sg, b, complete);
     if (sh == INVALID_ADDRESS)
         goto fail_dealloc_buf;
 
@@ -410,75 +545,15 @@ static void tracelog_file_write(status_handler complete)
         async_apply_status_handler(complete, timm("status", "out of memory"));
 }
 
-static boolean tracelog_entry_compare(void *za, void *zb)
-{
-    buffer ba = &((tracelog_buffer)za)->b;
-    buffer bb = &((tracelog_buffer)zb)->b;
-    assert(buffer_length(ba) > 0 && buffer_length(bb) > 0);
-
-    /* lower time is the higher priority
-       TODO suffers the same problem as elsewhere - need to have a static time
-       reference and compare deltas instead of absolute timestamps */
-    return ((tracelog_entry)buffer_ref(ba, 0))->t > ((tracelog_entry)buffer_ref(bb, 0))->t;
-}
-
 static void tracelog_collate(status_handler complete)
 {
-    pqueue pq = allocate_pqueue(tracelog.h, tracelog_entry_compare);
-    assert(pq != INVALID_ADDRESS);
-
     mutex_lock(tracelog.m);
-    for (int i = 0; i < total_processors; i++) {
-        cpuinfo ci = cpuinfo_from_id(i);
-        tracelog_buffer nb = tracelog.disabled ? 0 : allocate_tracelog_buffer_locked();
-        if (nb == INVALID_ADDRESS) {
-            msg_err("failed to allocate tracelog buffer for cpu %d; disabling tracing\n", i);
-            tracelog.disabled = true;
-            nb = 0;
-        }
-
-        tracelog_buffer ob;
-        u64 spins_remain = TRACELOG_COLLATE_SPIN_TIMEOUT;
-        do {
-            ob = ci->tracelog_buffer;
-            while (u64_from_pointer(ob) & TRACELOG_BUFFER_BUSY) {
-                if (spins_remain-- == 0)
-                    goto timeout;
-                kern_pause();
-                ob = ci->tracelog_buffer;
-            }
-        } while (!compare_and_swap_64((u64*)&ci->tracelog_buffer, u64_from_pointer(ob),
-                                      u64_from_pointer(nb)));
-
-        if (ob) {
-            if (buffer_length(&ob->b) > 0)
-                pqueue_insert(pq, ob);
-            else
-                release_tracelog_buffer_locked(ob);
-        }
-        continue;
-      timeout:
-        msg_err("timeout while waiting for busy tracelog buffer on cpu %d\n", i);
-    }
-
-    tracelog_buffer tb;
-    while ((tb = pqueue_pop(pq)) != INVALID_ADDRESS) {
-        buffer b = &tb->b;
-        assert(buffer_length(b) >= TRACELOG_ENTRY_SIZE);
-        tracelog_entry te = buffer_ref(b, 0);
-        buffer_consume(b, TRACELOG_ENTRY_SIZE);
-        list_insert_before(&tracelog.collated_entries, &te->l);
-        if (buffer_length(b) < TRACELOG_ENTRY_SIZE)
-            continue;           /* done with buffer; skipped reserve counts as release */
-        reserve_tracelog_buffer(tb);
-        pqueue_insert(pq, tb);
-    }
+    tracelog_collate_rings_locked();
     if (tracelog.logfile)
         tracelog_file_write(complete);
     else if (complete)
         async_apply_status_handler(complete, STATUS_OK);
     mutex_unlock(tracelog.m);
-    deallocate_pqueue(pq);
 }
 
 define_closure_function(0, 0, void, tracelog_collator)
@@ -490,36 +565,37 @@ define_closure_function(0, 0, void, tracelog_collator)
 
 #define catch_err(s) do {if (!is_ok(s)) msg_err("tracelog: failed to send HTTP response: %v\n", (s));} while(0)
 
-static inline void tracelog_send_http_response(buffer_handler handler, buffer b)
+static inline void tracelog_send_http_response(http_responder handler, buffer b)
 {
     catch_err(send_http_response(handler, timm("ContentType", "text/html"), b));
 }
 
-static inline void tracelog_send_http_simple_result(buffer_handler handler, const char *result)
+static inline void tracelog_send_http_simple_result(http_responder handler, const char *result)
 {
     buffer b = aprintf(tracelog.h, "<html><head><title>%s</title></head>"
                        "<body><h1>%s</h1></body></html>\r\n", result, result);
     tracelog_send_http_response(handler, b);
 }
 
-static inline void tracelog_send_http_chunked_response(buffer_handler handler)
+static inline void tracelog_send_http_chunked_response(http_responder handler, boolean json)
 {
-    catch_err(send_http_chunked_response(handler, timm("ContentType", "text/html")));
+    catch_err(send_http_chunked_response(handler, timm("ContentType", "%s",
+                                                       json ? "application/json" : "text/html")));
 }
 
-static inline void tracelog_send_http_error(buffer_handler handler, const char *status, const char *msg)
+static inline void tracelog_send_http_error(http_responder handler, const char *status, const char *msg)
 {
     buffer b = aprintf(tracelog.h, "<html><head><title>%s %s</title></head>"
                        "<body><h1>%s</h1></body></html>\r\n", status, msg, msg);
     catch_err(send_http_response(handler, timm("status", "%s %s", status, msg), b));
 }
 
-static inline void tracelog_send_http_uri_not_found(buffer_handler handler)
+static inline void tracelog_send_http_uri_not_found(http_responder handler)
 {
     tracelog_send_http_error(handler, "404", "Not Found");
 }
 
-static inline void tracelog_send_http_no_method(buffer_handler handler)
+static inline void tracelog_send_http_no_method(http_responder handler)
 {
     tracelog_send_http_error(handler, "501", "Not Implemented");
 }
@@ -527,24 +603,29 @@ static inline void tracelog_send_http_no_method(buffer_handler handler)
 static void tracelog_clear(void)
 {
     mutex_lock(tracelog.m);
-    list_foreach(&tracelog.collated_entries, l) {
-        tracelog_entry te = struct_from_list(l, tracelog_entry, l);
-        list_delete(l);
-        release_tracelog_buffer_locked(te->tb);
-    }
+    tracelog_collate_rings_locked();
+    buffer_clear(tracelog.collated);
     mutex_unlock(tracelog.m);
 }
 
-static boolean tracelog_do_http_get(buffer_handler out, buffer relative_uri)
+static boolean tracelog_do_http_get(http_responder out, boolean json)
 {
     tracelog_debug("%s\n", __func__);
     buffer b = allocate_buffer(tracelog.h, TRACELOG_HTTP_CHUNK_MAXSIZE);
+    if (json && tracelog.http_json_first) {
+        tracelog_format_json_header(b);
+        tracelog.http_json_first = false;
+    }
     mutex_lock(tracelog.m);
-    tracelog_buffer_fill_locked(b, TRACELOG_HTTP_CHUNK_THRESHOLD);
-    boolean more = !list_empty(&tracelog.collated_entries);
+    tracelog_buffer_fill_locked(b, TRACELOG_HTTP_CHUNK_THRESHOLD, json);
+    boolean more = buffer_length(tracelog.collated) > 0;
     mutex_unlock(tracelog.m);
+    if (!more && json)
+        buffer_write_cstring(b, "\n]\n");
     if (buffer_length(b) > 0)
         send_http_chunk(out, b); /* consumes and frees buffer */
+    else
+        deallocate_buffer(b);
     if (!more)
         send_http_chunk(out, 0);
     return more;
@@ -556,41 +637,47 @@ static inline void schedule_send_http_chunk(void)
 }
 
 define_closure_function(2, 0, void, tracelog_send_http_chunk,
-                        buffer_handler, out, buffer, relative_uri)
+                        http_responder, out, boolean, json)
 {
     tracelog_debug("%s\n", __func__);
-    if (tracelog_do_http_get(bound(out), bound(relative_uri)))
+    if (tracelog_do_http_get(bound(out), bound(json)))
         schedule_send_http_chunk();
 }
 
 closure_function(0, 3, void, tracelog_http_request,
-                 http_method, method, buffer_handler, handler, value, val)
+                 http_method, method, http_responder, handler, value, val)
 {
     string relative_uri = get_string(val, sym(relative_uri));
     tracelog_debug("%s: method %d, handler %p, relative_uri %p\n", __func__,
                    method, handler, relative_uri);
+    boolean json = false;
     switch (method) {
     case HTTP_REQUEST_METHOD_GET:
         if (relative_uri) {
             if (buffer_compare_with_cstring(relative_uri, "enable")) {
-                tracelog.disabled = false;
+                tracelog_set_enabled(true);
                 tracelog_send_http_simple_result(handler, "tracelog enabled");
+                break;
             } else if (buffer_compare_with_cstring(relative_uri, "disable")) {
-                tracelog.disabled = true;
+                tracelog_set_enabled(false);
                 tracelog_send_http_simple_result(handler, "tracelog disabled");
+                break;
             } else if (buffer_compare_with_cstring(relative_uri, "clear")) {
-                tracelog_collate(0);
                 tracelog_clear();
                 tracelog_send_http_simple_result(handler, "tracelog cleared");
+                break;
+            } else if (buffer_compare_with_cstring(relative_uri, "json")) {
+                json = true;
             } else {
                 tracelog_send_http_uri_not_found(handler);
+                break;
             }
-            break;
         }
         tracelog_collate(0);
-        tracelog_send_http_chunked_response(handler);
-        if (tracelog_do_http_get(handler, relative_uri)) {
-            init_closure(&tracelog.send_http_chunk, tracelog_send_http_chunk, handler, relative_uri);
+        tracelog_send_http_chunked_response(handler, json);
+        tracelog.http_json_first = true;
+        if (tracelog_do_http_get(handler, json)) {
+            init_closure(&tracelog.send_http_chunk, tracelog_send_http_chunk, handler, json);
             schedule_send_http_chunk();
         }
         break;
@@ -629,7 +716,7 @@ closure_function(0, 2, void, tracelog_shutdown_handler,
     closure_finish();
 }
 
-static void init_tracelog_file_writer(value v)
+static void init_tracelog_file_writer(value v, boolean json)
 {
     tuple file;
     fsfile fsf;
@@ -640,9 +727,10 @@ static void init_tracelog_file_writer(value v)
     }
     filesystem fs = get_root_fs();
     tuple root = filesystem_getroot(fs);
+    /* a JSON array can't be appended to, so start over */
     fs_status s = filesystem_get_node(&fs, inode_from_tuple(root),
                                       buffer_to_cstring((buffer)v),
-                                      true, true, false, &file, &fsf);
+                                      true, true, false, json, &file, &fsf);
     if (s != FS_STATUS_OK) {
         msg_err("failed to open tracelog file: %s\n", string_from_fs_status(s));
         return;
@@ -651,6 +739,8 @@ static void init_tracelog_file_writer(value v)
     tracelog.logfile = fsf;
     tracelog.fs_write = fsfile_get_writer(tracelog.logfile);
     tracelog.file_offset = fsfile_get_length(tracelog.logfile); /* append */
+    tracelog.file_json = json;
+    tracelog.file_json_first = true;
     add_shutdown_completion(closure(tracelog.h, tracelog_shutdown_handler));
     schedule_collator_timer();
     rprintf("tracelog file opened, offset %ld\n", tracelog.file_offset);
@@ -664,46 +754,60 @@ void init_tracelog_config(tuple root)
         return;
     }
 
+    /* typed tracepoints are selected by name among the trace tags */
+    tracelog.trace_tags = get_tuple(tl, sym(trace_tags));
+    if (tracelog.trace_tags) {
+        tracelog.tracepoint_mask = 0;
+        for (int i = 0; i < TRACEPOINT_MAX; i++) {
+            if (get(tracelog.trace_tags, sym_this(tracepoints[i].name)))
+                tracelog.tracepoint_mask |= U64_FROM_BIT(i);
+        }
+    }
+
     if (get(tl, sym(disable))) {
         /* don't trace on startup */
-        tracelog.disabled = true;
+        tracelog_set_enabled(false);
         rprintf("tracelog disabled on start\n");
+    } else {
+        tracelog_set_enabled(true);
     }
 
-    bytes alloc_size;
-    if (get_u64(tl, sym(alloc_size), &alloc_size))
-        tracelog.alloc_size = alloc_size;
-
-    tracelog.trace_tags = get_tuple(tl, sym(trace_tags));
     value v = get(tl, sym(file));
-    if (v)
-        init_tracelog_file_writer(v);
-    else
+    if (v) {
+        string format = get_string(tl, sym(format));
+        init_tracelog_file_writer(v, format && buffer_compare_with_cstring(format, "json"));
+    } else {
         init_tracelog_http_listener();
+    }
 }
 
 void init_tracelog(heap h)
 {
     tracelog.h = h;
-    tracelog.m = allocate_mutex(h, 0 /* no spinning */);
+    tracelog.m = allocate_mutex_class(h, 0 /* no spinning */, "tracelog");
     assert(tracelog.m != INVALID_ADDRESS);
-    list_init(&tracelog.collated_entries);
-    list_init(&tracelog.free_tracelog_buffers);
-    tracelog.n_free = 0;
-    tracelog.alloc_size = TRACELOG_DEFAULT_BUFFER_SIZE;
+    tracelog.collated = allocate_buffer(h, TRACELOG_DEFAULT_RING_SIZE);
+    assert(tracelog.collated != INVALID_ADDRESS);
+    tracelog.ring_size = TRACELOG_DEFAULT_RING_SIZE;
     tracelog.trace_tags = 0;
+    tracelog.tracepoint_mask = MASK(TRACEPOINT_MAX) & ~U64_FROM_BIT(TRACEPOINT_TEXT);
     init_closure(&tracelog.collator, tracelog_collator);
     tracelog.collator_scheduled = false;
-    tracelog.disabled = false;
     init_closure(&tracelog.collate_timer_func, tracelog_collate_timer_func);
-    
+
+    tracelog.cursors = allocate(h, total_processors * sizeof(struct tracelog_cursor));
+    assert(tracelog.cursors != INVALID_ADDRESS);
     for (int i = 0; i < total_processors; i++) {
-        tracelog_buffer b = allocate_tracelog_buffer_locked(); /* don't need lock here */
-        assert(b != INVALID_ADDRESS);
+        tracelog_ring r = allocate_zero(h, sizeof(*r));
+        assert(r != INVALID_ADDRESS);
+        r->words = allocate(h, tracelog.ring_size);
+        assert(r->words != INVALID_ADDRESS);
+        r->mask = tracelog.ring_size / sizeof(u64) - 1;
         cpuinfo ci = cpuinfo_from_id(i);
-        ci->tracelog_buffer = b;
+        ci->tracelog_ring = r;
     }
     tracelog.logfile = 0;
     tracelog.fs_write = 0;
     tracelog.file_offset = 0;
+    tracelog_set_enabled(true);
 }
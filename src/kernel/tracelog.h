@@ -2,3 +2,38 @@ void tprintf(symbol tag, tuple attrs, const char *format, ...);
 void vtprintf(symbol tag, tuple attrs, const char *format, vlist *ap);
 void init_tracelog_config(tuple root);
 void init_tracelog(heap h);
+
+/* Typed tracepoints record an event id and up to TRACEPOINT_MAX_ARGS raw
+   arguments; formatting is deferred until the log is read. See the
+   tracepoints[] table in tracelog.c for the argument layout of each event. */
+enum tracepoint_id {
+    TRACEPOINT_TEXT,            /* tprintf() */
+    TRACEPOINT_SYSCALL,
+    TRACEPOINT_PAGE_FAULT,
+    TRACEPOINT_STORAGE_REQ,
+    TRACEPOINT_MAX
+};
+
+#define TRACEPOINT_INSTANT  0
+#define TRACEPOINT_BEGIN    1
+#define TRACEPOINT_END      2
+
+#define TRACEPOINT_MAX_ARGS 6
+
+extern u64 tracepoint_mask;
+
+void tracepoint_record(int id, int ph, u64 *args, int nargs);
+
+#define tracepoint_enabled(id)  (tracepoint_mask & U64_FROM_BIT(id))
+
+#define tracepoint(id, ph, ...) do {                                    \
+        if (tracepoint_enabled(id)) {                                   \
+            u64 __tp_args[] = {__VA_ARGS__};                            \
+            build_assert(sizeof(__tp_args) <= TRACEPOINT_MAX_ARGS * sizeof(u64)); \
+            tracepoint_record(id, ph, __tp_args, sizeof(__tp_args) / sizeof(u64)); \
+        }                                                               \
+    } while (0)
+
+#define tracepoint_instant(id, ...) tracepoint(id, TRACEPOINT_INSTANT, __VA_ARGS__)
+#define tracepoint_begin(id, ...)   tracepoint(id, TRACEPOINT_BEGIN, __VA_ARGS__)
+#define tracepoint_end(id, ...)     tracepoint(id, TRACEPOINT_END, __VA_ARGS__)
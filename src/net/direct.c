@@ -23,6 +23,7 @@ typedef struct direct {
 } *direct;
 
 #define DIRECT_CONN_RECEIVE_QUEUE_SIZE 1024
+#define DIRECT_CONN_WND 0x34000
 
 declare_closure_struct(1, 1, status, direct_conn_send,
                        struct direct_conn *, dc,
@@ -34,6 +35,7 @@ typedef struct direct_conn {
     struct list l;              /* direct list */
     struct tcp_pcb *p;
     struct list sendq_head;
+    struct list unacked_head;   /* written qbufs awaiting acknowledgement */
     closure_struct(direct_conn_send, send_bh);
     input_buffer_handler receive_bh;
     queue receive_queue;
@@ -44,6 +46,7 @@ typedef struct direct_conn {
 typedef struct qbuf {
     struct list l;
     buffer b;
+    u32 seq_end;                /* sequence number following the buffer data */
 } *qbuf;
 
 static boolean direct_conn_closed(direct_conn dc);
@@ -135,11 +138,26 @@ static void direct_dealloc(direct d)
     deallocate(d->h, d, sizeof(struct direct));
 }
 
+/* lwIP locked on entry */
+static void direct_conn_release_acked(direct_conn dc, boolean all)
+{
+    list_foreach(&dc->unacked_head, l) {
+        qbuf q = struct_from_list(l, qbuf, l);
+        if (!all && (s32)(dc->p->lastack - q->seq_end) < 0)
+            break;
+        list_delete(&q->l);
+        deallocate_buffer(q->b);
+        deallocate(dc->d->h, q, sizeof(struct qbuf));
+    }
+}
+
 /* lwIP locked on entry */
 static boolean direct_conn_closed(direct_conn dc)
 {
     if (dc->receive_bh)
         apply(dc->receive_bh, 0);
+    /* lwIP no longer references any data at this point */
+    direct_conn_release_acked(dc, true);
     direct d = dc->d;
     boolean client = (dc->p == d->p);
     tcp_unref(dc->p);
@@ -169,6 +187,12 @@ static void direct_conn_send_internal(direct_conn dc, qbuf q, boolean lwip_locke
     while ((next = list_get_next(&dc->sendq_head))) {
         qbuf q = struct_from_list(next, qbuf, l);
         if (!q->b) {
+            /* Data still referenced by lwIP must be acknowledged before
+               the connection and its buffers go away; this is retried
+               from the sent callback. */
+            if (!list_empty(&dc->unacked_head))
+                break;
+
             /* close connection - should check error, but would need status handler... */
             direct_debug("connection close by sender\n");
             tcp_arg(dc->p, 0);
@@ -188,9 +212,12 @@ static void direct_conn_send_internal(direct_conn dc, qbuf q, boolean lwip_locke
 
         int write_len = MIN(avail, buffer_length(q->b));
         /* Fix interface: can send with PSH flag clear
-           (TCP_WRITE_FLAG_MORE) if we know more data is on the way... */
+           (TCP_WRITE_FLAG_MORE) if we know more data is on the way...
+
+           The buffer is referenced rather than copied; it is kept on the
+           unacked list until its data has been acknowledged. */
         direct_debug("write %p, len %d\n", buffer_ref(q->b, 0), write_len);
-        err_t err = tcp_write(dc->p, buffer_ref(q->b, 0), write_len, TCP_WRITE_FLAG_COPY);
+        err_t err = tcp_write(dc->p, buffer_ref(q->b, 0), write_len, 0);
         if (err == ERR_MEM)
             break;
 
@@ -203,12 +230,12 @@ static void direct_conn_send_internal(direct_conn dc, qbuf q, boolean lwip_locke
         buffer_consume(q->b, write_len);
         direct_debug("remaining %d\n", buffer_length(q->b));
 
-        /* pop off qbuf if work finished, else loop around to attempt to send more */
-        if (!q->b || buffer_length(q->b) == 0) {
-            if (q->b)
-                deallocate_buffer(q->b);
+        /* move qbuf to the unacked list if work finished, else loop around
+           to attempt to send more */
+        if (buffer_length(q->b) == 0) {
+            q->seq_end = dc->p->snd_lbb;
             list_delete(&q->l);
-            deallocate(dc->d->h, q, sizeof(struct qbuf));
+            list_insert_before(&dc->unacked_head, &q->l);
         }
     }
     if (dc) {
@@ -221,7 +248,11 @@ static void direct_conn_send_internal(direct_conn dc, qbuf q, boolean lwip_locke
 static err_t direct_conn_sent(void *arg, struct tcp_pcb *pcb, u16 len)
 {
     assert(arg);
-    direct_conn_send_internal((direct_conn)arg, 0, true);
+    direct_conn dc = arg;
+    spin_lock(&dc->send_lock);
+    direct_conn_release_acked(dc, false);
+    spin_unlock(&dc->send_lock);
+    direct_conn_send_internal(dc, 0, true);
     return ERR_OK;
 }
 
@@ -285,12 +316,25 @@ static direct_conn direct_conn_alloc(direct d, struct tcp_pcb *pcb)
     dc->d = d;
     dc->p = pcb;
     list_init(&dc->sendq_head);
+    list_init(&dc->unacked_head);
     init_closure(&dc->send_bh, direct_conn_send, dc);
     dc->receive_bh = 0;
     dc->receive_queue = allocate_queue(d->h, DIRECT_CONN_RECEIVE_QUEUE_SIZE);
     if (dc->receive_queue == INVALID_ADDRESS)
         goto fail_dealloc;
     dc->pending_err = ERR_OK;
+
+    /* TCP_WND only bounds the socket receive buffers; keep the window of
+       these connections at the default size, by never returning to lwIP the
+       part of the window beyond it */
+    u32 wnd_max = TCP_WND_MAX(pcb);
+    if (wnd_max > DIRECT_CONN_WND) {
+        pcb->rcv_wnd -= MIN(wnd_max - DIRECT_CONN_WND, pcb->rcv_wnd);
+        if (pcb->rcv_ann_wnd > pcb->rcv_wnd) {
+            pcb->rcv_ann_wnd = pcb->rcv_wnd;
+            pcb->rcv_ann_right_edge = pcb->rcv_nxt + pcb->rcv_wnd;
+        }
+    }
     tcp_ref(pcb);
     tcp_arg(pcb, dc);
     tcp_err(pcb, direct_conn_err);
@@ -57,17 +57,20 @@
 #define LWIP_PBUF_REF_T u32_t
 
 #define LWIP_CHKSUM_ALGORITHM   3
+#define LWIP_CHECKSUM_CTRL_PER_NETIF    1   /* drivers can skip checks done by the device */
 
 #define LWIP_WND_SCALE 1
 #define TCP_MSS 1460            /* Assuming ethernet; may want to derive this */
-#define TCP_WND 0x34000         /* For maximum throughput should be the same as TCP_SND_BUF */
-#define TCP_SND_BUF 0x34000     /* Same as /proc/sys/net/core/wmem_default on Linux */
+/* Upper bounds of the receive window and send buffer; the per-socket sizes
+   (SO_RCVBUF, SO_SNDBUF and autotuning) are enforced in netsyscall.c */
+#define TCP_WND 0x600000        /* Same as the tcp_rmem maximum on Linux */
+#define TCP_SND_BUF 0x400000    /* Same as the tcp_wmem maximum on Linux */
 #define TCP_SNDLOWAT (0xFFFE - (4 * TCP_MSS))   /* Unused, but needed to pass lwIP sanity checks */
 #define TCP_SND_QUEUELEN TCP_SNDQUEUELEN_OVERFLOW
 #define TCP_OVERSIZE TCP_MSS
 #define TCP_QUEUE_OOSEQ 1
 
-#define TCP_RCV_SCALE 2         /* (0xFFFFU << TCP_RCV_SCALE) must be greater than TCP_WND */
+#define TCP_RCV_SCALE 7         /* (0xFFFFU << TCP_RCV_SCALE) must be greater than TCP_WND */
 #define TCP_LISTEN_BACKLOG 1
 #define LWIP_DHCP 1
 // would prefer to set this dynamically...also,
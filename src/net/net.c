@@ -1,4 +1,5 @@
 #include <kernel.h>
+#include <net.h>
 #include <lwip.h>
 #include <lwip/priv/tcp_priv.h>
 
@@ -10,7 +11,14 @@
 #define IFF_NOARP       (1 << 7)
 #define IFF_MULTICAST   (1 << 12)
 
+/* Small lwIP objects (pbuf headers, tcp_seg, udp_pcb, tcp_pcb...) are
+   served from per-cpu magazines in front of the mcache. */
+#define LWIP_POOL_MIN_ORDER     5
+#define LWIP_POOL_MAX_ORDER     10
+#define LWIP_POOL_DEFAULT_SIZE  64
+
 BSS_RO_AFTER_INIT static heap lwip_heap;
+BSS_RO_AFTER_INIT static caching_heap lwip_pools;
 BSS_RO_AFTER_INIT int (*net_ip_input_filter)(struct pbuf *pbuf, struct netif *input_netif);
 
 declare_closure_struct(0, 2, void, net_timeout_handler, u64, expiry, u64, overruns);
@@ -218,6 +226,60 @@ void netif_name_cpy(char *dest, struct netif *netif)
     dest[sizeof(netif->name) + 1] = '\0';
 }
 
+static struct net_rx_stats rx_stats;
+
+void net_rx_account(net_rx_stats s)
+{
+    fetch_and_add(&rx_stats.frames, s->frames);
+    fetch_and_add(&rx_stats.bytes, s->bytes);
+    fetch_and_add(&rx_stats.inputs, s->inputs);
+    fetch_and_add(&rx_stats.coalesced, s->coalesced);
+    fetch_and_add(&rx_stats.interrupts, s->interrupts);
+    fetch_and_add(&rx_stats.polls, s->polls);
+}
+
+void net_rx_get_stats(net_rx_stats s)
+{
+    runtime_memcpy(s, &rx_stats, sizeof(*s));
+}
+
+#define NETIF_MAX_INDEX 256
+
+/* busy-poll handlers, by interface index */
+static netif_busy_poll_handler busy_poll_handlers[NETIF_MAX_INDEX];
+
+void netif_set_busy_poll(struct netif *n, netif_busy_poll_handler h)
+{
+    busy_poll_handlers[netif_get_index(n)] = h;
+}
+
+/* Poll the interface with the given index, or all interfaces that support
+   busy polling, splitting the budget among them, if the index is unknown. */
+boolean net_busy_poll(u8 if_idx, timestamp budget, busy_poll_cond cond)
+{
+    timestamp t = now(CLOCK_ID_MONOTONIC_RAW);
+    if (if_idx != NETIF_NO_INDEX) {
+        netif_busy_poll_handler h = busy_poll_handlers[if_idx];
+        return h ? apply(h, t + budget, cond) : false;
+    }
+    int count = 0;
+    for (int i = 1; i < NETIF_MAX_INDEX; i++)
+        if (busy_poll_handlers[i])
+            count++;
+    if (count == 0)
+        return false;
+    budget /= count;
+    for (int i = 1; i < NETIF_MAX_INDEX; i++) {
+        netif_busy_poll_handler h = busy_poll_handlers[i];
+        if (h) {
+            t += budget;
+            if (apply(h, t, cond))
+                return true;
+        }
+    }
+    return false;
+}
+
 #define MAX_ADDR_LEN 20
 
 #define MAX_IP6_ADDR_LEN    39
@@ -309,11 +371,37 @@ void ip4_when_ready(status_handler complete, timestamp timeout)
     check_netif_ready(0);
 }
 
+closure_function(0, 1, u64, lwip_mem_cleaner,
+                 u64, clean_bytes)
+{
+    return cache_drain(lwip_pools, clean_bytes, 0);
+}
+
+/* Per-cpu magazines can only be sized once all cpus are counted. */
+static void init_lwip_pools(tuple root, boolean trace)
+{
+    u64 size = LWIP_POOL_DEFAULT_SIZE;
+    get_u64(root, sym(lwip_pool_size), &size);
+    if (size == 0 || size > U64_FROM_BIT(16)) {
+        if (trace)
+            rprintf("NET: per-cpu lwIP pools disabled\n");
+    } else if (!percpu_cache_enable(lwip_pools, size)) {
+        msg_err("failed to enable per-cpu lwIP pools\n");
+    } else {
+        mm_register_mem_cleaner(closure(heap_locked(get_kernel_heaps()), lwip_mem_cleaner));
+    }
+    tuple heaps = get_tuple(root, sym(heaps));
+    if (heaps)
+        set(heaps, sym(lwip), heap_management(lwip_heap));
+}
+
 void init_network_iface(tuple root) {
     struct netif *n;
     struct netif *default_iface = 0;
     boolean trace = !!(trace_get_flags(get(root, sym(trace))) & TRACE_OTHER);
 
+    init_lwip_pools(root, trace);
+
     /* NETIF_FOREACH traverses interfaces in reverse order...so go by index */
     for (int i = 1; (n = netif_get_by_index(i)); i++) {
         if (netif_is_loopback(n)) {
@@ -390,9 +478,13 @@ void init_net(kernel_heaps kh)
     heap backed = (heap)heap_linear_backed(kh);
     bytes pagesize = is_low_memory_machine(kh) ?
                      U64_FROM_BIT(MAX_LWIP_ALLOC_ORDER + 1) : PAGESIZE_2M;
-    lwip_heap = allocate_mcache(h, backed, 5, MAX_LWIP_ALLOC_ORDER, pagesize);
+    lwip_heap = allocate_mcache(h, backed, LWIP_POOL_MIN_ORDER, MAX_LWIP_ALLOC_ORDER, pagesize);
     assert(lwip_heap != INVALID_ADDRESS);
-    lwip_heap = locking_heap_wrapper(h, lwip_heap);
+    /* the per-cpu cache serializes access to the mcache */
+    lwip_pools = percpu_cache_wrapper(heap_locked(kh), lwip_heap, pagesize,
+                                      LWIP_POOL_MIN_ORDER, LWIP_POOL_MAX_ORDER);
+    assert(lwip_pools != INVALID_ADDRESS);
+    lwip_heap = heapprof_wrapper(h, (heap)lwip_pools, "lwip");
     assert(lwip_heap != INVALID_ADDRESS);
     init_timer(&net.timeout);
     lwip_init();
@@ -5,3 +5,31 @@ void init_net(kernel_heaps kh);
 void init_network_iface(tuple root);
 void ip4_when_ready(status_handler complete, timestamp timeout);
 status listen_port(heap h, u16 port, connection_handler c);
+
+/* receive path counters, as accounted by network drivers */
+typedef struct net_rx_stats {
+    u64 frames;         /* frames taken from devices */
+    u64 bytes;
+    u64 inputs;         /* frames handed to the stack */
+    u64 coalesced;      /* frames merged into a preceding one before input */
+    u64 interrupts;     /* receive interrupts */
+    u64 polls;          /* passes over receive queues, from interrupts or busy polling */
+} *net_rx_stats;
+void net_rx_account(net_rx_stats s);
+void net_rx_get_stats(net_rx_stats s);
+
+/* Busy polling: a thread about to block for network input may instead poll
+   the receiving interface for up to a given time (as with Linux
+   SO_BUSY_POLL). Drivers that can process received frames synchronously
+   register a handler, which polls until the condition is met or the
+   deadline passes and returns the last value of the condition. */
+typedef closure_type(busy_poll_cond, boolean);
+typedef closure_type(netif_busy_poll_handler, boolean, timestamp /* deadline */, busy_poll_cond);
+struct netif;
+void netif_set_busy_poll(struct netif *n, netif_busy_poll_handler h);
+boolean net_busy_poll(u8 if_idx, timestamp budget, busy_poll_cond cond);
+
+/* default busy-poll budgets, in microseconds: for socket reads (busy_read in
+   the manifest) and for poll, select and epoll_wait (busy_poll) */
+extern u32 busy_read_usecs;
+extern u32 busy_poll_usecs;
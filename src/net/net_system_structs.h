@@ -40,14 +40,17 @@ enum protocol_type {
 #define MSG_OOB         0x00000001
 #define MSG_PEEK        0x00000002
 #define MSG_DONTROUTE   0x00000004
+#define MSG_CTRUNC      0x00000008
 #define MSG_PROBE       0x00000010
 #define MSG_TRUNC       0x00000020
 #define MSG_DONTWAIT    0x00000040
 #define MSG_EOR         0x00000080
 #define MSG_CONFIRM     0x00000800
+#define MSG_ERRQUEUE    0x00002000
 #define MSG_NOSIGNAL    0x00004000
 #define MSG_MORE        0x00008000
 #define MSG_WAITFORONE  0x00010000
+#define MSG_ZEROCOPY    0x04000000
 
 // tuplify
 #define SOCK_NONBLOCK 00004000
@@ -80,6 +83,11 @@ enum protocol_type {
 #define TCP_SAVE_SYN		27	/* Record SYN headers for new connections */
 #define TCP_SAVED_SYN		28	/* Get SYN headers recorded for connection */
 
+#define UDP_SEGMENT	103	/* Set GSO segmentation size */
+#define UDP_GRO		104	/* This socket can receive UDP GRO packets */
+
+#define UDP_MAX_SEGMENTS	128	/* max datagrams per UDP_SEGMENT send */
+
 #define SHUT_RD   0
 #define SHUT_WR   1
 #define SHUT_RDWR 2
@@ -58,11 +58,6 @@ struct sockaddr_in6 {
     u32 sin6_scope_id;
 };
 
-struct mmsghdr {
-    struct msghdr msg_hdr;
-    unsigned int msg_len;
-};
-
 struct ifconf {
     int ifc_len;
     union {
@@ -103,15 +98,38 @@ typedef struct netsock {
     queue incoming;
     err_t lwip_error;             /* lwIP error code; ERR_OK if normal */
     u8 ipv6only:1;
+    u8 rcvbuf_lock:1;             /* buffer sizes set by the application, */
+    u8 sndbuf_lock:1;             /* and thus not subject to autotuning */
+    u8 rx_if_idx;                 /* interface of the last received data */
+    u32 busy_poll;                /* SO_BUSY_POLL, in microseconds */
+    u32 rcvbuf;                   /* SO_RCVBUF */
+    u32 sndbuf;                   /* SO_SNDBUF */
     union {
 	struct {
 	    struct tcp_pcb *lw;
 	    tcpflags_t flags;
 	    enum tcp_socket_state state; // half open?
+	    struct list zc_pending;     /* netsock_zc_ref, in sequence order */
+	    u32 zc_next_id;             /* next MSG_ZEROCOPY notification id */
+	    u32 zc_lo, zc_hi;           /* completed ids not yet reported */
+	    u8 zerocopy:1;              /* SO_ZEROCOPY */
+	    u8 zc_notify:1;             /* zc_lo and zc_hi are valid */
+	    u8 zc_copied:1;             /* some of the data was copied */
+	    boolean snd_limited;        /* a write was limited by sndbuf */
+	    u32 rcv_withheld;           /* window space not returned to lwIP */
+	    u32 rcv_rtt_seq;            /* sequence number ending the timed window */
+	    timestamp rcv_rtt_start;    /* start of the timed window, or 0 */
+	    timestamp rcv_rtt;          /* receiver-side RTT estimate, or 0 */
+	    timestamp rcv_space_start;  /* start of the current autotuning period */
+	    u32 rcv_space_copied;       /* data read by the application in it */
+	    u32 rcvbuf_tuned;           /* autotuned growth of rcvbuf and sndbuf, */
+	    u32 sndbuf_tuned;           /* charged to tcp_autotune_used */
 	} tcp;
 	struct {
 	    struct udp_pcb *lw;
 	    enum udp_socket_state state;
+	    u16 gso_size;               /* UDP_SEGMENT */
+	    u8 gro:1;                   /* UDP_GRO */
 	} udp;
     } info;
 } *netsock;
@@ -119,9 +137,35 @@ typedef struct netsock {
 #define netsock_lock(s)     spin_lock(&(s)->sock.f.lock)
 #define netsock_unlock(s)   spin_unlock(&(s)->sock.f.lock)
 
+/* Data handed to lwIP by reference (MSG_ZEROCOPY sends, and sg_write
+   buffers that hold a reference to their source) must remain valid until
+   it is acknowledged. Each zc_ref records the sequence number following
+   its data; pending refs are accessed with the pcb locked. */
+typedef struct netsock_zc_ref {
+    struct list l;
+    u32 seq_end;
+    refcount r;                 /* released once acked, if set */
+    buffer pins;                /* pinned user memory (ranges), if set */
+    u32 id;                     /* MSG_ZEROCOPY notification id */
+    u8 notify:1;
+    u8 copied:1;
+} *netsock_zc_ref;
+
+/* takes over the pending refs of a socket that let go of its pcb */
+typedef struct netsock_zc_orphan {
+    heap h;
+    struct list pending;
+} *netsock_zc_orphan;
+
 #define DEFAULT_SO_RCVBUF   0x34000 /* same as Linux */
+#define DEFAULT_SO_SNDBUF   0x34000
+#define NETSOCK_MIN_BUF     (2 * TCP_MSS)
 
 int so_rcvbuf;
+u64 tcp_autotune_limit;         /* total growth of buffers allowed by autotuning */
+static u64 tcp_autotune_used;
+u32 busy_read_usecs;
+u32 busy_poll_usecs;
 
 static sysreturn netsock_bind(struct sock *sock, struct sockaddr *addr,
         socklen_t addrlen);
@@ -143,6 +187,10 @@ static sysreturn netsock_sendmsg(struct sock *sock, const struct msghdr *msg,
                                  int flags, boolean in_bh, io_completion completion);
 static sysreturn netsock_recvmsg(struct sock *sock, struct msghdr *msg,
                                  int flags, boolean in_bh, io_completion completion);
+static sysreturn netsock_sendmmsg(struct sock *sock, struct mmsghdr *msgvec, unsigned int vlen,
+                                  int flags);
+static sysreturn netsock_recvmmsg(struct sock *sock, struct mmsghdr *msgvec, unsigned int vlen,
+                                  int flags);
 
 BSS_RO_AFTER_INIT static thunk net_loop_poll;
 static boolean net_loop_poll_queued;
@@ -169,6 +217,15 @@ static netsock get_netsock(struct sock *sock)
     return (netsock)sock;
 }
 
+/* lwIP accounts for the send buffer against the global maximum
+   (TCP_SND_BUF), so the socket limit is applied to the data written and
+   not yet acknowledged. */
+static u64 netsock_tcp_sndbuf(netsock s, struct tcp_pcb *lw)
+{
+    u32 queued = lw->snd_lbb - lw->lastack;
+    return (queued < s->sndbuf) ? MIN(tcp_sndbuf(lw), s->sndbuf - queued) : 0;
+}
+
 static u32 netsock_events_locked(netsock s)
 {
     boolean in = !queue_empty(s->incoming);
@@ -184,7 +241,7 @@ static u32 netsock_events_locked(netsock s)
                as is the TCP sendbuf size read. */
             rv = (in ? EPOLLIN | EPOLLRDNORM : 0) |
                 (s->info.tcp.lw->state == ESTABLISHED ?
-                 (tcp_sndbuf(s->info.tcp.lw) ? EPOLLOUT | EPOLLWRNORM : 0) :
+                 (netsock_tcp_sndbuf(s, s->info.tcp.lw) ? EPOLLOUT | EPOLLWRNORM : 0) :
                  EPOLLIN | EPOLLOUT);
             break;
         case TCP_SOCK_UNDEFINED:
@@ -196,6 +253,8 @@ static u32 netsock_events_locked(netsock s)
         default:
             rv = 0;
         }
+        if (s->info.tcp.zc_notify)
+            rv |= EPOLLERR;     /* error queue not empty */
     } else {
         assert(s->sock.type == SOCK_DGRAM);
         rv = (in ? EPOLLIN | EPOLLRDNORM : 0) | EPOLLOUT | EPOLLWRNORM;
@@ -383,6 +442,306 @@ static void netsock_tcp_put(struct tcp_pcb * tcp_lw)
     tcp_unref(tcp_lw);
 }
 
+/* Release refs whose data has been acknowledged (or all of them, once lwIP
+   no longer holds any data), in order, and return the range of
+   notification ids completed. Called with the pcb locked. */
+static boolean netsock_zc_release(heap h, struct list *pending, struct tcp_pcb *lw, boolean all,
+                                  u32 *lo, u32 *hi, boolean *copied)
+{
+    boolean notify = false;
+    list_foreach(pending, l) {
+        netsock_zc_ref zr = struct_from_list(l, netsock_zc_ref, l);
+        if (!all && (s32)(lw->lastack - zr->seq_end) < 0)
+            break;
+        list_delete(l);
+        if (zr->r)
+            refcount_release(zr->r);
+        if (zr->pins) {
+            range *r = buffer_ref(zr->pins, 0);
+            for (u64 i = 0; i < buffer_length(zr->pins) / sizeof(*r); i++)
+                unpin_user_pages(r[i].start, range_span(r[i]));
+            deallocate_buffer(zr->pins);
+        }
+        if (zr->notify) {
+            if (!notify) {
+                *lo = zr->id;
+                notify = true;
+            }
+            *hi = zr->id;
+            if (zr->copied)
+                *copied = true;
+        }
+        deallocate(h, zr, sizeof(*zr));
+    }
+    return notify;
+}
+
+/* Completions arrive in order, so the notifications awaiting a read of the
+   error queue always form a single range. Called with netsock lock held. */
+static void netsock_zc_notify(netsock s, u32 lo, u32 hi, boolean copied)
+{
+    if (!s->info.tcp.zc_notify) {
+        s->info.tcp.zc_lo = lo;
+        s->info.tcp.zc_copied = 0;
+        s->info.tcp.zc_notify = 1;
+    }
+    s->info.tcp.zc_hi = hi;
+    if (copied)
+        s->info.tcp.zc_copied = 1;
+}
+
+static void netsock_zc_complete(netsock s, struct tcp_pcb *lw, boolean all)
+{
+    u32 lo, hi;
+    boolean copied = false;
+    if (list_empty(&s->info.tcp.zc_pending) ||
+        !netsock_zc_release(s->sock.h, &s->info.tcp.zc_pending, lw, all, &lo, &hi, &copied))
+        return;
+    netsock_lock(s);
+    netsock_zc_notify(s, lo, hi, copied);
+    netsock_unlock(s);
+}
+
+static boolean netsock_zc_idle(struct tcp_pcb *lw)
+{
+    return (lw->state == CLOSED) || (!lw->unsent && !lw->unacked);
+}
+
+static err_t netsock_zc_orphan_sent(void *arg, struct tcp_pcb *pcb, u16 len)
+{
+    netsock_zc_orphan o = arg;
+    if (!o)
+        return ERR_OK;
+    u32 lo, hi;
+    boolean copied;
+    netsock_zc_release(o->h, &o->pending, pcb, false, &lo, &hi, &copied);
+    if (list_empty(&o->pending)) {
+        tcp_arg(pcb, 0);
+        deallocate(o->h, o, sizeof(*o));
+    }
+    return ERR_OK;
+}
+
+static void netsock_zc_orphan_err(void *arg, err_t err)
+{
+    netsock_zc_orphan o = arg;
+    if (!o)
+        return;
+    u32 lo, hi;
+    boolean copied;
+    netsock_zc_release(o->h, &o->pending, 0, true, &lo, &hi, &copied);
+    deallocate(o->h, o, sizeof(*o));
+}
+
+/* The socket is letting go of its pcb (which must be locked): refs to data
+   that lwIP may still transmit are handed over to an orphan that releases
+   them as the data is acknowledged. */
+static void netsock_zc_detach(netsock s, struct tcp_pcb *lw)
+{
+    struct list *pending = &s->info.tcp.zc_pending;
+    if (list_empty(pending))
+        return;
+    u32 lo, hi;
+    boolean copied;
+    netsock_zc_release(s->sock.h, pending, lw, netsock_zc_idle(lw), &lo, &hi, &copied);
+    if (list_empty(pending))
+        return;
+    netsock_zc_orphan o = allocate(s->sock.h, sizeof(*o));
+    if (o == INVALID_ADDRESS) {
+        /* the data cannot be tracked any longer, so it must not be sent */
+        msg_err("failed to allocate orphan; aborting connection\n");
+        tcp_arg(lw, 0);
+        tcp_abort(lw);
+        netsock_zc_release(s->sock.h, pending, 0, true, &lo, &hi, &copied);
+        return;
+    }
+    o->h = s->sock.h;
+    list_move(&o->pending, pending);
+    tcp_arg(lw, o);
+    tcp_recv(lw, 0);
+    tcp_sent(lw, netsock_zc_orphan_sent);
+    tcp_err(lw, netsock_zc_orphan_err);
+}
+
+/* Pin the anonymous memory backing a zero-copy send, so that the pages
+   cannot be reused if the memory is unmapped before the data is
+   acknowledged, and record the pinned run in the zc_ref. Memory that is not
+   currently mapped is not faulted in here (the pcb lock is held), nor is
+   file-backed memory referenced; it is copied instead. Returns the length
+   of the physically contiguous run pinned at buf, or 0. */
+static u64 netsock_zc_pin(heap h, netsock_zc_ref zr, void *buf, u64 len, u64 *phys)
+{
+    if (!zr->pins) {
+        zr->pins = allocate_buffer(h, 4 * sizeof(range));
+        if (zr->pins == INVALID_ADDRESS) {
+            zr->pins = 0;
+            return 0;
+        }
+    }
+    u64 n = pin_user_pages(current->p, u64_from_pointer(buf), len, phys);
+    if (n == 0)
+        return 0;
+    range r = irangel(*phys, n);
+    if (!buffer_write(zr->pins, &r, sizeof(r))) {
+        unpin_user_pages(*phys, n);
+        return 0;
+    }
+    return n;
+}
+
+/* tcp_write() of user memory by reference; *written is set to the number
+   of bytes queued even if an error is returned. */
+static err_t netsock_tcp_write_zc(heap h, netsock_zc_ref zr, struct tcp_pcb *lw, void *buf,
+                                  u64 len, u8 apiflags, u64 *written, boolean *copied)
+{
+    err_t err = ERR_OK;
+    *written = 0;
+    while (*written < len) {
+        void *p = buf + *written;
+        u64 remain = len - *written;
+        u64 phys;
+        u64 n = netsock_zc_pin(h, zr, p, remain, &phys);
+        u8 flags = apiflags;
+        if (n == 0) {
+            n = MIN(remain, PAGESIZE - (u64_from_pointer(p) & PAGEMASK));
+            flags |= TCP_WRITE_FLAG_COPY;
+            *copied = true;
+        } else {
+            p = pointer_from_u64(virt_from_linear_backed_phys(phys));
+        }
+        if (n < remain)
+            flags |= TCP_WRITE_FLAG_MORE;
+        err = tcp_write(lw, p, n, flags);
+        if (err != ERR_OK) {
+            if (!(flags & TCP_WRITE_FLAG_COPY)) {
+                unpin_user_pages(phys, n);
+                zr->pins->end -= sizeof(range);
+            }
+            break;
+        }
+        *written += n;
+    }
+    return err;
+}
+
+/* Buffer growth by autotuning is charged against a global limit, so that
+   many connections cannot pin down an unbounded amount of memory. */
+static boolean netsock_autotune_charge(u32 *tuned, u64 delta)
+{
+    u64 used = fetch_and_add(&tcp_autotune_used, delta);
+    if (used + delta > tcp_autotune_limit) {
+        fetch_and_add(&tcp_autotune_used, -delta);
+        return false;
+    }
+    *tuned += delta;
+    return true;
+}
+
+static void netsock_autotune_release(u32 *tuned)
+{
+    if (*tuned) {
+        fetch_and_add(&tcp_autotune_used, -(u64)*tuned);
+        *tuned = 0;
+    }
+}
+
+/* lwIP opens the window up to the global maximum (TCP_WND); the part of
+   it beyond the socket receive buffer is withheld by not passing all
+   consumed data to tcp_recved(). Called with the pcb locked, once the
+   connection is established. */
+static void netsock_tcp_rcv_init(netsock s, struct tcp_pcb *lw)
+{
+    u32 max = TCP_WND_MAX(lw);
+    u32 take = MIN(max - MIN(s->rcvbuf, max), lw->rcv_wnd);
+    lw->rcv_wnd -= take;
+    if (lw->rcv_ann_wnd > lw->rcv_wnd) {
+        /* only the unscaled window of the SYN has actually been announced */
+        lw->rcv_ann_wnd = lw->rcv_wnd;
+        lw->rcv_ann_right_edge = lw->rcv_nxt + lw->rcv_wnd;
+    }
+    s->info.tcp.rcv_withheld = take;
+}
+
+/* Receiver-side RTT estimate, as in Linux: time the reception of a full
+   window. This bounds the RTT from above, so the lowest sample is kept.
+   Called with the netsock lock held. */
+static void netsock_tcp_rcv_rtt(netsock s, struct tcp_pcb *lw)
+{
+    timestamp t = now(CLOCK_ID_MONOTONIC_RAW);
+    if (s->info.tcp.rcv_rtt_start) {
+        if ((s32)(lw->rcv_nxt - s->info.tcp.rcv_rtt_seq) < 0)
+            return;
+        timestamp sample = t - s->info.tcp.rcv_rtt_start;
+        if (!s->info.tcp.rcv_rtt || sample < s->info.tcp.rcv_rtt)
+            s->info.tcp.rcv_rtt = sample;
+    }
+    s->info.tcp.rcv_rtt_seq = lw->rcv_nxt + lw->rcv_wnd;
+    s->info.tcp.rcv_rtt_start = t;
+}
+
+/* Dynamic right-sizing of the receive buffer: once per RTT, if the
+   application read more than half of the buffer, grow it to twice the
+   amount read, so that the window stays ahead of the sender. */
+static void netsock_tcp_rcv_autotune(netsock s, struct tcp_pcb *lw, u64 len)
+{
+    if (s->rcvbuf_lock || !s->info.tcp.rcv_rtt)
+        return;
+    timestamp t = now(CLOCK_ID_MONOTONIC_RAW);
+    s->info.tcp.rcv_space_copied += len;
+    if (!s->info.tcp.rcv_space_start) {
+        s->info.tcp.rcv_space_start = t;
+        return;
+    }
+    if (t - s->info.tcp.rcv_space_start < s->info.tcp.rcv_rtt)
+        return;
+    u64 target = MIN(2 * (u64)s->info.tcp.rcv_space_copied, TCP_WND_MAX(lw));
+    if (target > s->rcvbuf &&
+        netsock_autotune_charge(&s->info.tcp.rcvbuf_tuned, target - s->rcvbuf)) {
+        net_debug("sock %d, rcvbuf %d -> %ld, rtt %T\n", s->sock.fd, s->rcvbuf, target,
+                  s->info.tcp.rcv_rtt);
+        s->rcvbuf = target;
+    }
+    s->info.tcp.rcv_space_copied = 0;
+    s->info.tcp.rcv_space_start = t;
+}
+
+/* Return consumed receive data to the window, keeping the window within
+   the receive buffer. Called with the pcb locked. */
+static void netsock_tcp_recved(netsock s, struct tcp_pcb *lw, u64 len)
+{
+    netsock_tcp_rcv_autotune(s, lw, len);
+    u32 max = TCP_WND_MAX(lw);
+    u32 hold = max - MIN(s->rcvbuf, max);
+    u64 credit = s->info.tcp.rcv_withheld + len;
+    if (credit > hold) {
+        u64 n = credit - hold;
+        credit = hold;
+        while (n > 0) {
+            u16 recved = MIN(n, MASK(16));
+            tcp_recved(lw, recved);
+            n -= recved;
+        }
+    }
+    s->info.tcp.rcv_withheld = credit;
+}
+
+/* Grow the send buffer, when a writer found it full, to two congestion
+   windows (bounded by the peer's window), so that the sender is not
+   stalled while the previous window is being acknowledged. Called with
+   the pcb locked. */
+static void netsock_tcp_snd_autotune(netsock s, struct tcp_pcb *lw)
+{
+    if (s->sndbuf_lock || !s->info.tcp.snd_limited)
+        return;
+    s->info.tcp.snd_limited = false;
+    u64 target = MIN(2 * (u64)MIN(lw->cwnd, lw->snd_wnd_max), TCP_SND_BUF);
+    if (target > s->sndbuf &&
+        netsock_autotune_charge(&s->info.tcp.sndbuf_tuned, target - s->sndbuf)) {
+        net_debug("sock %d, sndbuf %d -> %ld\n", s->sock.fd, s->sndbuf, target);
+        s->sndbuf = target;
+    }
+}
+
 static inline s64 lwip_to_errno(s8 err)
 {
     switch (err) {
@@ -417,8 +776,97 @@ struct udp_entry {
     struct pbuf * pbuf;
     ip_addr_t raddr;
     u16 rport;
+    u16 gso_size;               /* segment size, if coalesced by UDP_GRO */
 };
 
+/* the UDP length field includes the header */
+#define UDP_MAX_PAYLOAD     (U16_MAX - 8)
+
+closure_function(1, 0, boolean, netsock_rx_ready,
+                 netsock, s)
+{
+    netsock s = bound(s);
+    netsock_lock(s);
+    boolean ready = (netsock_events_locked(s) & (EPOLLIN | EPOLLHUP)) ||
+        (get_lwip_error(s) != ERR_OK);
+    netsock_unlock(s);
+    return ready;
+}
+
+/* Before a reader blocks, spin on the interface that the socket last received
+   data from, for up to the socket's busy-poll time. Returns true if the socket
+   became readable meanwhile. */
+static boolean netsock_busy_poll(netsock s)
+{
+    if (!s->busy_poll || !is_syscall_context(get_current_context(current_cpu())))
+        return false;
+    return net_busy_poll(s->rx_if_idx, microseconds(s->busy_poll),
+                         stack_closure(netsock_rx_ready, s));
+}
+
+/* Copy a queued datagram into a message and, unless peeking, dequeue it;
+   datagrams coalesced by UDP_GRO are reported with their segment size.
+   Called with the netsock lock held. */
+static sysreturn netsock_udp_recv_locked(netsock s, struct udp_entry *e, struct msghdr *msg,
+                                         int flags)
+{
+    u64 controllen = msg->msg_control ? msg->msg_controllen : 0;
+    msg->msg_controllen = 0;
+    msg->msg_flags = 0;
+    if (msg->msg_name)
+        addrport_to_sockaddr(s->sock.domain, &e->raddr, e->rport, msg->msg_name,
+                             &msg->msg_namelen);
+
+    struct pbuf *pbuf = e->pbuf;
+    struct pbuf *cur_buf = pbuf;
+    iovec iov = msg->msg_iov;
+    u64 length = msg->msg_iovlen;
+    u64 iov_offset = 0, buf_offset = 0;
+    u64 xfer_total = 0;
+    while ((length > 0) && cur_buf) {
+        u64 xfer = MIN(iov->iov_len - iov_offset, cur_buf->len - buf_offset);
+        runtime_memcpy(iov->iov_base + iov_offset, cur_buf->payload + buf_offset, xfer);
+        xfer_total += xfer;
+        iov_offset += xfer;
+        buf_offset += xfer;
+        if (iov_offset == iov->iov_len) {
+            length--;
+            iov++;
+            iov_offset = 0;
+        }
+        if (buf_offset == cur_buf->len) {
+            cur_buf = cur_buf->next;
+            buf_offset = 0;
+        }
+    }
+    if (cur_buf) {
+        msg->msg_flags |= MSG_TRUNC;
+        if (flags & MSG_TRUNC)
+            xfer_total = pbuf->tot_len;
+    }
+
+    if (e->gso_size) {
+        if (controllen >= CMSG_LEN(sizeof(int))) {
+            struct cmsghdr *cmsg = msg->msg_control;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_GRO;
+            *(int *)CMSG_DATA(cmsg) = e->gso_size;
+            msg->msg_controllen = MIN(CMSG_SPACE(sizeof(int)), controllen);
+        } else {
+            msg->msg_flags |= MSG_CTRUNC;
+        }
+    }
+
+    if (!(flags & MSG_PEEK)) {
+        assert(dequeue(s->incoming) == e);
+        s->sock.rx_len -= pbuf->tot_len;
+        deallocate(s->sock.h, e, sizeof(*e));
+        pbuf_free(pbuf);
+    }
+    return xfer_total;
+}
+
 static sysreturn sock_read_bh_internal(netsock s, struct msghdr *msg, int flags,
                                        io_completion completion, u64 bqflags)
 {
@@ -464,33 +912,31 @@ static sysreturn sock_read_bh_internal(netsock s, struct msghdr *msg, int flags,
             goto out_unlock;
         }
         netsock_unlock(s);
+        if (!(bqflags & BLOCKQ_ACTION_BLOCKED) && netsock_busy_poll(s))
+            return sock_read_bh_internal(s, msg, flags, completion, bqflags);
         return blockq_block_required(t, bqflags);
     }
 
-    sockaddr src_addr = msg->msg_name;
-    if (src_addr) {
-        socklen_t *addrlen = &msg->msg_namelen;
-        if (s->sock.type == SOCK_STREAM) {
-            remote_sockaddr(s, src_addr, addrlen);
-        } else {
-            struct udp_entry * e = p;
-            addrport_to_sockaddr(s->sock.domain, &e->raddr, e->rport, src_addr,
-                                 addrlen);
-        }
+    if (s->sock.type == SOCK_DGRAM) {
+        rv = netsock_udp_recv_locked(s, p, msg, flags);
+        notify = queue_empty(s->incoming);  /* reset a triggered EPOLLIN condition */
+        goto out_unlock;
     }
 
+    if (msg->msg_name)
+        remote_sockaddr(s, msg->msg_name, &msg->msg_namelen);
+
     u64 iov_offset = 0;
     u64 xfer_total = 0;
     u32 pbuf_idx = 0;
-    if ((s->sock.type == SOCK_STREAM) && !(flags & MSG_PEEK)) {
+    if (!(flags & MSG_PEEK)) {
         tcp_lw = s->info.tcp.lw;
         tcp_ref(tcp_lw);
     }
 
-    /* TCP: consume multiple buffers to fill request, if available. */
+    /* Consume multiple buffers to fill request, if available. */
     do {
-        struct pbuf * pbuf = s->sock.type == SOCK_STREAM ? (struct pbuf *)p :
-            ((struct udp_entry *)p)->pbuf;
+        struct pbuf *pbuf = p;
         struct pbuf *cur_buf = pbuf;
 
         while ((length > 0) && cur_buf) {
@@ -499,8 +945,7 @@ static sysreturn sock_read_bh_internal(netsock s, struct msghdr *msg, int flags,
                 runtime_memcpy(iov->iov_base + iov_offset, cur_buf->payload, xfer);
                 if (!(flags & MSG_PEEK)) {
                     pbuf_consume(cur_buf, xfer);
-                    if (s->sock.type == SOCK_STREAM)
-                        s->sock.rx_len -= xfer;
+                    s->sock.rx_len -= xfer;
                 }
                 xfer_total += xfer;
                 iov_offset += xfer;
@@ -517,27 +962,17 @@ static sysreturn sock_read_bh_internal(netsock s, struct msghdr *msg, int flags,
         if (flags & MSG_PEEK) {
             if (!cur_buf)
                 p = queue_peek_at(s->incoming, ++pbuf_idx);
-        } else if (!cur_buf || (s->sock.type == SOCK_DGRAM)) {
+        } else if (!cur_buf) {
             assert(dequeue(s->incoming) == p);
-            if (s->sock.type == SOCK_DGRAM) {
-                s->sock.rx_len -= pbuf->tot_len;
-                if (cur_buf) {
-                    msg->msg_flags |= MSG_TRUNC;
-                    if (flags & MSG_TRUNC)
-                        xfer_total = pbuf->tot_len;
-                }
-                deallocate(s->sock.h, p, sizeof(struct udp_entry));
-            }
             pbuf_free(pbuf);
             p = queue_peek(s->incoming);
             if (p == INVALID_ADDRESS)
                 notify = true;  /* reset a triggered EPOLLIN condition */
         }
-    } while(s->sock.type == SOCK_STREAM && length > 0 && p != INVALID_ADDRESS); /* XXX simplify expression */
+    } while (length > 0 && p != INVALID_ADDRESS);
 
-    if (s->sock.type == SOCK_STREAM)
-        /* Calls to tcp_recved() may have enqueued new packets in the loopback interface. */
-        netsock_check_loop();
+    /* Calls to tcp_recved() may have enqueued new packets in the loopback interface. */
+    netsock_check_loop();
 
     rv = xfer_total;
   out_unlock:
@@ -548,7 +983,7 @@ static sysreturn sock_read_bh_internal(netsock s, struct msghdr *msg, int flags,
     if (tcp_lw) {
         if (rv > 0) {
             tcp_lock(tcp_lw);
-            tcp_recved(tcp_lw, rv);
+            netsock_tcp_recved(s, tcp_lw, rv);
             tcp_unlock(tcp_lw);
         }
         tcp_unref(tcp_lw);
@@ -642,6 +1077,7 @@ closure_function(6, 1, sysreturn, socket_write_tcp_bh,
     }
 
     struct tcp_pcb *tcp_lw = s->info.tcp.lw;
+    boolean zerocopy = (flags & MSG_ZEROCOPY) && s->info.tcp.zerocopy;
     tcp_ref(tcp_lw);
     netsock_unlock(s);
     tcp_lock(tcp_lw);
@@ -650,15 +1086,16 @@ closure_function(6, 1, sysreturn, socket_write_tcp_bh,
        bits here (and tcp_write() doesn't accept more than 2^16
        anyway), so even if we have a large transmit window due to
        LWIP_WND_SCALE, we still can't write more than 2^16. Sigh... */
-    u64 avail = tcp_sndbuf(tcp_lw);
+    u64 avail = netsock_tcp_sndbuf(s, tcp_lw);
     if (avail == 0) {
         /* directly poll for loopback traffic in case the enqueued netsock_poll is backed up */
         tcp_unlock(tcp_lw);
         netif_poll_loopback();
         tcp_lock(tcp_lw);
-        avail = tcp_sndbuf(tcp_lw);
+        avail = netsock_tcp_sndbuf(s, tcp_lw);
         if (avail == 0) {
           full:
+            s->info.tcp.snd_limited = true;
             tcp_unlock(tcp_lw);
             if ((bqflags & BLOCKQ_ACTION_BLOCKED) == 0 &&
                 ((s->sock.f.flags & SOCK_NONBLOCK) || (flags & MSG_DONTWAIT))) {
@@ -679,10 +1116,24 @@ closure_function(6, 1, sysreturn, socket_write_tcp_bh,
         remain = 1;
     }
 
+    /* The data of a zero-copy send stays referenced until acknowledged,
+       at which point a notification is queued on the error queue. */
+    netsock_zc_ref zr = 0;
+    boolean copied = false;
+    if (zerocopy) {
+        zr = allocate(s->sock.h, sizeof(*zr));
+        if (zr == INVALID_ADDRESS) {
+            zr = 0;
+            zerocopy = false;
+        } else {
+            zr->pins = 0;
+        }
+    }
+
     /* Figure actual length and flags */
     u64 n;
     for (u64 i = 0; i < remain; i++) {
-        u8 apiflags = TCP_WRITE_FLAG_COPY;
+        u8 apiflags = zerocopy ? 0 : TCP_WRITE_FLAG_COPY;
         n = iov[i].iov_len;
         if (avail < rv + n) {
             n = avail - rv;
@@ -691,14 +1142,31 @@ closure_function(6, 1, sysreturn, socket_write_tcp_bh,
             apiflags |= TCP_WRITE_FLAG_MORE;
         }
 
-        err = tcp_write(tcp_lw, iov[i].iov_base, n, apiflags);
-        if (err == ERR_OK) {
-            rv += n;
-            continue;
+        if (zerocopy) {
+            u64 written;
+            err = netsock_tcp_write_zc(s->sock.h, zr, tcp_lw, iov[i].iov_base, n, apiflags,
+                                       &written, &copied);
+            rv += written;
+        } else {
+            err = tcp_write(tcp_lw, iov[i].iov_base, n, apiflags);
+            if (err == ERR_OK)
+                rv += n;
         }
+        if (err == ERR_OK)
+            continue;
         if (err == ERR_MEM) {
             /* XXX some ambiguity in lwIP - investigate */
             net_debug(" tcp_write() returned ERR_MEM\n");
+            if (rv > 0) {
+                /* report the partial write */
+                err = ERR_OK;
+                break;
+            }
+            if (zr) {
+                if (zr->pins)
+                    deallocate_buffer(zr->pins);
+                deallocate(s->sock.h, zr, sizeof(*zr));
+            }
             goto full;
         } else {
             net_debug(" tcp_write() lwip error: %d\n", err);
@@ -706,6 +1174,23 @@ closure_function(6, 1, sysreturn, socket_write_tcp_bh,
         }
         break;
     }
+    if (zr) {
+        /* pinned memory stays referenced by queued data even if a later
+           write failed */
+        if (rv > 0 || (zr->pins && buffer_length(zr->pins) > 0)) {
+            zr->seq_end = tcp_lw->snd_lbb;
+            zr->r = 0;
+            zr->notify = rv > 0;
+            if (zr->notify)
+                zr->id = s->info.tcp.zc_next_id++;
+            zr->copied = copied;
+            list_push_back(&s->info.tcp.zc_pending, &zr->l);
+        } else {
+            if (zr->pins)
+                deallocate_buffer(zr->pins);
+            deallocate(s->sock.h, zr, sizeof(*zr));
+        }
+    }
     if (err == ERR_OK) {
         /* XXX prob add a flag to determine whether to continuously
            post data, e.g. if used by send/sendto... */
@@ -733,8 +1218,60 @@ closure_function(6, 1, sysreturn, socket_write_tcp_bh,
     return rv;
 }
 
+/* Send the data as one datagram or, if a segment size is given (UDP_SEGMENT),
+   as a train of datagrams of that size, the last one possibly shorter. If an
+   error interrupts a segmented send, the amount of data already sent is
+   returned. Called with the netsock lock held. */
+static sysreturn socket_write_udp_locked(netsock s, iovec iov, u64 iovlen, ip_addr_t *ipaddr,
+                                         u16 port, u16 gso_size)
+{
+    if (!ipaddr && !udp_is_flag_set(s->info.udp.lw, UDP_FLAGS_CONNECTED))
+        return -EDESTADDRREQ;
+    u64 total_len = iov_total_len(iov, iovlen);
+    if (total_len > UDP_MAX_PAYLOAD)
+        return -EMSGSIZE;
+    u64 seg_len = total_len;
+    if (gso_size && (total_len > gso_size)) {
+        if (total_len > (u64)gso_size * UDP_MAX_SEGMENTS)
+            return -EINVAL;
+        seg_len = gso_size;
+    }
+    u64 sent = 0;
+    u64 iov_offset = 0;
+    do {
+        u64 len = MIN(seg_len, total_len - sent);
+        struct pbuf *pbuf = pbuf_alloc(PBUF_TRANSPORT, len, PBUF_RAM);
+        if (!pbuf) {
+            msg_err("failed to allocate pbuf for udp_send()\n");
+            return sent ? sent : -ENOBUFS;
+        }
+        for (u64 offset = 0; offset < len; ) {
+            u64 n = MIN(iov->iov_len - iov_offset, len - offset);
+            runtime_memcpy(pbuf->payload + offset, iov->iov_base + iov_offset, n);
+            offset += n;
+            iov_offset += n;
+            if (iov_offset == iov->iov_len) {
+                iov++;
+                iov_offset = 0;
+            }
+        }
+        err_t err;
+        if (ipaddr)
+            err = udp_sendto(s->info.udp.lw, pbuf, ipaddr, port);
+        else
+            err = udp_send(s->info.udp.lw, pbuf);
+        pbuf_free(pbuf);
+        if (err != ERR_OK) {
+            net_debug("lwip error %d\n", err);
+            return sent ? sent : lwip_to_errno(err);
+        }
+        sent += len;
+    } while (sent < total_len);
+    return total_len;
+}
+
 static sysreturn socket_write_udp(netsock s, void *source, iovec iov, u64 length,
-                                  struct sockaddr *dest_addr, socklen_t addrlen)
+                                  struct sockaddr *dest_addr, socklen_t addrlen, u16 gso_size)
 {
     ip_addr_t ipaddr;
     u16 port = 0;
@@ -744,14 +1281,6 @@ static sysreturn socket_write_udp(netsock s, void *source, iovec iov, u64 length
         if (ret)
             return ret;
     }
-    err_t err = ERR_OK;
-
-    /* XXX check how much we can queue, maybe make udp bh */
-    netsock_lock(s);
-    if (!dest_addr && !udp_is_flag_set(s->info.udp.lw, UDP_FLAGS_CONNECTED)) {
-        netsock_unlock(s);
-        return -EDESTADDRREQ;
-    }
 
     struct iovec iov_internal;
     if (!iov) {
@@ -760,27 +1289,34 @@ static sysreturn socket_write_udp(netsock s, void *source, iovec iov, u64 length
         iov->iov_len = length;
         length = 1;
     }
-    u64 total_len = iov_total_len(iov, length);
-    struct pbuf *pbuf = pbuf_alloc(PBUF_TRANSPORT, total_len, PBUF_RAM);
-    if (!pbuf) {
-        netsock_unlock(s);
-        msg_err("failed to allocate pbuf for udp_send()\n");
-        return -ENOBUFS;
-    }
-    for (u64 i = 0, offset = 0; i < length; offset += iov[i].iov_len, i++)
-        runtime_memcpy(pbuf->payload + offset, iov[i].iov_base, iov[i].iov_len);
-    if (dest_addr)
-        err = udp_sendto(s->info.udp.lw, pbuf, &ipaddr, port);
-    else
-        err = udp_send(s->info.udp.lw, pbuf);
+    /* XXX check how much we can queue, maybe make udp bh */
+    netsock_lock(s);
+    sysreturn rv = socket_write_udp_locked(s, iov, length, dest_addr ? &ipaddr : 0, port,
+                                           gso_size);
     netsock_unlock(s);
-    pbuf_free(pbuf);
-    if (err != ERR_OK) {
-        net_debug("lwip error %d\n", err);
-        return lwip_to_errno(err);
+    if (rv >= 0)
+        netsock_check_loop();
+    return rv;
+}
+
+/* Retrieves the ancillary data of a datagram to be sent; UDP_SEGMENT
+   overrides the segment size set for the socket. */
+static sysreturn netsock_udp_send_control(const struct msghdr *msg, u16 *gso_size)
+{
+    u8 *control = msg->msg_control;
+    u64 controllen = control ? msg->msg_controllen : 0;
+    for (u64 offset = 0; offset + sizeof(struct cmsghdr) <= controllen; ) {
+        struct cmsghdr *cmsg = (struct cmsghdr *)(control + offset);
+        if ((cmsg->cmsg_len < sizeof(struct cmsghdr)) || (cmsg->cmsg_len > controllen - offset))
+            return -EINVAL;
+        if ((cmsg->cmsg_level == SOL_UDP) && (cmsg->cmsg_type == UDP_SEGMENT)) {
+            if (cmsg->cmsg_len != CMSG_LEN(sizeof(u16)))
+                return -EINVAL;
+            *gso_size = *(u16 *)CMSG_DATA(cmsg);
+        }
+        offset += CMSG_ALIGN(cmsg->cmsg_len);
     }
-    netsock_check_loop();
-    return total_len;
+    return 0;
 }
 
 static sysreturn socket_write_internal(struct sock *sock, void *source, iovec iov,
@@ -806,7 +1342,8 @@ static sysreturn socket_write_internal(struct sock *sock, void *source, iovec io
                                               completion);
         return blockq_check(sock->txbq, t, ba, bh);
     } else if (sock->type == SOCK_DGRAM) {
-        rv = socket_write_udp(s, source, iov, length, dest_addr, addrlen);
+        rv = socket_write_udp(s, source, iov, length, dest_addr, addrlen,
+                              s->info.udp.gso_size);
     } else {
 	msg_err("socket type %d unsupported\n", sock->type);
 	rv = -EINVAL;
@@ -827,6 +1364,136 @@ closure_function(1, 6, sysreturn, socket_write,
     return socket_write_internal(s, source, 0, length, 0, 0, 0, bh, completion);
 }
 
+/* Buffers that hold a reference to their source (e.g. page cache pages
+   read for sendfile) are queued by reference, keeping the reference until
+   the data is acknowledged; others are copied. */
+closure_function(4, 1, sysreturn, socket_sg_write_tcp_bh,
+                 netsock, s, sg_list, sg, u64, length, io_completion, completion,
+                 u64, bqflags)
+{
+    netsock s = bound(s);
+    sg_list sg = bound(sg);
+    thread t = current;
+    sysreturn rv = 0;
+    io_completion completion = bound(completion);
+    netsock_lock(s);
+    err_t err = get_lwip_error(s);
+    net_debug("fd %d, thread %ld, length %ld, bqflags 0x%lx, lwip err %d\n",
+              s->sock.fd, t->tid, bound(length), bqflags, err);
+    if (err != ERR_OK) {
+        rv = lwip_to_errno(err);
+        goto out_unlock;
+    }
+    if (s->info.tcp.state != TCP_SOCK_OPEN) {
+        rv = -ENOTCONN;
+        goto out_unlock;
+    }
+    if (bqflags & BLOCKQ_ACTION_NULLIFY) {
+        rv = -ERESTARTSYS;
+        goto out_unlock;
+    }
+    struct tcp_pcb *tcp_lw = s->info.tcp.lw;
+    tcp_ref(tcp_lw);
+    netsock_unlock(s);
+    tcp_lock(tcp_lw);
+    u64 avail = netsock_tcp_sndbuf(s, tcp_lw);
+    if (avail == 0) {
+        tcp_unlock(tcp_lw);
+        netif_poll_loopback();
+        tcp_lock(tcp_lw);
+        avail = netsock_tcp_sndbuf(s, tcp_lw);
+    }
+    if (avail == 0) {
+        s->info.tcp.snd_limited = true;
+        tcp_unlock(tcp_lw);
+        tcp_unref(tcp_lw);
+        if ((bqflags & BLOCKQ_ACTION_BLOCKED) == 0 && (s->sock.f.flags & SOCK_NONBLOCK)) {
+            rv = -EAGAIN;
+            goto out;
+        }
+        return blockq_block_required(t, bqflags);
+    }
+    u64 limit = MIN(avail, bound(length));
+    sg_buf sgb;
+    while (rv < limit && (sgb = sg_list_head_peek(sg)) != INVALID_ADDRESS) {
+        u64 n = MIN(sg_buf_len(sgb), limit - rv);
+        u8 apiflags = (rv + n < bound(length)) ? TCP_WRITE_FLAG_MORE : 0;
+        netsock_zc_ref zr = 0;
+        if (sgb->refcount) {
+            zr = allocate(s->sock.h, sizeof(*zr));
+            if (zr == INVALID_ADDRESS)
+                zr = 0;
+        }
+        if (!zr)
+            apiflags |= TCP_WRITE_FLAG_COPY;
+        err = tcp_write(tcp_lw, sgb->buf + sgb->offset, n, apiflags);
+        if (err != ERR_OK) {
+            if (zr)
+                deallocate(s->sock.h, zr, sizeof(*zr));
+            break;
+        }
+        if (zr) {
+            refcount_reserve(sgb->refcount);
+            zr->seq_end = tcp_lw->snd_lbb;
+            zr->r = sgb->refcount;
+            zr->pins = 0;
+            zr->notify = 0;
+            list_push_back(&s->info.tcp.zc_pending, &zr->l);
+        }
+        sg_consume(sg, n);
+        rv += n;
+    }
+    if (rv > 0) {
+        err = tcp_output(tcp_lw);
+        if (err == ERR_OK)
+            netsock_check_loop();
+        else
+            net_debug(" tcp_output() lwip error: %d\n", err);
+    } else {
+        net_debug(" tcp_write() lwip error: %d\n", err);
+        if (err == ERR_MEM && ((bqflags & BLOCKQ_ACTION_BLOCKED) ||
+                               !(s->sock.f.flags & SOCK_NONBLOCK))) {
+            netsock_tcp_put(tcp_lw);
+            return blockq_block_required(t, bqflags);
+        }
+        rv = (err == ERR_MEM) ? -EAGAIN : lwip_to_errno(err);
+    }
+    netsock_tcp_put(tcp_lw);
+    goto out;
+  out_unlock:
+    netsock_unlock(s);
+  out:
+    closure_finish();
+    net_debug("   completion %p, rv %ld\n", completion, rv);
+    apply(completion, t, rv);
+    return rv;
+}
+
+closure_function(1, 6, sysreturn, socket_sg_write,
+                 netsock, s,
+                 sg_list, sg, u64, length, u64, offset, thread, t, boolean, bh, io_completion, completion)
+{
+    netsock s = bound(s);
+    sysreturn rv;
+    net_debug("sock %d, thread %ld, sg %p, length %ld\n", s->sock.fd, t->tid, sg, length);
+    if (s->info.tcp.state != TCP_SOCK_OPEN) {
+        rv = -EPIPE;
+        goto out;
+    }
+    if (length == 0) {
+        rv = 0;
+        goto out;
+    }
+    blockq_action ba = contextual_closure(socket_sg_write_tcp_bh, s, sg, length, completion);
+    if (ba == INVALID_ADDRESS) {
+        rv = -ENOMEM;
+        goto out;
+    }
+    return blockq_check(s->sock.txbq, t, ba, bh);
+  out:
+    return io_complete(completion, t, rv);
+}
+
 static boolean siocgifconf_get_len(struct netif *n, void *priv)
 {
     if (netif_is_up(n) && netif_is_link_up(n) && !ip4_addr_isany(netif_ip4_addr(n))) {
@@ -1050,6 +1717,7 @@ closure_function(1, 2, sysreturn, netsock_ioctl,
 
 /* Must fit in a u8_t, because it may be used as backlog value for tcp_listen_with_backlog(). */
 #define SOCK_QUEUE_LEN 255
+#define SOCK_QUEUE_MAX_LEN  8192
 
 closure_function(1, 2, sysreturn, socket_close,
                  netsock, s,
@@ -1068,9 +1736,12 @@ closure_function(1, 2, sysreturn, socket_close,
         if (tcp_lw) {
             tcp_close(tcp_lw);
             tcp_arg(tcp_lw, 0);
+            netsock_zc_detach(s, tcp_lw);
             netsock_tcp_put(tcp_lw);
             netsock_check_loop();
         }
+        netsock_autotune_release(&s->info.tcp.rcvbuf_tuned);
+        netsock_autotune_release(&s->info.tcp.sndbuf_tuned);
         break;
     case SOCK_DGRAM:
         udp_remove(s->info.udp.lw);
@@ -1079,6 +1750,8 @@ closure_function(1, 2, sysreturn, socket_close,
     deallocate_queue(s->incoming);
     deallocate_closure(s->sock.f.read);
     deallocate_closure(s->sock.f.write);
+    if (s->sock.f.sg_write)
+        deallocate_closure(s->sock.f.sg_write);
     deallocate_closure(s->sock.f.close);
     deallocate_closure(s->sock.f.events);
     deallocate_closure(s->sock.f.ioctl);
@@ -1136,6 +1809,8 @@ static sysreturn netsock_shutdown(struct sock *sock, int how)
         netsock_unlock(s);
         tcp_lock(tcp_lw);
         tcp_shutdown(tcp_lw, shut_rx, shut_tx);
+        if (shut_rx && shut_tx)
+            netsock_zc_detach(s, tcp_lw);
         tcp_unlock(tcp_lw);
         tcp_unref(tcp_lw);
         netsock_check_loop();
@@ -1170,6 +1845,27 @@ sysreturn shutdown(int sockfd, int how)
     return s->shutdown(s, how);
 }
 
+/* UDP_GRO: append a received datagram to the last queued one, if they come
+   from the same source and the latter ends on a segment boundary, i.e. as in
+   Linux, all segments but the last of a coalesced datagram have the same
+   size. Called with the netsock lock held. */
+static boolean netsock_udp_gro(netsock s, struct pbuf *p, ip_addr_t *raddr, u16 rport)
+{
+    u64 n = queue_length(s->incoming);
+    if (n == 0)
+        return false;
+    struct udp_entry *e = queue_peek_at(s->incoming, n - 1);
+    u32 len = e->pbuf->tot_len;
+    u32 seg = e->gso_size ? e->gso_size : len;
+    if ((e->rport != rport) || !ip_addr_cmp(&e->raddr, raddr) || (seg == 0) || (len % seg) ||
+        (p->tot_len == 0) || (p->tot_len > seg) || (len + p->tot_len > UDP_MAX_PAYLOAD) ||
+        (len / seg >= UDP_MAX_SEGMENTS))
+        return false;
+    pbuf_cat(e->pbuf, p);
+    e->gso_size = seg;
+    return true;
+}
+
 static void udp_input_lower(void *z, struct udp_pcb *pcb, struct pbuf *p,
                             struct ip_globals *ip_data, u16 port)
 {
@@ -1182,19 +1878,28 @@ static void udp_input_lower(void *z, struct udp_pcb *pcb, struct pbuf *p,
     assert(pcb == s->info.udp.lw);
     if (p) {
 	netsock_lock(s);
-	if ((s->sock.rx_len + p->tot_len > so_rcvbuf) || queue_full(s->incoming)) {
+	if (s->sock.rx_len + p->tot_len > s->rcvbuf) {
 	    netsock_unlock(s);
 	    pbuf_free(p);
 	    return;
 	}
-	/* could make a cache if we care to */
-	struct udp_entry * e = allocate(s->sock.h, sizeof(*e));
-	assert(e != INVALID_ADDRESS);
-	e->pbuf = p;
-	runtime_memcpy(&e->raddr, &ip_data->current_iphdr_src, sizeof(ip_addr_t));
-	e->rport = port;
-	assert(enqueue(s->incoming, e));
+	if (!s->info.udp.gro || !netsock_udp_gro(s, p, &ip_data->current_iphdr_src, port)) {
+	    if (queue_full(s->incoming)) {
+	        netsock_unlock(s);
+	        pbuf_free(p);
+	        return;
+	    }
+	    /* could make a cache if we care to */
+	    struct udp_entry * e = allocate(s->sock.h, sizeof(*e));
+	    assert(e != INVALID_ADDRESS);
+	    e->pbuf = p;
+	    runtime_memcpy(&e->raddr, &ip_data->current_iphdr_src, sizeof(ip_addr_t));
+	    e->rport = port;
+	    e->gso_size = 0;
+	    assert(enqueue(s->incoming, e));
+	}
 	s->sock.rx_len += p->tot_len;
+	s->rx_if_idx = p->if_idx;
 	wakeup_sock(s, WAKEUP_SOCK_RX);
     } else {
 	msg_err("null pbuf\n");
@@ -1220,6 +1925,7 @@ static int allocate_sock(process p, int af, int type, u32 flags, netsock *rs)
     s->sock.f.close = closure(h, socket_close, s);
     s->sock.f.events = closure(h, socket_events, s);
     s->sock.f.ioctl = closure(h, netsock_ioctl, s);
+    s->sock.f.sg_write = (type == SOCK_STREAM) ? closure(h, socket_sg_write, s) : 0;
     s->p = p;
 
     s->incoming = allocate_queue(h, SOCK_QUEUE_LEN);
@@ -1239,8 +1945,29 @@ static int allocate_sock(process p, int af, int type, u32 flags, netsock *rs)
     s->sock.recvfrom = netsock_recvfrom;
     s->sock.sendmsg = netsock_sendmsg;
     s->sock.recvmsg = netsock_recvmsg;
+    if (type == SOCK_DGRAM) {
+        s->sock.sendmmsg = netsock_sendmmsg;
+        s->sock.recvmmsg = netsock_recvmmsg;
+    }
     s->sock.shutdown = netsock_shutdown;
     s->ipv6only = 0;
+    s->rx_if_idx = NETIF_NO_INDEX;
+    s->busy_poll = busy_read_usecs;
+    s->rcvbuf = so_rcvbuf;
+    s->sndbuf = DEFAULT_SO_SNDBUF;
+    s->rcvbuf_lock = s->sndbuf_lock = 0;
+    if (type == SOCK_STREAM) {
+        list_init(&s->info.tcp.zc_pending);
+        s->info.tcp.zc_next_id = 0;
+        s->info.tcp.zerocopy = 0;
+        s->info.tcp.zc_notify = 0;
+        s->info.tcp.snd_limited = false;
+        s->info.tcp.rcv_withheld = 0;
+        s->info.tcp.rcv_rtt_start = s->info.tcp.rcv_rtt = 0;
+        s->info.tcp.rcv_space_start = 0;
+        s->info.tcp.rcv_space_copied = 0;
+        s->info.tcp.rcvbuf_tuned = s->info.tcp.sndbuf_tuned = 0;
+    }
     set_lwip_error(s, ERR_OK);
     fd = s->sock.fd = allocate_fd(p, s);
     if (fd == INVALID_PHYSICAL) {
@@ -1278,6 +2005,8 @@ static int allocate_udp_sock(process p, int af, struct udp_pcb *pcb, u32 flags)
     if (fd >= 0) {
         s->info.udp.lw = pcb;
         s->info.udp.state = UDP_SOCK_CREATED;
+        s->info.udp.gso_size = 0;
+        s->info.udp.gro = 0;
         udp_recv(pcb, udp_input_lower, s);
     }
     return fd;
@@ -1343,6 +2072,24 @@ sysreturn socket(int domain, int type, int protocol)
     return -EINVAL;
 }
 
+/* A receive buffer larger than the default can hold more segments than
+   the incoming queue; called with the netsock lock held. */
+static boolean netsock_incoming_grow(netsock s)
+{
+    u64 len = queue_length(s->incoming);
+    if (len >= SOCK_QUEUE_MAX_LEN)
+        return false;
+    queue q = allocate_queue(s->sock.h, 2 * len);
+    if (q == INVALID_ADDRESS)
+        return false;
+    void *p;
+    while ((p = dequeue(s->incoming)) != INVALID_ADDRESS)
+        assert(enqueue(q, p));
+    deallocate_queue(s->incoming);
+    s->incoming = q;
+    return true;
+}
+
 static err_t tcp_input_lower(void *z, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
 {
     if (!z) {
@@ -1359,12 +2106,16 @@ static err_t tcp_input_lower(void *z, struct tcp_pcb *pcb, struct pbuf *p, err_t
     /* A null pbuf indicates connection closed. */
     netsock_lock(s);
     if (p) {
-        if ((s->sock.rx_len + p->tot_len > so_rcvbuf) || !enqueue(s->incoming, p)) {
+        if ((s->sock.rx_len + p->tot_len > s->rcvbuf) ||
+            (queue_full(s->incoming) && !netsock_incoming_grow(s)) ||
+            !enqueue(s->incoming, p)) {
 	    netsock_unlock(s);
 	    msg_err("incoming queue full\n");
             return ERR_BUF;     /* XXX verify */
         }
         s->sock.rx_len += p->tot_len;
+        s->rx_if_idx = p->if_idx;
+        netsock_tcp_rcv_rtt(s, pcb);
     }
     wakeup_sock(s, WAKEUP_SOCK_RX);
 
@@ -1433,6 +2184,9 @@ static void lwip_tcp_conn_err(void * z, err_t err) {
     }
     netsock s = z;
     net_debug("sock %d, err %d\n", s->sock.fd, err);
+
+    /* lwIP has dropped all queued data */
+    netsock_zc_complete(s, 0, true);
     netsock_lock(s);
     s->info.tcp.state = TCP_SOCK_UNDEFINED;
     set_lwip_error(s, err);
@@ -1451,6 +2205,8 @@ static err_t lwip_tcp_sent(void * arg, struct tcp_pcb * pcb, u16 len)
     }
     netsock s = (netsock)arg;
     net_debug("fd %d, pcb %p, len %d\n", s->sock.fd, pcb, len);
+    netsock_zc_complete(s, pcb, false);
+    netsock_tcp_snd_autotune(s, pcb);
     netsock_lock(s);
     wakeup_sock(s, WAKEUP_SOCK_TX);
     return ERR_OK;
@@ -1529,6 +2285,8 @@ static err_t connect_tcp_complete(void* arg, struct tcp_pcb* tpcb, err_t err)
    }
    assert(s->info.tcp.state == TCP_SOCK_IN_CONNECTION);
    s->info.tcp.state = TCP_SOCK_OPEN;
+   if (err == ERR_OK)
+       netsock_tcp_rcv_init(s, tpcb);
    set_lwip_error(s, err);
    wakeup_sock(s, WAKEUP_SOCK_TX);
    return ERR_OK;
@@ -1682,10 +2440,54 @@ static sysreturn netsock_sendmsg(struct sock *s, const struct msghdr *msg, int f
     sysreturn rv = sendto_prepare(s, flags);
     if (rv < 0)
         return io_complete(completion, current, rv);
+    if (s->type == SOCK_DGRAM) {
+        u16 gso_size = ((netsock)s)->info.udp.gso_size;
+        rv = netsock_udp_send_control(msg, &gso_size);
+        if (rv == 0)
+            rv = socket_write_udp((netsock)s, 0, msg->msg_iov, msg->msg_iovlen,
+                                  msg->msg_name, msg->msg_namelen, gso_size);
+        return io_complete(completion, current, rv);
+    }
     return socket_write_internal(s, 0, msg->msg_iov, msg->msg_iovlen, flags,
                                  msg->msg_name, msg->msg_namelen, in_bh, completion);
 }
 
+/* Datagrams are sent without blocking, so the whole batch is sent with the
+   socket locked once. */
+static sysreturn netsock_sendmmsg(struct sock *sock, struct mmsghdr *msgvec, unsigned int vlen,
+                                  int flags)
+{
+    netsock s = (netsock)sock;
+    unsigned int i = 0;
+    sysreturn rv = sendto_prepare(sock, flags);
+    if (rv < 0)
+        goto out;
+    netsock_lock(s);
+    for (; i < vlen; i++) {
+        struct msghdr *msg = &msgvec[i].msg_hdr;
+        u16 gso_size = s->info.udp.gso_size;
+        ip_addr_t ipaddr;
+        u16 port = 0;
+        rv = netsock_udp_send_control(msg, &gso_size);
+        if ((rv == 0) && msg->msg_name)
+            rv = sockaddr_to_addrport(s, msg->msg_name, msg->msg_namelen, &ipaddr, &port);
+        if (rv == 0)
+            rv = socket_write_udp_locked(s, msg->msg_iov, msg->msg_iovlen,
+                                         msg->msg_name ? &ipaddr : 0, port, gso_size);
+        if (rv < 0)
+            break;
+        msgvec[i].msg_len = rv;
+    }
+    netsock_unlock(s);
+    if (i > 0) {
+        netsock_check_loop();
+        rv = i;
+    }
+  out:
+    socket_release(sock);
+    return rv;
+}
+
 sysreturn sendmsg(int sockfd, const struct msghdr *msg, int flags)
 {
     if (!validate_msghdr(msg, false))
@@ -1747,6 +2549,8 @@ sysreturn sendmmsg(int sockfd, struct mmsghdr *msgvec, unsigned int vlen,
     struct sock *s = resolve_socket(t->p, sockfd);
 
     net_debug("sock %d, type %d, flags 0x%x, vlen %d\n", s->fd, s->type, flags, vlen);
+    if (s->sendmmsg)
+        return s->sendmmsg(s, msgvec, vlen, flags);
     closure_struct(sendmmsg_next, next);
     contextual_closure_init(sendmmsg_next, &next);
     io_completion completion = contextual_closure(sendmmsg_complete,
@@ -1799,6 +2603,49 @@ sysreturn recvfrom(int sockfd, void * buf, u64 len, int flags,
     return sock->recvfrom(sock, buf, len, flags, src_addr, addrlen);
 }
 
+/* The error queue only ever holds zero-copy completion notifications. */
+static sysreturn netsock_recv_errqueue(netsock s, struct msghdr *msg)
+{
+    msg->msg_flags = 0;
+    if (msg->msg_name)
+        msg->msg_namelen = 0;
+    if (s->sock.type != SOCK_STREAM)
+        return -EAGAIN;
+    struct sock_extended_err ee = {
+        .ee_origin = SO_EE_ORIGIN_ZEROCOPY,
+    };
+    netsock_lock(s);
+    if (!s->info.tcp.zc_notify) {
+        netsock_unlock(s);
+        return -EAGAIN;
+    }
+    ee.ee_info = s->info.tcp.zc_lo;
+    ee.ee_data = s->info.tcp.zc_hi;
+    if (s->info.tcp.zc_copied)
+        ee.ee_code = SO_EE_CODE_ZEROCOPY_COPIED;
+    s->info.tcp.zc_notify = 0;
+    netsock_unlock(s);
+    msg->msg_flags = MSG_ERRQUEUE;
+    if (msg->msg_control && msg->msg_controllen >= CMSG_LEN(sizeof(ee))) {
+        struct cmsghdr *cmsg = msg->msg_control;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(ee));
+        if (s->sock.domain == AF_INET6) {
+            cmsg->cmsg_level = IPPROTO_IPV6;
+            cmsg->cmsg_type = IPV6_RECVERR;
+        } else {
+            cmsg->cmsg_level = SOL_IP;
+            cmsg->cmsg_type = IP_RECVERR;
+        }
+        runtime_memcpy(CMSG_DATA(cmsg), &ee, sizeof(ee));
+        msg->msg_controllen = MIN(CMSG_SPACE(sizeof(ee)), msg->msg_controllen);
+    } else {
+        msg->msg_flags |= MSG_CTRUNC;
+        msg->msg_controllen = 0;
+    }
+    fdesc_notify_events(&s->sock.f);    /* reset a triggered EPOLLERR condition */
+    return 0;
+}
+
 static sysreturn netsock_recvmsg(struct sock *sock, struct msghdr *msg,
                                  int flags, boolean in_bh, io_completion completion)
 {
@@ -1806,11 +2653,18 @@ static sysreturn netsock_recvmsg(struct sock *sock, struct msghdr *msg,
     netsock s = (netsock) sock;
     sysreturn rv;
 
+    if (flags & MSG_ERRQUEUE) {
+        rv = netsock_recv_errqueue(s, msg);
+        goto out;
+    }
+
     if ((sock->type == SOCK_STREAM) && (s->info.tcp.state != TCP_SOCK_OPEN)) {
         rv = (s->info.tcp.state == TCP_SOCK_UNDEFINED) ? 0 : -ENOTCONN;
         goto out;
     }
-    msg->msg_controllen = 0;
+    /* datagram control messages are filled in on delivery */
+    if (sock->type == SOCK_STREAM)
+        msg->msg_controllen = 0;
     msg->msg_flags = 0;
     blockq_action ba = contextual_closure(recvmsg_bh, s, msg, flags, completion);
     return blockq_check(sock->rxbq, t, ba, in_bh);
@@ -1831,6 +2685,88 @@ sysreturn recvmsg(int sockfd, struct msghdr *msg, int flags)
     return s->recvmsg(s, msg, flags, false, (io_completion)&s->f.io_complete);
 }
 
+/* Datagrams are received into consecutive messages of the batch, taking the
+   socket lock once for all the datagrams that are available. */
+closure_function(5, 1, sysreturn, netsock_recvmmsg_bh,
+                 netsock, s, struct mmsghdr *, msgvec, unsigned int, vlen, int, flags, unsigned int, index,
+                 u64, bqflags)
+{
+    netsock s = bound(s);
+    int flags = bound(flags);
+    thread t = current;
+    boolean polled = false;
+    boolean notify;
+    sysreturn rv;
+  again:
+    notify = false;
+    netsock_lock(s);
+    err_t err = get_lwip_error(s);
+    net_debug("sock %d, thread %ld, index %d, vlen %d, flags 0x%x, bqflags 0x%lx, lwip err %d\n",
+              s->sock.fd, t->tid, bound(index), bound(vlen), flags, bqflags, err);
+    if (s->info.udp.state == UDP_SOCK_SHUTDOWN) {
+        rv = 0;
+        goto out_unlock;
+    }
+    if (err != ERR_OK) {
+        rv = lwip_to_errno(err);
+        goto out_unlock;
+    }
+    if (bqflags & BLOCKQ_ACTION_NULLIFY) {
+        rv = -ERESTARTSYS;
+        goto out_unlock;
+    }
+    while (bound(index) < bound(vlen)) {
+        struct udp_entry *e = queue_peek_at(s->incoming, (flags & MSG_PEEK) ? bound(index) : 0);
+        if (e == INVALID_ADDRESS)
+            break;
+        struct mmsghdr *hdr = &bound(msgvec)[bound(index)];
+        hdr->msg_len = netsock_udp_recv_locked(s, e, &hdr->msg_hdr, flags & ~MSG_WAITFORONE);
+        bound(index)++;
+    }
+    notify = queue_empty(s->incoming);  /* reset a triggered EPOLLIN condition */
+    rv = 0;
+    if ((bound(index) == bound(vlen)) || (bound(index) && (flags & MSG_WAITFORONE)))
+        goto out_unlock;
+    if ((s->sock.f.flags & SOCK_NONBLOCK) || (flags & MSG_DONTWAIT)) {
+        rv = -EAGAIN;
+        goto out_unlock;
+    }
+    if (notify)
+        netsock_notify_events(s);
+    else
+        netsock_unlock(s);
+    if (!polled && !(bqflags & BLOCKQ_ACTION_BLOCKED)) {
+        polled = true;
+        if (netsock_busy_poll(s))
+            goto again;
+    }
+    return blockq_block_required(t, bqflags);
+  out_unlock:
+    if (notify)
+        netsock_notify_events(s);
+    else
+        netsock_unlock(s);
+    if (bound(index) > 0)
+        rv = bound(index);
+    closure_finish();
+    socket_release(&s->sock);
+    apply(syscall_io_complete, t, rv);
+    return rv;
+}
+
+static sysreturn netsock_recvmmsg(struct sock *sock, struct mmsghdr *msgvec, unsigned int vlen,
+                                  int flags)
+{
+    blockq_action ba = contextual_closure(netsock_recvmmsg_bh, (netsock)sock, msgvec, vlen,
+                                          flags, 0);
+    if (ba == INVALID_ADDRESS) {
+        socket_release(sock);
+        return -ENOMEM;
+    }
+    blockq_check(sock->rxbq, current, ba, false);
+    return thread_maybe_sleep_uninterruptible(current);
+}
+
 declare_closure_struct(0, 0, void, recvmmsg_next);
 
 closure_function(6, 2, void, recvmmsg_complete,
@@ -1883,6 +2819,8 @@ sysreturn recvmmsg(int sockfd, struct mmsghdr *msgvec, unsigned int vlen, int fl
     thread t = current;
     struct sock *s = resolve_socket(t->p, sockfd);
     net_debug("sock %d, type %d, flags 0x%x, vlen %d\n", s->fd, s->type, flags, vlen);
+    if (s->recvmmsg)
+        return s->recvmmsg(s, msgvec, vlen, flags);
     closure_struct(recvmmsg_next, next);
     contextual_closure_init(recvmmsg_next, &next);
     io_completion completion = contextual_closure(recvmmsg_complete,
@@ -1918,6 +2856,11 @@ static err_t accept_tcp_from_lwip(void * z, struct tcp_pcb * lw, err_t err)
     net_debug("new fd %d, pcb %p\n", fd, lw);
     netsock sn = (netsock)fdesc_get(s->p, fd);
     sn->info.tcp.state = TCP_SOCK_OPEN;
+    sn->rcvbuf = s->rcvbuf;
+    sn->sndbuf = s->sndbuf;
+    sn->rcvbuf_lock = s->rcvbuf_lock;
+    sn->sndbuf_lock = s->sndbuf_lock;
+    netsock_tcp_rcv_init(sn, lw);
     set_lwip_error(s, ERR_OK);
     tcp_arg(lw, sn);
     tcp_recv(lw, tcp_input_lower);
@@ -2231,6 +3174,53 @@ static sysreturn netsock_setsockopt(struct sock *sock, int level,
             break;
         case SO_REUSEPORT:
             goto unimplemented;
+        case SO_BUSY_POLL:
+            if (optlen != sizeof(int) || *((int *)optval) < 0) {
+                rv = -EINVAL;
+                goto out;
+            }
+            s->busy_poll = *((int *)optval);
+            break;
+        case SO_SNDBUF:
+        case SO_RCVBUF: {
+            if (optlen != sizeof(int)) {
+                rv = -EINVAL;
+                goto out;
+            }
+            int val = *((int *)optval);
+            boolean rcv = (optname == SO_RCVBUF);
+            u32 max = (s->sock.type != SOCK_STREAM) ? MASK(31) : (rcv ? TCP_WND : TCP_SND_BUF);
+            u32 size = (val < NETSOCK_MIN_BUF) ? NETSOCK_MIN_BUF : MIN((u32)val, max);
+            struct tcp_pcb *tcp_lw = (s->sock.type == SOCK_STREAM) ? netsock_tcp_get(s) : 0;
+            if (rcv) {
+                s->rcvbuf = size;
+                s->rcvbuf_lock = 1;
+            } else {
+                s->sndbuf = size;
+                s->sndbuf_lock = 1;
+            }
+            if (s->sock.type == SOCK_STREAM) {
+                netsock_autotune_release(rcv ? &s->info.tcp.rcvbuf_tuned :
+                                         &s->info.tcp.sndbuf_tuned);
+                /* open the window if the buffer grew */
+                if (tcp_lw && rcv && s->info.tcp.state == TCP_SOCK_OPEN)
+                    netsock_tcp_recved(s, tcp_lw, 0);
+            }
+            if (tcp_lw)
+                netsock_tcp_put(tcp_lw);
+            break;
+        }
+        case SO_ZEROCOPY:
+            if (optlen != sizeof(int)) {
+                rv = -EINVAL;
+                goto out;
+            }
+            if (s->sock.type != SOCK_STREAM) {
+                rv = -EOPNOTSUPP;
+                goto out;
+            }
+            s->info.tcp.zerocopy = !!*((int *)optval);
+            break;
         default:
             goto unimplemented;
         }
@@ -2266,6 +3256,32 @@ static sysreturn netsock_setsockopt(struct sock *sock, int level,
             goto unimplemented;
         }
         break;
+    case SOL_UDP:
+        if (s->sock.type != SOCK_DGRAM) {
+            rv = -ENOPROTOOPT;
+            goto out;
+        }
+        if (optlen != sizeof(int)) {
+            rv = -EINVAL;
+            goto out;
+        }
+        switch (optname) {
+        case UDP_SEGMENT: {
+            int val = *((int *)optval);
+            if ((val < 0) || (val > UDP_MAX_PAYLOAD)) {
+                rv = -EINVAL;
+                goto out;
+            }
+            s->info.udp.gso_size = val;
+            break;
+        }
+        case UDP_GRO:
+            s->info.udp.gro = !!*((int *)optval);
+            break;
+        default:
+            goto unimplemented;
+        }
+        break;
     default:
         goto unimplemented;
     }
@@ -2305,10 +3321,10 @@ static sysreturn netsock_getsockopt(struct sock *sock, int level,
             ret_optval.val = -lwip_to_errno(get_and_clear_lwip_error(s));
             break;
         case SO_SNDBUF:
-            ret_optval.val = (s->sock.type == SOCK_STREAM) ? TCP_SND_BUF : 0;
+            ret_optval.val = s->sndbuf;
             break;
         case SO_RCVBUF:
-            ret_optval.val = so_rcvbuf;
+            ret_optval.val = s->rcvbuf;
             break;
         case SO_PRIORITY:
             ret_optval.val = 0; /* default value in Linux */
@@ -2345,6 +3361,12 @@ static sysreturn netsock_getsockopt(struct sock *sock, int level,
         case SO_PROTOCOL:
             ret_optval.val = s->sock.type == SOCK_STREAM ? IP_PROTO_TCP : IP_PROTO_UDP;
             break;
+        case SO_BUSY_POLL:
+            ret_optval.val = s->busy_poll;
+            break;
+        case SO_ZEROCOPY:
+            ret_optval.val = (s->sock.type == SOCK_STREAM) && s->info.tcp.zerocopy;
+            break;
         default:
             goto unimplemented;
         }
@@ -2378,6 +3400,22 @@ static sysreturn netsock_getsockopt(struct sock *sock, int level,
             goto unimplemented;
         }
         break;
+    case SOL_UDP:
+        if (s->sock.type != SOCK_DGRAM) {
+            rv = -EOPNOTSUPP;
+            goto out;
+        }
+        switch (optname) {
+        case UDP_SEGMENT:
+            ret_optval.val = s->info.udp.gso_size;
+            break;
+        case UDP_GRO:
+            ret_optval.val = s->info.udp.gro;
+            break;
+        default:
+            goto unimplemented;
+        }
+        break;
     case IPPROTO_IPV6:
         switch (optname) {
         case IPV6_V6ONLY:
@@ -2462,6 +3500,13 @@ boolean netsyscall_init(unix_heaps uh, tuple cfg)
     else
         so_rcvbuf = DEFAULT_SO_RCVBUF;
     kernel_heaps kh = (kernel_heaps)uh;
+    if (!get_u64(cfg, sym(tcp_autotune_mem), &tcp_autotune_limit))
+        tcp_autotune_limit = heap_total((heap)heap_physical(kh)) / 16;
+    u64 usecs;
+    if (get_u64(cfg, sym(busy_read), &usecs))
+        busy_read_usecs = MIN(usecs, U32_MAX);
+    if (get_u64(cfg, sym(busy_poll), &usecs))
+        busy_poll_usecs = MIN(usecs, U32_MAX);
     caching_heap socket_cache = allocate_objcache(heap_general(kh), (heap)heap_linear_backed(kh),
                                                   sizeof(struct netsock), PAGESIZE, true);
     if (socket_cache == INVALID_ADDRESS)
@@ -203,6 +203,7 @@ static boolean invoke_handlers_for_vector(cpuinfo ci, int v)
 void trap_interrupt(void)
 {
     cpuinfo ci = current_cpu();
+    cpu_clear_idle(ci);
     context ctx = get_current_context(ci);
     context_frame f = ctx->frame;
     u64 v = SCAUSE_CODE(f[FRAME_CAUSE]);
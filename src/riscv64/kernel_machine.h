@@ -206,6 +206,11 @@ static inline u64 frame_fault_pc(context_frame f)
     return f[FRAME_PC];
 }
 
+static inline u64 *frame_get_fp(context_frame f)
+{
+    return pointer_from_u64(f[FRAME_FP]);
+}
+
 static inline u64 frame_fault_address(context_frame f)
 {
     return f[FRAME_FAULT_ADDRESS];
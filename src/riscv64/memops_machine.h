@@ -0,0 +1,2 @@
+/* No architecture-specific memory operations; runtime memops use the generic
+   word loops. */
@@ -59,6 +59,7 @@ caching_heap allocate_objcache_preallocated(heap meta, heap parent, bytes objsiz
 boolean objcache_validate(heap h);
 heap objcache_from_object(u64 obj, bytes parent_pagesize);
 heap allocate_mcache(heap meta, heap parent, int min_order, int max_order, bytes pagesize);
+bytes mcache_drain(heap h, bytes len, bytes retain);
 heap reserve_heap_wrapper(heap meta, heap parent, bytes reserved);
 
 // really internals
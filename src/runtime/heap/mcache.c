@@ -197,6 +197,25 @@ static u64 mcache_total(heap h)
     return sum;
 }
 
+/* Release completely free pages of the child objcaches to the parent,
+   keeping at least retain bytes of free objects in each cache. Not
+   synchronized; the caller must hold whatever lock protects the mcache. */
+bytes mcache_drain(heap h, bytes len, bytes retain)
+{
+    bytes drained = 0;
+#if !(defined(MEMDEBUG_MCACHE) || defined(MEMDEBUG_ALL))
+    heap o;
+    vector_foreach(((mcache)h)->caches, o) {
+        if (!o)
+            continue;
+        drained += cache_drain((caching_heap)o, len - drained, retain);
+        if (drained >= len)
+            break;
+    }
+#endif
+    return drained;
+}
+
 closure_function(2, 0, value, mcache_get_allocated,
                  mcache, m, value, v)
 {
@@ -1,4 +1,17 @@
 #include <runtime.h>
+#include <memops_machine.h>
+
+#ifdef ARCH_MEMOPS
+/* Until init_memops() runs, e.g. in early boot, the generic code is used. */
+BSS_RO_AFTER_INIT static u32 memops_features;
+#endif
+
+void init_memops(void)
+{
+#ifdef ARCH_MEMOPS
+    memops_features = arch_memops_features();
+#endif
+}
 
 /* Copy by advancing memory addresses in forward direction. */
 static inline void memcpyf_8(void *dst, const void *src, bytes len)
@@ -45,6 +58,12 @@ void runtime_memcpy(void *a, const void *b, bytes len)
     unsigned long long_word1;
     unsigned long long_word2;
 
+#ifdef ARCH_MEMOPS
+    /* a forward copy is fine unless the destination overlaps the end of the source */
+    if ((((unsigned long)a <= (unsigned long)b) || ((unsigned long)a >= (unsigned long)b + len)) &&
+        arch_memcpy(a, b, len, memops_features))
+        return;
+#endif
     if ((unsigned long)a < (unsigned long)b) {
         if (len < sizeof(long)) {
             memcpyf_8(a, b, len);
@@ -126,6 +145,10 @@ void runtime_memcpy(void *a, const void *b, bytes len)
 
 void runtime_memset(u8 *a, u8 b, bytes len)
 {
+#ifdef ARCH_MEMOPS
+    if (arch_memset(a, b, len, memops_features))
+        return;
+#endif
     if (len < sizeof(long)) {
         memset_8(a, b, len);
         return;
@@ -184,7 +207,7 @@ int runtime_memcmp(const void *a, const void *b, bytes len)
         while (long_len-- > 0) {
             res = *p_long_a++ - *p_long_b++;
             if (res) {
-                return 1;
+                goto word_differs;
             }
         }
     }
@@ -197,10 +220,14 @@ int runtime_memcmp(const void *a, const void *b, bytes len)
             res = ((long_word1 >> (8 * (sizeof(long) - alignment))) |
                     (long_word2 << (8 * alignment))) - *p_long_b++;
             if (res) {
-                return 1;
+                goto word_differs;
             }
             long_word1 = long_word2;
         }
     }
     return memcmp_8(a + len - end_len, p_long_b, end_len);
+  word_differs:
+    /* compare the differing word byte by byte to get the ordering */
+    p_long_b--;
+    return memcmp_8(a + ((u8 *)p_long_b - (u8 *)b), p_long_b, sizeof(long));
 }
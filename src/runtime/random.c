@@ -110,7 +110,7 @@ chacha20_randomstir_locked(struct chacha20_s *chacha20, timestamp t)
 void init_random(heap h)
 {
 #ifdef KERNEL
-    chacha20inst.m = allocate_mutex(h, 2048);
+    chacha20inst.m = allocate_mutex_class(h, 2048, "random");
     assert(chacha20inst.m != INVALID_ADDRESS);
 #endif
     assert(CHACHA20_KEYBYTES*8 >= CHACHA_MINKEYLEN);
@@ -70,6 +70,8 @@ void runtime_memset(u8 *a, u8 b, bytes len);
 
 int runtime_memcmp(const void *a, const void *b, bytes len);
 
+void init_memops(void);
+
 static inline int runtime_strlen(const char *a)
 {
     int i = 0;
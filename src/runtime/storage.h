@@ -91,8 +91,17 @@ declare_closure_struct(2, 1, void, storage_simple_req_handler,
                        storage_req, req);
 storage_req_handler storage_init_req_handler(closure_ref(storage_simple_req_handler, handler),
                                              block_io read, block_io write);
+#ifdef CONFIG_TRACELOG
+void storage_trace_req(storage_req req);
+#endif
+
+storage_req_handler storage_queue_attach(storage_req_handler driver, int attach_id);
+void storage_set_limits(storage_req_handler driver, u64 max_bytes, u32 max_segs);
+void storage_plug(void);
+void storage_unplug(void);
 
 void init_volumes(heap h);
+void init_storage_management(tuple root);
 void storage_set_root_fs(struct filesystem *root_fs);
 void storage_set_mountpoints(tuple mounts);
 boolean volume_add(u8 *uuid, char *label, storage_req_handler req_handler, u64 size, int attach_id);
@@ -162,7 +162,7 @@ timerqueue allocate_timerqueue(heap h, clock_now now, const char *name)
     tq->now = now;
     tq->name = name;
 #ifdef KERNEL
-    spin_lock_init(&tq->lock);
+    spin_lock_init_class(&tq->lock, "timerqueue");
     tq->service_scheduled = tq->update = false;
     tq->empty = true;
     tq->next_expiry = 0;
@@ -279,37 +279,57 @@ value decode_value(heap h, table dictionary, buffer source, u64 *total,
     }
 }
 
-void encode_symbol(buffer dest, table dictionary, symbol s)
+/* With record false, the dictionary is only read (so that encoders may share
+   it), and encoding fails if a new dictionary entry would be needed; dest is
+   then left partially written. */
+static boolean encode_symbol_internal(buffer dest, table dictionary, symbol s, boolean record)
 {
     u64 ind;
     if ((ind = u64_from_pointer(table_find(dictionary, s)))) {
         push_header(dest, reference, type_buffer, ind);
     } else {
+        if (!record)
+            return false;
         buffer sb = symbol_string(s);
         push_header(dest, immediate, type_buffer, buffer_length(sb));
         assert(push_buffer(dest, sb));
         srecord(dictionary, s);
     }
+    return true;
 }
 
-void encode_tuple(buffer dest, table dictionary, tuple t, u64 *total);
-void encode_value(buffer dest, table dictionary, value v, u64 *total)
+void encode_symbol(buffer dest, table dictionary, symbol s)
+{
+    encode_symbol_internal(dest, dictionary, s, true);
+}
+
+static boolean encode_tuple_internal(buffer dest, table dictionary, tuple t, u64 *total,
+                                     boolean record);
+
+static boolean encode_value_internal(buffer dest, table dictionary, value v, u64 *total,
+                                     boolean record)
 {
     if (!v) {
         push_header(dest, immediate, type_buffer, 0);
     }
     else if (is_tuple(v)) {
-        encode_tuple(dest, dictionary, (tuple)v, total);
+        return encode_tuple_internal(dest, dictionary, (tuple)v, total, record);
     } else {
         push_header(dest, immediate, type_buffer, buffer_length((buffer)v));
         assert(push_buffer(dest, (buffer)v));
     }
+    return true;
+}
+
+void encode_value(buffer dest, table dictionary, value v, u64 *total)
+{
+    encode_value_internal(dest, dictionary, v, total, true);
 }
 
 // could close over encoder!
 // these are special cases of a slightly more general scheme
-void encode_eav(buffer dest, table dictionary, tuple e, symbol a, value v,
-                u64 *obsolete)
+static boolean encode_eav_internal(buffer dest, table dictionary, tuple e, symbol a, value v,
+                                   u64 *obsolete, boolean record)
 {
     // this can be push value really..dont need to assume that its already
     // been rooted - merge these two cases - maybe methodize the tuple interface
@@ -320,14 +340,17 @@ void encode_eav(buffer dest, table dictionary, tuple e, symbol a, value v,
         push_header(dest, reference, type_tuple, 1);
         push_varint(dest, d);
     } else {
+        if (!record)
+            return false;
         tuple_debug("encode_eav: e (%v) immediate at index 0x%lx\n",
                     e, dictionary->count + 1);
         push_header(dest, immediate, type_tuple, 1);
         srecord(dictionary, e);
     }
     tuple_debug("   encoding symbol \"%b\" with value %v\n", symbol_string(a), v);
-    encode_symbol(dest, dictionary, a);
-    encode_value(dest, dictionary, v, 0);
+    if (!encode_symbol_internal(dest, dictionary, a, record) ||
+        !encode_value_internal(dest, dictionary, v, 0, record))
+        return false;
     if (obsolete) {
         value old_v = get(e, a);
         if (old_v) {
@@ -336,6 +359,19 @@ void encode_eav(buffer dest, table dictionary, tuple e, symbol a, value v,
                 (*obsolete)++;
         }
     }
+    return true;
+}
+
+void encode_eav(buffer dest, table dictionary, tuple e, symbol a, value v,
+                u64 *obsolete)
+{
+    encode_eav_internal(dest, dictionary, e, a, v, obsolete, true);
+}
+
+boolean encode_eav_existing(buffer dest, table dictionary, tuple e, symbol a, value v,
+                            u64 *obsolete)
+{
+    return encode_eav_internal(dest, dictionary, e, a, v, obsolete, false);
 }
 
 static boolean no_encode(value v)
@@ -352,22 +388,24 @@ closure_function(1, 2, boolean, encode_tuple_count_each,
     return true;
 }
 
-closure_function(3, 2, boolean, encode_tuple_each,
-                 buffer, dest, table, dictionary, u64 *, total,
+closure_function(4, 2, boolean, encode_tuple_each,
+                 buffer, dest, table, dictionary, u64 *, total, boolean, record,
                  value, s, value, v)
 {
     assert(is_symbol(s));
     tuple_debug("   s %b, v %p, tag %d\n", symbol_string(s), v, tagof(v));
     if (no_encode(v))
         return true;
-    encode_symbol(bound(dest), bound(dictionary), s);
-    encode_value(bound(dest), bound(dictionary), v, bound(total));
+    if (!encode_symbol_internal(bound(dest), bound(dictionary), s, bound(record)) ||
+        !encode_value_internal(bound(dest), bound(dictionary), v, bound(total), bound(record)))
+        return false;
     if (bound(total))
         (*bound(total))++;
     return true;
 }
 
-void encode_tuple(buffer dest, table dictionary, tuple t, u64 *total)
+static boolean encode_tuple_internal(buffer dest, table dictionary, tuple t, u64 *total,
+                                     boolean record)
 {
     tuple_debug("%s: dest %p, dictionary %p, tuple %p\n", __func__, dest, dictionary, t);
     u64 d = u64_from_pointer(table_find(dictionary, t));
@@ -377,10 +415,22 @@ void encode_tuple(buffer dest, table dictionary, tuple t, u64 *total)
         push_header(dest, reference, type_tuple, count);
         push_varint(dest, d);
     } else {
+        if (!record)
+            return false;
         push_header(dest, immediate, type_tuple, count);
         srecord(dictionary, t);
     }
-    iterate(t, stack_closure(encode_tuple_each, dest, dictionary, total));
+    return iterate(t, stack_closure(encode_tuple_each, dest, dictionary, total, record));
+}
+
+void encode_tuple(buffer dest, table dictionary, tuple t, u64 *total)
+{
+    encode_tuple_internal(dest, dictionary, t, total, true);
+}
+
+boolean encode_tuple_existing(buffer dest, table dictionary, tuple t, u64 *total)
+{
+    return encode_tuple_internal(dest, dictionary, t, total, false);
 }
 
 void deallocate_value(tuple t)
@@ -37,6 +37,11 @@ void *decode_value(heap h, table dictionary, buffer source, u64 *total,
 void encode_eav(buffer dest, table dictionary, tuple e, symbol a, value v,
                 u64 *obsolete);
 
+/* encode without adding dictionary entries; false if one would be needed */
+boolean encode_tuple_existing(buffer dest, table dictionary, tuple t, u64 *total);
+boolean encode_eav_existing(buffer dest, table dictionary, tuple e, symbol a, value v,
+                            u64 *obsolete);
+
 static inline boolean is_tuple(value v)
 {
     value_tag tag = tagof(v);
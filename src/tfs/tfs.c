@@ -59,7 +59,160 @@ const char *string_from_fs_status(fs_status s)
 static tuple fs_tuple_from_inode(filesystem fs, inode n)
 {
     tuple t = pointer_from_u64(n);
-    return table_find(fs->files, t) ? t : 0;
+    filesystem_files_lock_shared(fs);
+    boolean found = (table_find(fs->files, t) != 0);
+    filesystem_files_unlock_shared(fs);
+    return found ? t : 0;
+}
+
+/* Called with fs unlocked; if inode number can be resolved, returns with fs locked shared for a
+   path lookup or namespace change. */
+static tuple fs_lock_inode(filesystem fs, inode n)
+{
+    filesystem_lock_shared(fs);
+    tuple t = fs_tuple_from_inode(fs, n);
+    if (!t)
+        filesystem_unlock_shared(fs);
+    return t;
+}
+
+/* Called with fs locked; returns the lock of node t, or 0 if t is not a node of fs. A regular file
+   is locked through its fsfile, a directory through its own lock, and any other node through the
+   node lock of the filesystem. */
+static void *fs_node_get_lock(filesystem fs, tuple t)
+{
+    filesystem_files_lock_shared(fs);
+    void *l = table_find(fs->files, t);
+#ifdef KERNEL
+    if (l == INVALID_ADDRESS) {
+        fsdir d = table_find(fs->dirs, t);
+        l = d ? &d->lock : &fs->node_lock;
+    } else if (l) {
+        l = &((fsfile)l)->lock;
+    }
+#endif
+    filesystem_files_unlock_shared(fs);
+    return l;
+}
+
+/* Called with fs locked shared; returns with node t locked, or 0 if t is not (or no longer) a node
+   of fs. The returned lock is to be released with fsnode_unlock(). */
+static void *fs_node_lock(filesystem fs, tuple t)
+{
+    void *l = fs_node_get_lock(fs, t);
+    if (l) {
+        fsnode_lock(l);
+
+        /* t may have been unlinked while waiting for the lock */
+        if (fs_node_get_lock(fs, t) != l) {
+            fsnode_unlock(l);
+            l = 0;
+        }
+    }
+    return l;
+}
+
+/* Called with fs locked shared; returns attribute a of node t, or 0 if t is no longer a node of
+   fs. */
+static value fs_node_get(filesystem fs, tuple t, symbol a)
+{
+    void *l = fs_node_lock(fs, t);
+    if (!l)
+        return 0;
+    value v = get(t, a);
+    fsnode_unlock(l);
+    return v;
+}
+
+static tuple fs_node_get_tuple(filesystem fs, tuple t, symbol a)
+{
+    value v = fs_node_get(fs, t, a);
+    return (v && is_tuple(v)) ? v : 0;
+}
+
+/* Called with fs locked shared; returns the entry named a in directory t. */
+static tuple fs_node_lookup(filesystem fs, tuple t, symbol a)
+{
+    void *l = fs_node_lock(fs, t);
+    if (!l)
+        return 0;
+    tuple n = lookup(t, a);
+    fsnode_unlock(l);
+    return n;
+}
+
+#ifndef TFS_READ_ONLY
+static void fs_node_unlock(filesystem fs, tuple t)
+{
+    fsnode_unlock(fs_node_get_lock(fs, t));
+}
+
+/* Called with fs locked shared: locks nodes n1 and n2 (either of which may be null) and then their
+   parent directory p, and checks that p still has them as entries s1 and s2 (a null node standing
+   for a missing entry). On success, the acquired locks are stored in locks, to be released with
+   fs_unlock_entries(). */
+static boolean fs_lock_entries(filesystem fs, tuple p, symbol s1, tuple n1, symbol s2, tuple n2,
+                               void *locks[3])
+{
+    void *a = n1 ? fs_node_get_lock(fs, n1) : 0;
+    void *b = n2 ? fs_node_get_lock(fs, n2) : 0;
+    if ((n1 && !a) || (n2 && !b))
+        return false;
+    if (b == a) {
+        b = 0;
+    } else if (!a || (b && (b < a))) {
+        void *l = a;
+        a = b;
+        b = l;
+    }
+    if (a)
+        fsnode_lock(a);
+    if (b)
+        fsnode_lock(b);
+    void *l = fs_node_lock(fs, p);
+    if (!l || (s1 && (lookup(p, s1) != n1)) || (s2 && (lookup(p, s2) != n2))) {
+        if (l)
+            fsnode_unlock(l);
+        if (b)
+            fsnode_unlock(b);
+        if (a)
+            fsnode_unlock(a);
+        return false;
+    }
+    locks[0] = l;
+    locks[1] = b;
+    locks[2] = a;
+    return true;
+}
+
+static void fs_unlock_entries(void *locks[3])
+{
+    for (int i = 0; i < 3; i++) {
+        if (locks[i])
+            fsnode_unlock(locks[i]);
+    }
+}
+#endif
+
+/* Called with fs locked shared, and with t (if not yet reachable from the namespace) or its parent
+   directory locked: makes t a node of fs, so that it can be looked up by inode number and locked. */
+static void fs_add_node(filesystem fs, tuple t, fsfile f)
+{
+#ifdef KERNEL
+    fsdir d = 0;
+    if (!f && children(t)) {
+        d = allocate(fs->h, sizeof(*d));
+        assert(d != INVALID_ADDRESS);
+        fsdir_lock_init(d);
+    }
+#endif
+    filesystem_files_lock(fs);
+    table_set(fs->files, t, f ? f : INVALID_ADDRESS);
+#ifdef KERNEL
+    if (d)
+        table_set(fs->dirs, t, d);
+#endif
+    filesystem_files_unlock(fs);
 }
 
 filesystem fsfile_get_fs(fsfile f)
@@ -89,6 +242,9 @@ u64 fsfile_get_blocks(fsfile f)
     rangemap_foreach(f->extentmap, n) {
         blocks += range_span(n->r);
     }
+    rangemap_foreach(f->delalloc, n) {
+        blocks += range_span(n->r);
+    }
     return blocks;
 }
 
@@ -241,25 +397,42 @@ static inline extent allocate_extent(heap h, range file_blocks, range storage_bl
 #define uninited_unlock(u)
 #endif
 
-u64 filesystem_allocate_storage(filesystem fs, u64 nblocks)
+/* called with the allocation lock held */
+static u64 fs_storage_alloc(filesystem fs, u64 nblocks)
 {
     if (fs->storage)
         return allocate_u64((heap)fs->storage, nblocks);
     return INVALID_PHYSICAL;
 }
 
+u64 filesystem_allocate_storage(filesystem fs, u64 nblocks)
+{
+    filesystem_alloc_lock(fs);
+    u64 start = fs_storage_alloc(fs, nblocks);
+    filesystem_alloc_unlock(fs);
+    return start;
+}
+
 boolean filesystem_reserve_storage(filesystem fs, range blocks)
 {
-    if (fs->storage)
-        return id_heap_set_area(fs->storage, blocks.start, range_span(blocks), true, true);
-    return true;
+    boolean success = true;
+    if (fs->storage) {
+        filesystem_alloc_lock(fs);
+        success = id_heap_set_area(fs->storage, blocks.start, range_span(blocks), true, true);
+        filesystem_alloc_unlock(fs);
+    }
+    return success;
 }
 
 boolean filesystem_free_storage(filesystem fs, range blocks)
 {
-    if (fs->storage)
-        return id_heap_set_area(fs->storage, blocks.start, range_span(blocks), true, false);
-    return true;
+    boolean success = true;
+    if (fs->storage) {
+        filesystem_alloc_lock(fs);
+        success = id_heap_set_area(fs->storage, blocks.start, range_span(blocks), true, false);
+        filesystem_alloc_unlock(fs);
+    }
+    return success;
 }
 
 void ingest_extent(fsfile f, symbol off, tuple value)
@@ -317,20 +490,27 @@ static boolean enumerate_dir_entries(filesystem fs, tuple t)
         fsfile f = allocate_fsfile(fs, t);
         if (f == INVALID_ADDRESS)
             return false;
-        table_set(fs->files, t, f);
         string filelength = get(t, sym(filelength));
         u64 len;
         if (filelength && u64_from_value(filelength, &len))
             fsfile_set_length(f, len);
         return iterate(extents, stack_closure(tfs_ingest_extent, f));
     }
-    table_set(fs->files, t, INVALID_ADDRESS);
+    fs_add_node(fs, t, 0);
     tuple c = children(t);
     if (c)
         return iterate(c, stack_closure(enumerate_dir_entries_each, fs));
     return true;
 }
 
+static void filesystem_storage_req(filesystem fs, storage_req req)
+{
+#if defined(KERNEL) && defined(CONFIG_TRACELOG)
+    storage_trace_req(req);
+#endif
+    apply(fs->req_handler, req);
+}
+
 void filesystem_storage_op(filesystem fs, sg_list sg, range blocks, boolean write,
                            status_handler completion)
 {
@@ -342,7 +522,7 @@ void filesystem_storage_op(filesystem fs, sg_list sg, range blocks, boolean writ
         .data = sg,
         .completion = completion,
     };
-    apply(fs->req_handler, &req);
+    filesystem_storage_req(fs, &req);
 }
 
 closure_function(2, 1, void, zero_blocks_complete,
@@ -392,7 +572,7 @@ void zero_blocks(filesystem fs, range blocks, merge m)
         .data = sg,
         .completion = zero_blocks_completion,
     };
-    apply(fs->req_handler, &req);
+    filesystem_storage_req(fs, &req);
 }
 
 /* called with uninited lock held */
@@ -469,11 +649,13 @@ closure_function(2, 3, void, filesystem_storage_read,
 
     /* read extent data and zero gaps */
     range blocks = range_rshift_pad(q, fs->blocksize_order);
-    filesystem_lock(fs);
+    filesystem_lock_shared(fs);
+    fsfile_lock(f);
     rangemap_range_lookup_with_gaps(f->extentmap, blocks,
                                     stack_closure(read_extent, fs, sg, m, blocks),
                                     stack_closure(zero_hole, fs, sg, blocks));
-    filesystem_unlock(fs);
+    fsfile_unlock(f);
+    filesystem_unlock_shared(fs);
     apply(k, STATUS_OK);
 }
 
@@ -525,8 +707,8 @@ void filesystem_read_entire(filesystem fs, tuple t, heap bufheap, buffer_handler
 {
     tfs_debug("filesystem_read_entire: t %p, bufheap %p, buffer_handler %p, status_handler %p\n",
               t, bufheap, c, sh);
-    fsfile f;
-    if (!(f = table_find(fs->files, t)) || (f == INVALID_ADDRESS)) {
+    fsfile f = fsfile_from_node(fs, t);
+    if (!f) {
         apply(sh, timm("result", "no such file %v", t,
                        "fsstatus", "%d", FS_STATUS_NOENT));
         return;
@@ -573,10 +755,18 @@ fs_status filesystem_write_eav(filesystem fs, tuple t, symbol a, value v)
         return FS_STATUS_NOSPACE;
 }
 
+static void fsfile_release_delalloc(fsfile f, range blocks);
+static void fsfile_set_prealloc(fsfile f, range r);
+
 static fs_status filesystem_truncate_locked(filesystem fs, fsfile f, u64 len)
 {
     if (fs->ro)
         return FS_STATUS_READONLY;
+    if (len < fsfile_get_length(f)) {
+        fsfile_release_delalloc(f, irange(pad(len, U64_FROM_BIT(fs->blocksize_order)) >>
+                                          fs->blocksize_order, infinity));
+        fsfile_set_prealloc(f, irange(0, 0));
+    }
     if (f->md) {
         value v = value_from_u64(fs->h, len);
         if (v == INVALID_ADDRESS)
@@ -604,20 +794,52 @@ static fs_status filesystem_truncate_locked(filesystem fs, fsfile f, u64 len)
 
 */
 
-static fs_status create_extent(filesystem fs, range blocks, boolean uninited, extent *ex)
+/* Allocate storage at goal if it is free, else at the first place past it
+   that fits, else anywhere. */
+static u64 filesystem_allocate_storage_near(filesystem fs, u64 nblocks, u64 goal)
+{
+    if (goal != INVALID_PHYSICAL) {
+        if ((goal + nblocks <= (fs->size >> fs->blocksize_order)) &&
+            filesystem_reserve_storage(fs, irangel(goal, nblocks)))
+            return goal;
+        filesystem_alloc_lock(fs);
+        u64 start_block = id_heap_alloc_subrange(fs->storage, nblocks, goal, infinity);
+        filesystem_alloc_unlock(fs);
+        if (start_block != INVALID_PHYSICAL)
+            return start_block;
+    }
+    return filesystem_allocate_storage(fs, nblocks);
+}
+
+/* If extra is non-zero, an additional *extra blocks are allocated
+   contiguously after the extent and left reserved for the caller; *extra is
+   zeroed if they could not be allocated. */
+static fs_status create_extent(filesystem fs, range blocks, boolean uninited, u64 goal,
+                               u64 *extra, extent *ex)
 {
     assert(!fs->ro);
     heap h = fs->h;
     u64 nblocks = MAX(range_span(blocks), MIN_EXTENT_SIZE >> fs->blocksize_order);
 
-    tfs_debug("create_extent: blocks %R, uninited %p, nblocks %ld\n", blocks, uninited, nblocks);
+    tfs_debug("create_extent: blocks %R, uninited %p, nblocks %ld, goal 0x%lx\n",
+              blocks, uninited, nblocks, goal);
     if (!filesystem_reserve_log_space(fs, &fs->next_extend_log_offset, 0, 0) ||
         !filesystem_reserve_log_space(fs, &fs->next_new_log_offset, 0, 0))
         return FS_STATUS_NOSPACE;
 
-    u64 start_block = filesystem_allocate_storage(fs, nblocks);
+    u64 start_block = INVALID_PHYSICAL;
+    if (extra && *extra) {
+        start_block = filesystem_allocate_storage_near(fs, nblocks + *extra, goal);
+        if (start_block == INVALID_PHYSICAL)
+            *extra = 0;
+    }
+    if (start_block == INVALID_PHYSICAL)
+        start_block = filesystem_allocate_storage_near(fs, nblocks, goal);
+    /* Space for writeback has been reserved already, so take any free area
+       rather than fail. */
+    u64 min_blocks = (uninited ? MIN_EXTENT_ALLOC_SIZE : MIN_EXTENT_SIZE) >> fs->blocksize_order;
     while (start_block == u64_from_pointer(INVALID_ADDRESS)) {
-        if (nblocks <= (MIN_EXTENT_ALLOC_SIZE >> fs->blocksize_order))
+        if (nblocks <= min_blocks)
             break;
         nblocks /= 2;
         start_block = filesystem_allocate_storage(fs, nblocks);
@@ -627,9 +849,14 @@ static fs_status create_extent(filesystem fs, range blocks, boolean uninited, ex
 
     range storage_blocks = irangel(start_block, nblocks);
     tfs_debug("   storage_blocks %R\n", storage_blocks);
+    /* if only a smaller area was free, the caller fills the rest of the range */
+    if (nblocks < range_span(blocks))
+        blocks.end = blocks.start + nblocks;
     *ex = allocate_extent(h, blocks, storage_blocks);
-    if (*ex == INVALID_ADDRESS)
+    if (*ex == INVALID_ADDRESS) {
+        filesystem_free_storage(fs, irangel(start_block, nblocks + (extra ? *extra : 0)));
         return FS_STATUS_NOMEM;
+    }
     (*ex)->md = 0;
     if (uninited)
         (*ex)->uninited = INVALID_ADDRESS;
@@ -646,6 +873,175 @@ static void destroy_extent(filesystem fs, extent ex)
     deallocate(fs->h, ex, sizeof(*ex));
 }
 
+/* Delayed allocation
+
+   A write only reserves space for the blocks it adds to a file, recording
+   them in f->delalloc. Storage is allocated when the pagecache writes the
+   data back, so that a contiguous dirty range gets a single extent placed
+   after the preceding one. A file being appended to also holds a
+   speculative preallocation of the storage following its last extent; it
+   lives in memory only, and later writebacks grow the extent into it. */
+
+/* called with the allocation lock held */
+static u64 fs_available_blocks(filesystem fs)
+{
+    u64 free = heap_free((heap)fs->storage);
+    return free > fs->delalloc_blocks ? free - fs->delalloc_blocks : 0;
+}
+
+static boolean fs_reserve_delalloc_blocks(filesystem fs, u64 n)
+{
+    filesystem_alloc_lock(fs);
+    boolean success = (n <= fs_available_blocks(fs));
+    if (success)
+        fs->delalloc_blocks += n;
+    filesystem_alloc_unlock(fs);
+    return success;
+}
+
+static void fs_release_delalloc_blocks(filesystem fs, u64 n)
+{
+    filesystem_alloc_lock(fs);
+    fs->delalloc_blocks -= MIN(n, fs->delalloc_blocks);
+    filesystem_alloc_unlock(fs);
+}
+
+static void fsfile_set_prealloc(fsfile f, range r)
+{
+    filesystem fs = f->fs;
+    range old = f->prealloc;
+    f->prealloc = r;
+    if (range_span(old))
+        filesystem_free_storage(fs, old);
+    filesystem_alloc_lock(fs);
+    fs->prealloc_blocks += range_span(r) - range_span(old);
+    filesystem_alloc_unlock(fs);
+}
+
+/* Called with f locked. Files in use on other cpus are skipped rather than
+   waited for. */
+static void filesystem_release_prealloc(filesystem fs, fsfile locked)
+{
+    tfs_debug("%s: %ld blocks\n", __func__, fs->prealloc_blocks);
+    fsfile_set_prealloc(locked, irange(0, 0));
+    filesystem_files_lock_shared(fs);
+    table_foreach(fs->files, t, f) {
+        (void)t;
+        if (f == INVALID_ADDRESS || f == locked || !fsfile_trylock((fsfile)f))
+            continue;
+        fsfile_set_prealloc(f, irange(0, 0));
+        fsfile_unlock((fsfile)f);
+    }
+    filesystem_files_unlock_shared(fs);
+}
+
+/* Size the preallocation for an append after the given blocks in
+   proportion to the file length. */
+static u64 fsfile_prealloc_blocks(fsfile f, range blocks)
+{
+    filesystem fs = f->fs;
+    u64 file_blocks = pad(fsfile_get_length(f), U64_FROM_BIT(fs->blocksize_order)) >>
+        fs->blocksize_order;
+    if (blocks.end < file_blocks)
+        return 0;   /* not an append */
+    u64 n = MIN(MAX(file_blocks, MIN_EXTENT_ALLOC_SIZE >> fs->blocksize_order),
+                MAX_EXTENT_PREALLOC_SIZE >> fs->blocksize_order);
+    /* leave ample room for reserved writes and other files */
+    filesystem_alloc_lock(fs);
+    u64 available = fs_available_blocks(fs);
+    filesystem_alloc_unlock(fs);
+    return available / 4 >= n ? n : 0;
+}
+
+/* Reserve storage blocks r for a file, consuming its preallocation if r
+   starts there. Returns the number of blocks reserved from r.start, which
+   is less than requested if only the preallocation was available. */
+static u64 fsfile_reserve_storage(fsfile f, range r)
+{
+    filesystem fs = f->fs;
+    u64 p = 0;
+    if (range_span(f->prealloc) && f->prealloc.start == r.start)
+        p = MIN(range_span(r), range_span(f->prealloc));
+    u64 n = p;
+    if (range_span(r) > p && filesystem_reserve_storage(fs, irange(r.start + p, r.end)))
+        n = range_span(r);
+    f->prealloc.start += p;
+    filesystem_alloc_lock(fs);
+    fs->prealloc_blocks -= p;
+    filesystem_alloc_unlock(fs);
+    return n;
+}
+
+closure_function(2, 1, boolean, delalloc_gap,
+                 fsfile, f, u64 *, needed,
+                 range, r)
+{
+    fsfile f = bound(f);
+    u64 *needed = bound(needed);
+    if (!needed)
+        return rangemap_insert_range(f->delalloc, r);
+    u64 n = range_span(r);
+    struct rmnode k;
+    k.r = r;
+    rangemap_foreach_of_range(f->delalloc, d, &k)
+        n -= range_span(range_intersection(d->r, r));
+    *needed += n;
+    return true;
+}
+
+/* Reserve space for a write of q, accounting for blocks not yet covered by
+   extents or a prior reservation. */
+static fs_status fsfile_reserve_delalloc(fsfile f, range q)
+{
+    filesystem fs = f->fs;
+    range blocks = range_rshift_pad(q, fs->blocksize_order);
+    u64 needed = 0;
+    rangemap_range_find_gaps(f->extentmap, blocks, stack_closure(delalloc_gap, f, &needed));
+    if (needed == 0)
+        return FS_STATUS_OK;
+    if (!fs_reserve_delalloc_blocks(fs, needed)) {
+        filesystem_release_prealloc(fs, f);
+        if (!fs_reserve_delalloc_blocks(fs, needed))
+            return FS_STATUS_NOSPACE;
+    }
+    if (rangemap_range_find_gaps(f->extentmap, blocks,
+                                 stack_closure(delalloc_gap, f, 0)) == RM_ABORT) {
+        fs_release_delalloc_blocks(fs, needed);
+        return FS_STATUS_NOMEM;
+    }
+    tfs_debug("%s: f %p, blocks %R, reserved %ld, total %ld\n", __func__, f, blocks,
+              needed, fs->delalloc_blocks);
+    return FS_STATUS_OK;
+}
+
+/* Drop the reservation for blocks which have been allocated or discarded. */
+static void fsfile_release_delalloc(fsfile f, range blocks)
+{
+    filesystem fs = f->fs;
+    struct rmnode k;
+    k.r = blocks;
+    u64 released = 0;
+    rangemap_foreach_of_range(f->delalloc, n, &k) {
+        released += range_span(range_intersection(n->r, blocks));
+        range d1, d2;
+        range_difference(n->r, blocks, &d1, &d2);
+        if (range_span(d1) && range_span(d2)) {
+            /* the only intersecting node */
+            rmnode_set_range(n, d1);
+            rangemap_insert_range(f->delalloc, d2);
+            break;
+        }
+        if (range_span(d1))
+            rmnode_set_range(n, d1);
+        else if (range_span(d2))
+            rmnode_set_range(n, d2);
+        else
+            rangemap_remove_range(f->delalloc, n);
+    }
+    if (released)
+        fs_release_delalloc_blocks(fs, released);
+}
+
 static fs_status add_extent_to_file(fsfile f, extent ex)
 {
     if (f->md) {
@@ -707,7 +1103,7 @@ static fs_status add_extents(filesystem fs, range i, rangemap rm)
     extent ex;
     fs_status fss;
     while (range_span(i)) {
-        fss = create_extent(fs, i, true, &ex);
+        fss = create_extent(fs, i, true, INVALID_PHYSICAL, 0, &ex);
         if (fss != FS_STATUS_OK)
             return fss;
         assert(rangemap_insert(rm, &ex->node));
@@ -849,16 +1245,37 @@ static u64 write_extent(fsfile f, extent ex, sg_list sg, range blocks, merge m)
 static fs_status fill_gap(fsfile f, sg_list sg, range blocks, merge m, u64 *edge)
 {
     tfs_debug("   %s: writing new extent blocks %R\n", __func__, blocks);
+    filesystem fs = f->fs;
+    u64 goal = INVALID_PHYSICAL;
+    u64 extra = 0;
+    if (m) {
+        /* allocating at writeback: continue on from the preceding extent */
+        rmnode prev = rangemap_lookup_max_lte(f->extentmap, blocks.start);
+        if (prev != INVALID_ADDRESS) {
+            extent pex = (extent)prev;
+            goal = pex->start_block + MAX(pex->allocated, blocks.start - prev->r.start);
+        }
+        extra = fsfile_prealloc_blocks(f, blocks);
+    }
     extent ex;
-    fs_status fss = create_extent(f->fs, blocks, m ? false : true, &ex);
+    fs_status fss = create_extent(fs, blocks, m ? false : true, goal, &extra, &ex);
+    if (fss == FS_STATUS_NOSPACE && fs->prealloc_blocks) {
+        filesystem_release_prealloc(fs, f);
+        fss = create_extent(fs, blocks, m ? false : true, goal, 0, &ex);
+        extra = 0;
+    }
     if (fss != FS_STATUS_OK)
         return fss;
     blocks = ex->node.r;
     fss = add_extent_to_file(f, ex);
     if (fss != FS_STATUS_OK) {
-        destroy_extent(f->fs, ex);
+        if (extra)
+            filesystem_free_storage(fs, irangel(ex->start_block + ex->allocated, extra));
+        destroy_extent(fs, ex);
         return fss;
     }
+    if (extra)
+        fsfile_set_prealloc(f, irangel(ex->start_block + ex->allocated, extra));
     if (m)
         write_extent(f, ex, sg, blocks, m);
     *edge = blocks.end;
@@ -905,6 +1322,20 @@ static fs_status update_extent_length(fsfile f, extent ex, u64 new_length)
     return FS_STATUS_OK;
 }
 
+/* Once an appending file has used up its preallocation, preallocate again
+   past its grown last extent, at the size its length now calls for. */
+static void fsfile_renew_prealloc(fsfile f, extent ex, range blocks)
+{
+    filesystem fs = f->fs;
+    if (range_span(f->prealloc))
+        return;
+    u64 n = fsfile_prealloc_blocks(f, blocks);
+    range r = irangel(ex->start_block + ex->allocated, n);
+    if (n && (r.end <= (fs->size >> fs->blocksize_order)) &&
+        filesystem_reserve_storage(fs, r))
+        fsfile_set_prealloc(f, r);
+}
+
 static fs_status extend(fsfile f, extent ex, sg_list sg, range blocks, merge m, u64 *edge)
 {
     u64 free = ex->allocated - range_span(ex->node.r);
@@ -912,12 +1343,17 @@ static fs_status extend(fsfile f, extent ex, sg_list sg, range blocks, merge m,
     if (blocks.end > r.end) {
         filesystem fs = f->fs;
         range new = irange(ex->start_block + ex->allocated,
-                           MIN(ex->start_block + blocks.end, fs->size >> fs->blocksize_order));
-        if (range_span(new) && filesystem_reserve_storage(fs, new)) {
-            fs_status s = update_extent_allocated(f, ex, ex->allocated + range_span(new));
+                           MIN(ex->start_block + (blocks.end - ex->node.r.start),
+                               fs->size >> fs->blocksize_order));
+        u64 n = range_span(new) ? fsfile_reserve_storage(f, new) : 0;
+        if (n > 0) {
+            new.end = new.start + n;
+            fs_status s = update_extent_allocated(f, ex, ex->allocated + n);
             if (s == FS_STATUS_OK) {
-                r.end = blocks.end;
+                r.end = ex->node.r.start + ex->allocated;
                 free = r.end - ex->node.r.end;
+                if (m)
+                    fsfile_renew_prealloc(f, ex, blocks);
             } else {
                 filesystem_free_storage(fs, new);
             }
@@ -1018,6 +1454,10 @@ static status extents_range_handler(filesystem fs, fsfile f, range q, sg_list sg
         assert(blocks.start <= blocks.end); // XXX tmp
     } while (range_span(blocks) > 0);
 
+    /* the range is now either allocated or zeroed */
+    if (m)
+        fsfile_release_delalloc(f, range_rshift_pad(q, fs->blocksize_order));
+
     if (fsfile_get_length(f) < q.end) {
         tfs_debug("   append; update length to %ld\n", q.end);
         fs_status fss = filesystem_truncate_locked(fs, f, q.end);
@@ -1036,9 +1476,17 @@ closure_function(2, 1, status, filesystem_check_or_reserve_extent,
     tfs_debug("%s: file %p range %R\n", __func__, f, q);
     if (fs->ro)
        return timm("result", "read-only filesystem", "fsstatus", "%d", FS_STATUS_READONLY);
-    filesystem_lock(fs);
-    status s = extents_range_handler(fs, f, q, 0, 0);
-    filesystem_unlock(fs);
+    filesystem_lock_shared(fs);
+    fsfile_lock(f);
+    fs_status fss = fsfile_reserve_delalloc(f, q);
+    status s = STATUS_OK;
+    if (fss != FS_STATUS_OK)
+        s = timm("result", "unable to reserve space", "fsstatus", "%d", fss);
+    else if (fsfile_get_length(f) < q.end &&
+             (fss = filesystem_truncate_locked(fs, f, q.end)) != FS_STATUS_OK)
+        s = timm("result", "unable to set file length", "fsstatus", "%d", fss);
+    fsfile_unlock(f);
+    filesystem_unlock_shared(fs);
     return s;
 }
 
@@ -1059,9 +1507,11 @@ closure_function(2, 3, void, filesystem_storage_write,
     merge m = allocate_merge(fs->h, complete);
     status_handler sh = apply_merge(m);
 
-    filesystem_lock(fs);
+    filesystem_lock_shared(fs);
+    fsfile_lock(f);
     status s = extents_range_handler(fs, f, q, sg, m);
-    filesystem_unlock(fs);
+    fsfile_unlock(f);
+    filesystem_unlock_shared(fs);
     apply(sh, s);
 }
 
@@ -1100,11 +1550,13 @@ void filesystem_write_linear(fsfile f, void *src, range q, io_status_handler io_
 
 fs_status filesystem_truncate(filesystem fs, fsfile f, u64 len)
 {
-    filesystem_lock(fs);
+    filesystem_lock_shared(fs);
+    fsfile_lock(f);
     fs_status fss = filesystem_truncate_locked(fs, f, len);
     if (f->md)
-        fs_notify_modify(f->md);
-    filesystem_unlock(fs);
+        fs_notify_modify(fs, f->md);
+    fsfile_unlock(f);
+    filesystem_unlock_shared(fs);
     return fss;
 }
 
@@ -1124,9 +1576,9 @@ closure_function(3, 1, void, fs_cache_sync_complete,
     if (bound(flush_log)) {
         bound(flush_log) = false;
         filesystem fs = bound(fs);
-        filesystem_lock(fs);
+        filesystem_lock_shared(fs);    /* keeps fs->tl from being switched */
         log_flush(fs->tl, (status_handler)closure_self());
-        filesystem_unlock(fs);
+        filesystem_unlock_shared(fs);
         return;
     }
     struct storage_req req = {
@@ -1134,7 +1586,7 @@ closure_function(3, 1, void, fs_cache_sync_complete,
         .blocks = irange(0, 0),
         .completion = bound(completion),
     };
-    apply(bound(fs)->req_handler, &req);
+    filesystem_storage_req(bound(fs), &req);
     closure_finish();
 }
 
@@ -1148,16 +1600,25 @@ void filesystem_flush(filesystem fs, status_handler completion)
     pagecache_sync_volume(fs->pv, sh);
 }
 
+/* Rewrite the metadata log as a checkpoint followed by an empty tail. */
+void filesystem_compact_log(filesystem fs)
+{
+    log_compact(fs->tl, true);
+}
+
 void fsfile_flush(fsfile fsf, boolean datasync, status_handler completion)
 {
+    fsfile_lock(fsf);
     boolean flush_log = datasync ? (fsf->status & FSF_DIRTY_DATASYNC) : (fsf->status & FSF_DIRTY);
     status_handler sh = closure(fsf->fs->h, fs_cache_sync_complete, fsf->fs, completion, flush_log);
     if (sh == INVALID_ADDRESS) {
+        fsfile_unlock(fsf);
         apply(completion, timm("result", "failed to allocate closure"));
         return;
     }
     if (flush_log)
         fsf->status &= ~FSF_DIRTY;
+    fsfile_unlock(fsf);
     pagecache_sync_node(fsf->cache_node, sh);
 }
 
@@ -1241,7 +1702,8 @@ void filesystem_alloc(fsfile f, long offset, long len,
     assert(new_rm != INVALID_ADDRESS);
     fs_status status = FS_STATUS_OK;
 
-    filesystem_lock(fs);
+    filesystem_lock_shared(fs);
+    fsfile_lock(f);
     u64 lastedge = blocks.start;
     rmnode curr = rangemap_first_node(f->extentmap);
     while (curr != INVALID_ADDRESS) {
@@ -1275,7 +1737,8 @@ done:
     deallocate_rangemap(new_rm, (status == FS_STATUS_OK ?
                                  stack_closure(assert_no_node) :
                                  stack_closure(destroy_extent_node, fs)));
-    filesystem_unlock(fs);
+    fsfile_unlock(f);
+    filesystem_unlock_shared(fs);
     apply(completion, f, status);
 }
 
@@ -1332,14 +1795,14 @@ static fs_status fs_set_dir_entry(filesystem fs, tuple parent, symbol name_sym,
     }
     tuple c = children(parent);
     fs_status s = filesystem_write_eav(fs, c, name_sym, child);
+    if (child) {
+        /* Re-add reference to parent (before the child can be reached through it). */
+        fixup_directory(parent, child);
+    }
     if (s == FS_STATUS_OK) {
         set(c, name_sym, child);
         filesystem_update_mtime(fs, parent);
     }
-    if (child) {
-        /* Re-add reference to parent. */
-        fixup_directory(parent, child);
-    }
     return s;
 }
 
@@ -1360,10 +1823,14 @@ closure_function(1, 2, boolean, file_unlink_each,
     return true;
 }
 
-/* Called with fs locked, returns with fs unlocked. */
-static void file_unlink(filesystem fs, tuple t)
+/* Called with fs locked exclusively, or shared with t and its parent directory locked; returns
+ * the fsfile (if any) to be released after unlocking fs, as the fsfile deallocator needs to acquire
+ * the filesystem lock. */
+static fsfile file_unlink(filesystem fs, tuple t)
 {
+    filesystem_files_lock(fs);
     fsfile f = table_remove(fs->files, t);
+    filesystem_files_unlock(fs);
     if (f == INVALID_ADDRESS)   /* directory entry other than regular file */
         f = 0;
     if (f) {
@@ -1372,17 +1839,35 @@ static void file_unlink(filesystem fs, tuple t)
     fs_notify_release(t, false);
 
     /* If a tuple is not present in the filesystem log dictionary, it can (and should) be destroyed
-     * now (it won't be destroyed when the filesystem log is rebuilt). */
-    if (get(t, sym(no_encode)))
+     * now (it won't be destroyed when the filesystem log is rebuilt); this is only done with fs
+     * locked exclusively. The lock of a directory is freed along with its tuple. */
+    if (get(t, sym(no_encode))) {
+#ifdef KERNEL
+        fsdir d = table_remove(fs->dirs, t);
+        if (d)
+            deallocate(fs->h, d, sizeof(*d));
+#endif
         destruct_dir_entry(t);
-    else
+    } else {
         iterate(t, stack_closure(file_unlink_each, t));
+    }
+    return f;
+}
 
-    filesystem_unlock(fs);  /* the fsfile deallocator needs to acquire the lock */
-    if (f)
-        refcount_release(&f->refcount);
+#ifdef KERNEL
+/* Called with fs locked exclusively: frees the locks of removed directories. */
+static void fs_free_dir_locks(filesystem fs, boolean all)
+{
+    table_foreach(fs->dirs, t, d) {
+        if (all || !table_find(fs->files, t)) {
+            table_set(fs->dirs, t, 0);
+            deallocate(fs->h, d, sizeof(struct fsdir));
+        }
+    }
 }
+#endif
 
+/* Called with fs locked shared and parent locked. */
 fs_status do_mkentry(filesystem fs, tuple parent, const char *name, tuple entry,
                      boolean persistent)
 {
@@ -1398,12 +1883,12 @@ fs_status do_mkentry(filesystem fs, tuple parent, const char *name, tuple entry,
         s = FS_STATUS_OK;
     }
 
+    fixup_directory(parent, entry);
     if (s == FS_STATUS_OK) {
+        fs_add_node(fs, entry, 0);
         set(c, name_sym, entry);
-        table_set(fs->files, entry, INVALID_ADDRESS);
         fs_notify_create(entry, parent, name_sym);
     }
-    fixup_directory(parent, entry);
     return s;
 }
 
@@ -1411,9 +1896,8 @@ fs_status filesystem_mkentry(filesystem fs, tuple cwd, const char *fp, tuple ent
 {
     if (fs->ro)
         return FS_STATUS_READONLY;
-    filesystem_lock(fs);
+    filesystem_lock_shared(fs);
     tuple parent = cwd ? cwd : fs->root;
-    assert(children(parent));
 
     char *token, *rest;
     fs_status status = FS_STATUS_OK;
@@ -1428,6 +1912,12 @@ fs_status filesystem_mkentry(filesystem fs, tuple cwd, const char *fp, tuple ent
     /* find the folder we need to mkentry in */
     while ((token = runtime_strtok_r(rest, "/", &rest))) {
         boolean final = *rest == '\0';
+        void *l = fs_node_lock(fs, parent);
+        if (!l) {
+            status = FS_STATUS_NOENT;
+            break;
+        }
+        assert(children(parent));
         tuple t = lookup(parent, sym_this(token));
         if (!t) {
             if (!final) {
@@ -1436,12 +1926,14 @@ fs_status filesystem_mkentry(filesystem fs, tuple cwd, const char *fp, tuple ent
                     tuple dir = fs_new_entry(fs);
                     set(dir, sym(children), allocate_tuple());
                     status = do_mkentry(fs, parent, token, dir, persistent);
+                    fsnode_unlock(l);
                     if (status != FS_STATUS_OK)
                         break;
 
                     parent = dir;
                     continue;
                 }
+                fsnode_unlock(l);
 
                 msg_err("a path component (\"%s\") is missing\n", token);
                 status = FS_STATUS_NOENT;
@@ -1449,8 +1941,10 @@ fs_status filesystem_mkentry(filesystem fs, tuple cwd, const char *fp, tuple ent
             }
 
             status = do_mkentry(fs, parent, token, entry, persistent);
+            fsnode_unlock(l);
             break;
         }
+        fsnode_unlock(l);
 
         if (final) {
             msg_debug("final path component (\"%s\") already exists\n", token);
@@ -1458,7 +1952,7 @@ fs_status filesystem_mkentry(filesystem fs, tuple cwd, const char *fp, tuple ent
             break;
         }
 
-        if (!children(t)) {
+        if (!fs_node_get_tuple(fs, t, sym(children))) {
             msg_debug("a path component (\"%s\") is not a folder\n", token);
             status = FS_STATUS_NOTDIR;
             break;
@@ -1467,7 +1961,7 @@ fs_status filesystem_mkentry(filesystem fs, tuple cwd, const char *fp, tuple ent
         parent = t;
     }
 
-    filesystem_unlock(fs);
+    filesystem_unlock_shared(fs);
     deallocate(fs->h, fp_copy, fp_len + 1);
     return status;
 }
@@ -1484,7 +1978,7 @@ fs_status filesystem_mkdirpath(filesystem fs, tuple cwd, const char *fp,
 
 fs_status filesystem_mkdir(filesystem fs, inode cwd, const char *path)
 {
-    tuple cwd_t = filesystem_get_meta(fs, cwd);
+    tuple cwd_t = fs_lock_inode(fs, cwd);
     if (!cwd_t)
         return FS_STATUS_NOENT;
     tuple parent;
@@ -1497,18 +1991,29 @@ fs_status filesystem_mkdir(filesystem fs, inode cwd, const char *path)
         fss = FS_STATUS_NAMETOOLONG;
         goto out;
     }
-    tuple dir = fs_new_entry(fs);
-    set(dir, sym(children), allocate_tuple());
     symbol name_sym = intern(name);
-    fss = fs_set_dir_entry(fs, parent, name_sym, dir);
-    if (fss == FS_STATUS_OK) {
-        table_set(fs->files, dir, INVALID_ADDRESS);
-        fs_notify_create(dir, parent, name_sym);
+    void *l = fs_node_lock(fs, parent);
+    if (!l) {
+        fss = FS_STATUS_NOENT;
+        goto out;
+    }
+    if (lookup(parent, name_sym)) {
+        /* created concurrently */
+        fss = FS_STATUS_EXIST;
     } else {
-        destruct_dir_entry(dir);
+        tuple dir = fs_new_entry(fs);
+        set(dir, sym(children), allocate_tuple());
+        fss = fs_set_dir_entry(fs, parent, name_sym, dir);
+        if (fss == FS_STATUS_OK) {
+            fs_add_node(fs, dir, 0);
+            fs_notify_create(dir, parent, name_sym);
+        } else {
+            destruct_dir_entry(dir);
+        }
     }
+    fsnode_unlock(l);
   out:
-    filesystem_unlock(fs);
+    filesystem_unlock_shared(fs);
     filesystem_release(fs);
     return fss;
 }
@@ -1517,6 +2022,9 @@ fsfile allocate_fsfile(filesystem fs, tuple md);
 
 static void deallocate_fsfile(filesystem fs, fsfile f, rmnode_handler extent_destructor)
 {
+    fsfile_release_delalloc(f, irange(0, infinity));
+    deallocate_rangemap(f->delalloc, stack_closure(assert_no_node));
+    fsfile_set_prealloc(f, irange(0, 0));
     deallocate_rangemap(f->extentmap, extent_destructor);
     pagecache_deallocate_node(f->cache_node);
     deallocate(fs->h, f, sizeof(*f));
@@ -1530,11 +2038,57 @@ closure_function(1, 1, boolean, free_extent,
     return true;
 }
 
+/* Called with fs locked shared: creates a regular file in directory parent, and returns with it
+   locked. Returns FS_STATUS_EXIST, with nothing locked, if the entry has been created
+   concurrently. */
+static fs_status fs_create_file(filesystem fs, tuple parent, const char *path, tuple *n,
+                                fsfile *f)
+{
+    symbol name = sym_this(filename_from_path(path));
+    void *l = fs_node_lock(fs, parent);
+    if (!l)
+        return FS_STATUS_NOENT;
+    fs_status fss;
+    if (lookup(parent, name)) {
+        fss = FS_STATUS_EXIST;
+        goto out;
+    }
+    tuple t = fs_new_entry(fs);
+
+    /* 'make it a file' by adding an empty extents list */
+    set(t, sym(extents), allocate_tuple());
+
+    fsfile fsf = allocate_fsfile(fs, t);
+    if (fsf != INVALID_ADDRESS) {
+        fsfile_lock(fsf);   /* not yet reachable, so this does not wait */
+        fsfile_set_length(fsf, 0);
+        fss = fs_set_dir_entry(fs, parent, name, t);
+        if (fss != FS_STATUS_OK) {
+            fsfile_unlock(fsf);
+            filesystem_files_lock(fs);
+            table_set(fs->files, t, 0);
+            filesystem_files_unlock(fs);
+            deallocate_fsfile(fs, fsf, stack_closure(free_extent, fs));
+        } else {
+            fs_notify_create(t, parent, name);
+            *n = t;
+            *f = fsf;
+        }
+    } else {
+        fss = FS_STATUS_NOMEM;
+    }
+    if (fss != FS_STATUS_OK)
+        destruct_dir_entry(t);
+  out:
+    fsnode_unlock(l);
+    return fss;
+}
+
 fs_status filesystem_get_node(filesystem *fs, inode cwd, const char *path, boolean nofollow,
                               boolean create, boolean exclusive, boolean truncate, tuple *n,
                               fsfile *f)
 {
-    tuple cwd_t = filesystem_get_meta(*fs, cwd);
+    tuple cwd_t = fs_lock_inode(*fs, cwd);
     if (!cwd_t)
         return FS_STATUS_NOENT;
     tuple parent, t;
@@ -1545,54 +2099,47 @@ fs_status filesystem_get_node(filesystem *fs, inode cwd, const char *path, boole
     else
         fss = filesystem_resolve_cstring_follow(fs, cwd_t, path, &t, &parent);
     if (fss != FS_STATUS_OK) {
-        if (create) {
-            if (!parent) {
-                fss = FS_STATUS_NOENT;
-                goto out;
-            }
-            if ((*fs)->ro) {
-                fss = FS_STATUS_READONLY;
-                goto out;
-            }
-            t = fs_new_entry(*fs);
-
-            /* 'make it a file' by adding an empty extents list */
-            set(t, sym(extents), allocate_tuple());
-
-            fsf = allocate_fsfile(*fs, t);
-            if (fsf != INVALID_ADDRESS) {
-                fsfile_set_length(fsf, 0);
-                symbol name = sym_this(filename_from_path(path));
-                fss = fs_set_dir_entry(*fs, parent, name, t);
-                if (fss != FS_STATUS_OK) {
-                    table_set((*fs)->files, t, 0);
-                    deallocate_fsfile(*fs, fsf, stack_closure(free_extent, *fs));
-                } else {
-                    fs_notify_create(t, parent, name);
-                }
-            } else {
-                fss = FS_STATUS_NOMEM;
-            }
-            if (fss != FS_STATUS_OK)
-                destruct_dir_entry(t);
-
+        if (!create)
+            goto out;
+        if (!parent) {
+            fss = FS_STATUS_NOENT;
+            goto out;
         }
-    } else {
-        if (exclusive) {
-            fss = FS_STATUS_EXIST;
-        } else {
-            fsf = fsfile_from_node(*fs, t);
-            if (fsf && truncate)
-                fss = filesystem_truncate_locked(*fs, fsf, 0);
+        if ((*fs)->ro) {
+            fss = FS_STATUS_READONLY;
+            goto out;
         }
+        fss = fs_create_file(*fs, parent, path, &t, &fsf);
+        if (fss != FS_STATUS_EXIST)
+            goto out;
+        t = fs_node_lookup(*fs, parent, sym_this(filename_from_path(path)));
+        if (!t) {
+            fss = FS_STATUS_NOENT;
+            goto out;
+        }
+        fss = FS_STATUS_OK;
+    }
+    void *l = fs_node_lock(*fs, t);
+    if (!l) {
+        fss = FS_STATUS_NOENT;
+        goto out;
     }
+    if (exclusive) {
+        fss = FS_STATUS_EXIST;
+    } else {
+        fsf = fsfile_from_node(*fs, t);
+        if (fsf && truncate)
+            fss = filesystem_truncate_locked(*fs, fsf, 0);
+    }
+    if (fss != FS_STATUS_OK)
+        fsnode_unlock(l);
   out:
     if (fss == FS_STATUS_OK) {
         *n = t;
         if (f)
             *f = fsf;
     } else {
-        filesystem_unlock(*fs);
+        filesystem_unlock_shared(*fs);
         filesystem_release(*fs);
     }
 
@@ -1601,23 +2148,44 @@ fs_status filesystem_get_node(filesystem *fs, inode cwd, const char *path, boole
 
 void filesystem_put_node(filesystem fs, tuple n)
 {
-    filesystem_unlock(fs);
+    fs_node_unlock(fs, n);
+    filesystem_unlock_shared(fs);
     filesystem_release(fs);
 }
 
-/* Called with fs unlocked; if inode number can be resolved, returns with fs locked. */
+/* Called with fs unlocked; if inode number can be resolved, returns with the node locked for
+   reading and updating, and with fs locked shared so that operations on different nodes can run
+   concurrently. */
 tuple filesystem_get_meta(filesystem fs, inode n)
 {
-    filesystem_lock(fs);
-    tuple t = fs_tuple_from_inode(fs, n);
-    if (!t)
-        filesystem_unlock(fs);
+    filesystem_lock_shared(fs);
+    tuple t = pointer_from_u64(n);
+    if (!fs_node_lock(fs, t)) {
+        filesystem_unlock_shared(fs);
+        return 0;
+    }
     return t;
 }
 
 void filesystem_put_meta(filesystem fs, tuple n)
 {
-    filesystem_unlock(fs);
+    fs_node_unlock(fs, n);
+    filesystem_unlock_shared(fs);
+}
+
+/* Called with node n locked (see filesystem_get_meta()); returns the parent directory of n locked,
+   or 0 if n is the root of its filesystem or has been removed along with its parent. */
+tuple filesystem_get_parent(filesystem fs, tuple n)
+{
+    tuple p = get_tuple(n, sym_this(".."));
+    if (!p || (p == n) || !fs_node_lock(fs, p))
+        return 0;
+    return p;
+}
+
+void filesystem_put_parent(filesystem fs, tuple p)
+{
+    fs_node_unlock(fs, p);
 }
 
 /* Called with fs locked. */
@@ -1635,7 +2203,7 @@ fs_status filesystem_creat_unnamed(filesystem fs, fsfile *f)
 
 fs_status filesystem_symlink(filesystem fs, inode cwd, const char *path, const char *target)
 {
-    tuple cwd_t = filesystem_get_meta(fs, cwd);
+    tuple cwd_t = fs_lock_inode(fs, cwd);
     if (!cwd_t)
         return FS_STATUS_NOENT;
     tuple parent;
@@ -1650,31 +2218,83 @@ fs_status filesystem_symlink(filesystem fs, inode cwd, const char *path, const c
         fss = FS_STATUS_READONLY;
         goto out;
     }
-    tuple link = fs_new_entry(fs);
-    set(link, sym(linktarget), buffer_cstring(fs->h, target));
     symbol name = sym_this(filename_from_path(path));
-    fss = fs_set_dir_entry(fs, parent, name, link);
-    if (fss != FS_STATUS_OK) {
-        destruct_dir_entry(link);
+    void *l = fs_node_lock(fs, parent);
+    if (!l) {
+        fss = FS_STATUS_NOENT;
+        goto out;
+    }
+    if (lookup(parent, name)) {
+        fss = FS_STATUS_EXIST;
     } else {
-        table_set(fs->files, link, INVALID_ADDRESS);
-        fs_notify_create(link, parent, name);
+        tuple link = fs_new_entry(fs);
+        set(link, sym(linktarget), buffer_cstring(fs->h, target));
+        fss = fs_set_dir_entry(fs, parent, name, link);
+        if (fss != FS_STATUS_OK) {
+            destruct_dir_entry(link);
+        } else {
+            fs_add_node(fs, link, 0);
+            fs_notify_create(link, parent, name);
+        }
     }
+    fsnode_unlock(l);
   out:
-    filesystem_unlock(fs);
+    filesystem_unlock_shared(fs);
     filesystem_release(fs);
     return fss;
 }
 
+/* Returns the name of the entry a path resolves to, or 0 if it is too long. */
+static symbol fs_entry_name(const char *path)
+{
+    buffer name = little_stack_buffer(NAME_MAX + 1);
+    return dirname_from_path(name, path) ? intern(name) : 0;
+}
+
+/* Called with fs locked shared, and with the tuples resolved from a path: relocks fs exclusively,
+   and checks that the entries have not changed in the meantime. */
+static boolean fs_upgrade_lock(filesystem fs, tuple p1, symbol s1, tuple n1, tuple p2, symbol s2,
+                               tuple n2)
+{
+    filesystem_unlock_shared(fs);
+    filesystem_lock(fs);
+    return (table_find(fs->files, p1) && (lookup(p1, s1) == n1) &&
+            (!p2 || (table_find(fs->files, p2) && (lookup(p2, s2) == n2))));
+}
+
 fs_status filesystem_delete(filesystem fs, inode cwd, const char *path, boolean directory)
 {
-    tuple cwd_t = filesystem_get_meta(fs, cwd);
+    tuple cwd_t = fs_lock_inode(fs, cwd);
     if (!cwd_t)
         return FS_STATUS_NOENT;
     tuple parent, t;
+    void *locks[3] = {0};
+    boolean exclusive = false;
+    fsfile f = 0;
     fs_status fss = filesystem_resolve_cstring(&fs, cwd_t, path, &t, &parent);
     if (fss != FS_STATUS_OK)
         goto out;
+    symbol name = fs_entry_name(path);
+    if (!name) {
+        fss = FS_STATUS_NAMETOOLONG;
+        goto out;
+    }
+    if ((name == sym_this(".")) || (name == sym_this(".."))) {
+        fss = directory ? FS_STATUS_INVAL : FS_STATUS_ISDIR;
+        goto out;
+    }
+
+    /* A non-persistent entry is destroyed when removed, which requires exclusive access. */
+    if (fs_node_get(fs, t, sym(no_encode))) {
+        exclusive = true;
+        if (!fs_upgrade_lock(fs, parent, name, t, 0, 0, 0)) {
+            fss = FS_STATUS_NOENT;
+            goto out;
+        }
+    } else if (!fs_lock_entries(fs, parent, name, t, 0, 0, locks)) {
+        fss = FS_STATUS_NOENT;
+        goto out;
+    }
     tuple c = children(t);
     if (directory) {
         if (!c) {
@@ -1696,16 +2316,19 @@ fs_status filesystem_delete(filesystem fs, inode cwd, const char *path, boolean
         fss = FS_STATUS_READONLY;
         goto out;
     }
-    symbol name = sym_this(filename_from_path(path));
     fss = fs_set_dir_entry(fs, parent, name, 0);
     if (fss == FS_STATUS_OK) {
         fs_notify_delete(t, parent, name);
-        file_unlink(fs, t);
-        goto release;
+        f = file_unlink(fs, t);
     }
   out:
-    filesystem_unlock(fs);
-  release:
+    fs_unlock_entries(locks);
+    if (exclusive)
+        filesystem_unlock(fs);
+    else
+        filesystem_unlock_shared(fs);
+    if (f)
+        refcount_release(&f->refcount);
     filesystem_release(fs);
     return fss;
 }
@@ -1716,11 +2339,14 @@ fs_status filesystem_rename(filesystem oldfs, inode oldwd, const char *oldpath,
 {
     if (!oldpath[0] || !newpath[0])
         return FS_STATUS_NOENT;
-    tuple oldwd_t = filesystem_get_meta(oldfs, oldwd);
+    tuple oldwd_t = fs_lock_inode(oldfs, oldwd);
     if (!oldwd_t)
         return FS_STATUS_NOENT;
     tuple old, oldparent;
     filesystem fs_to_unlock;
+    void *locks[3] = {0};
+    boolean exclusive = false;
+    fsfile f = 0;
     fs_status s = filesystem_resolve_cstring(&oldfs, oldwd_t, oldpath, &old, &oldparent);
     if (s != FS_STATUS_OK) {
         fs_to_unlock = oldfs;
@@ -1728,8 +2354,8 @@ fs_status filesystem_rename(filesystem oldfs, inode oldwd, const char *oldpath,
         goto out;
     }
     if (newfs != oldfs) {
-        filesystem_unlock(oldfs);
-        filesystem_lock(newfs);
+        filesystem_unlock_shared(oldfs);
+        filesystem_lock_shared(newfs);
     }
     tuple newwd_t = fs_tuple_from_inode(newfs, newwd);
     if (!newwd_t) {
@@ -1755,14 +2381,32 @@ fs_status filesystem_rename(filesystem oldfs, inode oldwd, const char *oldpath,
         s = FS_STATUS_READONLY;
         goto out;
     }
-    /* oldfs may have been unlocked in the process of resolving newpath, so check (now that the
-     * filesystem is locked again) whether previously found tuples are still valid. */
-    if (!table_find(oldfs->files, old) || !table_find(oldfs->files, oldparent)) {
+    symbol old_s = fs_entry_name(oldpath);
+    symbol new_s = fs_entry_name(newpath);
+    if (!old_s || !new_s) {
+        s = FS_STATUS_NAMETOOLONG;
+        goto out;
+    }
+
+    /* oldfs may have been unlocked in the process of resolving newpath, so the entries are checked
+     * again once locked. Moving an entry to another directory, or moving a directory (whose
+     * subtree is rewritten to the log), requires exclusive access, as does replacing a
+     * non-persistent entry (which is destroyed); entries are otherwise renamed with only the
+     * directory and the renamed nodes locked. */
+    if ((oldparent != newparent) || fs_node_get(oldfs, old, sym(children)) ||
+        (new && (fs_node_get(newfs, new, sym(children)) ||
+                 fs_node_get(newfs, new, sym(no_encode))))) {
+        exclusive = true;
+        if (!fs_upgrade_lock(newfs, oldparent, old_s, old, newparent, new_s, new)) {
+            s = FS_STATUS_NOENT;
+            goto out;
+        }
+    } else if (!fs_lock_entries(newfs, oldparent, old_s, old, new_s, new, locks)) {
         s = FS_STATUS_NOENT;
         goto out;
     }
 
-    if (s == FS_STATUS_OK) {
+    if (new) {
         if (noreplace) {
             s = FS_STATUS_EXIST;
             goto out;
@@ -1783,7 +2427,7 @@ fs_status filesystem_rename(filesystem oldfs, inode oldwd, const char *oldpath,
             goto out;
         }
     }
-    if (file_tuple_is_ancestor(old, new, newparent)) {
+    if (exclusive && file_tuple_is_ancestor(old, new, newparent)) {
         s = FS_STATUS_INVAL;
         goto out;
     }
@@ -1791,21 +2435,22 @@ fs_status filesystem_rename(filesystem oldfs, inode oldwd, const char *oldpath,
         s = FS_STATUS_OK;
         goto out;
     }
-    symbol old_s = sym_this(filename_from_path(oldpath));
-    symbol new_s = sym_this(filename_from_path(newpath));
     s = fs_set_dir_entry(newfs, newparent, new_s, old);
     if (s == FS_STATUS_OK)
         s = fs_set_dir_entry(oldfs, oldparent, old_s, 0);
     if (s == FS_STATUS_OK) {
         fs_notify_move(old, oldparent, old_s, newparent, new_s);
-        if (new) {
-            file_unlink(newfs, new);
-            goto release;
-        }
+        if (new)
+            f = file_unlink(newfs, new);
     }
   out:
-    filesystem_unlock(fs_to_unlock);
-  release:
+    fs_unlock_entries(locks);
+    if (exclusive)
+        filesystem_unlock(fs_to_unlock);
+    else
+        filesystem_unlock_shared(fs_to_unlock);
+    if (f)
+        refcount_release(&f->refcount);
     filesystem_release(oldfs);
     if (newfs)
         filesystem_release(newfs);
@@ -1815,12 +2460,14 @@ fs_status filesystem_rename(filesystem oldfs, inode oldwd, const char *oldpath,
 fs_status filesystem_exchange(filesystem fs1, inode wd1, const char *path1,
                               filesystem fs2, inode wd2, const char *path2)
 {
-    tuple wd1_t = filesystem_get_meta(fs1, wd1);
+    tuple wd1_t = fs_lock_inode(fs1, wd1);
     if (!wd1_t)
         return FS_STATUS_NOENT;
     tuple n1, n2;
     tuple parent1, parent2;
     filesystem fs_to_unlock;
+    void *locks[3] = {0};
+    boolean exclusive = false;
     fs_status s = filesystem_resolve_cstring(&fs1, wd1_t, path1, &n1, &parent1);
     if (s != FS_STATUS_OK) {
         fs_to_unlock = fs1;
@@ -1828,8 +2475,8 @@ fs_status filesystem_exchange(filesystem fs1, inode wd1, const char *path1,
         goto out;
     }
     if (fs2 != fs1) {
-        filesystem_unlock(fs1);
-        filesystem_lock(fs2);
+        filesystem_unlock_shared(fs1);
+        filesystem_lock_shared(fs2);
     }
     tuple wd2_t = fs_tuple_from_inode(fs2, wd2);
     if (!wd2_t) {
@@ -1850,51 +2497,70 @@ fs_status filesystem_exchange(filesystem fs1, inode wd1, const char *path1,
         s = FS_STATUS_READONLY;
         goto out;
     }
-    /* fs1 may have been unlocked in the process of resolving path2, so check (now that the
-     * filesystem is locked again) whether previously found tuples are still valid. */
-    if (!table_find(fs1->files, n1) || !table_find(fs1->files, parent1)) {
+    symbol s1 = fs_entry_name(path1);
+    symbol s2 = fs_entry_name(path2);
+    if (!s1 || !s2) {
+        s = FS_STATUS_NAMETOOLONG;
+        goto out;
+    }
+
+    /* as in filesystem_rename() */
+    if ((parent1 != parent2) || fs_node_get(fs1, n1, sym(children)) ||
+        fs_node_get(fs2, n2, sym(children))) {
+        exclusive = true;
+        if (!fs_upgrade_lock(fs1, parent1, s1, n1, parent2, s2, n2)) {
+            s = FS_STATUS_NOENT;
+            goto out;
+        }
+    } else if (!fs_lock_entries(fs1, parent1, s1, n1, s2, n2, locks)) {
         s = FS_STATUS_NOENT;
         goto out;
     }
 
     if ((parent1 == parent2) && (n1 == n2))
         goto out;
-    if (file_tuple_is_ancestor(n1, n2, parent2) || file_tuple_is_ancestor(n2, n1, parent1)) {
+    if (exclusive &&
+        (file_tuple_is_ancestor(n1, n2, parent2) || file_tuple_is_ancestor(n2, n1, parent1))) {
         s = FS_STATUS_INVAL;
         goto out;
     }
-    s = fs_set_dir_entry(fs1, parent1, sym_this(filename_from_path(path1)), n2);
+    s = fs_set_dir_entry(fs1, parent1, s1, n2);
     if (s == FS_STATUS_OK)
-        s = fs_set_dir_entry(fs2, parent2, sym_this(filename_from_path(path2)), n1);
+        s = fs_set_dir_entry(fs2, parent2, s2, n1);
   out:
-    filesystem_unlock(fs_to_unlock);
+    fs_unlock_entries(locks);
+    if (exclusive)
+        filesystem_unlock(fs_to_unlock);
+    else
+        filesystem_unlock_shared(fs_to_unlock);
     filesystem_release(fs1);
     if (fs2)
         filesystem_release(fs2);
     return s;
 }
 
-void filesystem_log_rebuild(filesystem fs, log new_tl, status_handler sh)
+/* Called with fs locked exclusively; the caller flushes new_tl after unlocking. */
+boolean filesystem_log_rebuild(filesystem fs, log new_tl)
 {
-    tfs_debug("%s(%F)\n", __func__, sh);
+    tfs_debug("%s\n", __func__);
     cleanup_directory(fs->root);
-    boolean ok = log_write(new_tl, fs->root);
+    boolean ok = log_checkpoint(new_tl, fs->root);
     fixup_directory(fs->root, fs->root);
-    if (ok) {
+    if (ok)
         fs->temp_log = new_tl;
-        log_flush(new_tl, sh);
-    } else {
-        filesystem_unlock(fs);
-        apply(sh, timm("result", "failed to write log"));
-        filesystem_lock(fs);
-    }
+    return ok;
 }
 
+/* Called with fs locked exclusively. */
 void filesystem_log_rebuild_done(filesystem fs, log new_tl)
 {
     tfs_debug("%s\n", __func__);
     fs->tl = new_tl;
     fs->temp_log = 0;
+#ifdef KERNEL
+    /* removed directories are destroyed along with the old log */
+    fs_free_dir_locks(fs, false);
+#endif
 }
 
 define_closure_function(1, 1, void, fsf_sync_complete,
@@ -1945,11 +2611,14 @@ fsfile allocate_fsfile(filesystem fs, tuple md)
         return INVALID_ADDRESS;
     }
     f->extentmap = allocate_rangemap(fs->h);
+    f->delalloc = allocate_rangemap(fs->h);
+    f->prealloc = irange(0, 0);
     f->fs = fs;
     f->md = md;
     f->length = 0;
+    fsfile_lock_init(f);
     if (md)
-        table_set(fs->files, md, f);
+        fs_add_node(fs, md, f);
     f->cache_node = pn;
     f->read = pagecache_node_get_reader(pn);
     f->write = pagecache_node_get_writer(pn);
@@ -1965,7 +2634,9 @@ fsfile allocate_fsfile(filesystem fs, tuple md)
 
 fsfile fsfile_from_node(filesystem fs, tuple n)
 {
+    filesystem_files_lock_shared(fs);
     fsfile fsf = table_find(fs->files, n);
+    filesystem_files_unlock_shared(fs);
     return (fsf != INVALID_ADDRESS) ? fsf : 0;
 }
 
@@ -1984,6 +2655,7 @@ closure_function(2, 1, void, log_complete,
             s = timm("result", "failed to enumerate directory entries");
         }
     }
+    fs->mount_stats.ready = mount_timestamp();
     apply(bound(fc), fs, s);
     closure_finish();
 }
@@ -1991,6 +2663,23 @@ closure_function(2, 1, void, log_complete,
 closure_function(0, 2, void, ignore_io,
                  status, s, bytes, length) {}
 
+#ifndef BOOT
+void filesystem_print_mount_stats(filesystem fs, buffer b)
+{
+    bprintf(b, "tfs%s%s: mounted in %ld us: log %ld us (%ld extensions, %ld reads, %ld KB, "
+            "%ld us waiting for reads, %ld us decoding, checkpoint %ld us), "
+            "directories %ld us\n", fs->label[0] ? " " : "", fs->label,
+            usec_from_timestamp(fs->mount_stats.ready - fs->mount_stats.start),
+            usec_from_timestamp(fs->mount_stats.log_done - fs->mount_stats.start),
+            fs->mount_stats.extensions, fs->mount_stats.reads,
+            fs->mount_stats.read_bytes / KB,
+            usec_from_timestamp(fs->mount_stats.io_wait),
+            usec_from_timestamp(fs->mount_stats.decode),
+            usec_from_timestamp(fs->mount_stats.checkpoint),
+            usec_from_timestamp(fs->mount_stats.ready - fs->mount_stats.log_done));
+}
+#endif
+
 const char *filesystem_get_label(filesystem fs)
 {
     return fs->label;
@@ -2003,18 +2692,24 @@ void filesystem_get_uuid(filesystem fs, u8 *uuid)
 
 boolean filesystem_reserve_log_space(filesystem fs, u64 *next_offset, u64 *offset, u64 size)
 {
+    boolean success = true;
     if (size == 0)
         size = filesystem_log_blocks(fs);
+    filesystem_alloc_lock(fs);
     if (*next_offset == INVALID_PHYSICAL) {
-        *next_offset = filesystem_allocate_storage(fs, size);
-        if (*next_offset == INVALID_PHYSICAL)
-            return false;
+        *next_offset = fs_storage_alloc(fs, size);
+        if (*next_offset == INVALID_PHYSICAL) {
+            success = false;
+            goto out;
+        }
     }
     if (offset) {
         *offset = *next_offset;
-        *next_offset = filesystem_allocate_storage(fs, size);
+        *next_offset = fs_storage_alloc(fs, size);
     }
-    return true;
+  out:
+    filesystem_alloc_unlock(fs);
+    return success;
 }
 
 void create_filesystem(heap h,
@@ -2032,10 +2727,16 @@ void create_filesystem(heap h,
     if (!ignore_io_status)
         ignore_io_status = closure(h, ignore_io);
     fs->files = allocate_table(h, identity_key, pointer_equal);
+#ifdef KERNEL
+    fs->dirs = allocate_table(h, identity_key, pointer_equal);
+    assert(fs->dirs != INVALID_ADDRESS);
+#endif
     fs->zero_page = pagecache_get_zero_page();
     assert(fs->zero_page);
     fs->req_handler = req_handler;
     fs->root = 0;
+    zero(&fs->mount_stats, sizeof(fs->mount_stats));
+    fs->mount_stats.start = mount_timestamp();
     fs->page_order = pagecache_get_page_order();
     fs->size = size;
     assert((blocksize & (blocksize - 1)) == 0);
@@ -2062,6 +2763,7 @@ void create_filesystem(heap h,
     }
     fs->next_extend_log_offset = INVALID_PHYSICAL;
     fs->next_new_log_offset = INVALID_PHYSICAL;
+    fs->delalloc_blocks = fs->prealloc_blocks = 0;
     fs->tl = log_create(h, fs, label != 0, closure(h, log_complete, complete, fs));
 }
 
@@ -2090,6 +2792,10 @@ void destroy_filesystem(filesystem fs)
         destruct_dir_entry(fs->root);
     pagecache_dealloc_volume(fs->pv);
     deallocate_table(fs->files);
+#ifdef KERNEL
+    fs_free_dir_locks(fs, true);
+    deallocate_table(fs->dirs);
+#endif
     destroy_id_heap(fs->storage);
     deallocate(fs->h, fs, sizeof(*fs));
 }
@@ -2133,7 +2839,12 @@ u64 fs_usedblocks(filesystem fs)
 
 u64 fs_freeblocks(filesystem fs)
 {
-    return heap_free((heap)fs->storage);
+    /* preallocated blocks are available, reserved ones are not */
+    filesystem_alloc_lock(fs);
+    u64 free = heap_free((heap)fs->storage) + fs->prealloc_blocks;
+    free = free > fs->delalloc_blocks ? free - fs->delalloc_blocks : 0;
+    filesystem_alloc_unlock(fs);
+    return free;
 }
 
 BSS_RO_AFTER_INIT static struct {
@@ -2148,24 +2859,25 @@ void fs_set_path_helper(filesystem (*get_root_fs)(), inode (*get_mountpoint)(tup
     fs_path_helper.get_mountpoint = get_mountpoint;
 }
 
-/* Requires that a mount point does not change while at least one of its two filesystems (parent and
- * child) is locked. */
+/* Called with *fs locked shared; directory entries are read with the directory locked. Requires
+ * that a mount point does not change while at least one of its two filesystems (parent and child)
+ * is locked. */
 static tuple lookup_follow(filesystem *fs, tuple t, symbol a, tuple *p)
 {
     *p = t;
-    t = lookup(t, a);
+    t = fs_node_lookup(*fs, t, a);
     if (!t)
         return t;
     if (fs_path_helper.get_mountpoint) {
-        tuple m = get_tuple(t, sym(mount));
+        tuple m = fs_node_get_tuple(*fs, t, sym(mount));
         if (m) {
             buffer b = get(m, sym(fs));
             if (b && (buffer_length(b) == sizeof(u64))) {
                 filesystem child_fs = pointer_from_u64(*((u64 *)buffer_ref(b, 0)));
                 filesystem_reserve(child_fs);
-                filesystem_unlock(*fs);
+                filesystem_unlock_shared(*fs);
                 filesystem_release(*fs);
-                filesystem_lock(child_fs);
+                filesystem_lock_shared(child_fs);
                 t = child_fs->root;
                 *fs = child_fs;
             }
@@ -2179,14 +2891,14 @@ static tuple lookup_follow(filesystem *fs, tuple t, symbol a, tuple *p)
             if (!n)
                 return t;
             filesystem_reserve(parent_fs);
-            filesystem_unlock(*fs);
+            filesystem_unlock_shared(*fs);
             filesystem_release(*fs);
-            filesystem_lock(parent_fs);
+            filesystem_lock_shared(parent_fs);
             tuple mp = fs_tuple_from_inode(parent_fs, n);
             *fs = parent_fs;
             if (mp) {
                 *p = mp;
-                t = lookup(mp, a);
+                t = fs_node_lookup(parent_fs, mp, a);
             } else {
                 /* The mount directory in the parent filesystem has disappeared before the
                  * filesystem could be locked. */
@@ -2197,7 +2909,7 @@ static tuple lookup_follow(filesystem *fs, tuple t, symbol a, tuple *p)
     return t;
 }
 
-/* Called with the filesystem pointed to by 'fs' locked.
+/* Called with the filesystem pointed to by 'fs' locked shared.
  * If the file path being resolved crosses a filesystem boundary (i.e. a mount
  * point), the current filesystem is unlocked, the new filesystem is locked, and the 'fs' argument
  * is updated to point to the new filesystem.
@@ -2214,9 +2926,9 @@ int filesystem_resolve_cstring(filesystem *fs, tuple cwd, const char *f, tuple *
         filesystem root_fs = fs_path_helper.get_root_fs();
         filesystem_reserve(root_fs);
         if (root_fs != *fs) {
-            filesystem_unlock(*fs);
+            filesystem_unlock_shared(*fs);
             *fs = root_fs;
-            filesystem_lock(*fs);
+            filesystem_lock_shared(*fs);
         }
         t = filesystem_getroot(root_fs);
     } else {
@@ -2244,7 +2956,7 @@ int filesystem_resolve_cstring(filesystem *fs, tuple cwd, const char *f, tuple *
                     t = false;
                     goto done;
                 }
-                if (!children(t))
+                if (!fs_node_get_tuple(*fs, t, sym(children)))
                     return FS_STATUS_NOTDIR;
                 buffer_clear(a);
             }
@@ -2262,7 +2974,7 @@ int filesystem_resolve_cstring(filesystem *fs, tuple cwd, const char *f, tuple *
     }
 
     if (buffer_length(a)) {
-        if (!children(t))
+        if (!fs_node_get_tuple(*fs, t, sym(children)))
             return FS_STATUS_NOTDIR;
         t = lookup_follow(fs, t, intern(a), &p);
     }
@@ -2300,10 +3012,11 @@ int filesystem_resolve_cstring_follow(filesystem *fs, tuple cwd, const char *f,
 
 #define SYMLINK_HOPS_MAX    8
 
+/* Called with *fs locked shared. */
 int filesystem_follow_links(filesystem *fs, tuple link, tuple parent,
                             tuple *target)
 {
-    if (!is_symlink(link)) {
+    if (!fs_node_get(*fs, link, sym(linktarget))) {
         return 0;
     }
 
@@ -2311,7 +3024,7 @@ int filesystem_follow_links(filesystem *fs, tuple link, tuple parent,
     buffer buf = little_stack_buffer(NAME_MAX + 1);
     int hop_count = 0;
     while (true) {
-        buffer target_b = linktarget(link);
+        buffer target_b = fs_node_get(*fs, link, sym(linktarget));
         if (!target_b) {
             *target = link;
             return 0;
@@ -2323,7 +3036,7 @@ int filesystem_follow_links(filesystem *fs, tuple link, tuple parent,
         if (ret) {
             return ret;
         }
-        if (is_symlink(target_t)) {
+        if (fs_node_get(*fs, target_t, sym(linktarget))) {
             if (hop_count++ == SYMLINK_HOPS_MAX) {
                 return FS_STATUS_LINKLOOP;
             }
@@ -2336,7 +3049,7 @@ int filesystem_follow_links(filesystem *fs, tuple link, tuple parent,
 
 fs_status filesystem_mk_socket(filesystem *fs, inode cwd, const char *path, void *s, inode *n)
 {
-    tuple cwd_t = filesystem_get_meta(*fs, cwd);
+    tuple cwd_t = fs_lock_inode(*fs, cwd);
     if (!cwd_t)
         return FS_STATUS_NOENT;
     tuple sock, parent;
@@ -2367,7 +3080,17 @@ fs_status filesystem_mk_socket(filesystem *fs, inode cwd, const char *path, void
     set(sock_handle, sym(value), b);
     set(sock_handle, sym(no_encode), null_value);
     set(sock, sym(socket), null_value);
-    fss = do_mkentry(*fs, parent, filename_from_path(path), sock, true);
+    void *l = fs_node_lock(*fs, parent);
+    if (!l) {
+        fss = FS_STATUS_NOENT;
+        goto err;
+    }
+    const char *name = filename_from_path(path);
+    if (lookup(parent, sym_this(name)))
+        fss = FS_STATUS_EXIST;
+    else
+        fss = do_mkentry(*fs, parent, name, sock, true);
+    fsnode_unlock(l);
     if (fss == FS_STATUS_OK) {
         *n = inode_from_tuple(sock);
         filesystem_reserve(*fs);
@@ -2376,34 +3099,41 @@ fs_status filesystem_mk_socket(filesystem *fs, inode cwd, const char *path, void
   err:
     destruct_dir_entry(sock);
   out:
-    filesystem_unlock(*fs);
+    filesystem_unlock_shared(*fs);
     filesystem_release(*fs);
     return fss;
 }
 
 fs_status filesystem_get_socket(filesystem *fs, inode cwd, const char *path, tuple *n, void **s)
 {
-    tuple cwd_t = filesystem_get_meta(*fs, cwd);
+    tuple cwd_t = fs_lock_inode(*fs, cwd);
     if (!cwd_t)
         return FS_STATUS_NOENT;
     tuple t, sock_handle;
     fs_status fss = filesystem_resolve_cstring(fs, cwd_t, path, &t, 0);
     if (fss != FS_STATUS_OK)
         goto out;
+    void *l = fs_node_lock(*fs, t);
+    if (!l) {
+        fss = FS_STATUS_NOENT;
+        goto out;
+    }
     if (!get(t, sym(socket)) || !(sock_handle = get(t, sym(handle)))) {
         fss = FS_STATUS_INVAL;
-        goto out;
+        goto unlock;
     }
     buffer b = get(sock_handle, sym(value));    // XXX untyped binary
     if (!b || (buffer_length(b) != sizeof(*s))) {
         fss = FS_STATUS_INVAL;
-        goto out;
+        goto unlock;
     }
     *n = t;
     *s = pointer_from_u64(*((u64 *)buffer_ref(b, 0)));
     return FS_STATUS_OK;
+  unlock:
+    fsnode_unlock(l);
   out:
-    filesystem_unlock(*fs);
+    filesystem_unlock_shared(*fs);
     filesystem_release(*fs);
     return fss;
 }
@@ -2417,7 +3147,7 @@ fs_status filesystem_clear_socket(filesystem fs, inode n)
         buffer b = get(sock_handle, sym(value));    // XXX untyped binary
         buffer_clear(b);
         fss = FS_STATUS_OK;
-        filesystem_unlock(fs);
+        filesystem_put_meta(fs, t);
     } else {
         fss = FS_STATUS_NOENT;
     }
@@ -2427,7 +3157,9 @@ fs_status filesystem_clear_socket(filesystem fs, inode n)
 
 fs_status filesystem_mount(filesystem parent, inode mount_dir, filesystem child)
 {
-    spin_lock_2(&parent->lock, &child->lock);
+    /* path lookups never hold two filesystem locks at once, so a fixed order suffices */
+    filesystem_lock(parent);
+    filesystem_lock(child);
     tuple mount_dir_t = fs_tuple_from_inode(parent, mount_dir);
     fs_status fss;
     if (!mount_dir_t) {
@@ -2458,7 +3190,8 @@ fs_status filesystem_mount(filesystem parent, inode mount_dir, filesystem child)
 
 void filesystem_unmount(filesystem parent, inode mount_dir, filesystem child, thunk complete)
 {
-    spin_lock_2(&parent->lock, &child->lock);
+    filesystem_lock(parent);
+    filesystem_lock(child);
     tuple mount_dir_t = fs_tuple_from_inode(parent, mount_dir);
     if (mount_dir_t) {
         tuple mount = get_tuple(mount_dir_t, sym(mount));
@@ -2529,7 +3262,7 @@ int file_get_path(filesystem fs, inode ino, char *buf, u64 len)
     if (len < 2) {
         return -1;
     }
-    tuple n = filesystem_get_meta(fs, ino);
+    tuple n = fs_lock_inode(fs, ino);
     if (!n)
         return -1;
     filesystem_reserve(fs);
@@ -2540,27 +3273,32 @@ int file_get_path(filesystem fs, inode ino, char *buf, u64 len)
     tuple p;
     do {
         n = lookup_follow(&fs, n, sym_this(".."), &p);
-        assert(n);
+        if (!n)     /* removed concurrently */
+            break;
         if (n == p) {   /* this is the root directory */
             if (cur_len == 1) {
                 buf[0] = '/';
                 buf[1] = '\0';
                 cur_len = 2;
             }
-            c = 0;
-        } else {
-            c = children(n);
+            rv = cur_len;
+            goto out;
         }
+        void *l = fs_node_lock(fs, n);
+        if (!l)
+            break;
+        c = children(n);
+        if (c)
+            iterate(c, stack_closure(file_get_path_each, p, buf, len, &cur_len));
+        fsnode_unlock(l);
         if (!c) {
             rv = cur_len;
             goto out;
         }
-
-        iterate(c, stack_closure(file_get_path_each, p, buf, len, &cur_len));
     } while (cur_len > 0);
     rv = -1;
   out:
-    filesystem_unlock(fs);
+    filesystem_unlock_shared(fs);
     filesystem_release(fs);
     return rv;
 }
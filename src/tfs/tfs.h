@@ -19,10 +19,12 @@ extern io_status_handler ignore_io_status;
 
 #define MIN_EXTENT_SIZE PAGESIZE
 #define MIN_EXTENT_ALLOC_SIZE   (1 * MB)
+#define MAX_EXTENT_PREALLOC_SIZE    (16 * MB)
 
 boolean filesystem_probe(u8 *first_sector, u8 *uuid, char *label);
 const char *filesystem_get_label(filesystem fs);
 void filesystem_get_uuid(filesystem fs, u8 *uuid);
+void filesystem_print_mount_stats(filesystem fs, buffer b);
 
 void create_filesystem(heap h,
                        u64 blocksize,
@@ -43,6 +45,7 @@ void filesystem_read_linear(fsfile f, void *dest, range q, io_status_handler com
 void filesystem_write_linear(fsfile f, void *src, range q, io_status_handler completion);
 
 void filesystem_flush(filesystem fs, status_handler completion);
+void filesystem_compact_log(filesystem fs);
 
 void filesystem_reserve(filesystem fs);
 void filesystem_release(filesystem fs);
@@ -116,6 +119,8 @@ fs_status filesystem_get_node(filesystem *fs, inode cwd, const char *path, boole
 void filesystem_put_node(filesystem fs, tuple n);
 tuple filesystem_get_meta(filesystem fs, inode n);
 void filesystem_put_meta(filesystem fs, tuple n);
+tuple filesystem_get_parent(filesystem fs, tuple n);
+void filesystem_put_parent(filesystem fs, tuple p);
 fs_status filesystem_creat_unnamed(filesystem fs, fsfile *f);
 fs_status filesystem_symlink(filesystem fs, inode cwd, const char *path, const char *target);
 fs_status filesystem_delete(filesystem fs, inode cwd, const char *path, boolean directory);
@@ -210,7 +215,7 @@ int file_get_path(filesystem fs, inode ino, char *buf, u64 len);
 void fs_notify_create(tuple t, tuple parent, symbol name);
 void fs_notify_move(tuple t, tuple old_parent, symbol old_name, tuple new_parent, symbol new_name);
 void fs_notify_delete(tuple t, tuple parent, symbol name);
-void fs_notify_modify(tuple t);
+void fs_notify_modify(filesystem fs, tuple t);
 void fs_notify_release(tuple t, boolean unmounted);
 
 #else
@@ -218,7 +223,7 @@ void fs_notify_release(tuple t, boolean unmounted);
 #define fs_notify_create(t, p, n)
 #define fs_notify_move(t, op, on, np, nn)
 #define fs_notify_delete(t, p, n)
-#define fs_notify_modify(t)
+#define fs_notify_modify(fs, t)
 #define fs_notify_release(t, u)             (void)(t)
 
 #endif
@@ -7,19 +7,70 @@
 #include <storage.h>
 #include <tfs.h>
 
-#define TFS_VERSION 0x00000004
-
+#define TFS_VERSION 0x00000005
+
+/* oldest log format that can still be read; version 5 adds checkpoints */
+#define TFS_VERSION_COMPAT 0x00000004
+
+/* Lock order: filesystem (exclusive or shared), then node (a regular file's
+   fsfile, a directory, or the node lock shared by all other nodes), then its
+   parent directory, then the file table, then log, then storage allocation.
+
+   The filesystem lock is shared by path lookups, by changes within a single
+   directory and by any access to a node, which take the node lock of each
+   tuple they read or modify. A node is locked before its parent directory and
+   never while a child is held, except for a new node not yet linked into the
+   namespace; sibling nodes are locked in the order of their locks' addresses.
+   The filesystem is locked exclusively to move entries between directories or
+   to move a directory, to remove a non-persistent entry, to (un)mount, and to
+   rebuild the log; nodes, fsfiles and directory locks are only freed with the
+   filesystem locked exclusively. Log appends and storage allocation have their
+   own locks. */
 #ifdef KERNEL
 
-#define filesystem_lock_init(fs)    spin_lock_init(&(fs)->lock)
-#define filesystem_lock(fs)         spin_lock(&(fs)->lock)
-#define filesystem_unlock(fs)       spin_unlock(&(fs)->lock)
+#define filesystem_lock_init(fs)    do {                                    \
+        spin_rw_lock_init_class(&(fs)->lock, "tfs");                        \
+        spin_rw_lock_init_class(&(fs)->files_lock, "tfs_files");            \
+        spin_lock_init_class(&(fs)->node_lock, "tfs_node");                 \
+        spin_lock_init_class(&(fs)->alloc_lock, "tfs_alloc");               \
+    } while (0)
+#define filesystem_lock(fs)         spin_wlock(&(fs)->lock)
+#define filesystem_unlock(fs)       spin_wunlock(&(fs)->lock)
+#define filesystem_lock_shared(fs)      spin_rlock(&(fs)->lock)
+#define filesystem_unlock_shared(fs)    spin_runlock(&(fs)->lock)
+#define filesystem_files_lock(fs)   spin_wlock(&(fs)->files_lock)
+#define filesystem_files_unlock(fs) spin_wunlock(&(fs)->files_lock)
+#define filesystem_files_lock_shared(fs)    spin_rlock(&(fs)->files_lock)
+#define filesystem_files_unlock_shared(fs)  spin_runlock(&(fs)->files_lock)
+#define filesystem_alloc_lock(fs)   spin_lock(&(fs)->alloc_lock)
+#define filesystem_alloc_unlock(fs) spin_unlock(&(fs)->alloc_lock)
+#define fsfile_lock_init(f)         spin_lock_init_class(&(f)->lock, "tfs_file")
+#define fsfile_lock(f)              spin_lock(&(f)->lock)
+#define fsfile_unlock(f)            spin_unlock(&(f)->lock)
+#define fsfile_trylock(f)           spin_try(&(f)->lock)
+#define fsdir_lock_init(d)          spin_lock_init_class(&(d)->lock, "tfs_dir")
+#define fsnode_lock(l)              spin_lock(l)
+#define fsnode_unlock(l)            spin_unlock(l)
 
 #else
 
 #define filesystem_lock_init(fs)
 #define filesystem_lock(fs)         ((void)fs)
 #define filesystem_unlock(fs)       ((void)fs)
+#define filesystem_lock_shared(fs)      ((void)fs)
+#define filesystem_unlock_shared(fs)    ((void)fs)
+#define filesystem_files_lock(fs)   ((void)fs)
+#define filesystem_files_unlock(fs) ((void)fs)
+#define filesystem_files_lock_shared(fs)    ((void)fs)
+#define filesystem_files_unlock_shared(fs)  ((void)fs)
+#define filesystem_alloc_lock(fs)   ((void)fs)
+#define filesystem_alloc_unlock(fs) ((void)fs)
+#define fsfile_lock_init(f)
+#define fsfile_lock(f)              ((void)f)
+#define fsfile_unlock(f)            ((void)f)
+#define fsfile_trylock(f)           true
+#define fsnode_lock(l)              ((void)l)
+#define fsnode_unlock(l)            ((void)l)
 
 #endif
 
@@ -51,9 +102,20 @@ typedef struct filesystem {
     log temp_log;
     u64 next_extend_log_offset;
     u64 next_new_log_offset;
+    u64 delalloc_blocks;        /* reserved by writes, not yet allocated */
+    u64 prealloc_blocks;        /* held by speculative preallocations */
     tuple root;
+    struct {
+        timestamp start, log_done, ready;
+        timestamp io_wait, decode, checkpoint;
+        u64 extensions, reads, read_bytes;
+    } mount_stats;
 #ifdef KERNEL
-    struct spinlock lock;
+    struct rw_spinlock lock;
+    struct rw_spinlock files_lock;  /* files, dirs */
+    struct spinlock node_lock;  /* nodes other than regular files and directories */
+    struct spinlock alloc_lock; /* storage, delalloc_blocks, prealloc_blocks */
+    table dirs;                 /* maps directory tuple to fsdir */
 #endif
     struct refcount refcount;
     closure_struct(fs_sync, sync);
@@ -72,17 +134,28 @@ declare_closure_struct(1, 1, void, fsf_sync_complete,
 
 typedef struct fsfile {
     rangemap extentmap;
+    rangemap delalloc;          /* file blocks written but not yet allocated */
+    range prealloc;             /* storage blocks reserved after the last extent */
     filesystem fs;
     pagecache_node cache_node;
     u64 length;
     tuple md;
     sg_io read;
     sg_io write;
+#ifdef KERNEL
+    struct spinlock lock;       /* extentmap, delalloc, prealloc, length, md (and its tuple), status */
+#endif
     struct refcount refcount;
     closure_struct(fsf_sync_complete, sync_complete);
     u8 status;
 } *fsfile;
 
+#ifdef KERNEL
+typedef struct fsdir {
+    struct spinlock lock;       /* directory tuple, including its entries */
+} *fsdir;
+#endif
+
 typedef struct uninited_queued_op {
     sg_list sg;
     merge m;
@@ -122,6 +195,8 @@ void ingest_extent(fsfile f, symbol foff, tuple value);
 
 log log_create(heap h, filesystem fs, boolean initialize, status_handler sh);
 boolean log_write(log tl, tuple t);
+boolean log_checkpoint(log tl, tuple t);
+void log_compact(log tl, boolean force);
 boolean log_write_eav(log tl, tuple e, symbol a, value v);
 void log_flush(log tl, status_handler completion);
 void log_destroy(log tl);
@@ -132,7 +207,7 @@ boolean filesystem_free_storage(filesystem fs, range storage_blocks);
 void filesystem_storage_op(filesystem fs, sg_list sg, range blocks, boolean write,
                            status_handler completion);
     
-void filesystem_log_rebuild(filesystem fs, log new_tl, status_handler sh);
+boolean filesystem_log_rebuild(filesystem fs, log new_tl);
 void filesystem_log_rebuild_done(filesystem fs, log new_tl);
 
 boolean filesystem_reserve_log_space(filesystem fs, u64 *next_offset, u64 *offset, u64 size);
@@ -142,6 +217,13 @@ fsfile allocate_fsfile(filesystem fs, tuple md);
 
 boolean file_tuple_is_ancestor(tuple t1, tuple t2, tuple p2);
 
+/* mount phase timing; the bootloader has no clock */
+#ifdef BOOT
+#define mount_timestamp()   0
+#else
+#define mount_timestamp()   now(CLOCK_ID_MONOTONIC_RAW)
+#endif
+
 #define filesystem_log_blocks(fs) (TFS_LOG_DEFAULT_EXTENSION_SIZE >> (fs)->blocksize_order)
 
 static inline u64 bytes_from_sectors(filesystem fs, u64 sectors)
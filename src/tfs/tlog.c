@@ -24,6 +24,7 @@ static const char *tfs_magic = "NVMTFS";
 #define TUPLE_EXTENDED 3
 #define END_OF_SEGMENT 4
 #define LOG_EXTENSION_LINK 5
+#define CHECKPOINT 6
 
 #define COMPLETION_QUEUE_SIZE 10
 
@@ -33,21 +34,57 @@ static const char *tfs_magic = "NVMTFS";
 #define TFS_EXTENSION_LINK_BYTES (1 + 2 * MAX_VARINT_SIZE)
 #define TFS_LOG_RESERVED_BYTES (TFS_EXTENSION_HEADER_BYTES + TFS_EXTENSION_LINK_BYTES)
 #define TFS_LOG_MAX_TUPLE_STAGING_BYTES (32 * MB)
+#define TFS_CHECKPOINT_FRAME_BYTES (1 + 3 * MAX_VARINT_SIZE)
+
+/* Checkpoint transfers are split into requests of this size, all issued at
+   once. */
+#define TFS_CHECKPOINT_IO_BYTES (4 * MB)
+
+#ifdef BOOT
+#define TFS_LOG_READ_AHEAD_BYTES 0  /* one extension at a time */
+#else
+#define TFS_LOG_READ_AHEAD_BYTES TFS_LOG_READ_AHEAD_SIZE
+#endif
 
 typedef struct log *log;
 typedef struct log_ext *log_ext;
 
-#define tlog_lock(tl)       filesystem_lock((tl)->fs)
-#define tlog_unlock(tl)     filesystem_unlock((tl)->fs)
-
 #ifdef KERNEL
 
+#define tlog_lock_init(tl)  spin_lock_init_class(&(tl)->lock, "tfs_log")
+#define tlog_lock(tl)       spin_lock(&(tl)->lock)
+#define tlog_unlock(tl)     spin_unlock(&(tl)->lock)
+
+#define tlog_dict_lock_init(tl)     spin_rw_lock_init_class(&(tl)->dict_lock, "tfs_log_dict")
+#define tlog_dict_lock(tl, x)       ((x) ? spin_wlock(&(tl)->dict_lock) : spin_rlock(&(tl)->dict_lock))
+#define tlog_dict_unlock(tl, x)     ((x) ? spin_wunlock(&(tl)->dict_lock) : spin_runlock(&(tl)->dict_lock))
+
+#define tlog_stage_lock_init(st)    spin_lock_init_class(&(st)->lock, "tfs_log_stage")
+#define tlog_stage_lock(st)         spin_lock(&(st)->lock)
+#define tlog_stage_unlock(st)       spin_unlock(&(st)->lock)
+#define tlog_nstages()              MAX(present_processors, total_processors)
+#define tlog_stage_index(tl)        (current_cpu()->id % (tl)->nstages)
+
 #define tlog_ext_lock_init(ext)    spin_lock_init(&(ext)->lock)
 #define tlog_ext_lock(ext)         spin_lock(&(ext)->lock)
 #define tlog_ext_unlock(ext)       spin_unlock(&(ext)->lock)
 
 #else
 
+#define tlog_lock_init(tl)
+#define tlog_lock(tl)
+#define tlog_unlock(tl)
+
+#define tlog_dict_lock_init(tl)
+#define tlog_dict_lock(tl, x)
+#define tlog_dict_unlock(tl, x)
+
+#define tlog_stage_lock_init(st)
+#define tlog_stage_lock(st)
+#define tlog_stage_unlock(st)
+#define tlog_nstages()              1
+#define tlog_stage_index(tl)        0
+
 #define tlog_ext_lock_init(ext)
 #define tlog_ext_lock(ext)
 #define tlog_ext_unlock(ext)
@@ -71,22 +108,58 @@ struct log_ext {
 #ifdef KERNEL
     struct spinlock lock;
 #endif
+    /* mount-time read state, protected by the extension lock */
+    boolean read_done;
+    status read_status;
+    status_handler read_waiter;
+    timestamp read_wait_start;
+    boolean read_drain;         /* parse is over: close once the read is done */
+    status drain_status;        /* parse result to report then */
     struct refcount refcount;
     closure_struct(log_ext_free, free);
 };
 
 declare_closure_struct(1, 0, void, log_free,
                        log, tl);
+declare_closure_struct(1, 0, void, log_compact_task,
+                       log, tl);
 
+/* Tuples are encoded into per-cpu stages. An encoding that only refers to
+   existing dictionary entries takes the dictionary lock shared, so that cpus
+   stage concurrently; one that adds entries takes it exclusively. Records are
+   tagged with a sequence number taken while encoding and are merged into
+   tuple_staging in that order on flush, so that each dictionary index is
+   defined in the log before it is referenced. */
+typedef struct log_stage {
+#ifdef KERNEL
+    struct spinlock lock;
+#endif
+    buffer b;
+    vector records;             /* sequence number, length pairs */
+    u64 next;                   /* next record to merge */
+} *log_stage;
+
+/* The log lock covers the merge from the stages into tuple_staging and flush
+   state; it is taken before the dictionary lock. It is independent of the
+   filesystem lock, so that operations on different files and directories
+   append to the log without holding the filesystem exclusively. */
 struct log {
     heap h;
     filesystem fs;
+#ifdef KERNEL
+    struct spinlock lock;
+    struct rw_spinlock dict_lock;
+#endif
     table dictionary;
     u64 total_entries, obsolete_entries;
     rangemap extensions;
     log_ext current;
     buffer tuple_staging;
     vector encoding_lengths;
+    log_stage stages;
+    u64 nstages;
+    u64 stage_seq;
+    u64 staged_bytes;
     u64 tuple_bytes_remain;
 
     struct timer flush_timer;
@@ -94,9 +167,26 @@ struct log {
     boolean dirty;
     boolean flushing;
     boolean compacting;
+    boolean compact_pending;    /* compaction task queued */
     boolean failed;             /* unrecoverable log failure */
+
+    /* A checkpoint is a snapshot of the whole tuple tree, encoded as a single
+       tuple in a contiguous run of blocks and referenced from the initial
+       extension. Only the log tail following it is replayed on mount. */
+    range checkpoint;
+    u64 checkpoint_bytes;
+    buffer checkpoint_buf;      /* pending write */
+
+    /* During mount, each read covers TFS_LOG_READ_AHEAD_BYTES from the start
+       of the requested extension, and the link to the next extension is
+       located (and its read issued) before the current one is decoded. */
+    void *read_window;
+    bytes read_window_alloc;
+    range read_window_sectors;
+    log_ext prefetch;
     struct refcount refcount;
     closure_struct(log_free, free);
+    closure_struct(log_compact_task, compact_task);
 };
 
 define_closure_function(3, 3, void, log_storage_op,
@@ -135,6 +225,11 @@ static log_ext open_log_extension(log tl, range sectors)
     if (ext->staging == INVALID_ADDRESS)
         goto fail_dealloc;
     ext->open = false;
+    ext->read_done = false;
+    ext->read_status = STATUS_OK;
+    ext->read_waiter = 0;
+    ext->read_drain = false;
+    ext->drain_status = STATUS_OK;
     init_closure(&ext->read, log_storage_op, tl->fs, sectors.start, false);
     init_closure(&ext->write, log_storage_op, tl->fs, sectors.start, true);
     ext->sectors = sectors;
@@ -185,6 +280,48 @@ define_closure_function(1, 0, void, log_free,
 
 #endif
 
+#ifndef TLOG_READ_ONLY
+static void log_stages_dealloc(log tl)
+{
+    for (u64 i = 0; i < tl->nstages; i++) {
+        log_stage st = &tl->stages[i];
+        if (st->b)
+            deallocate_buffer(st->b);
+        if (st->records)
+            deallocate_vector(st->records);
+    }
+    deallocate(tl->h, tl->stages, tl->nstages * sizeof(struct log_stage));
+}
+
+static boolean log_stages_alloc(log tl)
+{
+    tl->nstages = tlog_nstages();
+    tl->stages = allocate_zero(tl->h, tl->nstages * sizeof(struct log_stage));
+    if (tl->stages == INVALID_ADDRESS)
+        return false;
+    for (u64 i = 0; i < tl->nstages; i++) {
+        log_stage st = &tl->stages[i];
+        tlog_stage_lock_init(st);
+        st->b = allocate_buffer(tl->h, PAGESIZE /* arbitrary */);
+        if (st->b == INVALID_ADDRESS) {
+            st->b = 0;
+            goto fail;
+        }
+        st->records = allocate_vector(tl->h, 64);
+        if (st->records == INVALID_ADDRESS) {
+            st->records = 0;
+            goto fail;
+        }
+    }
+    tl->stage_seq = 0;
+    tl->staged_bytes = 0;
+    return true;
+  fail:
+    log_stages_dealloc(tl);
+    return false;
+}
+#endif
+
 static log log_new(heap h, filesystem fs)
 {
     tlog_debug("new log: heap %p, fs %p\n", h, fs);
@@ -193,6 +330,8 @@ static log log_new(heap h, filesystem fs)
         return tl;
     tl->h = h;
     tl->fs = fs;
+    tlog_lock_init(tl);
+    tlog_dict_lock_init(tl);
     tl->dictionary = allocate_table(h, identity_key, pointer_equal);
     if (tl->dictionary == INVALID_ADDRESS)
         goto fail_dealloc_log;
@@ -210,24 +349,40 @@ static log log_new(heap h, filesystem fs)
     if (tl->flush_completions == INVALID_ADDRESS)
         goto fail_dealloc_encoding_lengths;
     tl->total_entries = tl->obsolete_entries = 0;
+    tl->checkpoint = irange(0, 0);
+    tl->checkpoint_bytes = 0;
+    tl->checkpoint_buf = 0;
+    tl->read_window = 0;
+    tl->read_window_alloc = 0;
+    tl->read_window_sectors = irange(0, 0);
+    tl->prefetch = 0;
 #ifndef TLOG_READ_ONLY
     tl->extensions = allocate_rangemap(h);
     if (tl->extensions == INVALID_ADDRESS) {
         goto fail_dealloc_completions;
     }
     tl->compacting = false;
+    tl->compact_pending = false;
     tl->failed = false;
     init_refcount(&tl->refcount, 1, init_closure(&tl->free, log_free, tl));
+    if (!log_stages_alloc(tl))
+        goto fail_dealloc_extensions;
 #endif
     range sectors = irange(0, TFS_LOG_INITIAL_SIZE >> fs->blocksize_order);
     tl->current = open_log_extension(tl, sectors);
     if (tl->current == INVALID_ADDRESS) {
 #ifndef TLOG_READ_ONLY
-        deallocate_rangemap(tl->extensions, stack_closure(log_dealloc_ext_node, tl));
-#endif
+        log_stages_dealloc(tl);
+        goto fail_dealloc_extensions;
+#else
         goto fail_dealloc_completions;
+#endif
     }
     return tl;
+#ifndef TLOG_READ_ONLY
+  fail_dealloc_extensions:
+    deallocate_rangemap(tl->extensions, stack_closure(log_dealloc_ext_node, tl));
+#endif
   fail_dealloc_completions:
     deallocate_vector(tl->flush_completions);
   fail_dealloc_encoding_lengths:
@@ -257,6 +412,44 @@ static void dump_staging(log_ext ext)
 #endif
 }
 
+closure_function(2, 1, void, log_checkpoint_io_complete,
+                 sg_list, sg, status_handler, sh,
+                 status, s)
+{
+    deallocate_sg_list(bound(sg));
+    apply(bound(sh), s);
+    closure_finish();
+}
+
+/* Transfer the checkpoint between buf and storage, with the length padded
+   to the block size. */
+static void log_checkpoint_io(log tl, void *buf, boolean write, status_handler sh)
+{
+    filesystem fs = tl->fs;
+    u64 bytes = bytes_from_sectors(fs, range_span(tl->checkpoint));
+    merge m = allocate_merge(tl->h, sh);
+    status_handler k = apply_merge(m);
+    for (u64 offset = 0; offset < bytes; offset += TFS_CHECKPOINT_IO_BYTES) {
+        u64 length = MIN(bytes - offset, TFS_CHECKPOINT_IO_BYTES);
+        sg_list sg = allocate_sg_list();
+        if (sg == INVALID_ADDRESS) {
+            apply(apply_merge(m), timm("result", "failed to allocate sg list"));
+            break;
+        }
+        sg_buf sgb = sg_list_tail_add(sg, length);
+        sgb->buf = buf + offset;
+        sgb->size = length;
+        sgb->offset = 0;
+        sgb->refcount = 0;
+        range blocks = irangel(tl->checkpoint.start + sector_from_offset(fs, offset),
+                               sector_from_offset(fs, length));
+        tlog_debug("%s: %s blocks %R\n", __func__, write ? "write" : "read", blocks);
+        filesystem_storage_op(fs, sg, blocks, write,
+                              closure(tl->h, log_checkpoint_io_complete, sg, apply_merge(m)));
+    }
+    apply(k, STATUS_OK);
+}
+
 #ifndef TLOG_READ_ONLY
 closure_function(4, 1, void, flush_log_extension_complete,
                  sg_list, sg, log_ext, ext, boolean, release, status_handler, complete,
@@ -349,6 +542,14 @@ closure_function(3, 1, void, log_extend_link,
     /* add link to close out old extension and commit */
     log_ext old_ext = bound(old_ext);
     buffer b = old_ext->staging;
+    log tl = old_ext->tl;
+    if (old_ext->sectors.start == 0 && range_span(tl->checkpoint)) {
+        /* the checkpoint precedes the log tail */
+        push_u8(b, CHECKPOINT);
+        push_varint(b, tl->checkpoint.start);
+        push_varint(b, range_span(tl->checkpoint));
+        push_varint(b, tl->checkpoint_bytes);
+    }
     push_u8(b, LOG_EXTENSION_LINK);
     push_varint(b, bound(sectors).start);
     push_varint(b, range_span(bound(sectors)));
@@ -392,10 +593,46 @@ static inline u64 log_size(log_ext ext)
     return bytes_from_sectors(ext->tl->fs, range_span(ext->sectors));
 }
 
+/* called with the log locked */
+static void log_stages_merge(log tl)
+{
+    tlog_dict_lock(tl, true);
+    while (true) {
+        log_stage min = 0;
+        u64 min_seq = 0;
+        for (u64 i = 0; i < tl->nstages; i++) {
+            log_stage st = &tl->stages[i];
+            if (st->next >= vector_length(st->records))
+                continue;
+            u64 seq = (u64)vector_get(st->records, st->next);
+            if (!min || seq < min_seq) {
+                min = st;
+                min_seq = seq;
+            }
+        }
+        if (!min)
+            break;
+        u64 length = (u64)vector_get(min->records, min->next + 1);
+        assert(buffer_write(tl->tuple_staging, buffer_ref(min->b, 0), length));
+        buffer_consume(min->b, length);
+        vector_push(tl->encoding_lengths, (void *)length);
+        min->next += 2;
+    }
+    for (u64 i = 0; i < tl->nstages; i++) {
+        log_stage st = &tl->stages[i];
+        buffer_clear(st->b);
+        vector_clear(st->records);
+        st->next = 0;
+    }
+    tl->staged_bytes = 0;
+    tlog_dict_unlock(tl, true);
+}
+
 static inline boolean log_write_internal(log tl, merge m)
 {
     log_ext ext = tl->current;
     assert(ext);
+    log_stages_merge(tl);
 
     int n = vector_length(tl->encoding_lengths);
     tlog_ext_lock(ext);
@@ -477,6 +714,7 @@ closure_function(2, 1, void, log_switch_complete,
     log new_tl = bound(new_tl);
     filesystem fs = old_tl->fs;
     filesystem_lock(fs);
+    tlog_lock(old_tl);
     log to_be_used, to_be_destroyed;
     if (is_ok(s)) {
         to_be_used = new_tl;
@@ -502,6 +740,7 @@ closure_function(2, 1, void, log_switch_complete,
     }
 
     run_flush_completions(old_tl, s);
+    tlog_unlock(old_tl);
     filesystem_unlock(fs);
 
     refcount_release(&to_be_destroyed->refcount);
@@ -509,7 +748,96 @@ closure_function(2, 1, void, log_switch_complete,
     closure_finish();
 }
 
-void log_flush(log tl, status_handler completion)
+closure_function(2, 1, void, log_checkpoint_write_complete,
+                 log, tl, status_handler, sh,
+                 status, s)
+{
+    log tl = bound(tl);
+    tlog_debug("%s: status %v\n", __func__, s);
+    deallocate_buffer(tl->checkpoint_buf);
+    tl->checkpoint_buf = 0;
+    apply(bound(sh), s);
+    closure_finish();
+}
+
+static boolean log_compact_needed(log tl)
+{
+    return !tl->failed && !tl->compacting && (tl->obsolete_entries >= TFS_LOG_COMPACT_OBSOLETE) &&
+        (tl->total_entries <= TFS_LOG_COMPACT_RATIO * tl->obsolete_entries);
+}
+
+/* Rewrite the log as a checkpoint of the tuple tree followed by a new tail;
+   unless forced, only if enough of the log is obsolete. The tree can only be
+   encoded with the filesystem locked exclusively, which the log write that
+   found compaction to be due cannot do, so in the kernel this runs as a
+   separate task. */
+void log_compact(log tl, boolean force)
+{
+    filesystem fs = tl->fs;
+    filesystem_lock(fs);
+    tlog_lock(tl);
+    if (fs->tl != tl || tl->failed || tl->compacting || (!force && !log_compact_needed(tl)))
+        goto out_unlock;
+    tlog_debug("%ld obsolete entries out of %ld, starting log compaction\n",
+        tl->obsolete_entries, tl->total_entries);
+    log new_tl = log_new(fs->h, fs);
+    if (new_tl == INVALID_ADDRESS)
+        goto out_unlock;
+    log_ext new_ext = log_ext_new(new_tl);
+    if (new_ext == INVALID_ADDRESS)
+        goto fail_log_destroy;
+    status_handler switch_complete = closure(new_tl->h, log_switch_complete,
+        tl, new_tl);
+    if (switch_complete == INVALID_ADDRESS)
+        goto fail_log_ext_close;
+    status_handler rebuild_complete = closure(tl->h, log_extend_link,
+        new_tl->current, new_ext->sectors, switch_complete);
+    if (rebuild_complete == INVALID_ADDRESS)
+        goto fail_log_dealloc_closure;
+    log_extension_init(new_tl->current);
+    log_extension_init(new_ext);
+    new_tl->current = new_ext;
+    tl->compacting = true;
+    boolean ok = filesystem_log_rebuild(fs, new_tl);
+    tlog_unlock(tl);
+    filesystem_unlock(fs);
+
+    /* the switch to the new log needs the filesystem lock */
+    if (ok)
+        log_flush(new_tl, rebuild_complete);
+    else
+        apply(rebuild_complete, timm("result", "failed to write log"));
+    return;
+  fail_log_dealloc_closure:
+    deallocate_closure(switch_complete);
+  fail_log_ext_close:
+    close_log_extension(new_ext);
+    if (!filesystem_free_storage(fs, new_ext->sectors))
+        msg_err("failed to mark new_ext at %R as free", new_ext->sectors);
+  fail_log_destroy:
+    log_destroy(new_tl);
+  out_unlock:
+    tlog_unlock(tl);
+    filesystem_unlock(fs);
+}
+
+#ifdef KERNEL
+define_closure_function(1, 0, void, log_compact_task,
+                        log, tl)
+{
+    log tl = bound(tl);
+    filesystem fs = tl->fs;
+    tlog_lock(tl);
+    tl->compact_pending = false;
+    tlog_unlock(tl);
+    log_compact(tl, false);
+    refcount_release(&tl->refcount);
+    filesystem_release(fs);
+}
+#endif
+
+/* called with the log locked */
+static void log_flush_locked(log tl, status_handler completion)
 {
     tlog_debug("%s: log %p, completion %p, dirty %d\n", __func__, tl, completion, tl->dirty);
     if (!tl->dirty && !tl->compacting) {
@@ -532,6 +860,12 @@ void log_flush(log tl, status_handler completion)
     merge m = allocate_merge(tl->h, closure(tl->h, log_flush_complete, tl));
     status_handler sh = apply_merge(m);
 
+    /* The checkpoint write proceeds alongside the extension flush; both must
+       complete before the initial extension may reference the checkpoint. */
+    if (tl->checkpoint_buf)
+        log_checkpoint_io(tl, buffer_ref(tl->checkpoint_buf, 0), true,
+                          closure(tl->h, log_checkpoint_write_complete, tl, apply_merge(m)));
+
     /* If we're unable to commit the entire tuple_staging buffer, record an
        unrecoverable failure in the log, but flush the current extension. */
     if (!log_write_internal(tl, m))
@@ -542,40 +876,25 @@ void log_flush(log tl, status_handler completion)
     flush_log_extension(tl->current, false, sh);
     tlog_lock(tl);
 
-    if (!tl->failed && !tl->compacting && (tl->obsolete_entries >= TFS_LOG_COMPACT_OBSOLETE) &&
-        (tl->total_entries <= TFS_LOG_COMPACT_RATIO * tl->obsolete_entries)) {
-        tlog_debug("%ld obsolete entries out of %ld, starting log compaction\n",
-            tl->obsolete_entries, tl->total_entries);
-        filesystem fs = tl->fs;
-        log new_tl = log_new(fs->h, fs);
-        if (new_tl == INVALID_ADDRESS)
-            return;
-        log_ext new_ext = log_ext_new(new_tl);
-        if (new_ext == INVALID_ADDRESS)
-            goto fail_log_destroy;
-        status_handler switch_complete = closure(new_tl->h, log_switch_complete,
-            tl, new_tl);
-        if (switch_complete == INVALID_ADDRESS)
-            goto fail_log_ext_close;
-        status_handler rebuild_complete = closure(tl->h, log_extend_link,
-            new_tl->current, new_ext->sectors, switch_complete);
-        if (rebuild_complete == INVALID_ADDRESS)
-            goto fail_log_dealloc_closure;
-        log_extension_init(new_tl->current);
-        log_extension_init(new_ext);
-        new_tl->current = new_ext;
-        tl->compacting = true;
-        filesystem_log_rebuild(fs, new_tl, rebuild_complete);
+    if (!log_compact_needed(tl))
         return;
-  fail_log_dealloc_closure:
-        deallocate_closure(switch_complete);
-  fail_log_ext_close:
-        close_log_extension(new_ext);
-        if (!filesystem_free_storage(fs, new_ext->sectors))
-            msg_err("failed to mark new_ext at %R as free", new_ext->sectors);
-  fail_log_destroy:
-        log_destroy(new_tl);
+#ifdef KERNEL
+    if (!tl->compact_pending) {
+        tl->compact_pending = true;
+        refcount_reserve(&tl->refcount);
+        filesystem_reserve(tl->fs);
+        async_apply((thunk)init_closure(&tl->compact_task, log_compact_task, tl));
     }
+#else
+    log_compact(tl, false);
+#endif
+}
+
+void log_flush(log tl, status_handler completion)
+{
+    tlog_lock(tl);
+    log_flush_locked(tl, completion);
+    tlog_unlock(tl);
 }
 
 #ifdef KERNEL
@@ -585,7 +904,7 @@ closure_function(1, 2, void, log_flush_timer_expired,
 {
     if (overruns != timer_disabled) {
         tlog_lock(bound(tl));
-        log_flush(bound(tl), 0);
+        log_flush_locked(bound(tl), 0);
         tlog_unlock(bound(tl));
     }
     closure_finish();
@@ -594,9 +913,9 @@ closure_function(1, 2, void, log_flush_timer_expired,
 static void log_set_dirty(log tl)
 {
     if (tl->dirty) {
-        if (buffer_length(tl->tuple_staging) >= bytes_from_sectors(tl->fs,
+        if (tl->staged_bytes >= bytes_from_sectors(tl->fs,
                 range_span(tl->current->sectors)) / 2)
-            log_flush(tl, 0);
+            log_flush_locked(tl, 0);
         return;
     }
     tl->dirty = true;
@@ -609,38 +928,135 @@ static void log_set_dirty(log tl)
 static void log_set_dirty(log tl)
 {
     tl->dirty = true;
-    if (buffer_length(tl->tuple_staging) >=
+    if (tl->staged_bytes >=
             bytes_from_sectors(tl->fs, range_span(tl->current->sectors))) {
-        log_flush(tl, 0);
+        log_flush_locked(tl, 0);
     }
 }
 #endif
 
+/* Stage the encoding of t, or of attribute a of t with value v if a is set.
+   The caller holds t (and v) against concurrent changes. */
+static boolean log_stage_encode(log tl, tuple t, symbol a, value v)
+{
+    if (tl->failed || tl->staged_bytes >= TFS_LOG_MAX_TUPLE_STAGING_BYTES)
+        return false;
+    boolean exclusive = false;
+    log_stage st;
+    u64 start, total, obsolete;
+  retry:
+    tlog_dict_lock(tl, exclusive);
+    st = &tl->stages[tlog_stage_index(tl)];
+    tlog_stage_lock(st);
+    start = st->b->end;
+    total = obsolete = 0;
+    u64 seq = fetch_and_add(&tl->stage_seq, 1);
+    boolean ok = true;
+    if (a) {
+        if (exclusive)
+            encode_eav(st->b, tl->dictionary, t, a, v, &obsolete);
+        else
+            ok = encode_eav_existing(st->b, tl->dictionary, t, a, v, &obsolete);
+        total = 1;
+    } else {
+        if (exclusive)
+            encode_tuple(st->b, tl->dictionary, t, &total);
+        else
+            ok = encode_tuple_existing(st->b, tl->dictionary, t, &total);
+    }
+    if (!ok) {
+        /* new dictionary entries are needed */
+        st->b->end = start;
+        tlog_stage_unlock(st);
+        tlog_dict_unlock(tl, false);
+        exclusive = true;
+        goto retry;
+    }
+    u64 len = st->b->end - start;
+    vector_push(st->records, (void *)seq);
+    vector_push(st->records, (void *)len);
+    tlog_stage_unlock(st);
+    tlog_dict_unlock(tl, exclusive);
+    fetch_and_add(&tl->staged_bytes, len);
+    fetch_and_add(&tl->total_entries, total);
+    if (obsolete)
+        fetch_and_add(&tl->obsolete_entries, obsolete);
+
+    tlog_lock(tl);
+    log_set_dirty(tl);
+    boolean success = !tl->failed;
+    tlog_unlock(tl);
+    return success;
+}
+
 boolean log_write_eav(log tl, tuple e, symbol a, value v)
 {
     tlog_debug("log_write_eav: tl %p, e %p, a %b, v %p\n", tl, e, symbol_string(a), v);
-    u64 len = buffer_length(tl->tuple_staging);
-    if (tl->failed || len >= TFS_LOG_MAX_TUPLE_STAGING_BYTES)
+    return log_stage_encode(tl, e, a, v);
+}
+
+/* Encode t as a checkpoint of a new, empty log, to be written on the next
+   flush. If no contiguous storage can be found for it, the encoding is
+   committed to the log extensions as with log_write(). */
+boolean log_checkpoint(log tl, tuple t)
+{
+    tlog_debug("log_checkpoint: tl %p, t %p\n", tl, t);
+    filesystem fs = tl->fs;
+    tlog_lock(tl);
+    buffer b = tl->tuple_staging;
+    assert(buffer_length(b) == 0 && !tl->checkpoint_buf);
+    if (tl->failed) {
+        tlog_unlock(tl);
         return false;
-    encode_eav(tl->tuple_staging, tl->dictionary, e, a, v, &tl->obsolete_entries);
-    tl->total_entries++;
-    len = buffer_length(tl->tuple_staging) - len;
-    vector_push(tl->encoding_lengths, (void *)len);
+    }
+    tlog_dict_lock(tl, true);
+    assert(tl->stage_seq == 0);
+    encode_tuple(b, tl->dictionary, t, &tl->total_entries);
+    tlog_dict_unlock(tl, true);
+    u64 bytes = buffer_length(b);
+    u64 nblocks = sector_from_offset(fs, pad(bytes, fs_blocksize(fs)));
+    u64 padding = bytes_from_sectors(fs, nblocks) - bytes;
+    u64 start = filesystem_allocate_storage(fs, nblocks);
+    buffer staging = INVALID_ADDRESS;
+    rmnode n = INVALID_ADDRESS;
+    if (start != INVALID_PHYSICAL) {
+        staging = allocate_buffer(tl->h, PAGESIZE);
+        n = allocate(tl->h, sizeof(*n));
+    }
+    if (staging == INVALID_ADDRESS || n == INVALID_ADDRESS ||
+        !buffer_extend(b, padding)) {
+        tlog_debug("   unable to set up checkpoint, writing to log\n");
+        if (start != INVALID_PHYSICAL)
+            filesystem_free_storage(fs, irangel(start, nblocks));
+        if (staging != INVALID_ADDRESS)
+            deallocate_buffer(staging);
+        if (n != INVALID_ADDRESS)
+            deallocate(tl->h, n, sizeof(*n));
+        vector_push(tl->encoding_lengths, (void *)bytes);
+        log_set_dirty(tl);
+        tlog_unlock(tl);
+        return true;
+    }
+    /* the padding up to the block size is written out too */
+    zero(buffer_end(b), padding);
+    tl->checkpoint = irangel(start, nblocks);
+    tl->checkpoint_bytes = bytes;
+    rmnode_init(n, tl->checkpoint);
+    rangemap_insert(tl->extensions, n);
+
+    /* the checkpoint takes the staged encoding */
+    tl->checkpoint_buf = b;
+    tl->tuple_staging = staging;
+    tlog_debug("   checkpoint at %R, %ld bytes\n", tl->checkpoint, bytes);
     log_set_dirty(tl);
-    return !tl->failed;
+    tlog_unlock(tl);
+    return true;
 }
 
 boolean log_write(log tl, tuple t)
 {
     tlog_debug("log_write: tl %p, t %p\n", tl, t);
-    u64 len = buffer_length(tl->tuple_staging);
-    if (tl->failed || len >= TFS_LOG_MAX_TUPLE_STAGING_BYTES)
-        return false;
-    encode_tuple(tl->tuple_staging, tl->dictionary, t, &tl->total_entries);
-    len = buffer_length(tl->tuple_staging) - len;
-    vector_push(tl->encoding_lengths, (void *)len);
-    log_set_dirty(tl);
-    return !tl->failed;
+    return log_stage_encode(tl, t, 0, 0);
 }
 
 #endif /* !TLOG_READ_ONLY */
@@ -668,7 +1084,7 @@ static status log_hdr_parse(buffer b, boolean first_ext, u64 *length, u8 *uuid,
         return timm("result", "tfs magic mismatch");
     buffer_consume(b, TFS_MAGIC_BYTES);
     u64 version = pop_varint(b);
-    if (version != TFS_VERSION)
+    if (version < TFS_VERSION_COMPAT || version > TFS_VERSION)
         return timm("result", "tfs version mismatch (read %ld, build %ld)",
             version, TFS_VERSION);
     *length = pop_varint(b);
@@ -680,43 +1096,325 @@ static status log_hdr_parse(buffer b, boolean first_ext, u64 *length, u8 *uuid,
     return STATUS_OK;
 }
 
-static void log_read(log tl, status_handler sh);
+static void log_ext_wait(log_ext ext, status_handler sh);
+static void log_parse_extension(log_ext ext, status_handler sh);
+static void log_parse_done(log tl, status s, status_handler sh);
 
-closure_function(4, 1, void, log_read_complete,
-                 log_ext, ext, sg_list, sg, u64, length, status_handler, sh,
-                 status, read_status)
+closure_function(4, 1, void, log_read_checkpoint_complete,
+                 log_ext, ext, buffer, cb, status_handler, sh, timestamp, start,
+                 status, s)
 {
     log_ext ext = bound(ext);
     log tl = ext->tl;
-    status s = STATUS_OK;
+    buffer cb = bound(cb);
     status_handler sh = bound(sh);
-    u8 frame = 0;
-    u64 sector, length, tuple_length;
+    tlog_debug("%s: status %v\n", __func__, s);
+    if (!is_ok(s)) {
+        s = timm_up(s, "result", "checkpoint read failed");
+    } else {
+        buffer_produce(cb, tl->checkpoint_bytes);
+        if (!is_tuple(decode_value(tl->h, tl->dictionary, cb, &tl->total_entries,
+                                   &tl->obsolete_entries)) || buffer_length(cb) > 0)
+            s = timm("result", "invalid checkpoint");
+    }
+    deallocate_buffer(cb);
+    tl->fs->mount_stats.checkpoint = mount_timestamp() - bound(start);
+    if (is_ok(s))
+        log_parse_extension(ext, sh);   /* resume with the log tail */
+    else
+        log_parse_done(tl, s, sh);
+    closure_finish();
+}
+
+/* Read and decode the checkpoint with large requests, then resume parsing
+   the extension which references it. */
+static status log_read_checkpoint(log_ext ext, u64 sector, u64 length, u64 bytes,
+                                  status_handler sh)
+{
+    log tl = ext->tl;
+    filesystem fs = tl->fs;
+    if (length == 0 || bytes > bytes_from_sectors(fs, length) ||
+        range_span(tl->checkpoint) || ext->sectors.start != 0)
+        return timm("result", "invalid checkpoint (sector %ld, length %ld, bytes %ld)",
+                    sector, length, bytes);
+    tl->checkpoint = irangel(sector, length);
+    tl->checkpoint_bytes = bytes;
+#ifndef TLOG_READ_ONLY
+    if (!filesystem_reserve_storage(fs, tl->checkpoint))
+        return timm("result", "failed to reserve checkpoint sectors %R", tl->checkpoint);
+    rmnode n = allocate(tl->h, sizeof(*n));
+    if (n == INVALID_ADDRESS)
+        return timm("result", "failed to allocate checkpoint node");
+    rmnode_init(n, tl->checkpoint);
+    rangemap_insert(tl->extensions, n);
+#endif
+    buffer cb = allocate_buffer(tl->h, bytes_from_sectors(fs, length));
+    if (cb == INVALID_ADDRESS)
+        return timm("result", "failed to allocate checkpoint buffer");
+    tlog_debug("%s: reading checkpoint at %R, %ld bytes\n", __func__, tl->checkpoint, bytes);
+    log_checkpoint_io(tl, buffer_ref(cb, 0), false,
+                      closure(tl->h, log_read_checkpoint_complete, ext, cb, sh,
+                              mount_timestamp()));
+    return STATUS_OK;
+}
+
+/* Locate the link to the next extension without decoding any tuples. */
+static boolean log_find_link(buffer staging, range *r)
+{
+    buffer sb = alloca_wrap_buffer(buffer_ref(staging, 0), buffer_length(staging));
+    u64 sector, length;
+    while (buffer_length(sb) > 0) {
+        switch (pop_u8(sb)) {
+        case END_OF_SEGMENT:
+            break;
+        case TUPLE_AVAILABLE:
+            pop_varint(sb);     /* tuple length */
+            /* fall through */
+        case TUPLE_EXTENDED:
+            length = pop_varint(sb);
+            if (length > buffer_length(sb))
+                return false;
+            buffer_consume(sb, length);
+            break;
+        case CHECKPOINT:
+            pop_varint(sb);
+            pop_varint(sb);
+            pop_varint(sb);
+            break;
+        case LOG_EXTENSION_LINK:
+            sector = pop_varint(sb);
+            length = pop_varint(sb);
+            if (length == 0)
+                return false;
+            *r = irangel(sector, length);
+            return true;
+        default:
+            /* end of log, or a malformed frame which the parser will report */
+            return false;
+        }
+    }
+    return false;
+}
+
+static void log_read_window_release(log tl)
+{
+    if (tl->read_window) {
+        deallocate(tl->h, tl->read_window, tl->read_window_alloc);
+        tl->read_window = 0;
+        tl->read_window_alloc = 0;
+    }
+    tl->read_window_sectors = irange(0, 0);
+}
+
+/* Fill the extension staging buffer from the last read, if it covers it. */
+static boolean log_ext_from_window(log_ext ext)
+{
+    log tl = ext->tl;
+    if (!tl->read_window || !range_contains(tl->read_window_sectors, ext->sectors))
+        return false;
+    u64 offset = bytes_from_sectors(tl->fs, ext->sectors.start - tl->read_window_sectors.start);
+    assert(buffer_write(ext->staging, tl->read_window + offset,
+                        bytes_from_sectors(tl->fs, range_span(ext->sectors))));
+    dump_staging(ext);
+    return true;
+}
+
+static void log_ext_parse(log_ext ext, status_handler sh);
+static void log_ext_read_sectors(log_ext ext, range sectors);
+
+static void log_parse_finish(log tl, status s, status_handler sh)
+{
+    if (is_ok(s))
+        log_read_window_release(tl);
+    apply(sh, s);
+}
+
+static void log_ext_drained(log_ext ext, status_handler sh)
+{
+    log tl = ext->tl;
+    status s = ext->drain_status;
+    if (!is_ok(ext->read_status))
+        timm_dealloc(ext->read_status);
+    close_log_extension(ext);
+    log_parse_finish(tl, s, sh);
+}
+
+static void log_ext_read_done(log_ext ext, status s)
+{
+    tlog_ext_lock(ext);
+    ext->read_status = s;
+    ext->read_done = true;
+    status_handler sh = ext->read_waiter;
+    ext->read_waiter = 0;
+    tlog_ext_unlock(ext);
+    if (sh && ext->read_drain) {
+        log_ext_drained(ext, sh);
+    } else if (sh) {
+        ext->tl->fs->mount_stats.io_wait += mount_timestamp() - ext->read_wait_start;
+        log_ext_parse(ext, sh);
+    }
+}
 
-    if (!is_ok(read_status)) {
-        tlog_debug("log_read failure: %v\n", read_status);
-        apply(sh, timm_up(read_status, "result", "read failed"));
+closure_function(3, 1, void, log_read_complete,
+                 log_ext, ext, sg_list, sg, range, sectors,
+                 status, s)
+{
+    log_ext ext = bound(ext);
+    log tl = ext->tl;
+    range sectors = bound(sectors);
+    tlog_debug("%s: sectors %R, status %v\n", __func__, sectors, s);
+    deallocate_sg_list(bound(sg));
+    if (is_ok(s)) {
+        tl->read_window_sectors = sectors;
+        tl->fs->mount_stats.reads++;
+        tl->fs->mount_stats.read_bytes += bytes_from_sectors(tl->fs, range_span(sectors));
+        assert(log_ext_from_window(ext));
+    } else if (range_span(sectors) > range_span(ext->sectors)) {
+        /* the read-ahead may run past the end of the device */
+        tlog_debug("%s: read-ahead failed, reading extension only\n", __func__);
+        timm_dealloc(s);
+        log_ext_read_sectors(ext, ext->sectors);
         closure_finish();
         return;
+    } else {
+        tlog_debug("log_read failure: %v\n", s);
+        s = timm_up(s, "result", "read failed");
     }
+    log_ext_read_done(ext, s);
+    closure_finish();
+}
 
-    /* staging is preallocated to size */
+/* Start reading an extension. Extensions are allocated mostly back to back,
+   so the read extends past it to pick up the ones likely to be linked next. */
+static void log_ext_read(log_ext ext)
+{
+    log tl = ext->tl;
+    filesystem fs = tl->fs;
+    if (log_ext_from_window(ext)) {
+        log_ext_read_done(ext, STATUS_OK);
+        return;
+    }
+    range sectors = irangel(ext->sectors.start,
+                            sector_from_offset(fs, TFS_LOG_READ_AHEAD_BYTES));
+    sectors.end = MIN(sectors.end, sector_from_offset(fs, fs->size));
+    sectors.end = MAX(sectors.end, ext->sectors.end);
+    log_ext_read_sectors(ext, sectors);
+}
+
+static void log_ext_read_sectors(log_ext ext, range sectors)
+{
+    log tl = ext->tl;
+    filesystem fs = tl->fs;
+    bytes length = bytes_from_sectors(fs, range_span(sectors));
+    if (length > tl->read_window_alloc) {
+        log_read_window_release(tl);
+        tl->read_window = allocate(tl->h, length);
+        if (tl->read_window == INVALID_ADDRESS) {
+            tl->read_window = 0;
+            log_ext_read_done(ext, timm("result", "failed to allocate read buffer"));
+            return;
+        }
+        tl->read_window_alloc = length;
+    }
+    tl->read_window_sectors = irange(0, 0);     /* contents undefined until complete */
+    sg_list sg = allocate_sg_list();
+    if (sg == INVALID_ADDRESS) {
+        log_ext_read_done(ext, timm("result", "failed to allocate sg list"));
+        return;
+    }
+    sg_buf sgb = sg_list_tail_add(sg, length);
+    sgb->buf = tl->read_window;
+    sgb->size = length;
+    sgb->offset = 0;
+    sgb->refcount = 0;
+    status_handler tlc = closure(tl->h, log_read_complete, ext, sg, sectors);
+    tlog_debug("%s: issuing sg read, sg %p, sectors %R\n", __func__, sg, sectors);
+    apply((sg_io)&ext->read, sg, irangel(0, length), tlc);
+}
+
+/* Parse an extension whose read has completed. The read of the extension it
+   links to, if any, is issued first so that it overlaps the decoding. */
+static void log_ext_parse(log_ext ext, status_handler sh)
+{
+    log tl = ext->tl;
+    status s = ext->read_status;
+    if (!is_ok(s))
+        goto fail;
     buffer b = ext->staging;
-    buffer_produce(b, bound(length));
-    deallocate_sg_list(bound(sg));
-    dump_staging(ext);
-    tlog_debug("log_read_complete: buffer len %d, status %v\n", buffer_length(b), read_status);
-    tlog_debug("-> new log extension, checking magic and version\n");
+    tlog_debug("%s: buffer len %d\n", __func__, buffer_length(b));
     if (!ext->open) {
-        length = 0;
+        tlog_debug("-> new log extension, checking magic and version\n");
+        u64 length = 0;
         s = log_hdr_parse(b, ext->sectors.start == 0, &length, tl->fs->uuid,
             tl->fs->label);
         if (!is_ok(s))
-            goto out_apply_status;
+            goto fail;
         /* XXX the length is really for validation...so hook it up */
         tlog_debug("%ld sectors\n", length);
         ext->open = true;
     }
+    range r;
+    if (log_find_link(b, &r)) {
+        log_ext next = open_log_extension(tl, r);
+        if (next == INVALID_ADDRESS) {
+            s = timm("result", "unable to open log extension");
+            goto fail;
+        }
+        tl->prefetch = next;
+        log_ext_read(next);
+    }
+    tl->fs->mount_stats.extensions++;
+    log_parse_extension(ext, sh);
+    return;
+  fail:
+    log_parse_done(tl, s, sh);
+}
+
+/* End the parse with status s. The read of the next extension, issued
+   ahead of decoding, may still be in flight into the read window; the
+   extension is closed, and sh applied, only once that read is done, so that
+   the log may be destroyed on failure. */
+static void log_parse_done(log tl, status s, status_handler sh)
+{
+    buffer_clear(tl->tuple_staging);
+    log_ext ext = tl->prefetch;
+    if (!ext) {
+        log_parse_finish(tl, s, sh);
+        return;
+    }
+    tl->prefetch = 0;
+    tlog_ext_lock(ext);
+    ext->read_drain = true;
+    ext->drain_status = s;
+    boolean done = ext->read_done;
+    if (!done)
+        ext->read_waiter = sh;
+    tlog_ext_unlock(ext);
+    if (done)
+        log_ext_drained(ext, sh);
+}
+
+static void log_ext_wait(log_ext ext, status_handler sh)
+{
+    tlog_ext_lock(ext);
+    boolean done = ext->read_done;
+    if (!done) {
+        ext->read_wait_start = mount_timestamp();
+        ext->read_waiter = sh;
+    }
+    tlog_ext_unlock(ext);
+    if (done)
+        log_ext_parse(ext, sh);
+}
+
+static void log_parse_extension(log_ext ext, status_handler sh)
+{
+    log tl = ext->tl;
+    buffer b = ext->staging;
+    status s = STATUS_OK;
+    u8 frame = 0;
+    u64 sector, length, tuple_length;
+    timestamp start = mount_timestamp();
 
     /* need to check bounds */
     while ((frame = pop_u8(b)) != END_OF_LOG) {
@@ -733,22 +1431,34 @@ closure_function(4, 1, void, log_read_complete,
                 goto out_apply_status;
             }
             range r = irangel(sector, length);
-            close_log_extension(ext);
-            ext = open_log_extension(tl, r);
-            if (ext == INVALID_ADDRESS) {
-                s = timm("result", "unable to open log extension");
+            ext = tl->prefetch;
+            if (!ext || !range_equal(ext->sectors, r)) {
+                s = timm("result", "unexpected log extension link %R", r);
                 goto out_apply_status;
             }
-            tl->current = ext;
 #ifndef TLOG_READ_ONLY
             if (!filesystem_reserve_storage(tl->fs, r)) {
                 s = timm("result", "failed to reserve sectors %R in log extension", r);
                 goto out_apply_status;
             }
 #endif
+            tl->prefetch = 0;
+            close_log_extension(tl->current);
+            tl->current = ext;
             /* chain to next log extension, carrying status handler to end */
-            log_read(tl, sh);
-            goto out;
+            tl->fs->mount_stats.decode += mount_timestamp() - start;
+            log_ext_wait(ext, sh);
+            return;
+        case CHECKPOINT:
+            tlog_debug("-> checkpoint\n");
+            sector = pop_varint(b);
+            length = pop_varint(b);
+            u64 bytes = pop_varint(b);
+            s = log_read_checkpoint(ext, sector, length, bytes, sh);
+            if (!is_ok(s))
+                goto out_apply_status;
+            tl->fs->mount_stats.decode += mount_timestamp() - start;
+            return;             /* parsing resumes on checkpoint read completion */
         case TUPLE_AVAILABLE:
             tlog_debug("-> tuple available\n");
             if (tl->tuple_bytes_remain > 0) {
@@ -823,13 +1533,12 @@ closure_function(4, 1, void, log_read_complete,
         deallocate_table(tl->dictionary);
         tl->dictionary = newdict;
     }
+    tl->fs->mount_stats.log_done = mount_timestamp();
 
   out_apply_status:
-    tlog_debug("log_read_complete exit with status %v\n", s);
-    buffer_clear(tl->tuple_staging);
-    apply(sh, s);
-  out:
-    closure_finish();
+    tl->fs->mount_stats.decode += mount_timestamp() - start;
+    tlog_debug("%s exit with status %v\n", __func__, s);
+    log_parse_done(tl, s, sh);
 }
 
 static void log_read(log tl, status_handler sh)
@@ -837,21 +1546,8 @@ static void log_read(log tl, status_handler sh)
     log_ext ext = tl->current;
     assert(ext);
     assert(!ext->open);
-    sg_list sg = allocate_sg_list();
-    if (sg == INVALID_ADDRESS) {
-        apply(sh, timm("result", "failed to allocate sg list"));
-        return;
-    }
-    range r = irangel(0, bytes_from_sectors(tl->fs, range_span(ext->sectors)));
-    u64 length = range_span(r);
-    sg_buf sgb = sg_list_tail_add(sg, length);
-    sgb->buf = buffer_ref(ext->staging, 0);
-    sgb->size = length;
-    sgb->offset = 0;
-    sgb->refcount = 0;
-    status_handler tlc = closure(tl->h, log_read_complete, ext, sg, length, sh);
-    tlog_debug("%s: issuing sg read, sg %p, r %R\n", __func__, sg, r);
-    apply((sg_io)&ext->read, sg, r, tlc);
+    log_ext_read(ext);
+    log_ext_wait(ext, sh);
 }
 
 boolean filesystem_probe(u8 *first_sector, u8 *uuid, char *label)
@@ -916,6 +1612,8 @@ log log_create(heap h, filesystem fs, boolean initialize, status_handler sh)
 
 void log_destroy(log tl)
 {
+    /* parse completion waits for any read-ahead before the log can go away */
+    assert(!tl->prefetch);
 #ifdef KERNEL
     remove_timer(kernel_timers, &tl->flush_timer, 0);
 #endif
@@ -923,9 +1621,13 @@ void log_destroy(log tl)
 #ifndef TLOG_READ_ONLY
     deallocate_rangemap(tl->extensions, stack_closure(log_dealloc_ext_node,
         tl));
+    log_stages_dealloc(tl);
 #endif
     deallocate_vector(tl->encoding_lengths);
     deallocate_buffer(tl->tuple_staging);
+    if (tl->checkpoint_buf)
+        deallocate_buffer(tl->checkpoint_buf);
+    log_read_window_release(tl);
     close_log_extension(tl->current);
     deallocate_table(tl->dictionary);
     deallocate(tl->h, tl, sizeof(*tl));
@@ -58,6 +58,7 @@ static void blockq_apply(blockq bq, thread t, u64 bq_flags)
                  (bq_flags & BLOCKQ_ACTION_TIMEDOUT) ? "timedout" : "");
 
     assert(t->blocked_on == bq);
+    count_syscall_unblock(t);
     async_apply_1((async_1)t->bq_action, (void *)bq_flags); /* bq_action retval ignored */
 }
 
@@ -229,6 +230,7 @@ sysreturn blockq_check_timeout(blockq bq, thread t, blockq_action a, boolean in_
     }
     t->bq_remain_at_wake = 0;
     list_insert_before(&bq->waiters_head, &t->bq_l);
+    count_syscall_block(t);
     boolean wake = bq->wake;
     thread_unlock(t);
     blockq_unlock(bq);
@@ -346,7 +348,7 @@ blockq allocate_blockq(heap h, char * name)
     }
     bq->name[len] = '\0';
     bq->wake = false;
-    spin_lock_init(&bq->lock);
+    spin_lock_init_class(&bq->lock, "blockq");
     list_init(&bq->waiters_head);
     init_refcount(&bq->refcount, 1, init_closure(&bq->free, free_blockq, bq));
     return bq;
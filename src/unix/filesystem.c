@@ -434,14 +434,17 @@ static void fs_notify_internal(tuple md, u64 event, symbol name, u32 cookie)
     }
 }
 
-void fs_notify_event(tuple n, u64 event)
+/* Called with n locked (see filesystem_get_meta()). */
+void fs_notify_event(filesystem fs, tuple n, u64 event)
 {
     if (is_dir(n))
         event |= IN_ISDIR;
     fs_notify_internal(n, event, 0, 0);
-    tuple parent = get_tuple(n, sym_this(".."));
-    if (parent != n)
+    tuple parent = filesystem_get_parent(fs, n);
+    if (parent) {
         fs_notify_internal(parent, event, tuple_get_symbol(children(parent), n), 0);
+        filesystem_put_parent(fs, parent);
+    }
 }
 
 void fs_notify_create(tuple t, tuple parent, symbol name)
@@ -468,9 +471,9 @@ void fs_notify_delete(tuple t, tuple parent, symbol name)
     fs_notify_internal(parent, IN_DELETE | flags, name, 0);
 }
 
-void fs_notify_modify(tuple t)
+void fs_notify_modify(filesystem fs, tuple t)
 {
-    fs_notify_event(t, IN_MODIFY);
+    fs_notify_event(fs, t, IN_MODIFY);
 }
 
 void fs_notify_release(tuple t, boolean unmounted)
@@ -1,142 +1,214 @@
 #include <unix_internal.h>
 
-struct futex {
-    heap h;
-    blockq bq;
+/* Futex waiters are kept on a fixed-size hash table of buckets, keyed by user
+   address. A waiter entry exists only while its thread is blocked in a futex
+   wait: FUTEX_WAIT uses the entry embedded in the thread, while futex_waitv
+   allocates an array of entries for the duration of the call. Blocking itself
+   happens on the thread blockq. A waker claims a thread by setting
+   t->futex_woken to the index of the matching entry; any entries left on
+   buckets are removed by the waiting thread before returning. */
+
+#define FUTEX_HASH_ORDER    10
+#define FUTEX_HASH_SIZE     U64_FROM_BIT(FUTEX_HASH_ORDER)
+
+struct futex_bucket {
     struct spinlock lock;
+    struct list waiters;
 };
 
-#define futex_lock(f)   spin_lock(&(f)->lock)
-#define futex_unlock(f) spin_unlock(&(f)->lock)
+BSS_RO_AFTER_INIT static struct futex_bucket *futex_buckets;
+BSS_RO_AFTER_INIT static heap futex_heap;
+static boolean futex_verbose;
+
+#define futex_lock(b)   spin_lock(&(b)->lock)
+#define futex_unlock(b) spin_unlock(&(b)->lock)
 
-static u64 futex_key_function(void *x)
+static struct futex_bucket *futex_bucket_from_uaddr(int *uaddr)
 {
-    return u64_from_pointer(x);
+    u64 k = (u64_from_pointer(uaddr) >> 2) * 0x9e3779b97f4a7c15ull;
+    return &futex_buckets[k >> (64 - FUTEX_HASH_ORDER)];
 }
 
-static boolean futex_key_equal(void *a, void *b)
+static void futex_lock_2(struct futex_bucket *b1, struct futex_bucket *b2)
 {
-    return a == b;
+    if (b1 == b2)
+        futex_lock(b1);
+    else
+        spin_lock_2(&b1->lock, &b2->lock);
 }
 
-static struct futex * soft_create_futex(process p, u64 key)
+static void futex_unlock_2(struct futex_bucket *b1, struct futex_bucket *b2)
 {
-    heap h = heap_locked(get_kernel_heaps());
-    struct futex * f;
-
-    process_lock(p);
-
-    f = table_find(p->futices, pointer_from_u64(key));
-    if (f)
-        goto out;
-
-    f = allocate(h, sizeof(struct futex));
-    if (f == INVALID_ADDRESS) {
-        msg_err("failed to allocate futex\n");
-        goto out;
-    }
+    if (b1 != b2)
+        futex_unlock(b2);
+    futex_unlock(b1);
+}
 
-    f->h = h;
-    f->bq = allocate_blockq(f->h, "futex");
-    if (f->bq == INVALID_ADDRESS) {
-        msg_err("failed to allocate futex blockq\n");
-        deallocate(f->h, f, sizeof(struct futex));
-        f = INVALID_ADDRESS;
-        goto out;
+/* A requeue may move the waiter to another bucket while we wait for the lock. */
+static struct futex_bucket *futex_lock_waiter(struct futex_waiter *w)
+{
+    while (1) {
+        struct futex_bucket *b = futex_bucket_from_uaddr(*(int * volatile *)&w->uaddr);
+        futex_lock(b);
+        if (b == futex_bucket_from_uaddr(w->uaddr))
+            return b;
+        futex_unlock(b);
     }
-
-    spin_lock_init(&f->lock);
-    table_set(p->futices, pointer_from_u64(key), f);
-  out:
-    process_unlock(p);
-    return f;
 }
 
-static thread futex_wake_one(struct futex * f)
+/* Called with the bucket lock held. The waiting thread takes the lock of each
+   of its entries before completing the wait, so the thread (and its blockq)
+   cannot go away while the wakeup is being issued. */
+static boolean futex_wake_waiter(struct futex_waiter *w)
 {
-    thread t = blockq_wake_one(f->bq);
-    if (t != INVALID_ADDRESS)
-        return t;
-    kern_pause();
-    return t;
+    thread t = w->t;
+    if (!compare_and_swap_32((u32 *)&t->futex_woken, -1, w->index))
+        return false;
+    list_delete(&w->l);
+    blockq_wake_one(t->thread_bq);
+    return true;
 }
 
 /*
- * Wake up to 'val' waiters
+ * Wake up to 'val' waiters on uaddr whose bitset intersects 'bitset'
  * Return the number woken
  */
-static int futex_wake_many(struct futex * f, int val)
+static int futex_wake_many(struct futex_bucket *b, process p, int *uaddr, u32 bitset, int val)
 {
-    int nr_woken;
-
-    for (nr_woken = 0; nr_woken < val; nr_woken++) {
-        thread w = futex_wake_one(f);
-        if (w == INVALID_ADDRESS)
+    int nr_woken = 0;
+    list_foreach(&b->waiters, l) {
+        if (nr_woken >= val)
             break;
+        struct futex_waiter *w = struct_from_list(l, struct futex_waiter *, l);
+        if (w->p != p || w->uaddr != uaddr || !(w->bitset & bitset))
+            continue;
+        if (futex_wake_waiter(w))
+            nr_woken++;
     }
-
     return nr_woken;
 }
 
-boolean futex_wake_many_by_uaddr(process p, int *uaddr, int val)
+/* Move up to 'val' waiters from uaddr to uaddr2; both buckets must be locked. */
+static int futex_requeue(struct futex_bucket *b, struct futex_bucket *b2, process p,
+                         int *uaddr, int *uaddr2, int val)
 {
-    struct futex * f;
+    int requeued = 0;
+    list_foreach(&b->waiters, l) {
+        if (requeued >= val)
+            break;
+        struct futex_waiter *w = struct_from_list(l, struct futex_waiter *, l);
+        if (w->p != p || w->uaddr != uaddr)
+            continue;
+        w->uaddr = uaddr2;
+        if (b2 != b) {
+            list_delete(&w->l);
+            list_insert_before(&b2->waiters, &w->l);
+        }
+        requeued++;
+    }
+    return requeued;
+}
 
-    process_lock(p);
-    f = table_find(p->futices, (void *)uaddr);
-    process_unlock(p);
-    if (!f)
-        return false;
+boolean futex_wake_many_by_uaddr(process p, int *uaddr, int val)
+{
+    struct futex_bucket *b = futex_bucket_from_uaddr(uaddr);
+    futex_lock(b);
+    int nr_woken = futex_wake_many(b, p, uaddr, FUTEX_BITSET_MATCH_ANY, val);
+    futex_unlock(b);
+    return nr_woken > 0;
+}
 
-    futex_lock(f);
-    futex_wake_many(f, val);
-    futex_unlock(f);
-    return true;
+/* Remove any entries still queued and return the index of the woken entry, or -1. */
+static int futex_cancel_wait(struct futex_waiter *waiters, int n, thread t)
+{
+    for (int i = 0; i < n; i++) {
+        struct futex_waiter *w = &waiters[i];
+        struct futex_bucket *b = futex_lock_waiter(w);
+        if (list_inserted(&w->l))
+            list_delete(&w->l);
+        futex_unlock(b);
+    }
+    return t->futex_woken;
 }
 
 /*
  * futex_bh is invoked either by the bh processor in response
- * to timeout/signal delivery/etc., or by another thread in sys_futex
+ * to timeout/signal delivery/etc., or by a waker in sys_futex
  *
  * Return:
  *  BLOCKQ_BLOCK_REQUIRED: top half, going to block
  *  -ETIMEDOUT: if we timed out
  *  -EINTR: if we're being nullified
- *  0: thread woken up
+ *  index of the woken waiter (0 for FUTEX_WAIT): thread woken up
  */
-closure_function(3, 1, sysreturn, futex_bh,
-                 struct futex *, f, thread, t, timestamp, timeout,
+closure_function(4, 1, sysreturn, futex_bh,
+                 struct futex_waiter *, waiters, int, n, thread, t, timestamp, timeout,
                  u64, flags)
 {
     thread t = bound(t);
-    struct futex *f = bound(f);
+    struct futex_waiter *waiters = bound(waiters);
+    int n = bound(n);
     sysreturn rv;
 
-    if (!(flags & BLOCKQ_ACTION_BLOCKED)) {
-        futex_unlock(f);
-        thread_log(t, "%s: struct futex: %p, blocking", __func__, f);
-        return BLOCKQ_BLOCK_REQUIRED;
-    }
-
-    if (flags & (BLOCKQ_ACTION_NULLIFY | BLOCKQ_ACTION_TIMEDOUT)) {
-        if (flags & BLOCKQ_ACTION_NULLIFY)
-            rv = bound(timeout) ? -EINTR : -ERESTARTSYS;
-        else
-            rv = -ETIMEDOUT;
-    } else {
-        rv = 0; /* no timer expire + not us --> actual wakeup */
+    if (t->futex_woken < 0) {
+        if (!(flags & BLOCKQ_ACTION_BLOCKED)) {
+            thread_log(t, "%s: waiters %p (%d), blocking", __func__, waiters, n);
+            return BLOCKQ_BLOCK_REQUIRED;
+        }
+        if (!(flags & (BLOCKQ_ACTION_NULLIFY | BLOCKQ_ACTION_TIMEDOUT))) {
+            /* The thread blockq was woken by someone other than a futex waker;
+               resume blocking, then catch a futex wakeup that may have been
+               issued while the thread was off the blockq. */
+            blockq_block_required(t, flags);
+            if (t->futex_woken >= 0)
+                blockq_wake_one(t->thread_bq);
+            return BLOCKQ_BLOCK_REQUIRED;
+        }
     }
 
-    thread_log(t, "%s: struct futex: %p, flags 0x%lx, rv %ld", __func__, f, flags, rv);
+    int woken = futex_cancel_wait(waiters, n, t);
+    if (woken >= 0)
+        rv = woken;
+    else if (flags & BLOCKQ_ACTION_NULLIFY)
+        rv = bound(timeout) ? -EINTR : -ERESTARTSYS;
+    else
+        rv = -ETIMEDOUT;
+
+    thread_log(t, "%s: waiters %p (%d), flags 0x%lx, rv %ld", __func__, waiters, n, flags, rv);
+    if (waiters != &t->futex_waiter)
+        deallocate(futex_heap, waiters, n * sizeof(struct futex_waiter));
     closure_finish();
     return syscall_return(t, rv);
 }
 
-closure_function(1, 1, void, futex_requeue_handler,
-                 struct futex *, dest,
-                 blockq_action, action)
+static void futex_waiter_init(struct futex_waiter *w, thread t, int *uaddr, u32 bitset, int index)
 {
-    closure_member(futex_bh, action, f) = bound(dest);
+    list_init_member(&w->l);
+    w->p = t->p;
+    w->uaddr = uaddr;
+    w->bitset = bitset;
+    w->index = index;
+    w->t = t;
+}
+
+static sysreturn futex_wait(thread t, int *uaddr, int val, u32 bitset,
+                            clock_id clkid, timestamp ts, boolean absolute)
+{
+    struct futex_waiter *w = &t->futex_waiter;
+    struct futex_bucket *b = futex_bucket_from_uaddr(uaddr);
+
+    futex_waiter_init(w, t, uaddr, bitset, 0);
+    t->futex_woken = -1;
+    futex_lock(b);
+    if (*uaddr != val) {
+        futex_unlock(b);
+        return -EAGAIN;
+    }
+    list_insert_before(&b->waiters, &w->l);
+    futex_unlock(b);
+    return blockq_check_timeout(t->thread_bq, t,
+                                contextual_closure(futex_bh, w, 1, t, ts),
+                                false, clkid, ts, absolute);
 }
 
 static timestamp get_timeout_timestamp(int futex_op, u64 val2)
@@ -152,55 +224,53 @@ static timestamp get_timeout_timestamp(int futex_op, u64 val2)
     }
 }
 
-static boolean futex_verbose;
-
 sysreturn futex(int *uaddr, int futex_op, int val,
                 u64 val2, int *uaddr2, int val3)
 {
-    struct futex * f;
+    process p = current->p;
+    struct futex_bucket *b;
     timestamp ts;
     int op;
 
     if (!validate_user_memory(uaddr, sizeof(int), false))
         return set_syscall_error(current, EFAULT);
 
-    f = soft_create_futex(current->p, u64_from_pointer(uaddr));
-    if (f == INVALID_ADDRESS)
-        return set_syscall_error(current, ENOMEM);
-    
+    b = futex_bucket_from_uaddr(uaddr);
     op = futex_op & 127; // chuck the private bit
     ts = get_timeout_timestamp(op, val2);
     clock_id clkid = (futex_op & FUTEX_CLOCK_REALTIME) ? CLOCK_ID_REALTIME :
             CLOCK_ID_MONOTONIC;
 
     switch (op) {
-    case FUTEX_WAIT: {
+    case FUTEX_WAIT:
         if (futex_verbose)
             thread_log(current, "futex_wait [%ld %p %d] %d 0x%ld",
                 current->tid, uaddr, *uaddr, val, val2);
+        return futex_wait(current, uaddr, val, FUTEX_BITSET_MATCH_ANY, clkid, ts, false);
 
-        sysreturn rv;
-        futex_lock(f);
-        if (*uaddr != val)
-            rv = -EAGAIN;
-        else
-            rv = blockq_check_timeout(f->bq, current,
-                                      contextual_closure(futex_bh, f, current, ts),
-                                      false, clkid, ts, false);
-        futex_unlock(f);
-        return rv;
-    }
+    case FUTEX_WAIT_BITSET:
+        if (futex_verbose)
+            thread_log(current, "futex_wait_bitset [%ld %p %d] %d 0x%ld %d",
+                current->tid, uaddr, *uaddr, val, val2, val3);
+        if (!val3)
+            return -EINVAL;
+        return futex_wait(current, uaddr, val, val3, clkid, ts, true);
 
-    case FUTEX_WAKE: {
+    case FUTEX_WAKE:
+    case FUTEX_WAKE_BITSET: {
+        u32 bitset = (op == FUTEX_WAKE) ? FUTEX_BITSET_MATCH_ANY : val3;
         if (futex_verbose)
-            thread_log(current, "futex_wake [%ld %p %d] %d",
-                current->tid, uaddr, *uaddr, val);
-        futex_lock(f);
-        int nr_woken = futex_wake_many(f, val);
-        futex_unlock(f);
+            thread_log(current, "futex_wake [%ld %p %d] %d 0x%x",
+                current->tid, uaddr, *uaddr, val, bitset);
+        if (!bitset)
+            return -EINVAL;
+        futex_lock(b);
+        int nr_woken = futex_wake_many(b, p, uaddr, bitset, val);
+        futex_unlock(b);
         return nr_woken;
     }
 
+    case FUTEX_REQUEUE:
     case FUTEX_CMP_REQUEUE: {
         int woken, requeued;
 
@@ -211,30 +281,21 @@ sysreturn futex(int *uaddr, int futex_op, int val,
             thread_log(current, "futex_cmp_requeue [%ld %p %d] val: %d val2: %d uaddr2: %p %d val3: %d",
                        current->tid, uaddr, *uaddr, val, val2, uaddr2, *uaddr2, val3);
 
+        struct futex_bucket *b2 = futex_bucket_from_uaddr(uaddr2);
         sysreturn rv;
-        futex_lock(f);
-        if (*uaddr != val3) {
+        futex_lock_2(b, b2);
+        if (op == FUTEX_CMP_REQUEUE && *uaddr != val3) {
             rv = -EAGAIN;
             goto cmp_requeue_done;
         }
 
-        woken = futex_wake_many(f, val);
-
-        requeued = 0;
-        if (val2 > 0) {
-            struct futex * new = soft_create_futex(current->p, u64_from_pointer(uaddr2));
-            if (new == INVALID_ADDRESS) {
-                rv = -ENOMEM;
-                goto cmp_requeue_done;
-            }
-            requeued = blockq_transfer_waiters(new->bq, f->bq, val2,
-                                               stack_closure(futex_requeue_handler, new));
-            if (futex_verbose)
-                thread_log(current, " awoken: %d, re-queued %d", woken, requeued);
-        }
+        woken = futex_wake_many(b, p, uaddr, FUTEX_BITSET_MATCH_ANY, val);
+        requeued = (int)val2 > 0 ? futex_requeue(b, b2, p, uaddr, uaddr2, val2) : 0;
+        if (futex_verbose)
+            thread_log(current, " awoken: %d, re-queued %d", woken, requeued);
         rv = woken + requeued;
       cmp_requeue_done:
-        futex_unlock(f);
+        futex_unlock_2(b, b2);
         return rv;
     }
 
@@ -253,10 +314,8 @@ sysreturn futex(int *uaddr, int futex_op, int val,
                 current->tid, uaddr, *uaddr, uaddr2, cmparg, oparg, cmp, op);
         }
 
-        struct futex *f2 = soft_create_futex(current->p, u64_from_pointer(uaddr2));
-        if (f2 == INVALID_ADDRESS)
-            return -ENOMEM;
-        spin_lock_2(&f->lock, &f2->lock);
+        struct futex_bucket *b2 = futex_bucket_from_uaddr(uaddr2);
+        futex_lock_2(b, b2);
         oldval = *(int *) uaddr2;
         
         switch (op) {
@@ -267,7 +326,7 @@ sysreturn futex(int *uaddr, int futex_op, int val,
         case FUTEX_OP_XOR:   *uaddr2 ^= oparg; break;
         }
 
-        wake1 = futex_wake_many(f, val);
+        wake1 = futex_wake_many(b, p, uaddr, FUTEX_BITSET_MATCH_ANY, val);
         
         c = 0;
         switch (cmp) {
@@ -281,33 +340,13 @@ sysreturn futex(int *uaddr, int futex_op, int val,
         
         wake2 = 0;
         if (c) {
-            wake2 = futex_wake_many(f2, val2);
+            wake2 = futex_wake_many(b2, p, uaddr2, FUTEX_BITSET_MATCH_ANY, val2);
         }
 
-        futex_unlock(f2);
-        futex_unlock(f);
+        futex_unlock_2(b, b2);
         return set_syscall_return(current, wake1 + wake2);
     }
 
-    case FUTEX_WAIT_BITSET: {
-        if (futex_verbose)
-            thread_log(current, "futex_wait_bitset [%ld %p %d] %d 0x%ld %d",
-                current->tid, uaddr, *uaddr, val, val2, val3);
-
-        sysreturn rv;
-        futex_lock(f);
-        if (*uaddr != val)
-            rv = -EAGAIN;
-        else
-            rv = blockq_check_timeout(f->bq, current,
-                                      contextual_closure(futex_bh, f, current, ts),
-                                      false, clkid, ts, true);
-        futex_unlock(f);
-        return rv;
-    }
-
-    case FUTEX_REQUEUE: rprintf("futex_requeue not implemented\n"); break;
-    case FUTEX_WAKE_BITSET: rprintf("futex_wake_bitset not implemented\n"); break;
     case FUTEX_LOCK_PI: rprintf("futex_lock_pi not implemented\n"); break;
     case FUTEX_TRYLOCK_PI: rprintf("futex_trylock_pi not implemented\n"); break;
     case FUTEX_UNLOCK_PI: rprintf("futex_unlock_pi not implemented\n"); break;
@@ -319,6 +358,67 @@ sysreturn futex(int *uaddr, int futex_op, int val,
     return set_syscall_error(current, ENOSYS);
 }
 
+sysreturn futex_waitv(struct futex_waitv *waiters, unsigned int nr_futexes, unsigned int flags,
+                      struct timespec *timeout, clock_id clockid)
+{
+    thread t = current;
+    timestamp ts = 0;
+    sysreturn rv;
+
+    if (flags || !nr_futexes || nr_futexes > FUTEX_WAITV_MAX)
+        return -EINVAL;
+    if (!validate_user_memory(waiters, nr_futexes * sizeof(struct futex_waitv), false))
+        return -EFAULT;
+    if (timeout) {
+        if ((clockid != CLOCK_ID_MONOTONIC) && (clockid != CLOCK_ID_REALTIME))
+            return -EINVAL;
+        if (!validate_user_memory(timeout, sizeof(struct timespec), false))
+            return -EFAULT;
+        ts = time_from_timespec(timeout);
+    }
+    if (futex_verbose)
+        thread_log(t, "futex_waitv [%ld] waiters %p, nr %d, timeout %T",
+                   t->tid, waiters, nr_futexes, ts);
+
+    struct futex_waiter *w = allocate(futex_heap, nr_futexes * sizeof(struct futex_waiter));
+    if (w == INVALID_ADDRESS)
+        return -ENOMEM;
+    for (int i = 0; i < nr_futexes; i++) {
+        struct futex_waitv *fw = &waiters[i];
+        if (((fw->flags & ~FUTEX_PRIVATE_FLAG) != FUTEX_32) || fw->__reserved ||
+            (fw->uaddr & (sizeof(u32) - 1))) {
+            rv = -EINVAL;
+            goto out_dealloc;
+        }
+        int *uaddr = pointer_from_u64(fw->uaddr);
+        if (!validate_user_memory(uaddr, sizeof(int), false)) {
+            rv = -EFAULT;
+            goto out_dealloc;
+        }
+        futex_waiter_init(&w[i], t, uaddr, FUTEX_BITSET_MATCH_ANY, i);
+    }
+
+    t->futex_woken = -1;
+    for (int i = 0; i < nr_futexes; i++) {
+        struct futex_bucket *b = futex_bucket_from_uaddr(w[i].uaddr);
+        futex_lock(b);
+        if (*(u32 *)w[i].uaddr != (u32)waiters[i].val) {
+            futex_unlock(b);
+            int woken = futex_cancel_wait(w, i, t);
+            rv = (woken >= 0) ? woken : -EAGAIN;
+            goto out_dealloc;
+        }
+        list_insert_before(&b->waiters, &w[i].l);
+        futex_unlock(b);
+    }
+    return blockq_check_timeout(t->thread_bq, t,
+                                contextual_closure(futex_bh, w, nr_futexes, t, ts),
+                                false, clockid, ts, true);
+  out_dealloc:
+    deallocate(futex_heap, w, nr_futexes * sizeof(struct futex_waiter));
+    return rv;
+}
+
 closure_function(0, 1, boolean, futex_trace_notify,
                  value, v)
 {
@@ -326,14 +426,19 @@ closure_function(0, 1, boolean, futex_trace_notify,
     return true;
 }
 
-void
-init_futices(process p)
+boolean futex_init(unix_heaps uh)
 {
-    heap h = heap_locked(&p->uh->kh);
-    p->futices = allocate_table(h, futex_key_function, futex_key_equal);
-    if (p->futices == INVALID_ADDRESS)
-        halt("failed to allocate futex table\n");
+    heap h = heap_locked((kernel_heaps)uh);
+    futex_heap = h;
+    futex_buckets = allocate(h, FUTEX_HASH_SIZE * sizeof(struct futex_bucket));
+    if (futex_buckets == INVALID_ADDRESS)
+        return false;
+    for (int i = 0; i < FUTEX_HASH_SIZE; i++) {
+        spin_lock_init_class(&futex_buckets[i].lock, "futex_bucket");
+        list_init(&futex_buckets[i].waiters);
+    }
     register_root_notify(sym(futex_trace), closure(h, futex_trace_notify));
+    return true;
 }
 
 /* robust mutex handling */
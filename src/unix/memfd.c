@@ -0,0 +1,345 @@
+#include <unix_internal.h>
+
+//#define MEMFD_DEBUG
+#ifdef MEMFD_DEBUG
+#define memfd_debug(x, ...) do {tprintf(sym(memfd), 0, x, ##__VA_ARGS__);} while(0)
+#else
+#define memfd_debug(x, ...)
+#endif
+
+#define MFD_NAME_MAX    249     /* NAME_MAX - strlen("memfd:") */
+
+/* Anonymous memory files are pagecache nodes without backing storage: pages are filled with
+   zeros on first access and, once dirtied, are never written back, so they remain resident
+   until truncated away or until the file is closed and unmapped. */
+typedef struct memfd {
+    struct file f;              /* must be first */
+    heap h;
+    pagecache_node pn;
+    u32 seals;
+} *memfd;
+
+BSS_RO_AFTER_INIT static pagecache_volume memfd_pv;
+
+closure_function(0, 3, void, memfd_fill_zero,
+                 sg_list, sg, range, q, status_handler, complete)
+{
+    memfd_debug("%s: q %R\n", __func__, q);
+    sg_zero_fill(sg, range_span(q));
+    apply(complete, STATUS_OK);
+}
+
+static inline u64 memfd_length(memfd mfd)
+{
+    return pagecache_get_node_length(mfd->pn);
+}
+
+static sysreturn memfd_check_write(memfd mfd, u64 offset, u64 length)
+{
+    if (mfd->seals & (F_SEAL_WRITE | F_SEAL_FUTURE_WRITE))
+        return -EPERM;
+    if ((mfd->seals & F_SEAL_GROW) && (offset + length > memfd_length(mfd)))
+        return -EPERM;
+    return 0;
+}
+
+closure_function(7, 1, void, memfd_read_complete,
+                 thread, t, memfd, mfd, sg_list, sg, void *, dest, u64, limit, boolean, is_file_offset, io_completion, completion,
+                 status, s)
+{
+    sg_list sg = bound(sg);
+    sysreturn rv;
+    if (is_ok(s)) {
+        /* copy out also releases the page references held by the sg list */
+        rv = sg_copy_to_buf_and_release(bound(dest), sg, bound(limit));
+        if (bound(is_file_offset))
+            bound(mfd)->f.offset += rv;
+    } else {
+        sg_list_release(sg);
+        deallocate_sg_list(sg);
+        timm_dealloc(s);
+        rv = -EIO;
+    }
+    apply(bound(completion), bound(t), rv);
+    closure_finish();
+}
+
+closure_function(1, 6, sysreturn, memfd_read,
+                 memfd, mfd,
+                 void *, dest, u64, length, u64, offset_arg, thread, t, boolean, bh, io_completion, completion)
+{
+    memfd mfd = bound(mfd);
+    boolean is_file_offset = offset_arg == infinity;
+    u64 offset = is_file_offset ? mfd->f.offset : offset_arg;
+    thread_log(t, "%s: mfd %p, dest %p, offset %ld, length %ld", __func__, mfd, dest, offset, length);
+    if (offset >= memfd_length(mfd))
+        return io_complete(completion, t, 0);
+    sg_list sg = allocate_sg_list();
+    if (sg == INVALID_ADDRESS)
+        return io_complete(completion, t, -ENOMEM);
+    apply(mfd->f.fs_read, sg, irangel(offset, length),
+          contextual_closure(memfd_read_complete, t, mfd, sg, dest, length, is_file_offset,
+                             completion));
+    return bh ? SYSRETURN_CONTINUE_BLOCKING : thread_maybe_sleep_uninterruptible(t);
+}
+
+closure_function(5, 1, void, memfd_sg_read_complete,
+                 thread, t, memfd, mfd, sg_list, sg, boolean, is_file_offset, io_completion, completion,
+                 status, s)
+{
+    sysreturn rv;
+    if (is_ok(s)) {
+        rv = bound(sg)->count;
+        if (bound(is_file_offset))
+            bound(mfd)->f.offset += rv;
+    } else {
+        timm_dealloc(s);
+        rv = -EIO;
+    }
+    apply(bound(completion), bound(t), rv);
+    closure_finish();
+}
+
+closure_function(1, 6, sysreturn, memfd_sg_read,
+                 memfd, mfd,
+                 sg_list, sg, u64, length, u64, offset_arg, thread, t, boolean, bh, io_completion, completion)
+{
+    memfd mfd = bound(mfd);
+    boolean is_file_offset = offset_arg == infinity;
+    u64 offset = is_file_offset ? mfd->f.offset : offset_arg;
+    thread_log(t, "%s: mfd %p, sg %p, offset %ld, length %ld", __func__, mfd, sg, offset, length);
+    if (offset >= memfd_length(mfd))
+        return io_complete(completion, t, 0);
+    apply(mfd->f.fs_read, sg, irangel(offset, length),
+          contextual_closure(memfd_sg_read_complete, t, mfd, sg, is_file_offset, completion));
+    return bh ? SYSRETURN_CONTINUE_BLOCKING : thread_maybe_sleep_uninterruptible(t);
+}
+
+static void memfd_write_complete_internal(thread t, memfd mfd, u64 length, boolean is_file_offset,
+                                          io_completion completion, status s)
+{
+    sysreturn rv;
+    if (is_ok(s)) {
+        mfd->f.length = memfd_length(mfd);
+        if (is_file_offset)
+            mfd->f.offset += length;
+        rv = length;
+    } else {
+        timm_dealloc(s);
+        rv = -ENOMEM;
+    }
+    apply(completion, t, rv);
+}
+
+closure_function(6, 1, void, memfd_write_complete,
+                 thread, t, memfd, mfd, sg_list, sg, u64, length, boolean, is_file_offset, io_completion, completion,
+                 status, s)
+{
+    sg_list sg = bound(sg);
+    sg_list_release(sg);
+    deallocate_sg_list(sg);
+    memfd_write_complete_internal(bound(t), bound(mfd), bound(length), bound(is_file_offset),
+                                  bound(completion), s);
+    closure_finish();
+}
+
+closure_function(1, 6, sysreturn, memfd_write,
+                 memfd, mfd,
+                 void *, src, u64, length, u64, offset_arg, thread, t, boolean, bh, io_completion, completion)
+{
+    memfd mfd = bound(mfd);
+    boolean is_file_offset = offset_arg == infinity;
+    u64 offset = is_file_offset ? mfd->f.offset : offset_arg;
+    thread_log(t, "%s: mfd %p, src %p, offset %ld, length %ld", __func__, mfd, src, offset, length);
+    sysreturn rv = memfd_check_write(mfd, offset, length);
+    if (rv)
+        return io_complete(completion, t, rv);
+    sg_list sg = allocate_sg_list();
+    if (sg == INVALID_ADDRESS)
+        return io_complete(completion, t, -ENOMEM);
+    sg_buf sgb = sg_list_tail_add(sg, length);
+    if (sgb == INVALID_ADDRESS) {
+        deallocate_sg_list(sg);
+        return io_complete(completion, t, -ENOMEM);
+    }
+    sgb->buf = src;
+    sgb->size = length;
+    sgb->offset = 0;
+    sgb->refcount = 0;
+    apply(mfd->f.fs_write, sg, irangel(offset, length),
+          contextual_closure(memfd_write_complete, t, mfd, sg, length, is_file_offset,
+                             completion));
+    return bh ? SYSRETURN_CONTINUE_BLOCKING : thread_maybe_sleep_uninterruptible(t);
+}
+
+closure_function(5, 1, void, memfd_sg_write_complete,
+                 thread, t, memfd, mfd, u64, length, boolean, is_file_offset, io_completion, completion,
+                 status, s)
+{
+    memfd_write_complete_internal(bound(t), bound(mfd), bound(length), bound(is_file_offset),
+                                  bound(completion), s);
+    closure_finish();
+}
+
+closure_function(1, 6, sysreturn, memfd_sg_write,
+                 memfd, mfd,
+                 sg_list, sg, u64, length, u64, offset_arg, thread, t, boolean, bh, io_completion, completion)
+{
+    memfd mfd = bound(mfd);
+    boolean is_file_offset = offset_arg == infinity;
+    u64 offset = is_file_offset ? mfd->f.offset : offset_arg;
+    thread_log(t, "%s: mfd %p, sg %p, offset %ld, length %ld", __func__, mfd, sg, offset, length);
+    sysreturn rv = memfd_check_write(mfd, offset, length);
+    if (rv)
+        return io_complete(completion, t, rv);
+    apply(mfd->f.fs_write, sg, irangel(offset, length),
+          contextual_closure(memfd_sg_write_complete, t, mfd, length, is_file_offset,
+                             completion));
+    return bh ? SYSRETURN_CONTINUE_BLOCKING : thread_maybe_sleep_uninterruptible(t);
+}
+
+closure_function(1, 1, u32, memfd_events,
+                 memfd, mfd,
+                 thread, t /* ignore */)
+{
+    return EPOLLIN | EPOLLOUT;
+}
+
+closure_function(1, 2, sysreturn, memfd_close,
+                 memfd, mfd,
+                 thread, t, io_completion, completion)
+{
+    memfd mfd = bound(mfd);
+    memfd_debug("%s: mfd %p, length 0x%lx\n", __func__, mfd, memfd_length(mfd));
+
+    /* no mappings remain, as each vmap holds a reference to the descriptor */
+    pagecache_node_discard_pages(mfd->pn, 0);
+    pagecache_deallocate_node(mfd->pn);
+    deallocate_closure(mfd->f.f.read);
+    deallocate_closure(mfd->f.f.write);
+    deallocate_closure(mfd->f.f.sg_read);
+    deallocate_closure(mfd->f.f.sg_write);
+    deallocate_closure(mfd->f.f.events);
+    deallocate_closure(mfd->f.f.close);
+    release_fdesc(&mfd->f.f);
+    deallocate(mfd->h, mfd, sizeof(*mfd));
+    return io_complete(completion, t, 0);
+}
+
+pagecache_node memfd_get_cachenode(fdesc f)
+{
+    assert(f->type == FDESC_TYPE_MEMFD);
+    return ((memfd)f)->pn;
+}
+
+u32 memfd_get_seals(fdesc f)
+{
+    assert(f->type == FDESC_TYPE_MEMFD);
+    return ((memfd)f)->seals;
+}
+
+closure_function(2, 0, void, memfd_set_seals,
+                 memfd, mfd, u32, seals)
+{
+    bound(mfd)->seals |= bound(seals);
+}
+
+sysreturn memfd_add_seals(fdesc f, u32 seals)
+{
+    if (f->type != FDESC_TYPE_MEMFD)
+        return -EINVAL;
+    if (seals & ~(F_SEAL_SEAL | F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_FUTURE_WRITE))
+        return -EINVAL;
+    if (!fdesc_is_writable(f))
+        return -EPERM;
+    memfd mfd = (memfd)f;
+    if (mfd->seals & F_SEAL_SEAL)
+        return -EPERM;
+    thunk set = stack_closure(memfd_set_seals, mfd, seals);
+    if (!(seals & F_SEAL_WRITE)) {
+        apply(set);
+        return 0;
+    }
+
+    /* A write seal is refused while a shared mapping could still be used to modify contents. */
+    if (!vmap_node_apply_unless_writable(current->p, mfd->pn, set))
+        return -EBUSY;
+    return 0;
+}
+
+sysreturn memfd_truncate(fdesc f, long length)
+{
+    memfd mfd = (memfd)f;
+    if (length < 0)
+        return -EINVAL;
+    u64 cur = memfd_length(mfd);
+    thread_log(current, "%s: mfd %p, length 0x%lx -> 0x%lx", __func__, mfd, cur, length);
+    if (length == cur)
+        return 0;
+    if ((length < cur) ? (mfd->seals & F_SEAL_SHRINK) : (mfd->seals & F_SEAL_GROW))
+        return -EPERM;
+    if (length < cur) {
+        truncate_node_maps(current->p, mfd->pn, length);
+        pagecache_node_discard_pages(mfd->pn, length);
+    }
+    pagecache_set_node_length(mfd->pn, length);
+    mfd->f.length = length;
+    return 0;
+}
+
+sysreturn memfd_create(const char *name, unsigned int flags)
+{
+    thread_log(current, "%s: name %p, flags 0x%x", __func__, name, flags);
+    if (!fault_in_user_string(name))
+        return -EFAULT;
+    if (runtime_strlen(name) > MFD_NAME_MAX)
+        return -EINVAL;
+    if (flags & ~(MFD_CLOEXEC | MFD_ALLOW_SEALING))
+        return -EINVAL;
+
+    heap h = heap_locked(get_kernel_heaps());
+    memfd mfd = allocate(h, sizeof(*mfd));
+    if (mfd == INVALID_ADDRESS)
+        return -ENOMEM;
+    sysreturn rv = -ENOMEM;
+    sg_io fs_read = closure(h, memfd_fill_zero);
+    if (fs_read == INVALID_ADDRESS)
+        goto err_read;
+    mfd->pn = pagecache_allocate_node(memfd_pv, fs_read, 0, 0);
+    if (mfd->pn == INVALID_ADDRESS) {
+        deallocate_closure(fs_read);
+        goto err_read;
+    }
+    mfd->h = h;
+    mfd->seals = (flags & MFD_ALLOW_SEALING) ? 0 : F_SEAL_SEAL;
+
+    file f = &mfd->f;
+    zero(f, sizeof(*f));
+    init_fdesc(h, &f->f, FDESC_TYPE_MEMFD);
+    f->f.flags = O_RDWR | ((flags & MFD_CLOEXEC) ? O_CLOEXEC : 0);
+    f->fs_read = pagecache_node_get_reader(mfd->pn);
+    f->fs_write = pagecache_node_get_writer(mfd->pn);
+    f->f.read = closure(h, memfd_read, mfd);
+    f->f.write = closure(h, memfd_write, mfd);
+    f->f.sg_read = closure(h, memfd_sg_read, mfd);
+    f->f.sg_write = closure(h, memfd_sg_write, mfd);
+    f->f.events = closure(h, memfd_events, mfd);
+    f->f.close = closure(h, memfd_close, mfd);
+
+    int fd = allocate_fd(current->p, mfd);
+    if (fd == INVALID_PHYSICAL) {
+        apply(f->f.close, 0, io_completion_ignore);
+        return -EMFILE;
+    }
+    memfd_debug("%s: fd %d, mfd %p, node %p\n", __func__, fd, mfd, mfd->pn);
+    return fd;
+  err_read:
+    deallocate(h, mfd, sizeof(*mfd));
+    return rv;
+}
+
+boolean memfd_init(unix_heaps uh)
+{
+    memfd_pv = pagecache_allocate_volume(infinity, PAGELOG);
+    return (memfd_pv != INVALID_ADDRESS);
+}
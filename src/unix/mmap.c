@@ -49,8 +49,16 @@ static struct {
     closure_struct(pending_fault_print, pf_print);
 
     struct list pf_freelist;
+
+    /* pinned physical pages: page address -> (pin count << 1) | released */
+    struct spinlock pins_lock;
+    table pins;
+    u64 pinned_pages;
 } mmap_info;
 
+#define PIN_RELEASED    1
+#define PIN_COUNT_ONE   2
+
 define_closure_function(0, 2, int, pending_fault_compare,
                         rbnode, a, rbnode, b)
 {
@@ -72,6 +80,8 @@ define_closure_function(1, 1, void, pending_fault_complete,
 {
     pending_fault pf = bound(pf);
     pf_debug("%s: page 0x%lx, status %v\n", __func__, pf->addr, s);
+    tracepoint_end(TRACEPOINT_PAGE_FAULT, u64_from_pointer(pf),
+                   u64_from_pointer(is_ok(s) ? "ok" : "error"));
     if (!is_ok(s))
         rprintf("%s: page fill failed with %v\n", __func__, s);
     context ctx;
@@ -275,6 +285,7 @@ boolean do_demand_page(thread t, context ctx, u64 vaddr, vmap vm)
     } else {
         pf = new_pending_fault_locked(p, page_addr);
         spin_unlock_irq(&p->faulting_lock, flags);
+        tracepoint_begin(TRACEPOINT_PAGE_FAULT, u64_from_pointer(pf), t->tid, vaddr);
         pf_debug("   new pending_fault %p\n", pf);
         int mmap_type = vm->flags & VMAP_MMAP_TYPE_MASK;
         switch (mmap_type) {
@@ -959,17 +970,99 @@ closure_function(3, 1, boolean, vmap_remove_intersection,
     return true;
 }
 
-closure_function(1, 1, boolean, dealloc_phys_page,
-                 id_heap, physical,
-                 range, r)
+static boolean dealloc_phys_range(id_heap physical, range r)
 {
-    if (!id_heap_set_area(bound(physical), r.start, range_span(r), true, false)) {
+    if (!id_heap_set_area(physical, r.start, range_span(r), true, false)) {
         msg_err("some of physical range %R not allocated in heap\n", r);
         return false;
     }
     return true;
 }
 
+/* Pages that are pinned when unmapped are released on their last unpin. */
+closure_function(1, 1, boolean, dealloc_phys_page,
+                 id_heap, physical,
+                 range, r)
+{
+    /* order the unmapping before the check for pins; see pin_user_pages() */
+    memory_barrier();
+    if (!mmap_info.pinned_pages)
+        return dealloc_phys_range(bound(physical), r);
+    boolean success = true;
+    range f = irange(r.start, r.start);
+    u64 flags = spin_lock_irq(&mmap_info.pins_lock);
+    for (u64 a = r.start; a < r.end; a += PAGESIZE) {
+        u64 v = u64_from_pointer(table_find(mmap_info.pins, pointer_from_u64(a)));
+        if (!v) {
+            f.end = a + PAGESIZE;
+            continue;
+        }
+        table_set(mmap_info.pins, pointer_from_u64(a), pointer_from_u64(v | PIN_RELEASED));
+        if (range_span(f) && !dealloc_phys_range(bound(physical), f))
+            success = false;
+        f = irange(a + PAGESIZE, a + PAGESIZE);
+    }
+    spin_unlock_irq(&mmap_info.pins_lock, flags);
+    if (range_span(f) && !dealloc_phys_range(bound(physical), f))
+        success = false;
+    return success;
+}
+
+/* Pin the physical pages backing anonymous memory at vaddr, so that the
+   kernel can keep referencing them (through the linear mapping) after the
+   memory is unmapped. Returns the length of the physically contiguous run
+   pinned at vaddr, setting *phys to its physical address, or 0 if the
+   memory is not resident anonymous memory. */
+u64 pin_user_pages(process p, u64 vaddr, u64 len, u64 *phys)
+{
+    u64 n = 0;
+    vmap_lock(p);
+    /* anonymous pages are freed under the vmap lock, except on heap shrink,
+       which takes the range out of the heap vmap before unmapping it */
+    vmap vm = vmap_from_vaddr_locked(p, vaddr);
+    if (vm == INVALID_ADDRESS ||
+        ((vm->flags & VMAP_MMAP_TYPE_MASK) != VMAP_MMAP_TYPE_ANONYMOUS && vm != p->heap_map))
+        goto out;
+    len = MIN(len, vm->node.r.end - vaddr);
+    *phys = physical_from_virtual(pointer_from_u64(vaddr));
+    if (*phys == INVALID_PHYSICAL)
+        goto out;
+    n = MIN(len, PAGESIZE - (vaddr & PAGEMASK));
+    while (n < len && physical_from_virtual(pointer_from_u64(vaddr + n)) == *phys + n)
+        n += MIN(len - n, PAGESIZE);
+    u64 flags = spin_lock_irq(&mmap_info.pins_lock);
+    for (u64 a = *phys & ~PAGEMASK; a < *phys + n; a += PAGESIZE) {
+        u64 v = u64_from_pointer(table_find(mmap_info.pins, pointer_from_u64(a)));
+        if (!v)
+            mmap_info.pinned_pages++;
+        table_set(mmap_info.pins, pointer_from_u64(a), pointer_from_u64(v + PIN_COUNT_ONE));
+    }
+    spin_unlock_irq(&mmap_info.pins_lock, flags);
+    memory_barrier();
+  out:
+    vmap_unlock(p);
+    return n;
+}
+
+void unpin_user_pages(u64 phys, u64 len)
+{
+    u64 flags = spin_lock_irq(&mmap_info.pins_lock);
+    for (u64 a = phys & ~PAGEMASK; a < phys + len; a += PAGESIZE) {
+        u64 v = u64_from_pointer(table_find(mmap_info.pins, pointer_from_u64(a)));
+        assert(v >= PIN_COUNT_ONE);
+        v -= PIN_COUNT_ONE;
+        if (v >= PIN_COUNT_ONE) {
+            table_set(mmap_info.pins, pointer_from_u64(a), pointer_from_u64(v));
+            continue;
+        }
+        table_set(mmap_info.pins, pointer_from_u64(a), 0);
+        mmap_info.pinned_pages--;
+        if (v & PIN_RELEASED)
+            dealloc_phys_range(mmap_info.physical, irangel(a, PAGESIZE));
+    }
+    spin_unlock_irq(&mmap_info.pins_lock, flags);
+}
+
 static void vmap_unmap_page_range(process p, vmap k)
 {
     range r = k->node.r;
@@ -1010,11 +1103,10 @@ void unmap_and_free_phys(u64 virtual, u64 length)
 }
 
 /* don't truncate vmap; just unmap truncated pages */
-void truncate_file_maps(process p, fsfile f, u64 new_length)
+void truncate_node_maps(process p, pagecache_node pn, u64 new_length)
 {
     vmap_lock(p);
     u64 padlen = pad(new_length, PAGESIZE);
-    pagecache_node pn = fsfile_get_cachenode(f);
     rangemap_foreach(p->vmaps, n) {
         vmap vm = (vmap)n;
         /* an invalidate would be preferable to a sync... */
@@ -1034,6 +1126,24 @@ void truncate_file_maps(process p, fsfile f, u64 new_length)
     vmap_unlock(p);
 }
 
+/* Apply t only if no shared mapping of the node may be made writable; the check and t are
+   both done under the vmap lock, so a concurrent mmap() or mprotect() cannot interleave. */
+boolean vmap_node_apply_unless_writable(process p, pagecache_node pn, thunk t)
+{
+    vmap_lock(p);
+    rangemap_foreach(p->vmaps, n) {
+        vmap vm = (vmap)n;
+        if (vm->cache_node == pn && (vm->flags & VMAP_FLAG_SHARED) &&
+            (vm->allowed_flags & VMAP_FLAG_WRITABLE)) {
+            vmap_unlock(p);
+            return false;
+        }
+    }
+    apply(t);
+    vmap_unlock(p);
+    return true;
+}
+
 closure_function(0, 1, boolean, msync_vmap,
                  rmnode, n)
 {
@@ -1200,6 +1310,30 @@ static sysreturn mmap(void *addr, u64 length, int prot, int flags, int fd, u64 o
             node = fsfile_get_cachenode(fsf);
             thread_log(current, "   associated with cache node %p @ offset 0x%lx", node, offset);
             break;
+        case FDESC_TYPE_MEMFD:
+            thread_log(current, "   fd %d: file-backed (memfd)", fd);
+            vmap_mmap_type = VMAP_MMAP_TYPE_FILEBACKED;
+            allowed_flags = anon_perms(p);
+            if (vmflags & VMAP_FLAG_SHARED) {
+                u32 seals = memfd_get_seals(desc);
+                if (seals & (F_SEAL_WRITE | F_SEAL_FUTURE_WRITE)) {
+                    if (vmflags & VMAP_FLAG_WRITABLE) {
+                        thread_log(current, "   fail: writable shared mapping of sealed memfd");
+                        ret = -EPERM;
+                        goto out_unlock;
+                    }
+                    allowed_flags &= ~VMAP_FLAG_WRITABLE;
+                }
+            }
+            if (offset & PAGEMASK) {
+                thread_log(current, "   file-backed mapping must have aligned file offset (%ld)",
+                           offset);
+                ret = -EINVAL;
+                goto out_unlock;
+            }
+            node = memfd_get_cachenode(desc);
+            thread_log(current, "   associated with cache node %p @ offset 0x%lx", node, offset);
+            break;
         default:
             thread_log(current, "   fd %d: custom", fd);
             if (!desc->mmap) {
@@ -1388,7 +1522,7 @@ void mmap_process_init(process p, tuple root)
     mmap_info.h = h;
     mmap_info.physical = heap_physical(kh);
     mmap_info.linear_backed = reserve_heap_wrapper(h, (heap)heap_linear_backed(kh), USER_MEMORY_RESERVE);
-    spin_lock_init(&p->vmap_lock);
+    spin_lock_init_class(&p->vmap_lock, "vmap");
     u64 min_addr;
     if (get_u64(root, sym(mmap_min_addr), &min_addr))
         p->mmap_min_addr = min_addr;
@@ -1427,11 +1561,15 @@ void mmap_process_init(process p, tuple root)
                                      ivmap(VMAP_FLAG_EXEC, 0, 0, 0, 0)) != INVALID_ADDRESS);
 #endif
 
-    spin_lock_init(&p->faulting_lock);
+    spin_lock_init_class(&p->faulting_lock, "faulting");
     init_rbtree(&p->pending_faults,
                 init_closure(&mmap_info.pf_compare, pending_fault_compare),
                 init_closure(&mmap_info.pf_print, pending_fault_print));
     list_init(&mmap_info.pf_freelist);
+    spin_lock_init(&mmap_info.pins_lock);
+    mmap_info.pins = allocate_table(h, identity_key, pointer_equal);
+    assert(mmap_info.pins != INVALID_ADDRESS);
+    mmap_info.pinned_pages = 0;
 }
 
 void register_mmap_syscalls(struct syscall *map)
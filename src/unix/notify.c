@@ -18,7 +18,7 @@ notify_set allocate_notify_set(heap h)
     if (s == INVALID_ADDRESS)
         return s;
     s->h = h;
-    spin_lock_init(&s->lock);
+    spin_lock_init_class(&s->lock, "notify_set");
     list_init(&s->entries);
     return s;
 }
@@ -314,7 +314,7 @@ int do_pipe2(int fds[2], int flags)
         msg_err("failed to allocate pipe's data buffer\n");
         goto err;
     }
-    spin_lock_init(&pipe->lock);
+    spin_lock_init_class(&pipe->lock, "pipe");
 
     /* init reader */
     {
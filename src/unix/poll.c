@@ -150,7 +150,7 @@ static epollfd alloc_epollfd(epoll e, int fd, u32 eventmask, u64 data)
     efd->e = e;
     reset_epollfd(efd, eventmask, data);
     init_refcount(&efd->refcount, 1, init_closure(&efd->free, epollfd_free, efd));
-    spin_lock_init(&efd->lock);
+    spin_lock_init_class(&efd->lock, "epollfd");
     efd->registered = false;
     assert(vector_set(e->events, fd, efd));
     bitmap_set(e->fds, fd, 1);
@@ -457,6 +457,32 @@ static void check_fdesc(epollfd efd, epoll_blocked w)
     }
 }
 
+#ifdef NET
+closure_function(1, 0, boolean, epoll_blocked_ready,
+                 epoll_blocked, w)
+{
+    epoll_blocked w = bound(w);
+    switch (w->e->epoll_type) {
+    case EPOLL_TYPE_POLL:
+        return w->poll_retcount != 0;
+    case EPOLL_TYPE_EPOLL:
+        return user_event_count(w) != 0;
+    default:
+        return w->retcount != 0;
+    }
+}
+
+/* With no events ready, busy-poll the network interfaces for up to the
+   configured time before blocking. */
+static void epoll_busy_poll(epoll_blocked w, timestamp timeout)
+{
+    if (!busy_poll_usecs || !timeout || apply(stack_closure(epoll_blocked_ready, w)))
+        return;
+    net_busy_poll(0 /* any interface */, MIN(microseconds(busy_poll_usecs), timeout),
+                  stack_closure(epoll_blocked_ready, w));
+}
+#endif
+
 /* It would be nice to devise a way to allow a poll waiter to continue
    to collect events between wakeup (first event) and running. */
 
@@ -546,6 +572,9 @@ sysreturn epoll_wait(int epfd,
     spin_runlock(&e->fds_lock);
 
     timestamp ts = (timeout > 0) ? milliseconds(timeout) : 0;
+#ifdef NET
+    epoll_busy_poll(w, (timeout < 0) ? infinity : ts);
+#endif
     return blockq_check_timeout(w->t->thread_bq, current,
                                 contextual_closure(epoll_wait_bh, w, current,
                                 (timeout < 0) ? infinity : ts), false,
@@ -875,6 +904,9 @@ static sysreturn select_internal(int nfds,
             ep++;
     }
     spin_wunlock(&e->fds_lock);
+#ifdef NET
+    epoll_busy_poll(wt, timeout);
+#endif
   check_timeout:
     return blockq_check_timeout(wt->t->thread_bq, current,
                                 contextual_closure(select_bh, wt, current, timeout), false,
@@ -1034,6 +1066,9 @@ static sysreturn poll_internal(struct pollfd *fds, nfds_t nfds,
     }
     spin_wunlock(&e->fds_lock);
     deallocate_bitmap(remove_efds);
+#ifdef NET
+    epoll_busy_poll(w, timeout);
+#endif
 
     return blockq_check_timeout(w->t->thread_bq, current,
                                 contextual_closure(poll_bh, w, current, timeout), false,
@@ -17,19 +17,45 @@ struct sockaddr_un {
     char sun_path[108];
 };
 
+/* Ancillary data sent along with a message. In stream sockets, the data is attached to len bytes
+ * starting at stream offset pos. */
+typedef struct unixsock_anc {
+    u64 pos;
+    u64 len;
+    boolean has_cred;
+    struct ucred cred;
+    int nfds;
+    fdesc fds[0];
+} *unixsock_anc;
+
+#define unixsock_anc_size(nfds) (sizeof(struct unixsock_anc) + (nfds) * sizeof(fdesc))
+
 typedef struct sharedbuf {
     buffer b;
     struct refcount refcount;
     closure_struct(sharedbuf_free, free);
     struct sockaddr_un from_addr;
+    unixsock_anc anc;
 } *sharedbuf;
 
-#define UNIXSOCK_BUF_MAX_SIZE   PAGESIZE
 #define UNIXSOCK_QUEUE_MAX_LEN  64
 
+/* Stream data is received in a ring buffer that is grown on demand, up to the larger of the
+ * receiver's SO_RCVBUF and the sender's SO_SNDBUF. */
+#define UNIXSOCK_RING_MIN_SIZE  (4 * PAGESIZE)
+#define UNIXSOCK_RING_MAX_SIZE  (4 * MB)
+#define UNIXSOCK_SOCKBUF_MIN    (2 * PAGESIZE)
+
 typedef struct unixsock {
     struct sock sock; /* must be first */
-    queue data;
+    queue data;         /* datagrams, or ancillary data in stream sockets */
+    ringbuf ring;       /* stream data */
+    u64 rx_seq;         /* stream offset of the first byte in the ring */
+    u64 ring_limit;
+    int rcvbuf;
+    int sndbuf;
+    boolean passcred;
+    struct ucred cred;
     filesystem fs;
     inode fs_entry;
     struct sockaddr_un local_addr;
@@ -44,9 +70,21 @@ typedef struct unixsock {
 #define unixsock_lock(s)    spin_lock(&(s)->sock.f.lock)
 #define unixsock_unlock(s)  spin_unlock(&(s)->sock.f.lock)
 
+/* Releases any file descriptors that have not been delivered to a receiver. In-flight sockets
+ * that reference each other are not garbage-collected. */
+static void unixsock_anc_release(heap h, unixsock_anc anc)
+{
+    for (int i = 0; i < anc->nfds; i++)
+        if (anc->fds[i])
+            fdesc_put(anc->fds[i]);
+    deallocate(h, anc, unixsock_anc_size(anc->nfds));
+}
+
 static inline void sharedbuf_deallocate(sharedbuf shb)
 {
     heap h = shb->b->h;
+    if (shb->anc)
+        unixsock_anc_release(h, shb->anc);
     deallocate_buffer(shb->b);
     deallocate(h, shb, sizeof(*shb));
 }
@@ -104,6 +142,7 @@ static inline sharedbuf sharedbuf_allocate(heap h, u64 len)
     }
     init_closure(&shb->free, sharedbuf_free, shb);
     init_refcount(&shb->refcount, 1, (thunk)&shb->free);
+    shb->anc = 0;
     return shb;
 }
 
@@ -141,9 +180,21 @@ static unixsock unixsock_alloc(heap h, int type, u32 flags, boolean alloc_fd);
 /* Called with lock acquired, returns with lock released. */
 static void unixsock_dealloc(unixsock s)
 {
-    deallocate_queue(s->data);
+    queue data = s->data;
     s->data = 0;
     unixsock_unlock(s);
+    void *p;
+    while ((p = dequeue(data)) != INVALID_ADDRESS) {
+        if (s->sock.type == SOCK_STREAM)
+            unixsock_anc_release(s->sock.h, p);
+        else
+            sharedbuf_release(p);
+    }
+    deallocate_queue(data);
+    if (s->ring) {
+        deallocate_ringbuf(s->ring);
+        s->ring = 0;
+    }
     unixsock peer = unixsock_is_conn_oriented(s) ? s->peer : 0;
     if (peer) {
         unixsock_lock(peer);
@@ -181,26 +232,109 @@ static inline void unixsock_notify_writer(unixsock s)
     fdesc_notify_events(&s->sock.f);
 }
 
-closure_function(8, 1, sysreturn, unixsock_read_bh,
-                 unixsock, s, thread, t, void *, dest, sg_list, sg, u64, length, io_completion, completion, struct sockaddr_un *, from_addr, socklen_t *, from_length,
+/* The argument refers to the destination socket. Writers to a stream socket are reported as
+ * writable (and woken up) only when at least half of the ring limit is free, so that a reader
+ * draining the ring does not trigger a writer wakeup for each read. */
+static boolean unixsock_is_writable(unixsock s)
+{
+    if (s->sock.type == SOCK_STREAM)
+        return (s->sock.rx_len <= s->ring_limit / 2);
+    return (s->sock.rx_len < s->rcvbuf) && !queue_full(s->data);
+}
+
+/* Ensures there is space in the ring for up to len bytes; returns the available space. */
+static u64 unixsock_ring_reserve(unixsock s, u64 len)
+{
+    ringbuf r = s->ring;
+    if (!r) {
+        r = allocate_ringbuf(s->sock.h, MAX(len, UNIXSOCK_RING_MIN_SIZE));
+        if (r == INVALID_ADDRESS)
+            return 0;
+        s->ring = r;
+    } else if (ringbuf_space(r) < len) {
+        ringbuf_set_capacity(r, ringbuf_length(r) + len);
+    }
+    return MIN(len, ringbuf_space(r));
+}
+
+static void unixsock_ring_write_sg(ringbuf r, sg_list sg, u64 len)
+{
+    void *end = r->contents + (r->end & (r->length - 1));
+    u64 avail = MIN(len, r->contents + r->length - end);
+    u64 xfer = sg_copy_to_buf(end, sg, avail);
+    if (avail < len)
+        xfer += sg_copy_to_buf(r->contents, sg, len - avail);
+    assert(xfer == len);
+    ringbuf_produce(r, len);
+}
+
+/* Copies received ancillary data to the control buffer of a message; passed file descriptors
+ * are installed in the receiving process, and any that do not fit are left to be released. */
+static void unixsock_recv_control(process p, struct msghdr *msg, unixsock_anc anc,
+                                  struct ucred *cred)
+{
+    u8 *control = msg->msg_control;
+    u64 space = control ? msg->msg_controllen : 0;
+    u64 len = 0;
+    struct cmsghdr *cmsg;
+    if (cred) {
+        if (space >= CMSG_LEN(sizeof(*cred))) {
+            cmsg = (struct cmsghdr *)control;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(*cred));
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_CREDENTIALS;
+            runtime_memcpy(CMSG_DATA(cmsg), cred, sizeof(*cred));
+            len = MIN(CMSG_SPACE(sizeof(*cred)), space);
+        } else {
+            msg->msg_flags |= MSG_CTRUNC;
+        }
+    }
+    if (anc && anc->nfds) {
+        int max_fds = (space - len >= CMSG_LEN(sizeof(int))) ?
+                      (space - len - CMSG_LEN(0)) / sizeof(int) : 0;
+        cmsg = (struct cmsghdr *)(control + len);
+        int *fds = (int *)CMSG_DATA(cmsg);
+        int i;
+        for (i = 0; i < MIN(anc->nfds, max_fds); i++) {
+            u64 fd = allocate_fd(p, anc->fds[i]);
+            if (fd == INVALID_PHYSICAL)
+                break;
+            fds[i] = fd;
+            anc->fds[i] = 0;
+        }
+        if (i > 0) {
+            cmsg->cmsg_len = CMSG_LEN(i * sizeof(int));
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            len = MIN(len + CMSG_SPACE(i * sizeof(int)), space);
+        }
+        if (i < anc->nfds)
+            msg->msg_flags |= MSG_CTRUNC;
+    }
+    msg->msg_controllen = len;
+}
+
+closure_function(9, 1, sysreturn, unixsock_read_bh,
+                 unixsock, s, thread, t, void *, dest, sg_list, sg, u64, length, io_completion, completion, struct sockaddr_un *, from_addr, socklen_t *, from_length, struct msghdr *, msg,
                  u64, flags)
 {
     unixsock s = bound(s);
     void *dest = bound(dest);
     u64 length = bound(length);
-
-    sharedbuf shb;
+    struct msghdr *msg = bound(msg);
+    unixsock_anc anc = 0;
+    struct ucred cred, *credp = 0;
+    boolean wake_writer = false;
     sysreturn rv;
 
     unixsock_lock(s);
     boolean disconnected = unixsock_is_conn_oriented(s) && !(s->peer && s->peer->data);
-    boolean read_done = false;
     if ((flags & BLOCKQ_ACTION_NULLIFY) && !disconnected) {
         rv = -ERESTARTSYS;
         goto out;
     }
-    shb = queue_peek(s->data);
-    if (shb == INVALID_ADDRESS) {
+    boolean empty = (s->sock.type == SOCK_STREAM) ? (s->sock.rx_len == 0) : queue_empty(s->data);
+    if (empty) {
         if (disconnected) {
             rv = 0;
             goto out;
@@ -211,49 +345,101 @@ closure_function(8, 1, sysreturn, unixsock_read_bh,
         unixsock_unlock(s);
         return blockq_block_required(bound(t), flags);
     }
-    rv = 0;
-    do {
+    if (msg)
+        msg->msg_flags = 0;
+    if (s->sock.type == SOCK_STREAM) {
+        u64 xfer = MIN(s->sock.rx_len, length);
+        boolean has_anc = false;
+        unixsock_anc a = queue_peek(s->data);
+
+        /* do not merge data carrying ancillary data with other data in a single read */
+        if (a != INVALID_ADDRESS) {
+            if (a->pos == s->rx_seq) {
+                xfer = MIN(xfer, a->len);
+                has_anc = true;
+            } else {
+                xfer = MIN(xfer, a->pos - s->rx_seq);
+            }
+        }
+        if (dest) {
+            ringbuf_read(s->ring, dest, xfer);
+        } else {
+            sharedbuf shb = sharedbuf_allocate(s->sock.h, xfer);
+            if (shb == INVALID_ADDRESS) {
+                rv = -ENOMEM;
+                goto out;
+            }
+            sg_buf sgb = sg_list_tail_add(bound(sg), xfer);
+            if (sgb == INVALID_ADDRESS) {
+                sharedbuf_release(shb);
+                rv = -ENOMEM;
+                goto out;
+            }
+            ringbuf_read(s->ring, buffer_ref(shb->b, 0), xfer);
+            buffer_produce(shb->b, xfer);
+            sgb->buf = buffer_ref(shb->b, 0);
+            sgb->size = xfer;
+            sgb->offset = 0;
+            sgb->refcount = &shb->refcount;
+        }
+        if (has_anc)
+            anc = dequeue(s->data);
+        wake_writer = !unixsock_is_writable(s);
+        s->rx_seq += xfer;
+        s->sock.rx_len -= xfer;
+        wake_writer = wake_writer && unixsock_is_writable(s);
+        rv = xfer;
+    } else {
+        sharedbuf shb = queue_peek(s->data);
         buffer b = shb->b;
-        u64 xfer = MIN(buffer_length(b), length);
+        u64 len = buffer_length(b);
+        u64 xfer = MIN(len, length);
         if (dest) {
             buffer_read(b, dest, xfer);
-            dest = (u8 *)dest + xfer;
         } else if (xfer > 0) {
             sg_buf sgb = sg_list_tail_add(bound(sg), xfer);
-            if (sgb == INVALID_ADDRESS)
-                break;
+            if (sgb == INVALID_ADDRESS) {
+                rv = -ENOMEM;
+                goto out;
+            }
             sharedbuf_reserve(shb);
             sgb->buf = buffer_ref(b, 0);
             sgb->size = xfer;
             sgb->offset = 0;
             sgb->refcount = &shb->refcount;
-            buffer_consume(b, xfer);
         }
-        rv += xfer;
-        length -= xfer;
-        s->sock.rx_len -= xfer;
-        if (!buffer_length(b) || (s->sock.type != SOCK_STREAM)) {
-            assert(dequeue(s->data) == shb);
-            s->sock.rx_len -= buffer_length(b);
-            if (s->sock.type == SOCK_DGRAM) {
-                struct sockaddr_un *from_addr = bound(from_addr);
-                socklen_t *from_length = bound(from_length);
-                if (from_addr && from_length) {
-                    runtime_memcpy(from_addr, &shb->from_addr, MIN(*from_length, sizeof(shb->from_addr)));
-                    *from_length = __builtin_offsetof(struct sockaddr_un, sun_path) + runtime_strlen(from_addr->sun_path) + 1;
-                }
-            }
-            sharedbuf_release(shb);
-            shb = queue_peek(s->data);
-            if (shb == INVALID_ADDRESS) { /* no more data available to read */
-                break;
+        assert(dequeue(s->data) == shb);
+        s->sock.rx_len -= len;
+        if ((xfer < len) && msg)
+            msg->msg_flags |= MSG_TRUNC;
+        if (s->sock.type == SOCK_DGRAM) {
+            struct sockaddr_un *from_addr = bound(from_addr);
+            socklen_t *from_length = bound(from_length);
+            if (from_addr && from_length) {
+                runtime_memcpy(from_addr, &shb->from_addr, MIN(*from_length, sizeof(shb->from_addr)));
+                *from_length = __builtin_offsetof(struct sockaddr_un, sun_path) + runtime_strlen(from_addr->sun_path) + 1;
             }
         }
-    } while ((s->sock.type == SOCK_STREAM) && (length > 0));
-    read_done = true;
+        anc = shb->anc;
+        shb->anc = 0;
+        sharedbuf_release(shb);
+        wake_writer = true;
+        rv = xfer;
+    }
+    if (s->passcred) {
+        if (anc && anc->has_cred)
+            cred = anc->cred;
+        else
+            cred = s->peer ? s->peer->cred : s->cred;
+        credp = &cred;
+    }
 out:
     unixsock_unlock(s);
-    if (read_done)
+    if (msg && (rv >= 0))
+        unixsock_recv_control(bound(t)->p, msg, anc, credp);
+    if (anc)
+        unixsock_anc_release(s->sock.h, anc);
+    if (wake_writer)
         unixsock_notify_writer(s);
     apply(bound(completion), bound(t), rv);
     closure_finish();
@@ -266,7 +452,7 @@ static sysreturn unixsock_read_with_addr(unixsock s, void *dest, u64 length, u64
         return io_complete(completion, t, 0);
 
     blockq_action ba = contextual_closure(unixsock_read_bh, s, t, dest, 0, length,
-                                          completion, addr, addrlen);
+                                          completion, addr, addrlen, 0);
     return blockq_check(s->sock.rxbq, t, ba, bh);
 }
 
@@ -281,46 +467,55 @@ static sysreturn unixsock_write_check(unixsock s, u64 len)
 {
     if ((s->sock.type == SOCK_STREAM) && (len == 0))
         return 0;
-    if ((s->sock.type != SOCK_STREAM) && (len > UNIXSOCK_BUF_MAX_SIZE))
+    if ((s->sock.type != SOCK_STREAM) && (len > s->sndbuf))
         return -EMSGSIZE;
     return 1;   /* any value > 0 will do */
 }
 
+/* On success, any ancillary data is attached to the written data. */
 static sysreturn unixsock_write_to(void *src, sg_list sg, u64 length,
-                                   unixsock dest, unixsock from)
+                                   unixsock dest, unixsock from, unixsock_anc anc)
 {
-    if ((dest->sock.rx_len >= so_rcvbuf) || queue_full(dest->data)) {
+    if (anc && queue_full(dest->data))
         return -EAGAIN;
-    }
-
-    sysreturn rv = 0;
-    do {
-        u64 xfer = MIN(UNIXSOCK_BUF_MAX_SIZE, length);
-        if (from->sock.type == SOCK_STREAM)
-            xfer = MIN(xfer, so_rcvbuf - dest->sock.rx_len);
-        sharedbuf shb = sharedbuf_allocate(dest->sock.h, xfer);
-        if (shb == INVALID_ADDRESS) {
-            if (rv == 0) {
-                rv = -ENOMEM;
-            }
-            break;
-        }
-        if (from && from->sock.type == SOCK_DGRAM)
-            runtime_memcpy(&shb->from_addr, &from->local_addr, sizeof(struct sockaddr_un));
-        if (src) {
-            assert(buffer_write(shb->b, src, xfer));
-            src = (u8 *) src + xfer;
-        } else {
-            u64 len = sg_copy_to_buf(buffer_ref(shb->b, 0), sg, xfer);
-            assert(len == xfer);
-            buffer_produce(shb->b, xfer);
+    if (from->sock.type == SOCK_STREAM) {
+        dest->ring_limit = MIN(MAX(dest->rcvbuf, from->sndbuf), UNIXSOCK_RING_MAX_SIZE);
+        if (dest->sock.rx_len >= dest->ring_limit)
+            return -EAGAIN;
+        u64 xfer = unixsock_ring_reserve(dest, MIN(length, dest->ring_limit - dest->sock.rx_len));
+        if (xfer == 0)
+            return -ENOMEM;
+        if (anc) {
+            anc->pos = dest->rx_seq + dest->sock.rx_len;
+            anc->len = xfer;
+            assert(enqueue(dest->data, anc));
         }
-        assert(enqueue(dest->data, shb));
+        if (src)
+            assert(ringbuf_write(dest->ring, src, xfer));
+        else
+            unixsock_ring_write_sg(dest->ring, sg, xfer);
         dest->sock.rx_len += xfer;
-        rv += xfer;
-        length -= xfer;
-    } while ((length > 0) && (dest->sock.rx_len < so_rcvbuf) && !queue_full(dest->data));
-    return rv;
+        return xfer;
+    }
+
+    if ((dest->sock.rx_len >= dest->rcvbuf) || queue_full(dest->data))
+        return -EAGAIN;
+    sharedbuf shb = sharedbuf_allocate(dest->sock.h, length);
+    if (shb == INVALID_ADDRESS)
+        return -ENOMEM;
+    if (from->sock.type == SOCK_DGRAM)
+        runtime_memcpy(&shb->from_addr, &from->local_addr, sizeof(struct sockaddr_un));
+    if (src) {
+        assert(buffer_write(shb->b, src, length));
+    } else {
+        u64 len = sg_copy_to_buf(buffer_ref(shb->b, 0), sg, length);
+        assert(len == length);
+        buffer_produce(shb->b, length);
+    }
+    shb->anc = anc;
+    assert(enqueue(dest->data, shb));
+    dest->sock.rx_len += length;
+    return length;
 }
 
 static int lookup_socket(unixsock *s, char *path)
@@ -338,13 +533,14 @@ static int lookup_socket(unixsock *s, char *path)
     return sysreturn_from_fs_status(fss);
 }
 
-closure_function(7, 1, sysreturn, unixsock_write_bh,
-                 unixsock, s, thread, t, void *, src, sg_list, sg, u64, length, io_completion, completion, unixsock, dest,
+closure_function(8, 1, sysreturn, unixsock_write_bh,
+                 unixsock, s, thread, t, void *, src, sg_list, sg, u64, length, io_completion, completion, unixsock, dest, unixsock_anc, anc,
                  u64, flags)
 {
     unixsock s = bound(s);
     void *src = bound(src);
     u64 length = bound(length);
+    unixsock_anc anc = bound(anc);
     unixsock dest;
     boolean full = false;
 
@@ -361,14 +557,18 @@ closure_function(7, 1, sysreturn, unixsock_write_bh,
         goto out;
     }
 
-    rv = unixsock_write_to(src, bound(sg), length, dest, s);
+    rv = unixsock_write_to(src, bound(sg), length, dest, s, anc);
     if ((rv == -EAGAIN) && !(s->sock.f.flags & SOCK_NONBLOCK)) {
         unixsock_unlock(dest);
         return blockq_block_required(bound(t), flags);
     }
-    full = (dest->sock.rx_len >= so_rcvbuf) || queue_full(dest->data);
+    if (rv > 0)
+        anc = 0;
+    full = !unixsock_is_writable(dest);
 out:
     unixsock_unlock(dest);
+    if (anc)
+        unixsock_anc_release(s->sock.h, anc);
     if ((rv > 0) || ((rv == 0) && (dest->sock.type != SOCK_STREAM)))
         unixsock_notify_reader(dest);
     if (full)   /* no more space available to write */
@@ -389,7 +589,7 @@ static sysreturn unixsock_write_with_addr(unixsock s, void *src, u64 length, u64
     }
 
     blockq_action ba = contextual_closure(unixsock_write_bh, s, t, src, 0, length,
-                                          completion, addr);
+                                          completion, addr, 0);
     return blockq_check(addr->sock.txbq, t, ba, bh);
 }
 
@@ -413,34 +613,47 @@ closure_function(1, 6, sysreturn, unixsock_sg_read,
 {
     unixsock s = bound(s);
     blockq_action ba = contextual_closure(unixsock_read_bh, s, t, 0, sg, length,
-                                          completion, 0, 0);
+                                          completion, 0, 0, 0);
     if (ba == INVALID_ADDRESS)
         return io_complete(completion, t, -ENOMEM);
     return blockq_check(s->sock.rxbq, t, ba, bh);
 }
 
-closure_function(1, 6, sysreturn, unixsock_sg_write,
-                 unixsock, s,
-                 sg_list, sg, u64, length, u64, offset, thread, t, boolean, bh, io_completion, completion)
+/* Takes ownership of the ancillary data (if any). */
+static sysreturn unixsock_sg_write_anc(unixsock s, sg_list sg, u64 length, thread t, boolean bh,
+                                       io_completion completion, unixsock_anc anc)
 {
-    unixsock s = bound(s);
     sysreturn rv = unixsock_write_check(s, length);
     if (rv <= 0)
-        return io_complete(completion, t, rv);
-    unixsock_lock(bound(s));
-    unixsock dest = bound(s)->peer;
+        goto out;
+    unixsock_lock(s);
+    unixsock dest = s->peer;
     if (dest)
         refcount_reserve(&dest->refcount);
-    unixsock_unlock(bound(s));
-    if (!dest)
-        return io_complete(completion, t, -ENOTCONN);
+    unixsock_unlock(s);
+    if (!dest) {
+        rv = -ENOTCONN;
+        goto out;
+    }
     blockq_action ba = contextual_closure(unixsock_write_bh, s, t, 0, sg, length,
-                                          completion, dest);
+                                          completion, dest, anc);
     if (ba == INVALID_ADDRESS) {
         refcount_release(&dest->refcount);
-        return io_complete(completion, t, -ENOMEM);
+        rv = -ENOMEM;
+        goto out;
     }
     return blockq_check(dest->sock.txbq, t, ba, bh);
+  out:
+    if (anc)
+        unixsock_anc_release(s->sock.h, anc);
+    return io_complete(completion, t, rv);
+}
+
+closure_function(1, 6, sysreturn, unixsock_sg_write,
+                 unixsock, s,
+                 sg_list, sg, u64, length, u64, offset, thread, t, boolean, bh, io_completion, completion)
+{
+    return unixsock_sg_write_anc(bound(s), sg, length, t, bh, completion, 0);
 }
 
 closure_function(1, 1, u32, unixsock_events,
@@ -455,7 +668,7 @@ closure_function(1, 1, u32, unixsock_events,
             events |= EPOLLIN;
         }
     } else {
-        if (!queue_empty(s->data)) {
+        if ((s->sock.type == SOCK_STREAM) ? (s->sock.rx_len > 0) : !queue_empty(s->data)) {
             events |= EPOLLIN;
         }
         unixsock peer = s->peer;
@@ -466,7 +679,7 @@ closure_function(1, 1, u32, unixsock_events,
             if (!peer->data)
                 events |= unixsock_is_conn_oriented(s) ?
                           (EPOLLIN | EPOLLOUT | EPOLLHUP) : EPOLLOUT;
-            else if ((peer->sock.rx_len < so_rcvbuf) && !queue_full(peer->data))
+            else if (unixsock_is_writable(peer))
                 events |= EPOLLOUT;
             unixsock_unlock(peer);
             refcount_release(&peer->refcount);
@@ -771,13 +984,40 @@ static sysreturn unixsock_getsockname(struct sock *sock, struct sockaddr *addr,
 static sysreturn unixsock_setsockopt(struct sock *sock, int level,
                                      int optname, void *optval, socklen_t optlen)
 {
+    unixsock s = (unixsock)sock;
     sysreturn rv;
+    int val;
     switch (level) {
     case SOL_SOCKET:
         switch (optname) {
         case SO_REUSEADDR:
             rv = 0; /* to mimic Linux behavior, return 0 even if not actually implemented */
             break;
+        case SO_SNDBUF:
+        case SO_RCVBUF:
+        case SO_PASSCRED:
+            if (optlen < sizeof(int)) {
+                rv = -EINVAL;
+                break;
+            }
+            val = *(int *)optval;
+            unixsock_lock(s);
+            if (optname == SO_PASSCRED) {
+                s->passcred = (val != 0);
+            } else {
+                /* as in Linux, the value is doubled to allow for bookkeeping overhead */
+                val = MAX(MIN((u32)val, UNIXSOCK_RING_MAX_SIZE / 2) * 2, UNIXSOCK_SOCKBUF_MIN);
+                if (optname == SO_SNDBUF) {
+                    s->sndbuf = val;
+                } else {
+                    s->rcvbuf = val;
+                    if (sock->type == SOCK_STREAM)
+                        s->ring_limit = MAX(s->ring_limit, val);
+                }
+            }
+            unixsock_unlock(s);
+            rv = 0;
+            break;
         default:
             rv = -EOPNOTSUPP;
         }
@@ -792,6 +1032,7 @@ static sysreturn unixsock_setsockopt(struct sock *sock, int level,
 static sysreturn unixsock_getsockopt(struct sock *sock, int level,
                                      int optname, void *optval, socklen_t *optlen)
 {
+    unixsock s = (unixsock)sock;
     sysreturn rv;
     union {
         int val;
@@ -799,6 +1040,7 @@ static sysreturn unixsock_getsockopt(struct sock *sock, int level,
             int l_onoff;
             int l_linger;
         } linger;
+        struct ucred cred;
     } ret_optval;
     int ret_optlen;
 
@@ -809,6 +1051,29 @@ static sysreturn unixsock_getsockopt(struct sock *sock, int level,
             ret_optval.val = sock->type;
             ret_optlen = sizeof(ret_optval.val);
             break;
+        case SO_SNDBUF:
+            ret_optval.val = s->sndbuf;
+            ret_optlen = sizeof(ret_optval.val);
+            break;
+        case SO_RCVBUF:
+            ret_optval.val = s->rcvbuf;
+            ret_optlen = sizeof(ret_optval.val);
+            break;
+        case SO_PASSCRED:
+            ret_optval.val = s->passcred;
+            ret_optlen = sizeof(ret_optval.val);
+            break;
+        case SO_PEERCRED:
+            unixsock_lock(s);
+            if (s->peer) {
+                ret_optval.cred = s->peer->cred;
+            } else {
+                ret_optval.cred.pid = 0;
+                ret_optval.cred.uid = ret_optval.cred.gid = -1;
+            }
+            unixsock_unlock(s);
+            ret_optlen = sizeof(ret_optval.cred);
+            break;
         default:
             goto unimplemented;
         }
@@ -907,25 +1172,89 @@ closure_function(2, 2, void, sendmsg_complete,
     closure_finish();
 }
 
+/* Retrieves the ancillary data (if any) to be sent with a message, taking a reference to each
+ * passed file descriptor. */
+static sysreturn unixsock_send_control(unixsock s, const struct msghdr *msg, unixsock_anc *anc)
+{
+    u8 *control = msg->msg_control;
+    u64 controllen = control ? msg->msg_controllen : 0;
+    struct ucred *cred = 0;
+    int *fds = 0;
+    int nfds = 0;
+    *anc = 0;
+    for (u64 offset = 0; offset + sizeof(struct cmsghdr) <= controllen; ) {
+        struct cmsghdr *cmsg = (struct cmsghdr *)(control + offset);
+        if ((cmsg->cmsg_len < sizeof(struct cmsghdr)) || (cmsg->cmsg_len > controllen - offset))
+            return -EINVAL;
+        u64 len = cmsg->cmsg_len - CMSG_LEN(0);
+        if (cmsg->cmsg_level == SOL_SOCKET) {
+            switch (cmsg->cmsg_type) {
+            case SCM_RIGHTS:
+                if (fds || (len % sizeof(int)) || (len / sizeof(int) > SCM_MAX_FD))
+                    return -EINVAL;
+                fds = (int *)CMSG_DATA(cmsg);
+                nfds = len / sizeof(int);
+                break;
+            case SCM_CREDENTIALS:
+                if (len != sizeof(*cred))
+                    return -EINVAL;
+                cred = (struct ucred *)CMSG_DATA(cmsg);
+                if ((cred->pid != current->p->pid) || cred->uid || cred->gid)
+                    return -EPERM;
+                break;
+            default:
+                return -EINVAL;
+            }
+        }
+        offset += CMSG_ALIGN(cmsg->cmsg_len);
+    }
+    if (!cred && !nfds)
+        return 0;
+    unixsock_anc a = allocate(s->sock.h, unixsock_anc_size(nfds));
+    if (a == INVALID_ADDRESS)
+        return -ENOMEM;
+    a->has_cred = (cred != 0);
+    if (cred)
+        a->cred = *cred;
+    for (a->nfds = 0; a->nfds < nfds; a->nfds++) {
+        fdesc f = fdesc_get(current->p, fds[a->nfds]);
+        if (!f) {
+            while (a->nfds > 0)
+                fdesc_put(a->fds[--a->nfds]);
+            deallocate(s->sock.h, a, unixsock_anc_size(nfds));
+            return -EBADF;
+        }
+        a->fds[a->nfds] = f;
+    }
+    *anc = a;
+    return 0;
+}
+
 sysreturn unixsock_sendmsg(struct sock *sock, const struct msghdr *msg,
                            int flags, boolean in_bh, io_completion completion)
 {
     thread t = current;
+    unixsock_anc anc;
+    sysreturn rv = unixsock_send_control((unixsock)sock, msg, &anc);
+    if (rv)
+        goto out;
     sg_list sg = allocate_sg_list();
-    sysreturn rv;
     if (sg == INVALID_ADDRESS) {
         rv = -ENOMEM;
-        goto out;
+        goto err_release_anc;
     }
     if (!iov_to_sg(sg, msg->msg_iov, msg->msg_iovlen))
         goto err_dealloc_sg;
     io_completion complete = closure(sock->h, sendmsg_complete, sg, completion);
     if (complete == INVALID_ADDRESS)
         goto err_dealloc_sg;
-    return apply(sock->f.sg_write, sg, sg->count, 0, t, in_bh, complete);
+    return unixsock_sg_write_anc((unixsock)sock, sg, sg->count, t, in_bh, complete, anc);
   err_dealloc_sg:
     deallocate_sg_list(sg);
     rv = -ENOMEM;
+  err_release_anc:
+    if (anc)
+        unixsock_anc_release(sock->h, anc);
   out:
     return io_complete(completion, t, rv);
 }
@@ -958,9 +1287,16 @@ sysreturn unixsock_recvmsg(struct sock *sock, struct msghdr *msg, int flags, boo
     /* Non-connected sockets are not supported, so source address is not set. */
     msg->msg_namelen = 0;
 
-    return apply(sock->f.sg_read, sg,
-        iov_total_len(msg->msg_iov, msg->msg_iovlen), 0, current, false,
-        complete);
+    u64 length = iov_total_len(msg->msg_iov, msg->msg_iovlen);
+    if ((sock->type == SOCK_STREAM) && (length == 0))
+        return io_complete(complete, current, 0);
+    blockq_action ba = contextual_closure(unixsock_read_bh, (unixsock)sock, current, 0, sg, length,
+                                          complete, 0, 0, msg);
+    if (ba == INVALID_ADDRESS) {
+        deallocate_closure(complete);
+        goto err_dealloc_sg;
+    }
+    return blockq_check(sock->rxbq, current, ba, false);
   err_dealloc_sg:
     deallocate_sg_list(sg);
     rv = -ENOMEM;
@@ -1002,6 +1338,13 @@ static unixsock unixsock_alloc(heap h, int type, u32 flags, boolean alloc_fd)
     s->sock.recvfrom = unixsock_recvfrom;
     s->sock.sendmsg = unixsock_sendmsg;
     s->sock.recvmsg = unixsock_recvmsg;
+    s->ring = 0;
+    s->rx_seq = 0;
+    s->rcvbuf = s->sndbuf = so_rcvbuf;
+    s->ring_limit = MIN(s->rcvbuf, UNIXSOCK_RING_MAX_SIZE);
+    s->passcred = false;
+    s->cred.pid = current->p->pid;
+    s->cred.uid = s->cred.gid = 0;
     s->fs_entry = 0;
     s->local_addr.sun_family = AF_UNIX;
     s->local_addr.sun_path[0] = '\0';
@@ -20,6 +20,34 @@ struct msghdr {
     int msg_flags;
 };
 
+struct mmsghdr {
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+};
+
+struct cmsghdr {
+    u64 cmsg_len;
+    int cmsg_level;
+    int cmsg_type;
+};
+
+#define CMSG_ALIGN(len)     pad(len, sizeof(u64))
+#define CMSG_DATA(cmsg)     ((u8 *)(cmsg) + CMSG_ALIGN(sizeof(struct cmsghdr)))
+#define CMSG_SPACE(len)     (CMSG_ALIGN(sizeof(struct cmsghdr)) + CMSG_ALIGN(len))
+#define CMSG_LEN(len)       (CMSG_ALIGN(sizeof(struct cmsghdr)) + (len))
+
+/* ancillary message types (level SOL_SOCKET) */
+#define SCM_RIGHTS      1
+#define SCM_CREDENTIALS 2
+
+#define SCM_MAX_FD  253
+
+struct ucred {
+    u32 pid;
+    u32 uid;
+    u32 gid;
+};
+
 #define IFNAMSIZ    16
 
 struct ifmap {
@@ -78,6 +106,12 @@ struct sock {
                          int flags, boolean in_bh, io_completion completion);
     sysreturn (*recvmsg)(struct sock *sock, struct msghdr *msg, int flags, boolean in_bh,
                          io_completion completion);
+    /* optional; if not set, messages are processed one at a time with
+       sendmsg / recvmsg */
+    sysreturn (*sendmmsg)(struct sock *sock, struct mmsghdr *msgvec, unsigned int vlen,
+                          int flags);
+    sysreturn (*recvmmsg)(struct sock *sock, struct mmsghdr *msgvec, unsigned int vlen,
+                          int flags);
     sysreturn (*shutdown)(struct sock *sock, int how);
 };
 
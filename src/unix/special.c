@@ -203,12 +203,66 @@ static u32 cpu_online_events(file f)
     return (EPOLLIN | EPOLLOUT);
 }
 
+static sysreturn tlbshootdown_read(file f, void *dest, u64 length, u64 offset)
+{
+    struct flush_stats fs;
+    page_invalidate_get_stats(&fs);
+    buffer b = little_stack_buffer(256);
+    bprintf(b, "shootdowns %ld\n"
+               "ipis %ld\n"
+               "idle_skipped %ld\n"
+               "pv_flushed %ld\n",
+            fs.shootdowns, fs.ipis, fs.idle_skipped, fs.pv_flushed);
+    return buffer_read_at(b, offset, dest, length);
+}
+
+static sysreturn netrx_read(file f, void *dest, u64 length, u64 offset)
+{
+    struct net_rx_stats rs;
+    net_rx_get_stats(&rs);
+    buffer b = little_stack_buffer(512);
+    bprintf(b, "frames %ld\n"
+               "bytes %ld\n"
+               "inputs %ld\n"
+               "coalesced %ld\n"
+               "inputs_per_gb %ld\n"
+               "interrupts %ld\n"
+               "polls %ld\n"
+               "frames_per_poll %ld\n",
+            rs.frames, rs.bytes, rs.inputs, rs.coalesced,
+            rs.bytes ? (rs.inputs << 30) / rs.bytes : 0,
+            rs.interrupts, rs.polls, rs.polls ? rs.frames / rs.polls : 0);
+    return buffer_read_at(b, offset, dest, length);
+}
+
+static sysreturn syscalls_read(file f, void *dest, u64 length, u64 offset)
+{
+    heap h = heap_locked(get_kernel_heaps());
+    buffer b = allocate_buffer(h, PAGESIZE);
+    if (b == INVALID_ADDRESS)
+        return -ENOMEM;
+    syscall_stats_format(b, current->p);
+    sysreturn rv = buffer_read_at(b, offset, dest, length);
+    deallocate_buffer(b);
+    return rv;
+}
+
+/* any write resets the counters */
+static sysreturn syscalls_write(file f, void *dest, u64 length, u64 offset)
+{
+    syscall_stats_reset();
+    return length;
+}
+
 static const special_file special_files[] = {
     { "/dev/urandom", .read = urandom_read, .write = 0, .events = urandom_events },
     { "/dev/null", .read = null_read, .write = null_write, .events = null_events },
     { "/proc/meminfo", .read = meminfo_read},
     { "/proc/mounts", .open = mounts_open, .close = mounts_close, .read = mounts_read, .events = mounts_events, .alloc_size = sizeof(struct mounts_notify_data)},
     { "/proc/self/maps", .read = maps_read, .events = maps_events, },
+    { "/proc/nanos/tlbshootdown", .read = tlbshootdown_read, },
+    { "/proc/nanos/netrx", .read = netrx_read, },
+    { "/proc/nanos/syscalls", .read = syscalls_read, .write = syscalls_write, },
     { "/sys/devices/system/cpu/online", .read = cpu_online_read, .write = null_write, .events = cpu_online_events },
     FTRACE_SPECIAL_FILES
 };
@@ -14,15 +14,26 @@
 #define DT_SOCK		12
 #define DT_WHT		14
 
+/* Bucket 0 of the latency histogram counts calls completing in under a
+   microsecond, bucket n counts latencies in [2^(n-1), 2^n) usecs, and the
+   last bucket collects everything beyond. */
+#define SYSCALL_STAT_BUCKETS    24
+
 typedef struct syscall_stat {
     u64 calls;
     u64 errors;
-    u64 usecs;
+    u64 usecs;                  /* on-cpu */
+    u64 blocked_usecs;          /* waiting on a blockq */
+    u64 max_usecs;              /* wall-clock latency */
+    u32 hist[SYSCALL_STAT_BUCKETS];
 } *syscall_stat;
 
 static buffer hostname;
 
-static struct syscall_stat stats[SYS_MAX];
+/* Counters are kept per cpu and only summed when read. */
+BSS_RO_AFTER_INIT static syscall_stat *cpu_syscall_stats;
+static u64 syscall_stats_gen;
+BSS_RO_AFTER_INIT static tuple *syscall_stats_mgmt;
 BSS_RO_AFTER_INIT boolean do_syscall_stats;
 BSS_RO_AFTER_INIT static boolean do_missing_files;
 BSS_RO_AFTER_INIT static vector missing_files;
@@ -359,6 +370,13 @@ static boolean is_special(tuple n)
     return get(n, sym(special)) ? true : false;
 }
 
+/* Sockets with an sg_write method take the read buffers by reference, so the
+   data is sent without a copy into the socket. */
+static inline boolean sendfile_sg_out(fdesc out)
+{
+    return out->type == FDESC_TYPE_SOCKET && out->sg_write;
+}
+
 closure_function(9, 2, void, sendfile_bh,
                  fdesc, in, fdesc, out, int *, offset, sg_list, sg, sg_buf, cur_buf, bytes, count, bytes, readlen, bytes, written, boolean, bh,
                  thread, t, sysreturn, rv)
@@ -366,6 +384,23 @@ closure_function(9, 2, void, sendfile_bh,
     thread_log(t, "%s: readlen %ld, written %ld, bh %d, rv %ld",
                __func__, bound(readlen), bound(written), bound(bh), rv);
 
+    if (bound(bh) && sendfile_sg_out(bound(out))) {
+        /* result of an sg write of the whole read */
+        bound(written) = MAX(rv, 0);
+        if (bound(written) < bound(readlen)) {
+            /* rewind the input offset to the end of the written data */
+            s64 rewind = bound(readlen) - bound(written);
+            if (bound(offset))
+                *bound(offset) -= rewind;
+            else if (bound(in)->type == FDESC_TYPE_REGULAR)
+                ((file)bound(in))->offset -= rewind;
+            thread_log(t, "   sg write returned %ld, rewound %ld bytes", rv, rewind);
+        }
+        if (rv > 0)
+            rv = bound(written);
+        goto out_complete;
+    }
+
     if (rv <= 0) {
         if (bound(bh) && rv == -EAGAIN) { /* result of a write */
             if (!bound(offset) && bound(in)->type == FDESC_TYPE_REGULAR) {
@@ -396,6 +431,12 @@ closure_function(9, 2, void, sendfile_bh,
            (io_status_handler for linear) in the middle */
         if (bound(offset))
             *bound(offset) += rv;
+        if (sendfile_sg_out(bound(out))) {
+            /* let the output reference the buffers rather than copy them */
+            apply(bound(out)->sg_write, bound(sg), rv, infinity, t, true,
+                  (io_completion)closure_self());
+            return;
+        }
         bound(cur_buf) = sg_list_head_remove(bound(sg)); /* initial dequeue */
         assert(bound(cur_buf) != INVALID_ADDRESS);
         bound(cur_buf)->offset = 0; /* offset for our use */
@@ -498,7 +539,7 @@ static void begin_file_read(thread t, file f)
     if (md) {
         if ((f->length > 0) && !(f->f.flags & O_NOATIME))
             filesystem_update_relatime(f->fs, md);
-        fs_notify_event(md, IN_ACCESS);
+        fs_notify_event(f->fs, md, IN_ACCESS);
         filesystem_put_meta(f->fs, md);
     }
 }
@@ -603,7 +644,7 @@ static void begin_file_write(thread t, file f, u64 len)
         tuple md = filesystem_get_meta(f->fs, f->n);
         if (md) {
             filesystem_update_mtime(f->fs, md);
-            fs_notify_event(md, IN_MODIFY);
+            fs_notify_event(f->fs, md, IN_MODIFY);
             filesystem_put_meta(f->fs, md);
         }
     }
@@ -740,7 +781,7 @@ closure_function(2, 2, sysreturn, file_close,
     file f = bound(f);
     tuple md = filesystem_get_meta(f->fs, f->n);
     if (md) {
-        fs_notify_event(md, ((f->f.flags & O_ACCMODE) == O_RDONLY) ?
+        fs_notify_event(f->fs, md, ((f->f.flags & O_ACCMODE) == O_RDONLY) ?
                         IN_CLOSE_NOWRITE : IN_CLOSE_WRITE);
         filesystem_put_meta(f->fs, md);
     }
@@ -969,7 +1010,7 @@ sysreturn open_internal(filesystem fs, inode cwd, const char *name, int flags,
     }
     thread_log(current, "   fd %d, length %ld, offset %ld", fd, f->length, f->offset);
     filesystem_reserve(fs);
-    fs_notify_event(n, IN_OPEN);
+    fs_notify_event(fs, n, IN_OPEN);
     ret = fd;
   out:
     filesystem_put_node(fs, n);
@@ -1165,7 +1206,7 @@ static int try_write_dirent(void *dirp, boolean dirent64, char *p,
                 dp->d_reclen = reclen;
                 runtime_memcpy(dp->d_name, p, len + 1);
                 dp->d_off = reclen + *written_sofar;
-                dp->d_type = dt_from_tuple(n);
+                dp->d_type = DT_UNKNOWN;    /* see getdents_set_types() */
             } else {
                 struct linux_dirent *dp = dirp;
                 dp->d_ino = u64_from_pointer(n);
@@ -1173,7 +1214,7 @@ static int try_write_dirent(void *dirp, boolean dirent64, char *p,
                 runtime_memcpy(dp->d_name, p, len);
                 zero(dp->d_name + len, reclen - (((void *)dp->d_name) - dirp) - len - 1);
                 dp->d_off = reclen + *written_sofar;
-                ((char *)dirp)[reclen - 1] = dt_from_tuple(n);
+                ((char *)dirp)[reclen - 1] = DT_UNKNOWN;
             }
 
             // advance dirp
@@ -1202,6 +1243,37 @@ closure_function(7, 2, boolean, getdents_each,
     return true;
 }
 
+/* The type of each entry is read from the entry itself, which cannot be locked while its directory
+   is held, so it is filled in once the directory has been unlocked. */
+static void getdents_set_types(filesystem fs, void *dirp, int len, boolean dirent64)
+{
+    while (len > 0) {
+        inode ino;
+        int reclen;
+        u8 *type;
+        if (dirent64) {
+            struct linux_dirent64 *dp = dirp;
+            ino = dp->d_ino;
+            reclen = dp->d_reclen;
+            type = &dp->d_type;
+        } else {
+            struct linux_dirent *dp = dirp;
+            ino = dp->d_ino;
+            reclen = dp->d_reclen;
+            type = dirp + reclen - 1;
+        }
+        if ((reclen <= 0) || (reclen > len))    /* overwritten by the user program */
+            break;
+        tuple n = filesystem_get_meta(fs, ino);
+        if (n) {
+            *type = dt_from_tuple(n);
+            filesystem_put_meta(fs, n);
+        }
+        dirp += reclen;
+        len -= reclen;
+    }
+}
+
 static sysreturn getdents_internal(int fd, void *dirp, unsigned int count, boolean dirent64)
 {
     file f = resolve_fd(current->p, fd);
@@ -1220,14 +1292,18 @@ static sysreturn getdents_internal(int fd, void *dirp, unsigned int count, boole
 
     int r = 0;
     int read_sofar = 0, written_sofar = 0;
+    void *start = dirp;
     binding_handler h = stack_closure(getdents_each, f, &dirp, dirent64,
                                       &read_sofar, &written_sofar, &count, &r);
     symbol parent_sym = sym_this("..");
     if (apply(h, sym_this("."), md) && apply(h, parent_sym, get_tuple(md, parent_sym)))
         iterate(c, h);
-    fs_notify_event(md, IN_ACCESS);
+    fs_notify_event(f->fs, md, IN_ACCESS);
     filesystem_update_relatime(f->fs, md);
     f->offset = read_sofar;
+    filesystem_put_meta(f->fs, md);
+    md = 0;
+    getdents_set_types(f->fs, start, written_sofar, dirent64);
     if (r < 0 && written_sofar == 0)
         rv = -EINVAL;
     else
@@ -1340,8 +1416,11 @@ sysreturn ftruncate(int fd, long length)
     thread_log(current, "%s %d %d", __func__, fd, length);
     file f = resolve_fd(current->p, fd);
     sysreturn rv;
-    if (!(f->f.flags & (O_RDWR | O_WRONLY)) ||
-            (f->f.type != FDESC_TYPE_REGULAR)) {
+    if (!(f->f.flags & (O_RDWR | O_WRONLY))) {
+        rv = -EINVAL;
+    } else if (f->f.type == FDESC_TYPE_MEMFD) {
+        rv = memfd_truncate(&f->f, length);
+    } else if (f->f.type != FDESC_TYPE_REGULAR) {
         rv = -EINVAL;
     } else {
         rv = truncate_internal(f->fs, f->fsf, f, length);
@@ -1523,6 +1602,10 @@ static void fill_stat(int type, filesystem fs, fsfile f, tuple n, struct stat *s
     case FDESC_TYPE_SYMLINK:
         s->st_mode = S_IFLNK;
         break;
+    case FDESC_TYPE_MEMFD:
+        s->st_mode = S_IFREG | 0777;
+        s->st_blksize = PAGESIZE;
+        break;
     }
     s->st_ino = u64_from_pointer(n);
     if (type == FDESC_TYPE_REGULAR) {
@@ -1575,6 +1658,10 @@ static sysreturn fstat(int fd, struct stat *s)
     fill_stat(f->type, fs, fsf, n, s);
     if (n)
         filesystem_put_meta(fs, n);
+    if (f->type == FDESC_TYPE_MEMFD) {
+        s->st_ino = u64_from_pointer(f);
+        s->st_size = ((file)f)->length;
+    }
     thread_log(current, "st_ino %lx, st_mode 0x%x, st_size %lx", s->st_ino, s->st_mode, s->st_size);
   out:
     fdesc_put(f);
@@ -2097,6 +2184,16 @@ sysreturn fcntl(int fd, int cmd, s64 arg)
             rv = -EINVAL;
         }
         break;
+    case F_ADD_SEALS:
+        rv = memfd_add_seals(f, (u32)arg);
+        break;
+    case F_GET_SEALS:
+        if (f->type == FDESC_TYPE_MEMFD) {
+            rv = memfd_get_seals(f);
+        } else {
+            rv = -EINVAL;
+        }
+        break;
     default:
         rv = -ENOSYS;
     }
@@ -2403,6 +2500,7 @@ void register_file_syscalls(struct syscall *map)
     register_syscall(map, pipe2, pipe2, SYSCALL_F_SET_DESC);
     register_syscall(map, socketpair, socketpair, SYSCALL_F_SET_NET);
     register_syscall(map, eventfd2, eventfd2, SYSCALL_F_SET_DESC);
+    register_syscall(map, memfd_create, memfd_create, SYSCALL_F_SET_DESC);
     register_syscall(map, chdir, chdir, SYSCALL_F_SET_FILE);
     register_syscall(map, fchdir, fchdir, SYSCALL_F_SET_DESC);
     register_syscall(map, sched_getaffinity, sched_getaffinity, 0);
@@ -2435,21 +2533,93 @@ struct syscall {
 static struct syscall _linux_syscalls[SYS_MAX];
 struct syscall * const linux_syscalls = _linux_syscalls;
 
+static inline int syscall_stat_bucket(u64 us)
+{
+    return us == 0 ? 0 : MIN(msb(us) + 1, SYSCALL_STAT_BUCKETS - 1);
+}
+
+/* Keep the THREAD_SYSCALL_TOP syscalls with the highest accumulated latency
+   (space-saving): a syscall not in the table takes over the entry with the
+   lowest latency along with its counts, so that syscalls which keep replacing
+   each other still build up a total. The calls and latency of an entry may
+   thus include those of the syscalls it replaced, but any syscall whose
+   latency exceeds that of the cheapest entry is in the table. */
+static void count_thread_syscall(thread t, int call, u64 us)
+{
+    u64 gen = syscall_stats_gen;
+    if (t->syscall_stats_gen != gen) {
+        runtime_memset((void *)t->syscall_top, 0, sizeof(t->syscall_top));
+        t->syscall_stats_gen = gen;
+    }
+    thread_syscall_stat victim = 0;
+    for (int i = 0; i < THREAD_SYSCALL_TOP; i++) {
+        thread_syscall_stat ts = &t->syscall_top[i];
+        if (ts->calls && ts->call == call) {
+            ts->calls++;
+            ts->usecs += us;
+            return;
+        }
+        if (!victim || (victim->calls && (!ts->calls || ts->usecs < victim->usecs)))
+            victim = ts;
+    }
+    victim->call = call;
+    victim->calls++;
+    victim->usecs += us;
+}
+
 void count_syscall(thread t, sysreturn rv)
 {
     if (t->last_syscall == -1)
         return;
-    syscall_stat ss = &stats[t->last_syscall];
+    int call = t->last_syscall;
     t->last_syscall = -1;
-    fetch_and_add(&ss->calls, 1);
-    if (rv < 0 && rv >= -255)
-        fetch_and_add(&ss->errors, 1);
+    timestamp here = now(CLOCK_ID_MONOTONIC_RAW);
     u64 us;
     if (t->syscall_enter_ts)
-        us = usec_from_timestamp(now(CLOCK_ID_MONOTONIC_RAW) - t->syscall_enter_ts) + t->syscall_time;
+        us = usec_from_timestamp(here - t->syscall_enter_ts) + t->syscall_time;
     else
         us = t->syscall_time;
-    fetch_and_add(&ss->usecs, us);
+    u64 wall_us = usec_from_timestamp(here - t->syscall_start_ts);
+    count_thread_syscall(t, call, wall_us);
+
+    /* completions may run from interrupt handlers on this cpu */
+    u64 flags = irq_disable_save();
+    syscall_stat ss = &cpu_syscall_stats[current_cpu()->id][call];
+    ss->calls++;
+    if (rv < 0 && rv >= -255)
+        ss->errors++;
+    ss->usecs += us;
+    ss->blocked_usecs += MIN(t->syscall_blocked_time, wall_us);
+    if (wall_us > ss->max_usecs)
+        ss->max_usecs = wall_us;
+    ss->hist[syscall_stat_bucket(wall_us)]++;
+    irq_restore(flags);
+}
+
+static void syscall_stats_sum(syscall_stat dest, int call)
+{
+    runtime_memset((void *)dest, 0, sizeof(*dest));
+    for (int cpu = 0; cpu < total_processors; cpu++) {
+        syscall_stat ss = &cpu_syscall_stats[cpu][call];
+        dest->calls += ss->calls;
+        dest->errors += ss->errors;
+        dest->usecs += ss->usecs;
+        dest->blocked_usecs += ss->blocked_usecs;
+        dest->max_usecs = MAX(dest->max_usecs, ss->max_usecs);
+        for (int i = 0; i < SYSCALL_STAT_BUCKETS; i++)
+            dest->hist[i] += ss->hist[i];
+    }
+}
+
+/* Counters are cleared without synchronization; a syscall completing during
+   the reset may leave a partial sample behind. */
+void syscall_stats_reset(void)
+{
+    if (!do_syscall_stats)
+        return;
+    for (int cpu = 0; cpu < total_processors; cpu++)
+        runtime_memset((void *)cpu_syscall_stats[cpu], 0, SYS_MAX * sizeof(struct syscall_stat));
+    fetch_and_add(&syscall_stats_gen, 1);
 }
 
 static boolean debugsyscalls;
@@ -2584,7 +2754,10 @@ void syscall_handler(thread t)
         assert(t->last_syscall == -1);
         t->last_syscall = call;
         t->syscall_enter_ts = now(CLOCK_ID_MONOTONIC_RAW);
+        t->syscall_start_ts = t->syscall_enter_ts;
         t->syscall_time = 0;
+        t->syscall_block_ts = 0;
+        t->syscall_blocked_time = 0;
     }
     struct syscall *s = t->p->syscalls + call;
     if (debugsyscalls) {
@@ -2595,6 +2768,14 @@ void syscall_handler(thread t)
     }
 
     sysreturn (*h)(u64, u64, u64, u64, u64, u64) = s->handler;
+#ifdef CONFIG_TRACELOG
+    /* the span ends when the thread next returns to user mode */
+    if (tracepoint_enabled(TRACEPOINT_SYSCALL)) {
+        t->trace_syscall = true;
+        tracepoint_begin(TRACEPOINT_SYSCALL, t->tid, u64_from_pointer(s->name), call,
+                         arg0, f[SYSCALL_FRAME_ARG1], f[SYSCALL_FRAME_ARG2]);
+    }
+#endif
     if (h) {
         t->syscall_complete = false;
         context_reserve_refcount(&sc->context);
@@ -2704,14 +2885,19 @@ closure_function(0, 2, void, print_syscall_stats_cfn,
     u64 tot_errs = 0;
     buffer tbuf = little_stack_buffer(24);
     buffer pbuf = little_stack_buffer(24);
-    pqueue pq = allocate_pqueue(heap_locked(get_kernel_heaps()), stat_compare);
     syscall_stat ss;
 
     if (status != 0)
         return;
+    heap h = heap_locked(get_kernel_heaps());
+    syscall_stat stats = allocate(h, SYS_MAX * sizeof(struct syscall_stat));
+    if (stats == INVALID_ADDRESS)
+        return;
+    pqueue pq = allocate_pqueue(h, stat_compare);
     rprintf("\n" HDR_FMT SEPARATOR, "% time", "seconds", "usecs/call", "calls", "errors", "syscall");
     for (int i = 0; i < SYS_MAX; i++) {
         ss = &stats[i];
+        syscall_stats_sum(ss, i);
         if (ss->calls == 0)
             continue;
         tot_usecs += ss->usecs;
@@ -2725,6 +2911,170 @@ closure_function(0, 2, void, print_syscall_stats_cfn,
     }
     rprintf(SEPARATOR SUM_FMT, "100.00", print_usecs(tbuf, tot_usecs), 0, tot_calls, tot_errs, "total");
     deallocate_pqueue(pq);
+    deallocate(h, stats, SYS_MAX * sizeof(struct syscall_stat));
+}
+
+closure_function(2, 1, boolean, syscall_stats_format_thread,
+                 buffer, b, u64, gen,
+                 rbnode, n)
+{
+    thread t = struct_from_field(n, thread, n);
+    if (t->syscall_stats_gen != bound(gen))
+        return true;
+    buffer b = bound(b);
+    bprintf(b, "%6d %-16s", t->tid, t->name);
+    for (int i = 0; i < THREAD_SYSCALL_TOP; i++) {
+        thread_syscall_stat ts = &t->syscall_top[i];
+        if (ts->calls)
+            bprintf(b, " %s:%d/%ldus", _linux_syscalls[ts->call].name, ts->calls, ts->usecs);
+    }
+    buffer_write_byte(b, '\n');
+    return true;
+}
+
+/* Text rendering of the live counters for /proc/nanos/syscalls: a summary
+   line and latency histogram per syscall, followed by the top syscalls of
+   each thread in the process. */
+void syscall_stats_format(buffer b, process p)
+{
+    if (!do_syscall_stats) {
+        bprintf(b, "syscall statistics disabled\n");
+        return;
+    }
+    struct syscall_stat ss;
+    bprintf(b, "%-18s %10s %8s %14s %14s %12s\n", "syscall", "calls", "errors", "usecs",
+            "blocked_usecs", "max_usecs");
+    for (int call = 0; call < SYS_MAX; call++) {
+        syscall_stats_sum(&ss, call);
+        if (ss.calls == 0)
+            continue;
+        bprintf(b, "%-18s %10ld %8ld %14ld %14ld %12ld\n", _linux_syscalls[call].name,
+                ss.calls, ss.errors, ss.usecs, ss.blocked_usecs, ss.max_usecs);
+        bprintf(b, "  latency_us");
+        for (int i = 0; i < SYSCALL_STAT_BUCKETS - 1; i++) {
+            if (ss.hist[i])
+                bprintf(b, " <%ld:%d", 1ull << i, ss.hist[i]);
+        }
+        if (ss.hist[SYSCALL_STAT_BUCKETS - 1])
+            bprintf(b, " >=%ld:%d", 1ull << (SYSCALL_STAT_BUCKETS - 2),
+                    ss.hist[SYSCALL_STAT_BUCKETS - 1]);
+        buffer_write_byte(b, '\n');
+    }
+    bprintf(b, "\n%6s %-16s top syscalls (calls/latency)\n", "tid", "name");
+    spin_lock(&p->threads_lock);
+    rbtree_traverse(p->threads, RB_INORDER,
+                    stack_closure(syscall_stats_format_thread, b, syscall_stats_gen));
+    spin_unlock(&p->threads_lock);
+}
+
+/* Management view: each syscall that has been called appears under
+   syscalls/stats, with latency_us/<n> counting calls that completed in under
+   n usecs (and latency_us/inf the remainder). Setting syscalls/reset clears
+   all counters. */
+BSS_RO_AFTER_INIT static symbol syscall_stats_bucket_syms[SYSCALL_STAT_BUCKETS];
+
+static tuple syscall_stats_tuple(int call)
+{
+    struct syscall_stat ss;
+    heap h = heap_locked(get_kernel_heaps());
+    tuple t = syscall_stats_mgmt[call];
+    tuple hist;
+    if (!t) {
+        t = allocate_tuple();
+        assert(t != INVALID_ADDRESS);
+        set(t, sym(calls), value_from_u64(h, 0));
+        set(t, sym(errors), value_from_u64(h, 0));
+        set(t, sym(usecs), value_from_u64(h, 0));
+        set(t, sym(blocked_usecs), value_from_u64(h, 0));
+        set(t, sym(max_usecs), value_from_u64(h, 0));
+        hist = allocate_tuple();
+        assert(hist != INVALID_ADDRESS);
+        for (int i = 0; i < SYSCALL_STAT_BUCKETS; i++)
+            set(hist, syscall_stats_bucket_syms[i], value_from_u64(h, 0));
+        set(t, sym(latency_us), hist);
+        syscall_stats_mgmt[call] = t;
+    } else {
+        hist = get(t, sym(latency_us));
+    }
+    syscall_stats_sum(&ss, call);
+    value_rewrite_u64(get(t, sym(calls)), ss.calls);
+    value_rewrite_u64(get(t, sym(errors)), ss.errors);
+    value_rewrite_u64(get(t, sym(usecs)), ss.usecs);
+    value_rewrite_u64(get(t, sym(blocked_usecs)), ss.blocked_usecs);
+    value_rewrite_u64(get(t, sym(max_usecs)), ss.max_usecs);
+    for (int i = 0; i < SYSCALL_STAT_BUCKETS; i++)
+        value_rewrite_u64(get(hist, syscall_stats_bucket_syms[i]), ss.hist[i]);
+    return t;
+}
+
+closure_function(0, 1, value, syscall_stats_get,
+                 symbol, s)
+{
+    string name = symbol_string(s);
+    for (int call = 0; call < SYS_MAX; call++) {
+        const char *n = _linux_syscalls[call].name;
+        if (n && buffer_compare_with_cstring(name, n))
+            return syscall_stats_tuple(call);
+    }
+    return 0;
+}
+
+closure_function(0, 2, void, syscall_stats_set,
+                 symbol, s, value, v)
+{
+    /* read-only */
+}
+
+closure_function(0, 1, boolean, syscall_stats_iterate,
+                 binding_handler, h)
+{
+    for (int call = 0; call < SYS_MAX; call++) {
+        const char *n = _linux_syscalls[call].name;
+        if (!n)
+            continue;
+        u64 calls = 0;
+        for (int cpu = 0; cpu < total_processors; cpu++)
+            calls += cpu_syscall_stats[cpu][call].calls;
+        if (calls && !apply(h, sym_this(n), syscall_stats_tuple(call)))
+            return false;
+    }
+    return true;
+}
+
+closure_function(0, 1, boolean, syscall_stats_reset_notify,
+                 value, v)
+{
+    syscall_stats_reset();
+    return false;
+}
+
+static void init_syscall_stats(heap h, tuple root)
+{
+    heap backed = (heap)heap_linear_backed(get_kernel_heaps());
+    cpu_syscall_stats = allocate(h, total_processors * sizeof(syscall_stat));
+    assert(cpu_syscall_stats != INVALID_ADDRESS);
+    for (int cpu = 0; cpu < total_processors; cpu++) {
+        cpu_syscall_stats[cpu] = allocate_zero(backed, SYS_MAX * sizeof(struct syscall_stat));
+        assert(cpu_syscall_stats[cpu] != INVALID_ADDRESS);
+    }
+    syscall_stats_mgmt = allocate_zero(h, SYS_MAX * sizeof(tuple));
+    assert(syscall_stats_mgmt != INVALID_ADDRESS);
+    for (int i = 0; i < SYSCALL_STAT_BUCKETS - 1; i++)
+        syscall_stats_bucket_syms[i] = intern_u64(1ull << i);
+    syscall_stats_bucket_syms[SYSCALL_STAT_BUCKETS - 1] = sym(inf);
+
+    tuple t = allocate_tuple();
+    assert(t != INVALID_ADDRESS);
+    tuple stats = allocate_function_tuple(closure(h, syscall_stats_get),
+                                          closure(h, syscall_stats_set),
+                                          closure(h, syscall_stats_iterate));
+    assert(stats != INVALID_ADDRESS);
+    set(t, sym(stats), stats);
+    set(t, sym(no_encode), null_value);
+    tuple_notifier n = tuple_notifier_wrap(t);
+    assert(n != INVALID_ADDRESS);
+    tuple_notifier_register_set_notify(n, sym(reset), closure(h, syscall_stats_reset_notify));
+    set(root, sym(syscalls), n);
 }
 
 static boolean syscall_defer;
@@ -2762,8 +3112,11 @@ void init_syscalls(tuple root)
     if (hostname_t)
         filesystem_read_entire(get_root_fs(), hostname_t, h,
                                closure(h, hostname_done), ignore_status);
-    do_syscall_stats = get(root, sym(syscall_summary)) != 0;
-    if (do_syscall_stats) {
+    boolean syscall_summary = get(root, sym(syscall_summary)) != 0;
+    do_syscall_stats = syscall_summary || get(root, sym(syscall_stats)) != 0;
+    if (do_syscall_stats)
+        init_syscall_stats(h, root);
+    if (syscall_summary) {
         print_syscall_stats = closure(h, print_syscall_stats_cfn);
         add_shutdown_completion(print_syscall_stats);
     }
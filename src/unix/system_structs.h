@@ -125,6 +125,20 @@ typedef struct iovec {
 #define F_DUPFD_CLOEXEC (F_LINUX_SPECIFIC_BASE + 6)
 #define F_SETPIPE_SZ    (F_LINUX_SPECIFIC_BASE + 7)
 #define F_GETPIPE_SZ    (F_LINUX_SPECIFIC_BASE + 8)
+#define F_ADD_SEALS     (F_LINUX_SPECIFIC_BASE + 9)
+#define F_GET_SEALS     (F_LINUX_SPECIFIC_BASE + 10)
+
+/* Types of seals */
+#define F_SEAL_SEAL         0x0001  /* prevent further seals from being set */
+#define F_SEAL_SHRINK       0x0002  /* prevent file from shrinking */
+#define F_SEAL_GROW         0x0004  /* prevent file from growing */
+#define F_SEAL_WRITE        0x0008  /* prevent writes */
+#define F_SEAL_FUTURE_WRITE 0x0010  /* prevent future writes while mapped */
+
+/* memfd_create flags */
+#define MFD_CLOEXEC         0x0001U
+#define MFD_ALLOW_SEALING   0x0002U
+#define MFD_HUGETLB         0x0004U
 
 /* Values for 'mode' argument of access/faccessat syscalls */
 #define F_OK    0x0
@@ -281,8 +295,22 @@ struct utimbuf {
 #define FUTEX_WAIT_REQUEUE_PI	11
 #define FUTEX_CMP_REQUEUE_PI	12
 
+#define FUTEX_PRIVATE_FLAG      128
 #define FUTEX_CLOCK_REALTIME    (1 << 8)
 
+#define FUTEX_BITSET_MATCH_ANY  0xffffffff
+
+/* futex_waitv */
+#define FUTEX_32                2
+#define FUTEX_WAITV_MAX         128
+
+struct futex_waitv {
+    u64 val;
+    u64 uaddr;
+    u32 flags;
+    u32 __reserved;
+};
+
 #define  FUTEX_OP_SET        0  /* uaddr2 = oparg; */
 #define  FUTEX_OP_ADD        1  /* uaddr2 += oparg; */
 #define  FUTEX_OP_OR         2  /* uaddr2 |= oparg; */
@@ -803,8 +831,10 @@ struct io_uring_params {
 };
 
 /* Socket option levels */
+#define SOL_IP          0
 #define SOL_SOCKET      1
 #define SOL_TCP         6
+#define SOL_UDP         17
 #define IPPROTO_IPV6    41
 
 /* set/getsockopt optnames */
@@ -819,11 +849,31 @@ struct io_uring_params {
 #define SO_PRIORITY     12
 #define SO_LINGER       13
 #define SO_REUSEPORT    15
+#define SO_PASSCRED     16
+#define SO_PEERCRED     17
 #define SO_ACCEPTCONN   30
 #define SO_PROTOCOL     38
+#define SO_BUSY_POLL    46
+#define SO_ZEROCOPY     60
 
+#define IP_RECVERR      11
+#define IPV6_RECVERR    25
 #define IPV6_V6ONLY     26
 
+/* error queue messages (IP_RECVERR / IPV6_RECVERR) */
+struct sock_extended_err {
+    u32 ee_errno;
+    u8 ee_origin;
+    u8 ee_type;
+    u8 ee_code;
+    u8 ee_pad;
+    u32 ee_info;
+    u32 ee_data;
+};
+
+#define SO_EE_ORIGIN_ZEROCOPY       5
+#define SO_EE_CODE_ZEROCOPY_COPIED  1
+
 /* eventfd flags */
 #define EFD_CLOEXEC     O_CLOEXEC
 #define EFD_NONBLOCK    O_NONBLOCK
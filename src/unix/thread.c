@@ -148,6 +148,7 @@ sysreturn clone3(struct clone_args *args, bytes size)
 void register_thread_syscalls(struct syscall *map)
 {
     register_syscall(map, futex, futex, 0);
+    register_syscall(map, futex_waitv, futex_waitv, 0);
     register_syscall(map, set_robust_list, set_robust_list, 0);
     register_syscall(map, get_robust_list, get_robust_list, 0);
     register_syscall(map, clone, clone, SYSCALL_F_SET_PROC);
@@ -287,6 +288,12 @@ define_closure_function(1, 0, void, thread_return,
 
     context_frame f = t->context.frame;
     assert(f[FRAME_FULL]);
+#ifdef CONFIG_TRACELOG
+    if (t->trace_syscall) {
+        t->trace_syscall = false;
+        tracepoint_end(TRACEPOINT_SYSCALL, t->tid, f[SYSCALL_FRAME_RETVAL1]);
+    }
+#endif
     thread_trace(t, TRACE_THREAD_RUN, "run thread, cpu %d, frame %p, pc 0x%lx, sp 0x%lx, rv 0x%lx",
                  current_cpu()->id, f, f[SYSCALL_FRAME_PC], f[SYSCALL_FRAME_SP], f[SYSCALL_FRAME_RETVAL1]);
     ci->frcount++;
@@ -439,6 +446,8 @@ thread create_thread(process p, u64 tid)
     t->select_epoll = 0;
     runtime_memset((void *)&t->n, 0, sizeof(struct rbnode));
     t->clear_tid = 0;
+    list_init_member(&t->futex_waiter.l);
+    t->futex_woken = -1;
     t->name[0] = '\0';
 
     init_thread_fault_handler(t);
@@ -473,10 +482,13 @@ thread create_thread(process p, u64 tid)
     t->utime = t->stime = 0;
     t->start_time = 0;
     t->last_syscall = -1;
+    t->syscall_block_ts = 0;
+    t->syscall_stats_gen = 0;
+    runtime_memset((void *)t->syscall_top, 0, sizeof(t->syscall_top));
     t->cpu_timers = 0;
 
     list_init(&t->l_faultwait);
-    spin_lock_init(&t->lock);
+    spin_lock_init_class(&t->lock, "thread");
 
     /* install gdb fault handler if gdb is inited */
     gdb_check_fault_handler(t);
@@ -495,6 +507,7 @@ thread create_thread(process p, u64 tid)
         goto fail_affinity;
     }
     set(t->tracelog_attrs, sym(tid), aprintf(h, "%d", t->tid));
+    t->trace_syscall = false;
 #endif
     return t;
   fail_affinity:
@@ -574,6 +587,5 @@ void init_threads(process p)
 {
     heap h = heap_locked((kernel_heaps)p->uh);
     p->threads = allocate_rbtree(h, closure(h, thread_tid_compare), closure(h, tid_print_key));
-    spin_lock_init(&p->threads_lock);
-    init_futices(p);
+    spin_lock_init_class(&p->threads_lock, "process_threads");
 }
@@ -80,7 +80,7 @@ void init_fdesc(heap h, fdesc f, int type)
     f->refcnt = 1;
     f->type = type;
     f->ns = allocate_notify_set(h);
-    spin_lock_init(&f->lock);
+    spin_lock_init_class(&f->lock, "fdesc");
 }
 
 void release_fdesc(fdesc f)
@@ -395,7 +395,7 @@ process create_process(unix_heaps uh, tuple root, filesystem fs)
     process p = allocate(locked, sizeof(struct process));
     assert(p != INVALID_ADDRESS); 
 
-    spin_lock_init(&p->lock);
+    spin_lock_init_class(&p->lock, "process");
     p->uh = uh;
     p->brk = 0;
     p->pid = allocate_u64((heap)uh->processes, 1);
@@ -504,15 +504,17 @@ process init_unix(kernel_heaps kh, tuple root, filesystem fs)
 	goto alloc_fail;
     if (!poll_init(uh))
 	goto alloc_fail;
+    if (!memfd_init(uh))
+	goto alloc_fail;
     if (!pipe_init(uh))
 	goto alloc_fail;
+    if (!futex_init(uh))
+	goto alloc_fail;
     if (!unix_timers_init(uh))
         goto alloc_fail;
     if (ftrace_init(uh, fs))
 	goto alloc_fail;
-#ifdef LOCK_STATS
     lockstats_init(kh);
-#endif
 #ifdef NET
     if (!netsyscall_init(uh, root))
         goto alloc_fail;
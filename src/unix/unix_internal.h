@@ -275,6 +275,25 @@ declare_closure_struct(2, 2, void, blockq_thread_timeout,
 
 declare_closure_struct(0, 0, timestamp, thread_now);
 
+/* entry on a futex hash bucket, present only while the owning thread waits */
+struct futex_waiter {
+    struct list l;
+    process p;
+    int *uaddr;
+    u32 bitset;
+    int index;
+    thread t;
+};
+
+/* most expensive syscalls of a thread, by accumulated latency (upper bound) */
+#define THREAD_SYSCALL_TOP 4
+
+typedef struct thread_syscall_stat {
+    int call;
+    u32 calls;
+    u64 usecs;
+} *thread_syscall_stat;
+
 typedef struct thread {
     struct context context;
 
@@ -305,6 +324,10 @@ typedef struct thread {
     /* set by set_robust_list syscall */
     void *robust_list;
 
+    /* futex wait state; futex_woken is the index of the waiter that was woken, or -1 */
+    struct futex_waiter futex_waiter;
+    int futex_woken;
+
     /* blockq data */
     boolean bq_timer_pending;
     struct timer bq_timer;       /* timer for this item */
@@ -330,6 +353,11 @@ typedef struct thread {
     int last_syscall;
     timestamp syscall_enter_ts;
     u64 syscall_time;
+    timestamp syscall_start_ts;
+    timestamp syscall_block_ts;
+    u64 syscall_blocked_time;
+    u64 syscall_stats_gen;
+    struct thread_syscall_stat syscall_top[THREAD_SYSCALL_TOP];
     closure_struct(thread_now, now);
     timerqueue cpu_timers;
 
@@ -348,6 +376,7 @@ typedef struct thread {
 
 #ifdef CONFIG_TRACELOG
     tuple tracelog_attrs;
+    boolean trace_syscall;
 #endif
 } *thread;
 
@@ -377,6 +406,7 @@ typedef closure_type(sg_file_io, sysreturn, sg_list sg, u64 length, u64 offset,
 #define FDESC_TYPE_SYMLINK     11
 #define FDESC_TYPE_IORING      12
 #define FDESC_TYPE_INOTIFY     13
+#define FDESC_TYPE_MEMFD       14
 
 declare_closure_struct(1, 2, void, fdesc_io_complete,
                        struct fdesc *, f,
@@ -488,7 +518,6 @@ typedef struct process {
     filesystem        cwd_fs;
     tuple             process_root;
     inode             cwd;
-    table             futices;
     fault_handler     handler;
     rbtree            threads;
     struct spinlock   threads_lock;
@@ -837,6 +866,25 @@ static inline void count_syscall_noreturn(thread t)
     t->last_syscall = -1;
 }
 
+/* time spent waiting on a blockq is accounted separately from on-cpu time */
+static inline void count_syscall_block(thread t)
+{
+    if (do_syscall_stats && t->last_syscall != -1 && t->syscall_block_ts == 0)
+        t->syscall_block_ts = now(CLOCK_ID_MONOTONIC_RAW);
+}
+
+static inline void count_syscall_unblock(thread t)
+{
+    if (do_syscall_stats && t->syscall_block_ts) {
+        t->syscall_blocked_time += usec_from_timestamp(now(CLOCK_ID_MONOTONIC_RAW) -
+                                                       t->syscall_block_ts);
+        t->syscall_block_ts = 0;
+    }
+}
+
+void syscall_stats_format(buffer b, process p);
+void syscall_stats_reset(void);
+
 void register_file_syscalls(struct syscall *);
 void register_net_syscalls(struct syscall *);
 void register_signal_syscalls(struct syscall *);
@@ -860,9 +908,18 @@ extern sysreturn syscall_ignore();
 u64 new_zeroed_pages(u64 v, u64 length, pageflags flags, status_handler complete);
 boolean do_demand_page(thread t, context ctx, u64 vaddr, vmap vm);
 vmap vmap_from_vaddr(process p, u64 vaddr);
+u64 pin_user_pages(process p, u64 vaddr, u64 len, u64 *phys);
+void unpin_user_pages(u64 phys, u64 len);
 void vmap_iterator(process p, vmap_handler vmh);
 boolean vmap_validate_range(process p, range q, u32 flags);
-void truncate_file_maps(process p, fsfile f, u64 new_length);
+void truncate_node_maps(process p, pagecache_node pn, u64 new_length);
+boolean vmap_node_apply_unless_writable(process p, pagecache_node pn, thunk t);
+
+static inline void truncate_file_maps(process p, fsfile f, u64 new_length)
+{
+    truncate_node_maps(p, fsfile_get_cachenode(f), new_length);
+}
+
 const char *string_from_mmap_type(int type);
 
 void thread_log_internal(thread t, const char *desc, ...);
@@ -975,9 +1032,11 @@ static inline u64 iov_total_len(struct iovec *iov, int iovcnt)
 
 void init_syscalls(tuple root);
 void init_threads(process p);
-void init_futices(process p);
+boolean futex_init(unix_heaps uh);
 
 sysreturn futex(int *uaddr, int futex_op, int val, u64 val2, int *uaddr2, int val3);
+sysreturn futex_waitv(struct futex_waitv *waiters, unsigned int nr_futexes, unsigned int flags,
+                      struct timespec *timeout, clock_id clockid);
 sysreturn get_robust_list(int pid, void *head, u64 *len);
 sysreturn set_robust_list(void *head, u64 len);
 void wake_robust_list(process p, void *head);
@@ -1019,6 +1078,13 @@ sysreturn inotify_rm_watch(int fd, int wd);
 
 int do_eventfd2(unsigned int count, int flags);
 
+boolean memfd_init(unix_heaps uh);
+sysreturn memfd_create(const char *name, unsigned int flags);
+pagecache_node memfd_get_cachenode(fdesc f);
+u32 memfd_get_seals(fdesc f);
+sysreturn memfd_add_seals(fdesc f, u32 seals);
+sysreturn memfd_truncate(fdesc f, long length);
+
 typedef closure_type(spec_file_open, sysreturn, file f);
 
 void register_special_files(process p);
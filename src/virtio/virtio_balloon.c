@@ -34,6 +34,27 @@
 #define VIRTIO_BALLOON_F_MUST_TELL_HOST 1
 #define VIRTIO_BALLOON_F_STATS_VQ       2
 #define VIRTIO_BALLOON_F_DEFLATE_ON_OOM 4
+#define VIRTIO_BALLOON_F_FREE_PAGE_HINT 8
+#define VIRTIO_BALLOON_F_PAGE_REPORTING 0x20
+
+/* Free page reporting: every interval, up to limit MB of free memory is taken
+   from the physical heap in balloon allocation units and reported to the
+   host, which may then discard the backing pages. The units go back to the
+   physical heap as soon as the host acknowledges the report. As allocation
+   of units is next-fit, successive reports sweep all of free memory.
+
+   Reported units are marked in a bitmap, and are not reported again until
+   they have been seen in use: each interval starts by probing the marked
+   units, and clears the mark of any that is no longer free. A unit that is
+   used and freed again between two intervals keeps its mark, so it is left
+   to the host until it is next seen in use. An interval ends after a full
+   pass over free memory, even if the limit has not been reached. */
+#define VIRTIO_BALLOON_REPORT_INTERVAL_SEC  2
+#define VIRTIO_BALLOON_REPORT_LIMIT_MB      64
+#define VIRTIO_BALLOON_REPORT_CAPACITY      32  /* units per report */
+
+/* don't hold memory for reporting if it could trigger memory cleaning */
+#define VIRTIO_BALLOON_REPORT_MEMORY_MINIMUM (MEM_CLEAN_THRESHOLD + BALLOON_MEMORY_MINIMUM)
 
 struct virtio_balloon_stat {
 #define VIRTIO_BALLOON_S_SWAP_IN      0
@@ -55,6 +76,10 @@ struct virtio_balloon_stat {
 
 declare_closure_struct(0, 2, void, virtio_balloon_timer_task,
                        u64, expiry, u64, overruns);
+declare_closure_struct(0, 2, void, virtio_balloon_report_task,
+                       u64, expiry, u64, overruns);
+declare_closure_struct(0, 1, void, virtio_balloon_report_complete,
+                       u64, len);
 struct virtio_balloon {
     heap general;
     backed_heap backed;
@@ -71,6 +96,22 @@ struct virtio_balloon {
     u32 actual_pages;
     struct list in_balloon;
     struct list free;
+
+    /* free page reporting */
+    virtqueue reportq;
+    struct timer report_timer;
+    closure_struct(virtio_balloon_report_task, report_task);
+    closure_struct(virtio_balloon_report_complete, report_complete);
+    boolean report_configured;
+    u32 report_pending;
+    u64 report_interval;    /* seconds */
+    u64 report_limit;       /* allocation units per interval */
+    u64 report_budget;      /* allocation units left in this interval */
+    int report_count;
+    u64 report_units[VIRTIO_BALLOON_REPORT_CAPACITY];
+    u64 report_scanned;     /* allocation units taken in this interval */
+    bitmap reported_units;  /* reported and not seen in use since */
+    u64 reported;           /* total allocation units reported */
 } virtio_balloon;
 
 typedef struct balloon_page {
@@ -98,6 +139,11 @@ static inline boolean balloon_has_stats_vq(void)
     return (virtio_balloon.dev->features & VIRTIO_BALLOON_F_STATS_VQ) != 0;
 }
 
+static inline boolean balloon_has_page_reporting(void)
+{
+    return (virtio_balloon.dev->features & VIRTIO_BALLOON_F_PAGE_REPORTING) != 0;
+}
+
 static u64 phys_base_from_balloon_page(balloon_page bp)
 {
     return bp->addrs[0] << VIRTIO_BALLOON_PAGE_ORDER;
@@ -347,6 +393,139 @@ define_closure_function(0, 2, void, virtio_balloon_timer_task,
     }
 }
 
+/* Called with report_pending set; clears it once there is nothing more to
+   report in this interval. */
+static void virtio_balloon_report(void)
+{
+    heap physical = (heap)virtio_balloon.physical;
+    u64 units = heap_total(physical) >> VIRTIO_BALLOON_ALLOC_ORDER;
+    int n = 0;
+    while ((n < MIN(virtio_balloon.report_budget, VIRTIO_BALLOON_REPORT_CAPACITY)) &&
+           (virtio_balloon.report_scanned < units)) {
+        if (heap_free(physical) <
+            (VIRTIO_BALLOON_REPORT_MEMORY_MINIMUM + VIRTIO_BALLOON_ALLOC_SIZE))
+            break;
+        u64 phys = allocate_u64(physical, VIRTIO_BALLOON_ALLOC_SIZE);
+        if (phys == INVALID_PHYSICAL)
+            break;
+        virtio_balloon.report_scanned++;
+        if (bitmap_get(virtio_balloon.reported_units, phys >> VIRTIO_BALLOON_ALLOC_ORDER)) {
+            deallocate_u64(physical, phys, VIRTIO_BALLOON_ALLOC_SIZE);
+            continue;
+        }
+        virtio_balloon.report_units[n++] = phys;
+    }
+    virtio_balloon_verbose("%s: %d units, budget %ld\n", __func__, n,
+                           virtio_balloon.report_budget);
+    if (n == 0) {
+        virtio_balloon.report_budget = 0;
+        write_barrier();
+        virtio_balloon.report_pending = false;
+        return;
+    }
+    virtio_balloon.report_budget -= n;
+    virtio_balloon.report_count = n;
+    virtqueue vq = virtio_balloon.reportq;
+    vqmsg m = allocate_vqmsg(vq);
+    assert(m != INVALID_ADDRESS);
+    for (int i = 0; i < n; i++)
+        vqmsg_push(vq, m, virtio_balloon.report_units[i], VIRTIO_BALLOON_ALLOC_SIZE, true);
+    vqmsg_commit(vq, m, (vqfinish)&virtio_balloon.report_complete);
+}
+
+define_closure_function(0, 1, void, virtio_balloon_report_complete,
+                        u64, len)
+{
+    /* the host is done with the pages; they can be used again right away */
+    for (int i = 0; i < virtio_balloon.report_count; i++) {
+        u64 phys = virtio_balloon.report_units[i];
+        bitmap_set(virtio_balloon.reported_units, phys >> VIRTIO_BALLOON_ALLOC_ORDER, 1);
+        deallocate_u64((heap)virtio_balloon.physical, phys, VIRTIO_BALLOON_ALLOC_SIZE);
+    }
+    virtio_balloon.reported += virtio_balloon.report_count;
+    virtio_balloon.report_count = 0;
+    virtio_balloon_report();
+}
+
+/* Clears the mark of reported units which are no longer free. */
+static void virtio_balloon_report_probe(void)
+{
+    id_heap physical = virtio_balloon.physical;
+    bitmap b = virtio_balloon.reported_units;
+    u64 unit = 0;
+    while (unit < b->mapbits &&
+           (unit = bitmap_range_get_first(b, unit, b->mapbits - unit)) != INVALID_PHYSICAL) {
+        u64 phys = unit << VIRTIO_BALLOON_ALLOC_ORDER;
+        if (id_heap_set_area(physical, phys, VIRTIO_BALLOON_ALLOC_SIZE, true, true))
+            deallocate_u64((heap)physical, phys, VIRTIO_BALLOON_ALLOC_SIZE);
+        else
+            bitmap_set(b, unit, 0);
+        unit++;
+    }
+}
+
+/* The manifest is read on the first run after the root filesystem is up. */
+static void virtio_balloon_report_config(void)
+{
+    tuple root = get_root_tuple();
+    if (!root)
+        return;
+    u64 interval, limit;
+    if (get_u64(root, sym(balloon_report_interval), &interval))
+        virtio_balloon.report_interval = interval;
+    if (get_u64(root, sym(balloon_report_limit), &limit))
+        virtio_balloon.report_limit = (limit + MASK(VIRTIO_BALLOON_ALLOC_ORDER - 20)) >>
+            (VIRTIO_BALLOON_ALLOC_ORDER - 20);
+    virtio_balloon_debug("%s: interval %ld s, limit %ld units\n", __func__,
+                         virtio_balloon.report_interval, virtio_balloon.report_limit);
+    virtio_balloon.report_configured = true;
+}
+
+define_closure_function(0, 2, void, virtio_balloon_report_task,
+                        u64, expiry, u64, overruns)
+{
+    if (overruns == timer_disabled)
+        return;
+    if (!virtio_balloon.report_configured) {
+        virtio_balloon_report_config();
+        if (virtio_balloon.report_interval == 0 || virtio_balloon.report_limit == 0) {
+            virtio_balloon_debug("free page reporting disabled\n");
+            return;
+        }
+    }
+    virtio_balloon_debug("%s: %ld MB reported so far\n", __func__,
+                         virtio_balloon.reported << (VIRTIO_BALLOON_ALLOC_ORDER - 20));
+    if (compare_and_swap_32(&virtio_balloon.report_pending, false, true)) {
+        virtio_balloon_report_probe();
+        virtio_balloon.report_budget = virtio_balloon.report_limit;
+        virtio_balloon.report_scanned = 0;
+        virtio_balloon_report();
+    }
+    register_timer(kernel_timers, &virtio_balloon.report_timer, CLOCK_ID_MONOTONIC,
+                   seconds(virtio_balloon.report_interval), false, 0,
+                   (timer_handler)&virtio_balloon.report_task);
+}
+
+static void virtio_balloon_init_reporting(void)
+{
+    virtio_balloon_debug("%s\n", __func__);
+    virtio_balloon.report_configured = false;
+    virtio_balloon.report_pending = false;
+    virtio_balloon.report_interval = VIRTIO_BALLOON_REPORT_INTERVAL_SEC;
+    virtio_balloon.report_limit = VIRTIO_BALLOON_REPORT_LIMIT_MB >>
+        (VIRTIO_BALLOON_ALLOC_ORDER - 20);
+    virtio_balloon.report_count = 0;
+    virtio_balloon.reported_units = allocate_bitmap(virtio_balloon.general,
+                                                    virtio_balloon.general, infinity);
+    assert(virtio_balloon.reported_units != INVALID_ADDRESS);
+    virtio_balloon.reported = 0;
+    init_closure(&virtio_balloon.report_complete, virtio_balloon_report_complete);
+    init_closure(&virtio_balloon.report_task, virtio_balloon_report_task);
+    register_timer(kernel_timers, &virtio_balloon.report_timer, CLOCK_ID_MONOTONIC,
+                   seconds(virtio_balloon.report_interval), false, 0,
+                   (timer_handler)&virtio_balloon.report_task);
+}
+
 static boolean virtio_balloon_attach(heap general, backed_heap backed, id_heap physical, vtdev v)
 {
     virtio_balloon_debug("   dev_features 0x%lx, features 0x%lx\n",
@@ -382,6 +561,19 @@ static boolean virtio_balloon_attach(heap general, backed_heap backed, id_heap p
     } else {
         virtio_balloon.statsq = 0;
     }
+    if (balloon_has_page_reporting()) {
+        /* The free page hint queue, which we don't use, precedes the reporting
+           queue if the device offers it. */
+        int idx = balloon_has_stats_vq() ? 3 : 2;
+        if (v->dev_features & VIRTIO_BALLOON_F_FREE_PAGE_HINT)
+            idx++;
+        init_timer(&virtio_balloon.report_timer);
+        s = virtio_alloc_virtqueue(v, "virtio balloon reportq", idx, &virtio_balloon.reportq);
+        if (!is_ok(s))
+            goto fail;
+    } else {
+        virtio_balloon.reportq = 0;
+    }
     virtio_balloon_debug("   virtqueues allocated, setting driver status OK\n");
     vtdev_set_status(v, VIRTIO_CONFIG_STATUS_DRIVER_OK);
     update_actual_pages(0);
@@ -392,6 +584,8 @@ static boolean virtio_balloon_attach(heap general, backed_heap backed, id_heap p
         deallocate_closure(bd);
     if (balloon_has_stats_vq())
         virtio_balloon_init_statsq();
+    if (balloon_has_page_reporting())
+        virtio_balloon_init_reporting();
     return true;
   fail:
     rprintf("%s: failed to attach: %v\n", __func__, s);
@@ -409,7 +603,8 @@ closure_function(3, 1, boolean, vtpci_balloon_probe,
     virtio_balloon_debug("   attaching\n", __func__);
     vtdev v = (vtdev)attach_vtpci(bound(general), bound(backed), d,
                                   (VIRTIO_BALLOON_F_STATS_VQ |
-                                   VIRTIO_BALLOON_F_MUST_TELL_HOST));
+                                   VIRTIO_BALLOON_F_MUST_TELL_HOST |
+                                   VIRTIO_BALLOON_F_PAGE_REPORTING));
     return virtio_balloon_attach(bound(general), bound(backed), bound(physical), v);
 }
 
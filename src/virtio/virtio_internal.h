@@ -122,9 +122,18 @@ physical virtqueue_used_paddr(struct virtqueue *vq);
 u16 virtqueue_entries(virtqueue vq);
 void virtqueue_set_polling(virtqueue vq, boolean enable);
 
+#define VIRTQUEUE_SERVICE_MAX   64
+
+void virtqueue_set_service(virtqueue vq, thunk service);
+u64 virtqueue_service(virtqueue vq, u64 budget);
+boolean virtqueue_service_done(virtqueue vq);
+boolean virtqueue_service_claim(virtqueue vq);
+void virtqueue_kick(virtqueue vq);
+
 typedef struct vqmsg *vqmsg;
 
 vqmsg allocate_vqmsg(virtqueue vq);
 void deallocate_vqmsg(virtqueue vq, vqmsg m);
 void vqmsg_push(virtqueue vq, vqmsg m, u64 phys_addr, u32 len, boolean write);
 void vqmsg_commit(virtqueue vq, vqmsg m, vqfinish completion);
+void vqmsg_queue(virtqueue vq, vqmsg m, vqfinish completion);
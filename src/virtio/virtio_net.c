@@ -31,6 +31,7 @@
  */
 
 #include <kernel.h>
+#include <net.h>
 #include "lwip.h"
 #include "lwip/opt.h"
 #include "lwip/def.h"
@@ -42,6 +43,9 @@
 #include "lwip/etharp.h"
 #include "lwip/dhcp.h"
 #include "lwip/timeouts.h"
+#include "lwip/inet_chksum.h"
+#include "lwip/prot/tcp.h"
+#include "lwip/prot/udp.h"
 #include "netif/ethernet.h"
 #include "virtio_internal.h"
 #include "virtio_mmio.h"
@@ -54,16 +58,61 @@
 # define virtio_net_debug(...) do { } while(0)
 #endif // defined(VIRTIO_NET_DEBUG)
 
+/* maximum number of received frames handled per service pass */
+#define VNET_RX_BUDGET  VIRTQUEUE_SERVICE_MAX
+
+/* receive offloads: the device may hand us TSO frames assembled from
+   several receive buffers, with checksums it has already validated */
+#define VNET_RX_FEATURES    (VIRTIO_NET_F_GUEST_CSUM | VIRTIO_NET_F_GUEST_TSO4 | \
+                             VIRTIO_NET_F_GUEST_TSO6 | VIRTIO_NET_F_MRG_RXBUF)
+
+/* largest frame that guest TSO can deliver: a full-size IP datagram behind
+   a VLAN-tagged ethernet header */
+#define VNET_RX_GSO_MAX (sizeof(struct eth_hdr) + sizeof(struct eth_vlan_hdr) + 0xffff)
+
+/* pbuf lengths are 16 bits wide */
+#define VNET_FRAME_MAX  0xffff
+
+/* TCP flows tracked by receive coalescing within a service pass */
+#define VNET_GRO_FLOWS  8
+
+typedef struct vnet_gro_flow {
+    struct pbuf *p;         /* frame being coalesced; null if the slot is free */
+    struct tcp_hdr *tcp;
+    boolean ipv6;
+    u16 hdr_len;
+    u32 next_seq;
+    u32 segs;
+} *vnet_gro_flow;
+
 declare_closure_struct(0, 1, u64, vnet_mem_cleaner,
                        u64, clean_bytes);
+declare_closure_struct(0, 0, void, vnet_rx_service);
+declare_closure_struct(0, 2, boolean, vnet_busy_poll,
+                       timestamp, deadline, busy_poll_cond, cond);
 typedef struct vnet {
     vtdev dev;
     u16 port;
     caching_heap rxbuffers;
     caching_heap txhandlers;
     closure_struct(vnet_mem_cleaner, mem_cleaner);
+    closure_struct(vnet_rx_service, rx_service);
+    closure_struct(vnet_busy_poll, busy_poll);
+    struct pbuf *rx_batch[VNET_RX_BUDGET];
+    int rx_batch_count;
+    struct vnet_gro_flow gro_flows[VNET_GRO_FLOWS];
+    int gro_evict;
+    boolean rx_csum_offload;
+    boolean rx_continue;    /* rx_service rescheduled by the driver rather than an interrupt */
+    struct net_rx_stats rx_stats;
+    /* frame being assembled from receive buffers */
+    struct virtio_net_hdr rx_hdr;
+    struct pbuf *rx_frame, *rx_frame_tail;
+    u64 rx_frame_len;
+    u16 rx_frame_bufs;      /* buffers still to come */
     bytes net_header_len;
     int rxbuflen;
+    int rx_msg_bufs;        /* buffers per receive message */
     struct netif *n;
     struct virtqueue *txq;
     struct virtqueue *rxq;
@@ -78,6 +127,8 @@ typedef struct xpbuf
 {
     struct pbuf_custom p;
     vnet vn;
+    struct xpbuf *next_buf; /* next buffer posted in the same message */
+    boolean csum_valid;     /* first buffer of a frame with checksums validated */
     closure_struct(vnet_input, input);
 } *xpbuf;
 
@@ -127,54 +178,83 @@ static void receive_buffer_release(struct pbuf *p)
     deallocate((heap)x->vn->rxbuffers, x, x->vn->rxbuflen + sizeof(struct xpbuf));
 }
 
-static void post_receive(vnet vn);
+/* With VIRTIO_NET_F_GUEST_CSUM negotiated, frames that the device has
+   validated, or that carry a partial checksum from a sender on the same
+   host, are input with the stack's TCP and UDP checksum checks turned off.
+   Any other frame is checked by the stack as usual, which covers IP
+   fragments after reassembly and IPv6 packets with extension headers.
+   Input is synchronous, so the checks can be switched per frame. */
+static void vnet_rx_deliver(vnet vn, struct pbuf *p)
+{
+    struct netif *n = vn->n;
+    vn->rx_stats.inputs++;
+    if (((xpbuf)p)->csum_valid)
+        NETIF_SET_CHECKSUM_CTRL(n, NETIF_CHECKSUM_ENABLE_ALL &
+                                ~(NETIF_CHECKSUM_CHECK_TCP | NETIF_CHECKSUM_CHECK_UDP));
+    else
+        NETIF_SET_CHECKSUM_CTRL(n, NETIF_CHECKSUM_ENABLE_ALL);
+    if (n->input(p, n) != ERR_OK)
+        pbuf_free(p);
+}
 
-static u16 vnet_csum(u8 *buf, u64 len)
+/* A frame is complete once all of its receive buffers have been used. */
+static void vnet_rx_frame_done(vnet vn)
 {
-    u64 sum = 0;
-    while (len >= sizeof(u64)) {
-        u64 s = *(u64 *)buf;
-        sum += s;
-        if (sum < s)
-            sum++;
-        buf += sizeof(u64);
-        len -= sizeof(u64);
-    }
-    if (len >= sizeof(u32)) {
-        u32 s = *(u32 *)buf;
-        sum += s;
-        if (sum < s)
-            sum++;
-        buf += sizeof(u32);
-        len -= sizeof(u32);
-    }
-    if (len >= sizeof(u16)) {
-        u16 s = *(u16 *)buf;
-        sum += s;
-        if (sum < s)
-            sum++;
-        buf += sizeof(u16);
-        len -= sizeof(u16);
+    struct pbuf *p = vn->rx_frame;
+    u64 len = vn->rx_frame_len;
+    vn->rx_frame = vn->rx_frame_tail = 0;
+    vn->rx_frame_len = 0;
+    if (!p)
+        return;
+    vn->rx_stats.frames++;
+    vn->rx_stats.bytes += len;
+    u64 remain = len;
+    for (struct pbuf *q = p; q; q = q->next) {
+        q->tot_len = remain;
+        remain -= q->len;
     }
-    if (len) {
-        u8 s = *buf;
-        sum += s;
-        if (sum < s)
-            sum++;
+
+    /* A frame that doesn't fit in a pbuf chain could only be a merged TSO
+       frame carrying a full-size IP datagram; hosts keep their TSO frames
+       below that limit. */
+    if (len > VNET_FRAME_MAX) {
+        virtio_net_debug("%s: dropping oversize frame (%ld bytes)\n", __func__, len);
+        LINK_STATS_INC(link.drop);
+        pbuf_free(p);
+        return;
     }
+    ((xpbuf)p)->csum_valid = vn->rx_csum_offload &&
+        (vn->rx_hdr.flags & (VIRTIO_NET_HDR_F_NEEDS_CSUM | VIRTIO_NET_HDR_F_DATA_VALID));
+    /* frames are handed to the stack by vnet_rx_service() */
+    vn->rx_batch[vn->rx_batch_count++] = p;
+}
 
-    /* Fold down to 16 bits */
-    u32 s1 = sum;
-    u32 s2 = sum >> 32;
-    s1 += s2;
-    if (s1 < s2)
-        s1++;
-    u16 s3 = s1;
-    u16 s4 = s1 >> 16;
-    s3 += s4;
-    if (s3 < s4)
-        s3++;
-    return ~s3;
+/* Add the used part of a receive buffer, and of any buffers posted along
+   with it, to the frame being assembled; unused buffers are released. */
+static void vnet_rx_append(vnet vn, xpbuf x, u64 len)
+{
+    while (x) {
+        xpbuf next = x->next_buf;
+        struct pbuf *p = &x->p.pbuf;
+        u64 avail = ((u8 *)(x + 1) + vn->rxbuflen) - (u8 *)p->payload;
+        u64 n = MIN(len, avail);
+        x->next_buf = 0;
+        if (n == 0) {
+            receive_buffer_release(p);
+        } else {
+            p->len = n;
+            p->next = 0;
+            if (vn->rx_frame_tail)
+                vn->rx_frame_tail->next = p;
+            else
+                vn->rx_frame = p;
+            vn->rx_frame_tail = p;
+            vn->rx_frame_len += n;
+            len -= n;
+        }
+        x = next;
+    }
+    assert(len == 0);
 }
 
 define_closure_function(0, 1, void, vnet_input,
@@ -183,55 +263,297 @@ define_closure_function(0, 1, void, vnet_input,
     virtio_net_debug("%s: len %ld\n", __func__, len);
 
     xpbuf x = struct_from_field(closure_self(), xpbuf, input);
-    vnet vn= x->vn;
-    // under what conditions does a virtio queue give us zero?
-    struct virtio_net_hdr *hdr = (struct virtio_net_hdr *)x->p.pbuf.payload;
-    boolean err = false;
-    len -= vn->net_header_len;
-    assert(len <= x->p.pbuf.len);
-    x->p.pbuf.tot_len = x->p.pbuf.len = len;
-    x->p.pbuf.payload += vn->net_header_len;
-    if (hdr->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) {
-        if (hdr->csum_start + hdr->csum_offset <= len - sizeof(u16)) {
-            u16 csum = vnet_csum(x->p.pbuf.payload + hdr->csum_start, len - hdr->csum_start);
-            *(u16 *)(x->p.pbuf.payload + hdr->csum_start + hdr->csum_offset) = csum;
+    vnet vn = x->vn;
+    if (vn->rx_frame_bufs == 0) {
+        /* first buffer of a frame, starting with the virtio header */
+        struct virtio_net_hdr_mrg_rxbuf *hdr = x->p.pbuf.payload;
+        assert(len >= vn->net_header_len);
+        runtime_memcpy(&vn->rx_hdr, &hdr->hdr, sizeof(vn->rx_hdr));
+        vn->rx_frame_bufs = (vn->dev->features & VIRTIO_NET_F_MRG_RXBUF) ?
+            MAX(hdr->num_buffers, 1) : 1;
+        x->p.pbuf.payload += vn->net_header_len;
+        len -= vn->net_header_len;
+    }
+    vnet_rx_append(vn, x, len);
+    if (--vn->rx_frame_bufs == 0)
+        vnet_rx_frame_done(vn);
+}
+
+/* Headers of a TCP segment that receive coalescing can work on */
+typedef struct vnet_tcp_seg {
+    u8 *l3;                 /* IPv4 or IPv6 header */
+    boolean ipv6;
+    struct tcp_hdr *tcp;
+    u16 hdr_len;            /* ethernet, IP and TCP header bytes */
+    u16 payload_len;
+} *vnet_tcp_seg;
+
+/* Only plain in-order data segments are coalesced: no IP options or
+   fragments, no IPv6 extension headers, and no TCP flags other than ACK
+   and PSH. All headers must be in the first buffer of the frame. */
+static boolean vnet_gro_parse(struct pbuf *p, vnet_tcp_seg s)
+{
+    if (p->len < SIZEOF_ETH_HDR)
+        return false;
+    struct eth_hdr *eth = p->payload;
+    s->l3 = (u8 *)p->payload + SIZEOF_ETH_HDR;
+    u32 l3_len;
+    u16 hlen = SIZEOF_ETH_HDR;
+    if (eth->type == PP_HTONS(ETHTYPE_IP)) {
+        struct ip_hdr *iph = (struct ip_hdr *)s->l3;
+        if (p->len < SIZEOF_ETH_HDR + IP_HLEN || IPH_V(iph) != 4 || IPH_HL_BYTES(iph) != IP_HLEN ||
+            (IPH_OFFSET(iph) & PP_HTONS(IP_MF | IP_OFFMASK)) || IPH_PROTO(iph) != IP_PROTO_TCP)
+            return false;
+        s->ipv6 = false;
+        l3_len = lwip_ntohs(IPH_LEN(iph));
+        hlen += IP_HLEN;
+    } else if (eth->type == PP_HTONS(ETHTYPE_IPV6)) {
+        struct ip6_hdr *ip6h = (struct ip6_hdr *)s->l3;
+        if (p->len < SIZEOF_ETH_HDR + IP6_HLEN || IP6H_V(ip6h) != 6 ||
+            IP6H_NEXTH(ip6h) != IP6_NEXTH_TCP)
+            return false;
+        s->ipv6 = true;
+        l3_len = IP6_HLEN + IP6H_PLEN(ip6h);
+        hlen += IP6_HLEN;
+    } else {
+        return false;
+    }
+    if (p->len < hlen + TCP_HLEN)
+        return false;
+    s->tcp = (struct tcp_hdr *)((u8 *)p->payload + hlen);
+    hlen += TCPH_HDRLEN_BYTES(s->tcp);
+    /* frames with ethernet padding are left alone */
+    if (TCPH_HDRLEN_BYTES(s->tcp) < TCP_HLEN || p->len < hlen ||
+        SIZEOF_ETH_HDR + l3_len != p->tot_len || p->tot_len <= hlen)
+        return false;
+    if ((TCPH_FLAGS(s->tcp) & ~TCP_PSH) != TCP_ACK)
+        return false;
+    s->hdr_len = hlen;
+    s->payload_len = p->tot_len - hlen;
+    return true;
+}
+
+/* Segments of the same flow, with the same IP and TCP header fields apart
+   from the sequence number and lengths */
+static boolean vnet_gro_same_flow(vnet_gro_flow f, vnet_tcp_seg s)
+{
+    u8 *l3 = (u8 *)f->p->payload + SIZEOF_ETH_HDR;
+    struct tcp_hdr *tcph = f->tcp;
+    if (f->ipv6 != s->ipv6 || f->hdr_len != s->hdr_len)
+        return false;
+    if (s->ipv6) {
+        struct ip6_hdr *a = (struct ip6_hdr *)l3, *b = (struct ip6_hdr *)s->l3;
+        if (a->_v_tc_fl != b->_v_tc_fl || IP6H_HOPLIM(a) != IP6H_HOPLIM(b) ||
+            runtime_memcmp(&a->src, &b->src, 2 * sizeof(a->src)))
+            return false;
+    } else {
+        struct ip_hdr *a = (struct ip_hdr *)l3, *b = (struct ip_hdr *)s->l3;
+        if (IPH_TOS(a) != IPH_TOS(b) || IPH_TTL(a) != IPH_TTL(b) ||
+            runtime_memcmp(&a->src, &b->src, 2 * sizeof(a->src)))
+            return false;
+    }
+    return tcph->src == s->tcp->src && tcph->dest == s->tcp->dest &&
+        tcph->ackno == s->tcp->ackno && tcph->wnd == s->tcp->wnd &&
+        !runtime_memcmp(tcph + 1, s->tcp + 1, TCPH_HDRLEN_BYTES(s->tcp) - TCP_HLEN);
+}
+
+/* Fix up the IP header of a coalesced frame and pass it on */
+static void vnet_gro_flush(vnet vn, vnet_gro_flow f)
+{
+    struct pbuf *p = f->p;
+    f->p = 0;
+    if (f->segs > 1) {
+        u8 *l3 = (u8 *)p->payload + SIZEOF_ETH_HDR;
+        if (f->ipv6) {
+            IP6H_PLEN_SET((struct ip6_hdr *)l3, p->tot_len - SIZEOF_ETH_HDR - IP6_HLEN);
         } else {
-            err = true;
+            struct ip_hdr *iph = (struct ip_hdr *)l3;
+            IPH_LEN_SET(iph, lwip_htons(p->tot_len - SIZEOF_ETH_HDR));
+            IPH_CHKSUM_SET(iph, 0);
+            IPH_CHKSUM_SET(iph, inet_chksum(iph, IP_HLEN));
         }
+        vn->rx_stats.coalesced += f->segs - 1;
+    }
+    vnet_rx_deliver(vn, p);
+}
+
+static void vnet_gro_flush_all(vnet vn)
+{
+    for (int i = 0; i < VNET_GRO_FLOWS; i++) {
+        if (vn->gro_flows[i].p)
+            vnet_gro_flush(vn, &vn->gro_flows[i]);
     }
-    if (!err)
-        err = (vn->n->input(&x->p.pbuf, vn->n) != ERR_OK);
-    if (err)
-        receive_buffer_release(&x->p.pbuf);
-    // we need to get a signal from the device side that there was
-    // an underrun here to open up the window
-    post_receive(vn);
 }
 
+/* Software receive coalescing: consecutive in-order segments of a TCP flow
+   within a service pass are merged into one pbuf chain, with the headers of
+   the first segment, so that the stack takes them in a single input call.
+   Only frames with checksums validated by the device are coalesced, as the
+   TCP checksum no longer matches the merged payload. */
+static void vnet_gro_receive(vnet vn, struct pbuf *p)
+{
+    struct vnet_tcp_seg s;
+    if (!((xpbuf)p)->csum_valid || !vnet_gro_parse(p, &s)) {
+        /* keep frames in order with the ones held back */
+        vnet_gro_flush_all(vn);
+        vnet_rx_deliver(vn, p);
+        return;
+    }
+    boolean push = (TCPH_FLAGS(s.tcp) & TCP_PSH) != 0;
+    u32 seq = lwip_ntohl(s.tcp->seqno);
+    vnet_gro_flow f = 0;
+    for (int i = 0; i < VNET_GRO_FLOWS; i++) {
+        vnet_gro_flow fl = &vn->gro_flows[i];
+        if (fl->p && vnet_gro_same_flow(fl, &s)) {
+            f = fl;
+            break;
+        }
+    }
+    if (f) {
+        if (seq == f->next_seq && f->p->tot_len + s.payload_len <= VNET_FRAME_MAX) {
+            pbuf_remove_header(p, s.hdr_len);
+            if (p->len == 0) {
+                struct pbuf *q = p->next;
+                p->next = 0;
+                pbuf_free(p);
+                p = q;
+            }
+            pbuf_cat(f->p, p);
+            f->next_seq += s.payload_len;
+            f->segs++;
+            if (push) {
+                TCPH_SET_FLAG(f->tcp, TCP_PSH);
+                vnet_gro_flush(vn, f);
+            }
+            return;
+        }
+        vnet_gro_flush(vn, f);
+    } else if (!push) {
+        for (int i = 0; i < VNET_GRO_FLOWS && !f; i++) {
+            if (!vn->gro_flows[i].p)
+                f = &vn->gro_flows[i];
+        }
+        if (!f) {
+            f = &vn->gro_flows[vn->gro_evict];
+            vn->gro_evict = (vn->gro_evict + 1) % VNET_GRO_FLOWS;
+            vnet_gro_flush(vn, f);
+        }
+    }
+    if (push) {
+        vnet_rx_deliver(vn, p);
+        return;
+    }
+    f->p = p;
+    f->ipv6 = s.ipv6;
+    f->tcp = s.tcp;
+    f->hdr_len = s.hdr_len;
+    f->next_seq = seq + s.payload_len;
+    f->segs = 1;
+}
 
 static void post_receive(vnet vn)
 {
-    xpbuf x = allocate((heap)vn->rxbuffers, sizeof(struct xpbuf) + vn->rxbuflen);
-    assert(x != INVALID_ADDRESS);
-    x->vn = vn;
-    x->p.custom_free_function = receive_buffer_release;
-    pbuf_alloced_custom(PBUF_RAW,
-                        vn->rxbuflen,
-                        PBUF_REF,
-                        &x->p,
-                        x+1,
-                        vn->rxbuflen);
-
     vqmsg m = allocate_vqmsg(vn->rxq);
     assert(m != INVALID_ADDRESS);
-    u64 phys = physical_from_virtual(x + 1);
-    if (vtdev_is_modern(vn->dev) || (vn->dev->features & VIRTIO_F_ANY_LAYOUT)) {
-        vqmsg_push(vn->rxq, m, phys, vn->rxbuflen, true);
-    } else {
-        vqmsg_push(vn->rxq, m, phys, vn->net_header_len, true);
-        vqmsg_push(vn->rxq, m, phys + vn->net_header_len, vn->rxbuflen - vn->net_header_len, true);
+    xpbuf first = 0, last = 0;
+    for (int i = 0; i < vn->rx_msg_bufs; i++) {
+        xpbuf x = allocate((heap)vn->rxbuffers, sizeof(struct xpbuf) + vn->rxbuflen);
+        assert(x != INVALID_ADDRESS);
+        x->vn = vn;
+        x->next_buf = 0;
+        x->p.custom_free_function = receive_buffer_release;
+        pbuf_alloced_custom(PBUF_RAW,
+                            vn->rxbuflen,
+                            PBUF_REF,
+                            &x->p,
+                            x+1,
+                            vn->rxbuflen);
+        u64 phys = physical_from_virtual(x + 1);
+        if (i > 0 || vtdev_is_modern(vn->dev) || (vn->dev->features & VIRTIO_F_ANY_LAYOUT)) {
+            vqmsg_push(vn->rxq, m, phys, vn->rxbuflen, true);
+        } else {
+            vqmsg_push(vn->rxq, m, phys, vn->net_header_len, true);
+            vqmsg_push(vn->rxq, m, phys + vn->net_header_len, vn->rxbuflen - vn->net_header_len, true);
+        }
+        if (last)
+            last->next_buf = x;
+        else
+            first = x;
+        last = x;
     }
-    vqmsg_commit(vn->rxq, m, init_closure(&x->input, vnet_input));
+    vqmsg_queue(vn->rxq, m, init_closure(&first->input, vnet_input));
+}
+
+/* refill the receive ring, notifying the device once for the whole batch */
+static void vnet_rx_refill(vnet vn, u64 count)
+{
+    for (u64 i = 0; i < count; i++)
+        post_receive(vn);
+    virtqueue_kick(vn->rxq);
+}
+
+/* one pass over the receive queue; returns the number of buffers used */
+static u64 vnet_rx_poll(vnet vn)
+{
+    vn->rx_stats.polls++;
+    vn->rx_batch_count = 0;
+    u64 used = virtqueue_service(vn->rxq, VNET_RX_BUDGET);
+    virtio_net_debug("%s: %ld used, %d frames\n", __func__, used, vn->rx_batch_count);
+
+    /* refill before feeding the stack so the device doesn't run dry meanwhile */
+    if (used)
+        vnet_rx_refill(vn, used);
+    for (int i = 0; i < vn->rx_batch_count; i++) {
+        struct pbuf *p = vn->rx_batch[i];
+        if (vn->rx_csum_offload)
+            vnet_gro_receive(vn, p);
+        else
+            vnet_rx_deliver(vn, p);
+    }
+    vnet_gro_flush_all(vn);
+    net_rx_account(&vn->rx_stats);
+    zero(&vn->rx_stats, sizeof(vn->rx_stats));
+    return used;
+}
+
+/* Scheduled on a receive interrupt, with further interrupts suppressed
+   until the used ring has been drained. */
+define_closure_function(0, 0, void, vnet_rx_service)
+{
+    vnet vn = struct_from_field(closure_self(), vnet, rx_service);
+    if (vn->rx_continue)
+        vn->rx_continue = false;
+    else
+        vn->rx_stats.interrupts++;
+    u64 used = vnet_rx_poll(vn);
+    if (used == VNET_RX_BUDGET || !virtqueue_service_done(vn->rxq)) {
+        vn->rx_continue = true;
+        async_apply((thunk)&vn->rx_service);
+    }
+}
+
+/* Busy polling from a thread waiting for input: receive processing is taken
+   over from the interrupt-driven service for the duration, and handed back
+   to it if frames are still pending at the end. */
+define_closure_function(0, 2, boolean, vnet_busy_poll,
+                        timestamp, deadline, busy_poll_cond, cond)
+{
+    vnet vn = struct_from_field(closure_self(), vnet, busy_poll);
+    if (!virtqueue_service_claim(vn->rxq))
+        return false;
+    boolean ready;
+    while (true) {
+        vnet_rx_poll(vn);
+        ready = apply(cond);
+        if (ready || now(CLOCK_ID_MONOTONIC_RAW) >= deadline)
+            break;
+        kern_pause();
+    }
+    if (!virtqueue_service_done(vn->rxq)) {
+        vn->rx_continue = true;
+        async_apply((thunk)&vn->rx_service);
+    }
+    return ready;
 }
 
 define_closure_function(0, 1, u64, vnet_mem_cleaner,
@@ -271,30 +593,36 @@ static err_t virtioif_init(struct netif *netif)
     /* don't set NETIF_FLAG_ETHARP if this device is not an ethernet one */
     netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_LINK_UP | NETIF_FLAG_UP;
 
-    for (int i = 0; i < virtqueue_entries(vn->rxq); i++)
-        post_receive(vn);
-    
+    vnet_rx_refill(vn, virtqueue_entries(vn->rxq) / vn->rx_msg_bufs);
     return ERR_OK;
 }
 
 static void virtio_net_attach(vtdev dev)
 {
-    //u32 badness = VIRTIO_F_BAD_FEATURE | VIRTIO_NET_F_CSUM | VIRTIO_NET_F_GUEST_CSUM |
-    //    VIRTIO_NET_F_GUEST_TSO4 | VIRTIO_NET_F_GUEST_TSO6 |  VIRTIO_NET_F_GUEST_ECN|
-    //    VIRTIO_NET_F_GUEST_UFO | VIRTIO_NET_F_CTRL_VLAN | VIRTIO_NET_F_MQ;
-
     heap h = dev->general;
     backed_heap contiguous = dev->contiguous;
     vnet vn = allocate(h, sizeof(struct vnet));
     assert(vn != INVALID_ADDRESS);
+    zero(vn, sizeof(struct vnet));
     vn->n = allocate(h, sizeof(struct netif));
     assert(vn->n != INVALID_ADDRESS);
     vn->net_header_len = (dev->features & VIRTIO_F_VERSION_1) ||
         (dev->features & VIRTIO_NET_F_MRG_RXBUF) != 0 ?
         sizeof(struct virtio_net_hdr_mrg_rxbuf) : sizeof(struct virtio_net_hdr);
-    vn->rxbuflen = pad(vn->net_header_len + sizeof(struct eth_hdr) + sizeof(struct eth_vlan_hdr) +
-                       1500, 8);    /* padding to make xpbuf structures aligned to 8 bytes */
-    virtio_net_debug("%s: net_header_len %d, rxbuflen %d\n", __func__, vn->net_header_len, vn->rxbuflen);
+    vn->rx_csum_offload = (dev->features & VIRTIO_NET_F_GUEST_CSUM) != 0;
+    if ((dev->features & (VIRTIO_NET_F_GUEST_TSO4 | VIRTIO_NET_F_GUEST_TSO6)) &&
+        !(dev->features & VIRTIO_NET_F_MRG_RXBUF)) {
+        /* Without mergeable buffers, each receive message must be able to
+           hold a whole TSO frame: post chains of page-sized buffers. */
+        vn->rxbuflen = PAGESIZE - sizeof(struct xpbuf);
+        vn->rx_msg_bufs = (vn->net_header_len + VNET_RX_GSO_MAX + vn->rxbuflen - 1) / vn->rxbuflen;
+    } else {
+        vn->rxbuflen = pad(vn->net_header_len + sizeof(struct eth_hdr) + sizeof(struct eth_vlan_hdr) +
+                           1500, 8);    /* padding to make xpbuf structures aligned to 8 bytes */
+        vn->rx_msg_bufs = 1;
+    }
+    virtio_net_debug("%s: net_header_len %d, rxbuflen %d, bufs per message %d\n", __func__,
+                     vn->net_header_len, vn->rxbuflen, vn->rx_msg_bufs);
     vn->rxbuffers = allocate_objcache(h, (heap)contiguous, vn->rxbuflen + sizeof(struct xpbuf),
                                       PAGESIZE_2M, true);
     vn->txhandlers = allocate_objcache(h, (heap)contiguous, sizeof(closure_struct_type(tx_complete)),
@@ -306,6 +634,7 @@ static void virtio_net_attach(vtdev dev)
     virtio_alloc_virtqueue(dev, "virtio net tx", 1, &vn->txq);
     virtqueue_set_polling(vn->txq, true);
     virtio_alloc_virtqueue(dev, "virtio net rx", 0, &vn->rxq);
+    virtqueue_set_service(vn->rxq, init_closure(&vn->rx_service, vnet_rx_service));
     // just need vn->net_header_len contig bytes really
     vn->empty = alloc_map(contiguous, contiguous->h.pagesize, &vn->empty_phys);
     assert(vn->empty != INVALID_ADDRESS);
@@ -318,6 +647,7 @@ static void virtio_net_attach(vtdev dev)
               vn,
               virtioif_init,
               ethernet_input);
+    netif_set_busy_poll(vn->n, init_closure(&vn->busy_poll, vnet_busy_poll));
 }
 
 closure_function(2, 1, boolean, vtpci_net_probe,
@@ -327,7 +657,7 @@ closure_function(2, 1, boolean, vtpci_net_probe,
     if (!vtpci_probe(d, VIRTIO_ID_NETWORK))
         return false;
     vtpci dev = attach_vtpci(bound(general), bound(page_allocator), d,
-        VIRTIO_NET_F_MAC | VIRTIO_F_ANY_LAYOUT | VIRTIO_F_RING_EVENT_IDX);
+        VIRTIO_NET_F_MAC | VIRTIO_F_ANY_LAYOUT | VIRTIO_F_RING_EVENT_IDX | VNET_RX_FEATURES);
     virtio_net_attach(&dev->virtio_dev);
     return true;
 }
@@ -341,7 +671,7 @@ closure_function(2, 1, void, vtmmio_net_probe,
             sizeof(struct virtio_net_config)))
         return;
     if (attach_vtmmio(bound(general), bound(page_allocator), d,
-            VIRTIO_NET_F_MAC))
+            VIRTIO_NET_F_MAC | VNET_RX_FEATURES))
         virtio_net_attach(&d->virtio_dev);
 }
 
@@ -246,10 +246,13 @@ static void vtpci_register_non_msix_config_handler(vtpci dev, thunk handler)
     dev->config_handler = handler;
 }
 
-status vtpci_alloc_virtqueue(vtpci dev,
-                             const char *name,
-                             int idx,
-                             struct virtqueue **result)
+/* With MSI-X, the virtqueue interrupt (and thus completion processing) is
+   steered to target_cpu. */
+status vtpci_alloc_virtqueue_target(vtpci dev,
+                                    const char *name,
+                                    int idx,
+                                    u32 target_cpu,
+                                    struct virtqueue **result)
 {
     // allocate virtqueue
     struct virtqueue *vq;
@@ -270,7 +273,8 @@ status vtpci_alloc_virtqueue(vtpci dev,
     if (dev->msix_enabled) {
         // setup virtqueue MSI-X interrupt
         int msi_slot = idx + 1; /* 0 reserved for config change */
-        if (pci_setup_msix(dev->dev, msi_slot, handler, name) == INVALID_PHYSICAL)
+        if (pci_setup_msix_target(dev->dev, msi_slot, handler, name, target_cpu) ==
+            INVALID_PHYSICAL)
             return timm("status", "failed to allocate MSI-X vector");
         pci_bar_write_2(&dev->common_config, dev->regs[VTPCI_REG_QUEUE_MSIX_VECTOR], msi_slot);
         int check_idx = pci_bar_read_2(&dev->common_config, dev->regs[VTPCI_REG_QUEUE_MSIX_VECTOR]);
@@ -296,6 +300,14 @@ status vtpci_alloc_virtqueue(vtpci dev,
     return STATUS_OK;
 }
 
+status vtpci_alloc_virtqueue(vtpci dev,
+                             const char *name,
+                             int idx,
+                             struct virtqueue **result)
+{
+    return vtpci_alloc_virtqueue_target(dev, name, idx, 0, result);
+}
+
 closure_function(2, 0, void, vtpci_config_change_msix_irq,
                  vtpci, dev, thunk, handler)
 {
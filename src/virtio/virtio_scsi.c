@@ -95,15 +95,38 @@ struct virtio_scsi_resp_cmd {
     u8 sense[VIRTIO_SCSI_SENSE_SIZE];
 } __attribute__((packed));
 
+typedef struct virtio_scsi *virtio_scsi;
+typedef struct virtio_scsi_request *virtio_scsi_request;
+typedef closure_type(vsr_complete, void, virtio_scsi, virtio_scsi_request);
+
+/* Request queues are assigned to cpus round-robin; each queue keeps its own
+   cache of I/O requests, so that submissions from different cpus do not
+   contend on any lock. */
+typedef struct virtio_scsi_queue {
+    virtio_scsi s;
+    struct virtqueue *vq;
+    struct spinlock lock;               // protects free_reqs
+    struct list free_reqs;
+    u32 free_count;
+    u32 max_free;
+} *virtio_scsi_queue;
+
+declare_closure_struct(0, 1, void, virtio_scsi_request_complete,
+                       u64, len);
+
 struct virtio_scsi_request {
     struct virtio_scsi_req_cmd req;
     struct virtio_scsi_resp_cmd resp;
+    closure_struct(virtio_scsi_request_complete, complete);
+    virtio_scsi_queue q;
+    u64 phys;
+    vsr_complete c;                    // command completion, or...
+    status_handler sh;                 // ...block I/O completion
+    struct list l;                     // free list
     u32 alloc_len;                     // allocated data length
     char data[];                       // embedded datain/dataout
 };
 
-typedef struct virtio_scsi_request *virtio_scsi_request;
-
 struct virtio_scsi {
     vtpci v;
 
@@ -112,7 +135,8 @@ struct virtio_scsi {
     struct virtqueue *eventq;
     struct virtio_scsi_event events[VIRTIO_SCSI_NUM_EVENTS];
 
-    struct virtqueue *requestq;
+    struct virtio_scsi_queue *requestqs;
+    u32 num_requestqs;
 
     u32 seg_max;
     u16 max_target;
@@ -123,7 +147,6 @@ struct virtio_scsi {
     struct spinlock lock;
 };
 
-typedef struct virtio_scsi *virtio_scsi;
 typedef struct virtio_scsi_disk *virtio_scsi_disk;
 
 declare_closure_struct(0, 1, void, virtio_scsi_req_handler,
@@ -217,30 +240,79 @@ static void virtio_scsi_enqueue_event(virtio_scsi s, virtio_scsi_event e, vqfini
  * Request queue
  */
 
-typedef closure_type(vsr_complete, void, virtio_scsi, virtio_scsi_request);
+static inline virtio_scsi_queue virtio_scsi_get_queue(virtio_scsi s)
+{
+    return s->requestqs + (current_cpu()->id % s->num_requestqs);
+}
 
-closure_function(4, 1, void, virtio_scsi_request_complete,
-                 vsr_complete, c, virtio_scsi, s, virtio_scsi_request, r, u64, r_phys,
-                 u64, len)
+static void virtio_scsi_free_request(virtio_scsi_request r)
 {
-    virtio_scsi s = bound(s);
-    virtio_scsi_request r = bound(r);
-    apply(bound(c), s, r);
-    backed_heap contiguous = s->v->virtio_dev.contiguous;
-    dealloc_unmap(contiguous, r, bound(r_phys),
-                  sizeof(*r) + r->alloc_len);
-    closure_finish();
+    virtio_scsi_queue q = r->q;
+    if (r->alloc_len == 0) {
+        u64 irqflags = spin_lock_irq(&q->lock);
+        if (q->free_count < q->max_free) {
+            list_insert_after(&q->free_reqs, &r->l);
+            q->free_count++;
+            spin_unlock_irq(&q->lock, irqflags);
+            return;
+        }
+        spin_unlock_irq(&q->lock, irqflags);
+    }
+    dealloc_unmap(q->s->v->virtio_dev.contiguous, r, r->phys, sizeof(*r) + r->alloc_len);
+}
+
+static status virtio_scsi_io_status(virtio_scsi_request r)
+{
+    struct virtio_scsi_resp_cmd *resp = &r->resp;
+    virtio_scsi_debug("%s: response %d, status %d\n", __func__, resp->response,
+                      resp->status);
+
+    if (resp->response != VIRTIO_SCSI_S_OK)
+        return timm("result", "response %d", resp->response);
+    if (resp->status != SCSI_STATUS_OK) {
+        scsi_dump_sense(resp->sense, sizeof(resp->sense));
+        return timm("result", "status %d", resp->status);
+    }
+    return STATUS_OK;
 }
 
-static virtio_scsi_request virtio_scsi_alloc_request(virtio_scsi s, u16 target, u16 lun, u8 cmd,
-                                                     u64 *r_phys)
+define_closure_function(0, 1, void, virtio_scsi_request_complete,
+                        u64, len)
+{
+    virtio_scsi_request r = struct_from_field(closure_self(), virtio_scsi_request, complete);
+    if (r->c)
+        apply(r->c, r->q->s, r);
+    else
+        async_apply_status_handler(r->sh, virtio_scsi_io_status(r));
+    virtio_scsi_free_request(r);
+}
+
+static virtio_scsi_request virtio_scsi_alloc_request(virtio_scsi_queue q, u16 target, u16 lun,
+                                                     u8 cmd)
 {
     int alloc_len = scsi_data_len(cmd);
     virtio_scsi_debug("%s: cmd 0x%x, data len %d\n", __func__, cmd, alloc_len);
 
-    virtio_scsi_request r = alloc_map(s->v->virtio_dev.contiguous,
-        sizeof(*r) + alloc_len, r_phys);
-    assert(r != INVALID_ADDRESS);
+    virtio_scsi_request r = 0;
+    if (alloc_len == 0) {
+        u64 irqflags = spin_lock_irq(&q->lock);
+        struct list *l = list_get_next(&q->free_reqs);
+        if (l) {
+            list_delete(l);
+            q->free_count--;
+            r = struct_from_list(l, virtio_scsi_request, l);
+        }
+        spin_unlock_irq(&q->lock, irqflags);
+    }
+    if (!r) {
+        u64 phys;
+        r = alloc_map(q->s->v->virtio_dev.contiguous, sizeof(*r) + alloc_len, &phys);
+        assert(r != INVALID_ADDRESS);
+        init_closure(&r->complete, virtio_scsi_request_complete);
+        r->q = q;
+        r->phys = phys;
+        r->alloc_len = alloc_len;
+    }
     zero((void *) &r->req, sizeof(r->req));
     r->req.cdb[0] = cmd;
     r->req.lun[0] = 1;
@@ -248,17 +320,20 @@ static virtio_scsi_request virtio_scsi_alloc_request(virtio_scsi s, u16 target,
     r->req.lun[2] = ((lun >> 8) & 0x3f) | 0x40;
     r->req.lun[3] = (lun & 0xff);
     r->req.id = u64_from_pointer(r);
-    r->alloc_len = alloc_len;
+    r->c = 0;
+    r->sh = 0;
 
     return r;
 }
 
-static void virtio_scsi_enqueue_request(virtio_scsi s, virtio_scsi_request r,
-                                        u64 r_phys, void *buf, u64 length, vsr_complete c)
+/* Exactly one of c and sh is set. */
+static void virtio_scsi_enqueue_request(virtio_scsi_request r, void *buf, u64 length,
+                                        vsr_complete c, status_handler sh)
 {
-    vqfinish f = closure(s->v->virtio_dev.general, virtio_scsi_request_complete,
-        c, s, r, r_phys);
-    virtqueue vq = s->requestq;
+    virtqueue vq = r->q->vq;
+    u64 r_phys = r->phys;
+    r->c = c;
+    r->sh = sh;
     vqmsg m = allocate_vqmsg(vq);
     assert(m != INVALID_ADDRESS);
 
@@ -275,61 +350,33 @@ static void virtio_scsi_enqueue_request(virtio_scsi s, virtio_scsi_request r,
             vqmsg_push(vq, m, physical_from_virtual(buf), length, true);    // datain
     }
 
-    vqmsg_commit(vq, m, f);
+    vqmsg_commit(vq, m, (vqfinish)&r->complete);
 }
 
 /*
  * Device driver hooks
- *
- * If we ever really care, the following may be simplified by re-using
- * closures and maintaining a little state machine.
  */
-closure_function(1, 2, void, virtio_scsi_io_done,
-                 status_handler, sh,
-                 virtio_scsi, s, virtio_scsi_request, r)
-{
-    struct virtio_scsi_resp_cmd *resp = &r->resp;
-    virtio_scsi_debug("%s: response %d, status %d\n", __func__, resp->response,
-                      resp->status);
-
-    status st = 0;
-    if (resp->response != VIRTIO_SCSI_S_OK) {
-        st = timm("result", "response %d", resp->response);
-    } else if (resp->status != SCSI_STATUS_OK) {
-        scsi_dump_sense(resp->sense, sizeof(resp->sense));
-        st = timm("result", "status %d", resp->status);
-    }
-    async_apply_status_handler(bound(sh), st);
-    closure_finish();
-}
-
 static void virtio_scsi_io(virtio_scsi_disk d, u8 cmd, void *buf, range blocks,
                            status_handler sh)
 {
-    virtio_scsi s = d->scsi;
-    u64 r_phys;
-    virtio_scsi_request r = virtio_scsi_alloc_request(s, d->target, d->lun, cmd, &r_phys);
+    virtio_scsi_request r = virtio_scsi_alloc_request(virtio_scsi_get_queue(d->scsi), d->target,
+                                                      d->lun, cmd);
     struct scsi_cdb_readwrite_16 *cdb = (struct scsi_cdb_readwrite_16 *) r->req.cdb;
     u32 nblocks = range_span(blocks);
     cdb->addr = htobe64(blocks.start);
     cdb->length = htobe32(nblocks);
     virtio_scsi_debug("%s: cmd %d, blocks %R, addr 0x%016lx, length 0x%08x\n",
         __func__, cmd, blocks, cdb->addr, cdb->length);
-    virtio_scsi_enqueue_request(s, r, r_phys, buf, nblocks * d->block_size,
-                                closure(s->v->virtio_dev.general, virtio_scsi_io_done, sh));
+    virtio_scsi_enqueue_request(r, buf, nblocks * d->block_size, 0, sh);
 }
 
-static void virtio_scsi_io_commit(virtio_scsi s, virtqueue vq, vqmsg msg, boolean write,
-                                  virtio_scsi_request r, u64 r_phys, status_handler completion)
+static void virtio_scsi_io_commit(virtqueue vq, vqmsg msg, boolean write,
+                                  virtio_scsi_request r, status_handler completion)
 {
-    heap h = s->v->virtio_dev.general;
     if (write)
-        vqmsg_push(vq, msg, r_phys + offsetof(virtio_scsi_request, resp), sizeof(r->resp), true);
-    vsr_complete c = closure(h, virtio_scsi_io_done, completion);
-    assert(c != INVALID_ADDRESS);
-    vqfinish f = closure(h, virtio_scsi_request_complete, c, s, r, r_phys);
-    assert(f != INVALID_ADDRESS);
-    vqmsg_commit(vq, msg, f);
+        vqmsg_push(vq, msg, r->phys + offsetof(virtio_scsi_request, resp), sizeof(r->resp), true);
+    r->sh = completion;
+    vqmsg_commit(vq, msg, (vqfinish)&r->complete);
 }
 
 static void virtio_scsi_io_sg(virtio_scsi_disk d, boolean write, sg_list sg, range blocks,
@@ -338,25 +385,25 @@ static void virtio_scsi_io_sg(virtio_scsi_disk d, boolean write, sg_list sg, ran
     virtio_scsi_debug("%s: %c blocks %R, sh %F\n", __func__, write ? 'w' : 'r', blocks, sh);
     virtio_scsi s = d->scsi;
     virtio_scsi_request r = 0;
-    u64 r_phys;
     struct scsi_cdb_readwrite_16 *cdb;
     u32 desc_blocks, req_blocks;
     heap h = s->v->virtio_dev.general;
-    virtqueue vq = s->requestq;
+    virtio_scsi_queue q = virtio_scsi_get_queue(s);
+    virtqueue vq = q->vq;
     vqmsg msg;
     u32 desc_count;
     merge m = 0;
     while (range_span(blocks)) {
         if (!r) {
-            r = virtio_scsi_alloc_request(s, d->target, d->lun,
-                                          write ? SCSI_CMD_WRITE_16 : SCSI_CMD_READ_16, &r_phys);
+            r = virtio_scsi_alloc_request(q, d->target, d->lun,
+                                          write ? SCSI_CMD_WRITE_16 : SCSI_CMD_READ_16);
             cdb = (struct scsi_cdb_readwrite_16 *)r->req.cdb;
             cdb->addr = htobe64(blocks.start);
             msg = allocate_vqmsg(vq);
             assert(msg != INVALID_ADDRESS);
-            vqmsg_push(vq, msg, r_phys + offsetof(virtio_scsi_request, req), sizeof(r->req), false);
+            vqmsg_push(vq, msg, r->phys + offsetof(virtio_scsi_request, req), sizeof(r->req), false);
             if (!write)
-                vqmsg_push(vq, msg, r_phys + offsetof(virtio_scsi_request, resp), sizeof(r->resp),
+                vqmsg_push(vq, msg, r->phys + offsetof(virtio_scsi_request, resp), sizeof(r->resp),
                            true);
             req_blocks = 0;
             desc_count = 0;
@@ -379,14 +426,14 @@ static void virtio_scsi_io_sg(virtio_scsi_disk d, boolean write, sg_list sg, ran
                 m = allocate_merge(h, sh);
                 sh = apply_merge(m);
             }
-            virtio_scsi_io_commit(s, vq, msg, write, r, r_phys, m ? apply_merge(m) : sh);
+            virtio_scsi_io_commit(vq, msg, write, r, m ? apply_merge(m) : sh);
             r = 0;
         }
     }
     if (r) {
         virtio_scsi_debug("  requesting %d blocks\n", req_blocks);
         cdb->length = htobe32(req_blocks);
-        virtio_scsi_io_commit(s, vq, msg, write, r, r_phys, m ? apply_merge(m) : sh);
+        virtio_scsi_io_commit(vq, msg, write, r, m ? apply_merge(m) : sh);
     }
     if (m)
         apply(sh, STATUS_OK);
@@ -394,11 +441,8 @@ static void virtio_scsi_io_sg(virtio_scsi_disk d, boolean write, sg_list sg, ran
 
 static void virtio_scsi_flush(virtio_scsi_disk d, status_handler sh)
 {
-    virtio_scsi s = d->scsi;
-    u64 r_phys;
-    virtio_scsi_request r = virtio_scsi_alloc_request(s, d->target, d->lun,
-                                                      SCSI_CMD_SYNCHRONIZE_CACHE_10,
-                                                      &r_phys);
+    virtio_scsi_request r = virtio_scsi_alloc_request(virtio_scsi_get_queue(d->scsi), d->target,
+                                                      d->lun, SCSI_CMD_SYNCHRONIZE_CACHE_10);
     struct scsi_cdb_synchronize_cache_10 *cdb =
         (struct scsi_cdb_synchronize_cache_10 *) r->req.cdb;
     cdb->byte2 = 0;             /* no IMMED */
@@ -407,8 +451,7 @@ static void virtio_scsi_flush(virtio_scsi_disk d, status_handler sh)
     cdb->length = 0;            /* all logical blocks */
     cdb->control = 0;           /* no ACA */
     virtio_scsi_debug("%s: enqueue request %p\n", __func__, r);
-    virtio_scsi_enqueue_request(s, r, r_phys, 0, 0,
-                                closure(s->v->virtio_dev.general, virtio_scsi_io_done, sh));
+    virtio_scsi_enqueue_request(r, 0, 0, 0, sh);
 }
 
 define_closure_function(0, 1, void, virtio_scsi_req_handler,
@@ -444,6 +487,8 @@ closure_function(3, 0, void, virtio_scsi_init_done,
     spin_unlock(&s->lock);
     apply(bound(a), init_closure(&d->req_handler, virtio_scsi_req_handler), d->capacity,
           bound(attach_id));
+    storage_set_limits((storage_req_handler)&d->req_handler, d->max_xfer_len * d->block_size,
+                       s->seg_max);
     closure_finish();
 }
 
@@ -513,13 +558,13 @@ closure_function(6, 2, void, virtio_scsi_test_unit_ready_done,
     int attach_id = bound(attach_id);
     u32 max_xfer_len = bound(max_xfer_len);
     heap h = s->v->virtio_dev.general;
-    u64 r_phys;
+    virtio_scsi_queue q = virtio_scsi_get_queue(s);
     if (resp->status != SCSI_STATUS_OK) {
         if (retry_count < 3) {
-            r = virtio_scsi_alloc_request(s, target, lun, SCSI_CMD_TEST_UNIT_READY, &r_phys);
-            virtio_scsi_enqueue_request(s, r, r_phys, r->data, r->alloc_len,
+            r = virtio_scsi_alloc_request(q, target, lun, SCSI_CMD_TEST_UNIT_READY);
+            virtio_scsi_enqueue_request(r, r->data, r->alloc_len,
                                         closure(h, virtio_scsi_test_unit_ready_done, a, target, lun,
-                                                attach_id, max_xfer_len, retry_count + 1));
+                                                attach_id, max_xfer_len, retry_count + 1), 0);
         } else {
             scsi_dump_sense(resp->sense, sizeof(resp->sense));
         }
@@ -527,13 +572,13 @@ closure_function(6, 2, void, virtio_scsi_test_unit_ready_done,
     }
 
     // read capacity
-    r = virtio_scsi_alloc_request(s, target, lun, SCSI_CMD_SERVICE_ACTION, &r_phys);
+    r = virtio_scsi_alloc_request(q, target, lun, SCSI_CMD_SERVICE_ACTION);
     struct scsi_cdb_read_capacity_16 *cdb = (struct scsi_cdb_read_capacity_16 *) r->req.cdb;
     cdb->service_action = SRC16_SERVICE_ACTION;
     cdb->alloc_len = htobe32(r->alloc_len);
-    virtio_scsi_enqueue_request(s, r, r_phys, r->data, r->alloc_len,
+    virtio_scsi_enqueue_request(r, r->data, r->alloc_len,
                                 closure(h, virtio_scsi_read_capacity_done, a, target, lun,
-                                        attach_id, max_xfer_len));
+                                        attach_id, max_xfer_len), 0);
   out:
     closure_finish();
 }
@@ -592,12 +637,12 @@ closure_function(6, 2, void, virtio_scsi_inquiry_done,
 
     if (fetch_and_add(&bound(resp_count), 1) == 1) {
         // test unit ready
-        u64 r_phys;
-        r = virtio_scsi_alloc_request(s, target, lun, SCSI_CMD_TEST_UNIT_READY, &r_phys);
-        virtio_scsi_enqueue_request(s, r, r_phys, r->data, r->alloc_len,
+        r = virtio_scsi_alloc_request(virtio_scsi_get_queue(s), target, lun,
+                                      SCSI_CMD_TEST_UNIT_READY);
+        virtio_scsi_enqueue_request(r, r->data, r->alloc_len,
                                     closure(s->v->virtio_dev.general,
                                             virtio_scsi_test_unit_ready_done, bound(a), target, lun,
-                                            bound(attach_id), bound(max_xfer_len), 0));
+                                            bound(attach_id), bound(max_xfer_len), 0), 0);
         closure_finish();
     }
 }
@@ -605,14 +650,13 @@ closure_function(6, 2, void, virtio_scsi_inquiry_done,
 static void virtio_scsi_inquiry_vpd(virtio_scsi s, u16 target, u16 lun, u8 page_code,
                                     vsr_complete c)
 {
-    u64 r_phys;
-    virtio_scsi_request r = virtio_scsi_alloc_request(s, target, lun, SCSI_CMD_INQUIRY,
-        &r_phys);
+    virtio_scsi_request r = virtio_scsi_alloc_request(virtio_scsi_get_queue(s), target, lun,
+                                                      SCSI_CMD_INQUIRY);
     struct scsi_cdb_inquiry *cdb = (struct scsi_cdb_inquiry *) r->req.cdb;
     cdb->byte2 = SI_EVPD;
     cdb->page_code = page_code;
     cdb->length = htobe16(r->alloc_len);
-    virtio_scsi_enqueue_request(s, r, r_phys, r->data, r->alloc_len, c);
+    virtio_scsi_enqueue_request(r, r->data, r->alloc_len, c, 0);
 }
 
 static void send_lun_inquiry(virtio_scsi s, u16 target, u16 lun)
@@ -655,13 +699,13 @@ closure_function(2, 2, void, virtio_scsi_report_luns_done,
 
 static void virtio_scsi_report_luns(virtio_scsi s, storage_attach a, u16 target)
 {
-    u64 r_phys;
-    virtio_scsi_request r = virtio_scsi_alloc_request(s, target, 0, SCSI_CMD_REPORT_LUNS, &r_phys);
+    virtio_scsi_request r = virtio_scsi_alloc_request(virtio_scsi_get_queue(s), target, 0,
+                                                      SCSI_CMD_REPORT_LUNS);
     struct scsi_cdb_report_luns *cdb = (struct scsi_cdb_report_luns *) r->req.cdb;
     cdb->select_report = RPL_REPORT_DEFAULT;
     cdb->length = htobe32(r->alloc_len);
-    virtio_scsi_enqueue_request(s, r, r_phys, r->data, r->alloc_len,
-        closure(s->v->virtio_dev.general, virtio_scsi_report_luns_done, a, target));
+    virtio_scsi_enqueue_request(r, r->data, r->alloc_len,
+        closure(s->v->virtio_dev.general, virtio_scsi_report_luns_done, a, target), 0);
 }
 
 static void virtio_scsi_attach(heap general, storage_attach a, backed_heap page_allocator,
@@ -671,10 +715,10 @@ static void virtio_scsi_attach(heap general, storage_attach a, backed_heap page_
     assert(s != INVALID_ADDRESS);
     s->v = attach_vtpci(general, page_allocator, _dev, VIRTIO_SCSI_F_HOTPLUG);
 
-#ifdef VIRTIO_SCSI_DEBUG
     u32 num_queues = pci_bar_read_4(&s->v->device_config, VIRTIO_SCSI_R_NUM_QUEUES);
     virtio_scsi_debug("num queues %d\n", num_queues);
 
+#ifdef VIRTIO_SCSI_DEBUG
     u32 max_sectors = pci_bar_read_4(&s->v->device_config, VIRTIO_SCSI_R_MAX_SECTORS);
     virtio_scsi_debug("max sectors %d\n", max_sectors);
 
@@ -705,8 +749,28 @@ static void virtio_scsi_attach(heap general, storage_attach a, backed_heap page_
     assert(st == STATUS_OK);
     st = vtpci_alloc_virtqueue(s->v, "virtio scsi event", 1, &s->eventq);
     assert(st == STATUS_OK);
-    st = vtpci_alloc_virtqueue(s->v, "virtio scsi request", 2, &s->requestq);
-    assert(st == STATUS_OK);
+
+    /* One request queue per cpu, as far as the device and its MSI-X vectors
+       (one for config changes, one for each virtqueue) allow. */
+    u32 nqueues = MIN(num_queues, total_processors);
+    if (s->v->msix_enabled) {
+        int vectors = pci_get_msix_count(s->v->dev);
+        nqueues = MIN(nqueues, MAX(vectors - 3, 1));
+    }
+    s->num_requestqs = MAX(nqueues, 1);
+    s->requestqs = allocate(general, s->num_requestqs * sizeof(struct virtio_scsi_queue));
+    assert(s->requestqs != INVALID_ADDRESS);
+    for (u32 i = 0; i < s->num_requestqs; i++) {
+        virtio_scsi_queue q = s->requestqs + i;
+        q->s = s;
+        st = vtpci_alloc_virtqueue_target(s->v, "virtio scsi request", 2 + i, i, &q->vq);
+        assert(st == STATUS_OK);
+        spin_lock_init(&q->lock);
+        list_init(&q->free_reqs);
+        q->free_count = 0;
+        q->max_free = virtqueue_entries(q->vq);
+    }
+    virtio_scsi_debug("%d request queues\n", s->num_requestqs);
 
     // On reset, the device MUST set sense_size to 96 and cdb_size to 32
     pci_bar_write_4(&s->v->device_config, VIRTIO_SCSI_R_SENSE_SIZE, VIRTIO_SCSI_SENSE_SIZE);
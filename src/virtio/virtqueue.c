@@ -99,6 +99,8 @@ typedef struct virtqueue {
     u16 *used_event;
     boolean polling;
     boolean events_enabled;
+    boolean service_scheduled;  /* driver-serviced queues only */
+    thunk service;
     u64 free_cnt;               /* atomic */
     u16 desc_idx;               /* head of descriptor free list */
     u16 last_used_idx;          /* irq only */
@@ -153,6 +155,8 @@ void vqmsg_push(virtqueue vq, vqmsg m, u64 phys_addr, u32 len, boolean write)
 }
 
 static void virtqueue_fill(virtqueue vq);
+static void vq_enable_events(virtqueue vq);
+static void vq_disable_events(virtqueue vq);
 
 void vqmsg_commit(virtqueue vq, vqmsg m, vqfinish completion)
 {
@@ -165,39 +169,65 @@ void vqmsg_commit(virtqueue vq, vqmsg m, vqfinish completion)
     spin_unlock_irq(&vq->lock, irqflags);
 }
 
+/* Queue a message without placing it on the ring; a batch of queued
+   messages is made available to the device, with at most one
+   notification, by virtqueue_kick(). */
+void vqmsg_queue(virtqueue vq, vqmsg m, vqfinish completion)
+{
+    m->completion = completion;
+    u64 irqflags = spin_lock_irq(&vq->lock);
+    list_push_back(&vq->msg_queue, &m->l);
+    spin_unlock_irq(&vq->lock, irqflags);
+}
+
+void virtqueue_kick(virtqueue vq)
+{
+    u64 irqflags = spin_lock_irq(&vq->lock);
+    virtqueue_fill(vq);
+    spin_unlock_irq(&vq->lock, irqflags);
+}
+
+/* Take the next used message off the ring and return its descriptors to
+   the free list; called with lock held. The message itself goes back on
+   the free list, so the caller must pick up completion and len first. */
+static vqmsg vq_reclaim_used(virtqueue vq)
+{
+    volatile struct vring_used_elem *uep = vq->used->ring + (vq->last_used_idx & (vq->entries - 1));
+    virtqueue_debug_verbose("%s: vq %s: last_used_idx %d, id %d, len %d\n",
+        __func__, vq->name, vq->last_used_idx, uep->id, uep->len);
+    u16 head = uep->id;
+    vqmsg m = vq->msgs[head];
+
+    /* return descriptor(s) to free list */
+    int dcount = 1;
+    volatile struct vring_desc *d = vq->desc + head;
+    while ((d->flags & VRING_DESC_F_NEXT)) {
+        d = vq->desc + d->next;
+        dcount++;
+    }
+    assert(dcount == m->count);
+    d->next = vq->desc_idx;
+    vq->desc_idx = head;
+
+    vq->last_used_idx++;
+    fetch_and_add(&vq->free_cnt, m->count);
+    m->len = uep->len;
+    vq->msgs[head] = 0;
+    virtqueue_debug("add msg %p\n", m);
+
+    /* TODO should probably observe a limit / drain method here */
+    list_insert_after(&vq->free_msgs, &m->l);
+    return m;
+}
+
 static void vq_poll(virtqueue vq)
 {
     // ensure we see up-to-date used->idx (updated by host)
     memory_barrier();
     
     while (vq->last_used_idx != vq->used->idx) {
-        volatile struct vring_used_elem *uep = vq->used->ring + (vq->last_used_idx & (vq->entries - 1));
-        virtqueue_debug_verbose("%s: vq %s: last_used_idx %d, id %d, len %d\n",
-            __func__, vq->name, vq->last_used_idx, uep->id, uep->len);
-        u16 head = uep->id;
-        vqmsg m = vq->msgs[head];
-
-        /* return descriptor(s) to free list */
-        int dcount = 1;
-        volatile struct vring_desc *d = vq->desc + head;
-        while ((d->flags & VRING_DESC_F_NEXT)) {
-            d = vq->desc + d->next;
-            dcount++;
-        }
-        assert(dcount == m->count);
-        d->next = vq->desc_idx;
-        vq->desc_idx = head;
-
-        vq->last_used_idx++;
-        fetch_and_add(&vq->free_cnt, m->count);
-        m->len = uep->len;
-        vq->msgs[head] = 0;
-        virtqueue_debug("add msg %p\n", m);
-
+        vqmsg m = vq_reclaim_used(vq);
         async_apply_1(m->completion, (void*)m->len);
-
-        /* TODO should probably observe a limit / drain method here */
-        list_insert_after(&vq->free_msgs, &m->l);
     }
 }
 
@@ -209,6 +239,17 @@ closure_function(1, 0, void, vq_interrupt,
         __func__, vq->name, vq->entries, vq->last_used_idx, vq->used->idx, vq->desc_idx);
 
     spin_lock(&vq->lock);
+    if (vq->service) {
+        /* The driver polls the queue from its service routine; keep the
+           device quiet until it has caught up. */
+        vq_disable_events(vq);
+        boolean schedule = !vq->service_scheduled;
+        vq->service_scheduled = true;
+        spin_unlock(&vq->lock);
+        if (schedule)
+            async_apply_bh(vq->service);
+        return;
+    }
   poll:
     vq_poll(vq);
     if (!vq->polling && (vq->dev->features & VIRTIO_F_RING_EVENT_IDX) &&
@@ -254,7 +295,7 @@ status virtqueue_alloc(vtdev dev,
     vq->free_cnt = size;
     list_init(&vq->msg_queue);
     list_init(&vq->free_msgs);
-    spin_lock_init(&vq->lock);
+    spin_lock_init_class(&vq->lock, "virtqueue");
 
     if ((vq->ring_mem = allocate_zero(&dev->contiguous->h, alloc)) == INVALID_ADDRESS) {
         deallocate(dev->general, vq, vq_alloc_size);
@@ -328,6 +369,72 @@ void virtqueue_set_polling(virtqueue vq, boolean enable)
     vq->polling = enable;
 }
 
+/* Let the driver consume completions in batches (NAPI style): on an
+   interrupt, events are disabled and the service thunk is scheduled once.
+   The service routine calls virtqueue_service() until it runs short of
+   its budget and then virtqueue_service_done() to re-arm the queue. */
+void virtqueue_set_service(virtqueue vq, thunk service)
+{
+    vq->service = service;
+}
+
+u64 virtqueue_service(virtqueue vq, u64 budget)
+{
+    struct {
+        vqfinish completion;
+        u64 len;
+    } done[VIRTQUEUE_SERVICE_MAX];
+    u64 n = 0;
+    budget = MIN(budget, VIRTQUEUE_SERVICE_MAX);
+    u64 irqflags = spin_lock_irq(&vq->lock);
+    memory_barrier();
+    while (n < budget && vq->last_used_idx != vq->used->idx) {
+        vqmsg m = vq_reclaim_used(vq);
+        done[n].completion = m->completion;
+        done[n].len = m->len;
+        n++;
+    }
+    spin_unlock_irq(&vq->lock, irqflags);
+    for (u64 i = 0; i < n; i++)
+        apply(done[i].completion, done[i].len);
+    return n;
+}
+
+/* Returns true if the queue is armed again; false if more used entries
+   arrived in the meantime and the caller should keep servicing. */
+boolean virtqueue_service_done(virtqueue vq)
+{
+    boolean armed;
+    u64 irqflags = spin_lock_irq(&vq->lock);
+    vq_enable_events(vq);
+    memory_barrier();
+    if (vq->last_used_idx != vq->used->idx) {
+        vq_disable_events(vq);
+        armed = false;
+    } else {
+        vq->service_scheduled = false;
+        armed = true;
+    }
+    spin_unlock_irq(&vq->lock, irqflags);
+    return armed;
+}
+
+/* Take over servicing the queue outside of the service routine, e.g. from a
+   busy-polling thread. Fails if a service pass is already pending or in
+   progress; otherwise events are disabled as on an interrupt, and the caller
+   must finish with virtqueue_service_done(). */
+boolean virtqueue_service_claim(virtqueue vq)
+{
+    u64 irqflags = spin_lock_irq(&vq->lock);
+    boolean claimed = !vq->service_scheduled;
+    if (claimed) {
+        vq->service_scheduled = true;
+        vq_disable_events(vq);
+    }
+    spin_unlock_irq(&vq->lock, irqflags);
+    return claimed;
+}
+
 static int virtqueue_notify(virtqueue vq, u16 added)
 {
     // ensure used->flags update is visible to us
@@ -91,11 +91,13 @@ void lapic_eoi(void)
     write_barrier();
 }
 
-void msi_format(u32 *address, u32 *data, int vector)
+void msi_format(u32 *address, u32 *data, int vector, u32 target_cpu)
 {
     u32 dm = 0;             // destination mode: ignored if rh == 0
     u32 rh = 0;             // redirection hint: 0 - disabled
-    u32 destination = 0;    // destination APIC
+    u32 destination = apicid_from_cpuid(target_cpu);    // destination APIC
+    if (destination > 0xff) // not addressable without interrupt remapping
+        destination = 0;
     *address = (0xfeeu << 20) | (destination << 12) | (rh << 3) | (dm << 2);
 
     u32 mode = 0;           // delivery mode: 000 fixed, 001 lowest, 010 smi, 100 nmi, 101 init, 111 extint
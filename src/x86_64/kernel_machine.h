@@ -213,11 +213,6 @@ extern void write_xmsr(u64, u64);
 /* CPUID level 7 (EBX) */
 #define CPUID_FSGSBASE  (1 << 0)
 
-static inline void cpuid(u32 fn, u32 ecx, u32 * v)
-{
-    asm volatile("cpuid" : "=a" (v[0]), "=b" (v[1]), "=c" (v[2]), "=d" (v[3]) : "0" (fn), "2" (ecx));
-}
-
 static inline void xsetbv(u32 ecx, u32 eax, u32 edx)
 {
     asm volatile("xsetbv" : : "a" (eax), "d" (edx), "c" (ecx));
@@ -309,6 +304,9 @@ struct cpuinfo_machine {
     /* Monotonic clock timestamp when the lapic timer is supposed to fire; used to re-arm the timer
      * when it fires too early (based on what the monotonic clock source says). */
     timestamp lapic_timer_expiry;
+
+    /* Per-cpu state of the hypervisor interface in use, set up by the cpu itself */
+    void *hypervisor_data;
 };
 
 typedef struct cpuinfo *cpuinfo;
@@ -382,6 +380,11 @@ static inline u64 frame_fault_pc(context_frame f)
     return f[FRAME_RIP];
 }
 
+static inline u64 *frame_get_fp(context_frame f)
+{
+    return pointer_from_u64(f[FRAME_RBP]);
+}
+
 static inline u64 frame_fault_address(context_frame f)
 {
     return f[FRAME_CR2];
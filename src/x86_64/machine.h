@@ -134,6 +134,11 @@ static inline __attribute__((always_inline)) void kern_pause(void)
     asm volatile("pause");
 }
 
+static inline void cpuid(u32 fn, u32 ecx, u32 * v)
+{
+    asm volatile("cpuid" : "=a" (v[0]), "=b" (v[1]), "=c" (v[2]), "=d" (v[3]) : "0" (fn), "2" (ecx));
+}
+
 struct arch_vdso_dat {
     u8 platform_has_rdtscp;
 };
@@ -0,0 +1,51 @@
+/* Fast string operations for runtime memops, selected once by init_memops().
+   The kernel runs without SSE/AVX state, so bulk copies and fills rely on
+   rep movsb / rep stosb, which are the fastest non-vector forms when the cpu
+   has enhanced rep movsb/stosb (ERMS). Below ARCH_MEMOPS_REP_MIN bytes their
+   startup cost outweighs the word loops, unless the cpu also has fast short
+   rep movsb (FSRM). */
+#ifndef BOOT
+#define ARCH_MEMOPS
+
+#define ARCH_MEMOPS_ERMS    (1 << 0)
+#define ARCH_MEMOPS_FSRM    (1 << 1)
+
+#define ARCH_MEMOPS_REP_MIN 256
+
+/* CPUID level 7 */
+#define CPUID_ERMS  (1 << 9)    /* EBX */
+#define CPUID_FSRM  (1 << 4)    /* EDX */
+
+static inline u32 arch_memops_features(void)
+{
+    u32 v[4];
+    cpuid(0, 0, v);
+    if (v[0] < 7)
+        return 0;
+    cpuid(7, 0, v);
+    u32 features = 0;
+    if (v[1] & CPUID_ERMS)
+        features |= ARCH_MEMOPS_ERMS;
+    if (v[3] & CPUID_FSRM)
+        features |= ARCH_MEMOPS_FSRM;
+    return features;
+}
+
+/* Forward copy; returns false if the copy is left to the generic code. */
+static inline boolean arch_memcpy(void *dst, const void *src, bytes len, u32 features)
+{
+    if (!(features & ARCH_MEMOPS_ERMS) ||
+        ((len < ARCH_MEMOPS_REP_MIN) && !(features & ARCH_MEMOPS_FSRM)))
+        return false;
+    asm volatile("rep movsb" : "+D" (dst), "+S" (src), "+c" (len) : : "memory");
+    return true;
+}
+
+static inline boolean arch_memset(void *dst, u8 c, bytes len, u32 features)
+{
+    if (!(features & ARCH_MEMOPS_ERMS) || (len < ARCH_MEMOPS_REP_MIN))
+        return false;
+    asm volatile("rep stosb" : "+D" (dst), "+c" (len) : "a" (c) : "memory");
+    return true;
+}
+#endif
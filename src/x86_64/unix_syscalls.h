@@ -334,5 +334,6 @@
 #define SYS_io_uring_enter			426
 #define SYS_io_uring_register			427
 #define SYS_clone3				435
+#define SYS_futex_waitv				449
 
-#define SYS_MAX 436
+#define SYS_MAX 450
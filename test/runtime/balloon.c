@@ -0,0 +1,80 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* Free page reporting check: touches a large anonymous mapping, so that the
+   host has to back it, then unmaps it and idles while the balloon driver
+   reports the freed memory, and finally checks that the memory can be used
+   again. Run with ENABLE_BALLOON=1.
+
+   The release of host memory is not checked by the program itself, as the
+   guest cannot see it. To measure it, sample the RSS of the qemu process
+   (e.g. ps -o rss= -p <qemu pid>) when "touched" is printed and again at the
+   end of the idle period: it should have dropped by about the size touched,
+   at a rate of up to balloon_report_limit MB per balloon_report_interval. */
+
+#define DEFAULT_SIZE_MB 512
+#define DEFAULT_SECONDS 30
+
+#define test_assert(expr) do { \
+    if (!(expr)) { \
+        printf("Error: %s -- failed at %s:%d\n", #expr, __FILE__, __LINE__); \
+        exit(EXIT_FAILURE); \
+    } \
+} while (0)
+
+static void usage(const char *prog)
+{
+    printf("usage: %s [-s MB to touch] [-d seconds to idle]\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    long size = DEFAULT_SIZE_MB * 1024l * 1024;
+    int seconds = DEFAULT_SECONDS;
+    int c;
+
+    while ((c = getopt(argc, argv, "s:d:")) != EOF) {
+        switch (c) {
+        case 's':
+            size = atol(optarg) * 1024 * 1024;
+            break;
+        case 'd':
+            seconds = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (size < 1 || seconds < 0)
+        usage(argv[0]);
+
+    unsigned char *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                            -1, 0);
+    test_assert(p != MAP_FAILED);
+    long pagesize = sysconf(_SC_PAGESIZE);
+    for (long i = 0; i < size; i += pagesize)
+        p[i] = 0xa5;
+    for (long i = 0; i < size; i += pagesize)
+        test_assert(p[i] == 0xa5);
+    printf("balloon: touched %ld MB\n", size / (1024 * 1024));
+    test_assert(munmap(p, size) == 0);
+    printf("balloon: unmapped, idling for %d s\n", seconds);
+    for (int i = 0; i < seconds; i++)
+        sleep(1);
+
+    /* reported memory must be usable again without any deflate */
+    p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    test_assert(p != MAP_FAILED);
+    for (long i = 0; i < size; i += pagesize) {
+        test_assert(p[i] == 0);
+        p[i] = 0x5a;
+    }
+    test_assert(munmap(p, size) == 0);
+    printf("balloon OK\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,177 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Block device IOPS scaling benchmark: each thread is pinned to a cpu and
+   does random block-sized writes to its own file, each followed by
+   fdatasync, so that every operation goes to the device. The run is repeated
+   with 1, 2, 4... threads up to the number of cpus; with a multi-queue
+   storage driver the IOPS should scale with the number of submitting cpus
+   until the device saturates. */
+
+#define MAX_THREADS     16
+#define BENCH_DIR       "/blkiops"
+
+#define BLOCK_SIZE      4096
+#define DEFAULT_FILE_MB 16
+#define DEFAULT_SECONDS 2
+
+#define test_assert(expr) do { \
+    if (!(expr)) { \
+        printf("Error: %s -- failed at %s:%d\n", #expr, __FILE__, __LINE__); \
+        exit(EXIT_FAILURE); \
+    } \
+} while (0)
+
+static int ncpus;
+static long file_size = DEFAULT_FILE_MB * 1024 * 1024;
+static int seconds = DEFAULT_SECONDS;
+
+static pthread_barrier_t barrier;
+static volatile int stop;
+static long ops[MAX_THREADS];
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void *bench_thread(void *arg)
+{
+    int id = (long)arg;
+    char path[64];
+    uint8_t *buf = malloc(BLOCK_SIZE);
+    test_assert(buf);
+    unsigned int seed = id + 1;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(id % ncpus, &set);
+    test_assert(sched_setaffinity(0, sizeof(set), &set) == 0);
+
+    snprintf(path, sizeof(path), BENCH_DIR "/t%d", id);
+    int fd = open(path, O_RDWR);
+    test_assert(fd >= 0);
+    long nblocks = file_size / BLOCK_SIZE;
+    long n = 0;
+    pthread_barrier_wait(&barrier);
+    while (!stop) {
+        long block = rand_r(&seed) % nblocks;
+        memset(buf, n & 0xff, BLOCK_SIZE);
+        test_assert(pwrite(fd, buf, BLOCK_SIZE, block * BLOCK_SIZE) == BLOCK_SIZE);
+        test_assert(fdatasync(fd) == 0);
+        n++;
+    }
+    ops[id] = n;
+    test_assert(close(fd) == 0);
+    free(buf);
+    return NULL;
+}
+
+/* Returns the aggregate IOPS with the given number of threads. */
+static double run(int nthreads)
+{
+    pthread_t threads[MAX_THREADS];
+    stop = 0;
+    test_assert(pthread_barrier_init(&barrier, NULL, nthreads + 1) == 0);
+    for (long i = 0; i < nthreads; i++)
+        test_assert(pthread_create(&threads[i], NULL, bench_thread, (void *)i) == 0);
+    pthread_barrier_wait(&barrier);
+    uint64_t start = now_ns();
+    sleep(seconds);
+    stop = 1;
+    long total = 0;
+    for (int i = 0; i < nthreads; i++) {
+        test_assert(pthread_join(threads[i], NULL) == 0);
+        test_assert(ops[i] > 0);
+        total += ops[i];
+    }
+    double secs = (now_ns() - start) / 1e9;
+    pthread_barrier_destroy(&barrier);
+    return total / secs;
+}
+
+static void usage(const char *prog)
+{
+    printf("usage: %s [-t max threads] [-s file MB per thread] [-d seconds per run]\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    int c;
+
+    ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = ncpus;
+    while ((c = getopt(argc, argv, "t:s:d:")) != EOF) {
+        switch (c) {
+        case 't':
+            max_threads = atoi(optarg);
+            break;
+        case 's':
+            file_size = atol(optarg) * 1024 * 1024;
+            break;
+        case 'd':
+            seconds = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (max_threads < 1)
+        max_threads = 1;
+    else if (max_threads > MAX_THREADS)
+        max_threads = MAX_THREADS;
+    if (file_size < BLOCK_SIZE || seconds < 1)
+        usage(argv[0]);
+
+    printf("blkiops: %d cpus, %ld MB file per thread, %d s per run\n", ncpus,
+           file_size / (1024 * 1024), seconds);
+    test_assert(mkdir(BENCH_DIR, 0755) == 0 || errno == EEXIST);
+    uint8_t *buf = calloc(1, BLOCK_SIZE);
+    test_assert(buf);
+    for (int i = 0; i < max_threads; i++) {
+        char path[64];
+        snprintf(path, sizeof(path), BENCH_DIR "/t%d", i);
+        int fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+        test_assert(fd >= 0);
+        for (long offset = 0; offset < file_size; offset += BLOCK_SIZE)
+            test_assert(write(fd, buf, BLOCK_SIZE) == BLOCK_SIZE);
+        test_assert(fsync(fd) == 0);
+        test_assert(close(fd) == 0);
+    }
+    free(buf);
+
+    double base = 0;
+    for (int nthreads = 1; ; nthreads *= 2) {
+        if (nthreads > max_threads)
+            nthreads = max_threads;
+        double iops = run(nthreads);
+        if (!base)
+            base = iops;
+        printf("%2d threads %10.0f IOPS (%.2fx)\n", nthreads, iops, iops / base);
+        if (nthreads == max_threads)
+            break;
+    }
+
+    for (int i = 0; i < max_threads; i++) {
+        char path[64];
+        snprintf(path, sizeof(path), BENCH_DIR "/t%d", i);
+        test_assert(unlink(path) == 0);
+    }
+    test_assert(rmdir(BENCH_DIR) == 0);
+    printf("blkiops OK\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,221 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Multi-threaded filesystem benchmark: each thread works in its own directory
+   and on its own files, so that the phases measure how well operations on
+   unrelated files and directories scale across cpus. */
+
+#define MAX_THREADS     16
+#define BENCH_DIR       "/fsbench"
+
+#define DEFAULT_FILES       256
+#define DEFAULT_WRITE_SIZE  (8 * 1024 * 1024)
+#define DEFAULT_FSYNCS      64
+#define WRITE_CHUNK         (64 * 1024)
+#define FSYNC_CHUNK         4096
+
+#define test_assert(expr) do { \
+    if (!(expr)) { \
+        printf("Error: %s -- failed at %s:%d\n", #expr, __FILE__, __LINE__); \
+        exit(EXIT_FAILURE); \
+    } \
+} while (0)
+
+enum phase {
+    PHASE_CREATE,
+    PHASE_WRITE,
+    PHASE_FSYNC,
+    PHASE_VERIFY,
+    PHASE_UNLINK,
+    PHASE_COUNT
+};
+
+static const char *phase_names[PHASE_COUNT] = {
+    "create", "write", "fsync", "verify", "unlink"
+};
+
+static int nthreads;
+static int nfiles = DEFAULT_FILES;
+static long write_size = DEFAULT_WRITE_SIZE;
+static int nfsyncs = DEFAULT_FSYNCS;
+
+static pthread_barrier_t barrier;
+static struct timespec phase_start[PHASE_COUNT], phase_end[PHASE_COUNT];
+
+static double elapsed(enum phase p)
+{
+    return (phase_end[p].tv_sec - phase_start[p].tv_sec) +
+        (phase_end[p].tv_nsec - phase_start[p].tv_nsec) / 1e9;
+}
+
+/* All threads start a phase together; the first one through the barrier
+   records the time. */
+static void phase_begin(enum phase p)
+{
+    if (pthread_barrier_wait(&barrier) == PTHREAD_BARRIER_SERIAL_THREAD)
+        clock_gettime(CLOCK_MONOTONIC, &phase_start[p]);
+    pthread_barrier_wait(&barrier);
+}
+
+static void phase_done(enum phase p)
+{
+    if (pthread_barrier_wait(&barrier) == PTHREAD_BARRIER_SERIAL_THREAD)
+        clock_gettime(CLOCK_MONOTONIC, &phase_end[p]);
+}
+
+static void fill_pattern(uint8_t *buf, size_t len, int id, long offset)
+{
+    uint64_t *p = (uint64_t *)buf;
+    for (size_t i = 0; i < len / sizeof(uint64_t); i++)
+        p[i] = ((uint64_t)id << 48) | (offset + i * sizeof(uint64_t));
+}
+
+static void *bench_thread(void *arg)
+{
+    int id = (long)arg;
+    char path[64];
+    uint8_t *buf = malloc(WRITE_CHUNK);
+    uint8_t *check = malloc(WRITE_CHUNK);
+    test_assert(buf && check);
+
+    snprintf(path, sizeof(path), BENCH_DIR "/t%d", id);
+    test_assert(mkdir(path, 0755) == 0);
+
+    phase_begin(PHASE_CREATE);
+    for (int i = 0; i < nfiles; i++) {
+        snprintf(path, sizeof(path), BENCH_DIR "/t%d/f%d", id, i);
+        int fd = open(path, O_CREAT | O_EXCL | O_WRONLY, 0644);
+        test_assert(fd >= 0);
+        test_assert(close(fd) == 0);
+    }
+    phase_done(PHASE_CREATE);
+
+    snprintf(path, sizeof(path), BENCH_DIR "/t%d/data", id);
+    int fd = open(path, O_CREAT | O_RDWR, 0644);
+    test_assert(fd >= 0);
+    phase_begin(PHASE_WRITE);
+    for (long offset = 0; offset < write_size; offset += WRITE_CHUNK) {
+        fill_pattern(buf, WRITE_CHUNK, id, offset);
+        test_assert(write(fd, buf, WRITE_CHUNK) == WRITE_CHUNK);
+    }
+    test_assert(fdatasync(fd) == 0);
+    phase_done(PHASE_WRITE);
+
+    snprintf(path, sizeof(path), BENCH_DIR "/t%d/sync", id);
+    int sfd = open(path, O_CREAT | O_WRONLY, 0644);
+    test_assert(sfd >= 0);
+    phase_begin(PHASE_FSYNC);
+    for (int i = 0; i < nfsyncs; i++) {
+        fill_pattern(buf, FSYNC_CHUNK, id, (long)i * FSYNC_CHUNK);
+        test_assert(write(sfd, buf, FSYNC_CHUNK) == FSYNC_CHUNK);
+        test_assert(fsync(sfd) == 0);
+    }
+    phase_done(PHASE_FSYNC);
+    test_assert(close(sfd) == 0);
+
+    phase_begin(PHASE_VERIFY);
+    test_assert(lseek(fd, 0, SEEK_SET) == 0);
+    for (long offset = 0; offset < write_size; offset += WRITE_CHUNK) {
+        fill_pattern(buf, WRITE_CHUNK, id, offset);
+        test_assert(read(fd, check, WRITE_CHUNK) == WRITE_CHUNK);
+        if (memcmp(buf, check, WRITE_CHUNK)) {
+            printf("thread %d: data mismatch at offset %ld\n", id, offset);
+            exit(EXIT_FAILURE);
+        }
+    }
+    phase_done(PHASE_VERIFY);
+    test_assert(close(fd) == 0);
+
+    phase_begin(PHASE_UNLINK);
+    for (int i = 0; i < nfiles; i++) {
+        snprintf(path, sizeof(path), BENCH_DIR "/t%d/f%d", id, i);
+        test_assert(unlink(path) == 0);
+    }
+    phase_done(PHASE_UNLINK);
+
+    snprintf(path, sizeof(path), BENCH_DIR "/t%d/data", id);
+    test_assert(unlink(path) == 0);
+    snprintf(path, sizeof(path), BENCH_DIR "/t%d/sync", id);
+    test_assert(unlink(path) == 0);
+    snprintf(path, sizeof(path), BENCH_DIR "/t%d", id);
+    test_assert(rmdir(path) == 0);
+    free(buf);
+    free(check);
+    return NULL;
+}
+
+static void usage(const char *prog)
+{
+    printf("usage: %s [-t threads] [-f files per thread] [-s write MB per thread] "
+           "[-n fsyncs per thread]\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    pthread_t threads[MAX_THREADS];
+    int c;
+
+    nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    while ((c = getopt(argc, argv, "t:f:s:n:")) != EOF) {
+        switch (c) {
+        case 't':
+            nthreads = atoi(optarg);
+            break;
+        case 'f':
+            nfiles = atoi(optarg);
+            break;
+        case 's':
+            write_size = atol(optarg) * 1024 * 1024;
+            break;
+        case 'n':
+            nfsyncs = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (nthreads < 1)
+        nthreads = 1;
+    else if (nthreads > MAX_THREADS)
+        nthreads = MAX_THREADS;
+    if (nfiles < 1 || write_size < WRITE_CHUNK || nfsyncs < 1)
+        usage(argv[0]);
+
+    printf("fsbench: %d threads, %d files, %ld MB written and %d fsyncs per thread\n",
+           nthreads, nfiles, write_size / (1024 * 1024), nfsyncs);
+    test_assert(mkdir(BENCH_DIR, 0755) == 0 || errno == EEXIST);
+    test_assert(pthread_barrier_init(&barrier, NULL, nthreads) == 0);
+    for (long i = 0; i < nthreads; i++)
+        test_assert(pthread_create(&threads[i], NULL, bench_thread, (void *)i) == 0);
+    for (int i = 0; i < nthreads; i++)
+        test_assert(pthread_join(threads[i], NULL) == 0);
+    pthread_barrier_destroy(&barrier);
+    test_assert(rmdir(BENCH_DIR) == 0);
+
+    long total_files = (long)nthreads * nfiles;
+    long total_mb = nthreads * (write_size / (1024 * 1024));
+    long total_fsyncs = (long)nthreads * nfsyncs;
+    printf("%-8s %10.0f files/s (%ld in %.3f s)\n", phase_names[PHASE_CREATE],
+           total_files / elapsed(PHASE_CREATE), total_files, elapsed(PHASE_CREATE));
+    printf("%-8s %10.1f MB/s (%ld MB in %.3f s)\n", phase_names[PHASE_WRITE],
+           total_mb / elapsed(PHASE_WRITE), total_mb, elapsed(PHASE_WRITE));
+    printf("%-8s %10.0f ops/s (%ld in %.3f s)\n", phase_names[PHASE_FSYNC],
+           total_fsyncs / elapsed(PHASE_FSYNC), total_fsyncs, elapsed(PHASE_FSYNC));
+    printf("%-8s %10.1f MB/s (%ld MB in %.3f s)\n", phase_names[PHASE_VERIFY],
+           total_mb / elapsed(PHASE_VERIFY), total_mb, elapsed(PHASE_VERIFY));
+    printf("%-8s %10.0f files/s (%ld in %.3f s)\n", phase_names[PHASE_UNLINK],
+           total_files / elapsed(PHASE_UNLINK), total_files, elapsed(PHASE_UNLINK));
+    printf("fsbench OK\n");
+    return EXIT_SUCCESS;
+}
@@ -8,6 +8,7 @@
 #include <limits.h>
 #include <time.h>
 #include <errno.h>
+#include <stdint.h>
 
 #define EXIT_FAILURE 1
 #define EXIT_SUCCESS 0
@@ -27,6 +28,8 @@ int cmp_requeue_test_futex_1 = FUTEX_INITIALIZER;
 int cmp_requeue_test_futex_2 = FUTEX_INITIALIZER;
 int wake_op_test_futex_1 = FUTEX_INITIALIZER;
 int wake_op_test_futex_2 = FUTEX_INITIALIZER;
+int wake_bitset_test_futex = FUTEX_INITIALIZER;
+int waitv_test_futex[3] = {FUTEX_INITIALIZER, FUTEX_INITIALIZER, FUTEX_INITIALIZER};
 
 /* Helper Thread Function Declarations */
 static void *futex_wake_test_thread(void *arg);
@@ -333,6 +336,198 @@ static void *futex_wake_op_test_thread(void *arg)
     return NULL;
 } 
 
+/* FUTEX_WAKE_BITSET test: two threads wait on the same futex with
+disjoint bitsets; each wake must only reach the matching waiter */
+static void *futex_wake_bitset_test_thread(void *arg)
+{
+    long ret = syscall(SYS_futex, &wake_bitset_test_futex, FUTEX_WAIT_BITSET,
+                       FUTEX_INITIALIZER, NULL, NULL, (int)(long)arg);
+    return (void *)ret;
+}
+
+static boolean futex_wake_bitset_test()
+{
+    int *uaddr = &wake_bitset_test_futex;
+    pthread_t threads[2];
+    void *retval;
+    int ret;
+
+    for (long i = 0; i < 2; i++) {
+        if (pthread_create(&threads[i], NULL, futex_wake_bitset_test_thread, (void *)(1l << i))) {
+            printf("Unable to create thread.\n");
+            return false;
+        }
+    }
+    sleep(1);
+
+    if ((syscall(SYS_futex, uaddr, FUTEX_WAKE_BITSET, 1, NULL, NULL, 0) != -1) || (errno != EINVAL)) {
+        printf("wake_bitset test: zero bitset not rejected\n");
+        return false;
+    }
+    if (syscall(SYS_futex, uaddr, FUTEX_WAKE_BITSET, INT_MAX, NULL, NULL, 4) != 0) {
+        printf("wake_bitset test: woke waiter with non-matching bitset\n");
+        return false;
+    }
+    ret = syscall(SYS_futex, uaddr, FUTEX_WAKE_BITSET, INT_MAX, NULL, NULL, 2);
+    if (ret != 1 || pthread_join(threads[1], &retval) || retval != 0) {
+        printf("wake_bitset test: bitset 2 wake failed (%d)\n", ret);
+        return false;
+    }
+    ret = syscall(SYS_futex, uaddr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    if (ret != 1 || pthread_join(threads[0], &retval) || retval != 0) {
+        printf("wake_bitset test: plain wake failed (%d)\n", ret);
+        return false;
+    }
+    printf("wake_bitset test: passed\n");
+    return true;
+}
+
+/* futex_waitv tests: value mismatch, timeout, and a wakeup on one
+of several futexes returning the index of the woken futex */
+static long futex_waitv_call(struct futex_waitv *w, int n, struct timespec *ts)
+{
+    return syscall(SYS_futex_waitv, w, n, 0, ts, CLOCK_MONOTONIC);
+}
+
+static void futex_waitv_init(struct futex_waitv *w)
+{
+    for (int i = 0; i < 3; i++) {
+        w[i].val = FUTEX_INITIALIZER;
+        w[i].uaddr = (uintptr_t)&waitv_test_futex[i];
+        w[i].flags = FUTEX_32 | FUTEX_PRIVATE_FLAG;
+        w[i].__reserved = 0;
+    }
+}
+
+static void *futex_waitv_test_thread(void *arg)
+{
+    struct futex_waitv w[3];
+    futex_waitv_init(w);
+    return (void *)futex_waitv_call(w, 3, NULL);
+}
+
+static boolean futex_waitv_test()
+{
+    struct futex_waitv w[3];
+    struct timespec ts;
+    pthread_t thread;
+    void *retval;
+
+    futex_waitv_init(w);
+    if ((futex_waitv_call(w, 0, NULL) != -1) || (errno != EINVAL)) {
+        printf("waitv test: empty vector not rejected\n");
+        return false;
+    }
+    w[1].flags = 0;
+    if ((futex_waitv_call(w, 3, NULL) != -1) || (errno != EINVAL)) {
+        printf("waitv test: invalid flags not rejected\n");
+        return false;
+    }
+    futex_waitv_init(w);
+    w[2].val = FUTEX_INITIALIZER + 1;
+    if ((futex_waitv_call(w, 3, NULL) != -1) || (errno != EAGAIN)) {
+        printf("waitv test: value mismatch not detected\n");
+        return false;
+    }
+
+    futex_waitv_init(w);
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_nsec += 100000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    if ((futex_waitv_call(w, 3, &ts) != -1) || (errno != ETIMEDOUT)) {
+        printf("waitv test: timeout failed\n");
+        return false;
+    }
+
+    if (pthread_create(&thread, NULL, futex_waitv_test_thread, NULL)) {
+        printf("Unable to create thread.\n");
+        return false;
+    }
+    sleep(1);
+    int ret = syscall(SYS_futex, &waitv_test_futex[1], FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    if (ret != 1 || pthread_join(thread, &retval) || (long)retval != 1) {
+        printf("waitv test: wakeup failed (%d, %ld)\n", ret, (long)retval);
+        return false;
+    }
+    /* no waiter entries may be left behind on the other futexes */
+    if (syscall(SYS_futex, &waitv_test_futex[0], FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0) != 0 ||
+        syscall(SYS_futex, &waitv_test_futex[2], FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0) != 0) {
+        printf("waitv test: stale waiters found\n");
+        return false;
+    }
+    printf("waitv test: passed\n");
+    return true;
+}
+
+/* Contended mutex benchmark: a three-state futex mutex (0 unlocked,
+1 locked, 2 locked with waiters) hammered by several threads */
+#define MUTEX_BENCH_THREADS 8
+#define MUTEX_BENCH_ITERS   200000
+
+static int bench_mutex;
+static long bench_counter;
+
+static void bench_lock(int *m)
+{
+    int c = __sync_val_compare_and_swap(m, 0, 1);
+    if (c == 0)
+        return;
+    if (c != 2)
+        c = __atomic_exchange_n(m, 2, __ATOMIC_ACQUIRE);
+    while (c != 0) {
+        syscall(SYS_futex, m, FUTEX_WAIT_PRIVATE, 2, NULL, NULL, 0);
+        c = __atomic_exchange_n(m, 2, __ATOMIC_ACQUIRE);
+    }
+}
+
+static void bench_unlock(int *m)
+{
+    if (__atomic_fetch_sub(m, 1, __ATOMIC_RELEASE) != 1) {
+        __atomic_store_n(m, 0, __ATOMIC_RELEASE);
+        syscall(SYS_futex, m, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+}
+
+static void *mutex_bench_thread(void *arg)
+{
+    for (int i = 0; i < MUTEX_BENCH_ITERS; i++) {
+        bench_lock(&bench_mutex);
+        bench_counter++;
+        bench_unlock(&bench_mutex);
+    }
+    return NULL;
+}
+
+static boolean futex_mutex_bench()
+{
+    pthread_t threads[MUTEX_BENCH_THREADS];
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < MUTEX_BENCH_THREADS; i++) {
+        if (pthread_create(&threads[i], NULL, mutex_bench_thread, NULL)) {
+            printf("Unable to create thread.\n");
+            return false;
+        }
+    }
+    for (int i = 0; i < MUTEX_BENCH_THREADS; i++)
+        pthread_join(threads[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    long expected = (long)MUTEX_BENCH_THREADS * MUTEX_BENCH_ITERS;
+    if (bench_counter != expected) {
+        printf("mutex bench: counter %ld, expected %ld\n", bench_counter, expected);
+        return false;
+    }
+    double secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("mutex bench: %d threads, %ld lock/unlock pairs in %.3f s (%.0f ops/s)\n",
+           MUTEX_BENCH_THREADS, expected, secs, expected / secs);
+    return true;
+}
+
 /* Method to run all tests */
 boolean basic_test() 
 {
@@ -402,6 +597,18 @@ boolean basic_test()
     }
     else
         printf("wake_op test 2: passed\n");
+
+    printf("---FUTEX_WAKE_BITSET TESTS--- \n");
+    if (!futex_wake_bitset_test())
+        num_failed++;
+
+    printf("---FUTEX_WAITV TESTS--- \n");
+    if (!futex_waitv_test())
+        num_failed++;
+
+    printf("---CONTENDED MUTEX BENCHMARK--- \n");
+    if (!futex_mutex_bench())
+        num_failed++;
     
     if (num_failed > 0)
         return false;
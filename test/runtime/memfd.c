@@ -0,0 +1,148 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#define test_assert(expr) do { \
+    if (!(expr)) { \
+        printf("Error: %s -- failed at %s:%d\n", #expr, __FILE__, __LINE__); \
+        exit(EXIT_FAILURE); \
+    } \
+} while (0)
+
+#define PAGESIZE    4096
+
+static int test_memfd_create(const char *name, unsigned int flags)
+{
+    return syscall(SYS_memfd_create, name, flags);
+}
+
+static void test_basic(void)
+{
+    char name[256];
+    char buf[64];
+    struct stat s;
+
+    memset(name, 'a', sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+    test_assert((test_memfd_create(name, 0) == -1) && (errno == EINVAL));
+    test_assert((test_memfd_create("test", ~0) == -1) && (errno == EINVAL));
+    test_assert((test_memfd_create((void *)-1, 0) == -1) && (errno == EFAULT));
+
+    int fd = test_memfd_create("test", MFD_CLOEXEC);
+    test_assert(fd >= 0);
+    test_assert(fcntl(fd, F_GETFD) == FD_CLOEXEC);
+    test_assert((fstat(fd, &s) == 0) && S_ISREG(s.st_mode) && (s.st_size == 0));
+    test_assert(read(fd, buf, sizeof(buf)) == 0);
+    test_assert(write(fd, "hello", 5) == 5);
+    test_assert((fstat(fd, &s) == 0) && (s.st_size == 5));
+    test_assert(lseek(fd, 0, SEEK_SET) == 0);
+    test_assert(read(fd, buf, sizeof(buf)) == 5);
+    test_assert(!memcmp(buf, "hello", 5));
+    test_assert(pwrite(fd, "world", 5, 2 * PAGESIZE) == 5);
+    test_assert((fstat(fd, &s) == 0) && (s.st_size == 2 * PAGESIZE + 5));
+    test_assert(pread(fd, buf, 5, PAGESIZE) == 5);
+    for (int i = 0; i < 5; i++)
+        test_assert(buf[i] == 0);
+    test_assert(pread(fd, buf, sizeof(buf), 2 * PAGESIZE) == 5);
+    test_assert(!memcmp(buf, "world", 5));
+
+    /* sealing not allowed */
+    test_assert(fcntl(fd, F_GET_SEALS) == F_SEAL_SEAL);
+    test_assert((fcntl(fd, F_ADD_SEALS, F_SEAL_WRITE) == -1) && (errno == EPERM));
+    test_assert(close(fd) == 0);
+}
+
+static void test_mmap(void)
+{
+    struct stat s;
+    int fd = test_memfd_create("test_mmap", 0);
+    test_assert(fd >= 0);
+    test_assert(ftruncate(fd, 4 * PAGESIZE) == 0);
+    test_assert((fstat(fd, &s) == 0) && (s.st_size == 4 * PAGESIZE));
+    unsigned char *p1 = mmap(NULL, 4 * PAGESIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    test_assert(p1 != MAP_FAILED);
+    unsigned char *p2 = mmap(NULL, 4 * PAGESIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    test_assert(p2 != MAP_FAILED);
+    for (int i = 0; i < 4 * PAGESIZE; i++)
+        test_assert(p1[i] == 0);
+    for (int i = 0; i < 4; i++)
+        p1[i * PAGESIZE] = i + 1;
+    for (int i = 0; i < 4; i++)
+        test_assert(p2[i * PAGESIZE] == i + 1);
+    unsigned char c;
+    test_assert((pread(fd, &c, 1, 3 * PAGESIZE) == 1) && (c == 4));
+    c = 0x55;
+    test_assert(pwrite(fd, &c, 1, PAGESIZE + 1) == 1);
+    test_assert(p1[PAGESIZE + 1] == 0x55);
+
+    /* shrink and grow again: truncated contents must read back as zeros */
+    test_assert(munmap(p2, 4 * PAGESIZE) == 0);
+    test_assert(munmap(p1 + 2 * PAGESIZE, 2 * PAGESIZE) == 0);
+    test_assert(ftruncate(fd, PAGESIZE + 1) == 0);
+    test_assert(p1[PAGESIZE] == 2);
+    test_assert(p1[PAGESIZE + 1] == 0);
+    test_assert(ftruncate(fd, 4 * PAGESIZE) == 0);
+    test_assert((pread(fd, &c, 1, 3 * PAGESIZE) == 1) && (c == 0));
+    test_assert(munmap(p1, 2 * PAGESIZE) == 0);
+    test_assert(close(fd) == 0);
+}
+
+static void test_seals(void)
+{
+    char buf[8];
+    int fd = test_memfd_create("test_seals", MFD_ALLOW_SEALING);
+    test_assert(fd >= 0);
+    test_assert(fcntl(fd, F_GET_SEALS) == 0);
+    test_assert(write(fd, "data", 4) == 4);
+
+    test_assert(fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK) == 0);
+    test_assert((ftruncate(fd, 2) == -1) && (errno == EPERM));
+    test_assert(ftruncate(fd, PAGESIZE) == 0);
+    test_assert(fcntl(fd, F_ADD_SEALS, F_SEAL_GROW) == 0);
+    test_assert((ftruncate(fd, 2 * PAGESIZE) == -1) && (errno == EPERM));
+    test_assert((pwrite(fd, buf, 1, PAGESIZE) == -1) && (errno == EPERM));
+    test_assert(pwrite(fd, "x", 1, PAGESIZE - 1) == 1);
+
+    /* a write seal cannot be added while a writable shared mapping exists */
+    void *p = mmap(NULL, PAGESIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    test_assert(p != MAP_FAILED);
+    test_assert((fcntl(fd, F_ADD_SEALS, F_SEAL_WRITE) == -1) && (errno == EBUSY));
+    test_assert(munmap(p, PAGESIZE) == 0);
+    test_assert(fcntl(fd, F_ADD_SEALS, F_SEAL_WRITE) == 0);
+    test_assert((write(fd, "data", 4) == -1) && (errno == EPERM));
+    test_assert((mmap(NULL, PAGESIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) == MAP_FAILED) &&
+                (errno == EPERM));
+    p = mmap(NULL, PAGESIZE, PROT_READ, MAP_SHARED, fd, 0);
+    test_assert(p != MAP_FAILED);
+    test_assert(!memcmp(p, "data", 4));
+    test_assert(munmap(p, PAGESIZE) == 0);
+
+    /* private mappings are not affected by write seals */
+    p = mmap(NULL, PAGESIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    test_assert(p != MAP_FAILED);
+    *(char *)p = 'D';
+    test_assert((pread(fd, buf, 1, 0) == 1) && (buf[0] == 'd'));
+    test_assert(munmap(p, PAGESIZE) == 0);
+
+    test_assert(fcntl(fd, F_ADD_SEALS, F_SEAL_SEAL) == 0);
+    test_assert((fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK) == -1) && (errno == EPERM));
+    test_assert(fcntl(fd, F_GET_SEALS) ==
+                (F_SEAL_SEAL | F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE));
+    test_assert(close(fd) == 0);
+}
+
+int main(int argc, char **argv)
+{
+    test_basic();
+    test_mmap();
+    test_seals();
+    printf("memfd test passed\n");
+    return EXIT_SUCCESS;
+}
@@ -22,6 +22,20 @@
 
 #define NETSOCK_TEST_PEEK_COUNT 8
 
+#define NETSOCK_TEST_GSO_PORT   1235
+#define NETSOCK_TEST_GSO_SIZE   1000
+#define NETSOCK_TEST_GSO_SEGS   8
+
+#ifndef SOL_UDP
+#define SOL_UDP     17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO     104
+#endif
+
 #define test_assert(expr) do { \
     if (!(expr)) { \
         printf("Error: %s -- failed at %s:%d\n", #expr, __FILE__, __LINE__); \
@@ -675,6 +689,102 @@ static void netsock_test_msg(int sock_type)
         test_assert(close(listen_fd) == 0);
 }
 
+/* UDP segmentation offload and receive coalescing over loopback */
+static void netsock_test_udpgso(void)
+{
+    int tx_fd, rx_fd;
+    struct sockaddr_in addr;
+    int val;
+    socklen_t optlen;
+    uint8_t buf[NETSOCK_TEST_GSO_SIZE * NETSOCK_TEST_GSO_SEGS];
+    uint8_t rbuf[sizeof(buf)];
+    const int last_len = NETSOCK_TEST_GSO_SIZE / 2;
+    const int total_len = sizeof(buf) - NETSOCK_TEST_GSO_SIZE + last_len;
+    struct iovec iov[NETSOCK_TEST_GSO_SEGS];
+    struct mmsghdr mmsg[NETSOCK_TEST_GSO_SEGS];
+    char control[CMSG_SPACE(sizeof(uint16_t)) > CMSG_SPACE(sizeof(int)) ?
+                 CMSG_SPACE(sizeof(uint16_t)) : CMSG_SPACE(sizeof(int))];
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    int rx_avail;
+
+    for (int i = 0; i < sizeof(buf); i++)
+        buf[i] = i * 7;
+    tx_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    test_assert(tx_fd > 0);
+    rx_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    test_assert(rx_fd > 0);
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(NETSOCK_TEST_GSO_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    test_assert(bind(rx_fd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    test_assert(connect(tx_fd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+
+    /* a send with a segment size set for the socket is received as separate datagrams */
+    val = NETSOCK_TEST_GSO_SIZE;
+    test_assert(setsockopt(tx_fd, SOL_UDP, UDP_SEGMENT, &val, sizeof(val)) == 0);
+    val = 0;
+    optlen = sizeof(val);
+    test_assert(getsockopt(tx_fd, SOL_UDP, UDP_SEGMENT, &val, &optlen) == 0);
+    test_assert((optlen == sizeof(val)) && (val == NETSOCK_TEST_GSO_SIZE));
+    test_assert(send(tx_fd, buf, total_len, 0) == total_len);
+    memset(mmsg, 0, sizeof(mmsg));
+    for (int i = 0; i < NETSOCK_TEST_GSO_SEGS; i++) {
+        iov[i].iov_base = rbuf + i * NETSOCK_TEST_GSO_SIZE;
+        iov[i].iov_len = NETSOCK_TEST_GSO_SIZE;
+        mmsg[i].msg_hdr.msg_iov = &iov[i];
+        mmsg[i].msg_hdr.msg_iovlen = 1;
+    }
+    test_assert(recvmmsg(rx_fd, mmsg, NETSOCK_TEST_GSO_SEGS, 0, NULL) == NETSOCK_TEST_GSO_SEGS);
+    for (int i = 0; i < NETSOCK_TEST_GSO_SEGS; i++)
+        test_assert(mmsg[i].msg_len ==
+                    ((i < NETSOCK_TEST_GSO_SEGS - 1) ? NETSOCK_TEST_GSO_SIZE : last_len));
+    test_assert(!memcmp(rbuf, buf, total_len));
+    test_assert((recv(rx_fd, rbuf, sizeof(rbuf), MSG_DONTWAIT) == -1) && (errno == EAGAIN));
+
+    /* too many segments */
+    val = 50;
+    test_assert(setsockopt(tx_fd, SOL_UDP, UDP_SEGMENT, &val, sizeof(val)) == 0);
+    test_assert((send(tx_fd, buf, sizeof(buf), 0) == -1) && (errno == EINVAL));
+    val = 0;
+    test_assert(setsockopt(tx_fd, SOL_UDP, UDP_SEGMENT, &val, sizeof(val)) == 0);
+
+    /* segment size from a control message, coalesced again by the receiver */
+    val = 1;
+    test_assert(setsockopt(rx_fd, SOL_UDP, UDP_GRO, &val, sizeof(val)) == 0);
+    iov[0].iov_base = buf;
+    iov[0].iov_len = total_len;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    *(uint16_t *)CMSG_DATA(cmsg) = NETSOCK_TEST_GSO_SIZE;
+    test_assert(sendmsg(tx_fd, &msg, 0) == total_len);
+    for (int i = 0; i < 1000; i++) {
+        test_assert(ioctl(rx_fd, FIONREAD, &rx_avail) == 0);
+        if (rx_avail == total_len)
+            break;
+        usleep(1000);
+    }
+    test_assert(rx_avail == total_len);
+    memset(rbuf, 0, sizeof(rbuf));
+    iov[0].iov_base = rbuf;
+    iov[0].iov_len = sizeof(rbuf);
+    msg.msg_controllen = sizeof(control);
+    test_assert(recvmsg(rx_fd, &msg, 0) == total_len);
+    test_assert(!memcmp(rbuf, buf, total_len));
+    test_assert(!(msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)));
+    cmsg = CMSG_FIRSTHDR(&msg);
+    test_assert(cmsg && (cmsg->cmsg_level == SOL_UDP) && (cmsg->cmsg_type == UDP_GRO));
+    test_assert(*(int *)CMSG_DATA(cmsg) == NETSOCK_TEST_GSO_SIZE);
+    test_assert((close(tx_fd) == 0) && (close(rx_fd) == 0));
+}
+
 int main(int argc, char **argv)
 {
     netsock_test_basic(SOCK_STREAM);
@@ -688,6 +798,7 @@ int main(int argc, char **argv)
     netsock_test_netconf();
     netsock_test_msg(SOCK_STREAM);
     netsock_test_msg(SOCK_DGRAM);
+    netsock_test_udpgso();
     printf("Network socket tests OK\n");
     return EXIT_SUCCESS;
 }
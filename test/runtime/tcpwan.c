@@ -0,0 +1,277 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/if_tun.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+/* TCP over an emulated WAN link: connections to the tun peer address are
+   looped back through a delay shim, which holds each packet for a fixed
+   one-way delay and then reflects it into the local stack by swapping its
+   source and destination addresses (which leaves all checksums valid). The
+   same transfer is run with a small fixed receive buffer and with buffer
+   autotuning; the latter must open the window to fill the link. */
+
+#define TUN_ADDR        0x0a030001      /* 10.3.0.1 */
+#define TUN_PEER_ADDR   (TUN_ADDR + 1)
+#define TUN_MTU         1500
+
+#define SERVER_PORT     5309
+
+#define DEFAULT_DELAY_MS    10
+#define LOCKED_RCVBUF       (64 * 1024)
+#define LOCKED_SIZE         (2 * 1024 * 1024)
+#define AUTOTUNE_SIZE       (32 * 1024 * 1024)
+#define CHUNK_SIZE          (64 * 1024)
+
+#define SHIM_SLOTS      8192
+
+#define test_assert(expr) do { \
+    if (!(expr)) { \
+        printf("Error: %s -- failed at %s:%d\n", #expr, __FILE__, __LINE__); \
+        exit(EXIT_FAILURE); \
+    } \
+} while (0)
+
+struct shim_packet {
+    uint64_t due;
+    int len;
+    uint8_t data[TUN_MTU];
+};
+
+static struct shim_packet *shim_ring;
+static unsigned int shim_head, shim_tail;
+static unsigned long shim_drops;
+static uint64_t delay_ns = DEFAULT_DELAY_MS * 1000000ull;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int tun_open(void)
+{
+    struct ifreq ifr;
+    struct sockaddr_in addr;
+
+    int tun_fd = open("/dev/net/tun", O_RDWR);
+    test_assert(tun_fd > 0);
+    memset(&ifr, 0, sizeof(ifr));
+    ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+    test_assert(ioctl(tun_fd, TUNSETIFF, &ifr) == 0);
+    int nbio = 1;
+    test_assert(ioctl(tun_fd, FIONBIO, &nbio) == 0);
+
+    int sock_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    test_assert(sock_fd > 0);
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(TUN_ADDR);
+    memcpy(&ifr.ifr_addr, &addr, sizeof(addr));
+    test_assert(ioctl(sock_fd, SIOCSIFADDR, &ifr) == 0);
+    addr.sin_addr.s_addr = htonl(0xffffff00);
+    memcpy(&ifr.ifr_addr, &addr, sizeof(addr));
+    test_assert(ioctl(sock_fd, SIOCSIFNETMASK, &ifr) == 0);
+    ifr.ifr_mtu = TUN_MTU;
+    test_assert(ioctl(sock_fd, SIOCSIFMTU, &ifr) == 0);
+    test_assert(ioctl(sock_fd, SIOCGIFFLAGS, &ifr) == 0);
+    ifr.ifr_flags |= IFF_UP;
+    test_assert(ioctl(sock_fd, SIOCSIFFLAGS, &ifr) == 0);
+    test_assert(close(sock_fd) == 0);
+    return tun_fd;
+}
+
+/* Delay shim: a FIFO of packets, each released once its delay expires.
+   Packets arriving to a full FIFO are dropped, as by a bottleneck queue. */
+static void *shim_thread(void *arg)
+{
+    int tun_fd = (long)arg;
+    struct pollfd pfd = { .fd = tun_fd, .events = POLLIN };
+    while (1) {
+        int timeout = -1;
+        if (shim_head != shim_tail) {
+            uint64_t t = now_ns(), due = shim_ring[shim_head % SHIM_SLOTS].due;
+            timeout = (due > t) ? (due - t + 999999) / 1000000 : 0;
+        }
+        test_assert(poll(&pfd, 1, timeout) >= 0);
+        while (1) {
+            struct shim_packet *pkt = &shim_ring[shim_tail % SHIM_SLOTS];
+            uint8_t *data = pkt->data;
+            uint8_t discard[TUN_MTU];
+            if (shim_tail - shim_head == SHIM_SLOTS)
+                data = discard;
+            int len = read(tun_fd, data, TUN_MTU);
+            if (len < 0) {
+                test_assert(errno == EAGAIN);
+                break;
+            }
+            if (data == discard) {
+                shim_drops++;
+                continue;
+            }
+            struct iphdr *ip = (struct iphdr *)data;
+            if (len < sizeof(*ip) || ip->version != 4)
+                continue;
+            uint32_t saddr = ip->saddr;
+            ip->saddr = ip->daddr;
+            ip->daddr = saddr;
+            pkt->len = len;
+            pkt->due = now_ns() + delay_ns;
+            shim_tail++;
+        }
+        uint64_t t = now_ns();
+        while (shim_head != shim_tail) {
+            struct shim_packet *pkt = &shim_ring[shim_head % SHIM_SLOTS];
+            if (pkt->due > t)
+                break;
+            test_assert(write(tun_fd, pkt->data, pkt->len) == pkt->len);
+            shim_head++;
+        }
+    }
+    return NULL;
+}
+
+static long transfer_size;
+
+static uint8_t pattern_byte(long offset)
+{
+    return (offset * 13 + (offset >> 10)) & 0xff;
+}
+
+static void *sender(void *arg)
+{
+    int fd = (long)arg;
+    uint8_t *buf = malloc(CHUNK_SIZE);
+    test_assert(buf);
+    for (long offset = 0; offset < transfer_size; ) {
+        long len = transfer_size - offset < CHUNK_SIZE ? transfer_size - offset : CHUNK_SIZE;
+        for (long i = 0; i < len; i++)
+            buf[i] = pattern_byte(offset + i);
+        ssize_t n = write(fd, buf, len);
+        test_assert(n > 0);
+        offset += n;
+    }
+    test_assert(shutdown(fd, SHUT_WR) == 0);
+    free(buf);
+    return NULL;
+}
+
+static int get_rcvbuf(int fd)
+{
+    int val;
+    socklen_t len = sizeof(val);
+    test_assert(getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &val, &len) == 0);
+    test_assert(len == sizeof(val));
+    return val;
+}
+
+/* Returns the throughput in MB/s; the receive buffer size of the receiving
+   socket is returned in *initial_rcvbuf and *rcvbuf, before and after the
+   transfer. */
+static double run_transfer(int rcvbuf_set, long size, int *initial_rcvbuf, int *rcvbuf)
+{
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    test_assert(lfd >= 0);
+    int one = 1;
+    test_assert(setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == 0);
+    if (rcvbuf_set) {
+        test_assert(setsockopt(lfd, SOL_SOCKET, SO_RCVBUF, &rcvbuf_set, sizeof(rcvbuf_set)) == 0);
+        test_assert(get_rcvbuf(lfd) == rcvbuf_set);
+    }
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(SERVER_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    test_assert(bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    test_assert(listen(lfd, 1) == 0);
+
+    /* connect to the tun peer, so that traffic goes through the shim */
+    int cfd = socket(AF_INET, SOCK_STREAM, 0);
+    test_assert(cfd >= 0);
+    addr.sin_addr.s_addr = htonl(TUN_PEER_ADDR);
+    test_assert(connect(cfd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    int rfd = accept(lfd, NULL, NULL);
+    test_assert(rfd >= 0);
+    test_assert(close(lfd) == 0);
+    *initial_rcvbuf = get_rcvbuf(rfd);
+    if (rcvbuf_set)
+        test_assert(*initial_rcvbuf == rcvbuf_set);
+
+    transfer_size = size;
+    pthread_t sthread;
+    uint64_t start = now_ns();
+    test_assert(pthread_create(&sthread, NULL, sender, (void *)(long)cfd) == 0);
+    uint8_t *buf = malloc(CHUNK_SIZE);
+    test_assert(buf);
+    long offset = 0;
+    ssize_t n;
+    while ((n = read(rfd, buf, CHUNK_SIZE)) > 0) {
+        for (ssize_t i = 0; i < n; i++) {
+            if (buf[i] != pattern_byte(offset + i)) {
+                printf("data mismatch at offset %ld\n", offset + i);
+                exit(EXIT_FAILURE);
+            }
+        }
+        offset += n;
+    }
+    test_assert(n == 0);
+    test_assert(offset == size);
+    double secs = (now_ns() - start) / 1e9;
+    test_assert(pthread_join(sthread, NULL) == 0);
+    *rcvbuf = get_rcvbuf(rfd);
+    free(buf);
+    test_assert(close(rfd) == 0);
+    test_assert(close(cfd) == 0);
+    printf("%-9s %8.2f MB/s (%ld MB in %.3f s), rcvbuf %d -> %d\n",
+           rcvbuf_set ? "fixed" : "autotuned", size / (1024.0 * 1024) / secs,
+           size / (1024 * 1024), secs, *initial_rcvbuf, *rcvbuf);
+    return size / (1024.0 * 1024) / secs;
+}
+
+int main(int argc, char **argv)
+{
+    int c;
+    while ((c = getopt(argc, argv, "d:")) != EOF) {
+        switch (c) {
+        case 'd':
+            delay_ns = atol(optarg) * 1000000ull;
+            break;
+        default:
+            printf("usage: %s [-d one-way delay in ms]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    shim_ring = malloc(SHIM_SLOTS * sizeof(*shim_ring));
+    test_assert(shim_ring);
+    int tun_fd = tun_open();
+    pthread_t shim;
+    test_assert(pthread_create(&shim, NULL, shim_thread, (void *)(long)tun_fd) == 0);
+    printf("tcpwan: %lu ms RTT\n", (unsigned long)(2 * delay_ns / 1000000));
+
+    int initial_rcvbuf, rcvbuf;
+    double fixed = run_transfer(LOCKED_RCVBUF, LOCKED_SIZE, &initial_rcvbuf, &rcvbuf);
+    test_assert(rcvbuf == LOCKED_RCVBUF);
+    double tuned = run_transfer(0, AUTOTUNE_SIZE, &initial_rcvbuf, &rcvbuf);
+    test_assert(rcvbuf > initial_rcvbuf);
+
+    /* a fixed buffer limits throughput to one window per RTT */
+    test_assert(tuned > 2 * fixed);
+    printf("shim drops: %lu\n", shim_drops);
+    printf("tcpwan OK\n");
+    return EXIT_SUCCESS;
+}
@@ -14,6 +14,9 @@
 #define MAX_CPUS 16
 #define PAGESIZE 4096
 #define NBYTES 256
+#define LOOPS 1000
+
+#define TLBSTATS_FILE "/proc/nanos/tlbshootdown"
 
 pthread_t threads[MAX_CPUS];
 sigjmp_buf jbs[MAX_CPUS];
@@ -82,6 +85,26 @@ void handle_sigbuf(int sig, siginfo_t *si, void *uctxt)
     siglongjmp(jbs[id], si->si_code);
 }
 
+struct tlbstats {
+    unsigned long shootdowns;
+    unsigned long ipis;
+    unsigned long idle_skipped;
+    unsigned long pv_flushed;
+};
+
+/* returns 0 if the kernel doesn't export shootdown statistics */
+int
+read_tlbstats(struct tlbstats *ts)
+{
+    FILE *f = fopen(TLBSTATS_FILE, "r");
+    if (!f)
+        return 0;
+    int n = fscanf(f, "shootdowns %lu ipis %lu idle_skipped %lu pv_flushed %lu",
+                   &ts->shootdowns, &ts->ipis, &ts->idle_skipped, &ts->pv_flushed);
+    fclose(f);
+    return n == 4;
+}
+
 void
 wait_for_children(void)
 {
@@ -103,6 +126,8 @@ int main(int argc, char **argv)
 {
     int loops;
     struct sigaction sa;
+    struct tlbstats start, end;
+    int have_stats;
 
     pthread_cond_init(&kid_cv, NULL);
     pthread_cond_init(&sync_cv, NULL);
@@ -119,7 +144,8 @@ int main(int argc, char **argv)
     np = get_nprocs();
     printf("There are %d processors available\n", np);
 
-    for (loops = 0; loops < 1000; loops++) {
+    have_stats = read_tlbstats(&start);
+    for (loops = 0; loops < LOOPS; loops++) {
         stage = 0;
         m = mmap(NULL, PAGESIZE * np, PROT_READ|PROT_WRITE, MAP_ANONYMOUS|MAP_PRIVATE, 0, 0);
         if (m == (void *)-1) {
@@ -141,6 +167,12 @@ int main(int argc, char **argv)
         for (int i = 0; i < np; i++)
             pthread_join(threads[i], NULL);
     }
+    if (have_stats && read_tlbstats(&end)) {
+        printf("shootdowns: %lu, IPIs: %lu (%.2f per unmap), idle cpus skipped: %lu, "
+               "paravirtual flushes: %lu\n", end.shootdowns - start.shootdowns,
+               end.ipis - start.ipis, (double)(end.ipis - start.ipis) / LOOPS,
+               end.idle_skipped - start.idle_skipped, end.pv_flushed - start.pv_flushed);
+    }
     printf("%s passed\n", argv[0]);
     exit(EXIT_SUCCESS);
 }
@@ -41,6 +41,13 @@ int main(int argc, char ** argv)
     if (bind(fd, (struct sockaddr *)&lsin, sizeof(lsin)) < 0)
 	fail("bind");
 
+    if (get_u64(t, sym(busy_poll), &result)) {
+        int usecs = result;
+        if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usecs, sizeof(usecs)) < 0)
+            fail("setsockopt");
+        rprintf("busy polling for %d us\n", usecs);
+    }
+
     struct sockaddr_in rsin;
     socklen_t rsin_len = sizeof(rsin);
     const char * tstr = "terminate";
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <errno.h>
 #include <fcntl.h>
 #include <poll.h>
@@ -10,6 +11,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/un.h>
+#include <time.h>
 #include <unistd.h>
 #include <semaphore.h>
 
@@ -22,6 +24,9 @@
 #define CLIENT_COUNT     8
 #define DGRAM_COUNT      128
 
+#define THROUGHPUT_CHUNK    (64 * 1024)
+#define THROUGHPUT_TOTAL    (256 * 1024 * 1024)
+
 #define test_assert(expr) do { \
     if (!(expr)) { \
         printf("Error: %s -- failed at %s:%d\n", #expr, __FILE__, __LINE__); \
@@ -609,12 +614,219 @@ static void uds_nonblocking_test(void)
     test_assert(unlink(SERVER_SOCKET_PATH) == 0);
 }
 
+static void uds_sockbuf_test(void)
+{
+    int sv[2];
+    int val;
+    socklen_t optlen = sizeof(val);
+    uint8_t buf[SMALLBUF_SIZE];
+    ssize_t nbytes, total;
+
+    test_assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+    test_assert(getsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &val, &optlen) == 0);
+    test_assert((optlen == sizeof(val)) && (val > 0));
+    test_assert(getsockopt(sv[1], SOL_SOCKET, SO_RCVBUF, &val, &optlen) == 0);
+    test_assert(val > 0);
+
+    /* the kernel doubles the requested value */
+    val = 32 * 1024;
+    test_assert(setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &val, sizeof(val)) == 0);
+    test_assert(setsockopt(sv[1], SOL_SOCKET, SO_RCVBUF, &val, sizeof(val)) == 0);
+    test_assert(getsockopt(sv[1], SOL_SOCKET, SO_RCVBUF, &val, &optlen) == 0);
+    test_assert(val == 64 * 1024);
+    test_assert((setsockopt(sv[1], SOL_SOCKET, SO_RCVBUF, &val, 1) == -1) && (errno == EINVAL));
+
+    /* fill the receive buffer; the amount of buffered data must be bounded */
+    uint8_t *large = malloc(THROUGHPUT_CHUNK);
+    test_assert(large);
+    total = 0;
+    while ((nbytes = send(sv[0], large, THROUGHPUT_CHUNK, 0)) > 0)
+        total += nbytes;
+    test_assert((nbytes == -1) && (errno == EAGAIN));
+    test_assert((total > 0) && (total <= 1024 * 1024));
+    while ((nbytes = recv(sv[1], large, THROUGHPUT_CHUNK, 0)) > 0)
+        total -= nbytes;
+    test_assert((nbytes == -1) && (errno == EAGAIN));
+    test_assert(total == 0);
+    free(large);
+    test_assert(send(sv[0], "x", 1, 0) == 1);
+    test_assert((recv(sv[1], buf, sizeof(buf), 0) == 1) && (buf[0] == 'x'));
+    test_assert(close(sv[0]) == 0);
+    test_assert(close(sv[1]) == 0);
+}
+
+static int uds_send_fds(int fd, const void *data, size_t len, int *fds, int nfds)
+{
+    union {
+        char buf[CMSG_SPACE(sizeof(int) * 4)];
+        struct cmsghdr align;
+    } control;
+    struct iovec iov = { .iov_base = (void *)data, .iov_len = len };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nfds);
+    return sendmsg(fd, &msg, 0);
+}
+
+static void uds_scm_test(void)
+{
+    int sv[2], pipefd[2];
+    int fds[2];
+    uint8_t buf[SMALLBUF_SIZE];
+    union {
+        char buf[CMSG_SPACE(sizeof(int) * 4) + CMSG_SPACE(sizeof(struct ucred))];
+        struct cmsghdr align;
+    } control;
+    struct iovec iov;
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    struct ucred cred;
+    socklen_t optlen = sizeof(cred);
+    int val;
+
+    test_assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    test_assert(pipe(pipefd) == 0);
+    test_assert(getsockopt(sv[0], SOL_SOCKET, SO_PEERCRED, &cred, &optlen) == 0);
+    test_assert((optlen == sizeof(cred)) && (cred.pid == getpid()));
+
+    /* pass both pipe ends; data sent afterwards must not be merged with the fds-carrying data */
+    test_assert(uds_send_fds(sv[0], "ab", 2, pipefd, 2) == 2);
+    test_assert(send(sv[0], "cd", 2, 0) == 2);
+    fds[0] = -1;
+    test_assert((uds_send_fds(sv[0], "e", 1, fds, 1) == -1) && (errno == EBADF));
+    iov.iov_base = buf;
+    iov.iov_len = sizeof(buf);
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+    test_assert(recvmsg(sv[1], &msg, 0) == 2);
+    test_assert(!memcmp(buf, "ab", 2) && !(msg.msg_flags & MSG_CTRUNC));
+    cmsg = CMSG_FIRSTHDR(&msg);
+    test_assert(cmsg && (cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_RIGHTS));
+    test_assert(cmsg->cmsg_len == CMSG_LEN(2 * sizeof(int)));
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    test_assert((fds[0] != pipefd[0]) && (fds[1] != pipefd[1]));
+    test_assert(CMSG_NXTHDR(&msg, cmsg) == NULL);
+    test_assert(write(fds[1], "p", 1) == 1);
+    test_assert((read(pipefd[0], buf, 1) == 1) && (buf[0] == 'p'));
+    test_assert(write(pipefd[1], "q", 1) == 1);
+    test_assert((read(fds[0], buf, 1) == 1) && (buf[0] == 'q'));
+    test_assert(close(fds[0]) == 0);
+    test_assert(close(fds[1]) == 0);
+    msg.msg_controllen = sizeof(control.buf);
+    test_assert(recvmsg(sv[1], &msg, 0) == 2);
+    test_assert(!memcmp(buf, "cd", 2) && (msg.msg_controllen == 0));
+
+    /* insufficient control buffer space: excess fds are discarded */
+    int three_fds[3] = { pipefd[0], pipefd[1], pipefd[0] };
+    test_assert(uds_send_fds(sv[0], "f", 1, three_fds, 3) == 1);
+    msg.msg_controllen = CMSG_LEN(2 * sizeof(int));
+    test_assert(recvmsg(sv[1], &msg, 0) == 1);
+    test_assert(msg.msg_flags & MSG_CTRUNC);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    test_assert(cmsg && (cmsg->cmsg_len == CMSG_LEN(2 * sizeof(int))));
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    test_assert(close(fds[0]) == 0);
+    test_assert(close(fds[1]) == 0);
+
+    /* fds received by a plain read are discarded */
+    test_assert(uds_send_fds(sv[0], "g", 1, pipefd, 1) == 1);
+    test_assert((read(sv[1], buf, sizeof(buf)) == 1) && (buf[0] == 'g'));
+
+    /* credentials */
+    val = 1;
+    test_assert(setsockopt(sv[1], SOL_SOCKET, SO_PASSCRED, &val, sizeof(val)) == 0);
+    test_assert(send(sv[0], "h", 1, 0) == 1);
+    msg.msg_controllen = sizeof(control.buf);
+    test_assert(recvmsg(sv[1], &msg, 0) == 1);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    test_assert(cmsg && (cmsg->cmsg_level == SOL_SOCKET) &&
+                (cmsg->cmsg_type == SCM_CREDENTIALS));
+    memcpy(&cred, CMSG_DATA(cmsg), sizeof(cred));
+    test_assert((cred.pid == getpid()) && (cred.uid == getuid()) && (cred.gid == getgid()));
+    test_assert(close(sv[0]) == 0);
+    test_assert(close(sv[1]) == 0);
+
+    /* datagram sockets */
+    test_assert(socketpair(AF_UNIX, SOCK_DGRAM, 0, sv) == 0);
+    test_assert(uds_send_fds(sv[0], "i", 1, pipefd, 1) == 1);
+    test_assert(uds_send_fds(sv[0], "j", 1, pipefd + 1, 1) == 1);
+    msg.msg_controllen = sizeof(control.buf);
+    test_assert(recvmsg(sv[1], &msg, 0) == 1);
+    test_assert(buf[0] == 'i');
+    cmsg = CMSG_FIRSTHDR(&msg);
+    test_assert(cmsg && (cmsg->cmsg_type == SCM_RIGHTS));
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(int));
+    test_assert(write(pipefd[1], "r", 1) == 1);
+    test_assert((read(fds[0], buf, 1) == 1) && (buf[0] == 'r'));
+    test_assert(close(fds[0]) == 0);
+    test_assert(close(sv[0]) == 0);
+    test_assert(close(sv[1]) == 0); /* discards the fd in the unread datagram */
+
+    test_assert(close(pipefd[0]) == 0);
+    test_assert(close(pipefd[1]) == 0);
+}
+
+static void *uds_throughput_writer(void *arg)
+{
+    int fd = (long) arg;
+    uint8_t *buf = malloc(THROUGHPUT_CHUNK);
+    test_assert(buf);
+    memset(buf, 0xa5, THROUGHPUT_CHUNK);
+    for (size_t total = 0; total < THROUGHPUT_TOTAL; ) {
+        ssize_t nbytes = write(fd, buf, THROUGHPUT_CHUNK);
+        test_assert(nbytes > 0);
+        total += nbytes;
+    }
+    free(buf);
+    return NULL;
+}
+
+static void uds_stream_throughput(void)
+{
+    int sv[2];
+    pthread_t pt;
+    struct timespec start, end;
+    uint8_t *buf = malloc(THROUGHPUT_CHUNK);
+
+    test_assert(buf);
+    test_assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    test_assert(pthread_create(&pt, NULL, uds_throughput_writer, (void *)(long) sv[0]) == 0);
+    for (size_t total = 0; total < THROUGHPUT_TOTAL; ) {
+        ssize_t nbytes = read(sv[1], buf, THROUGHPUT_CHUNK);
+        test_assert(nbytes > 0);
+        total += nbytes;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    test_assert(pthread_join(pt, NULL) == 0);
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("unix stream throughput: %.1f MB/s (%d MB in %.3f s)\n",
+           THROUGHPUT_TOTAL / elapsed / (1024 * 1024), THROUGHPUT_TOTAL / (1024 * 1024), elapsed);
+    test_assert(close(sv[0]) == 0);
+    test_assert(close(sv[1]) == 0);
+    free(buf);
+}
+
 int main(int argc, char **argv)
 {
     uds_stream_test();
     uds_dgram_test();
     uds_seqpacket_test();
     uds_nonblocking_test();
+    uds_sockbuf_test();
+    uds_scm_test();
+    uds_stream_throughput();
     printf("Unix domain socket tests OK\n");
     return EXIT_SUCCESS;
 }
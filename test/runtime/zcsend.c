@@ -0,0 +1,271 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+/* TCP send benchmark over loopback: the same data is sent with plain writes,
+   with MSG_ZEROCOPY sends (reaping completions from the error queue) and with
+   sendfile, and throughput and cpu time of the sender are reported for each
+   mode. The receiver verifies the data, so this doubles as a functional test
+   of the zero-copy paths. */
+
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY     60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY    0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY   5
+#endif
+
+#define BENCH_PORT      5308
+#define BENCH_FILE      "/zcsend.dat"
+
+#define DEFAULT_SIZE    (32 * 1024 * 1024)
+#define DEFAULT_CHUNK   (64 * 1024)
+
+#define test_assert(expr) do { \
+    if (!(expr)) { \
+        printf("Error: %s -- failed at %s:%d\n", #expr, __FILE__, __LINE__); \
+        exit(EXIT_FAILURE); \
+    } \
+} while (0)
+
+enum mode {
+    MODE_COPY,
+    MODE_ZEROCOPY,
+    MODE_SENDFILE,
+    MODE_COUNT
+};
+
+static const char *mode_names[MODE_COUNT] = {
+    "copy", "zerocopy", "sendfile"
+};
+
+static long total_size = DEFAULT_SIZE;
+static long chunk_size = DEFAULT_CHUNK;
+static uint8_t *send_buf;
+
+static uint8_t pattern_byte(long offset)
+{
+    return (offset * 7 + (offset >> 12)) & 0xff;
+}
+
+static void *receiver(void *arg)
+{
+    int fd = (long)arg;
+    uint8_t *buf = malloc(chunk_size);
+    test_assert(buf);
+    long offset = 0;
+    ssize_t n;
+    while ((n = read(fd, buf, chunk_size)) > 0) {
+        for (ssize_t i = 0; i < n; i++) {
+            if (buf[i] != pattern_byte(offset + i)) {
+                printf("receiver: data mismatch at offset %ld\n", offset + i);
+                exit(EXIT_FAILURE);
+            }
+        }
+        offset += n;
+    }
+    test_assert(n == 0);
+    test_assert(offset == total_size);
+    close(fd);
+    free(buf);
+    return NULL;
+}
+
+static void connect_pair(int lfd, int *sfd, pthread_t *rthread)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(BENCH_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    *sfd = socket(AF_INET, SOCK_STREAM, 0);
+    test_assert(*sfd >= 0);
+    test_assert(connect(*sfd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    int rfd = accept(lfd, NULL, NULL);
+    test_assert(rfd >= 0);
+    test_assert(pthread_create(rthread, NULL, receiver, (void *)(long)rfd) == 0);
+}
+
+/* Drain completion notifications; returns the number of sends completed. */
+static long reap_completions(int fd, long *copied)
+{
+    char control[CMSG_SPACE(sizeof(struct sock_extended_err))];
+    struct msghdr msg = {
+        .msg_control = control,
+        .msg_controllen = sizeof(control),
+    };
+    long completed = 0;
+    while (recvmsg(fd, &msg, MSG_ERRQUEUE) == 0) {
+        struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+        test_assert(cm && cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR);
+        struct sock_extended_err *ee = (struct sock_extended_err *)CMSG_DATA(cm);
+        test_assert(ee->ee_errno == 0 && ee->ee_origin == SO_EE_ORIGIN_ZEROCOPY);
+        test_assert(ee->ee_data >= ee->ee_info);
+        completed += ee->ee_data - ee->ee_info + 1;
+        if (ee->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+            (*copied)++;
+        msg.msg_controllen = sizeof(control);
+    }
+    test_assert(errno == EAGAIN);
+    return completed;
+}
+
+static void send_all(int fd, enum mode m, int file_fd)
+{
+    long sends = 0, completed = 0, copied = 0;
+    long offset = 0;
+    while (offset < total_size) {
+        long len = total_size - offset < chunk_size ? total_size - offset : chunk_size;
+        ssize_t n;
+        switch (m) {
+        case MODE_COPY:
+            n = write(fd, send_buf + offset, len);
+            break;
+        case MODE_ZEROCOPY:
+            n = send(fd, send_buf + offset, len, MSG_ZEROCOPY);
+            if (n > 0)
+                sends++;
+            completed += reap_completions(fd, &copied);
+            break;
+        default:
+            n = sendfile(fd, file_fd, NULL, len);
+            break;
+        }
+        test_assert(n > 0);
+        offset += n;
+    }
+    if (m == MODE_ZEROCOPY) {
+        /* all data must eventually be acknowledged */
+        while (completed < sends) {
+            struct pollfd pfd = { .fd = fd, .events = 0 };
+            test_assert(poll(&pfd, 1, 5000) == 1);
+            test_assert(pfd.revents & POLLERR);
+            completed += reap_completions(fd, &copied);
+        }
+        test_assert(completed == sends);
+        printf("%-8s %ld sends completed, %ld notifications with copied data\n",
+               mode_names[m], sends, copied);
+    }
+}
+
+static double timespec_diff(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static double rusage_cpu(struct rusage *ru)
+{
+    return ru->ru_utime.tv_sec + ru->ru_utime.tv_usec / 1e6 +
+        ru->ru_stime.tv_sec + ru->ru_stime.tv_usec / 1e6;
+}
+
+static void run_mode(int lfd, enum mode m)
+{
+    int sfd, file_fd = -1;
+    pthread_t rthread;
+    struct timespec start, end;
+    struct rusage ru_start, ru_end;
+
+    connect_pair(lfd, &sfd, &rthread);
+    if (m == MODE_ZEROCOPY) {
+        int one = 1;
+        test_assert(setsockopt(sfd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0);
+    } else if (m == MODE_SENDFILE) {
+        file_fd = open(BENCH_FILE, O_RDONLY);
+        test_assert(file_fd >= 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    test_assert(getrusage(RUSAGE_SELF, &ru_start) == 0);
+    send_all(sfd, m, file_fd);
+    test_assert(shutdown(sfd, SHUT_WR) == 0);
+    test_assert(pthread_join(rthread, NULL) == 0);
+    test_assert(getrusage(RUSAGE_SELF, &ru_end) == 0);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    test_assert(close(sfd) == 0);
+    if (file_fd >= 0)
+        test_assert(close(file_fd) == 0);
+
+    double secs = timespec_diff(&start, &end);
+    double mb = (double)total_size / (1024 * 1024);
+    printf("%-8s %10.1f MB/s (%.0f MB in %.3f s), %.3f s cpu\n", mode_names[m],
+           mb / secs, mb, secs, rusage_cpu(&ru_end) - rusage_cpu(&ru_start));
+}
+
+static void usage(const char *prog)
+{
+    printf("usage: %s [-s MB to send per mode] [-c chunk KB]\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    int c;
+    while ((c = getopt(argc, argv, "s:c:")) != EOF) {
+        switch (c) {
+        case 's':
+            total_size = atol(optarg) * 1024 * 1024;
+            break;
+        case 'c':
+            chunk_size = atol(optarg) * 1024;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (total_size < 1 || chunk_size < 1)
+        usage(argv[0]);
+
+    /* page-aligned source buffer, as zero-copy transmission is done in pages */
+    send_buf = mmap(NULL, total_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    test_assert(send_buf != MAP_FAILED);
+    for (long i = 0; i < total_size; i++)
+        send_buf[i] = pattern_byte(i);
+    int fd = open(BENCH_FILE, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    test_assert(fd >= 0);
+    for (long offset = 0; offset < total_size; ) {
+        ssize_t n = write(fd, send_buf + offset, total_size - offset);
+        test_assert(n > 0);
+        offset += n;
+    }
+    test_assert(close(fd) == 0);
+
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    test_assert(lfd >= 0);
+    int one = 1;
+    test_assert(setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(BENCH_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    test_assert(bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    test_assert(listen(lfd, 1) == 0);
+
+    printf("zcsend: %ld MB per mode in %ld KB sends\n", total_size / (1024 * 1024),
+           chunk_size / 1024);
+    for (enum mode m = 0; m < MODE_COUNT; m++)
+        run_mode(lfd, m);
+    close(lfd);
+    test_assert(unlink(BENCH_FILE) == 0);
+    munmap(send_buf, total_size);
+    printf("zcsend OK\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+#include <runtime.h>
+#include <stdlib.h>
+
+/* Throughput of the runtime memory operations at small, page and huge page
+   sizes. Each operation is repeated over the same buffers until
+   BENCH_TOTAL_BYTES have been processed; an optional argument overrides the
+   total, in MB. Not run by "make test"; run the binary directly. */
+
+#define BENCH_TOTAL_BYTES   (512 * MB)
+#define BENCH_BUF_SIZE      (2 * MB)
+
+#define test_assert(expr)   do { \
+    if (!(expr)) { \
+        msg_err("%s -- failed at %s:%d\n", #expr, __FILE__, __LINE__); \
+        exit(EXIT_FAILURE); \
+    } \
+} while (0)
+
+enum bench_op {
+    BENCH_MEMCPY,
+    BENCH_MEMSET,
+    BENCH_MEMCMP,
+};
+
+static const char * const bench_op_names[] = {
+    [BENCH_MEMCPY] = "memcpy",
+    [BENCH_MEMSET] = "memset",
+    [BENCH_MEMCMP] = "memcmp",
+};
+
+static u64 bench(enum bench_op op, u8 *dst, u8 *src, bytes size, u64 total)
+{
+    u64 iterations = MAX(total / size, 1);
+    int res = 0;
+    timestamp start = now(CLOCK_ID_MONOTONIC);
+    for (u64 i = 0; i < iterations; i++) {
+        switch (op) {
+        case BENCH_MEMCPY:
+            runtime_memcpy(dst, src, size);
+            break;
+        case BENCH_MEMSET:
+            runtime_memset(dst, i, size);
+            break;
+        case BENCH_MEMCMP:
+            res |= runtime_memcmp(dst, src, size);
+            break;
+        }
+        compiler_barrier();
+    }
+    timestamp elapsed = now(CLOCK_ID_MONOTONIC) - start;
+    test_assert(res == 0);
+    u64 usec = MAX(usec_from_timestamp(elapsed), 1);
+    return (iterations * size) / usec;  /* bytes per usec, i.e. MB/s */
+}
+
+int main(int argc, char *argv[])
+{
+    const bytes sizes[] = {64, 4 * KB, 2 * MB};
+    u64 total = BENCH_TOTAL_BYTES;
+
+    init_process_runtime();
+    if (argc > 1)
+        total = atol(argv[1]) * MB;
+    test_assert(total > 0);
+    u8 *src = malloc(BENCH_BUF_SIZE), *dst = malloc(BENCH_BUF_SIZE);
+    test_assert(src && dst);
+    for (int i = 0; i < BENCH_BUF_SIZE; i++)
+        src[i] = i;
+
+    for (enum bench_op op = BENCH_MEMCPY; op <= BENCH_MEMCMP; op++) {
+        if (op == BENCH_MEMCMP)
+            runtime_memcpy(dst, src, BENCH_BUF_SIZE);
+        for (int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            u64 mbps = bench(op, dst, src, sizes[s], total);
+            rprintf("%s %8ld bytes: %8ld MB/s\n", bench_op_names[op], sizes[s], mbps);
+        }
+    }
+    free(src);
+    free(dst);
+    return 0;
+}
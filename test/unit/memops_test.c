@@ -2,6 +2,7 @@
 #include <stdlib.h>
 
 #define MEM_BUF_SIZE    512
+#define LARGE_BUF_SIZE  (64 * KB)
 
 #define test_assert(expr)   do { \
     if (!(expr)) { \
@@ -108,6 +109,65 @@ static void test_memcmp(long *buf, unsigned long buf_size)
     test_assert(runtime_memcmp(buf, buf, buf_size * sizeof(long)) == 0);
 }
 
+/* Differing words must compare according to their first differing byte. */
+static void test_memcmp_order(u8 *buf1, u8 *buf2, unsigned long buf_size)
+{
+    unsigned long len = buf_size / 2;
+    for (long i = 0; i < len; i++) {
+        buf1[i] = i;
+    }
+    for (long offset = 0; offset < sizeof(long); offset++) {
+        runtime_memcpy(buf2 + offset, buf1, len);
+        test_assert(runtime_memcmp(buf1, buf2 + offset, len) == 0);
+        for (long i = 0; i < 4 * sizeof(long); i++) {
+            long pos = 2 * sizeof(long) + i;
+            buf2[offset + pos] = buf1[pos] + 1;
+            buf2[offset + pos + 1] = buf1[pos + 1] - 1;
+            test_assert(runtime_memcmp(buf1, buf2 + offset, len) < 0);
+            test_assert(runtime_memcmp(buf2 + offset, buf1, len) > 0);
+            buf2[offset + pos] = buf1[pos];
+            buf2[offset + pos + 1] = buf1[pos + 1];
+        }
+    }
+}
+
+/* Lengths around the thresholds of architecture-specific implementations,
+   at all relative alignments. */
+static void test_large(u8 *buf1, u8 *buf2, unsigned long buf_size)
+{
+    const bytes lengths[] = {63, 64, 255, 256, 257, 4095, 4096, 4097,
+                             buf_size - 2 * sizeof(long)};
+    for (long i = 0; i < buf_size; i++) {
+        buf1[i] = i * 7;
+    }
+    for (int l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        bytes len = lengths[l];
+        for (long i = 0; i < sizeof(long); i++) {
+            for (long j = 0; j < sizeof(long); j++) {
+                runtime_memset(buf2, 0, buf_size);
+                runtime_memcpy(buf2 + i, buf1 + j, len);
+                test_assert(runtime_memcmp(buf2 + i, buf1 + j, len) == 0);
+                for (long k = 0; k < i; k++)
+                    test_assert(buf2[k] == 0);
+                test_assert(buf2[i + len] == 0);
+            }
+            runtime_memset(buf2 + i, 0x5A, len);
+            for (long k = 0; k < len; k++)
+                test_assert(buf2[i + k] == 0x5A);
+            if (i > 0)
+                test_assert(buf2[i - 1] != 0x5A);
+            test_assert(buf2[i + len] != 0x5A);
+            runtime_memset(buf2, 0xFF, buf_size);
+            runtime_memset(buf2 + i, 0, len);
+            for (long k = 0; k < len; k++)
+                test_assert(buf2[i + k] == 0);
+            if (i > 0)
+                test_assert(buf2[i - 1] == 0xFF);
+            test_assert(buf2[i + len] == 0xFF);
+        }
+    }
+}
+
 int main(int argc, char *argv[])
 {
     long buf1[MEM_BUF_SIZE], buf2[MEM_BUF_SIZE];
@@ -118,5 +178,13 @@ int main(int argc, char *argv[])
     test_memcpy_overlap(buf1, MEM_BUF_SIZE);
     test_memset(buf1, MEM_BUF_SIZE);
     test_memcmp(buf1, MEM_BUF_SIZE);
+    test_memcmp_order((u8 *)buf1, (u8 *)buf2, sizeof(buf1));
+
+    u8 *large1 = malloc(LARGE_BUF_SIZE), *large2 = malloc(LARGE_BUF_SIZE);
+    test_assert(large1 && large2);
+    test_large(large1, large2, LARGE_BUF_SIZE);
+    test_memcpy_overlap((long *)large1, LARGE_BUF_SIZE / sizeof(long));
+    free(large1);
+    free(large2);
     return 0;
 }
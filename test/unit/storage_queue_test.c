@@ -0,0 +1,277 @@
+#include <runtime.h>
+#include <stdlib.h>
+#include <storage.h>
+#include <management.h>
+#include <storage_queue.h>
+#define EXIT_FAILURE 1
+#define EXIT_SUCCESS 0
+
+#define STUB_MAX_REQS   128
+#define TEST_MAX_REQS   128
+
+#define test_assert(expr) do { \
+if (expr) ; else { \
+	msg_err("%s -- failed at %s:%d\n", #expr, __FILE__, __LINE__); \
+	goto fail; \
+} \
+} while (0)
+
+extern heap init_process_runtime();
+
+/* Requests as seen by the driver, completed by the test */
+static struct stub_req {
+    u8 op;
+    range blocks;
+    u64 bytes;
+    status_handler completion;
+} stub_reqs[STUB_MAX_REQS];
+static int stub_count;
+
+static u8 test_data[PAGESIZE];
+
+/* Completion status of each request issued by the test; 0 if pending */
+static status test_status[TEST_MAX_REQS];
+static int test_count;
+
+closure_function(0, 1, void, stub_driver,
+                 storage_req, req)
+{
+    assert(stub_count < STUB_MAX_REQS);
+    struct stub_req *r = &stub_reqs[stub_count++];
+    r->op = req->op;
+    r->blocks = req->blocks;
+    r->bytes = ((req->op == STORAGE_OP_READSG) || (req->op == STORAGE_OP_WRITESG)) ?
+        ((sg_list)req->data)->count : 0;
+    r->completion = req->completion;
+}
+
+closure_function(1, 1, void, test_req_complete,
+                 int, id,
+                 status, s)
+{
+    test_status[bound(id)] = s;
+    closure_finish();
+}
+
+static void test_reset(void)
+{
+    stub_count = test_count = 0;
+    zero(test_status, sizeof(test_status));
+}
+
+/* Returns the index of the request in test_status. */
+static int test_submit(heap h, storage_queue q, u8 op, range blocks)
+{
+    int id = test_count++;
+    assert(id < TEST_MAX_REQS);
+    struct storage_req req = {
+        .op = op,
+        .blocks = blocks,
+        .completion = closure(h, test_req_complete, id),
+    };
+    if ((op == STORAGE_OP_READSG) || (op == STORAGE_OP_WRITESG)) {
+        sg_list sg = allocate_sg_list();
+        assert(sg != INVALID_ADDRESS);
+        u64 length = range_span(blocks) << SECTOR_OFFSET;
+        assert(length <= sizeof(test_data));
+        sg_buf sgb = sg_list_tail_add(sg, length);
+        assert(sgb != INVALID_ADDRESS);
+        sgb->buf = test_data;
+        sgb->size = length;
+        sgb->offset = 0;
+        sgb->refcount = 0;
+        req.data = sg;
+    }
+    apply(storage_queue_handler(q), &req);
+    return id;
+}
+
+static void stub_complete_all(status s)
+{
+    for (int i = 0; i < stub_count; i++) {
+        status_handler sh = stub_reqs[i].completion;
+        stub_reqs[i].completion = 0;
+        if (sh)
+            apply(sh, s);
+    }
+}
+
+static boolean stub_req_is(int i, u8 op, range blocks)
+{
+    if ((i >= stub_count) || (stub_reqs[i].op != op) ||
+        !range_equal(stub_reqs[i].blocks, blocks))
+        return false;
+    if ((op == STORAGE_OP_READSG) || (op == STORAGE_OP_WRITESG))
+        return stub_reqs[i].bytes == (range_span(blocks) << SECTOR_OFFSET);
+    return true;
+}
+
+static boolean test_all_ok(void)
+{
+    for (int i = 0; i < test_count; i++) {
+        if (test_status[i] != STATUS_OK)
+            return false;
+    }
+    return true;
+}
+
+static storage_queue test_queue(heap h, u64 max_bytes, u32 max_segs)
+{
+    test_reset();
+    storage_queue q = allocate_storage_queue(h, closure(h, stub_driver));
+    assert(q != INVALID_ADDRESS);
+    storage_queue_set_limits(q, max_bytes, max_segs);
+    return q;
+}
+
+/* Unplugged requests go straight to the driver, including once the
+   preallocated contexts are all in use. */
+static boolean passthrough_test(heap h)
+{
+    storage_queue q = test_queue(h, 0, 0);
+    int n = STORAGE_QUEUE_CONTEXTS + 8;
+    for (int i = 0; i < n; i++)
+        test_submit(h, q, STORAGE_OP_WRITESG, irangel(i, 1));
+    test_assert(stub_count == n);
+    for (int i = 0; i < n; i++)
+        test_assert(stub_req_is(i, STORAGE_OP_WRITESG, irangel(i, 1)));
+    test_assert(q->inflight == n && q->max_inflight == n);
+    test_assert(q->requests == n && q->dispatched == n && q->merged == 0);
+    stub_complete_all(STATUS_OK);
+    test_assert(test_all_ok());
+    test_assert(q->inflight == 0 && q->completed == n);
+    test_assert(q->ctx_busy == 0);
+    storage_queue_release(q);
+    return true;
+  fail:
+    return false;
+}
+
+/* Contiguous writes are merged into the last held one, within the size and
+   segment limits. */
+static boolean merge_test(heap h)
+{
+    storage_queue q = test_queue(h, 0, 3);
+    storage_plug();
+    for (int i = 0; i < 4; i++)
+        test_submit(h, q, STORAGE_OP_WRITESG, irangel(2 * i, 2));
+    test_submit(h, q, STORAGE_OP_WRITESG, irangel(20, 2));
+    test_assert(stub_count == 0);
+    storage_unplug();
+    test_assert(stub_count == 3);
+    test_assert(stub_req_is(0, STORAGE_OP_WRITESG, irange(0, 6)));
+    test_assert(stub_req_is(1, STORAGE_OP_WRITESG, irange(6, 8)));
+    test_assert(stub_req_is(2, STORAGE_OP_WRITESG, irange(20, 22)));
+    test_assert(q->merged == 2 && q->dispatched == 3 && q->inflight == 3);
+    stub_complete_all(STATUS_OK);
+    test_assert(test_all_ok());
+    test_assert(q->inflight == 0);
+    storage_queue_release(q);
+
+    q = test_queue(h, 4 << SECTOR_OFFSET, 0);
+    storage_plug();
+    for (int i = 0; i < 3; i++)
+        test_submit(h, q, STORAGE_OP_WRITESG, irangel(30 + 2 * i, 2));
+    storage_unplug();
+    test_assert(stub_count == 2);
+    test_assert(stub_req_is(0, STORAGE_OP_WRITESG, irange(30, 34)));
+    test_assert(stub_req_is(1, STORAGE_OP_WRITESG, irange(34, 36)));
+    stub_complete_all(STATUS_OK);
+    test_assert(test_all_ok());
+    storage_queue_release(q);
+    return true;
+  fail:
+    return false;
+}
+
+/* Requests that can't be held are dispatched after the held ones. Reads are
+   never held. */
+static boolean order_test(heap h)
+{
+    storage_queue q = test_queue(h, 0, 0);
+    storage_plug();
+    test_submit(h, q, STORAGE_OP_WRITESG, irangel(0, 1));
+    test_submit(h, q, STORAGE_OP_WRITESG, irangel(1, 1));
+    test_assert(stub_count == 0);
+    test_submit(h, q, STORAGE_OP_FLUSH, irange(0, 0));
+    test_assert(stub_count == 2);
+    test_assert(stub_req_is(0, STORAGE_OP_WRITESG, irange(0, 2)));
+    test_assert(stub_req_is(1, STORAGE_OP_FLUSH, irange(0, 0)));
+    test_submit(h, q, STORAGE_OP_WRITESG, irangel(2, 1));
+    test_submit(h, q, STORAGE_OP_READSG, irangel(3, 1));
+    test_assert(stub_count == 4);
+    test_assert(stub_req_is(2, STORAGE_OP_WRITESG, irangel(2, 1)));
+    test_assert(stub_req_is(3, STORAGE_OP_READSG, irangel(3, 1)));
+    storage_unplug();
+    test_assert(stub_count == 4);
+    stub_complete_all(STATUS_OK);
+    test_assert(test_all_ok());
+    storage_queue_release(q);
+    return true;
+  fail:
+    return false;
+}
+
+/* An error completing a merged request is reported to each request merged
+   into it. */
+static boolean error_test(heap h)
+{
+    storage_queue q = test_queue(h, 0, 0);
+    storage_plug();
+    for (int i = 0; i < 3; i++)
+        test_submit(h, q, STORAGE_OP_WRITESG, irangel(i, 1));
+    storage_unplug();
+    test_assert(stub_count == 1);
+    stub_complete_all(timm("result", "stub error"));
+    for (int i = 0; i < 3; i++)
+        test_assert(test_status[i] && !is_ok(test_status[i]));
+    test_assert(q->inflight == 0);
+    storage_queue_release(q);
+    return true;
+  fail:
+    return false;
+}
+
+/* Held requests are only dispatched on the outermost unplug. */
+static boolean nested_plug_test(heap h)
+{
+    storage_queue q = test_queue(h, 0, 0);
+    storage_plug();
+    storage_plug();
+    test_submit(h, q, STORAGE_OP_WRITESG, irangel(0, 1));
+    storage_unplug();
+    test_assert(stub_count == 0);
+    test_submit(h, q, STORAGE_OP_WRITESG, irangel(1, 1));
+    storage_unplug();
+    test_assert(stub_count == 1);
+    test_assert(stub_req_is(0, STORAGE_OP_WRITESG, irange(0, 2)));
+    stub_complete_all(STATUS_OK);
+    test_assert(test_all_ok());
+    storage_queue_release(q);
+    return true;
+  fail:
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    heap h = init_process_runtime();
+    init_storage_queues();
+
+    if (!passthrough_test(h))
+        goto fail;
+    if (!merge_test(h))
+        goto fail;
+    if (!order_test(h))
+        goto fail;
+    if (!error_test(h))
+        goto fail;
+    if (!nested_plug_test(h))
+        goto fail;
+
+    msg_debug("test passed\n");
+    exit(EXIT_SUCCESS);
+  fail:
+    msg_err("test failed\n");
+    exit(EXIT_FAILURE);
+}
@@ -0,0 +1,430 @@
+#include <runtime.h>
+#include <stdlib.h>
+#include <pagecache.h>
+#include <storage.h>
+#include <tfs.h>
+#define EXIT_FAILURE 1
+#define EXIT_SUCCESS 0
+
+#define TEST_FS_SIZE    (64 * MB)
+#define TEST_NFILES     16
+
+/* interleaved appenders, flushed every few rounds of appends */
+#define DELALLOC_NFILES         4
+#define DELALLOC_CHUNK          (64 * KB)
+#define DELALLOC_CHUNKS         32
+#define DELALLOC_FLUSH_ROUNDS   8
+
+#define test_assert(expr) do { \
+if (expr) ; else { \
+	msg_err("%s -- failed at %s:%d\n", #expr, __FILE__, __LINE__); \
+	goto fail; \
+} \
+} while (0)
+
+extern heap init_process_runtime();
+
+/* The filesystem image lives in memory, and all requests complete
+   synchronously. */
+closure_function(1, 1, void, image_req,
+                 u8 *, image,
+                 storage_req, req)
+{
+    u8 *p = bound(image) + (req->blocks.start << SECTOR_OFFSET);
+    u64 total = range_span(req->blocks) << SECTOR_OFFSET;
+    switch (req->op) {
+    case STORAGE_OP_READSG:
+        while (total > 0) {
+            sg_buf sgb = sg_list_head_peek(req->data);
+            assert(sgb != INVALID_ADDRESS);
+            u64 len = MIN(sg_buf_len(sgb), total);
+            runtime_memcpy(sgb->buf + sgb->offset, p, len);
+            sg_consume(req->data, len);
+            p += len;
+            total -= len;
+        }
+        break;
+    case STORAGE_OP_WRITESG:
+        assert(sg_copy_to_buf(p, req->data, total) == total);
+        break;
+    case STORAGE_OP_FLUSH:
+        break;
+    default:
+        halt("%s: invalid storage op %d\n", __func__, req->op);
+    }
+    apply(req->completion, STATUS_OK);
+}
+
+closure_function(1, 2, void, fs_complete,
+                 filesystem *, fsp,
+                 filesystem, fs, status, s)
+{
+    if (is_ok(s))
+        *bound(fsp) = fs;
+    else
+        msg_err("failed to create filesystem: %v\n", s);
+    closure_finish();
+}
+
+closure_function(1, 1, void, test_status,
+                 boolean *, ok,
+                 status, s)
+{
+    if (is_ok(s))
+        *bound(ok) = true;
+    else
+        msg_err("%v\n", s);
+    closure_finish();
+}
+
+closure_function(1, 2, void, test_io_status,
+                 boolean *, ok,
+                 status, s, bytes, length)
+{
+    if (is_ok(s))
+        *bound(ok) = true;
+    else
+        msg_err("%v\n", s);
+    closure_finish();
+}
+
+/* The status handler of filesystem_read_entire() is only applied on error. */
+closure_function(2, 1, status, compare_contents,
+                 buffer, expected, boolean *, ok,
+                 buffer, b)
+{
+    buffer expected = bound(expected);
+    if (buffer_length(b) == buffer_length(expected) &&
+        !runtime_memcmp(buffer_ref(b, 0), buffer_ref(expected, 0), buffer_length(b)))
+        *bound(ok) = true;
+    else
+        msg_err("file contents mismatch\n");
+    deallocate_buffer(b);
+    closure_finish();
+    return STATUS_OK;
+}
+
+/* A label is given only to make a new filesystem. */
+static filesystem mount_image(heap h, u8 *image, boolean ro, const char *label)
+{
+    filesystem fs = 0;
+    create_filesystem(h, SECTOR_SIZE, TEST_FS_SIZE, closure(h, image_req, image), ro,
+                      label, closure(h, fs_complete, &fs));
+    return fs;
+}
+
+static buffer file_pattern(heap h, int i, u64 length)
+{
+    buffer b = allocate_buffer(h, length);
+    for (u64 j = 0; j < length; j++)
+        push_u8(b, (u8)(i + j * 7));
+    return b;
+}
+
+static buffer file_contents(heap h, int i)
+{
+    return file_pattern(h, i, i * 3001);
+}
+
+/* Makes the root of a new filesystem, with an empty directory "dir". */
+static tuple make_test_dir(filesystem fs)
+{
+    tuple root = filesystem_getroot(fs);
+    set(root, sym_this(".."), 0);
+    tuple dir = allocate_tuple();
+    set(dir, sym(children), allocate_tuple());
+    set(root, sym(children), allocate_tuple());
+    set(children(root), sym(dir), dir);
+    if (filesystem_write_tuple(fs, root) != FS_STATUS_OK)
+        return 0;
+    return dir;
+}
+
+static tuple test_dir(tuple root)
+{
+    return get_tuple(children(root), sym(dir));
+}
+
+static fsfile create_file(filesystem fs, tuple dir, int i, tuple *t)
+{
+    char name[16];
+    rsnprintf(name, sizeof(name), "file%d", i);
+    *t = allocate_tuple();
+    if (do_mkentry(fs, dir, name, *t, true) != FS_STATUS_OK)
+        return INVALID_ADDRESS;
+    return allocate_fsfile(fs, *t);
+}
+
+closure_function(1, 2, boolean, count_extent,
+                 int *, n,
+                 value, k, value, v)
+{
+    (*bound(n))++;
+    return true;
+}
+
+static int file_extents(tuple t)
+{
+    int n = 0;
+    tuple extents = get_tuple(t, sym(extents));
+    if (extents)
+        iterate(extents, stack_closure(count_extent, &n));
+    return n;
+}
+
+static boolean flush_fs(heap h, filesystem fs)
+{
+    boolean ok = false;
+    filesystem_flush(fs, closure(h, test_status, &ok));
+    return ok;
+}
+
+static boolean write_file(heap h, filesystem fs, tuple dir, int i, buffer contents)
+{
+    boolean ok = false;
+    tuple t;
+    fsfile f = create_file(fs, dir, i, &t);
+    test_assert(f != INVALID_ADDRESS);
+    if (buffer_length(contents) > 0) {
+        filesystem_write_linear(f, buffer_ref(contents, 0), irangel(0, buffer_length(contents)),
+                                closure(h, test_io_status, &ok));
+        test_assert(ok);
+    } else {
+        tuple extents = allocate_tuple();
+        test_assert(filesystem_write_eav(fs, t, sym(extents), extents) == FS_STATUS_OK);
+        set(t, sym(extents), extents);
+        string len = wrap_buffer_cstring(h, "0");
+        test_assert(filesystem_write_eav(fs, t, sym(filelength), len) == FS_STATUS_OK);
+        set(t, sym(filelength), len);
+    }
+    return true;
+  fail:
+    return false;
+}
+
+static boolean check_files(heap h, filesystem fs, vector files, int nfiles)
+{
+    tuple dir = test_dir(filesystem_getroot(fs));
+    test_assert(dir);
+    for (int i = 0; i < nfiles; i++) {
+        buffer expected = vector_get(files, i);
+        char name[16];
+        rsnprintf(name, sizeof(name), "file%d", i);
+        tuple t = get_tuple(children(dir), sym_this(name));
+        test_assert(t);
+        fsfile f = fsfile_from_node(fs, t);
+        test_assert(f);
+        test_assert(fsfile_get_length(f) == buffer_length(expected));
+        if (buffer_length(expected) == 0)
+            continue;
+        boolean ok = false;
+        filesystem_read_entire(fs, t, h, closure(h, compare_contents, expected, &ok),
+                               closure(h, test_status, &ok));
+        test_assert(ok);
+    }
+    return true;
+  fail:
+    return false;
+}
+
+/* Write a tree the way mkfs does, compact the log into a checkpoint, then
+   check that the files read back from the checkpoint, and from the log tail
+   appended after it. */
+static boolean checkpoint_test(heap h)
+{
+    u8 *image = malloc(TEST_FS_SIZE);
+    test_assert(image);
+    zero(image, TEST_FS_SIZE);
+    vector files = allocate_vector(h, TEST_NFILES + 1);
+    for (int i = 0; i <= TEST_NFILES; i++)
+        vector_push(files, file_contents(h, i));
+
+    filesystem fs = mount_image(h, image, false, "");
+    test_assert(fs);
+    tuple dir = make_test_dir(fs);
+    test_assert(dir);
+    for (int i = 0; i < TEST_NFILES; i++)
+        test_assert(write_file(h, fs, dir, i, vector_get(files, i)));
+    test_assert(flush_fs(h, fs));
+    filesystem_compact_log(fs);
+    destroy_filesystem(fs);
+
+    fs = mount_image(h, image, true, 0);
+    test_assert(fs);
+    test_assert(check_files(h, fs, files, TEST_NFILES));
+    destroy_filesystem(fs);
+
+    fs = mount_image(h, image, false, 0);
+    test_assert(fs);
+    test_assert(write_file(h, fs, test_dir(filesystem_getroot(fs)), TEST_NFILES,
+                           vector_get(files, TEST_NFILES)));
+    test_assert(flush_fs(h, fs));
+    destroy_filesystem(fs);
+
+    fs = mount_image(h, image, true, 0);
+    test_assert(fs);
+    test_assert(check_files(h, fs, files, TEST_NFILES + 1));
+    destroy_filesystem(fs);
+    free(image);
+    return true;
+  fail:
+    return false;
+}
+
+/* Rounds of appends to a few files, with a flush every few rounds, as
+   writeback would interleave them. Space is only reserved at write time;
+   each writeback extends the last extent of a file into its preallocation,
+   so every file ends up with a single extent. Shrinking a file drops its
+   preallocation. Prints the resulting extent count and throughput. */
+static boolean delalloc_test(heap h)
+{
+    u8 *image = malloc(TEST_FS_SIZE);
+    test_assert(image);
+    zero(image, TEST_FS_SIZE);
+    u64 length = DELALLOC_CHUNK * DELALLOC_CHUNKS;
+    vector files = allocate_vector(h, DELALLOC_NFILES);
+    for (int i = 0; i < DELALLOC_NFILES; i++)
+        vector_push(files, file_pattern(h, i, length));
+
+    filesystem fs = mount_image(h, image, false, "");
+    test_assert(fs);
+    u64 chunk_blocks = DELALLOC_CHUNK / fs_blocksize(fs);
+    tuple dir = make_test_dir(fs);
+    test_assert(dir);
+    fsfile f[DELALLOC_NFILES];
+    tuple t[DELALLOC_NFILES];
+    for (int i = 0; i < DELALLOC_NFILES; i++) {
+        f[i] = create_file(fs, dir, i, &t[i]);
+        test_assert(f[i] != INVALID_ADDRESS);
+    }
+    u64 free_blocks = fs_freeblocks(fs);
+    timestamp start = now(CLOCK_ID_MONOTONIC);
+    for (int c = 0; c < DELALLOC_CHUNKS; c++) {
+        for (int i = 0; i < DELALLOC_NFILES; i++) {
+            boolean ok = false;
+            buffer b = vector_get(files, i);
+            filesystem_write_linear(f[i], buffer_ref(b, c * DELALLOC_CHUNK),
+                                    irangel(c * DELALLOC_CHUNK, DELALLOC_CHUNK),
+                                    closure(h, test_io_status, &ok));
+            test_assert(ok);
+        }
+        if (c == 0) {
+            /* reserved, not allocated */
+            for (int i = 0; i < DELALLOC_NFILES; i++) {
+                test_assert(file_extents(t[i]) == 0);
+                test_assert(fsfile_get_blocks(f[i]) == chunk_blocks);
+            }
+            test_assert(fs_freeblocks(fs) <= free_blocks - DELALLOC_NFILES * chunk_blocks);
+        }
+        if ((c + 1) % DELALLOC_FLUSH_ROUNDS == 0)
+            test_assert(flush_fs(h, fs));
+    }
+    timestamp write_time = now(CLOCK_ID_MONOTONIC) - start;
+    int extents = 0;
+    for (int i = 0; i < DELALLOC_NFILES; i++) {
+        int n = file_extents(t[i]);
+        msg_debug("file%d: %d extents\n", i, n);
+        test_assert(n == 1);
+        test_assert(fsfile_get_blocks(f[i]) == DELALLOC_CHUNKS * chunk_blocks);
+        extents += n;
+    }
+
+    /* the last file appended to still holds its preallocation */
+    int last = DELALLOC_NFILES - 1;
+    u64 used = fs_usedblocks(fs);
+    free_blocks = fs_freeblocks(fs);
+    test_assert(filesystem_truncate(fs, f[last], length / 2) == FS_STATUS_OK);
+    test_assert(fs_usedblocks(fs) < used);
+    test_assert(fs_freeblocks(fs) >= free_blocks);
+    buffer b = vector_get(files, last);
+    b->end = b->start + length / 2;
+    test_assert(flush_fs(h, fs));
+    destroy_filesystem(fs);
+
+    fs = mount_image(h, image, true, 0);
+    test_assert(fs);
+    start = now(CLOCK_ID_MONOTONIC);
+    test_assert(check_files(h, fs, files, DELALLOC_NFILES));
+    timestamp read_time = now(CLOCK_ID_MONOTONIC) - start;
+    destroy_filesystem(fs);
+    free(image);
+    u64 total = DELALLOC_NFILES * length;
+    rprintf("delalloc: %d files of %ld KB in %ld KB appends: %d extents, "
+            "write %ld MB/s, read %ld MB/s\n", DELALLOC_NFILES, length / KB,
+            DELALLOC_CHUNK / KB, extents, total / MAX(usec_from_timestamp(write_time), 1),
+            (total - length / 2) / MAX(usec_from_timestamp(read_time), 1));
+    return true;
+  fail:
+    return false;
+}
+
+/* A write that only fits in the space preallocated for another file
+   succeeds, by dropping the preallocation. */
+static boolean prealloc_nospace_test(heap h)
+{
+    u8 *image = malloc(TEST_FS_SIZE);
+    test_assert(image);
+    zero(image, TEST_FS_SIZE);
+    filesystem fs = mount_image(h, image, false, "");
+    test_assert(fs);
+    tuple dir = make_test_dir(fs);
+    test_assert(dir);
+    u64 length = 8 * MB;
+    vector files = allocate_vector(h, 2);
+    vector_push(files, file_pattern(h, 0, length));
+    tuple t;
+    fsfile f = create_file(fs, dir, 0, &t);
+    test_assert(f != INVALID_ADDRESS);
+    buffer b = vector_get(files, 0);
+    for (u64 offset = 0; offset < length; offset += MB) {
+        boolean ok = false;
+        filesystem_write_linear(f, buffer_ref(b, offset), irangel(offset, MB),
+                                closure(h, test_io_status, &ok));
+        test_assert(ok);
+        test_assert(flush_fs(h, fs));
+    }
+    test_assert(file_extents(t) == 1);
+    u64 used = fs_usedblocks(fs);
+
+    /* leave some room for log extensions */
+    u64 fill = (fs_freeblocks(fs) * fs_blocksize(fs) - 2 * MB) & ~(MB - 1);
+    vector_push(files, file_pattern(h, 1, fill));
+    f = create_file(fs, dir, 1, &t);
+    test_assert(f != INVALID_ADDRESS);
+    b = vector_get(files, 1);
+    boolean ok = false;
+    filesystem_write_linear(f, buffer_ref(b, 0), irangel(0, fill),
+                            closure(h, test_io_status, &ok));
+    test_assert(ok);
+    test_assert(flush_fs(h, fs));
+    test_assert(fs_usedblocks(fs) - used < fill / fs_blocksize(fs));
+    destroy_filesystem(fs);
+
+    fs = mount_image(h, image, true, 0);
+    test_assert(fs);
+    test_assert(check_files(h, fs, files, 2));
+    destroy_filesystem(fs);
+    free(image);
+    return true;
+  fail:
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    heap h = init_process_runtime();
+    init_pagecache(h, h, 0, PAGESIZE);
+
+    if (!checkpoint_test(h))
+        goto fail;
+    if (!delalloc_test(h))
+        goto fail;
+    if (!prealloc_nospace_test(h))
+        goto fail;
+
+    msg_debug("test passed\n");
+    exit(EXIT_SUCCESS);
+  fail:
+    msg_err("test failed\n");
+    exit(EXIT_FAILURE);
+}
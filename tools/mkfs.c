@@ -353,8 +353,8 @@ closure_function(0, 2, void, mkfs_write_handler,
     }
 }
 
-closure_function(4, 2, void, fsc,
-                 heap, h, descriptor, out, tuple, root, const char *, target_root,
+closure_function(5, 2, void, fsc,
+                 heap, h, descriptor, out, tuple, root, const char *, target_root, boolean, checkpoint,
                  filesystem, fs, status, s)
 {
     tuple root = bound(root);
@@ -363,7 +363,13 @@ closure_function(4, 2, void, fsc,
 
     heap h = bound(h);
     vector worklist = allocate_vector(h, 10);
-    tuple md = translate(h, worklist, bound(target_root), fs, root, closure(h, err));
+    /* The translated manifest becomes the root of the filesystem, so that it
+       is encoded first both in the log and in a checkpoint. Its link to
+       itself as parent is only meant for path lookups. */
+    tuple md = filesystem_getroot(fs);
+    set(md, sym_this(".."), 0);
+    status_handler sh = closure(h, err);
+    iterate(root, stack_closure(translate_each, h, worklist, bound(target_root), fs, sh, md));
 
     buffer b = allocate_buffer(transient, 64);
     u8 uuid[UUID_LEN];
@@ -391,13 +397,20 @@ closure_function(4, 2, void, fsc,
             } else {
                 if (!off)
                     off = wrap_buffer_cstring(h, "0");
-                /* make an empty file */
-                filesystem_write_eav(fs, f, sym(extents), allocate_tuple());
+                /* make an empty file; the checkpoint is encoded from memory */
+                tuple extents = allocate_tuple();
+                filesystem_write_eav(fs, f, sym(extents), extents);
+                set(f, sym(extents), extents);
                 filesystem_write_eav(fs, f, sym(filelength), off);
+                set(f, sym(filelength), off);
             }
         }
     }
     filesystem_flush(fs, ignore_status);
+
+    /* have the kernel load the metadata from a checkpoint instead of replaying the log */
+    if (bound(checkpoint))
+        filesystem_compact_log(fs);
     closure_finish();
 }
 
@@ -788,7 +801,7 @@ int main(int argc, char **argv)
         }
         if (boot) {
             create_filesystem(h, SECTOR_SIZE, BOOTFS_SIZE, closure(h, bwrite, out, offset), false,
-                              "", closure(h, fsc, h, out, boot, target_root));
+                              "", closure(h, fsc, h, out, boot, target_root, false));
             offset += BOOTFS_SIZE;
 
             /* Remove tuple from root, so it doesn't end up in the root FS. */
@@ -804,7 +817,7 @@ int main(int argc, char **argv)
                       closure(h, bwrite, out, offset),
                       false,
                       label,
-                      closure(h, fsc, h, out, root, target_root));
+                      closure(h, fsc, h, out, root, target_root, true));
 
     off_t current_size = lseek(out, 0, SEEK_END);
     if (current_size < 0) {
@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+# UDP request/response latency client for the udploop runtime test: sends
+# fixed-size requests one at a time and reports latency percentiles, e.g. to
+# compare a udploop instance run with and without "-busy_poll <usecs>".
+from __future__ import print_function
+import argparse
+import socket
+import time
+
+def percentile(sorted_vals, p):
+    idx = int(round(p / 100.0 * (len(sorted_vals) - 1)))
+    return sorted_vals[idx]
+
+def main():
+    parser = argparse.ArgumentParser(description='measure UDP round-trip latency')
+    parser.add_argument('host')
+    parser.add_argument('-p', '--port', type=int, default=5309)
+    parser.add_argument('-n', '--requests', type=int, default=10000)
+    parser.add_argument('-s', '--size', type=int, default=64)
+    parser.add_argument('-w', '--warmup', type=int, default=100)
+    parser.add_argument('-t', '--terminate', action='store_true',
+                        help='stop udploop when done')
+    args = parser.parse_args()
+
+    s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    s.settimeout(1.0)
+    addr = (args.host, args.port)
+    msg = b'x' * args.size
+    lat = []
+    lost = 0
+    for i in range(args.warmup + args.requests):
+        start = time.perf_counter()
+        s.sendto(msg, addr)
+        try:
+            s.recvfrom(65536)
+        except socket.timeout:
+            lost += 1
+            continue
+        if i >= args.warmup:
+            lat.append((time.perf_counter() - start) * 1e6)
+    if args.terminate:
+        s.sendto(b'terminate', addr)
+    if not lat:
+        print('no responses')
+        return 1
+    lat.sort()
+    print('%d requests, %d lost: p50 %.1f us, p99 %.1f us, max %.1f us' %
+          (len(lat), lost, percentile(lat, 50), percentile(lat, 99), lat[-1]))
+    return 0
+
+if __name__ == '__main__':
+    exit(main())